@@ -60,6 +60,14 @@ set(SOURCESDK_INCLUDE_DIRS
 	${SOURCESDK_INCLUDE_DIRS}
 )
 
+if(SOURCESDK_ALLOC_TRACKER)
+	set(SOURCESDK_COMPILE_DEFINITIONS
+		${SOURCESDK_COMPILE_DEFINITIONS}
+
+		SOURCESDK_ALLOC_TRACKER
+	)
+endif()
+
 if(SOURCESDK_MALLOC_OVERRIDE)
 	set(SOURCESDK_SOURCE_FILES
 		${SOURCESDK_SOURCE_FILES}
@@ -37,14 +37,22 @@ list(APPEND SOURCESDK_INCLUDE_DIRS
 )
 
 set(SOURCESDK_TIER1_SOURCE_FILES
+	${SOURCESDK_TIER1_DIR}/alloctracker.cpp
 	${SOURCESDK_TIER1_DIR}/bitbuf.cpp
+	${SOURCESDK_TIER1_DIR}/bufferstringarena.cpp
 	${SOURCESDK_TIER1_DIR}/convar.cpp
 	${SOURCESDK_TIER1_DIR}/generichash.cpp
 	${SOURCESDK_TIER1_DIR}/newbitbuf.cpp
 	${SOURCESDK_TIER1_DIR}/processor_detect.cpp
 	${SOURCESDK_TIER1_DIR}/rangecheckedvar.cpp
+	${SOURCESDK_TIER1_DIR}/sparsematrix.cpp
+	${SOURCESDK_TIER1_DIR}/strtools_simd.cpp
+	${SOURCESDK_TIER1_DIR}/strtools_unicode.cpp
 	${SOURCESDK_TIER1_DIR}/tier1.cpp
 	${SOURCESDK_TIER1_DIR}/utlbufferutil.cpp
+	${SOURCESDK_TIER1_DIR}/utlbvh4.cpp
+	${SOURCESDK_TIER1_DIR}/utlmappedbuffer.cpp
+	${SOURCESDK_TIER1_DIR}/zoneprofiler.cpp
 	${SOURCESDK_TIER1_DIR}/keyvalues3.cpp
 )
 
@@ -34,6 +34,8 @@
 
 #include "mathlib/ssemath.h"
 #include "mathlib/ssequaternion.h"
+#include "mathlib/ssemath8.h"
+#include "tier1/processor_detect.h"
 
 // memdbgon must be the last include file in a .cpp file!!!
 #include "tier0/memdbgon.h"
@@ -1008,6 +1010,43 @@ int __cdecl BoxOnPlaneSide (const float *emins, const float *emaxs, const cplane
 	return sides;
 }
 
+//-----------------------------------------------------------------------------
+// Batched BoxOnPlaneSideSIMD. Which of mins/maxs each corner takes depends only
+// on the plane, so it is picked once per call rather than per box.
+//-----------------------------------------------------------------------------
+void BoxOnPlaneSideSIMD( const FourVectors *pMins, const FourVectors *pMaxs, int nBoxes, const cplane_t *p, uint8 *pSides, float tolerance )
+{
+	const FourVectors *pNearX = p->normal.x >= 0.0f ? pMaxs : pMins;
+	const FourVectors *pNearY = p->normal.y >= 0.0f ? pMaxs : pMins;
+	const FourVectors *pNearZ = p->normal.z >= 0.0f ? pMaxs : pMins;
+	const FourVectors *pFarX = p->normal.x >= 0.0f ? pMins : pMaxs;
+	const FourVectors *pFarY = p->normal.y >= 0.0f ? pMins : pMaxs;
+	const FourVectors *pFarZ = p->normal.z >= 0.0f ? pMins : pMaxs;
+
+	fltx4 normalX = ReplicateX4( p->normal.x );
+	fltx4 normalY = ReplicateX4( p->normal.y );
+	fltx4 normalZ = ReplicateX4( p->normal.z );
+	fltx4 negDist = ReplicateX4( -p->dist );
+	fltx4 t4 = ReplicateX4( tolerance );
+	fltx4 negt4 = ReplicateX4( -tolerance );
+
+	for ( int i = 0; i < nBoxes; i += 4 )
+	{
+		int g = i >> 2;
+		fltx4 dot1 = AddSIMD( AddSIMD( AddSIMD( MulSIMD( normalX, pNearX[g].x ), MulSIMD( normalY, pNearY[g].y ) ), MulSIMD( normalZ, pNearZ[g].z ) ), negDist );
+		fltx4 dot2 = AddSIMD( AddSIMD( AddSIMD( MulSIMD( normalX, pFarX[g].x ), MulSIMD( normalY, pFarY[g].y ) ), MulSIMD( normalZ, pFarZ[g].z ) ), negDist );
+
+		int nFront = TestSignSIMD( CmpGeSIMD( dot1, t4 ) );
+		int nBack = TestSignSIMD( CmpGtSIMD( negt4, dot2 ) );
+
+		int nCount = MIN( 4, nBoxes - i );
+		for ( int j = 0; j < nCount; j++ )
+		{
+			pSides[i + j] = ( uint8 )( ( ( nFront >> j ) & 1 ) | ( ( ( nBack >> j ) & 1 ) << 1 ) );
+		}
+	}
+}
+
 //-----------------------------------------------------------------------------
 // Euler QAngle -> Basis Vectors
 //-----------------------------------------------------------------------------
@@ -2215,6 +2254,194 @@ void QuaternionMatrix( const Quaternion &q, matrix3x4_t& matrix )
 }
 
 
+//-----------------------------------------------------------------------------
+// Batched quaternion operations. Each group of four is transposed into a
+// FourQuaternions, worked on in SoA and transposed back. A partial last group
+// goes through a padded copy so the loops never read or write past nCount.
+//-----------------------------------------------------------------------------
+static FORCEINLINE void LoadFourQuaternions( const Quaternion *pQ, FourQuaternions &q )
+{
+	q.x = LoadUnalignedSIMD( pQ[0].Base() );
+	q.y = LoadUnalignedSIMD( pQ[1].Base() );
+	q.z = LoadUnalignedSIMD( pQ[2].Base() );
+	q.w = LoadUnalignedSIMD( pQ[3].Base() );
+	TransposeSIMD( q.x, q.y, q.z, q.w );
+}
+
+static FORCEINLINE void StoreFourQuaternions( const FourQuaternions &q, Quaternion *pQ )
+{
+	fltx4 r0 = q.x, r1 = q.y, r2 = q.z, r3 = q.w;
+	TransposeSIMD( r0, r1, r2, r3 );
+	StoreUnalignedSIMD( pQ[0].Base(), r0 );
+	StoreUnalignedSIMD( pQ[1].Base(), r1 );
+	StoreUnalignedSIMD( pQ[2].Base(), r2 );
+	StoreUnalignedSIMD( pQ[3].Base(), r3 );
+}
+
+// Eberly, "A Fast and Accurate Algorithm for Computing SLERP": sin( t * omega ) / sin( omega ) is
+// expanded as a polynomial in cos( omega ), so there is no trig at all, and the expansion is exact
+// at omega = 0, which covers the case QuaternionSlerpNoAlign special cases.
+static FORCEINLINE FourQuaternions SlerpFourQuaternions( const FourQuaternions &p, const FourQuaternions &q, const fltx4 &t )
+{
+	// the last term is scaled to make up for the ones left off; 12 terms keep the error under 1e-6 for any t in [0,1]
+	static const float s_flOnePlusMu = 1.8937232730807962f;
+	static const float s_flU[12] = { 1.0f / ( 1 * 3 ), 1.0f / ( 2 * 5 ), 1.0f / ( 3 * 7 ), 1.0f / ( 4 * 9 ), 1.0f / ( 5 * 11 ), 1.0f / ( 6 * 13 ), 1.0f / ( 7 * 15 ), 1.0f / ( 8 * 17 ), 1.0f / ( 9 * 19 ), 1.0f / ( 10 * 21 ), 1.0f / ( 11 * 23 ), s_flOnePlusMu / ( 12 * 25 ) };
+	static const float s_flV[12] = { 1.0f / 3, 2.0f / 5, 3.0f / 7, 4.0f / 9, 5.0f / 11, 6.0f / 13, 7.0f / 15, 8.0f / 17, 9.0f / 19, 10.0f / 21, 11.0f / 23, s_flOnePlusMu * 12 / 25 };
+
+	// take the short way round, which is what QuaternionAlign does
+	fltx4 cosOmega = Dot( p, q );
+	fltx4 sign = MaskedAssign( CmpLtSIMD( cosOmega, Four_Zeros ), Four_NegativeOnes, Four_Ones );
+	fltx4 xm1 = SubSIMD( MulSIMD( cosOmega, sign ), Four_Ones );
+
+	fltx4 d = SubSIMD( Four_Ones, t );
+	fltx4 sqrT = MulSIMD( t, t );
+	fltx4 sqrD = MulSIMD( d, d );
+
+	fltx4 cT = Four_Ones;
+	fltx4 cD = Four_Ones;
+	for ( int i = 11; i >= 0; i-- )
+	{
+		fltx4 u = ReplicateX4( s_flU[i] );
+		fltx4 v = ReplicateX4( s_flV[i] );
+		cT = MaddSIMD( MulSIMD( SubSIMD( MulSIMD( u, sqrT ), v ), xm1 ), cT, Four_Ones );
+		cD = MaddSIMD( MulSIMD( SubSIMD( MulSIMD( u, sqrD ), v ), xm1 ), cD, Four_Ones );
+	}
+	cT = MulSIMD( MulSIMD( cT, t ), sign );
+	cD = MulSIMD( cD, d );
+
+	return Madd( q, cT, Mul( p, cD ) );
+}
+
+static FORCEINLINE FourQuaternions BlendFourQuaternions( const FourQuaternions &p, const FourQuaternions &q, const fltx4 &t )
+{
+	return QuaternionNormalize( Madd( QuaternionAlign( p, q ), t, Mul( p, SubSIMD( Four_Ones, t ) ) ) );
+}
+
+template < FourQuaternions ( *KERNEL )( const FourQuaternions &, const FourQuaternions &, const fltx4 & ) >
+static void QuaternionPairsSIMD( const Quaternion *pP, const Quaternion *pQ, float t, int nCount, Quaternion *pOut )
+{
+	fltx4 t4 = ReplicateX4( t );
+	FourQuaternions p4, q4;
+
+	int i = 0;
+	for ( ; i + 4 <= nCount; i += 4 )
+	{
+		LoadFourQuaternions( pP + i, p4 );
+		LoadFourQuaternions( pQ + i, q4 );
+		StoreFourQuaternions( KERNEL( p4, q4, t4 ), pOut + i );
+	}
+
+	if ( i < nCount )
+	{
+		Quaternion p[4], q[4], out[4];
+		for ( int j = 0; j < 4; j++ )
+		{
+			p[j] = ( i + j < nCount ) ? pP[i + j] : quat_identity;
+			q[j] = ( i + j < nCount ) ? pQ[i + j] : quat_identity;
+		}
+
+		LoadFourQuaternions( p, p4 );
+		LoadFourQuaternions( q, q4 );
+		StoreFourQuaternions( KERNEL( p4, q4, t4 ), out );
+
+		for ( int j = 0; i + j < nCount; j++ )
+		{
+			pOut[i + j] = out[j];
+		}
+	}
+}
+
+void QuaternionSlerps( const Quaternion *pP, const Quaternion *pQ, float t, int nCount, Quaternion *pOut )
+{
+	QuaternionPairsSIMD< SlerpFourQuaternions >( pP, pQ, t, nCount, pOut );
+}
+
+void QuaternionBlends( const Quaternion *pP, const Quaternion *pQ, float t, int nCount, Quaternion *pOut )
+{
+	QuaternionPairsSIMD< BlendFourQuaternions >( pP, pQ, t, nCount, pOut );
+}
+
+// Same terms as QuaternionMatrix, each row goes out with the position as its fourth column
+static FORCEINLINE void FourQuaternionMatrices( const FourQuaternions &q, const FourVectors &pos, matrix3x4a_t *pOut )
+{
+	fltx4 x2 = AddSIMD( q.x, q.x );
+	fltx4 y2 = AddSIMD( q.y, q.y );
+	fltx4 z2 = AddSIMD( q.z, q.z );
+	fltx4 xx = MulSIMD( q.x, x2 ), xy = MulSIMD( q.x, y2 ), xz = MulSIMD( q.x, z2 );
+	fltx4 yy = MulSIMD( q.y, y2 ), yz = MulSIMD( q.y, z2 ), zz = MulSIMD( q.z, z2 );
+	fltx4 wx = MulSIMD( q.w, x2 ), wy = MulSIMD( q.w, y2 ), wz = MulSIMD( q.w, z2 );
+
+	fltx4 rows[3][4];
+	rows[0][0] = SubSIMD( Four_Ones, AddSIMD( yy, zz ) );
+	rows[0][1] = SubSIMD( xy, wz );
+	rows[0][2] = AddSIMD( xz, wy );
+	rows[0][3] = pos.x;
+	rows[1][0] = AddSIMD( xy, wz );
+	rows[1][1] = SubSIMD( Four_Ones, AddSIMD( xx, zz ) );
+	rows[1][2] = SubSIMD( yz, wx );
+	rows[1][3] = pos.y;
+	rows[2][0] = SubSIMD( xz, wy );
+	rows[2][1] = AddSIMD( yz, wx );
+	rows[2][2] = SubSIMD( Four_Ones, AddSIMD( xx, yy ) );
+	rows[2][3] = pos.z;
+
+	for ( int r = 0; r < 3; r++ )
+	{
+		TransposeSIMD( rows[r][0], rows[r][1], rows[r][2], rows[r][3] );
+		for ( int j = 0; j < 4; j++ )
+		{
+			StoreAlignedSIMD( pOut[j].m_flMatVal[r], rows[r][j] );
+		}
+	}
+}
+
+void QuaternionMatrices( const Quaternion *pQ, const Vector *pPos, int nCount, matrix3x4a_t *pOut )
+{
+	FourQuaternions q4;
+	FourVectors pos4;
+
+	int i = 0;
+	for ( ; i + 4 <= nCount; i += 4 )
+	{
+		LoadFourQuaternions( pQ + i, q4 );
+		pos4.LoadAndSwizzle( pPos[i], pPos[i + 1], pPos[i + 2], pPos[i + 3] );
+		FourQuaternionMatrices( q4, pos4, pOut + i );
+	}
+
+	if ( i < nCount )
+	{
+		Quaternion q[4];
+		Vector pos[4];
+		matrix3x4a_t out[4];
+		for ( int j = 0; j < 4; j++ )
+		{
+			q[j] = ( i + j < nCount ) ? pQ[i + j] : quat_identity;
+			pos[j] = ( i + j < nCount ) ? pPos[i + j] : vec3_origin;
+		}
+
+		LoadFourQuaternions( q, q4 );
+		pos4.LoadAndSwizzle( pos[0], pos[1], pos[2], pos[3] );
+		FourQuaternionMatrices( q4, pos4, out );
+
+		for ( int j = 0; i + j < nCount; j++ )
+		{
+			pOut[i + j] = out[j];
+		}
+	}
+}
+
+void ConcatBoneTransforms( const matrix3x4a_t &rootTransform, const matrix3x4a_t *pLocal, const int *pParents, int nBones, matrix3x4a_t *pOut )
+{
+	// ConcatTransforms_Aligned reads both inputs before writing, so pLocal == pOut is fine
+	for ( int i = 0; i < nBones; i++ )
+	{
+		int nParent = pParents[i];
+		Assert( nParent < i );
+		ConcatTransforms_Aligned( ( nParent >= 0 ) ? pOut[nParent] : rootTransform, pLocal[i], pOut[i] );
+	}
+}
+
+
 const Vector Quaternion::GetForward()const
 {
 	Vector vAxisX;
@@ -3645,6 +3872,121 @@ void ITransformAABB( const matrix3x4_t& transform, const Vector &vecMinsIn, cons
 }
 
 
+//-----------------------------------------------------------------------------
+// Batched TransformAABB. m holds the matrix elements, either the same for all
+// four lanes or transposed from four matrices; the arithmetic is done in the same
+// order as TransformAABB so every lane gets exactly its result.
+//-----------------------------------------------------------------------------
+static FORCEINLINE void TransformFourAABBs( const fltx4 m[3][4], const FourVectors &mins, const FourVectors &maxs, FourVectors &minsOut, FourVectors &maxsOut )
+{
+	fltx4 half = ReplicateX4( 0.5f );
+	FourVectors center, extents;
+	center.x = MulSIMD( AddSIMD( mins.x, maxs.x ), half );
+	center.y = MulSIMD( AddSIMD( mins.y, maxs.y ), half );
+	center.z = MulSIMD( AddSIMD( mins.z, maxs.z ), half );
+	extents.x = SubSIMD( maxs.x, center.x );
+	extents.y = SubSIMD( maxs.y, center.y );
+	extents.z = SubSIMD( maxs.z, center.z );
+
+	for ( int r = 0; r < 3; r++ )
+	{
+		fltx4 worldCenter = AddSIMD( AddSIMD( AddSIMD( MulSIMD( center.x, m[r][0] ), MulSIMD( center.y, m[r][1] ) ), MulSIMD( center.z, m[r][2] ) ), m[r][3] );
+		fltx4 worldExtents = AddSIMD( AddSIMD( fabs( MulSIMD( extents.x, m[r][0] ) ), fabs( MulSIMD( extents.y, m[r][1] ) ) ), fabs( MulSIMD( extents.z, m[r][2] ) ) );
+		minsOut[r] = SubSIMD( worldCenter, worldExtents );
+		maxsOut[r] = AddSIMD( worldCenter, worldExtents );
+	}
+}
+
+static SIMD8_TARGET int TransformAABBs_SIMD8( const matrix3x4_t &transform, const FourVectors *pMinsIn, const FourVectors *pMaxsIn, int nGroups, FourVectors *pMinsOut, FourVectors *pMaxsOut )
+{
+	fltx8 m[3][4];
+	for ( int r = 0; r < 3; r++ )
+	{
+		for ( int c = 0; c < 4; c++ )
+		{
+			m[r][c] = ReplicateX8( transform[r][c] );
+		}
+	}
+
+	fltx8 half = ReplicateX8( 0.5f );
+
+	int g = 0;
+	for ( ; g + 2 <= nGroups; g += 2 )
+	{
+		fltx8 center[3], extents[3];
+		for ( int c = 0; c < 3; c++ )
+		{
+			fltx8 mins = CombineSIMD8( pMinsIn[g][c], pMinsIn[g + 1][c] );
+			fltx8 maxs = CombineSIMD8( pMaxsIn[g][c], pMaxsIn[g + 1][c] );
+			center[c] = MulSIMD( AddSIMD( mins, maxs ), half );
+			extents[c] = SubSIMD( maxs, center[c] );
+		}
+
+		for ( int r = 0; r < 3; r++ )
+		{
+			fltx8 worldCenter = AddSIMD( AddSIMD( AddSIMD( MulSIMD( center[0], m[r][0] ), MulSIMD( center[1], m[r][1] ) ), MulSIMD( center[2], m[r][2] ) ), m[r][3] );
+			fltx8 worldExtents = AddSIMD( AddSIMD( AbsSIMD( MulSIMD( extents[0], m[r][0] ) ), AbsSIMD( MulSIMD( extents[1], m[r][1] ) ) ), AbsSIMD( MulSIMD( extents[2], m[r][2] ) ) );
+			fltx8 mins = SubSIMD( worldCenter, worldExtents );
+			fltx8 maxs = AddSIMD( worldCenter, worldExtents );
+			pMinsOut[g][r] = LowerSIMD( mins );
+			pMinsOut[g + 1][r] = UpperSIMD( mins );
+			pMaxsOut[g][r] = LowerSIMD( maxs );
+			pMaxsOut[g + 1][r] = UpperSIMD( maxs );
+		}
+	}
+
+	return g;
+}
+
+void TransformAABBs( const matrix3x4_t &transform, const FourVectors *pMinsIn, const FourVectors *pMaxsIn, int nBoxes, FourVectors *pMinsOut, FourVectors *pMaxsOut )
+{
+	int nGroups = ( nBoxes + 3 ) >> 2;
+
+	int g = 0;
+	if ( MathLib_SIMD8Enabled() )
+		g = TransformAABBs_SIMD8( transform, pMinsIn, pMaxsIn, nGroups, pMinsOut, pMaxsOut );
+
+	fltx4 m[3][4];
+	for ( int r = 0; r < 3; r++ )
+	{
+		for ( int c = 0; c < 4; c++ )
+		{
+			m[r][c] = ReplicateX4( transform[r][c] );
+		}
+	}
+
+	for ( ; g < nGroups; g++ )
+	{
+		TransformFourAABBs( m, pMinsIn[g], pMaxsIn[g], pMinsOut[g], pMaxsOut[g] );
+	}
+}
+
+void TransformAABBs( const matrix3x4_t *pTransforms, const FourVectors *pMinsIn, const FourVectors *pMaxsIn, int nBoxes, FourVectors *pMinsOut, FourVectors *pMaxsOut )
+{
+	for ( int i = 0; i < nBoxes; i += 4 )
+	{
+		// the lanes past the last box reuse its matrix instead of reading off the end
+		const matrix3x4_t &m0 = pTransforms[i];
+		const matrix3x4_t &m1 = pTransforms[MIN( i + 1, nBoxes - 1 )];
+		const matrix3x4_t &m2 = pTransforms[MIN( i + 2, nBoxes - 1 )];
+		const matrix3x4_t &m3 = pTransforms[MIN( i + 3, nBoxes - 1 )];
+
+		fltx4 m[3][4];
+		for ( int r = 0; r < 3; r++ )
+		{
+			m[r][0] = LoadUnalignedSIMD( m0[r] );
+			m[r][1] = LoadUnalignedSIMD( m1[r] );
+			m[r][2] = LoadUnalignedSIMD( m2[r] );
+			m[r][3] = LoadUnalignedSIMD( m3[r] );
+			TransposeSIMD( m[r][0], m[r][1], m[r][2], m[r][3] );
+		}
+
+		int g = i >> 2;
+		TransformFourAABBs( m, pMinsIn[g], pMaxsIn[g], pMinsOut[g], pMaxsOut[g] );
+	}
+}
+
+
 //-----------------------------------------------------------------------------
 // Rotates a AABB into another space; which will inherently grow the box. 
 // (same as TransformAABB, but doesn't take the translation into account)
@@ -4052,6 +4394,24 @@ bool MathLib_SSE2Enabled( void )
 	return true;
 }
 
+static bool s_bSIMD8Enabled = true;
+
+bool MathLib_SIMD8Enabled( void )
+{
+#if USE_EMULATED_SIMD8
+	return s_bSIMD8Enabled;
+#else
+	// detected on first use rather than in MathLib_Init, tools call into mathlib without it
+	static bool s_bAVX2 = CheckAVX2Technology();
+	return s_bAVX2 && s_bSIMD8Enabled;
+#endif
+}
+
+void MathLib_SetSIMD8Enabled( bool bEnable )
+{
+	s_bSIMD8Enabled = bEnable;
+}
+
 
 // BUGBUG: Why doesn't this call angle diff?!?!?
 float ApproachAngle( float target, float value, float speed )
@@ -5041,6 +5401,185 @@ bool Frustum_t::CullBoxCenterExtents( const fltx4 &fl4Center, const fltx4 &fl4Ex
 	return false;
 }
 
+//-----------------------------------------------------------------------------
+// Batched culling. A box is outside when its corner farthest along a plane's
+// normal is still behind it; which of mins/maxs gives that corner depends only
+// on the plane, so it is picked once per call and each group of boxes costs a
+// dot product per plane. The arithmetic is the same as CullBox's, lane for lane.
+//-----------------------------------------------------------------------------
+struct CullingPlane_t
+{
+	float m_flNormal[3];
+	float m_flNormalAbs[3];
+	float m_flDist;
+	const FourVectors *m_pFar[3];
+};
+
+// The unused slots of planes[1] have a zero normal and distance and never cull anything
+static int GetCullingPlanes( const Frustum_t &frustum, const FourVectors *pMins, const FourVectors *pMaxs, CullingPlane_t *pPlanes )
+{
+	int nPlanes = 0;
+	for ( int i = 0; i < 8; i++ )
+	{
+		const fourplanes_t &planes = frustum.planes[i >> 2];
+
+		CullingPlane_t &plane = pPlanes[nPlanes];
+		plane.m_flNormal[0] = SubFloat( planes.nX, i & 3 );
+		plane.m_flNormal[1] = SubFloat( planes.nY, i & 3 );
+		plane.m_flNormal[2] = SubFloat( planes.nZ, i & 3 );
+		plane.m_flDist = SubFloat( planes.dist, i & 3 );
+
+		if ( plane.m_flNormal[0] == 0.0f && plane.m_flNormal[1] == 0.0f && plane.m_flNormal[2] == 0.0f && plane.m_flDist <= 0.0f )
+			continue;
+
+		for ( int c = 0; c < 3; c++ )
+		{
+			plane.m_flNormalAbs[c] = fabsf( plane.m_flNormal[c] );
+			plane.m_pFar[c] = plane.m_flNormal[c] < 0.0f ? pMins : pMaxs;
+		}
+
+		nPlanes++;
+	}
+
+	return nPlanes;
+}
+
+static FORCEINLINE int CullFourBoxes( const CullingPlane_t *pPlanes, int nPlanes, int g )
+{
+	bi32x4 culled = (bi32x4)Four_Zeros;
+	for ( int i = 0; i < nPlanes; i++ )
+	{
+		const CullingPlane_t &plane = pPlanes[i];
+		fltx4 xTotalBack = MulSIMD( ReplicateX4( plane.m_flNormal[0] ), plane.m_pFar[0][g].x );
+		fltx4 yTotalBack = MulSIMD( ReplicateX4( plane.m_flNormal[1] ), plane.m_pFar[1][g].y );
+		fltx4 zTotalBack = MulSIMD( ReplicateX4( plane.m_flNormal[2] ), plane.m_pFar[2][g].z );
+		fltx4 dotBack = AddSIMD( xTotalBack, AddSIMD( yTotalBack, zTotalBack ) );
+		culled = OrSIMD( culled, CmpLtSIMD( dotBack, ReplicateX4( plane.m_flDist ) ) );
+	}
+
+	return TestSignSIMD( culled );
+}
+
+static FORCEINLINE int CullFourBoxesCenterExtents( const CullingPlane_t *pPlanes, int nPlanes, const FourVectors &center, const FourVectors &extents )
+{
+	bi32x4 culled = (bi32x4)Four_Zeros;
+	for ( int i = 0; i < nPlanes; i++ )
+	{
+		const CullingPlane_t &plane = pPlanes[i];
+		fltx4 xTotalBack = AddSIMD( MulSIMD( ReplicateX4( plane.m_flNormal[0] ), center.x ), MulSIMD( ReplicateX4( plane.m_flNormalAbs[0] ), extents.x ) );
+		fltx4 yTotalBack = AddSIMD( MulSIMD( ReplicateX4( plane.m_flNormal[1] ), center.y ), MulSIMD( ReplicateX4( plane.m_flNormalAbs[1] ), extents.y ) );
+		fltx4 zTotalBack = AddSIMD( MulSIMD( ReplicateX4( plane.m_flNormal[2] ), center.z ), MulSIMD( ReplicateX4( plane.m_flNormalAbs[2] ), extents.z ) );
+		fltx4 dotBack = AddSIMD( xTotalBack, AddSIMD( yTotalBack, zTotalBack ) );
+		culled = OrSIMD( culled, CmpLtSIMD( dotBack, ReplicateX4( plane.m_flDist ) ) );
+	}
+
+	return TestSignSIMD( culled );
+}
+
+static SIMD8_TARGET int CullBoxes_SIMD8( const CullingPlane_t *pPlanes, int nPlanes, int nGroups, uint32 *pCulled )
+{
+	int g = 0;
+	for ( ; g + 2 <= nGroups; g += 2 )
+	{
+		bi32x8 culled = LoadZeroSIMD8();
+		for ( int i = 0; i < nPlanes; i++ )
+		{
+			const CullingPlane_t &plane = pPlanes[i];
+			fltx8 xTotalBack = MulSIMD( ReplicateX8( plane.m_flNormal[0] ), CombineSIMD8( plane.m_pFar[0][g].x, plane.m_pFar[0][g + 1].x ) );
+			fltx8 yTotalBack = MulSIMD( ReplicateX8( plane.m_flNormal[1] ), CombineSIMD8( plane.m_pFar[1][g].y, plane.m_pFar[1][g + 1].y ) );
+			fltx8 zTotalBack = MulSIMD( ReplicateX8( plane.m_flNormal[2] ), CombineSIMD8( plane.m_pFar[2][g].z, plane.m_pFar[2][g + 1].z ) );
+			fltx8 dotBack = AddSIMD( xTotalBack, AddSIMD( yTotalBack, zTotalBack ) );
+			culled = OrSIMD( culled, CmpLtSIMD( dotBack, ReplicateX8( plane.m_flDist ) ) );
+		}
+
+		pCulled[g >> 3] |= ( uint32 )TestSignSIMD( culled ) << ( ( g & 7 ) * 4 );
+	}
+
+	return g;
+}
+
+static SIMD8_TARGET int CullBoxesCenterExtents_SIMD8( const CullingPlane_t *pPlanes, int nPlanes, const FourVectors *pCenters, const FourVectors *pExtents, int nGroups, uint32 *pCulled )
+{
+	int g = 0;
+	for ( ; g + 2 <= nGroups; g += 2 )
+	{
+		EightVectors center, extents;
+		center.LoadFourVectors( pCenters[g], pCenters[g + 1] );
+		extents.LoadFourVectors( pExtents[g], pExtents[g + 1] );
+
+		bi32x8 culled = LoadZeroSIMD8();
+		for ( int i = 0; i < nPlanes; i++ )
+		{
+			const CullingPlane_t &plane = pPlanes[i];
+			fltx8 xTotalBack = AddSIMD( MulSIMD( ReplicateX8( plane.m_flNormal[0] ), center.x ), MulSIMD( ReplicateX8( plane.m_flNormalAbs[0] ), extents.x ) );
+			fltx8 yTotalBack = AddSIMD( MulSIMD( ReplicateX8( plane.m_flNormal[1] ), center.y ), MulSIMD( ReplicateX8( plane.m_flNormalAbs[1] ), extents.y ) );
+			fltx8 zTotalBack = AddSIMD( MulSIMD( ReplicateX8( plane.m_flNormal[2] ), center.z ), MulSIMD( ReplicateX8( plane.m_flNormalAbs[2] ), extents.z ) );
+			fltx8 dotBack = AddSIMD( xTotalBack, AddSIMD( yTotalBack, zTotalBack ) );
+			culled = OrSIMD( culled, CmpLtSIMD( dotBack, ReplicateX8( plane.m_flDist ) ) );
+		}
+
+		pCulled[g >> 3] |= ( uint32 )TestSignSIMD( culled ) << ( ( g & 7 ) * 4 );
+	}
+
+	return g;
+}
+
+// Clears the bits past the last box and counts the rest
+static int FinishCullMask( int nBoxes, uint32 *pCulled )
+{
+	if ( nBoxes & 31 )
+		pCulled[nBoxes >> 5] &= ( 1u << ( nBoxes & 31 ) ) - 1;
+
+	int nCulled = 0;
+	for ( int i = 0; i < ( nBoxes + 31 ) >> 5; i++ )
+	{
+		for ( uint32 nBits = pCulled[i]; nBits; nBits &= nBits - 1 )
+			nCulled++;
+	}
+
+	return nCulled;
+}
+
+int Frustum_t::CullBoxes( const FourVectors *pMins, const FourVectors *pMaxs, int nBoxes, uint32 *pCulled ) const
+{
+	CullingPlane_t cullingPlanes[8];
+	int nPlanes = GetCullingPlanes( *this, pMins, pMaxs, cullingPlanes );
+	int nGroups = ( nBoxes + 3 ) >> 2;
+
+	memset( pCulled, 0, ( ( nBoxes + 31 ) >> 5 ) * sizeof( uint32 ) );
+
+	int g = 0;
+	if ( MathLib_SIMD8Enabled() )
+		g = CullBoxes_SIMD8( cullingPlanes, nPlanes, nGroups, pCulled );
+
+	for ( ; g < nGroups; g++ )
+	{
+		pCulled[g >> 3] |= ( uint32 )CullFourBoxes( cullingPlanes, nPlanes, g ) << ( ( g & 7 ) * 4 );
+	}
+
+	return FinishCullMask( nBoxes, pCulled );
+}
+
+int Frustum_t::CullBoxesCenterExtents( const FourVectors *pCenters, const FourVectors *pExtents, int nBoxes, uint32 *pCulled ) const
+{
+	CullingPlane_t cullingPlanes[8];
+	int nPlanes = GetCullingPlanes( *this, pCenters, pCenters, cullingPlanes );
+	int nGroups = ( nBoxes + 3 ) >> 2;
+
+	memset( pCulled, 0, ( ( nBoxes + 31 ) >> 5 ) * sizeof( uint32 ) );
+
+	int g = 0;
+	if ( MathLib_SIMD8Enabled() )
+		g = CullBoxesCenterExtents_SIMD8( cullingPlanes, nPlanes, pCenters, pExtents, nGroups, pCulled );
+
+	for ( ; g < nGroups; g++ )
+	{
+		pCulled[g >> 3] |= ( uint32 )CullFourBoxesCenterExtents( cullingPlanes, nPlanes, pCenters[g], pExtents[g] ) << ( ( g & 7 ) * 4 );
+	}
+
+	return FinishCullMask( nBoxes, pCulled );
+}
+
 // Return true if this bounding volume is contained in the frustum, false if it is not
 // TODO SIMDIFY
 bool Frustum_t::Contains( const Vector &mins, const Vector &maxs ) const
@@ -8,6 +8,7 @@
 
 #include "mathlib/polyhedron.h"
 #include "mathlib/vmatrix.h"
+#include "mathlib/ssemath.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include "tier1/utlvector.h"
@@ -2009,6 +2010,839 @@ CPolyhedron *GeneratePolyhedronFromPlanes( const float *pOutwardFacingPlanes, in
 
 
 
+//-----------------------------------------------------------------------------
+// Reentrant clipper. Every bit of state lives in the CPolyhedronClipScratch.
+//-----------------------------------------------------------------------------
+enum PolyhedronClipPointState_t
+{
+	CLIPPOINT_DEAD,
+	CLIPPOINT_ONPLANE,
+	CLIPPOINT_ALIVE
+};
+
+enum PolyhedronClipResult_t
+{
+	CLIP_RESULT_ALL_DEAD,
+	CLIP_RESULT_UNTOUCHED,
+	CLIP_RESULT_CUT
+};
+
+class CPolyhedronClipper
+{
+public:
+	CPolyhedronClipper( CPolyhedronClipScratch &scratch ) : m_Scratch( scratch ), m_iPointCount( 0 ), m_iCurrent( 0 ), m_iEdgeHashShift( 32 ) {}
+
+	void InitBox( const Vector &vMins, const Vector &vMaxs );
+	void InitFromPolyhedron( const CPolyhedron *pPolyhedron );
+
+	PolyhedronClipResult_t ClipByPlane( const float *pOutwardFacingPlane, float fOnPlaneEpsilon );
+	CPolyhedron *CreatePolyhedron( bool bUseScratchMemory );
+
+	//the scratch's own output polyhedron or a CPolyhedron_AllocByNew, with the arrays laid out but not filled in
+	static CPolyhedron *AllocateOutput( CPolyhedronClipScratch &scratch, bool bUseScratchMemory, int iVertices, int iLines, int iIndices, int iPolygons );
+	//a straight copy into the same kind of memory, for clips that don't cut anything
+	static CPolyhedron *CopyPolyhedron( CPolyhedronClipScratch &scratch, bool bUseScratchMemory, const CPolyhedron *pPolyhedron );
+
+private:
+	void EnsurePointCapacity( int iPointCount );
+	int ClassifyPoints( const Vector &vNormal, float fPlaneDist, float fOnPlaneEpsilon, int *pAliveCount );
+	void ResetEdgeHash( int iMinEntries );
+	int *FindOrAddEdge( uint32 iKey, bool *pAdded );
+	int FindEdge( uint32 iKey ) const;
+	int CutEdge( int iLivingPoint, int iDeadPoint );
+	void AddCapPolygonsFromEdgeHash( const Vector &vNormal );
+	void AddCapPolygons( const Vector &vNormal, int iFirstPoint, int iCapEdges );
+	void CompactPoints( int iOldPointCount );
+
+	static uint32 EdgeKey( int iFrom, int iTo ) { return ( (uint32)iFrom << 16 ) | (uint32)iTo; }
+
+	CPolyhedronClipScratch &m_Scratch;
+	int m_iPointCount; //the per point arrays in the scratch are only used as storage, they're always at least this big (rounded up to 4)
+	int m_iCurrent; //which of the double buffered polygon lists is current
+	int m_iEdgeHashShift; //32 - log2( edge hash size ), the hash is the top bits of a multiplicative hash
+};
+
+CPolyhedronClipScratch::CPolyhedronClipScratch( void ) : m_iEdgeHashGeneration( 0 )
+{
+	m_OutputPolyhedron.pVertices = NULL;
+	m_OutputPolyhedron.pLines = NULL;
+	m_OutputPolyhedron.pIndices = NULL;
+	m_OutputPolyhedron.pPolygons = NULL;
+	m_OutputPolyhedron.iVertexCount = 0;
+	m_OutputPolyhedron.iLineCount = 0;
+	m_OutputPolyhedron.iIndexCount = 0;
+	m_OutputPolyhedron.iPolygonCount = 0;
+}
+
+void CPolyhedronClipScratch::Purge( void )
+{
+	m_PointsX.Purge();
+	m_PointsY.Purge();
+	m_PointsZ.Purge();
+	m_PointDists.Purge();
+	m_PointStates.Purge();
+	m_PointRemap.Purge();
+	for( int i = 0; i != 2; ++i )
+	{
+		m_Polygons[i].Purge();
+		m_PolygonLoops[i].Purge();
+	}
+	m_EdgeHash.Purge();
+	m_iEdgeHashGeneration = 0;
+	m_Lines.Purge();
+	m_LineReferences.Purge();
+	m_OutputBuffer.Purge();
+
+	m_OutputPolyhedron.pVertices = NULL;
+	m_OutputPolyhedron.pLines = NULL;
+	m_OutputPolyhedron.pIndices = NULL;
+	m_OutputPolyhedron.pPolygons = NULL;
+	m_OutputPolyhedron.iVertexCount = m_OutputPolyhedron.iLineCount = m_OutputPolyhedron.iIndexCount = m_OutputPolyhedron.iPolygonCount = 0;
+}
+
+void CPolyhedronClipper::EnsurePointCapacity( int iPointCount )
+{
+	//padded to a whole number of fltx4s, the extra lanes are never looked at
+	int iPaddedCount = ALIGN_VALUE( iPointCount, 4 );
+	if( m_Scratch.m_PointsX.Count() >= iPaddedCount )
+		return;
+
+	iPaddedCount = ALIGN_VALUE( MAX( iPaddedCount, m_Scratch.m_PointsX.Count() * 2 ), 4 );
+	m_Scratch.m_PointsX.SetCountNonDestructively( iPaddedCount );
+	m_Scratch.m_PointsY.SetCountNonDestructively( iPaddedCount );
+	m_Scratch.m_PointsZ.SetCountNonDestructively( iPaddedCount );
+	m_Scratch.m_PointDists.SetCountNonDestructively( iPaddedCount );
+	m_Scratch.m_PointStates.SetCountNonDestructively( iPaddedCount );
+	m_Scratch.m_PointRemap.SetCountNonDestructively( iPaddedCount );
+}
+
+void CPolyhedronClipper::InitBox( const Vector &vMins, const Vector &vMaxs )
+{
+	//same corner numbering and polygon order as the starting box of GeneratePolyhedronFromPlanes above
+	static const int s_BoxLoops[6][4] = 
+	{
+		{ 3, 2, 0, 1 },
+		{ 7, 3, 1, 5 },
+		{ 6, 7, 5, 4 },
+		{ 2, 6, 4, 0 },
+		{ 3, 7, 6, 2 },
+		{ 4, 5, 1, 0 },
+	};
+	static const float s_BoxNormals[6][3] = 
+	{
+		{ -1.0f, 0.0f, 0.0f },
+		{ 0.0f, 1.0f, 0.0f },
+		{ 1.0f, 0.0f, 0.0f },
+		{ 0.0f, -1.0f, 0.0f },
+		{ 0.0f, 0.0f, 1.0f },
+		{ 0.0f, 0.0f, -1.0f },
+	};
+
+	m_iPointCount = 8;
+	EnsurePointCapacity( m_iPointCount );
+
+	float *pX = m_Scratch.m_PointsX.Base();
+	float *pY = m_Scratch.m_PointsY.Base();
+	float *pZ = m_Scratch.m_PointsZ.Base();
+	for( int i = 0; i != 8; ++i )
+	{
+		pX[i] = (i & 4) ? vMaxs.x : vMins.x;
+		pY[i] = (i & 1) ? vMaxs.y : vMins.y;
+		pZ[i] = (i & 2) ? vMaxs.z : vMins.z;
+	}
+
+	m_iCurrent = 0;
+	m_Scratch.m_Polygons[0].SetCountNonDestructively( 6 );
+	m_Scratch.m_PolygonLoops[0].SetCountNonDestructively( 24 );
+
+	CPolyhedronClipScratch::Polygon_t *pPolygons = m_Scratch.m_Polygons[0].Base();
+	int *pLoops = m_Scratch.m_PolygonLoops[0].Base();
+	for( int i = 0; i != 6; ++i )
+	{
+		pPolygons[i].vNormal.Init( s_BoxNormals[i][0], s_BoxNormals[i][1], s_BoxNormals[i][2] );
+		pPolygons[i].iFirstIndex = i * 4;
+		pPolygons[i].iIndexCount = 4;
+		for( int j = 0; j != 4; ++j )
+			pLoops[(i * 4) + j] = s_BoxLoops[i][j];
+	}
+}
+
+void CPolyhedronClipper::InitFromPolyhedron( const CPolyhedron *pPolyhedron )
+{
+	//copy everything out first, pPolyhedron may live in the scratch's output buffer
+	m_iPointCount = pPolyhedron->iVertexCount;
+	EnsurePointCapacity( m_iPointCount );
+
+	float *pX = m_Scratch.m_PointsX.Base();
+	float *pY = m_Scratch.m_PointsY.Base();
+	float *pZ = m_Scratch.m_PointsZ.Base();
+	for( int i = 0; i != m_iPointCount; ++i )
+	{
+		pX[i] = pPolyhedron->pVertices[i].x;
+		pY[i] = pPolyhedron->pVertices[i].y;
+		pZ[i] = pPolyhedron->pVertices[i].z;
+	}
+
+	m_iCurrent = 0;
+	CUtlVector<CPolyhedronClipScratch::Polygon_t> &polygons = m_Scratch.m_Polygons[0];
+	CUtlVector<int> &loops = m_Scratch.m_PolygonLoops[0];
+	polygons.SetCountNonDestructively( pPolyhedron->iPolygonCount );
+	loops.SetCountNonDestructively( pPolyhedron->iIndexCount );
+
+	CPolyhedronClipScratch::Polygon_t *pPolygons = polygons.Base();
+	int *pLoops = loops.Base();
+	for( int i = 0; i != pPolyhedron->iPolygonCount; ++i )
+	{
+		const Polyhedron_IndexedPolygon_t &polygon = pPolyhedron->pPolygons[i];
+		pPolygons[i].vNormal = polygon.polyNormal;
+		pPolygons[i].iFirstIndex = polygon.iFirstIndex;
+		pPolygons[i].iIndexCount = polygon.iIndexCount;
+
+		//each line reference runs from the start point to pPoints[iEndPointIndex], so the loop is the start points in order
+		for( int j = 0; j != polygon.iIndexCount; ++j )
+		{
+			const Polyhedron_IndexedLineReference_t &reference = pPolyhedron->pIndices[polygon.iFirstIndex + j];
+			pLoops[polygon.iFirstIndex + j] = pPolyhedron->pLines[reference.iLineIndex].iPointIndices[1 - reference.iEndPointIndex];
+		}
+	}
+}
+
+int CPolyhedronClipper::ClassifyPoints( const Vector &vNormal, float fPlaneDist, float fOnPlaneEpsilon, int *pAliveCount )
+{
+	static const int s_iBitCounts[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+	const float *pX = m_Scratch.m_PointsX.Base();
+	const float *pY = m_Scratch.m_PointsY.Base();
+	const float *pZ = m_Scratch.m_PointsZ.Base();
+	float *pDists = m_Scratch.m_PointDists.Base();
+	unsigned char *pStates = m_Scratch.m_PointStates.Base();
+
+	const fltx4 fl4NormalX = ReplicateX4( vNormal.x );
+	const fltx4 fl4NormalY = ReplicateX4( vNormal.y );
+	const fltx4 fl4NormalZ = ReplicateX4( vNormal.z );
+	const fltx4 fl4PlaneDist = ReplicateX4( fPlaneDist );
+	const fltx4 fl4Epsilon = ReplicateX4( fOnPlaneEpsilon );
+	const fltx4 fl4NegativeEpsilon = ReplicateX4( -fOnPlaneEpsilon );
+
+	int iAliveCount = 0, iDeadCount = 0;
+	for( int i = 0; i < m_iPointCount; i += 4 )
+	{
+		fltx4 fl4Dist = MulSIMD( LoadUnalignedSIMD( pX + i ), fl4NormalX );
+		fl4Dist = MaddSIMD( LoadUnalignedSIMD( pY + i ), fl4NormalY, fl4Dist );
+		fl4Dist = MaddSIMD( LoadUnalignedSIMD( pZ + i ), fl4NormalZ, fl4Dist );
+		fl4Dist = SubSIMD( fl4Dist, fl4PlaneDist );
+		StoreUnalignedSIMD( pDists + i, fl4Dist );
+
+		//same tests as the linked version: dead is > epsilon, alive is <= -epsilon
+		const int iLaneMask = ( m_iPointCount - i >= 4 ) ? 0xF : ( ( 1 << ( m_iPointCount - i ) ) - 1 );
+		const int iDeadMask = TestSignSIMD( CmpGtSIMD( fl4Dist, fl4Epsilon ) ) & iLaneMask;
+		const int iAliveMask = TestSignSIMD( CmpLeSIMD( fl4Dist, fl4NegativeEpsilon ) ) & iLaneMask;
+
+		//CLIPPOINT_ONPLANE, plus one if alive or minus one if dead
+		for( int j = 0; j != 4; ++j )
+		{
+			pStates[i + j] = (unsigned char)( CLIPPOINT_ONPLANE + ( ( iAliveMask >> j ) & 1 ) - ( ( iDeadMask >> j ) & 1 ) );
+		}
+
+		iAliveCount += s_iBitCounts[iAliveMask];
+		iDeadCount += s_iBitCounts[iDeadMask];
+	}
+
+	*pAliveCount = iAliveCount;
+	return iDeadCount;
+}
+
+void CPolyhedronClipper::ResetEdgeHash( int iMinEntries )
+{
+	CUtlVector<CPolyhedronClipScratch::EdgeHashEntry_t> &edgeHash = m_Scratch.m_EdgeHash;
+
+	//the table only ever grows, a bigger one than needed costs nothing since it isn't cleared
+	if( edgeHash.Count() < iMinEntries * 2 )
+	{
+		int iSize = MAX( edgeHash.Count(), 64 );
+		while( iSize < iMinEntries * 2 )
+			iSize <<= 1;
+
+		edgeHash.SetCountNonDestructively( iSize );
+		m_Scratch.m_iEdgeHashGeneration = 0;
+	}
+
+	if( ++m_Scratch.m_iEdgeHashGeneration == 1 ) //fresh table or the generation wrapped around
+	{
+		memset( edgeHash.Base(), 0, edgeHash.Count() * sizeof( CPolyhedronClipScratch::EdgeHashEntry_t ) );
+		m_Scratch.m_iEdgeHashGeneration = 1;
+	}
+
+	m_iEdgeHashShift = 32;
+	for( int iSize = edgeHash.Count(); iSize > 1; iSize >>= 1 )
+		--m_iEdgeHashShift;
+}
+
+int *CPolyhedronClipper::FindOrAddEdge( uint32 iKey, bool *pAdded )
+{
+	CPolyhedronClipScratch::EdgeHashEntry_t *pEntries = m_Scratch.m_EdgeHash.Base();
+	const uint32 iMask = m_Scratch.m_EdgeHash.Count() - 1;
+	const uint32 iGeneration = m_Scratch.m_iEdgeHashGeneration;
+
+	for( uint32 iSlot = ( iKey * 2654435761u ) >> m_iEdgeHashShift; ; iSlot = ( iSlot + 1 ) & iMask )
+	{
+		CPolyhedronClipScratch::EdgeHashEntry_t &entry = pEntries[iSlot];
+		if( entry.iGeneration != iGeneration )
+		{
+			entry.iKey = iKey;
+			entry.iGeneration = iGeneration;
+			*pAdded = true;
+			return &entry.iValue;
+		}
+
+		if( entry.iKey == iKey )
+		{
+			*pAdded = false;
+			return &entry.iValue;
+		}
+	}
+}
+
+int CPolyhedronClipper::FindEdge( uint32 iKey ) const
+{
+	const CPolyhedronClipScratch::EdgeHashEntry_t *pEntries = m_Scratch.m_EdgeHash.Base();
+	const uint32 iMask = m_Scratch.m_EdgeHash.Count() - 1;
+	const uint32 iGeneration = m_Scratch.m_iEdgeHashGeneration;
+
+	for( uint32 iSlot = ( iKey * 2654435761u ) >> m_iEdgeHashShift; ; iSlot = ( iSlot + 1 ) & iMask )
+	{
+		const CPolyhedronClipScratch::EdgeHashEntry_t &entry = pEntries[iSlot];
+		if( entry.iGeneration != iGeneration )
+			return -1;
+
+		if( entry.iKey == iKey )
+			return entry.iValue;
+	}
+}
+
+int CPolyhedronClipper::CutEdge( int iLivingPoint, int iDeadPoint )
+{
+	//both polygons sharing the edge have to end up with the same new point
+	bool bAdded;
+	int *pNewPoint = FindOrAddEdge( EdgeKey( MIN( iLivingPoint, iDeadPoint ), MAX( iLivingPoint, iDeadPoint ) ), &bAdded );
+	if( bAdded )
+	{
+		//capacity for every possible new point was reserved before the cut started
+		float *pX = m_Scratch.m_PointsX.Base();
+		float *pY = m_Scratch.m_PointsY.Base();
+		float *pZ = m_Scratch.m_PointsZ.Base();
+		const float *pDists = m_Scratch.m_PointDists.Base();
+
+		float fInvTotalDist = 1.0f / ( pDists[iDeadPoint] - pDists[iLivingPoint] ); //subtraction because the living distance is known to be negative
+		float fT = -pDists[iLivingPoint] * fInvTotalDist;
+
+		*pNewPoint = m_iPointCount++;
+		pX[*pNewPoint] = pX[iLivingPoint] + ( pX[iDeadPoint] - pX[iLivingPoint] ) * fT;
+		pY[*pNewPoint] = pY[iLivingPoint] + ( pY[iDeadPoint] - pY[iLivingPoint] ) * fT;
+		pZ[*pNewPoint] = pZ[iLivingPoint] + ( pZ[iDeadPoint] - pZ[iLivingPoint] ) * fT;
+	}
+
+	return *pNewPoint;
+}
+
+void CPolyhedronClipper::AddCapPolygonsFromEdgeHash( const Vector &vNormal )
+{
+	const CUtlVector<CPolyhedronClipScratch::Polygon_t> &polygons = m_Scratch.m_Polygons[m_iCurrent];
+	const CUtlVector<int> &loops = m_Scratch.m_PolygonLoops[m_iCurrent];
+	const CPolyhedronClipScratch::Polygon_t *pPolygons = polygons.Base();
+	const int *pLoops = loops.Base();
+	const int iPolygonCount = polygons.Count();
+
+	//every edge of the clipped polygons whose reverse isn't also used is on the hole left by the cut
+	ResetEdgeHash( loops.Count() );
+	for( int i = 0; i != iPolygonCount; ++i )
+	{
+		const int *pLoop = pLoops + pPolygons[i].iFirstIndex;
+		const int iCount = pPolygons[i].iIndexCount;
+		for( int j = 0; j != iCount; ++j )
+		{
+			bool bAdded;
+			*FindOrAddEdge( EdgeKey( pLoop[j], pLoop[( j + 1 == iCount ) ? 0 : j + 1] ), &bAdded ) = 0;
+		}
+	}
+
+	int *pCapNext = m_Scratch.m_PointRemap.Base();
+	for( int i = 0; i != m_iPointCount; ++i )
+	{
+		pCapNext[i] = -1;
+	}
+
+	int iCapEdges = 0;
+	for( int i = 0; i != iPolygonCount; ++i )
+	{
+		const int *pLoop = pLoops + pPolygons[i].iFirstIndex;
+		const int iCount = pPolygons[i].iIndexCount;
+		for( int j = 0; j != iCount; ++j )
+		{
+			int iFrom = pLoop[j];
+			int iTo = pLoop[( j + 1 == iCount ) ? 0 : j + 1];
+			if( FindEdge( EdgeKey( iTo, iFrom ) ) < 0 )
+			{
+				pCapNext[iTo] = iFrom;
+				++iCapEdges;
+			}
+		}
+	}
+
+	AddCapPolygons( vNormal, 0, iCapEdges );
+}
+
+void CPolyhedronClipper::AddCapPolygons( const Vector &vNormal, int iFirstPoint, int iCapEdges )
+{
+	if( iCapEdges == 0 )
+		return;
+
+	//the cap walks each hole edge backwards (pCapNext[to] = from), so it winds the same way as the rest
+	CUtlVector<CPolyhedronClipScratch::Polygon_t> &polygons = m_Scratch.m_Polygons[m_iCurrent];
+	CUtlVector<int> &loops = m_Scratch.m_PolygonLoops[m_iCurrent];
+	int *pCapNext = m_Scratch.m_PointRemap.Base();
+	const int iLoopCount = loops.Count();
+
+	loops.SetCountNonDestructively( iLoopCount + iCapEdges );
+	int *pLoops = loops.Base();
+	int iWrite = iLoopCount;
+
+	for( int iStart = iFirstPoint; iStart != m_iPointCount; ++iStart )
+	{
+		if( pCapNext[iStart] < 0 )
+			continue;
+
+		CPolyhedronClipScratch::Polygon_t cap;
+		cap.vNormal = vNormal;
+		cap.iFirstIndex = iWrite;
+
+		int iPoint = iStart;
+		bool bClosed = false;
+		while( pCapNext[iPoint] >= 0 && iWrite != iLoopCount + iCapEdges )
+		{
+			pLoops[iWrite++] = iPoint;
+			int iNext = pCapNext[iPoint];
+			pCapNext[iPoint] = -1;
+			iPoint = iNext;
+
+			if( iPoint == iStart )
+			{
+				bClosed = true;
+				break;
+			}
+		}
+
+		cap.iIndexCount = iWrite - cap.iFirstIndex;
+		if( bClosed && cap.iIndexCount >= 3 )
+		{
+			polygons.AddToTail( cap );
+		}
+		else
+		{
+			AssertMsg( false, "Polyhedron clip left a hole that doesn't form a polygon, float imprecision is the likely culprit" );
+			iWrite = cap.iFirstIndex;
+		}
+	}
+
+	loops.SetCountNonDestructively( iWrite );
+}
+
+void CPolyhedronClipper::CompactPoints( int iOldPointCount )
+{
+	//Dead points are exactly the ones no polygon uses anymore. Surviving old points all still have a living polygon around them,
+	//	and every new point sits on an edge of one.
+	const unsigned char *pStates = m_Scratch.m_PointStates.Base();
+	int *pRemap = m_Scratch.m_PointRemap.Base();
+	float *pX = m_Scratch.m_PointsX.Base();
+	float *pY = m_Scratch.m_PointsY.Base();
+	float *pZ = m_Scratch.m_PointsZ.Base();
+
+	//nothing moves before the first dead point
+	int iKept = 0;
+	while( iKept != iOldPointCount && pStates[iKept] != CLIPPOINT_DEAD )
+	{
+		pRemap[iKept] = iKept;
+		++iKept;
+	}
+
+	for( int i = iKept; i != m_iPointCount; ++i )
+	{
+		if( i < iOldPointCount && pStates[i] == CLIPPOINT_DEAD )
+			continue;
+
+		pX[iKept] = pX[i];
+		pY[iKept] = pY[i];
+		pZ[iKept] = pZ[i];
+		pRemap[i] = iKept++;
+	}
+	m_iPointCount = iKept;
+
+	CUtlVector<int> &loops = m_Scratch.m_PolygonLoops[m_iCurrent];
+	int *pLoops = loops.Base();
+	const int iLoopCount = loops.Count();
+	for( int i = 0; i != iLoopCount; ++i )
+	{
+		pLoops[i] = pRemap[pLoops[i]];
+	}
+}
+
+PolyhedronClipResult_t CPolyhedronClipper::ClipByPlane( const float *pOutwardFacingPlane, float fOnPlaneEpsilon )
+{
+	const Vector vNormal( pOutwardFacingPlane[0], pOutwardFacingPlane[1], pOutwardFacingPlane[2] );
+
+	int iAliveCount;
+	int iDeadCount = ClassifyPoints( vNormal, pOutwardFacingPlane[3], fOnPlaneEpsilon, &iAliveCount );
+
+	if( iAliveCount == 0 )
+		return CLIP_RESULT_ALL_DEAD; //all the points either died or are on the plane, no polyhedron left at all
+
+	if( iDeadCount == 0 )
+		return CLIP_RESULT_UNTOUCHED;
+
+	const CUtlVector<CPolyhedronClipScratch::Polygon_t> &polygons = m_Scratch.m_Polygons[m_iCurrent];
+	const CUtlVector<int> &loops = m_Scratch.m_PolygonLoops[m_iCurrent];
+	const CPolyhedronClipScratch::Polygon_t *pPolygons = polygons.Base();
+	const int *pLoops = loops.Base();
+	const int iPolygonCount = polygons.Count();
+	const int iOldPointCount = m_iPointCount;
+	const bool bHasOnPlanePoints = ( iAliveCount + iDeadCount != m_iPointCount );
+
+	//every edge shows up twice in the loops, so that's how many new points the cut could add at most
+	const int iMaxPointCount = m_iPointCount + ( loops.Count() / 2 ) + 1;
+	EnsurePointCapacity( iMaxPointCount );
+	unsigned char *pStates = m_Scratch.m_PointStates.Base();
+	int *pCapNext = m_Scratch.m_PointRemap.Base();
+
+	if( bHasOnPlanePoints )
+	{
+		//On-plane points that aren't connected to a living point get downgraded to dead, the same as the linked version does.
+		//	Otherwise float imprecision can leave the shape *slightly* concave.
+		int *pHasLivingNeighbor = pCapNext;
+		for( int i = 0; i != m_iPointCount; ++i )
+		{
+			pHasLivingNeighbor[i] = 0;
+		}
+
+		for( int i = 0; i != iPolygonCount; ++i )
+		{
+			const int *pLoop = pLoops + pPolygons[i].iFirstIndex;
+			const int iCount = pPolygons[i].iIndexCount;
+			for( int j = 0; j != iCount; ++j )
+			{
+				int iFrom = pLoop[j];
+				int iTo = pLoop[( j + 1 == iCount ) ? 0 : j + 1];
+				pHasLivingNeighbor[iFrom] |= ( pStates[iTo] == CLIPPOINT_ALIVE );
+				pHasLivingNeighbor[iTo] |= ( pStates[iFrom] == CLIPPOINT_ALIVE );
+			}
+		}
+
+		for( int i = 0; i != m_iPointCount; ++i )
+		{
+			if( pStates[i] == CLIPPOINT_ONPLANE && !pHasLivingNeighbor[i] )
+				pStates[i] = CLIPPOINT_DEAD;
+		}
+	}
+	else
+	{
+		//Every point is strictly on one side, so each cut polygon leaves exactly one new edge between two new points
+		//	and the cap can be chained straight from those.
+		for( int i = m_iPointCount; i != iMaxPointCount; ++i )
+		{
+			pCapNext[i] = -1;
+		}
+	}
+
+	//Clip each polygon into the other buffer, new points on cut edges are shared through the edge hash.
+	//	A convex polygon gains at most one point from a cut.
+	const int iNext = 1 - m_iCurrent;
+	CUtlVector<CPolyhedronClipScratch::Polygon_t> &newPolygons = m_Scratch.m_Polygons[iNext];
+	CUtlVector<int> &newLoops = m_Scratch.m_PolygonLoops[iNext];
+	newPolygons.SetCountNonDestructively( iPolygonCount + 1 );
+	newLoops.SetCountNonDestructively( loops.Count() + iPolygonCount );
+	CPolyhedronClipScratch::Polygon_t *pNewPolygons = newPolygons.Base();
+	int *pNewLoops = newLoops.Base();
+	int iNewPolygonCount = 0;
+	int iWrite = 0;
+	int iCapEdges = 0;
+
+	ResetEdgeHash( loops.Count() );
+
+	for( int i = 0; i != iPolygonCount; ++i )
+	{
+		const int *pLoop = pLoops + pPolygons[i].iFirstIndex;
+		const int iCount = pPolygons[i].iIndexCount;
+		const int iFirstIndex = iWrite;
+
+		//most polygons aren't touched by the cut at all
+		bool bAlive = false, bCut = false;
+		for( int j = 0; j != iCount; ++j )
+		{
+			bAlive |= ( pStates[pLoop[j]] == CLIPPOINT_ALIVE );
+			bCut |= ( pStates[pLoop[j]] == CLIPPOINT_DEAD );
+		}
+
+		if( !bAlive )
+			continue; //either gone or lies in the cut plane, in which case the cap replaces it
+
+		if( !bCut )
+		{
+			memcpy( pNewLoops + iWrite, pLoop, iCount * sizeof( int ) );
+			iWrite += iCount;
+
+			CPolyhedronClipScratch::Polygon_t &newPolygon = pNewPolygons[iNewPolygonCount++];
+			newPolygon.vNormal = pPolygons[i].vNormal;
+			newPolygon.iFirstIndex = iFirstIndex;
+			newPolygon.iIndexCount = iCount;
+			continue;
+		}
+
+		int iExitPoint = -1, iEntryPoint = -1;
+		for( int j = 0; j != iCount; ++j )
+		{
+			int iFrom = pLoop[j];
+			int iTo = pLoop[( j + 1 == iCount ) ? 0 : j + 1];
+
+			if( pStates[iFrom] != CLIPPOINT_DEAD )
+			{
+				pNewLoops[iWrite++] = iFrom;
+			}
+
+			if( pStates[iFrom] == CLIPPOINT_ALIVE && pStates[iTo] == CLIPPOINT_DEAD )
+			{
+				iExitPoint = CutEdge( iFrom, iTo );
+				pNewLoops[iWrite++] = iExitPoint;
+			}
+			else if( pStates[iFrom] == CLIPPOINT_DEAD && pStates[iTo] == CLIPPOINT_ALIVE )
+			{
+				iEntryPoint = CutEdge( iTo, iFrom );
+				pNewLoops[iWrite++] = iEntryPoint;
+			}
+		}
+
+		if( iWrite - iFirstIndex >= 3 )
+		{
+			CPolyhedronClipScratch::Polygon_t &newPolygon = pNewPolygons[iNewPolygonCount++];
+			newPolygon.vNormal = pPolygons[i].vNormal;
+			newPolygon.iFirstIndex = iFirstIndex;
+			newPolygon.iIndexCount = iWrite - iFirstIndex;
+
+			//the new edge runs exit -> entry, the cap walks it backwards
+			if( iExitPoint >= 0 && !bHasOnPlanePoints )
+			{
+				pCapNext[iEntryPoint] = iExitPoint;
+				++iCapEdges;
+			}
+		}
+		else
+		{
+			iWrite = iFirstIndex;
+		}
+	}
+
+	newPolygons.SetCountNonDestructively( iNewPolygonCount );
+	newLoops.SetCountNonDestructively( iWrite );
+	m_iCurrent = iNext;
+
+	if( bHasOnPlanePoints )
+	{
+		AddCapPolygonsFromEdgeHash( vNormal );
+	}
+	else
+	{
+		AddCapPolygons( vNormal, iOldPointCount, iCapEdges );
+	}
+
+	CompactPoints( iOldPointCount );
+
+	return CLIP_RESULT_CUT;
+}
+
+CPolyhedron *CPolyhedronClipper::AllocateOutput( CPolyhedronClipScratch &scratch, bool bUseScratchMemory, int iVertices, int iLines, int iIndices, int iPolygons )
+{
+	if( !bUseScratchMemory )
+		return CPolyhedron_AllocByNew::Allocate( iVertices, iLines, iIndices, iPolygons );
+
+	CPolyhedron *pScratchPolyhedron = &scratch.m_OutputPolyhedron;
+	scratch.m_OutputBuffer.SetCountNonDestructively( (sizeof( Vector ) * iVertices) +
+													(sizeof( Polyhedron_IndexedLine_t ) * iLines) +
+													(sizeof( Polyhedron_IndexedLineReference_t ) * iIndices) +
+													(sizeof( Polyhedron_IndexedPolygon_t ) * iPolygons) );
+
+	pScratchPolyhedron->iVertexCount = iVertices;
+	pScratchPolyhedron->iLineCount = iLines;
+	pScratchPolyhedron->iIndexCount = iIndices;
+	pScratchPolyhedron->iPolygonCount = iPolygons;
+	pScratchPolyhedron->pVertices = (Vector *)scratch.m_OutputBuffer.Base();
+	pScratchPolyhedron->pLines = (Polyhedron_IndexedLine_t *)(pScratchPolyhedron->pVertices + iVertices);
+	pScratchPolyhedron->pIndices = (Polyhedron_IndexedLineReference_t *)(pScratchPolyhedron->pLines + iLines);
+	pScratchPolyhedron->pPolygons = (Polyhedron_IndexedPolygon_t *)(pScratchPolyhedron->pIndices + iIndices);
+	return pScratchPolyhedron;
+}
+
+CPolyhedron *CPolyhedronClipper::CopyPolyhedron( CPolyhedronClipScratch &scratch, bool bUseScratchMemory, const CPolyhedron *pPolyhedron )
+{
+	if( bUseScratchMemory && ( pPolyhedron == &scratch.m_OutputPolyhedron ) )
+		return &scratch.m_OutputPolyhedron;
+
+	CPolyhedron *pReturn = AllocateOutput( scratch, bUseScratchMemory, pPolyhedron->iVertexCount, pPolyhedron->iLineCount, pPolyhedron->iIndexCount, pPolyhedron->iPolygonCount );
+	memcpy( ( void * )pReturn->pVertices, pPolyhedron->pVertices, sizeof( Vector ) * pReturn->iVertexCount );
+	memcpy( ( void * )pReturn->pLines, pPolyhedron->pLines, sizeof( Polyhedron_IndexedLine_t ) * pReturn->iLineCount );
+	memcpy( ( void * )pReturn->pIndices, pPolyhedron->pIndices, sizeof( Polyhedron_IndexedLineReference_t ) * pReturn->iIndexCount );
+	memcpy( ( void * )pReturn->pPolygons, pPolyhedron->pPolygons, sizeof( Polyhedron_IndexedPolygon_t ) * pReturn->iPolygonCount );
+	return pReturn;
+}
+
+CPolyhedron *CPolyhedronClipper::CreatePolyhedron( bool bUseScratchMemory )
+{
+	const CUtlVector<CPolyhedronClipScratch::Polygon_t> &polygons = m_Scratch.m_Polygons[m_iCurrent];
+	const CUtlVector<int> &loops = m_Scratch.m_PolygonLoops[m_iCurrent];
+	const CPolyhedronClipScratch::Polygon_t *pPolygons = polygons.Base();
+	const int *pLoops = loops.Base();
+	const int iPolygonCount = polygons.Count();
+	const int iIndexCount = loops.Count();
+
+	if( iPolygonCount < 3 || m_iPointCount < 3 || m_iPointCount > 0xFFFF || iIndexCount > 0xFFFF )
+		return NULL;
+
+	//every edge becomes a line the first time either polygon using it comes across it
+	m_Scratch.m_Lines.SetCountNonDestructively( iIndexCount );
+	m_Scratch.m_LineReferences.SetCountNonDestructively( iIndexCount );
+	Polyhedron_IndexedLine_t *pLines = m_Scratch.m_Lines.Base();
+	Polyhedron_IndexedLineReference_t *pReferences = m_Scratch.m_LineReferences.Base();
+	int iLineCount = 0;
+
+	ResetEdgeHash( iIndexCount );
+	for( int i = 0; i != iPolygonCount; ++i )
+	{
+		const int *pLoop = pLoops + pPolygons[i].iFirstIndex;
+		const int iCount = pPolygons[i].iIndexCount;
+		for( int j = 0; j != iCount; ++j )
+		{
+			int iFrom = pLoop[j];
+			int iTo = pLoop[( j + 1 == iCount ) ? 0 : j + 1];
+
+			bool bAdded;
+			int *pLine = FindOrAddEdge( EdgeKey( MIN( iFrom, iTo ), MAX( iFrom, iTo ) ), &bAdded );
+			if( bAdded )
+			{
+				*pLine = iLineCount++;
+				pLines[*pLine].iPointIndices[0] = (unsigned short)iFrom;
+				pLines[*pLine].iPointIndices[1] = (unsigned short)iTo;
+			}
+
+			Polyhedron_IndexedLineReference_t &reference = pReferences[pPolygons[i].iFirstIndex + j];
+			reference.iLineIndex = (unsigned short)*pLine;
+			reference.iEndPointIndex = ( pLines[*pLine].iPointIndices[1] == iTo ) ? 1 : 0;
+		}
+	}
+
+	CPolyhedron *pReturn = AllocateOutput( m_Scratch, bUseScratchMemory, m_iPointCount, iLineCount, iIndexCount, iPolygonCount );
+
+	const float *pX = m_Scratch.m_PointsX.Base();
+	const float *pY = m_Scratch.m_PointsY.Base();
+	const float *pZ = m_Scratch.m_PointsZ.Base();
+	for( int i = 0; i != m_iPointCount; ++i )
+	{
+		pReturn->pVertices[i].Init( pX[i], pY[i], pZ[i] );
+	}
+
+	memcpy( ( void * )pReturn->pLines, pLines, sizeof( Polyhedron_IndexedLine_t ) * iLineCount );
+	memcpy( ( void * )pReturn->pIndices, pReferences, sizeof( Polyhedron_IndexedLineReference_t ) * iIndexCount );
+
+	for( int i = 0; i != iPolygonCount; ++i )
+	{
+		pReturn->pPolygons[i].polyNormal = pPolygons[i].vNormal;
+		pReturn->pPolygons[i].iFirstIndex = (unsigned short)pPolygons[i].iFirstIndex;
+		pReturn->pPolygons[i].iIndexCount = (unsigned short)pPolygons[i].iIndexCount;
+	}
+
+	return pReturn;
+}
+
+CPolyhedron *GeneratePolyhedronFromPlanes( const float *pOutwardFacingPlanes, int iPlaneCount, float fOnPlaneEpsilon, CPolyhedronClipScratch &scratch, bool bUseScratchMemory )
+{
+	//same starting box as the linked version
+	float *pFlippedPlanes = (float *)stackalloc( (iPlaneCount * 4) * sizeof( float ) );
+	for( int i = 0; i != iPlaneCount * 4; ++i )
+	{
+		pFlippedPlanes[i] = -pOutwardFacingPlanes[i];
+	}
+
+	Vector vAABBMins, vAABBMaxs;
+	if( FindConvexShapeLooseAABB( pFlippedPlanes, iPlaneCount, &vAABBMins, &vAABBMaxs ) == false )
+		return NULL; //no shape to work with apparently
+
+	{
+		Vector vGrow = (vAABBMaxs - vAABBMins) * 0.5f;
+		vGrow.x += 100.0f;
+		vGrow.y += 100.0f;
+		vGrow.z += 100.0f;
+
+		vAABBMaxs += vGrow;
+		vAABBMins -= vGrow;
+	}
+
+	CPolyhedronClipper clipper( scratch );
+	clipper.InitBox( vAABBMins, vAABBMaxs );
+
+	for( int i = 0; i != iPlaneCount; ++i )
+	{
+		if( clipper.ClipByPlane( &pOutwardFacingPlanes[i * 4], fOnPlaneEpsilon ) == CLIP_RESULT_ALL_DEAD )
+			return NULL;
+	}
+
+	return clipper.CreatePolyhedron( bUseScratchMemory );
+}
+
+CPolyhedron *ClipPolyhedron( const CPolyhedron *pExistingPolyhedron, const float *pOutwardFacingPlanes, int iPlaneCount, float fOnPlaneEpsilon, CPolyhedronClipScratch &scratch, bool bUseScratchMemory )
+{
+	if( pExistingPolyhedron == NULL )
+		return NULL;
+
+	AssertMsg( (pExistingPolyhedron->iVertexCount >= 3) && (pExistingPolyhedron->iPolygonCount >= 2), "Polyhedron doesn't meet absolute minimum spec" );
+
+	//Same early out as the linked version, but each plane is judged on its own. Most clips either don't touch the
+	//	polyhedron or remove it entirely.
+	bool bCutsAnything = false;
+	for( int i = 0; i != iPlaneCount; ++i )
+	{
+		const Vector &vNormal = *((const Vector *)&pOutwardFacingPlanes[(i * 4) + 0]);
+		const float fPlaneDist = pOutwardFacingPlanes[(i * 4) + 3];
+
+		int iLiveCount = 0;
+		for( int j = 0; j != pExistingPolyhedron->iVertexCount; ++j )
+		{
+			float fPointDist = vNormal.Dot( pExistingPolyhedron->pVertices[j] ) - fPlaneDist;
+
+			if( fPointDist <= -fOnPlaneEpsilon )
+				++iLiveCount;
+			else if( fPointDist > fOnPlaneEpsilon )
+				bCutsAnything = true;
+		}
+
+		if( iLiveCount == 0 )
+			return NULL; //all points are dead or on the plane, so the polyhedron is dead
+	}
+
+	if( !bCutsAnything )
+	{
+		return CPolyhedronClipper::CopyPolyhedron( scratch, bUseScratchMemory, pExistingPolyhedron );
+	}
+
+	CPolyhedronClipper clipper( scratch );
+	clipper.InitFromPolyhedron( pExistingPolyhedron );
+
+	for( int i = 0; i != iPlaneCount; ++i )
+	{
+		if( clipper.ClipByPlane( &pOutwardFacingPlanes[i * 4], fOnPlaneEpsilon ) == CLIP_RESULT_ALL_DEAD )
+			return NULL;
+	}
+
+	return clipper.CreatePolyhedron( bUseScratchMemory );
+}
+
+
+
 
 
 
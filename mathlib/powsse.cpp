@@ -5,6 +5,7 @@
 //=====================================================================================//
 
 #include "mathlib/ssemath.h"
+#include "mathlib/ssemath8.h"
 
 fltx4 Pow_FixedPoint_Exponent_SIMD( const fltx4 & x, int exponent)
 {
@@ -37,3 +38,34 @@ fltx4 Pow_FixedPoint_Exponent_SIMD( const fltx4 & x, int exponent)
 		return rslt;
 }
 
+// Same as above, eight at a time
+SIMD8_TARGET fltx8 Pow_FixedPoint_Exponent_SIMD( const fltx8 & x, int exponent)
+{
+	fltx8 rslt=LoadOneSIMD8();								// x^0=1.0
+	int xp=abs(exponent);
+	if (xp & 3)												// fraction present?
+	{
+		fltx8 sq_rt=SqrtEstSIMD(x);
+		if (xp & 1)											// .25?
+			rslt=SqrtEstSIMD(sq_rt);						// x^.25
+		if (xp & 2)
+			rslt=MulSIMD(rslt,sq_rt);
+	}
+	xp>>=2;													// strip fraction
+	fltx8 curpower=x;										// curpower iterates through  x,x^2,x^4,x^8,x^16...
+
+	while(1)
+	{
+		if (xp & 1)
+			rslt=MulSIMD(rslt,curpower);
+		xp>>=1;
+		if (xp)
+			curpower=MulSIMD(curpower,curpower);
+		else
+			break;
+	}
+	if (exponent<0)
+		return ReciprocalEstSIMD(rslt);							// pow(x,-b)=1/pow(x,b)
+	else
+		return rslt;
+}
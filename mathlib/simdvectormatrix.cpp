@@ -13,6 +13,7 @@
 #include "mathlib/mathlib.h"
 #include "mathlib/simdvectormatrix.h"
 #include "mathlib/ssemath.h"
+#include "mathlib/ssemath8.h"
 #include "tier0/dbg.h"
 
 void CSIMDVectorMatrix::CreateFromRGBA_FloatImageData(int srcwidth, int srcheight,
@@ -59,10 +60,71 @@ void CSIMDVectorMatrix::CreateFromRGBA_FloatImageData(int srcwidth, int srcheigh
 	}
 }
 
+// The whole image is a flat array of floats as far as these are concerned: FourVectors
+// are 12 floats each, so two of them are exactly three fltx8s.
+static SIMD8_TARGET void RaiseToPower_SIMD8( FourVectors *pData, int nv, int fixed_point_exp )
+{
+	float *pFloats=reinterpret_cast<float *>( pData );
+	int nFloats=( nv & ~1 ) * 12;
+	for( int i=0; i < nFloats; i+=8 )
+	{
+		StoreUnalignedSIMD( pFloats+i, Pow_FixedPoint_Exponent_SIMD( LoadUnalignedSIMD8( pFloats+i ), fixed_point_exp ) );
+	}
+	if ( nv & 1 )
+	{
+		FourVectors *src=pData+nv-1;
+		src->x=Pow_FixedPoint_Exponent_SIMD( src->x, fixed_point_exp );
+		src->y=Pow_FixedPoint_Exponent_SIMD( src->y, fixed_point_exp );
+		src->z=Pow_FixedPoint_Exponent_SIMD( src->z, fixed_point_exp );
+	}
+}
+
+static SIMD8_TARGET void Add_SIMD8( FourVectors *pDest, const FourVectors *pSrc, int nv )
+{
+	float *pDestFloats=reinterpret_cast<float *>( pDest );
+	const float *pSrcFloats=reinterpret_cast<const float *>( pSrc );
+	int nFloats=( nv & ~1 ) * 12;
+	for( int i=0; i < nFloats; i+=8 )
+	{
+		StoreUnalignedSIMD( pDestFloats+i, AddSIMD( LoadUnalignedSIMD8( pDestFloats+i ), LoadUnalignedSIMD8( pSrcFloats+i ) ) );
+	}
+	if ( nv & 1 )
+	{
+		pDest[nv-1] += pSrc[nv-1];
+	}
+}
+
+static SIMD8_TARGET void Scale_SIMD8( FourVectors *pDest, Vector const &scale, int nv )
+{
+	// a pair of FourVectors is xxxxyyyy zzzzxxxx yyyyzzzz
+	fltx8 scale0=CombineSIMD8( ReplicateX4( scale.x ), ReplicateX4( scale.y ) );
+	fltx8 scale1=CombineSIMD8( ReplicateX4( scale.z ), ReplicateX4( scale.x ) );
+	fltx8 scale2=CombineSIMD8( ReplicateX4( scale.y ), ReplicateX4( scale.z ) );
+
+	float *pFloats=reinterpret_cast<float *>( pDest );
+	int nFloats=( nv & ~1 ) * 12;
+	for( int i=0; i < nFloats; i+=24 )
+	{
+		StoreUnalignedSIMD( pFloats+i, MulSIMD( LoadUnalignedSIMD8( pFloats+i ), scale0 ) );
+		StoreUnalignedSIMD( pFloats+i+8, MulSIMD( LoadUnalignedSIMD8( pFloats+i+8 ), scale1 ) );
+		StoreUnalignedSIMD( pFloats+i+16, MulSIMD( LoadUnalignedSIMD8( pFloats+i+16 ), scale2 ) );
+	}
+	if ( nv & 1 )
+	{
+		FourVectors scalevalue;
+		scalevalue.DuplicateVector( scale );
+		pDest[nv-1].VProduct( scalevalue );
+	}
+}
+
 void CSIMDVectorMatrix::RaiseToPower( float power )
 {
 	int nv=NVectors();
-	if ( nv )
+	if ( nv && MathLib_SIMD8Enabled() )
+	{
+		RaiseToPower_SIMD8( m_pData, nv, (int) ( 4.0*power ) );
+	}
+	else if ( nv )
 	{
 		int fixed_point_exp=(int) ( 4.0*power );
 		FourVectors *src=m_pData;
@@ -81,7 +143,11 @@ CSIMDVectorMatrix & CSIMDVectorMatrix::operator+=( CSIMDVectorMatrix const &src
 	Assert( m_nWidth == src.m_nWidth );
 	Assert( m_nHeight == src.m_nHeight );
 	int nv=NVectors();
-	if ( nv )
+	if ( nv && MathLib_SIMD8Enabled() )
+	{
+		Add_SIMD8( m_pData, src.m_pData, nv );
+	}
+	else if ( nv )
 	{
 		FourVectors *srcv=src.m_pData;
 		FourVectors *destv=m_pData;
@@ -96,7 +162,11 @@ CSIMDVectorMatrix & CSIMDVectorMatrix::operator+=( CSIMDVectorMatrix const &src
 CSIMDVectorMatrix & CSIMDVectorMatrix::operator*=( Vector const &src )
 {
 	int nv=NVectors();
-	if ( nv )
+	if ( nv && MathLib_SIMD8Enabled() )
+	{
+		Scale_SIMD8( m_pData, src, nv );
+	}
+	else if ( nv )
 	{
 		FourVectors scalevalue;
 		scalevalue.DuplicateVector( src );
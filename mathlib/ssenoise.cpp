@@ -12,6 +12,7 @@
 #include "mathlib/mathlib.h"
 #include "mathlib/vector.h"
 #include "mathlib/ssemath.h"
+#include "mathlib/ssemath8.h"
 
 // memdbgon must be the last include file in a .cpp file!!!
 #include "tier0/memdbgon.h"
@@ -103,3 +104,121 @@ fltx4 NoiseSIMD( FourVectors const &pos )
 {
 	return NoiseSIMD( pos.x, pos.y, pos.z );
 }
+
+#if !USE_EMULATED_SIMD8
+
+// the three perm lookups of neighbouring lattice points share their prefixes, so walk
+// them once per prefix. Hardware gathers lose to this on most AVX2 parts.
+static FORCEINLINE void GetLatticePointValues( int xi, int yi, int zi, float *pLattice, int nStride )
+{
+	int nPermA0 = perm_a[xi & 0xff];
+	int nPermA1 = perm_a[( xi + 1 ) & 0xff];
+
+	int nPermB00 = perm_b[( yi + nPermA0 ) & 0xff];
+	int nPermB01 = perm_b[( yi + 1 + nPermA0 ) & 0xff];
+	int nPermB10 = perm_b[( yi + nPermA1 ) & 0xff];
+	int nPermB11 = perm_b[( yi + 1 + nPermA1 ) & 0xff];
+
+	pLattice[0 * nStride] = impulse_xcoords[perm_c[( zi + nPermB00 ) & 0xff]];
+	pLattice[1 * nStride] = impulse_xcoords[perm_c[( zi + 1 + nPermB00 ) & 0xff]];
+	pLattice[2 * nStride] = impulse_xcoords[perm_c[( zi + nPermB01 ) & 0xff]];
+	pLattice[3 * nStride] = impulse_xcoords[perm_c[( zi + 1 + nPermB01 ) & 0xff]];
+	pLattice[4 * nStride] = impulse_xcoords[perm_c[( zi + nPermB10 ) & 0xff]];
+	pLattice[5 * nStride] = impulse_xcoords[perm_c[( zi + 1 + nPermB10 ) & 0xff]];
+	pLattice[6 * nStride] = impulse_xcoords[perm_c[( zi + nPermB11 ) & 0xff]];
+	pLattice[7 * nStride] = impulse_xcoords[perm_c[( zi + 1 + nPermB11 ) & 0xff]];
+}
+
+SIMD8_TARGET fltx8 NoiseSIMD( const fltx8 & x, const fltx8 & y, const fltx8 & z )
+{
+	// use magic to convert to integer index, the low 16 bits are 8.8 fixed point
+	const fltx8 magic = ReplicateX8( MAGIC_NUMBER );
+	__m256i x_idx = _mm256_castps_si256( AddSIMD( x, magic ) );
+	__m256i y_idx = _mm256_castps_si256( AddSIMD( y, magic ) );
+	__m256i z_idx = _mm256_castps_si256( AddSIMD( z, magic ) );
+
+	// the fractions stay in registers, only the lattice indices go through memory
+	const __m256i fracMask = _mm256_set1_epi32( 0xff );
+	const fltx8 fracScale = ReplicateX8( 1.0f / 256.0f );
+	fltx8 xfrac = MulSIMD( _mm256_cvtepi32_ps( _mm256_and_si256( x_idx, fracMask ) ), fracScale );
+	fltx8 yfrac = MulSIMD( _mm256_cvtepi32_ps( _mm256_and_si256( y_idx, fracMask ) ), fracScale );
+	fltx8 zfrac = MulSIMD( _mm256_cvtepi32_ps( _mm256_and_si256( z_idx, fracMask ) ), fracScale );
+
+	ALIGN32 int32 xi[8], yi[8], zi[8];
+	_mm256_store_si256( ( __m256i * )xi, _mm256_srli_epi32( x_idx, 8 ) );
+	_mm256_store_si256( ( __m256i * )yi, _mm256_srli_epi32( y_idx, 8 ) );
+	_mm256_store_si256( ( __m256i * )zi, _mm256_srli_epi32( z_idx, 8 ) );
+
+	// lattice[xyz corner][lane]
+	ALIGN32 float lattice[8][8];
+	for ( int i = 0; i < 8; i++ )
+	{
+		GetLatticePointValues( xi[i], yi[i], zi[i], &lattice[0][i], 8 );
+	}
+
+	fltx8 lattice000 = LoadAlignedSIMD8( lattice[0] );
+	fltx8 lattice001 = LoadAlignedSIMD8( lattice[1] );
+	fltx8 lattice010 = LoadAlignedSIMD8( lattice[2] );
+	fltx8 lattice011 = LoadAlignedSIMD8( lattice[3] );
+	fltx8 lattice100 = LoadAlignedSIMD8( lattice[4] );
+	fltx8 lattice101 = LoadAlignedSIMD8( lattice[5] );
+	fltx8 lattice110 = LoadAlignedSIMD8( lattice[6] );
+	fltx8 lattice111 = LoadAlignedSIMD8( lattice[7] );
+
+	// first, do x interpolation
+	fltx8 l2d00 = MaddSIMD( xfrac, SubSIMD( lattice100, lattice000 ), lattice000 );
+	fltx8 l2d01 = MaddSIMD( xfrac, SubSIMD( lattice101, lattice001 ), lattice001 );
+	fltx8 l2d10 = MaddSIMD( xfrac, SubSIMD( lattice110, lattice010 ), lattice010 );
+	fltx8 l2d11 = MaddSIMD( xfrac, SubSIMD( lattice111, lattice011 ), lattice011 );
+
+	// now, do y interpolation
+	fltx8 l1d0 = MaddSIMD( yfrac, SubSIMD( l2d10, l2d00 ), l2d00 );
+	fltx8 l1d1 = MaddSIMD( yfrac, SubSIMD( l2d11, l2d01 ), l2d01 );
+
+	// final z interpolation
+	fltx8 rslt = MaddSIMD( zfrac, SubSIMD( l1d1, l1d0 ), l1d0 );
+
+	// map to -1..1
+	return MulSIMD( ReplicateX8( 2.0f ), SubSIMD( rslt, ReplicateX8( 0.5f ) ) );
+}
+
+#else
+
+fltx8 NoiseSIMD( const fltx8 & x, const fltx8 & y, const fltx8 & z )
+{
+	return CombineSIMD8( NoiseSIMD( LowerSIMD( x ), LowerSIMD( y ), LowerSIMD( z ) ),
+						 NoiseSIMD( UpperSIMD( x ), UpperSIMD( y ), UpperSIMD( z ) ) );
+}
+
+#endif
+
+SIMD8_TARGET fltx8 NoiseSIMD( EightVectors const &pos )
+{
+	return NoiseSIMD( pos.x, pos.y, pos.z );
+}
+
+static SIMD8_TARGET int NoiseSIMD8( FourVectors const *pPositions, fltx4 *pResults, int nCount )
+{
+	int i = 0;
+	for ( ; i + 2 <= nCount; i += 2 )
+	{
+		EightVectors pos;
+		pos.LoadFourVectors( pPositions[i], pPositions[i + 1] );
+
+		fltx8 rslt = NoiseSIMD( pos );
+		pResults[i] = LowerSIMD( rslt );
+		pResults[i + 1] = UpperSIMD( rslt );
+	}
+
+	return i;
+}
+
+void NoiseSIMD( FourVectors const *pPositions, fltx4 *pResults, int nCount )
+{
+	int i = 0;
+	if ( MathLib_SIMD8Enabled() )
+		i = NoiseSIMD8( pPositions, pResults, nCount );
+
+	for ( ; i < nCount; i++ )
+		pResults[i] = NoiseSIMD( pPositions[i] );
+}
@@ -14,6 +14,7 @@
 #include "tier2/interval.h"
 #include "soundchars.h"
 #include "keyvalues.h"
+#include "tier1/utlperfecthash.h"
 
 // memdbgon must be the last include file in a .cpp file!!!
 #include "tier0/memdbgon.h"
@@ -25,7 +26,7 @@ struct SoundChannels
 };
 
 // NOTE:  This will need to be updated if channel names are added/removed
-static SoundChannels g_pChannelNames[] =
+static constexpr SoundChannels g_pChannelNames[] =
 {
 	{ CHAN_AUTO, "CHAN_AUTO" },
 	{ CHAN_WEAPON, "CHAN_WEAPON" },
@@ -70,7 +71,7 @@ struct SoundLevelLookup
 };
 
 // NOTE:  Needs to reflect the soundlevel_t enum defined in soundflags.h
-static SoundLevelLookup g_pSoundLevels[] =
+static constexpr SoundLevelLookup g_pSoundLevels[] =
 {
 	{ SNDLVL_NONE, "SNDLVL_NONE" },
 	{ SNDLVL_20dB, "SNDLVL_20dB" },
@@ -104,6 +105,32 @@ static SoundLevelLookup g_pSoundLevels[] =
 	{ SNDLVL_180dB, "SNDLVL_180dB" },
 };
 
+// The names of one of the tables above on their own, for its CUtlPerfectHash
+template< int N >
+struct SoundLookupNames
+{
+	const char *names[ N ];
+};
+
+template< class T, int N >
+static constexpr SoundLookupNames< N > GetSoundLookupNames( const T ( &entries )[ N ] )
+{
+	SoundLookupNames< N > lookupNames = {};
+	for ( int i = 0; i < N; i++ )
+	{
+		lookupNames.names[ i ] = entries[ i ].name;
+	}
+
+	return lookupNames;
+}
+
+// The scripts name a channel and a sound level for most of their sounds
+static constexpr auto g_ChannelNames = GetSoundLookupNames( g_pChannelNames );
+static constexpr auto g_ChannelNameTable = MakePerfectHash< true >( g_ChannelNames.names );
+
+static constexpr auto g_SoundLevelNames = GetSoundLookupNames( g_pSoundLevels );
+static constexpr auto g_SoundLevelNameTable = MakePerfectHash< true >( g_SoundLevelNames.names );
+
 static const char *_SoundLevelToString( soundlevel_t level )
 {
 	int c = ARRAYSIZE( g_pSoundLevels );
@@ -112,7 +139,7 @@ static const char *_SoundLevelToString( soundlevel_t level )
 
 	for ( i = 0 ; i < c; i++ )
 	{
-		SoundLevelLookup *entry = &g_pSoundLevels[ i ];
+		const SoundLevelLookup *entry = &g_pSoundLevels[ i ];
 		if ( entry->level == level )
 			return entry->name;
 	}
@@ -130,7 +157,7 @@ static const char *_ChannelToString( int channel )
 
 	for ( i = 0 ; i < c; i++ )
 	{
-		SoundChannels *entry = &g_pChannelNames[ i ];
+		const SoundChannels *entry = &g_pChannelNames[ i ];
 		if ( entry->channel == channel )
 			return entry->name;
 	}
@@ -186,16 +213,9 @@ soundlevel_t TextToSoundLevel( const char *key )
 		return SNDLVL_NORM;
 	}
 
-	int c = ARRAYSIZE( g_pSoundLevels );
-
-	int i;
-
-	for ( i = 0 ; i < c; i++ )
-	{
-		SoundLevelLookup *entry = &g_pSoundLevels[ i ];
-		if ( !Q_strcasecmp( key, entry->name ) )
-			return entry->level;
-	}
+	int i = g_SoundLevelNameTable.Find( key );
+	if ( i >= 0 )
+		return g_pSoundLevels[ i ].level;
 
 	if ( !Q_strnicmp( key, SNDLVL_PREFIX, Q_strlen( SNDLVL_PREFIX ) ) )
 	{
@@ -231,15 +251,10 @@ int TextToChannel( const char *name )
 		return atoi( name );
 	}
 
-	int c = ARRAYSIZE( g_pChannelNames );
-	int i;
-
-	for ( i = 0; i < c; i++ )
+	int i = g_ChannelNameTable.Find( name );
+	if ( i >= 0 )
 	{
-		if ( !Q_strcasecmp( name, g_pChannelNames[ i ].name ) )
-		{
-			return g_pChannelNames[ i ].channel;
-		}
+		return g_pChannelNames[ i ].channel;
 	}
 
 	// At this point, it starts with chan_ but is not recognized
@@ -257,7 +272,7 @@ const char *SoundLevelToString( soundlevel_t level )
 
 	for ( i = 0 ; i < c; i++ )
 	{
-		SoundLevelLookup *entry = &g_pSoundLevels[ i ];
+		const SoundLevelLookup *entry = &g_pSoundLevels[ i ];
 		if ( entry->level == level )
 			return entry->name;
 	}
@@ -275,7 +290,7 @@ const char *ChannelToString( int channel )
 
 	for ( i = 0 ; i < c; i++ )
 	{
-		SoundChannels *entry = &g_pChannelNames[ i ];
+		const SoundChannels *entry = &g_pChannelNames[ i ];
 		if ( entry->channel == channel )
 			return entry->name;
 	}
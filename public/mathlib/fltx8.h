@@ -0,0 +1,61 @@
+//===== Copyright 1996-2010, Valve Corporation, All rights reserved. ======//
+//
+// Purpose: - defines the type fltx8 - the 8-wide counterpart of fltx4.
+//
+// On x86 fltx8 is an AVX register. Every function that touches one is compiled
+// for AVX2 + FMA (SIMD8_TARGET) while the rest of the module stays at the SSE
+// baseline, so fltx8 code may only run after MathLib_SIMD8Enabled() said yes.
+//
+// Everywhere else (or with USE_EMULATED_SIMD8 defined) fltx8 is a pair of fltx4s
+// and every op forwards to the fltx4 version of itself, which makes the 8-wide
+// code paths portable at the speed of the 4-wide ones.
+//
+//===========================================================================//
+
+#ifndef FLTX8_H
+#define FLTX8_H
+
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include "mathlib/fltx4.h"
+
+#ifndef USE_EMULATED_SIMD8
+#if !defined( PLATFORM_PPC ) && USE_STDC_FOR_SIMD == 0 && ( defined( _M_X64 ) || defined( _M_IX86 ) || defined( __x86_64__ ) || defined( __i386__ ) )
+#define USE_EMULATED_SIMD8 0
+#else
+#define USE_EMULATED_SIMD8 1
+#endif
+#endif
+
+#if USE_EMULATED_SIMD8
+
+struct fltx8
+{
+	fltx4 m_lo;		// elements 0..3
+	fltx4 m_hi;		// elements 4..7
+};
+
+typedef fltx8 bi32x8;
+
+#define SIMD8_TARGET
+
+#else
+
+#include <immintrin.h>
+
+typedef __m256 fltx8;
+typedef __m256i i32x8;
+typedef fltx8 bi32x8;
+
+// MSVC lets intrinsics through regardless of /arch, gcc and clang need to be told per function
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define SIMD8_TARGET __attribute__(( target( "avx2,fma" ) ))
+#else
+#define SIMD8_TARGET
+#endif
+
+#endif
+
+#endif // FLTX8_H
@@ -718,6 +718,17 @@ void QuaternionMult( const Quaternion &p, const Quaternion &q, Quaternion &qt );
 void QuaternionMatrix( const Quaternion &q, matrix3x4_t &matrix );
 void QuaternionMatrix( const Quaternion &q, const Vector &pos, matrix3x4_t &matrix );
 void QuaternionMatrix( const Quaternion &q, const Vector &pos, const Vector &vScale, matrix3x4_t& mat );
+
+// Batched versions of the above over arrays, four at a time as FourQuaternions. The slerp
+// is a polynomial fit rather than acos/sin and agrees with QuaternionSlerp to about 1e-6.
+// The outputs may be the same arrays as the inputs.
+void QuaternionSlerps( const Quaternion *pP, const Quaternion *pQ, float t, int nCount, Quaternion *pOut );
+void QuaternionBlends( const Quaternion *pP, const Quaternion *pQ, float t, int nCount, Quaternion *pOut );
+void QuaternionMatrices( const Quaternion *pQ, const Vector *pPos, int nCount, matrix3x4a_t *pOut );
+
+// pOut[i] = pOut[pParents[i]] * pLocal[i], or rootTransform * pLocal[i] for bones whose parent is -1.
+// Parents must come before their children; pLocal and pOut may be the same array.
+void ConcatBoneTransforms( const matrix3x4a_t &rootTransform, const matrix3x4a_t *pLocal, const int *pParents, int nBones, matrix3x4a_t *pOut );
 void QuaternionAngles( const Quaternion &q, QAngle &angles );
 void AngleQuaternion( const QAngle& angles, Quaternion &qt );
 void QuaternionAngles( const Quaternion &q, RadianEuler &angles );
@@ -2352,6 +2363,9 @@ void MathLib_Init( float gamma = 2.2f, float texGamma = 2.2f, float brightness =
 bool MathLib_MMXEnabled( void );
 bool MathLib_SSEEnabled( void );
 bool MathLib_SSE2Enabled( void );
+// 8-wide (fltx8) paths: AVX2 and FMA are there, or fltx8 is emulated. See ssemath8.h
+bool MathLib_SIMD8Enabled( void );
+void MathLib_SetSIMD8Enabled( bool bEnable );
 
 inline float Approach( float target, float value, float speed );
 float ApproachAngle( float target, float value, float speed );
@@ -14,6 +14,7 @@
 #endif
 
 #include "mathlib/mathlib.h"
+#include "tier1/utlvector.h"
 
 
 
@@ -69,5 +70,66 @@ CPolyhedron *ClipPolyhedron( const CPolyhedron *pExistingPolyhedron, const float
 CPolyhedron *GetTempPolyhedron( unsigned short iVertices, unsigned short iLines, unsigned short iIndices, unsigned short iPolygons ); //grab the temporary polyhedron. Avoids new/delete for quick work. Can only be in use by one chunk of code at a time
 
 
+//-----------------------------------------------------------------------------
+// Reentrant polyhedron clipping
+//
+// The versions of GeneratePolyhedronFromPlanes/ClipPolyhedron taking a CPolyhedronClipScratch keep all of their
+// working state in it instead of on the stack or in globals, so any number of threads can clip at once as long as
+// each uses its own scratch. The shape is kept as a flat vertex array (classified four points at a time against each
+// plane) and a list of polygons as vertex loops, rather than the linked point/line/polygon graph used above.
+// Once the scratch has grown to fit the largest shape it has seen, clipping allocates nothing except the returned
+// polyhedron, and not even that with bUseScratchMemory.
+//-----------------------------------------------------------------------------
+class CPolyhedronClipScratch
+{
+public:
+	CPolyhedronClipScratch( void );
+
+	// Free everything, including the polyhedron handed out with bUseScratchMemory
+	void Purge( void );
+
+private:
+	friend class CPolyhedronClipper;
+
+	class CPolyhedron_ScratchMemory : public CPolyhedron
+	{
+	public:
+		virtual void Release( void ) {} //memory belongs to the scratch
+	};
+
+	struct Polygon_t
+	{
+		Vector vNormal;
+		int iFirstIndex;
+		int iIndexCount;
+	};
+
+	struct EdgeHashEntry_t
+	{
+		uint32 iKey;
+		int iValue;
+		uint32 iGeneration; //entries from an older generation count as empty, so the hash never needs clearing
+	};
+
+	CUtlVector<float> m_PointsX, m_PointsY, m_PointsZ; //SoA so points can be classified four at a time. The per point arrays are storage only, their counts mean nothing
+	CUtlVector<float> m_PointDists;
+	CUtlVector<unsigned char> m_PointStates;
+	CUtlVector<int> m_PointRemap;
+	CUtlVector<Polygon_t> m_Polygons[2]; //current and next polygon lists
+	CUtlVector<int> m_PolygonLoops[2]; //point indices of each polygon, clockwise when viewed from outside
+	CUtlVector<EdgeHashEntry_t> m_EdgeHash;
+	uint32 m_iEdgeHashGeneration;
+	CUtlVector<Polyhedron_IndexedLine_t> m_Lines;
+	CUtlVector<Polyhedron_IndexedLineReference_t> m_LineReferences;
+
+	CUtlVector<unsigned char> m_OutputBuffer;
+	CPolyhedron_ScratchMemory m_OutputPolyhedron;
+};
+
+//bUseScratchMemory returns a polyhedron owned by the scratch, valid until the next call with the same scratch. Otherwise be sure to polyhedron->Release()
+CPolyhedron *GeneratePolyhedronFromPlanes( const float *pOutwardFacingPlanes, int iPlaneCount, float fOnPlaneEpsilon, CPolyhedronClipScratch &scratch, bool bUseScratchMemory = false );
+CPolyhedron *ClipPolyhedron( const CPolyhedron *pExistingPolyhedron, const float *pOutwardFacingPlanes, int iPlaneCount, float fOnPlaneEpsilon, CPolyhedronClipScratch &scratch, bool bUseScratchMemory = false ); //pExistingPolyhedron may be the scratch's own output
+
+
 #endif //#ifndef POLYHEDRON_H_
 
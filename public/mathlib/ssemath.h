@@ -4471,6 +4471,8 @@ FORCEINLINE fltx4 VectorMergeLowSIMD( fltx4 fl4SrcA, fltx4 fl4SrcB )
 // fourplanes_t, Frustrum_t are not supported on SPU
 // It would make sense to support FourVectors on SPU at some point.
 
+class FourVectors;
+
 struct ALIGN16 fourplanes_t
 {
 	fltx4		nX;
@@ -4511,6 +4513,12 @@ public:
 	bool CullBox( const fltx4 &fl4Mins, const fltx4 &fl4Maxs ) const;
 	bool CullBoxCenterExtents( const fltx4 &fl4Center, const fltx4 &fl4Extents ) const;
 
+	// CullBox over nBoxes boxes stored four to a FourVectors (box i is lane i & 3 of element i >> 2).
+	// Sets bit i of pCulled, which holds ( nBoxes + 31 ) / 32 words, for every box outside the
+	// frustum and returns how many there were.
+	int CullBoxes( const FourVectors *pMins, const FourVectors *pMaxs, int nBoxes, uint32 *pCulled ) const;
+	int CullBoxesCenterExtents( const FourVectors *pCenters, const FourVectors *pExtents, int nBoxes, uint32 *pCulled ) const;
+
 
 	// Return true if frustum contains this bounding volume, false if any corner is outside
 	bool Contains( const Vector &mins, const Vector &maxs ) const;
@@ -5462,6 +5470,9 @@ FourVectors CurlNoiseSIMD( FourVectors const &v );
 /// return value is -1..1. Only reliable around +/- 1 million or so.
 fltx4 NoiseSIMD( const fltx4 & x, const fltx4 & y, const fltx4 & z );
 
+/// NoiseSIMD( FourVectors ) over an array, eight positions at a time where fltx8 is available.
+void NoiseSIMD( FourVectors const *pPositions, fltx4 *pResults, int nCount );
+
 
 /// calculate the absolute value of a packed single
 inline fltx4 fabs( const fltx4 & x )
@@ -5727,6 +5738,21 @@ FORCEINLINE int BoxOnPlaneSideSIMD( const fltx4& emins, const fltx4& emaxs, cons
 	return sides[0];
 }
 
+//-----------------------------------------------------------------------------
+// Batched box operations. The boxes are stored four to a FourVectors, box i in
+// lane i & 3 of element i >> 2; whole elements are read and written, so the
+// arrays hold ( nBoxes + 3 ) / 4 of them.
+//-----------------------------------------------------------------------------
+
+// BoxOnPlaneSideSIMD for every box, the 1/2/3 results go to pSides[0..nBoxes-1]
+void BoxOnPlaneSideSIMD( const FourVectors *pMins, const FourVectors *pMaxs, int nBoxes, const cplane_t *p, uint8 *pSides, float tolerance = 0.f );
+
+// TransformAABB for every box, all by the same matrix
+void TransformAABBs( const matrix3x4_t &transform, const FourVectors *pMinsIn, const FourVectors *pMaxsIn, int nBoxes, FourVectors *pMinsOut, FourVectors *pMaxsOut );
+
+// TransformAABB for every box, box i by pTransforms[i]
+void TransformAABBs( const matrix3x4_t *pTransforms, const FourVectors *pMinsIn, const FourVectors *pMaxsIn, int nBoxes, FourVectors *pMinsOut, FourVectors *pMaxsOut );
+
 
 // k-dop bounding volume. 26-dop bounds with 13 plane-pairs plus 3 other "arbitrary bounds". The arbitrary values could be used to hold type info, etc,
 // which can compare against "for free"
@@ -0,0 +1,754 @@
+//===== Copyright 1996-2010, Valve Corporation, All rights reserved. ======//
+//
+// Purpose: 8-wide SIMD math - fltx8 and EightVectors, alongside ssemath.h's
+// fltx4 and FourVectors.
+//
+// The ops are overloads of the fltx4 names (AddSIMD, MaddSIMD, CmpGtSIMD,
+// MaskedAssign, ...), so 4-wide code ports by changing types. Only the
+// functions that can't be told apart by their arguments get an 8 in the name
+// (LoadAlignedSIMD8, ReplicateX8, ...).
+//
+// Native fltx8 code has to be compiled for AVX2 (mark it SIMD8_TARGET, see
+// fltx8.h) and must only run when MathLib_SIMD8Enabled() returns true:
+//
+//		static SIMD8_TARGET void ScaleAll8( float *pData, int nCount, float flScale );
+//
+//		if ( MathLib_SIMD8Enabled() )
+//			ScaleAll8( pData, nCount, flScale );
+//		else
+//			... 4-wide loop ...
+//
+//===========================================================================//
+
+#ifndef SSEMATH8_H
+#define SSEMATH8_H
+
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include "mathlib/ssemath.h"
+#include "mathlib/fltx8.h"
+
+#define FORCEINLINE_SIMD8 FORCEINLINE SIMD8_TARGET
+
+
+#if !USE_EMULATED_SIMD8
+
+//---------------------------------------------------------------------
+// AVX2 / FMA implementation
+//---------------------------------------------------------------------
+
+FORCEINLINE float SubFloat( const fltx8 & a, int idx )
+{
+	return ( reinterpret_cast< float const * >( &a ) )[idx];
+}
+
+FORCEINLINE float & SubFloat( fltx8 & a, int idx )
+{
+	return ( reinterpret_cast< float * >( &a ) )[idx];
+}
+
+FORCEINLINE uint32 SubInt( const fltx8 & a, int idx )
+{
+	return ( reinterpret_cast< uint32 const * >( &a ) )[idx];
+}
+
+FORCEINLINE uint32 & SubInt( fltx8 & a, int idx )
+{
+	return ( reinterpret_cast< uint32 * >( &a ) )[idx];
+}
+
+FORCEINLINE_SIMD8 fltx8 LoadZeroSIMD8( void )
+{
+	return _mm256_setzero_ps();
+}
+
+FORCEINLINE_SIMD8 fltx8 LoadOneSIMD8( void )
+{
+	return _mm256_set1_ps( 1.0f );
+}
+
+FORCEINLINE_SIMD8 fltx8 ReplicateX8( float flValue )
+{
+	return _mm256_set1_ps( flValue );
+}
+
+FORCEINLINE_SIMD8 fltx8 ReplicateIX8( int nValue )						// all eight words set to the same int
+{
+	return _mm256_castsi256_ps( _mm256_set1_epi32( nValue ) );
+}
+
+FORCEINLINE_SIMD8 fltx8 LoadAlignedSIMD8( const void *pSIMD )				// 32 byte aligned
+{
+	return _mm256_load_ps( reinterpret_cast< const float * >( pSIMD ) );
+}
+
+FORCEINLINE_SIMD8 fltx8 LoadUnalignedSIMD8( const void *pSIMD )
+{
+	return _mm256_loadu_ps( reinterpret_cast< const float * >( pSIMD ) );
+}
+
+FORCEINLINE_SIMD8 void StoreAlignedSIMD( float *pSIMD, const fltx8 & a )
+{
+	_mm256_store_ps( pSIMD, a );
+}
+
+FORCEINLINE_SIMD8 void StoreUnalignedSIMD( float *pSIMD, const fltx8 & a )
+{
+	_mm256_storeu_ps( pSIMD, a );
+}
+
+// elements 0..3 from lo, 4..7 from hi
+FORCEINLINE_SIMD8 fltx8 CombineSIMD8( const fltx4 & lo, const fltx4 & hi )
+{
+	return _mm256_insertf128_ps( _mm256_castps128_ps256( lo ), hi, 1 );
+}
+
+FORCEINLINE_SIMD8 fltx4 LowerSIMD( const fltx8 & a )						// elements 0..3
+{
+	return _mm256_castps256_ps128( a );
+}
+
+FORCEINLINE_SIMD8 fltx4 UpperSIMD( const fltx8 & a )						// elements 4..7
+{
+	return _mm256_extractf128_ps( a, 1 );
+}
+
+FORCEINLINE_SIMD8 fltx8 AddSIMD( const fltx8 & a, const fltx8 & b )		// a+b
+{
+	return _mm256_add_ps( a, b );
+}
+
+FORCEINLINE_SIMD8 fltx8 SubSIMD( const fltx8 & a, const fltx8 & b )		// a-b
+{
+	return _mm256_sub_ps( a, b );
+}
+
+FORCEINLINE_SIMD8 fltx8 MulSIMD( const fltx8 & a, const fltx8 & b )		// a*b
+{
+	return _mm256_mul_ps( a, b );
+}
+
+FORCEINLINE_SIMD8 fltx8 DivSIMD( const fltx8 & a, const fltx8 & b )		// a/b
+{
+	return _mm256_div_ps( a, b );
+}
+
+// Fused, so the results can differ from the 4-wide version in the last bit
+FORCEINLINE_SIMD8 fltx8 MaddSIMD( const fltx8 & a, const fltx8 & b, const fltx8 & c )	// a*b + c
+{
+	return _mm256_fmadd_ps( a, b, c );
+}
+
+FORCEINLINE_SIMD8 fltx8 MsubSIMD( const fltx8 & a, const fltx8 & b, const fltx8 & c )	// c - a*b
+{
+	return _mm256_fnmadd_ps( a, b, c );
+}
+
+FORCEINLINE_SIMD8 fltx8 AndSIMD( const fltx8 & a, const fltx8 & b )		// a & b
+{
+	return _mm256_and_ps( a, b );
+}
+
+FORCEINLINE_SIMD8 fltx8 AndNotSIMD( const fltx8 & a, const fltx8 & b )	// ~a & b
+{
+	return _mm256_andnot_ps( a, b );
+}
+
+FORCEINLINE_SIMD8 fltx8 OrSIMD( const fltx8 & a, const fltx8 & b )		// a | b
+{
+	return _mm256_or_ps( a, b );
+}
+
+FORCEINLINE_SIMD8 fltx8 XorSIMD( const fltx8 & a, const fltx8 & b )		// a ^ b
+{
+	return _mm256_xor_ps( a, b );
+}
+
+FORCEINLINE_SIMD8 fltx8 NegSIMD( const fltx8 & a )						// -a
+{
+	return _mm256_xor_ps( a, _mm256_set1_ps( -0.0f ) );
+}
+
+FORCEINLINE_SIMD8 fltx8 AbsSIMD( const fltx8 & a )						// |a|
+{
+	return _mm256_andnot_ps( _mm256_set1_ps( -0.0f ), a );
+}
+
+FORCEINLINE_SIMD8 fltx8 MinSIMD( const fltx8 & a, const fltx8 & b )		// min(a,b)
+{
+	return _mm256_min_ps( a, b );
+}
+
+FORCEINLINE_SIMD8 fltx8 MaxSIMD( const fltx8 & a, const fltx8 & b )		// max(a,b)
+{
+	return _mm256_max_ps( a, b );
+}
+
+FORCEINLINE_SIMD8 bi32x8 CmpEqSIMD( const fltx8 & a, const fltx8 & b )	// (a==b) ? ~0:0
+{
+	return _mm256_cmp_ps( a, b, _CMP_EQ_OQ );
+}
+
+FORCEINLINE_SIMD8 bi32x8 CmpGtSIMD( const fltx8 & a, const fltx8 & b )	// (a>b) ? ~0:0
+{
+	return _mm256_cmp_ps( a, b, _CMP_GT_OQ );
+}
+
+FORCEINLINE_SIMD8 bi32x8 CmpGeSIMD( const fltx8 & a, const fltx8 & b )	// (a>=b) ? ~0:0
+{
+	return _mm256_cmp_ps( a, b, _CMP_GE_OQ );
+}
+
+FORCEINLINE_SIMD8 bi32x8 CmpLtSIMD( const fltx8 & a, const fltx8 & b )	// (a<b) ? ~0:0
+{
+	return _mm256_cmp_ps( a, b, _CMP_LT_OQ );
+}
+
+FORCEINLINE_SIMD8 bi32x8 CmpLeSIMD( const fltx8 & a, const fltx8 & b )	// (a<=b) ? ~0:0
+{
+	return _mm256_cmp_ps( a, b, _CMP_LE_OQ );
+}
+
+// Mask words must be all ones or all zeros (which is what the Cmp functions return)
+FORCEINLINE_SIMD8 fltx8 MaskedAssign( const bi32x8 & ReplacementMask, const fltx8 & NewValue, const fltx8 & OldValue )
+{
+	return _mm256_blendv_ps( OldValue, NewValue, ReplacementMask );
+}
+
+FORCEINLINE_SIMD8 int TestSignSIMD( const fltx8 & a )						// mask of which floats have the high bit set
+{
+	return _mm256_movemask_ps( a );
+}
+
+FORCEINLINE_SIMD8 fltx8 SqrtSIMD( const fltx8 & a )						// sqrt(a)
+{
+	return _mm256_sqrt_ps( a );
+}
+
+FORCEINLINE_SIMD8 fltx8 SqrtEstSIMD( const fltx8 & a )					// sqrt(a), more or less
+{
+	return _mm256_sqrt_ps( a );
+}
+
+FORCEINLINE_SIMD8 fltx8 ReciprocalSqrtEstSIMD( const fltx8 & a )			// 1/sqrt(a), more or less
+{
+	return _mm256_rsqrt_ps( a );
+}
+
+FORCEINLINE_SIMD8 fltx8 ReciprocalEstSIMD( const fltx8 & a )				// 1/a, more or less
+{
+	return _mm256_rcp_ps( a );
+}
+
+FORCEINLINE_SIMD8 fltx8 FloorSIMD( const fltx8 & a )
+{
+	return _mm256_floor_ps( a );
+}
+
+/// sine and cosine of all eight values at once, accurate to a couple of ulps for |radians| < 8192
+FORCEINLINE_SIMD8 void SinCosSIMD( fltx8 &sine, fltx8 &cosine, const fltx8 &radians )
+{
+	const __m256 fl8SignMask = _mm256_set1_ps( -0.0f );
+
+	__m256 x = _mm256_andnot_ps( fl8SignMask, radians );
+	__m256 sinSign = _mm256_and_ps( radians, fl8SignMask );
+
+	// octant (rounded up to even), so the reduced angle is in -pi/4..pi/4
+	__m256i nOctant = _mm256_cvttps_epi32( _mm256_mul_ps( x, _mm256_set1_ps( 1.27323954473516f ) ) );
+	nOctant = _mm256_and_si256( _mm256_add_epi32( nOctant, _mm256_set1_epi32( 1 ) ), _mm256_set1_epi32( ~1 ) );
+	__m256 y = _mm256_cvtepi32_ps( nOctant );
+
+	// octants 4..7 flip the sine, 2..5 flip the cosine, and 2, 3, 6, 7 swap the polynomials
+	sinSign = _mm256_xor_ps( sinSign, _mm256_castsi256_ps( _mm256_slli_epi32( _mm256_and_si256( nOctant, _mm256_set1_epi32( 4 ) ), 29 ) ) );
+	__m256 cosSign = _mm256_castsi256_ps( _mm256_slli_epi32( _mm256_andnot_si256( _mm256_sub_epi32( nOctant, _mm256_set1_epi32( 2 ) ), _mm256_set1_epi32( 4 ) ), 29 ) );
+	__m256 swapMask = _mm256_castsi256_ps( _mm256_cmpeq_epi32( _mm256_and_si256( nOctant, _mm256_set1_epi32( 2 ) ), _mm256_set1_epi32( 2 ) ) );
+
+	// x - y*pi/4 in three parts (Cody-Waite) to keep the precision
+	x = _mm256_fnmadd_ps( y, _mm256_set1_ps( 0.78515625f ), x );
+	x = _mm256_fnmadd_ps( y, _mm256_set1_ps( 2.4187564849853515625e-4f ), x );
+	x = _mm256_fnmadd_ps( y, _mm256_set1_ps( 3.77489497744594108e-8f ), x );
+
+	__m256 z = _mm256_mul_ps( x, x );
+
+	__m256 cosPoly = _mm256_fmadd_ps( _mm256_set1_ps( 2.443315711809948e-5f ), z, _mm256_set1_ps( -1.388731625493765e-3f ) );
+	cosPoly = _mm256_fmadd_ps( cosPoly, z, _mm256_set1_ps( 4.166664568298827e-2f ) );
+	cosPoly = _mm256_mul_ps( _mm256_mul_ps( cosPoly, z ), z );
+	cosPoly = _mm256_fnmadd_ps( z, _mm256_set1_ps( 0.5f ), cosPoly );
+	cosPoly = _mm256_add_ps( cosPoly, _mm256_set1_ps( 1.0f ) );
+
+	__m256 sinPoly = _mm256_fmadd_ps( _mm256_set1_ps( -1.9515295891e-4f ), z, _mm256_set1_ps( 8.3321608736e-3f ) );
+	sinPoly = _mm256_fmadd_ps( sinPoly, z, _mm256_set1_ps( -1.6666654611e-1f ) );
+	sinPoly = _mm256_fmadd_ps( _mm256_mul_ps( sinPoly, z ), x, x );
+
+	sine = _mm256_xor_ps( _mm256_blendv_ps( sinPoly, cosPoly, swapMask ), sinSign );
+	cosine = _mm256_xor_ps( _mm256_blendv_ps( cosPoly, sinPoly, swapMask ), cosSign );
+}
+
+#else
+
+//---------------------------------------------------------------------
+// Emulated implementation - two fltx4s
+//---------------------------------------------------------------------
+
+FORCEINLINE float SubFloat( const fltx8 & a, int idx )
+{
+	return idx < 4 ? SubFloat( a.m_lo, idx ) : SubFloat( a.m_hi, idx - 4 );
+}
+
+FORCEINLINE float & SubFloat( fltx8 & a, int idx )
+{
+	return idx < 4 ? SubFloat( a.m_lo, idx ) : SubFloat( a.m_hi, idx - 4 );
+}
+
+FORCEINLINE uint32 SubInt( const fltx8 & a, int idx )
+{
+	return idx < 4 ? SubInt( a.m_lo, idx ) : SubInt( a.m_hi, idx - 4 );
+}
+
+FORCEINLINE uint32 & SubInt( fltx8 & a, int idx )
+{
+	return idx < 4 ? SubInt( a.m_lo, idx ) : SubInt( a.m_hi, idx - 4 );
+}
+
+FORCEINLINE fltx8 CombineSIMD8( const fltx4 & lo, const fltx4 & hi )
+{
+	fltx8 retVal;
+	retVal.m_lo = lo;
+	retVal.m_hi = hi;
+	return retVal;
+}
+
+FORCEINLINE fltx4 LowerSIMD( const fltx8 & a )
+{
+	return a.m_lo;
+}
+
+FORCEINLINE fltx4 UpperSIMD( const fltx8 & a )
+{
+	return a.m_hi;
+}
+
+FORCEINLINE fltx8 LoadZeroSIMD8( void )
+{
+	return CombineSIMD8( LoadZeroSIMD(), LoadZeroSIMD() );
+}
+
+FORCEINLINE fltx8 LoadOneSIMD8( void )
+{
+	return CombineSIMD8( LoadOneSIMD(), LoadOneSIMD() );
+}
+
+FORCEINLINE fltx8 ReplicateX8( float flValue )
+{
+	fltx4 value = ReplicateX4( flValue );
+	return CombineSIMD8( value, value );
+}
+
+FORCEINLINE fltx8 ReplicateIX8( int nValue )
+{
+	fltx4 value = ReplicateIX4( nValue );
+	return CombineSIMD8( value, value );
+}
+
+FORCEINLINE fltx8 LoadAlignedSIMD8( const void *pSIMD )
+{
+	const float *pFloats = reinterpret_cast< const float * >( pSIMD );
+	return CombineSIMD8( LoadAlignedSIMD( pFloats ), LoadAlignedSIMD( pFloats + 4 ) );
+}
+
+FORCEINLINE fltx8 LoadUnalignedSIMD8( const void *pSIMD )
+{
+	const float *pFloats = reinterpret_cast< const float * >( pSIMD );
+	return CombineSIMD8( LoadUnalignedSIMD( pFloats ), LoadUnalignedSIMD( pFloats + 4 ) );
+}
+
+FORCEINLINE void StoreAlignedSIMD( float *pSIMD, const fltx8 & a )
+{
+	StoreAlignedSIMD( pSIMD, a.m_lo );
+	StoreAlignedSIMD( pSIMD + 4, a.m_hi );
+}
+
+FORCEINLINE void StoreUnalignedSIMD( float *pSIMD, const fltx8 & a )
+{
+	StoreUnalignedSIMD( pSIMD, a.m_lo );
+	StoreUnalignedSIMD( pSIMD + 4, a.m_hi );
+}
+
+FORCEINLINE fltx8 AddSIMD( const fltx8 & a, const fltx8 & b )
+{
+	return CombineSIMD8( AddSIMD( a.m_lo, b.m_lo ), AddSIMD( a.m_hi, b.m_hi ) );
+}
+
+FORCEINLINE fltx8 SubSIMD( const fltx8 & a, const fltx8 & b )
+{
+	return CombineSIMD8( SubSIMD( a.m_lo, b.m_lo ), SubSIMD( a.m_hi, b.m_hi ) );
+}
+
+FORCEINLINE fltx8 MulSIMD( const fltx8 & a, const fltx8 & b )
+{
+	return CombineSIMD8( MulSIMD( a.m_lo, b.m_lo ), MulSIMD( a.m_hi, b.m_hi ) );
+}
+
+FORCEINLINE fltx8 DivSIMD( const fltx8 & a, const fltx8 & b )
+{
+	return CombineSIMD8( DivSIMD( a.m_lo, b.m_lo ), DivSIMD( a.m_hi, b.m_hi ) );
+}
+
+FORCEINLINE fltx8 MaddSIMD( const fltx8 & a, const fltx8 & b, const fltx8 & c )
+{
+	return CombineSIMD8( MaddSIMD( a.m_lo, b.m_lo, c.m_lo ), MaddSIMD( a.m_hi, b.m_hi, c.m_hi ) );
+}
+
+FORCEINLINE fltx8 MsubSIMD( const fltx8 & a, const fltx8 & b, const fltx8 & c )
+{
+	return CombineSIMD8( MsubSIMD( a.m_lo, b.m_lo, c.m_lo ), MsubSIMD( a.m_hi, b.m_hi, c.m_hi ) );
+}
+
+FORCEINLINE fltx8 AndSIMD( const fltx8 & a, const fltx8 & b )
+{
+	return CombineSIMD8( AndSIMD( a.m_lo, b.m_lo ), AndSIMD( a.m_hi, b.m_hi ) );
+}
+
+FORCEINLINE fltx8 AndNotSIMD( const fltx8 & a, const fltx8 & b )
+{
+	return CombineSIMD8( AndNotSIMD( a.m_lo, b.m_lo ), AndNotSIMD( a.m_hi, b.m_hi ) );
+}
+
+FORCEINLINE fltx8 OrSIMD( const fltx8 & a, const fltx8 & b )
+{
+	return CombineSIMD8( OrSIMD( a.m_lo, b.m_lo ), OrSIMD( a.m_hi, b.m_hi ) );
+}
+
+FORCEINLINE fltx8 XorSIMD( const fltx8 & a, const fltx8 & b )
+{
+	return CombineSIMD8( XorSIMD( a.m_lo, b.m_lo ), XorSIMD( a.m_hi, b.m_hi ) );
+}
+
+FORCEINLINE fltx8 NegSIMD( const fltx8 & a )
+{
+	return CombineSIMD8( NegSIMD( a.m_lo ), NegSIMD( a.m_hi ) );
+}
+
+FORCEINLINE fltx8 AbsSIMD( const fltx8 & a )
+{
+	return CombineSIMD8( AbsSIMD( a.m_lo ), AbsSIMD( a.m_hi ) );
+}
+
+FORCEINLINE fltx8 MinSIMD( const fltx8 & a, const fltx8 & b )
+{
+	return CombineSIMD8( MinSIMD( a.m_lo, b.m_lo ), MinSIMD( a.m_hi, b.m_hi ) );
+}
+
+FORCEINLINE fltx8 MaxSIMD( const fltx8 & a, const fltx8 & b )
+{
+	return CombineSIMD8( MaxSIMD( a.m_lo, b.m_lo ), MaxSIMD( a.m_hi, b.m_hi ) );
+}
+
+FORCEINLINE bi32x8 CmpEqSIMD( const fltx8 & a, const fltx8 & b )
+{
+	return CombineSIMD8( CmpEqSIMD( a.m_lo, b.m_lo ), CmpEqSIMD( a.m_hi, b.m_hi ) );
+}
+
+FORCEINLINE bi32x8 CmpGtSIMD( const fltx8 & a, const fltx8 & b )
+{
+	return CombineSIMD8( CmpGtSIMD( a.m_lo, b.m_lo ), CmpGtSIMD( a.m_hi, b.m_hi ) );
+}
+
+FORCEINLINE bi32x8 CmpGeSIMD( const fltx8 & a, const fltx8 & b )
+{
+	return CombineSIMD8( CmpGeSIMD( a.m_lo, b.m_lo ), CmpGeSIMD( a.m_hi, b.m_hi ) );
+}
+
+FORCEINLINE bi32x8 CmpLtSIMD( const fltx8 & a, const fltx8 & b )
+{
+	return CombineSIMD8( CmpLtSIMD( a.m_lo, b.m_lo ), CmpLtSIMD( a.m_hi, b.m_hi ) );
+}
+
+FORCEINLINE bi32x8 CmpLeSIMD( const fltx8 & a, const fltx8 & b )
+{
+	return CombineSIMD8( CmpLeSIMD( a.m_lo, b.m_lo ), CmpLeSIMD( a.m_hi, b.m_hi ) );
+}
+
+FORCEINLINE fltx8 MaskedAssign( const bi32x8 & ReplacementMask, const fltx8 & NewValue, const fltx8 & OldValue )
+{
+	return CombineSIMD8( MaskedAssign( ReplacementMask.m_lo, NewValue.m_lo, OldValue.m_lo ),
+						 MaskedAssign( ReplacementMask.m_hi, NewValue.m_hi, OldValue.m_hi ) );
+}
+
+FORCEINLINE int TestSignSIMD( const fltx8 & a )
+{
+	return TestSignSIMD( a.m_lo ) | ( TestSignSIMD( a.m_hi ) << 4 );
+}
+
+FORCEINLINE fltx8 SqrtSIMD( const fltx8 & a )
+{
+	return CombineSIMD8( SqrtSIMD( a.m_lo ), SqrtSIMD( a.m_hi ) );
+}
+
+FORCEINLINE fltx8 SqrtEstSIMD( const fltx8 & a )
+{
+	return CombineSIMD8( SqrtEstSIMD( a.m_lo ), SqrtEstSIMD( a.m_hi ) );
+}
+
+FORCEINLINE fltx8 ReciprocalSqrtEstSIMD( const fltx8 & a )
+{
+	return CombineSIMD8( ReciprocalSqrtEstSIMD( a.m_lo ), ReciprocalSqrtEstSIMD( a.m_hi ) );
+}
+
+FORCEINLINE fltx8 ReciprocalEstSIMD( const fltx8 & a )
+{
+	return CombineSIMD8( ReciprocalEstSIMD( a.m_lo ), ReciprocalEstSIMD( a.m_hi ) );
+}
+
+// inherits the fltx4 version's rounding mode assumption for negative values
+FORCEINLINE fltx8 FloorSIMD( const fltx8 & a )
+{
+	return CombineSIMD8( FloorSIMD( a.m_lo ), FloorSIMD( a.m_hi ) );
+}
+
+FORCEINLINE void SinCosSIMD( fltx8 &sine, fltx8 &cosine, const fltx8 &radians )
+{
+	SinCosSIMD( sine.m_lo, cosine.m_lo, radians.m_lo );
+	SinCosSIMD( sine.m_hi, cosine.m_hi, radians.m_hi );
+}
+
+#endif
+
+
+//---------------------------------------------------------------------
+// Shared by both implementations
+//---------------------------------------------------------------------
+
+FORCEINLINE_SIMD8 bool IsAnyNegative( const fltx8 & a )						// any of the eight < 0?
+{
+	return TestSignSIMD( a ) != 0;
+}
+
+FORCEINLINE_SIMD8 bool IsAllZeros( const fltx8 & a )
+{
+	return TestSignSIMD( CmpEqSIMD( a, LoadZeroSIMD8() ) ) == 0xFF;
+}
+
+/// uses newton iteration for higher precision results than ReciprocalSqrtEstSIMD
+FORCEINLINE_SIMD8 fltx8 ReciprocalSqrtSIMD( const fltx8 & a )				// 1/sqrt(a)
+{
+	fltx8 guess = ReciprocalSqrtEstSIMD( a );
+	// newton iteration for 1/sqrt(a) : y(n+1) = 1/2 (y(n)*(3-a*y(n)^2));
+	guess = MulSIMD( guess, MsubSIMD( a, MulSIMD( guess, guess ), ReplicateX8( 3.0f ) ) );
+	return MulSIMD( ReplicateX8( 0.5f ), guess );
+}
+
+/// 1/x for all 8 values. uses reciprocal approximation instruction plus newton iteration.
+FORCEINLINE_SIMD8 fltx8 ReciprocalSIMD( const fltx8 & a )					// 1/a
+{
+	fltx8 ret = ReciprocalEstSIMD( a );
+	// newton iteration is: Y(n+1) = 2*Y(n)-a*Y(n)^2
+	return MulSIMD( ret, MsubSIMD( a, ret, ReplicateX8( 2.0f ) ) );
+}
+
+FORCEINLINE_SIMD8 fltx8 SinSIMD( const fltx8 &radians )
+{
+	fltx8 sine, cosine;
+	SinCosSIMD( sine, cosine, radians );
+	return sine;
+}
+
+fltx8 Pow_FixedPoint_Exponent_SIMD( const fltx8 & x, int exponent );
+
+// PowSIMD - raise eight values to a power, with the same 2 bit fraction restrictions as
+// the fltx4 PowSIMD.
+FORCEINLINE_SIMD8 fltx8 PowSIMD( const fltx8 & x, float exponent )
+{
+	return Pow_FixedPoint_Exponent_SIMD( x, ( int )( 4.0 * exponent ) );
+}
+
+/// quick, low quality perlin-style noise() function suitable for real time use.
+/// return value is -1..1. Only reliable around +/- 1 million or so.
+fltx8 NoiseSIMD( const fltx8 & x, const fltx8 & y, const fltx8 & z );
+
+
+/// class EightVectors stores 8 independent vectors for use in SIMD processing, laid out
+/// x x x x x x x x y y y y y y y y z z z z z z z z. It's FourVectors twice as wide, and a
+/// pair of FourVectors converts in and out with LoadFourVectors/StoreFourVectors.
+class ALIGN32 EightVectors
+{
+public:
+	fltx8 x, y, z;
+
+	EightVectors( void )
+	{
+	}
+
+	explicit FORCEINLINE_SIMD8 EightVectors( float a )
+	{
+		fltx8 aReplicated = ReplicateX8( a );
+		x = y = z = aReplicated;
+	}
+
+	FORCEINLINE_SIMD8 EightVectors( fltx8 const &fl8X, fltx8 const &fl8Y, fltx8 const &fl8Z )
+	{
+		Init( fl8X, fl8Y, fl8Z );
+	}
+
+	FORCEINLINE_SIMD8 void Init( void )
+	{
+		x = y = z = LoadZeroSIMD8();
+	}
+
+	FORCEINLINE_SIMD8 void Init( float flX, float flY, float flZ )
+	{
+		x = ReplicateX8( flX );
+		y = ReplicateX8( flY );
+		z = ReplicateX8( flZ );
+	}
+
+	FORCEINLINE_SIMD8 void Init( fltx8 const &fl8X, fltx8 const &fl8Y, fltx8 const &fl8Z )
+	{
+		x = fl8X;
+		y = fl8Y;
+		z = fl8Z;
+	}
+
+	/// vectors 0..3 from lo, 4..7 from hi
+	FORCEINLINE_SIMD8 void LoadFourVectors( FourVectors const &lo, FourVectors const &hi )
+	{
+		x = CombineSIMD8( lo.x, hi.x );
+		y = CombineSIMD8( lo.y, hi.y );
+		z = CombineSIMD8( lo.z, hi.z );
+	}
+
+	FORCEINLINE_SIMD8 void StoreFourVectors( FourVectors &lo, FourVectors &hi ) const
+	{
+		lo.x = LowerSIMD( x );
+		lo.y = LowerSIMD( y );
+		lo.z = LowerSIMD( z );
+		hi.x = UpperSIMD( x );
+		hi.y = UpperSIMD( y );
+		hi.z = UpperSIMD( z );
+	}
+
+	FORCEINLINE_SIMD8 void DuplicateVector( Vector const &v )			//< set all 8 vectors to the same vector value
+	{
+		x = ReplicateX8( v.x );
+		y = ReplicateX8( v.y );
+		z = ReplicateX8( v.z );
+	}
+
+	FORCEINLINE_SIMD8 void operator+=( EightVectors const &b )			//< add 8 vectors to another 8 vectors
+	{
+		x = AddSIMD( x, b.x );
+		y = AddSIMD( y, b.y );
+		z = AddSIMD( z, b.z );
+	}
+
+	FORCEINLINE_SIMD8 void operator-=( EightVectors const &b )			//< subtract 8 vectors from another 8
+	{
+		x = SubSIMD( x, b.x );
+		y = SubSIMD( y, b.y );
+		z = SubSIMD( z, b.z );
+	}
+
+	FORCEINLINE_SIMD8 void operator*=( EightVectors const &b )			//< scale all eight vectors per component scale
+	{
+		x = MulSIMD( x, b.x );
+		y = MulSIMD( y, b.y );
+		z = MulSIMD( z, b.z );
+	}
+
+	FORCEINLINE_SIMD8 void operator*=( const fltx8 & scale )			//< scale
+	{
+		x = MulSIMD( x, scale );
+		y = MulSIMD( y, scale );
+		z = MulSIMD( z, scale );
+	}
+
+	FORCEINLINE_SIMD8 void operator*=( float scale )					//< uniformly scale all 8 vectors
+	{
+		*this *= ReplicateX8( scale );
+	}
+
+	FORCEINLINE_SIMD8 fltx8 operator*( EightVectors const &b ) const	//< 8 dot products
+	{
+		return MaddSIMD( z, b.z, MaddSIMD( y, b.y, MulSIMD( x, b.x ) ) );
+	}
+
+	FORCEINLINE_SIMD8 fltx8 operator*( Vector const &b ) const			//< dot product all 8 vectors with 1 vector
+	{
+		return MaddSIMD( z, ReplicateX8( b.z ), MaddSIMD( y, ReplicateX8( b.y ), MulSIMD( x, ReplicateX8( b.x ) ) ) );
+	}
+
+	FORCEINLINE_SIMD8 void VProduct( EightVectors const &b )			//< component by component mul
+	{
+		*this *= b;
+	}
+
+	/// squared length of all 8 vectors
+	FORCEINLINE_SIMD8 fltx8 length2( void ) const
+	{
+		return ( *this ) * ( *this );
+	}
+
+	/// return the approximate length of all 8 vectors. uses the sqrt approximation instruction
+	FORCEINLINE_SIMD8 fltx8 length( void ) const
+	{
+		return SqrtEstSIMD( length2() );
+	}
+
+	FORCEINLINE_SIMD8 fltx8 Length( void ) const
+	{
+		return SqrtSIMD( length2() );
+	}
+
+	/// normalize all 8 vectors in place. not mega-accurate (uses reciprocal approximation instruction)
+	FORCEINLINE_SIMD8 void VectorNormalizeFast( void )
+	{
+		( *this ) *= ReciprocalSqrtEstSIMD( length2() );
+	}
+
+	/// normalize all 8 vectors in place.
+	FORCEINLINE_SIMD8 void VectorNormalize( void )
+	{
+		( *this ) *= ReciprocalSqrtSIMD( length2() );
+	}
+
+	FORCEINLINE float X( int idx ) const
+	{
+		return SubFloat( x, idx );
+	}
+
+	FORCEINLINE float Y( int idx ) const
+	{
+		return SubFloat( y, idx );
+	}
+
+	FORCEINLINE float Z( int idx ) const
+	{
+		return SubFloat( z, idx );
+	}
+
+	FORCEINLINE Vector Vec( int idx ) const								//< unpack one of the vectors
+	{
+		return Vector( X( idx ), Y( idx ), Z( idx ) );
+	}
+};
+
+FORCEINLINE_SIMD8 EightVectors operator+( EightVectors const &a, EightVectors const &b )
+{
+	return EightVectors( AddSIMD( a.x, b.x ), AddSIMD( a.y, b.y ), AddSIMD( a.z, b.z ) );
+}
+
+FORCEINLINE_SIMD8 EightVectors operator-( EightVectors const &a, EightVectors const &b )
+{
+	return EightVectors( SubSIMD( a.x, b.x ), SubSIMD( a.y, b.y ), SubSIMD( a.z, b.z ) );
+}
+
+FORCEINLINE_SIMD8 EightVectors operator*( EightVectors const &a, const fltx8 &scale )
+{
+	return EightVectors( MulSIMD( a.x, scale ), MulSIMD( a.y, scale ), MulSIMD( a.z, scale ) );
+}
+
+fltx8 NoiseSIMD( EightVectors const &v );
+
+#endif // SSEMATH8_H
@@ -0,0 +1,166 @@
+//===== Copyright 1996-2010, Valve Corporation, All rights reserved. ======//
+//
+// Purpose: - EightQuaternions, the fltx8 counterpart of FourQuaternions.
+//
+//===========================================================================//
+
+#ifndef SSEQUATMATH8_H
+#define SSEQUATMATH8_H
+
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include "mathlib/ssequaternion.h"
+#include "mathlib/ssemath8.h"
+
+
+/// class EightQuaternions stores 8 independent quaternions in structure of arrays form, the
+/// same way FourQuaternions stores 4. Same code requirements as the rest of ssemath8.h.
+class ALIGN32 EightQuaternions
+{
+public:
+	fltx8 x, y, z, w;
+
+	EightQuaternions( void )
+	{
+	}
+
+	FORCEINLINE_SIMD8 EightQuaternions( const fltx8 &_x,
+										const fltx8 &_y,
+										const fltx8 &_z,
+										const fltx8 &_w )
+										: x( _x ), y( _y ), z( _z ), w( _w )
+	{}
+
+	/// quaternions 0..3 from lo, 4..7 from hi
+	FORCEINLINE_SIMD8 void LoadFourQuaternions( FourQuaternions const &lo, FourQuaternions const &hi )
+	{
+		x = CombineSIMD8( lo.x, hi.x );
+		y = CombineSIMD8( lo.y, hi.y );
+		z = CombineSIMD8( lo.z, hi.z );
+		w = CombineSIMD8( lo.w, hi.w );
+	}
+
+	FORCEINLINE_SIMD8 void StoreFourQuaternions( FourQuaternions &lo, FourQuaternions &hi ) const
+	{
+		lo.x = LowerSIMD( x );
+		lo.y = LowerSIMD( y );
+		lo.z = LowerSIMD( z );
+		lo.w = LowerSIMD( w );
+		hi.x = UpperSIMD( x );
+		hi.y = UpperSIMD( y );
+		hi.z = UpperSIMD( z );
+		hi.w = UpperSIMD( w );
+	}
+
+	/// load 8 consecutive QuaternionAligneds, performing the transpose
+	FORCEINLINE_SIMD8 void LoadAndSwizzleAligned( const QuaternionAligned *qs )
+	{
+		FourQuaternions lo, hi;
+		lo.LoadAndSwizzleAligned( qs );
+		hi.LoadAndSwizzleAligned( qs + 4 );
+		LoadFourQuaternions( lo, hi );
+	}
+
+	/// store out to 8 consecutive QuaternionAligneds
+	FORCEINLINE_SIMD8 void SwizzleAndStoreAligned( QuaternionAligned *qs ) const
+	{
+		FourQuaternions lo, hi;
+		StoreFourQuaternions( lo, hi );
+		lo.SwizzleAndStoreAligned( qs );
+		hi.SwizzleAndStoreAligned( qs + 4 );
+	}
+
+	/// this = this * q; flipped where the two point into different hemispheres, like FourQuaternions::Mul
+	FORCEINLINE_SIMD8 EightQuaternions Mul( EightQuaternions const &q ) const;
+
+	/// negate the vector part
+	FORCEINLINE_SIMD8 EightQuaternions Conjugate() const
+	{
+		return EightQuaternions( NegSIMD( x ), NegSIMD( y ), NegSIMD( z ), w );
+	}
+
+	/// normalize all 8 in place
+	FORCEINLINE_SIMD8 void Normalize( void )
+	{
+		fltx8 lenSq = MaddSIMD( x, x, MaddSIMD( y, y, MaddSIMD( z, z, MulSIMD( w, w ) ) ) );
+		fltx8 invLen = ReciprocalSqrtSIMD( lenSq );
+		x = MulSIMD( x, invLen );
+		y = MulSIMD( y, invLen );
+		z = MulSIMD( z, invLen );
+		w = MulSIMD( w, invLen );
+	}
+
+	// rotate (in place) an EightVectors by these quaternions
+	FORCEINLINE_SIMD8 void RotateEightVectors( EightVectors * RESTRICT vecs ) const;
+};
+
+
+FORCEINLINE_SIMD8 fltx8 Dot( const EightQuaternions &a, const EightQuaternions &b )
+{
+	return MaddSIMD( a.x, b.x, MaddSIMD( a.y, b.y, MaddSIMD( a.z, b.z, MulSIMD( a.w, b.w ) ) ) );
+}
+
+FORCEINLINE_SIMD8 EightQuaternions EightQuaternions::Mul( EightQuaternions const &q ) const
+{
+	EightQuaternions ret;
+
+	// as we do the multiplication, also do a dot product, so we know whether
+	// one of the quats is backwards and if we therefore have to negate at the end
+	fltx8 dotProduct = MulSIMD( w, q.w );
+
+	ret.w = MulSIMD( w, q.w ); // W = w1w2
+	ret.x = MulSIMD( w, q.x ); // X = w1x2
+	ret.y = MulSIMD( w, q.y ); // Y = w1y2
+	ret.z = MulSIMD( w, q.z ); // Z = w1z2
+
+	dotProduct = MaddSIMD( x, q.x, dotProduct );
+	ret.w = MsubSIMD( x, q.x, ret.w ); // W = w1w2 - x1x2
+	ret.x = MaddSIMD( x, q.w, ret.x ); // X = w1x2 + x1w2
+	ret.y = MsubSIMD( x, q.z, ret.y ); // Y = w1y2 - x1z2
+	ret.z = MaddSIMD( x, q.y, ret.z ); // Z = w1z2 + x1y2
+
+	dotProduct = MaddSIMD( y, q.y, dotProduct );
+	ret.w = MsubSIMD( y, q.y, ret.w ); // W = w1w2 - x1x2 - y1y2
+	ret.x = MaddSIMD( y, q.z, ret.x ); // X = w1x2 + x1w2 + y1z2
+	ret.y = MaddSIMD( y, q.w, ret.y ); // Y = w1y2 - x1z2 + y1w2
+	ret.z = MsubSIMD( y, q.x, ret.z ); // Z = w1z2 + x1y2 - y1x2
+
+	dotProduct = MaddSIMD( z, q.z, dotProduct );
+	ret.w = MsubSIMD( z, q.z, ret.w ); // W = w1w2 - x1x2 - y1y2 - z1z2
+	ret.x = MsubSIMD( z, q.y, ret.x ); // X = w1x2 + x1w2 + y1z2 - z1y2
+	ret.y = MaddSIMD( z, q.x, ret.y ); // Y = w1y2 - x1z2 + y1w2 + z1x2
+	ret.z = MaddSIMD( z, q.w, ret.z ); // Z = w1z2 + x1y2 - y1x2 + z1w2
+
+	fltx8 Zero = LoadZeroSIMD8();
+	bi32x8 control = CmpLtSIMD( dotProduct, Zero );
+	fltx8 signMask = MaskedAssign( control, ReplicateX8( -0.0f ), Zero ); // negate quats where q1.q2 < 0
+	ret.w = XorSIMD( signMask, ret.w );
+	ret.x = XorSIMD( signMask, ret.x );
+	ret.y = XorSIMD( signMask, ret.y );
+	ret.z = XorSIMD( signMask, ret.z );
+
+	return ret;
+}
+
+FORCEINLINE_SIMD8 void EightQuaternions::RotateEightVectors( EightVectors * RESTRICT vecs ) const
+{
+	fltx8 tmpX, tmpY, tmpZ, tmpW;
+	fltx8 outX, outY, outZ;
+
+	tmpX = MsubSIMD( z, vecs->y, MaddSIMD( w, vecs->x, MulSIMD( y, vecs->z ) ) );
+	tmpY = MsubSIMD( x, vecs->z, MaddSIMD( w, vecs->y, MulSIMD( z, vecs->x ) ) );
+	tmpZ = MsubSIMD( y, vecs->x, MaddSIMD( w, vecs->z, MulSIMD( x, vecs->y ) ) );
+	tmpW = MaddSIMD( z, vecs->z, MaddSIMD( x, vecs->x, MulSIMD( y, vecs->y ) ) );
+
+	outX = MaddSIMD( tmpZ, y, MsubSIMD( tmpY, z, MaddSIMD( tmpW, x, MulSIMD( tmpX, w ) ) ) );
+	outY = MaddSIMD( tmpX, z, MsubSIMD( tmpZ, x, MaddSIMD( tmpW, y, MulSIMD( tmpY, w ) ) ) );
+	outZ = MaddSIMD( tmpY, x, MsubSIMD( tmpX, y, MaddSIMD( tmpW, z, MulSIMD( tmpZ, w ) ) ) );
+
+	vecs->x = outX;
+	vecs->y = outY;
+	vecs->z = outZ;
+}
+
+#endif // SSEQUATMATH8_H
@@ -185,8 +185,8 @@ struct SerializerFieldLookup_t
 	int m_FieldIndex;
 };
 
-template<> struct DefaultEqualFunctor<SerializerFieldLookup_t> { bool operator()( SerializerFieldLookup_t a, SerializerFieldLookup_t b ) const { return a.m_FieldName == b.m_FieldName; } };
-template<> struct DefaultHashFunctor<SerializerFieldLookup_t> { unsigned int operator()( SerializerFieldLookup_t a ) const { return MurmurHash2LowerCase( a.m_FieldName.String(), CODEGEN_HASH_TOKEN ); } };
+template<> struct DefaultEqualFunctor<SerializerFieldLookup_t> { bool operator()( const SerializerFieldLookup_t &a, const SerializerFieldLookup_t &b ) const { return a.m_FieldName == b.m_FieldName; } };
+template<> struct DefaultHashFunctor<SerializerFieldLookup_t> { unsigned int operator()( const SerializerFieldLookup_t &a ) const { return MurmurHash2LowerCase( a.m_FieldName.String(), a.m_FieldName.Length(), CODEGEN_HASH_TOKEN ); } };
 
 class CNetworkSerializerClassInfo
 {
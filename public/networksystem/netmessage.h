@@ -9,6 +9,7 @@
 #include "iserver.h"
 #include "networksystem/inetworkmessages.h"
 #include "networksystem/inetworkserializer.h"
+#include "tier1/utlperfecthash.h"
 
 #include <typeinfo>
 
@@ -37,6 +38,13 @@ inline constexpr const char *k_pszNetGroupNames[ SG_TOTAL ] =
 	"Decals"            // SG_DECALS = 18
 };
 
+// Where a name is in k_pszNetGroupNames, which is its SG_ group, in any case; -1 if it isn't there
+inline int FindNetGroupByName( const char *pszName )
+{
+	static constexpr auto s_Table = MakePerfectHash< true >( k_pszNetGroupNames );
+	return s_Table.Find( pszName );
+}
+
 class CNetMessage
 {
 public:
@@ -23,6 +23,7 @@
 #include "tier0/platform.h"
 #include "tier1/utlvector.h"
 #include "tier1/utlrbtree.h"
+#include "tier1/alloctrackermacros.h"
 
 //-----------------------------------------------------------------------------
 // Purpose: Optimized pool memory allocator
@@ -107,6 +108,7 @@ class CUtlMemoryPool : public CUtlMemoryPoolBase
 public:
 	CUtlMemoryPool( int numElements, MemoryPoolGrowType_t growMode = UTLMEMORYPOOL_GROW_FAST, const char *pszAllocOwner = MEM_ALLOC_CLASSNAME(T), MemAllocAttribute_t allocAttribute = MemAllocAttribute_Unk0 ) 
 		: CUtlMemoryPoolBase( sizeof(T), numElements, alignof(T), growMode, pszAllocOwner, allocAttribute ) {}
+	~CUtlMemoryPool() { ALLOC_TRACKER_FREE_MULTIPLE( T, Count(), sizeof( T ) ); }
 
 	T*		Alloc();
 	T*		AllocZero();
@@ -333,6 +335,7 @@ inline T* CUtlMemoryPool<T>::Alloc()
 
 	if ( pRet )
 	{
+		ALLOC_TRACKER_ALLOC( T, sizeof( T ) );
 		Construct( pRet );
 	}
 	return pRet;
@@ -350,6 +353,7 @@ inline T* CUtlMemoryPool<T>::AllocZero()
 
 	if ( pRet )
 	{
+		ALLOC_TRACKER_ALLOC( T, sizeof( T ) );
 		Construct( pRet );
 	}
 	return pRet;
@@ -360,6 +364,7 @@ inline void CUtlMemoryPool<T>::Free(T *pMem)
 {
 	if ( pMem )
 	{
+		ALLOC_TRACKER_FREE( T, sizeof( T ) );
 		Destruct( pMem );
 	}
 
@@ -369,6 +374,7 @@ inline void CUtlMemoryPool<T>::Free(T *pMem)
 template< class T >
 inline void CUtlMemoryPool<T>::Clear()
 {
+	ALLOC_TRACKER_FREE_MULTIPLE( T, Count(), sizeof( T ) );
 	CUtlMemoryPoolBase::ClearDestruct( (void (*)( void* ))&Destruct<T> );
 }
 
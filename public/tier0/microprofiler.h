@@ -200,7 +200,7 @@ public:
 #if defined( _X360 ) || defined( _PS3 )
 		return numTimeBaseTicks / 79800.0 ;
 #else
-		return numTimeBaseTicks / ( GetCPUInformation().m_Speed * 0.001f );
+		return numTimeBaseTicks / ( Plat_CPUTickFrequency() * 0.001f );
 #endif
 	}
 	float GetAverageTicks() const
@@ -21,6 +21,26 @@
 #define DEBUG_STRINGTOKENS 0
 #define STRINGTOKEN_MURMURHASH_SEED 0x31415926
 
+// consteval where the compiler has it, constexpr before C++20
+#ifndef STRINGTOKEN_CONSTEVAL
+#ifdef __cpp_consteval
+#define STRINGTOKEN_CONSTEVAL consteval
+#else
+#define STRINGTOKEN_CONSTEVAL constexpr
+#endif
+#endif
+
+// Tokens of const char arrays, literals above all, are constexpr and hashed by the compiler
+// wherever they are constant. Defining STRINGTOKEN_CONSTEVAL_LITERALS makes that a
+// requirement, for code that wants to be sure no literal is hashed at run time; a const
+// array that isn't a constant, such as a literal passed on through a const char (&)[N]
+// parameter, then has to use the ( pointer, length ) constructor.
+#ifdef STRINGTOKEN_CONSTEVAL_LITERALS
+#define STRINGTOKEN_LITERAL STRINGTOKEN_CONSTEVAL
+#else
+#define STRINGTOKEN_LITERAL constexpr
+#endif
+
 // Macros are intended to be used between CUtlStringToken (always lowercase)
 #define MAKE_STRINGTOKEN(pstr) CUtlStringToken::Hash( (pstr), static_cast<int>(strlen(pstr)), STRINGTOKEN_MURMURHASH_SEED )
 #define MAKE_STRINGTOKEN_UTL(containerName) CUtlStringToken::Hash( (containerName).Get(), (containerName).Length(), STRINGTOKEN_MURMURHASH_SEED )
@@ -58,7 +78,9 @@ public:
 
 		while ( nLength >= 4 )
 		{
-			uint32 k = CASEINSENSITIVE ? ( TOLOWERU( pString[ 0 ] ) | ( TOLOWERU( pString[ 1 ] ) << 8 ) | ( TOLOWERU( pString[ 2 ] ) << 16 ) | ( TOLOWERU( pString[ 3 ] ) << 24 ) ) : LittleDWord( *(uint32 *)pString );
+			// Assembled byte by byte so it can run in the compiler; it's the little endian load either way
+			uint32 k = CASEINSENSITIVE ? ( TOLOWERU( pString[ 0 ] ) | ( TOLOWERU( pString[ 1 ] ) << 8 ) | ( TOLOWERU( pString[ 2 ] ) << 16 ) | ( TOLOWERU( pString[ 3 ] ) << 24 ) )
+			                           : ( ( uint32 )( uint8 )pString[ 0 ] | ( ( uint32 )( uint8 )pString[ 1 ] << 8 ) | ( ( uint32 )( uint8 )pString[ 2 ] << 16 ) | ( ( uint32 )( uint8 )pString[ 3 ] << 24 ) );
 
 			k *= m;
 			k ^= k >> r;
@@ -91,8 +113,19 @@ public:
 		return h;
 	}
 
-	CUtlStringToken( uint32 nHashCode = 0 ) : m_nHashCode( nHashCode ) {}
-	template < uintp N > FORCEINLINE constexpr CUtlStringToken( const char (&str)[N] ) : m_nHashCode( Hash( str, N - 1 ) ) {}
+	// Length of the string in a char array, which ends at its terminator rather than at the end of the array
+	template < uintp N > static constexpr int ArrayLength( const char (&str)[N] )
+	{
+		int nLength = 0;
+		while ( nLength < static_cast< int >( N ) && str[nLength] )
+			nLength++;
+
+		return nLength;
+	}
+
+	constexpr CUtlStringToken( uint32 nHashCode = 0 ) : m_nHashCode( nHashCode ) {}
+	template < uintp N > STRINGTOKEN_LITERAL CUtlStringToken( const char (&str)[N] ) : m_nHashCode( Hash( str, ArrayLength( str ) ) ) {}
+	template < uintp N > constexpr CUtlStringToken( char (&str)[N] ) : m_nHashCode( Hash( str, ArrayLength( str ) ) ) {}
 	CUtlStringToken( const char *pString, int nLen ) : m_nHashCode( Hash( pString, nLen ) ) {}
 	CUtlStringToken( const CUtlString &str ) : CUtlStringToken( str.Get(), str.Length() ) {}
 	CUtlStringToken( const CBufferString &buffer ) : CUtlStringToken( buffer.Get(), buffer.Length() ) {}
@@ -170,7 +203,11 @@ FORCEINLINE uint32 HashStringWithBuffer( const char *pString, int nLen = -1 )
 template< bool CASEINSENSITIVE = true, bool TRACKCREATION = false >
 FORCEINLINE CUtlStringToken MakeStringToken2( const char *pString, int nLen = -1 )
 {
-	uint32 nHash = HashStringWithBuffer< CASEINSENSITIVE >( pString, nLen );
+	if ( nLen < 0 )
+		nLen = static_cast<int>(strlen(pString));
+
+	// Lowered as it's hashed, no copy; the tail is read as char like CUtlStringToken::Hash so it matches literal tokens
+	uint32 nHash = MurmurHash2StringToken( pString, nLen, STRINGTOKEN_MURMURHASH_SEED, CASEINSENSITIVE );
 
 	if constexpr ( TRACKCREATION )
 		TrackStringToken( nHash, pString );
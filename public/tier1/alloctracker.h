@@ -0,0 +1,201 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: Allocation tracking for the tier1 containers (tier1/alloctracker.cpp)
+//
+// Built with SOURCESDK_ALLOC_TRACKER, CUtlVectorMemory, CUtlLeanVector,
+// CKV3Arena and CUtlMemoryPool count what they allocate and free against a
+// tag: the element type and the innermost ALLOC_TRACKER_SITE( "name" ) scope,
+// both as CUtlStringTokens. Counters live per thread and are only written by
+// their thread, so a record is a probe of a small table and four plain
+// stores. CAllocTrackerSnapshot (tier1/alloctrackersnapshot.h) sums them on
+// demand.
+//
+// A free is credited to the site the freeing thread is in, so totals per
+// type are exact while totals per site only are when a site frees what it
+// allocates.
+//
+// Without SOURCESDK_ALLOC_TRACKER the hooks compile to nothing. Headers that
+// only place hooks include tier1/alloctrackermacros.h, which pulls this one in
+// only when the tracker is built.
+//
+//=============================================================================//
+
+#ifndef ALLOCTRACKER_H
+#define ALLOCTRACKER_H
+
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include "tier0/platform.h"
+
+#include <atomic>
+
+// Tags each thread can count before the rest share an overflow counter; must be a power of two
+#ifndef ALLOC_TRACKER_THREAD_SLOTS
+#define ALLOC_TRACKER_THREAD_SLOTS 1024
+#endif
+
+#define ALLOC_TRACKER_MAX_PROBE 16
+
+// The site of anything allocated outside an ALLOC_TRACKER_SITE scope
+#define ALLOC_TRACKER_NO_SITE 0
+
+struct AllocTrackerCounter_t
+{
+	// ( type << 32 ) | site, 0 while the slot is unclaimed
+	std::atomic< uint64 > m_nTag;
+
+	std::atomic< int64 > m_nAllocs;
+	std::atomic< int64 > m_nFrees;
+	std::atomic< int64 > m_nAllocBytes;
+	std::atomic< int64 > m_nFreeBytes;
+
+	// Owner thread only
+	void Add( int64 nCount, int64 nBytes, std::atomic< int64 > &count, std::atomic< int64 > &bytes )
+	{
+		count.store( count.load( std::memory_order_relaxed ) + nCount, std::memory_order_relaxed );
+		bytes.store( bytes.load( std::memory_order_relaxed ) + nBytes, std::memory_order_relaxed );
+	}
+};
+
+class CAllocTrackerThread
+{
+public:
+	CAllocTrackerThread();
+
+	// Owner thread only. Slots are claimed once and never given back, the
+	// counters in them only grow, so readers can sum them at any time.
+	AllocTrackerCounter_t &Find( uint64 nTag )
+	{
+		uint32 nSlot = ( uint32 )( ( nTag * 0x9E3779B97F4A7C15ull ) >> 32 ) & ( ALLOC_TRACKER_THREAD_SLOTS - 1 );
+		for ( int nProbe = 0; nProbe < ALLOC_TRACKER_MAX_PROBE; nProbe++ )
+		{
+			AllocTrackerCounter_t &counter = m_Counters[nSlot];
+			uint64 nSlotTag = counter.m_nTag.load( std::memory_order_relaxed );
+			if ( nSlotTag == nTag )
+				return counter;
+
+			if ( !nSlotTag )
+			{
+				counter.m_nTag.store( nTag, std::memory_order_release );
+				return counter;
+			}
+
+			nSlot = ( nSlot + 1 ) & ( ALLOC_TRACKER_THREAD_SLOTS - 1 );
+		}
+
+		return m_Overflow;
+	}
+
+	// Set while a thread owns the counters; they are reused, never freed
+	std::atomic< bool > m_bInUse;
+	CAllocTrackerThread *m_pNext;
+
+	AllocTrackerCounter_t m_Overflow;
+	AllocTrackerCounter_t m_Counters[ALLOC_TRACKER_THREAD_SLOTS];
+};
+
+extern thread_local CAllocTrackerThread *g_pAllocTrackerThread;
+extern thread_local uint32 g_nAllocTrackerSite;
+
+// Claims counters for the calling thread the first time it records
+CAllocTrackerThread *AllocTracker_AttachThread();
+
+// Gives the calling thread's counters back when the thread is about to exit
+void AllocTracker_DetachThread();
+
+inline CAllocTrackerThread *AllocTracker_GetThread()
+{
+	CAllocTrackerThread *pThread = g_pAllocTrackerThread;
+	return pThread ? pThread : AllocTracker_AttachThread();
+}
+
+inline void AllocTracker_RecordAlloc( uint32 nType, int64 nBytes, int64 nCount = 1 )
+{
+	AllocTrackerCounter_t &counter = AllocTracker_GetThread()->Find( ( ( uint64 )nType << 32 ) | g_nAllocTrackerSite );
+	counter.Add( nCount, nBytes, counter.m_nAllocs, counter.m_nAllocBytes );
+}
+
+inline void AllocTracker_RecordFree( uint32 nType, int64 nBytes, int64 nCount = 1 )
+{
+	AllocTrackerCounter_t &counter = AllocTracker_GetThread()->Find( ( ( uint64 )nType << 32 ) | g_nAllocTrackerSite );
+	counter.Add( nCount, nBytes, counter.m_nFrees, counter.m_nFreeBytes );
+}
+
+// Both return the CUtlStringToken of the name and remember the name for the
+// dumps. Names must outlive the tracker; string literals do.
+uint32 AllocTracker_RegisterType( const char *pszFunctionSignature );
+uint32 AllocTracker_RegisterSite( const char *pszName );
+
+// NULL for a token nothing registered
+const char *AllocTracker_GetName( uint32 nToken );
+
+// The type token is taken from the name the compiler gives T, without RTTI.
+// The static is constant initialized, so it needs no guard (the build has
+// -fno-threadsafe-statics); threads racing on the first call both register,
+// which hands them the same token.
+template< class T >
+inline uint32 AllocTracker_TypeToken()
+{
+	static std::atomic< uint32 > s_nType( 0 );
+	uint32 nType = s_nType.load( std::memory_order_relaxed );
+	if ( !nType )
+	{
+#ifdef _MSC_VER
+		nType = AllocTracker_RegisterType( __FUNCSIG__ );
+#else
+		nType = AllocTracker_RegisterType( __PRETTY_FUNCTION__ );
+#endif
+		s_nType.store( nType, std::memory_order_relaxed );
+	}
+
+	return nType;
+}
+
+// An ALLOC_TRACKER_SITE, registered the first time it's entered the same way
+class CAllocTrackerSite
+{
+public:
+	constexpr explicit CAllocTrackerSite( const char *pszName ) : m_pszName( pszName ), m_nSite( ALLOC_TRACKER_NO_SITE )
+	{
+	}
+
+	uint32 GetSite()
+	{
+		uint32 nSite = m_nSite.load( std::memory_order_relaxed );
+		if ( nSite == ALLOC_TRACKER_NO_SITE )
+		{
+			nSite = AllocTracker_RegisterSite( m_pszName );
+			m_nSite.store( nSite, std::memory_order_relaxed );
+		}
+
+		return nSite;
+	}
+
+private:
+	const char *m_pszName;
+	std::atomic< uint32 > m_nSite;
+};
+
+class CAllocTrackerSiteScope
+{
+public:
+	explicit CAllocTrackerSiteScope( uint32 nSite ) : m_nPrevSite( g_nAllocTrackerSite )
+	{
+		g_nAllocTrackerSite = nSite;
+	}
+
+	~CAllocTrackerSiteScope()
+	{
+		g_nAllocTrackerSite = m_nPrevSite;
+	}
+
+private:
+	uint32 m_nPrevSite;
+};
+
+// The ALLOC_TRACKER_* hooks
+#include "tier1/alloctrackermacros.h"
+
+#endif // ALLOCTRACKER_H
@@ -0,0 +1,45 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: The ALLOC_TRACKER_* hooks of tier1/alloctracker.h. Containers
+//			include this one, so a build without SOURCESDK_ALLOC_TRACKER
+//			doesn't pull the tracker's counters into every file.
+//
+//=============================================================================//
+
+#ifndef ALLOCTRACKERMACROS_H
+#define ALLOCTRACKERMACROS_H
+
+#ifdef _WIN32
+#pragma once
+#endif
+
+#ifdef SOURCESDK_ALLOC_TRACKER
+
+#include "tier1/alloctracker.h"
+
+#define ALLOC_TRACKER_CONCAT_( a, b ) a##b
+#define ALLOC_TRACKER_CONCAT( a, b ) ALLOC_TRACKER_CONCAT_( a, b )
+
+#define ALLOC_TRACKER_SITE_( name, id ) \
+	static CAllocTrackerSite ALLOC_TRACKER_CONCAT( s_AllocTrackerSite, id )( name ); \
+	CAllocTrackerSiteScope ALLOC_TRACKER_CONCAT( allocTrackerSiteScope, id )( ALLOC_TRACKER_CONCAT( s_AllocTrackerSite, id ).GetSite() )
+
+// Credits the container allocations in the rest of the enclosing scope to a site; name has to be a string literal
+#define ALLOC_TRACKER_SITE( name ) ALLOC_TRACKER_SITE_( name, __COUNTER__ )
+
+#define ALLOC_TRACKER_ALLOC( T, nBytes )	AllocTracker_RecordAlloc( AllocTracker_TypeToken< T >(), ( int64 )( nBytes ) )
+#define ALLOC_TRACKER_FREE( T, nBytes )		AllocTracker_RecordFree( AllocTracker_TypeToken< T >(), ( int64 )( nBytes ) )
+
+// nCount blocks of nBytes each released at once, as a pool does when it's cleared
+#define ALLOC_TRACKER_FREE_MULTIPLE( T, nCount, nBytes )	AllocTracker_RecordFree( AllocTracker_TypeToken< T >(), ( int64 )( nCount ) * ( int64 )( nBytes ), ( int64 )( nCount ) )
+
+#else
+
+#define ALLOC_TRACKER_SITE( name )			((void)0)
+#define ALLOC_TRACKER_ALLOC( T, nBytes )	((void)0)
+#define ALLOC_TRACKER_FREE( T, nBytes )		((void)0)
+#define ALLOC_TRACKER_FREE_MULTIPLE( T, nCount, nBytes )	((void)0)
+
+#endif // SOURCESDK_ALLOC_TRACKER
+
+#endif // ALLOCTRACKERMACROS_H
@@ -0,0 +1,67 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: Point in time totals of the allocation tracker (tier1/alloctracker.cpp)
+//
+// Capture sums every thread's counters into one entry per type and site.
+// Two captures diff into what was allocated and freed between them, which
+// is what to look at for growth over a long uptime. Capturing takes no lock
+// the recording threads see.
+//
+//=============================================================================//
+
+#ifndef ALLOCTRACKERSNAPSHOT_H
+#define ALLOCTRACKERSNAPSHOT_H
+
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include "tier1/alloctracker.h"
+#include "tier1/utlvector.h"
+#include "tier0/utlstringtoken.h"
+
+class CUtlBuffer;
+
+struct AllocTrackerEntry_t
+{
+	CUtlStringToken m_Type;		// 0 for what went past a thread's tag table
+	CUtlStringToken m_Site;		// ALLOC_TRACKER_NO_SITE outside any scope
+
+	int64 m_nAllocs;
+	int64 m_nFrees;
+	int64 m_nAllocBytes;
+	int64 m_nFreeBytes;
+
+	int64 LiveCount() const { return m_nAllocs - m_nFrees; }
+	int64 LiveBytes() const { return m_nAllocBytes - m_nFreeBytes; }
+};
+
+class CAllocTrackerSnapshot
+{
+public:
+	// Replaces the entries with the current totals, ordered by tag
+	void Capture();
+
+	// What happened between two captures of the same process, ordered by tag;
+	// tags with no activity in between are left out
+	static void Diff( const CAllocTrackerSnapshot &before, const CAllocTrackerSnapshot &after, CAllocTrackerSnapshot &out );
+
+	// Largest live bytes first
+	void SortByLiveBytes();
+
+	// A text table of the first nMaxEntries entries (all for -1) and their sum
+	void Dump( CUtlBuffer &buf, int nMaxEntries = -1 ) const;
+
+	int Count() const { return m_Entries.Count(); }
+	const AllocTrackerEntry_t &operator[]( int i ) const { return m_Entries[i]; }
+
+	// NULL if nothing with this type and site was counted
+	const AllocTrackerEntry_t *Find( CUtlStringToken type, CUtlStringToken site = ALLOC_TRACKER_NO_SITE ) const;
+
+	int64 LiveBytes() const;
+
+private:
+	CUtlVector< AllocTrackerEntry_t > m_Entries;
+};
+
+#endif // ALLOCTRACKERSNAPSHOT_H
@@ -0,0 +1,181 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: Per-thread bump arena for transient CBufferStrings (tier1/bufferstringarena.cpp)
+//
+// A CBufferString that outgrows its inline bytes goes to the heap, and a
+// call that formats a handful of values does that for each of them. Inside a
+// CBufferStringArenaScope a CArenaBufferString takes its buffer from a bump
+// region of the thread instead, and leaving the scope gives the whole region
+// back at once:
+//
+//	CBufferStringArenaScope scope;
+//	CArenaBufferString prev_str, new_str;
+//	TypeTraits()->ValueToString( value, new_str );
+//
+// Growth is still tier0's: a string that needs more than it was given,
+// through anything that takes a CBufferString &, moves itself to the heap
+// like any other. The string's own Format/AppendFormat grow it in the arena.
+//
+// A string the scope doesn't outlive, a member or one made before the scope,
+// keeps its contents: leaving the scope copies whatever is still in its part
+// of the arena to the heap. Outside of any scope a CArenaBufferString is a
+// plain CBufferString.
+//
+// The one thing that escapes unseen is a move into a plain CBufferString,
+// which takes the buffer as is; Promote() first.
+//
+//=============================================================================//
+
+#ifndef BUFFERSTRINGARENA_H
+#define BUFFERSTRINGARENA_H
+
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include "tier0/platform.h"
+#include "tier0/bufferstring.h"
+
+#include <stdarg.h>
+
+class CArenaBufferString;
+
+class CBufferStringArena
+{
+public:
+	// Strings bigger than a block aren't worth keeping around, they go to the heap
+	enum { BLOCK_SIZE = 64 * 1024 };
+
+	struct Block_t
+	{
+		Block_t *m_pNext;
+		uint64 m_nIndex;
+
+		char *Data() { return reinterpret_cast< char * >( this + 1 ); }
+	};
+
+	struct Mark_t
+	{
+		Block_t *m_pBlock;
+		int m_nUsed;
+	};
+
+	CBufferStringArena();
+	~CBufferStringArena();
+
+	// NULL when nBytes won't fit a block. nPosition is where it starts counted over
+	// all the blocks, which only goes up as more is allocated
+	char *Alloc( int nBytes, uint64 &nPosition );
+
+	// In place, when it's the last allocation and the innermost scope made it
+	bool Extend( uint64 nPosition, int nOldBytes, int nNewBytes );
+
+	// Given back only when it's the last allocation and the innermost scope made it,
+	// anything else waits for the scope to end
+	void Free( uint64 nPosition, int nBytes );
+
+	Mark_t GetMark() const { Mark_t mark = { m_pBlock, m_nUsed }; return mark; }
+	uint64 GetPosition() const { return Position( m_pBlock, m_nUsed ); }
+
+	// Bytes the blocks take, for the tests and benchmarks
+	int64 GetReservedSize() const { return m_nBlocks * ( int64 )BLOCK_SIZE; }
+	int GetScopeDepth() const { return m_nScopeDepth; }
+
+private:
+	friend class CArenaBufferString;
+	friend class CBufferStringArenaScope;
+
+	// A byte apart between blocks, so the end of one block isn't mistaken for the start of the next
+	static uint64 Position( const Block_t *pBlock, int nUsed ) { return pBlock ? pBlock->m_nIndex * ( BLOCK_SIZE + 1 ) + nUsed : 0; }
+
+	void Link( CArenaBufferString *pString );
+	void Unlink( CArenaBufferString *pString );
+
+	void EnterScope( uint64 &nPrevScopePosition );
+	void LeaveScope( const Mark_t &mark, uint64 nPrevScopePosition );
+
+	Block_t *m_pFirst;
+	Block_t *m_pBlock;
+	int m_nUsed;
+	int m_nBlocks;
+
+	// Strings with a buffer in the arena, newest first, which is also by position from the top
+	CArenaBufferString *m_pStrings;
+
+	uint64 m_nScopePosition;
+	int m_nScopeDepth;
+};
+
+// Non-NULL while the thread is in a CBufferStringArenaScope
+extern thread_local CBufferStringArena *g_pBufferStringArena;
+
+// The thread's arena, made the first time
+CBufferStringArena *BufferStringArena_GetThread();
+
+class CBufferStringArenaScope
+{
+public:
+	// Not entered when bEnter is false, for callers that only sometimes format anything
+	explicit CBufferStringArenaScope( bool bEnter = true );
+	~CBufferStringArenaScope();
+
+private:
+	CBufferStringArenaScope( const CBufferStringArenaScope & ) = delete;
+	CBufferStringArenaScope &operator=( const CBufferStringArenaScope & ) = delete;
+
+	CBufferStringArena *m_pArena;
+	CBufferStringArena::Mark_t m_Mark;
+	uint64 m_nPrevScopePosition;
+};
+
+class CArenaBufferString : public CBufferString
+{
+public:
+	using BaseClass = CBufferString;
+
+	// Bytes asked of the arena up front, past the terminator
+	enum { DEFAULT_CAPACITY = 256 };
+
+	explicit CArenaBufferString( int nCapacity = DEFAULT_CAPACITY ) : m_pArenaBuffer( NULL ) { if ( g_pBufferStringArena ) Attach( nCapacity ); }
+	CArenaBufferString( const char *pString, int nLen = -1 ) : CArenaBufferString() { Assign( pString, nLen ); }
+	CArenaBufferString( const CBufferString &copyFrom ) : CArenaBufferString( copyFrom.Get(), copyFrom.Length() ) {}
+	CArenaBufferString( const CArenaBufferString &copyFrom ) : CArenaBufferString( copyFrom.Get(), copyFrom.Length() ) {}
+	~CArenaBufferString() { if ( m_pArenaBuffer ) Detach(); }
+
+	// Copies, even from an rvalue: taking the buffer of another arena string would take it out of sight
+	CArenaBufferString &operator=( const CArenaBufferString &copyFrom ) { Assign( copyFrom.Get(), copyFrom.Length() ); return *this; }
+	CArenaBufferString &operator=( CArenaBufferString &&moveFrom ) { Assign( moveFrom.Get(), moveFrom.Length() ); return *this; }
+	using BaseClass::operator=;
+
+	// Whether the contents are still in the arena, and not moved to the heap by tier0 growing them
+	bool IsInArena() const { return m_pArenaBuffer && String() == m_pArenaBuffer; }
+
+	// Moves the contents to the heap, for a string that's handed on past the scope
+	void Promote();
+
+	// Room for nCapacity chars and the terminator, in the arena; false when the string
+	// isn't in it or it won't fit a block
+	bool Reserve( int nCapacity );
+
+	// Formatted in the arena directly, measured by the formatting itself instead of first
+	// sizing a heap buffer. Returns the length of the string after
+	int Format( const char *pFormat, ... ) FMTFUNCTION( 2, 3 );
+	int AppendFormat( const char *pFormat, ... ) FMTFUNCTION( 2, 3 );
+	int AppendFormatV( const char *pFormat, va_list params );
+
+private:
+	friend class CBufferStringArena;
+
+	void Attach( int nCapacity );
+	void Detach();
+	void Assign( const char *pString, int nLen );
+
+	char *m_pArenaBuffer;
+	int m_nArenaCapacity;
+	uint64 m_nArenaPosition;
+
+	CArenaBufferString *m_pPrev;
+	CArenaBufferString *m_pNext;
+};
+
+#endif // BUFFERSTRINGARENA_H
@@ -37,6 +37,7 @@ class CCommand;
 class ConCommand;
 class CCommandContext;
 class ConVarRefAbstract;
+class CArenaBufferString;
 
 //-----------------------------------------------------------------------------
 // Purpose: Internal structure of ConVar objects
@@ -292,6 +293,7 @@ public:
 	const char *GetCommandString() const;		// The entire command in string form, including the 0th arg
 	const char *operator[]( int nIndex ) const;	// Gets at arguments
 	const char *Arg( int nIndex ) const;		// Gets at arguments
+	std::string_view ArgView( int nIndex ) const;	// Same, with the length and without a strlen
 	
 	// Helper functions to parse arguments to commands.
 	// 
@@ -358,6 +360,16 @@ inline const char *CCommand::Arg( int nIndex ) const
 	return m_Args[nIndex];
 }
 
+inline std::string_view CCommand::ArgView( int nIndex ) const
+{
+	if ( nIndex < 0 || nIndex >= ArgC() )
+		return std::string_view( "", 0 );
+
+	// The args are stored back to back, each with its terminator
+	const char *pArg = m_Args[nIndex];
+	return std::string_view( pArg, ( nIndex + 1 < ArgC() ) ? m_Args[nIndex + 1] - pArg - 1 : V_strlen( pArg ) );
+}
+
 inline const char *CCommand::operator[]( int nIndex ) const
 {
 	return Arg( nIndex );
@@ -1103,6 +1115,14 @@ protected:
 	};
 };
 
+// One entry of a ConVarRefAbstract::SetValues batch
+struct ConVarSetValue_t
+{
+	ConVarRefAbstract *m_pConVar;
+	const char *m_pszValue;
+	CSplitScreenSlot m_Slot = -1;
+};
+
 class ConVarRefAbstract : public ConVarRef
 {
 public:
@@ -1198,6 +1218,11 @@ public:
 	void SetInt( int value, CSplitScreenSlot slot = -1 ) { SetAs<int>( value, slot ); }
 	// Parses the string to CvarType type, returns true on success, false otherwise
 	bool SetString( CUtlString string, CSplitScreenSlot slot = -1 );
+	// Same as SetString for a whole list of cvars, but the change callbacks only run
+	// once every value is in, in one pass. A cvar listed more than once gets one callback,
+	// from its value before the batch to the last one set, and none if that is where it
+	// started. Returns how many of the strings parsed
+	static int SetValues( const ConVarSetValue_t *values, int count );
 
 	// Reset to default value
 	void Revert( CSplitScreenSlot slot = -1 );
@@ -1224,10 +1249,15 @@ protected:
 	}
 
 	void CallChangeCallbacks( CSplitScreenSlot slot, CVValue_t *new_value, CVValue_t *prev_value, const char *new_str, const char *prev_str );
+	// Formats the strings for the global change callbacks, if there are any to take them
+	void CallChangeCallbacks( CSplitScreenSlot slot, CVValue_t *new_value, CVValue_t *prev_value, CArenaBufferString &new_str, CArenaBufferString &prev_str );
 
 	void SetOrQueueValueInternal( CSplitScreenSlot slot, CVValue_t *value );
 	void QueueSetValueInternal( CSplitScreenSlot slot, CVValue_t *value );
 	void SetValueInternal( CSplitScreenSlot slot, CVValue_t *value );
+	// Runs the filter and stores the value, returns true if that changed it,
+	// in which case the old value is in prev_value and needs destructing
+	bool ApplyValueInternal( CSplitScreenSlot slot, CVValue_t *value, CVValue_t *prev_value );
 
 	// Does type conversion from CvarType to type T, only valid for primitive types
 	template <typename T>
@@ -1512,6 +1542,13 @@ bool ConVar_Register( uint64 nCVarFlag = 0, FnConVarRegisterCallback cvar_reg_cb
 uint64 ConVar_GetDefaultFlags();
 bool ConVar_Unregister( );
 
+//-----------------------------------------------------------------------------
+// Called when any ConVar set through this module changes value, with the values
+// themselves rather than the strings ICvar's global change callbacks get
+//-----------------------------------------------------------------------------
+void ConVar_InstallValueChangeCallback( FnGenericChangeCallback_t callback );
+void ConVar_RemoveValueChangeCallback( FnGenericChangeCallback_t callback );
+
 
 //-----------------------------------------------------------------------------
 // Utility methods 
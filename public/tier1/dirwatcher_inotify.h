@@ -0,0 +1,66 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: inotify backend for CDirWatcher (tier1/dirwatcher_inotify.cpp)
+//
+// inotify watches one directory per descriptor and doesn't recurse, so every
+// directory below the base dir gets a watch of its own, added as they show
+// up. Events are only read when asked for, so an idle watcher costs nothing
+// but the kernel watches. When the kernel queue overflows the events in it
+// are gone, and the tree is rescanned for files modified since the last
+// read instead.
+//
+//=============================================================================//
+
+#ifndef DIRWATCHER_INOTIFY_H
+#define DIRWATCHER_INOTIFY_H
+
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include "tier0/platform.h"
+#include "tier0/utlstring.h"
+#include "tier1/utlmap.h"
+
+#include <time.h>
+
+class CDirWatcherINotify
+{
+public:
+	// pchRelPath is relative to the watched directory
+	typedef void ( *ChangedFileFunc_t )( const char *pchRelPath, void *pContext );
+
+	CDirWatcherINotify( ChangedFileFunc_t pfnChangedFile, void *pContext );
+	~CDirWatcherINotify();
+
+	// pchDir is absolute, without a trailing slash. Nothing in it counts as changed yet
+	bool BInit( const char *pchDir );
+
+	// Reports everything that changed since the last call
+	void ReadEvents();
+
+	// Directories watched, and how many times the kernel queue overflowed; for the tests
+	int GetWatchCount() const { return m_mapWatchDirs.Count(); }
+	int GetOverflowCount() const { return m_cOverflows; }
+
+private:
+	void AddWatchRecursive( const CUtlString &sRelDir, const struct timespec *pModifiedSince );
+	void RemoveWatchRecursive( const CUtlString &sRelDir );
+
+	ChangedFileFunc_t m_pfnChangedFile;
+	void *m_pContext;
+
+	int m_fdINotify;
+	CUtlString m_BaseDir;
+
+	// watch descriptor -> directory relative to m_BaseDir ("" for the base dir itself)
+	CUtlMap<int, CUtlString> m_mapWatchDirs;
+
+	// changes from before this have been picked up already, used to rescan after an overflow
+	struct timespec m_LastReadTime;
+	int m_cOverflows;
+
+	void *m_pEventBuffer;
+};
+
+#endif // DIRWATCHER_INOTIFY_H
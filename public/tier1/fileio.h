@@ -145,12 +145,26 @@ public:
 		k_ESeekEnd
 	};
 
+	// Called once the writer is done with a buffer handed over through WriteOwned()
+	typedef void ( *FileWriterReleaseFunc_t )( void *pvData, void *pContext );
+
 	CFileWriter( bool bAsync = false );
 	virtual ~CFileWriter();
 
 	bool BFileOpen();
 	bool BSetFile( const char *pchFile, bool bAllowOpenExisting = false );
 	bool Write( const void *pvData, uint32 cubData );
+
+	// Zero-copy write: ownership of pvData moves to the writer, which releases it through
+	// pfnRelease (or free() when NULL) once the data has been written
+	bool WriteOwned( void *pvData, uint32 cubData, FileWriterReleaseFunc_t pfnRelease = NULL, void *pContext = NULL );
+
+	// Barrier: returns once everything written so far has reached the disk (fdatasync)
+	bool SyncData();
+
+	// Bounds the bytes handed to the OS but not yet completed, writers past it wait for completions
+	void SetMaxBytesInFlight( uint32 cubMaxInFlight );
+
 	int  Printf( char *pDest, int bufferLen, PRINTF_FORMAT_STRING char const *pFormat, ... );
 	bool Seek( uint64 offset, ESeekOrigin eOrigin );
 	void Flush();
@@ -181,6 +195,12 @@ private:
 	// this is not great but a good enough for log files and we didn't need a full blow IOCP manager for this.
 	volatile int m_cPendingCallbacksFromOtherThreads; 
 
+#ifdef _LINUX
+	// io_uring backend, NULL when writing synchronously. Any thread may write to it without waiting
+	class CFileWriterURing *m_pURing;
+#endif
+	uint32 m_cubMaxInFlight;
+
 };
 
 // data accessor
@@ -0,0 +1,149 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: io_uring write backend for CFileWriter (tier1/fileio_uring.cpp)
+//
+// Small writes are appended into one of a few staging buffers that are
+// registered with the ring up front (IORING_OP_WRITE_FIXED, no per-write
+// page pinning); a staging buffer goes to the kernel once it's full or on
+// Flush/SyncData. WriteOwned() buffers are submitted as they are, without a
+// copy. Every write carries its own file offset, so completions may arrive
+// in any order.
+//
+// Any thread can write. The lock covers queueing and reaping only: one
+// thread at a time sleeps in the kernel for completions without it, the
+// others wait on a condition variable for that thread to reap, so writers
+// that have room keep queueing while someone else waits.
+//
+// Talks to the kernel directly, there is no liburing dependency. Build with
+// NO_IOURING_FILEIO to leave it out.
+//
+//=============================================================================//
+
+#ifndef FILEIO_URING_H
+#define FILEIO_URING_H
+
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include "tier1/fileio.h"
+
+#if defined( _LINUX ) && !defined( NO_IOURING_FILEIO )
+#define IOURING_FILEIO
+#endif
+
+#ifdef IOURING_FILEIO
+#include <pthread.h>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+static const int k_cFileWriterURingEntries = 64;
+static const int k_cFileWriterStagingBuffers = 8;
+static const uint32 k_cubFileWriterStagingBuffer = 256 * 1024;
+
+struct FileWriterURingRequest_t
+{
+	uint8 *m_pubData;
+	uint32 m_cubData;
+	uint32 m_cubDone;
+	uint64 m_ulOffset;
+	uint64 m_nSeq;			// order it was first queued in, 0 while free
+	int m_iStagingBuffer;	// -1 for caller owned buffers and fsyncs
+	bool m_bSync;			// m_pContext is the bool set when it completes
+	CFileWriter::FileWriterReleaseFunc_t m_pfnRelease;
+	void *m_pContext;
+	FileWriterURingRequest_t *m_pNextFree;
+};
+
+class CFileWriterURing
+{
+public:
+	// NULL when there's no ring to be had (old kernel, seccomp, ...). Without
+	// bRegisterBuffers, or when registering them fails, every write is a copy
+	// submitted on its own
+	static CFileWriterURing *Create( int fd, uint32 cubMaxInFlight, bool bRegisterBuffers = true );
+	~CFileWriterURing();
+
+	// *pcubWritten is the file offset, advanced under the lock
+	bool Write( const void *pvData, uint32 cubData, uint64 *pcubWritten );
+	bool WriteOwned( void *pvData, uint32 cubData, uint64 *pcubWritten, CFileWriter::FileWriterReleaseFunc_t pfnRelease, void *pContext );
+
+	// Returns once everything written before the call is on disk
+	bool SyncData();
+	bool Flush();
+
+	void SetMaxBytesInFlight( uint32 cubMaxInFlight );
+
+	// Caps how much of a request goes to the kernel at once, so the rest of it comes
+	// back as a short write; 0 for no cap. For the tests
+	void SetMaxBytesPerSubmit( uint32 cubMaxPerSubmit );
+
+	bool BStagingRegistered() const { return m_pubStaging != NULL; }
+
+private:
+	CFileWriterURing( int fd, uint32 cubMaxInFlight );
+	bool BInit( bool bRegisterBuffers );
+
+	FileWriterURingRequest_t *AllocRequest();
+	void FreeRequest( FileWriterURingRequest_t *pRequest );
+	void QueueRequest( FileWriterURingRequest_t *pRequest );
+	void QueueStaging();
+	bool Submit();
+	bool WaitForCompletion();
+	void ReapCompletions();
+	void CompleteRequest( FileWriterURingRequest_t *pRequest );
+	bool WaitForInFlight( uint32 cubIncoming );
+	bool BWritesQueuedBefore( uint64 nSeq ) const;
+	bool FlushLocked();
+
+	int m_fd;
+	int m_fdRing;
+
+	// shared ring memory
+	void *m_pSQRing;
+	void *m_pCQRing;
+	size_t m_cubSQRing;
+	size_t m_cubCQRing;
+	io_uring_sqe *m_pSQEs;
+	size_t m_cubSQEs;
+	unsigned *m_pSQHead;
+	unsigned *m_pSQTail;
+	unsigned *m_pSQArray;
+	unsigned m_unSQMask;
+	unsigned *m_pCQHead;
+	unsigned *m_pCQTail;
+	unsigned m_unCQMask;
+	io_uring_cqe *m_pCQEs;
+
+	uint32 m_cUnsubmitted;
+	uint32 m_cInFlight;
+	uint32 m_cubInFlight;
+	uint32 m_cubMaxInFlight;
+	uint32 m_cubMaxPerSubmit;
+	bool m_bError;
+
+	// Requests done so far, and the sequence number for the next one queued
+	uint32 m_cCompleted;
+	uint64 m_nNextSeq;
+
+	FileWriterURingRequest_t m_Requests[k_cFileWriterURingEntries];
+	FileWriterURingRequest_t *m_pFreeRequests;
+
+	// staging buffers, one big registered allocation
+	uint8 *m_pubStaging;
+	bool m_rgbStagingBusy[k_cFileWriterStagingBuffers];
+	int m_iCurStaging;
+	uint32 m_cubCurStaging;
+	uint64 m_ulCurStagingOffset;
+
+	pthread_mutex_t m_Mutex;
+
+	// Set while a thread sleeps in the kernel without the lock; only that thread reaps
+	// then, the rest wait on m_ReapedCond
+	bool m_bWaiting;
+	pthread_cond_t m_ReapedCond;
+};
+#endif // IOURING_FILEIO
+
+#endif // FILEIO_URING_H
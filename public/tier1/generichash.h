@@ -140,8 +140,116 @@ uint32 MurmurHash2( const void *key, int len, uint32 seed );
 uint32 MurmurHash2LowerCase( char const *pString, uint32 nSeed );
 uint32 MurmurHash2LowerCase( char const *pString, int nLength, uint32 nSeed );
 
+// What CUtlStringToken::Hash gives at run time, lowered as it's read. That reads the last
+// 1-3 bytes as char, so past 0x7F its tokens differ from MurmurHash2 / MurmurHash2LowerCase.
+uint32 MurmurHash2StringToken( char const *pString, int nLength, uint32 nSeed, bool bLowerCase = true );
+
+// MurmurHash2LowerCase of nCount strings at once, several strings to a SIMD register;
+// the same hashes as a call per string. pnLengths can be NULL for the string lengths.
+void MurmurHash2LowerCaseBatch( const char *const *ppStrings, const int *pnLengths, int nCount, uint32 nSeed, uint32 *pHashes );
+
+// The widest level the CPU has is picked on first use; MurmurHash2SetSIMDLevel pins a
+// lower one and returns the level in use. 2 is AVX2, below that it's a call per string.
+int MurmurHash2SetSIMDLevel( int nLevel );
+int MurmurHash2GetSIMDLevel();
+
 // MurmurHash2, 64-bit version
 uint64 MurmurHash64( const void *key, int len, uint32 seed );
 
 
+//-----------------------------------------------------------------------------
+// FastHash: 64/128-bit seeded hash family built on the XXH3 construction
+// (16-byte SIMD lanes, 64-byte stripes, periodic accumulator scrambling).
+// It is NOT bit-compatible with XXH3 (it uses its own secret), nor with any
+// of the hashes above - keep using those for anything that is persisted or
+// shared with engine binaries (string tokens, symbol tables, KV3 members).
+//
+// The caseless variants fold ASCII 'A'-'Z' while reading, so
+// FastHash64Caseless( s ) == FastHash64( lowercase( s ) ) with no temp copy.
+//-----------------------------------------------------------------------------
+struct FastHash128_t
+{
+	uint64 m_nLow;
+	uint64 m_nHigh;
+
+	bool operator==( const FastHash128_t &other ) const { return m_nLow == other.m_nLow && m_nHigh == other.m_nHigh; }
+	bool operator!=( const FastHash128_t &other ) const { return !( *this == other ); }
+};
+
+uint64 FastHash64( const void *pKey, size_t nLength, uint64 nSeed = 0 );
+uint64 FastHash64Caseless( const void *pKey, size_t nLength, uint64 nSeed = 0 );
+FastHash128_t FastHash128( const void *pKey, size_t nLength, uint64 nSeed = 0 );
+FastHash128_t FastHash128Caseless( const void *pKey, size_t nLength, uint64 nSeed = 0 );
+
+uint64 FastHashString64( const char *pszKey, uint64 nSeed = 0 );
+uint64 FastHashStringCaseless64( const char *pszKey, uint64 nSeed = 0 );
+
+// Folds a 64-bit hash down to 32 bits for hash table buckets
+FORCEINLINE uint32 FastHashFold32( uint64 nHash )
+{
+	return ( uint32 )( nHash ^ ( nHash >> 32 ) );
+}
+
+//-----------------------------------------------------------------------------
+// Streaming FastHash. Feeding the same bytes through any number of Update()
+// calls produces exactly the one-shot FastHash64/FastHash128(Caseless) value.
+//-----------------------------------------------------------------------------
+class CFastHashState
+{
+public:
+	enum
+	{
+		SECRET_SIZE = 192,
+		STRIPE_LEN = 64,
+		BUFFER_SIZE = 256,
+		ACC_COUNT = 8,
+	};
+
+	explicit CFastHashState( uint64 nSeed = 0, bool bCaseless = false ) { Reset( nSeed, bCaseless ); }
+
+	void Reset( uint64 nSeed = 0, bool bCaseless = false );
+	void Update( const void *pData, size_t nLength );
+
+	uint64 Digest64() const;
+	FastHash128_t Digest128() const;
+
+	uint64 GetTotalLength() const { return m_nTotalLength; }
+
+private:
+	void ConsumeStripes( uint64 *pAcc, uint32 &nStripesSoFar, const uint8 *pInput, uint32 nStripes ) const;
+	void DigestLong( uint64 *pAcc ) const;
+
+	ALIGN16 uint64 m_nAcc[ACC_COUNT] ALIGN16_POST;
+	ALIGN16 uint8 m_Secret[SECRET_SIZE] ALIGN16_POST;
+	ALIGN16 uint8 m_Buffer[BUFFER_SIZE] ALIGN16_POST;
+	uint64 m_nTotalLength;
+	uint64 m_nSeed;
+	uint32 m_nBufferedSize;
+	uint32 m_nStripesSoFar;
+	bool m_bCaseless;
+};
+
+//-----------------------------------------------------------------------------
+// Opt-in FastHash functors for CUtlHashtable and friends, e.g.
+//   CUtlHashtable< const char *, int, FastStringHashFunctor, StringEqualFunctor >
+// The default functors are left untouched.
+//-----------------------------------------------------------------------------
+struct FastStringHashFunctor
+{
+	unsigned int operator()( const char *pszKey ) const { return FastHashFold32( FastHashString64( pszKey ) ); }
+};
+
+struct FastCaselessStringHashFunctor
+{
+	unsigned int operator()( const char *pszKey ) const { return FastHashFold32( FastHashStringCaseless64( pszKey ) ); }
+};
+
+// Hashes the object representation, only use on types without padding
+template < typename T >
+struct FastBlockHashFunctor
+{
+	unsigned int operator()( const T &item ) const { return FastHashFold32( FastHash64( &item, sizeof( item ) ) ); }
+};
+
+
 #endif /* !GENERICHASH_H */
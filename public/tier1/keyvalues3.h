@@ -13,6 +13,7 @@
 #include "tier0/utlstring.h"
 #include "tier0/utlstringtoken.h"
 #include "tier0/utlstring.h"
+#include "tier1/alloctrackermacros.h"
 #include "tier1/generichash.h"
 #include "tier1/utlhashtable.h"
 #include "tier1/utlmap.h"
@@ -340,7 +341,8 @@ using CKV3MemberHash = KeyValues3LowercaseHash_t;
 class CKV3MemberName : public CKV3MemberHash
 {
 public:
-	template< uintp N > constexpr CKV3MemberName( const char (&szInit)[N] ) : CKV3MemberHash( szInit ), m_iSymLarge( UTL_INVAL_SYMBOL_LARGE ), m_pszString( (const char *)szInit ) {}
+	template< uintp N > STRINGTOKEN_LITERAL CKV3MemberName( const char (&szInit)[N] ) : CKV3MemberHash( szInit ), m_iSymLarge( UTL_INVAL_SYMBOL_LARGE ), m_pszString( (const char *)szInit ) {}
+	template< uintp N > constexpr CKV3MemberName( char (&szInit)[N] ) : CKV3MemberHash( szInit ), m_iSymLarge( UTL_INVAL_SYMBOL_LARGE ), m_pszString( (const char *)szInit ) {}
 	CKV3MemberName( const char *pszString, int nLen ) : CKV3MemberHash( MakeStringToken2( pszString, nLen ) ), m_iSymLarge( UTL_INVAL_SYMBOL_LARGE ), m_pszString( pszString ) {}
 	CKV3MemberName( uint32 nHash = 0, UtlSymLargeId_t index = UTL_INVAL_SYMBOL_LARGE, const char* pszString = StringFuncs<char>::EmptyString() ) : CKV3MemberHash( nHash ), m_iSymLarge( index ), m_pszString( pszString ) {}
 
@@ -373,7 +375,7 @@ using CKeyValues3StringAndHash = CKV3MemberName;
 class CKV3MemberNameWithStorage : public CKV3MemberName
 {
 public:
-	template< uintp N > constexpr CKV3MemberNameWithStorage( const char (&szInit)[N] ) : CKV3MemberName( szInit ), m_Storage( (const char*)szInit, N - 1 ) {}
+	template< uintp N > constexpr CKV3MemberNameWithStorage( const char (&szInit)[N] ) : CKV3MemberName( CUtlStringToken::Hash( szInit, CUtlStringToken::ArrayLength( szInit ) ), UTL_INVAL_SYMBOL_LARGE, szInit ), m_Storage( (const char*)szInit, CUtlStringToken::ArrayLength( szInit ) ) {}
 	CKV3MemberNameWithStorage( const char* pszString, int nLen ): CKV3MemberName( pszString, nLen ), m_Storage( pszString, nLen ) {}
 	CKV3MemberNameWithStorage( uint32 nHash = 0, UtlSymLargeId_t index = 0, const char* pszString = StringFuncs<char>::EmptyString(), int nLen = -1  ) : CKV3MemberName( nHash, index, pszString ), m_Storage( pszString, nLen ) {}
 
@@ -431,6 +433,10 @@ public:
 	const char* GetTypeAsString() const;
 	const char* GetSubTypeAsString() const;
 
+	// Back from the names above, KV3_TYPE_INVALID or KV3_SUBTYPE_INVALID for anything else
+	static KV3Type_t GetTypeFromString( const char *pszType );
+	static KV3SubType_t GetSubTypeFromString( const char *pszSubType );
+
 	const char* ToString( CBufferString& buff, uint flags = KV3_TO_STRING_NONE ) const;
 
 	bool IsNull() const { return GetType() == KV3_TYPE_NULL; }
@@ -1610,8 +1616,13 @@ inline void CKV3ArenaBase::NodeList<NODE>::EnsureByteSize( int bytes_needed )
 
 	int new_alloc_size = KV3Helpers::CalcNewBufferSize( m_nAllocatedBytes, bytes_needed, ALLOC_CONTEXT_NODELIST_MIN, ALLOC_CONTEXT_NODELIST_MAX );
 
+	if(m_pData)
+		ALLOC_TRACKER_FREE( NODE, m_nAllocatedBytes );
+
 	m_pData = (ListEntry *)realloc( m_pData, new_alloc_size );
 	m_nAllocatedBytes = new_alloc_size;
+
+	ALLOC_TRACKER_ALLOC( NODE, m_nAllocatedBytes );
 }
 
 template<typename NODE>
@@ -1648,8 +1659,12 @@ inline void CKV3ArenaBase::NodeList<NODE>::Purge()
 {
 	Clear();
 
+	if(m_pData)
+		ALLOC_TRACKER_FREE( NODE, m_nAllocatedBytes );
+
 	free( m_pData );
 	m_pData = nullptr;
+	m_nAllocatedBytes = 0;
 }
 
 template<typename CLUSTER>
@@ -1662,6 +1677,7 @@ inline void CKV3Arena::PurgeClusterNodeChain( ClusterNodeChain<CLUSTER> &cluster
 
 		if(node->IsAllocatedOnHeap())
 		{
+			ALLOC_TRACKER_FREE( CLUSTER, CLUSTER::TotalSizeOf( node->NumAllocated() ) );
 			node->Purge();
 			g_pMemAlloc->RegionFree( MEMALLOC_REGION_FREE_4, node );
 		}
@@ -1717,6 +1733,7 @@ auto CKV3Arena::Alloc( ClusterNodeChain<CLUSTER> &partial_clusters,
 	else
 	{
 		cluster = (CLUSTER *)g_pMemAlloc->RegionAlloc( MEMALLOC_REGION_ALLOC_4, CLUSTER::TotalSizeOf( initial_size ) );
+		ALLOC_TRACKER_ALLOC( CLUSTER, CLUSTER::TotalSizeOf( initial_size ) );
 
 		Construct( cluster, this, true, initial_size );
 		partial_clusters.AddToChain( cluster );
@@ -1766,6 +1783,7 @@ void CKV3Arena::Free( NODE *element, ClusterNodeChain<CLUSTER> &partial_clusters
 	{
 		partial_clusters.RemoveFromChain( cluster );
 
+		ALLOC_TRACKER_FREE( CLUSTER, CLUSTER::TotalSizeOf( num_allocated ) );
 		Destruct( cluster );
 		g_pMemAlloc->RegionFree( MEMALLOC_REGION_FREE_4, cluster );
 	}
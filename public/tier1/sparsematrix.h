@@ -28,6 +28,14 @@ public:
 		int m_nDataIndex;									// index of NonZeroValueDescriptor_t for the first non-zero value
 	};
 
+	/// One element of a matrix given in coordinate (COO) form, see SetFromTriplets
+	struct Triplet_t
+	{
+		int m_nRow;
+		int m_nColumnNumber;
+		float m_flValue;
+	};
+
 	int m_nNumRows;
 	int m_nNumCols;
 	CUtlVector<RowDescriptor_t> m_rowDescriptors;
@@ -42,8 +50,31 @@ public:
 	void AppendElement( int nRow, int nCol, float flValue );
 	void FinishedAppending( void );
 
+	/// Replace the contents with the elements in pTriplets, which may come in any order. Elements
+	/// given more than once are summed and elements that end up zero are not stored. This is a
+	/// single pass over the triplets (plus sorting each row), where SetElement moves every later
+	/// row each time it inserts.
+	void SetFromTriplets( int nNumRows, int nNumCols, Triplet_t const *pTriplets, int nCount );
+
 	FORCEINLINE int Height( void ) const { return m_nNumRows; }
 	FORCEINLINE int Width( void ) const { return m_nNumCols; }
+	FORCEINLINE int NonZeroCount( void ) const { return m_entries.Count(); }
+
+	/// pOut = this * pVector, where pVector has Width() elements and pOut Height(). With nThreads
+	/// > 1 the rows are split between that many threads (the caller's included) so each gets about
+	/// the same number of non-zeros; small matrices are always done on the calling thread.
+	void MultiplyVector( float const *pVector, float *pOut, int nThreads = 1 ) const;
+
+	/// pOut = this * pMatrix, for a dense row major pMatrix of Width() rows by nColumns and a dense
+	/// row major pOut of Height() rows by nColumns. Threaded the same way as MultiplyVector.
+	void MultiplyDense( float const *pMatrix, int nColumns, float *pOut, int nThreads = 1 ) const;
+
+	/// Solve this * pX = pB for a symmetric positive definite matrix by conjugate gradient with a
+	/// diagonal (Jacobi) preconditioner. pX holds the initial guess on input. Stops once the
+	/// residual is below flTolerance * |pB|, and returns the number of iterations taken, or -1 if
+	/// that didn't happen within nMaxIterations (pX then holds the last iterate). The products
+	/// are threaded as in MultiplyVector.
+	int SolveConjugateGradient( float const *pB, float *pX, int nMaxIterations, float flTolerance = 1.0e-6f, int nThreads = 1 ) const;
 
 };
 
@@ -75,6 +106,46 @@ FORCEINLINE float CSparseMatrix::Element( int nRow, int nCol ) const
 
 
 
+/// Collects the elements of a sparse matrix in any order, then builds the CSparseMatrix from them
+/// in one go. Use this rather than SetElement when the elements don't come top to bottom.
+class CSparseMatrixBuilder
+{
+public:
+	CSparseMatrixBuilder( void ) : m_nNumRows( 0 ), m_nNumCols( 0 ) {}
+
+	/// Start over with an empty matrix of the given size
+	void SetDimensions( int nNumRows, int nNumCols );
+	void EnsureCapacity( int nNumElements ) { m_triplets.EnsureCapacity( nNumElements ); }
+
+	/// Add flValue to the element at nRow, nCol
+	FORCEINLINE void AddElement( int nRow, int nCol, float flValue );
+
+	/// Fill pMatrix from the elements added so far. The builder is left as it was.
+	void Build( CSparseMatrix *pMatrix ) const;
+
+	FORCEINLINE int Height( void ) const { return m_nNumRows; }
+	FORCEINLINE int Width( void ) const { return m_nNumCols; }
+	FORCEINLINE int Count( void ) const { return m_triplets.Count(); }
+
+	void Purge( void ) { m_triplets.Purge(); }
+
+private:
+	int m_nNumRows;
+	int m_nNumCols;
+	CUtlVector<CSparseMatrix::Triplet_t> m_triplets;
+};
+
+FORCEINLINE void CSparseMatrixBuilder::AddElement( int nRow, int nCol, float flValue )
+{
+	Assert( nRow >= 0 && nRow < m_nNumRows && nCol >= 0 && nCol < m_nNumCols );
+	CSparseMatrix::Triplet_t &triplet = m_triplets[ m_triplets.AddToTail() ];
+	triplet.m_nRow = nRow;
+	triplet.m_nColumnNumber = nCol;
+	triplet.m_flValue = flValue;
+}
+
+
+
 // type-specific overrides of matrixmath template for special case sparse routines
 
 namespace MatrixMath
@@ -0,0 +1,46 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: SSE2/AVX2 versions of the hot V_ string functions (tier1/strtools_simd.cpp)
+//
+// Same results as the tier0 functions they stand in for: case folding is
+// ASCII only, like the _fast variants, and comparisons are on the folded
+// bytes as unsigned chars. Blocks are loaded whole and can read past the
+// terminator, but never into the next page.
+//
+// The widest level the CPU has is picked on first use; V_StrSetSIMDLevel
+// pins a lower one (0 is the scalar fallback, 1 SSE2, 2 AVX2).
+//
+//=============================================================================//
+
+#ifndef TIER1_STRTOOLS_SIMD_H
+#define TIER1_STRTOOLS_SIMD_H
+
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include "tier0/platform.h"
+
+// Returns the level in use after clamping to what the CPU has
+int V_StrSetSIMDLevel( int nLevel );
+int V_StrGetSIMDLevel();
+
+// V_strlen
+int V_strlen_simd( const char *pStr );
+
+// V_stricmp_fast, V_strnicmp; n < 0 compares whole strings
+int V_stricmp_simd( const char *s1, const char *s2 );
+int V_strnicmp_simd( const char *s1, const char *s2, int n );
+
+// V_strstr, V_stristr; an empty search matches at the start
+const char *V_strstr_simd( const char *pStr, const char *pSearch );
+const char *V_stristr_simd( const char *pStr, const char *pSearch );
+
+// V_strlower, in place
+char *V_strlower_simd( char *pStart );
+
+// Copies pIn to pOut lowered, truncating to fit nOutSize with the terminator.
+// Returns the length written.
+int V_strtolower_simd( const char *pIn, char *pOut, int nOutSize );
+
+#endif // TIER1_STRTOOLS_SIMD_H
@@ -0,0 +1,69 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: Unicode validation and conversion (tier1/strtools_unicode.cpp)
+//
+// Same contracts as the V_ versions in tier0/strtools.h. The UTF-8 input side
+// runs on SSE4.1 or AVX2 where the CPU has them, with the same results as the
+// scalar decoder, CESU-8 handling included.
+//
+//=============================================================================//
+
+#ifndef STRTOOLS_UNICODE_H
+#define STRTOOLS_UNICODE_H
+
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include "tier0/strtools.h"
+
+bool Q_IsValidUChar32( uchar32 uVal );
+int Q_UChar32ToUTF8Len( uchar32 uVal );
+int Q_UChar32ToUTF16Len( uchar32 uVal );
+int Q_UChar32ToUTF8( uchar32 uVal, char *pUTF8Out );
+int Q_UChar32ToUTF16( uchar32 uVal, uchar16 *pUTF16Out );
+
+// Decode one character; 6-byte CESU-8 sequences come out as one character
+int Q_UTF8ToUChar32( const char *pUTF8, uchar32 &uValueOut, bool &bErrorOut );
+int Q_UTF16ToUChar32( const uchar16 *pUTF16, uchar32 &uValueOut, bool &bErrorOut );
+
+// Returns true if the string holds no invalid sequences (CESU-8 counts as invalid)
+bool Q_UnicodeValidate( const char *pUTF8 );
+bool Q_UnicodeValidate( const uchar16 *pUTF16 );
+bool Q_UnicodeValidate( const uchar32 *pUTF32 );
+
+// Number of code points in the string
+int Q_UnicodeLength( const char *pUTF8 );
+int Q_UnicodeLength( const uchar16 *pUTF16 );
+int Q_UnicodeLength( const uchar32 *pUTF32 );
+
+char *Q_UnicodeAdvance( char *pUTF8, int nChars );
+uchar16 *Q_UnicodeAdvance( uchar16 *pUTF16, int nChars );
+uchar32 *Q_UnicodeAdvance( uchar32 *pUTF32, int nChars );
+
+// Conversions return the number of *bytes* required if the output pointer is NULL
+int Q_UTF8ToUTF16( const char *pUTF8, uchar16 *pUTF16, int cubDestSizeInBytes, EStringConvertErrorPolicy ePolicy );
+int Q_UTF8ToUTF32( const char *pUTF8, uchar32 *pUTF32, int cubDestSizeInBytes, EStringConvertErrorPolicy ePolicy );
+int Q_UTF16ToUTF8( const uchar16 *pUTF16, char *pUTF8, int cubDestSizeInBytes, EStringConvertErrorPolicy ePolicy );
+int Q_UTF16ToUTF32( const uchar16 *pUTF16, uchar32 *pUTF32, int cubDestSizeInBytes, EStringConvertErrorPolicy ePolicy );
+int Q_UTF32ToUTF8( const uchar32 *pUTF32, char *pUTF8, int cubDestSizeInBytes, EStringConvertErrorPolicy ePolicy );
+int Q_UTF32ToUTF16( const uchar32 *pUTF32, uchar16 *pUTF16, int cubDestSizeInBytes, EStringConvertErrorPolicy ePolicy );
+int Q_UTF32ToUTF32( const uchar32 *pUTF32Source, uchar32 *pUTF32Dest, int cubDestSizeInBytes, EStringConvertErrorPolicy ePolicy );
+
+int Q_UTF8CharsToUTF16( const char *pUTF8, int nElements, uchar16 *pUTF16, int cubDestSizeInBytes, EStringConvertErrorPolicy ePolicy );
+int Q_UTF8CharsToUTF32( const char *pUTF8, int nElements, uchar32 *pUTF32, int cubDestSizeInBytes, EStringConvertErrorPolicy ePolicy );
+int Q_UTF16CharsToUTF8( const uchar16 *pUTF16, int nElements, char *pUTF8, int cubDestSizeInBytes, EStringConvertErrorPolicy ePolicy );
+int Q_UTF16CharsToUTF32( const uchar16 *pUTF16, int nElements, uchar32 *pUTF32, int cubDestSizeInBytes, EStringConvertErrorPolicy ePolicy );
+int Q_UTF32CharsToUTF8( const uchar32 *pUTF32, int nElements, char *pUTF8, int cubDestSizeInBytes, EStringConvertErrorPolicy ePolicy );
+int Q_UTF32CharsToUTF16( const uchar32 *pUTF32, int nElements, uchar16 *pUTF16, int cubDestSizeInBytes, EStringConvertErrorPolicy ePolicy );
+
+// Remove or replace invalid sequences in place. Returns non-zero on success.
+int Q_UnicodeRepair( char *pUTF8, EStringConvertErrorPolicy ePolicy );
+int Q_UnicodeRepair( uchar16 *pUTF16, EStringConvertErrorPolicy ePolicy );
+int Q_UnicodeRepair( uchar32 *pUTF32, EStringConvertErrorPolicy ePolicy );
+
+// Which UTF-8 scanner to use: 0 scalar only, 1 SSE4.1, 2 AVX2. Clamped to what the
+// CPU has, returns the level in use. Defaults to the best one; for tests and benchmarks.
+int Q_UnicodeSetSIMDLevel( int nLevel );
+
+#endif // STRTOOLS_UNICODE_H
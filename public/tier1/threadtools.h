@@ -23,4 +23,32 @@ public:
 	// ...
 };
 
+//-----------------------------------------------------------------------------
+// Runs pfnThread( pParam ) on nThreads threads, the calling thread being one of
+// them, and returns once all of them have. pfnThread should take its work from a
+// counter they share: if no threads could be started the calling thread does it all.
+//-----------------------------------------------------------------------------
+inline void RunOnSimpleThreads( int nThreads, ThreadFunc_t pfnThread, void *pParam )
+{
+	ThreadHandle_t *pThreads = nThreads > 1 ? ( ThreadHandle_t * )stackalloc( ( nThreads - 1 ) * sizeof( ThreadHandle_t ) ) : NULL;
+
+	int nStarted = 0;
+	for ( int i = 1; i < nThreads; i++ )
+	{
+		ThreadHandle_t hThread = CreateSimpleThread( pfnThread, pParam );
+		if ( hThread )
+		{
+			pThreads[nStarted++] = hThread;
+		}
+	}
+
+	pfnThread( pParam );
+
+	for ( int i = 0; i < nStarted; i++ )
+	{
+		ThreadJoin( pThreads[i] );
+		ReleaseThreadHandle( pThreads[i] );
+	}
+}
+
 #endif // TIER1_THREADTOOLS_H
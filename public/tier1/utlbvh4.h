@@ -0,0 +1,139 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: A bounding volume hierarchy with four children per node, built in
+// one go from all of its primitives.
+//
+// Each node keeps the boxes of its four children as SoA fltx4s, so every step
+// of a query tests all four children with one set of SIMD instructions. The
+// tree is built with a binned SAH (optionally on several threads) and can be
+// refit in place when primitives move, which keeps the topology but is far
+// cheaper than a rebuild.
+//
+// The query interface mirrors CUtlSphereTree (including Cut) so callers can
+// switch over without restructuring their code:
+//
+// e.g.:	CUtlBVH4 tree;
+//			tree.Build( pPrimitives, nCount, 4 );
+//			tree.IntersectWithSphere( Vector4D( vCenter.x, vCenter.y, vCenter.z, flRadius ), true, results );
+//
+//=============================================================================//
+
+#ifndef UTLBVH4_H
+#define UTLBVH4_H
+
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include "mathlib/vector.h"
+#include "mathlib/vector4d.h"
+#include "mathlib/ssemath.h"
+#include "tier1/utlvector.h"
+
+
+class CUtlBVH4
+{
+public:
+	// A primitive to build the tree from. pData is what queries hand back.
+	struct Primitive_t
+	{
+		Vector m_vMins;
+		Vector m_vMaxs;
+		const void *m_pData;
+	};
+
+	// Same as CUtlSphereTree::Cut: the set of sub-trees left after refining the
+	// tree by some test, without having to walk down to the leaves.
+	class Cut
+	{
+		friend class CUtlBVH4;
+
+	public:
+		enum CutFlags
+		{
+			PARTIAL_INTERSECTIONS = 1,	// include leaves that only partially pass
+			OR_INTERSECTIONS = 2		// passing ANY plane is a pass (the default requires ALL of them)
+		};
+
+		// Initialize a Cut with the entire tree
+		Cut( const CUtlBVH4 *pTree );
+
+		// Return the user data pointers of the primitives within the Cut. To limit the number of results returned,
+		// pass 'maxLeaves > 0' (note that the return value may be more than this).
+		int GetLeaves( CUtlVector< void * > &leaves, int maxLeaves = 0 ) const;
+
+	private:
+		// Don't use the default constructor
+		Cut( void ) : m_pTree( NULL ) { Assert( 0 ); }
+
+		const CUtlBVH4 *m_pTree;
+		CUtlVector< int > m_NodeRefs;	// >= 0 is a whole sub-tree, < 0 the single primitive in slot ~ref
+	};
+
+	CUtlBVH4();
+
+	// Throw away the current tree and build a new one. With nThreads > 1 the
+	// lower levels are built on that many threads (the caller's included).
+	void Build( const Primitive_t *pPrimitives, int nCount, int nThreads = 1 );
+	// Same, from bounding spheres as passed to CUtlSphereTree::Insert
+	void Build( const Vector4D *pSpheres, const void * const *ppData, int nCount, int nThreads = 1 );
+	// Empty the tree (and deallocate)
+	void Purge( void );
+
+	// Move a primitive; nPrimitive is its index in the array the tree was built from.
+	// Queries see stale bounds until Refit() is called.
+	void SetPrimitiveBounds( int nPrimitive, const Vector &vMins, const Vector &vMaxs );
+	// Recompute every node's bounds from the primitives. The topology is kept, so a tree
+	// refit after large movements answers queries correctly but more slowly than a rebuilt one.
+	void Refit( void );
+
+	int Count( void ) const { return m_Primitives.Count(); }
+	int NodeCount( void ) const { return m_Nodes.Count(); }
+
+	// All the queries return the user data pointers of the primitives they hit, unordered. To limit
+	// the number of results returned, pass 'maxResults > 0' (note that the return value may be more than this).
+	// Passing a Cut restricts the query to it.
+
+	// Primitives whose box the segment [rayStart, rayStart + rayDelta] touches
+	int IntersectWithRay( const Vector &rayStart, const Vector &rayDelta, CUtlVector< void * > &result, int maxResults = 0, const Cut *cut = NULL ) const;
+	// Primitives whose box overlaps the sphere (xyz = center, w = radius), or with
+	// bPartial == false only those fully inside it
+	int IntersectWithSphere( const Vector4D &sphere, bool bPartial, CUtlVector< void * > &result, int maxResults = 0, const Cut *cut = NULL ) const;
+	// Primitives whose box overlaps the given box
+	int IntersectWithBox( const Vector &vMins, const Vector &vMaxs, CUtlVector< void * > &result, int maxResults = 0, const Cut *cut = NULL ) const;
+	// Primitives Frustum_t::CullBox would not cull
+	int IntersectWithFrustum( const Frustum_t &frustum, CUtlVector< void * > &result, int maxResults = 0, const Cut *cut = NULL ) const;
+
+	// Cut the tree (or refine an existing cut) by planes (xyz = normal, w = distance), keeping
+	// what is partially/fully in front of any/all of them (see Cut::CutFlags). If outputCut
+	// and inputCut are the same the cut is refined in place.
+	void CutByPlanes( Cut *outputCut, const Cut *inputCut, int cutFlags, const Vector4D *planes, int numPlanes = 1 ) const;
+
+private:
+	// 128 bytes: the boxes of the four children, then where they point
+	struct ALIGN16 Node_t
+	{
+		fltx4 m_MinX, m_MinY, m_MinZ;
+		fltx4 m_MaxX, m_MaxY, m_MaxZ;
+		int32 m_nChild[4];			// node index, or primitive slot if the child's bit is set in m_nLeafMask
+		int32 m_nChildCount;		// children are packed at the front, the unused lanes hold an empty box
+		int32 m_nLeafMask;
+		int32 m_nFirstPrimitive;	// the primitive slots under this node
+		int32 m_nPrimitiveCount;
+	} ALIGN16_POST;
+
+	friend class CUtlBVH4Builder;
+
+	// Walks the tree (or a Cut of it) testing four children at a time against QUERY
+	template < class QUERY > int Traverse( const QUERY &query, CUtlVector< void * > &result, int maxResults, const Cut *cut ) const;
+
+	static void SetChildBounds( Node_t &node, int nChild, const Vector &vMins, const Vector &vMaxs );
+	void GetNodeBounds( int nNode, Vector &vMins, Vector &vMaxs ) const;
+	void GetLeavesUnderNode( int nNode, CUtlVector< void * > &leaves, int &count ) const;
+
+	CUtlVector< Node_t > m_Nodes;			// m_Nodes[0] is the root; children always come after their parent
+	CUtlVector< Primitive_t > m_Primitives;	// in leaf order, so each sub-tree owns a contiguous range
+	CUtlVector< int > m_PrimitiveSlots;		// index passed to Build -> slot in m_Primitives
+};
+
+#endif // UTLBVH4_H
@@ -12,7 +12,7 @@
 
 #include <stdlib.h> // qsort
 #include "tier0/platform.h"
-#include "tier1/utlstack.h"
+#include "tier1/utlvector.h"
 
 //
 // An interval tree is a tree of "segments" or "intervals" of type T which can be searched for overlaps with another interval.
@@ -56,8 +56,24 @@
 		Msg( " [%d] overlap [%f, %f] [val %d]\n",
 		i, vec[ i ].GetLowVal(), vec[ i ].GetHighVal(), (int)vec[ i ].m_Data );
 	}
+
+	// Many probes in one call; the overlaps of checks[i] end up in vec[ starts[i] ] .. vec[ starts[i + 1] - 1 ]
+	int starts[ numchecks + 1 ];
+	tree.FindOverlaps( checks, numchecks, vec, starts );
+
+	// More intervals can be added later without rebuilding everything
+	tree.Insert( iv );
 */
 //
+// The tree is stored implicitly: each sorted run of intervals is laid out in an array in
+// Eytzinger (BFS) order, children of node k at 2k+1 and 2k+2, with every node carrying the
+// highest end point in its subtree. A query walks that array with a small fixed stack
+// instead of chasing pointers between separately allocated nodes.
+//
+// Insert() appends to a small unsorted buffer; when that fills up it is sorted into a new
+// run, and runs are merged whenever one is no larger than the run before it (the way an
+// LSM tree compacts), so there are never more than O(log n) of them to search.
+//
 
 template< class DataType, class T = float >
 class CUtlIntervalTree 
@@ -117,35 +133,53 @@ public:
 		DataType		m_Data;
 	};
 
-	CUtlIntervalTree() : m_pRoot( NULL ) {}
-	~CUtlIntervalTree(void);
+	CUtlIntervalTree() {}
 
+	// Replaces the contents of the tree (pIntervals is sorted by low value in place)
 	void BuildTree( Value_t *pIntervals, unsigned int nCount );
+	// Adds one interval to whatever the tree already holds
+	void Insert( const Value_t &interval );
+	void RemoveAll();
+	void Purge();
+	int Count() const;
+
 	void FindOverlaps( const Interval_t &rCheck, CUtlVector< Value_t > &vecOverlappingIntervals, bool bSortResultsByLowVal, bool bStricOverlapsOnly = false ) const;
+	// Batched version for many probes. The results for pChecks[i] are appended as the range
+	// [ pResultStarts[i], pResultStarts[i + 1] ) of vecOverlappingIntervals, so pResultStarts
+	// needs room for nChecks + 1 entries. Probes are walked in order of their low value so
+	// consecutive ones reuse the same part of the tree.
+	void FindOverlaps( const Interval_t *pChecks, int nChecks, CUtlVector< Value_t > &vecOverlappingIntervals, int *pResultStarts, bool bStricOverlapsOnly = false ) const;
 
 private:
-	struct TreeNode 
+	enum
 	{
-		TreeNode( const Value_t &interval ) : 
-	m_Interval(interval),
-		m_pLeft( NULL ),
-		m_pRight( NULL )
+		INSERT_BUFFER_SIZE = 32,	// unsorted inserts are scanned linearly until there are this many
+		MAX_TREE_DEPTH = 64,
+	};
+
+	struct TreeNode 
 	{
-	}
+		T				m_MinVal;		// the node's own interval
+		T				m_HighVal;
+		T				m_MaxVal;		// highest end point in this subtree
+	};
 
-	Value_t			m_Interval;
-	TreeNode		*m_pLeft; 
-	TreeNode		*m_pRight;			
-	T				m_MinVal;             
-	T				m_MaxVal;
+	// One sorted run of intervals in Eytzinger order; m_Values[k] belongs to m_Nodes[k]
+	struct Run_t
+	{
+		CUtlVector< TreeNode >	m_Nodes;
+		CUtlVector< Value_t >	m_Values;
 	};
 
-	TreeNode					*m_pRoot;                  
+	void BuildRun( Run_t &run, const Value_t *pSorted, int nCount );
+	static int FillRun_R( Run_t &run, const Value_t *pSorted, int nSortedIndex, int nNode );
+	static void ExtractSorted( const Run_t &run, CUtlVector< Value_t > &sorted );
+	void FlushInsertBuffer();
+	void FindOverlapsInRun( const Run_t &run, const Interval_t &rCheck, CUtlVector< Value_t > &vecOverlappingIntervals, bool bStricOverlapsOnly ) const;
+	void FindAllOverlaps( const Interval_t &rCheck, CUtlVector< Value_t > &vecOverlappingIntervals, bool bStricOverlapsOnly ) const;
 
-private:
-
-	void DeleteTree_R( TreeNode *pNode );
-	TreeNode *Insert_R( const Value_t *pIntervals, unsigned int nCount );
+	CUtlVector< Run_t >		m_Runs;				// each no larger than half the one before it, roughly
+	CUtlVector< Value_t >	m_InsertBuffer;
 };
 
 template< class DataType, class T >
@@ -167,133 +201,276 @@ inline int CompareIntervals( const void *p1, const void *p2 )
 template< class DataType, class T >
 inline void CUtlIntervalTree< DataType, T >::BuildTree( Value_t *pIntervals, unsigned int nCount )
 {
-	if ( m_pRoot )  
-	{ 
-		DeleteTree_R( m_pRoot ); 
-		m_pRoot = NULL;  
-	}
+	RemoveAll();
 
 	if ( nCount > 0 )
 	{
 		qsort( pIntervals, nCount, sizeof( Value_t ), CompareIntervals< DataType, T > );
-		// Recursively build tree
-		m_pRoot = Insert_R( pIntervals, nCount );
+		BuildRun( m_Runs[ m_Runs.AddToTail() ], pIntervals, nCount );
 	}
 }
 
 template< class DataType, class T >
-inline CUtlIntervalTree<DataType, T>::~CUtlIntervalTree(void)
+inline void CUtlIntervalTree< DataType, T >::Insert( const Value_t &interval )
 {
-	if ( m_pRoot )
+	m_InsertBuffer.AddToTail( interval );
+
+	if ( m_InsertBuffer.Count() >= INSERT_BUFFER_SIZE )
 	{
-		DeleteTree_R( m_pRoot );
+		FlushInsertBuffer();
 	}
 }
 
 template< class DataType, class T >
-inline typename CUtlIntervalTree<DataType, T>::TreeNode *CUtlIntervalTree<DataType, T>::Insert_R( const Value_t *pIntervals, unsigned int nCount )
+inline void CUtlIntervalTree< DataType, T >::RemoveAll()
 {
-	unsigned int rootIdx = nCount / 2;
+	m_Runs.RemoveAll();
+	m_InsertBuffer.RemoveAll();
+}
 
-	TreeNode *pRoot = new TreeNode( pIntervals[ rootIdx ] );
+template< class DataType, class T >
+inline void CUtlIntervalTree< DataType, T >::Purge()
+{
+	m_Runs.Purge();
+	m_InsertBuffer.Purge();
+}
 
-	switch( nCount )
+template< class DataType, class T >
+inline int CUtlIntervalTree< DataType, T >::Count() const
+{
+	int nCount = m_InsertBuffer.Count();
+	for ( int i = 0; i < m_Runs.Count(); ++i )
 	{
-	case 1:
-		{
-			// m_pLeft, m_pRight are NULL by default
-			pRoot->m_MinVal = pRoot->m_Interval.GetLowVal();
-			pRoot->m_MaxVal = pRoot->m_Interval.GetHighVal();
-		}
-		break;
+		nCount += m_Runs[ i ].m_Values.Count();
+	}
+	return nCount;
+}
 
-	case 2:
-		{
-			pRoot->m_pLeft  = Insert_R( pIntervals, 1 );
-			// m_pRight == NULL by default
+template< class DataType, class T >
+inline int CUtlIntervalTree< DataType, T >::FillRun_R( Run_t &run, const Value_t *pSorted, int nSortedIndex, int nNode )
+{
+	// In order walk of the implicit tree hands out the sorted intervals left to right
+	if ( nNode >= run.m_Values.Count() )
+		return nSortedIndex;
 
-			pRoot->m_MinVal = pRoot->m_pLeft->m_MinVal;
-			pRoot->m_MaxVal = MAX( pRoot->m_pLeft->m_MaxVal, pRoot->m_Interval.GetHighVal() );
-		}
-		break;
+	nSortedIndex = FillRun_R( run, pSorted, nSortedIndex, 2 * nNode + 1 );
+	run.m_Values[ nNode ] = pSorted[ nSortedIndex++ ];
+	return FillRun_R( run, pSorted, nSortedIndex, 2 * nNode + 2 );
+}
 
-	default: // nCount > 2
-		{
-			pRoot->m_pLeft  = Insert_R( pIntervals, rootIdx );
-			pRoot->m_pRight = Insert_R( &pIntervals[ rootIdx + 1 ], nCount - rootIdx - 1 );
+template< class DataType, class T >
+inline void CUtlIntervalTree< DataType, T >::BuildRun( Run_t &run, const Value_t *pSorted, int nCount )
+{
+	run.m_Values.SetCount( nCount );
+	run.m_Nodes.SetCount( nCount );
+
+	FillRun_R( run, pSorted, 0, 0 );
+
+	// Children come after their parent, so one backwards pass fills in the subtree maxima
+	for ( int k = nCount - 1; k >= 0; --k )
+	{
+		TreeNode &node = run.m_Nodes[ k ];
+		node.m_MinVal = run.m_Values[ k ].GetLowVal();
+		node.m_HighVal = run.m_Values[ k ].GetHighVal();
+		node.m_MaxVal = node.m_HighVal;
 
-			pRoot->m_MinVal = pRoot->m_pLeft->m_MinVal;
-			// Max is greatest of this or two children...
-			pRoot->m_MaxVal = MAX( MAX( pRoot->m_pLeft->m_MaxVal, pRoot->m_pRight->m_MaxVal ), pRoot->m_Interval.GetHighVal() );
+		int nLeft = 2 * k + 1;
+		if ( nLeft < nCount )
+		{
+			node.m_MaxVal = MAX( node.m_MaxVal, run.m_Nodes[ nLeft ].m_MaxVal );
+		}
+		if ( nLeft + 1 < nCount )
+		{
+			node.m_MaxVal = MAX( node.m_MaxVal, run.m_Nodes[ nLeft + 1 ].m_MaxVal );
 		}
-		break;
 	}
-
-	return pRoot;
 }
 
 template< class DataType, class T >
-inline void CUtlIntervalTree<DataType, T>::DeleteTree_R( TreeNode *pNode )
+inline void CUtlIntervalTree< DataType, T >::ExtractSorted( const Run_t &run, CUtlVector< Value_t > &sorted )
 {
-	if ( pNode->m_pLeft )
-	{
-		DeleteTree_R( pNode->m_pLeft );
-	}
-	if ( pNode->m_pRight ) 
+	// Iterative in order walk: go left as far as possible, emit, then step right
+	const int nCount = run.m_Values.Count();
+	int stack[ MAX_TREE_DEPTH ];
+	int nStack = 0;
+	int k = 0;
+
+	sorted.EnsureCapacity( sorted.Count() + nCount );
+
+	while ( nStack > 0 || k < nCount )
 	{
-		DeleteTree_R( pNode->m_pRight );
+		if ( k < nCount )
+		{
+			stack[ nStack++ ] = k;
+			k = 2 * k + 1;
+		}
+		else
+		{
+			k = stack[ --nStack ];
+			sorted.AddToTail( run.m_Values[ k ] );
+			k = 2 * k + 2;
+		}
 	}
-	delete pNode;
 }
 
 template< class DataType, class T >
-inline void CUtlIntervalTree<DataType, T>::FindOverlaps( const Interval_t &rCheck, CUtlVector< Value_t > &vecOverlappingIntervals, bool bSortResultsByLowVal, bool bStricOverlapsOnly /*= false*/ ) const
+inline void CUtlIntervalTree< DataType, T >::FlushInsertBuffer()
 {
-	const TreeNode *pNode = m_pRoot;
-	if ( !pNode ) 
+	if ( !m_InsertBuffer.Count() )
 		return;
 
-	// Work queue stack
-	CUtlStack< const TreeNode * > stack;
-	stack.Push( NULL );
+	qsort( m_InsertBuffer.Base(), m_InsertBuffer.Count(), sizeof( Value_t ), CompareIntervals< DataType, T > );
+	BuildRun( m_Runs[ m_Runs.AddToTail() ], m_InsertBuffer.Base(), m_InsertBuffer.Count() );
+	m_InsertBuffer.RemoveAll();
 
-	while ( pNode != NULL )
+	// Merge the two newest runs for as long as the newer one has caught up with the older one
+	CUtlVector< Value_t > older, newer, merged;
+	while ( m_Runs.Count() >= 2 && m_Runs[ m_Runs.Count() - 2 ].m_Values.Count() <= m_Runs.Tail().m_Values.Count() )
 	{
-		if ( rCheck.IsOverlapping( pNode->m_Interval, bStricOverlapsOnly ) )
+		older.RemoveAll();
+		newer.RemoveAll();
+		merged.RemoveAll();
+
+		ExtractSorted( m_Runs[ m_Runs.Count() - 2 ], older );
+		ExtractSorted( m_Runs.Tail(), newer );
+
+		merged.EnsureCapacity( older.Count() + newer.Count() );
+		int i = 0, j = 0;
+		while ( i < older.Count() && j < newer.Count() )
 		{
-			vecOverlappingIntervals.AddToTail( pNode->m_Interval );
+			if ( newer[ j ].GetLowVal() < older[ i ].GetLowVal() )
+				merged.AddToTail( newer[ j++ ] );
+			else
+				merged.AddToTail( older[ i++ ] );
 		}
+		merged.AddMultipleToTail( older.Count() - i, older.Base() + i );
+		merged.AddMultipleToTail( newer.Count() - j, newer.Base() + j );
+
+		m_Runs.RemoveMultipleFromTail( 1 );
+		BuildRun( m_Runs.Tail(), merged.Base(), merged.Count() );
+	}
+}
+
+template< class DataType, class T >
+inline void CUtlIntervalTree<DataType, T>::FindOverlapsInRun( const Run_t &run, const Interval_t &rCheck, CUtlVector< Value_t > &vecOverlappingIntervals, bool bStricOverlapsOnly ) const
+{
+	const TreeNode *pNodes = run.m_Nodes.Base();
+	const int nCount = run.m_Nodes.Count();
+	const T checkLow = rCheck.GetLowVal();
+	const T checkHigh = rCheck.GetHighVal();
+
+	// Pre-order walk; a pending right child per level at most, so the stack stays shallow
+	int stack[ MAX_TREE_DEPTH ];
+	int nStack = 0;
+	stack[ nStack++ ] = 0;
+
+	while ( nStack > 0 )
+	{
+		int k = stack[ --nStack ];
+		const TreeNode &node = pNodes[ k ];
 
-		bool bCheckLeft = ( pNode->m_pLeft && 
-			pNode->m_pLeft->m_MaxVal >= rCheck.GetLowVal() );
-		bool bCheckRight = ( pNode->m_pRight && 
-			pNode->m_pRight->m_MinVal <= rCheck.GetHighVal() );
+		// Nothing in this subtree reaches the probe
+		if ( node.m_MaxVal < checkLow )
+			continue;
 
-		if ( bCheckRight )
+		int nLeft = 2 * k + 1;
+
+		// Everything to the right starts at or after this node, so if this one starts
+		// past the probe the whole right subtree does too
+		if ( node.m_MinVal <= checkHigh )
 		{
-			if ( bCheckLeft )
+			if ( rCheck.IsOverlapping( run.m_Values[ k ], bStricOverlapsOnly ) )
 			{
-				// queue it up for later
-				stack.Push( pNode->m_pLeft );
+				vecOverlappingIntervals.AddToTail( run.m_Values[ k ] );
 			}
 
-			pNode = pNode->m_pRight;
+			if ( nLeft + 1 < nCount )
+			{
+				stack[ nStack++ ] = nLeft + 1;
+			}
 		}
-		else if ( bCheckLeft )
+
+		if ( nLeft < nCount )
 		{
-			pNode = pNode->m_pLeft;
+			stack[ nStack++ ] = nLeft;
 		}
-		else
+	}
+}
+
+template< class DataType, class T >
+inline void CUtlIntervalTree<DataType, T>::FindAllOverlaps( const Interval_t &rCheck, CUtlVector< Value_t > &vecOverlappingIntervals, bool bStricOverlapsOnly ) const
+{
+	for ( int i = 0; i < m_Runs.Count(); ++i )
+	{
+		FindOverlapsInRun( m_Runs[ i ], rCheck, vecOverlappingIntervals, bStricOverlapsOnly );
+	}
+
+	for ( int i = 0; i < m_InsertBuffer.Count(); ++i )
+	{
+		if ( rCheck.IsOverlapping( m_InsertBuffer[ i ], bStricOverlapsOnly ) )
 		{
-			stack.Pop( pNode );
+			vecOverlappingIntervals.AddToTail( m_InsertBuffer[ i ] );
 		}
 	}
+}
+
+template< class DataType, class T >
+inline void CUtlIntervalTree<DataType, T>::FindOverlaps( const Interval_t &rCheck, CUtlVector< Value_t > &vecOverlappingIntervals, bool bSortResultsByLowVal, bool bStricOverlapsOnly /*= false*/ ) const
+{
+	int nFirst = vecOverlappingIntervals.Count();
+
+	FindAllOverlaps( rCheck, vecOverlappingIntervals, bStricOverlapsOnly );
 
 	if ( bSortResultsByLowVal && 
-		vecOverlappingIntervals.Count() > 1 )
+		vecOverlappingIntervals.Count() - nFirst > 1 )
+	{
+		qsort( vecOverlappingIntervals.Base() + nFirst, vecOverlappingIntervals.Count() - nFirst, sizeof( Value_t ), CompareIntervals< DataType, T > );
+	}
+}
+
+template< class DataType, class T >
+inline void CUtlIntervalTree<DataType, T>::FindOverlaps( const Interval_t *pChecks, int nChecks, CUtlVector< Value_t > &vecOverlappingIntervals, int *pResultStarts, bool bStricOverlapsOnly /*= false*/ ) const
+{
+	struct ProbeOrder_t
+	{
+		T m_Low;
+		int m_nIndex;
+	};
+
+	CUtlVector< ProbeOrder_t > order;
+	order.SetCount( nChecks );
+	for ( int i = 0; i < nChecks; ++i )
+	{
+		order[ i ].m_Low = pChecks[ i ].GetLowVal();
+		order[ i ].m_nIndex = i;
+	}
+	order.SortPredicate( []( const ProbeOrder_t &a, const ProbeOrder_t &b ) { return a.m_Low < b.m_Low; } );
+
+	// Gather in probe order, remembering where each probe's results landed...
+	CUtlVector< Value_t > gathered;
+	CUtlVector< int > gatheredStarts, gatheredCounts;
+	gatheredStarts.SetCount( nChecks );
+	gatheredCounts.SetCount( nChecks );
+	for ( int i = 0; i < nChecks; ++i )
+	{
+		int nCheck = order[ i ].m_nIndex;
+		gatheredStarts[ nCheck ] = gathered.Count();
+		FindAllOverlaps( pChecks[ nCheck ], gathered, bStricOverlapsOnly );
+		gatheredCounts[ nCheck ] = gathered.Count() - gatheredStarts[ nCheck ];
+	}
+
+	// ...then hand them back in the caller's order
+	int nOut = vecOverlappingIntervals.Count();
+	vecOverlappingIntervals.AddMultipleToTail( gathered.Count() );
+	for ( int i = 0; i < nChecks; ++i )
 	{
-		qsort( vecOverlappingIntervals.Base(), vecOverlappingIntervals.Count(), sizeof( Value_t ), CompareIntervals< DataType, T > );
+		pResultStarts[ i ] = nOut;
+		for ( int j = 0; j < gatheredCounts[ i ]; ++j )
+		{
+			vecOverlappingIntervals[ nOut++ ] = gathered[ gatheredStarts[ i ] + j ];
+		}
 	}
+	pResultStarts[ nChecks ] = nOut;
 }
 
 #endif // UTLINTERVALTREE_H
@@ -20,10 +20,19 @@
 #include "tier0/platform.h"
 
 #include "mathlib/mathlib.h"
+#include "tier1/alloctrackermacros.h"
 
 #include <string.h>
 #include <iterator>
 
+#ifdef SOURCESDK_ALLOC_TRACKER
+#define UTLLEANVECTOR_TRACK_ALLOC( nAllocated )	ALLOC_TRACKER_ALLOC( T, ( size_t )( nAllocated ) * sizeof( T ) )
+#define UTLLEANVECTOR_TRACK_FREE( nAllocated )	ALLOC_TRACKER_FREE( T, ( size_t )( nAllocated ) * sizeof( T ) )
+#else
+#define UTLLEANVECTOR_TRACK_ALLOC( nAllocated )	((void)0)
+#define UTLLEANVECTOR_TRACK_FREE( nAllocated )	((void)0)
+#endif
+
 #define FOR_EACH_LEANVEC( vecName, iteratorName ) \
 	for ( auto iteratorName = vecName.First(); vecName.IsValidIterator( iteratorName ); iteratorName = vecName.Next( iteratorName ) )
 
@@ -132,11 +141,16 @@ void CUtlLeanVectorBase<T, I, A>::EnsureCapacity( int num, bool force )
 	}
 	else
 	{
+		if ( m_nAllocated > 0 )
+			UTLLEANVECTOR_TRACK_FREE( m_nAllocated );
+
 		pNew = MemoryAllocator_t::Realloc( m_pElements, nNewAllocated, nNewAllocated );
 	}
 
 	m_pElements = pNew;
 	m_nAllocated = nNewAllocated;
+
+	UTLLEANVECTOR_TRACK_ALLOC( m_nAllocated );
 }
 
 //-----------------------------------------------------------------------------
@@ -219,6 +233,7 @@ inline void CUtlLeanVectorBase<T, I, A>::Purge()
 
 		if ( m_nAllocated > 0 )
 		{
+			UTLLEANVECTOR_TRACK_FREE( m_nAllocated );
 			MemoryAllocator_t::Free( (void*)m_pElements );
 		}
 	}
@@ -350,6 +365,7 @@ void CUtlLeanVectorFixedGrowableBase<T, N, I, A>::EnsureCapacity( int num, bool
 
 	if ( !IsExternallyAllocated() && m_nAllocated > N )
 	{
+		UTLLEANVECTOR_TRACK_FREE( m_nAllocated );
 		pNew = MemoryAllocator_t::Realloc( m_pElements, nNewAllocated, nNewAllocated );
 	}
 	else
@@ -360,6 +376,8 @@ void CUtlLeanVectorFixedGrowableBase<T, N, I, A>::EnsureCapacity( int num, bool
 	
 	m_pElements = pNew;
 	m_nAllocated = nNewAllocated;
+
+	UTLLEANVECTOR_TRACK_ALLOC( m_nAllocated );
 }
 
 //-----------------------------------------------------------------------------
@@ -385,7 +403,10 @@ inline void CUtlLeanVectorFixedGrowableBase<T, N, I, A>::Purge()
 	RemoveAll();
 	
 	if ( ( size_t )m_nAllocated > N )
+	{
+		UTLLEANVECTOR_TRACK_FREE( m_nAllocated );
 		CMemAllocAllocator::Free( (void*)m_pElements );
+	}
 	
 	m_nAllocated = N;
 }
@@ -0,0 +1,133 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: Read-only CUtlBuffer over a memory mapped file
+//
+// Loaders that parse from a CUtlBuffer (LoadKV3, KVPacker::ReadAsBinary) or a
+// raw pointer (CLZMA, CLZSS) can run straight off the page cache instead of a
+// heap copy of the file. Pages come in on demand and are shared with every
+// other process mapping the same file.
+//
+// e.g.:	CUtlMappedBuffer mapped;
+//			if ( mapped.Open( "maps/foo.vpk", CUtlMappedBuffer::ACCESS_SEQUENTIAL ) )
+//				KVPacker().ReadAsBinary( pKV, mapped.GetBuffer() );
+//
+// The buffer (and anything pointing into Base()) is only valid until the
+// next MapWindow() or Close(), so keep the CUtlMappedBuffer alive for as long
+// as the parsed data references the input.
+//
+//=============================================================================//
+
+#ifndef UTLMAPPEDBUFFER_H
+#define UTLMAPPEDBUFFER_H
+
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include "tier0/platform.h"
+#include "tier0/utlbuffer.h"
+
+
+class CUtlMappedBuffer
+{
+public:
+	// How the mapped range is going to be read, passed on to the kernel (madvise)
+	enum AccessHint_t
+	{
+		ACCESS_NORMAL = 0,
+		ACCESS_SEQUENTIAL,	// read front to back once; aggressive readahead, pages dropped early
+		ACCESS_RANDOM,		// scattered reads; no readahead
+		ACCESS_WILLNEED,	// start reading the whole range in now
+	};
+
+	// CUtlBuffer offsets are ints, so one window covers at most this much of the file
+	static const uint32 k_cubMaxWindow = 0x7fff0000;
+
+	CUtlMappedBuffer();
+	~CUtlMappedBuffer();
+
+	// Opens the file and maps the start of it (all of it when it's under k_cubMaxWindow).
+	// bTextBuffer marks the buffer as TEXT_BUFFER for text parsers.
+	bool Open( const char *pszFileName, AccessHint_t eHint = ACCESS_NORMAL, bool bTextBuffer = false );
+	void Close();
+
+	bool IsOpen() const;
+	uint64 GetFileSize() const;
+
+	// Remaps the buffer onto [ulOffset, ulOffset + cubSize) of the file; cubSize is clamped
+	// to the end of the file and k_cubMaxWindow. Walking files over 2GB goes through here.
+	bool MapWindow( uint64 ulOffset, uint32 cubSize, AccessHint_t eHint = ACCESS_NORMAL );
+
+	// Moves the window to start where the current one ends; false at the end of the file
+	bool MapNextWindow( AccessHint_t eHint = ACCESS_SEQUENTIAL );
+
+	// Re-hints part of the current window, offsets are relative to the window
+	void Advise( uint32 nOffset, uint32 cubSize, AccessHint_t eHint );
+
+	uint64 GetWindowOffset() const;
+	uint32 GetWindowSize() const;
+
+	// Start of the current window. The pages are private copy-on-write, so a decoder
+	// that writes into its input (or a null terminator poked in by a parser) only
+	// copies the page it touches and never reaches the file.
+	unsigned char *Base();
+	const unsigned char *Base() const;
+
+	// READ_ONLY external CUtlBuffer over the current window, get pointer at 0
+	CUtlBuffer &GetBuffer();
+
+private:
+	CUtlMappedBuffer( const CUtlMappedBuffer & ) = delete;
+	CUtlMappedBuffer &operator=( const CUtlMappedBuffer & ) = delete;
+
+	void Unmap();
+
+#ifdef _WIN32
+	void *m_hFile;
+	void *m_hMapping;
+#else
+	int m_fd;
+#endif
+	uint64 m_cubFile;
+
+	// the view starts on an allocation boundary at or before the window
+	void *m_pView;
+	size_t m_cubView;
+	uint64 m_ulWindowOffset;
+	uint32 m_cubWindow;
+
+	bool m_bTextBuffer;
+	CUtlBuffer m_Buffer;
+};
+
+
+inline bool CUtlMappedBuffer::IsOpen() const
+{
+#ifdef _WIN32
+	return m_hFile != NULL;
+#else
+	return m_fd >= 0;
+#endif
+}
+
+inline uint64 CUtlMappedBuffer::GetFileSize() const
+{
+	return m_cubFile;
+}
+
+inline uint64 CUtlMappedBuffer::GetWindowOffset() const
+{
+	return m_ulWindowOffset;
+}
+
+inline uint32 CUtlMappedBuffer::GetWindowSize() const
+{
+	return m_cubWindow;
+}
+
+inline CUtlBuffer &CUtlMappedBuffer::GetBuffer()
+{
+	return m_Buffer;
+}
+
+#endif // UTLMAPPEDBUFFER_H
@@ -280,7 +280,7 @@ class ObjectAttributeKeyOps_t
 {
 public:
 	static ObjectAttributeKey_t MakeKey( uint32 nHash, UtlSymLargeId_t iNameSymbol = UTL_INVAL_SYMBOL_LARGE ) { return ObjectAttributeKey_t( nHash, iNameSymbol ); }
-	static ObjectAttributeKey_t MakeKey( const char *pszName, UtlSymLargeId_t iNameSymbol = UTL_INVAL_SYMBOL_LARGE ) { return MakeKey( pszName ? HashStringWithBuffer< true >( pszName ) : 0, iNameSymbol ); }
+	static ObjectAttributeKey_t MakeKey( const char *pszName, UtlSymLargeId_t iNameSymbol = UTL_INVAL_SYMBOL_LARGE ) { return MakeKey( pszName ? MakeStringToken2< true >( pszName ).GetHashCode() : 0, iNameSymbol ); }
 	static ObjectAttributeKey_t MakeKey( const CUtlString &sName, UtlSymLargeId_t iNameSymbol = UTL_INVAL_SYMBOL_LARGE ) { return MakeKey( sName.String(), iNameSymbol ); }
 	static ObjectAttributeKey_t MakeKey( const CUtlStringToken &name, UtlSymLargeId_t iNameSymbol = UTL_INVAL_SYMBOL_LARGE ) { return MakeKey( static_cast< uint32 >( name ), iNameSymbol ); }
 
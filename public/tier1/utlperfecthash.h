@@ -0,0 +1,235 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: Minimal perfect hash tables over constant string arrays
+//
+// CUtlPerfectHash is built by the compiler from a constexpr array of names
+// and maps each name back to its index: one hash of the name, a read of the
+// bucket's displacement, one remix and a compare against the name found
+// there. Every slot holds a name, so a miss costs the same as a hit.
+//
+//	static constexpr auto s_Table = MakePerfectHash( k_pszNames );
+//	int nIndex = s_Table.Find( pszName ); // -1 when it's not one
+//
+// Names are hashed as CUtlStringTokens, so a case-insensitive table can also
+// be looked up by a token someone already has. NULL entries are left out.
+// A table that can't be built (the same name twice) is a compile error
+// naming CUtlPerfectHash_BuildFailed.
+//
+//=============================================================================//
+
+#ifndef UTLPERFECTHASH_H
+#define UTLPERFECTHASH_H
+
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include "tier0/utlstringtoken.h"
+
+// Not constexpr: reached only when a table can't be built, it stops the build there
+inline void CUtlPerfectHash_BuildFailed( const char *pszReason ) {}
+
+template< int N, bool CASEINSENSITIVE = false >
+class CUtlPerfectHash
+{
+public:
+	static_assert( N > 0, "CUtlPerfectHash needs at least one name" );
+
+	STRINGTOKEN_CONSTEVAL explicit CUtlPerfectHash( const char *const ( &pNames )[N] ) : m_ppNames( pNames )
+	{
+		int nBucketSizes[N] = {};
+		int nMaxBucketSize = 0;
+
+		for ( int i = 0; i < N; i++ )
+		{
+			m_nSlotIndices[i] = -1;
+
+			if ( !pNames[i] )
+				continue;
+
+			m_nLengths[i] = ConstLength( pNames[i] );
+			m_nHashes[i] = CUtlStringToken::Hash< CASEINSENSITIVE >( pNames[i], m_nLengths[i] );
+
+			int nBucket = m_nHashes[i] % N;
+			if ( ++nBucketSizes[nBucket] > nMaxBucketSize )
+				nMaxBucketSize = nBucketSizes[nBucket];
+		}
+
+		// The fullest buckets pick their displacement first, while most slots are free
+		for ( int nSize = nMaxBucketSize; nSize > 1; nSize-- )
+		{
+			for ( int nBucket = 0; nBucket < N; nBucket++ )
+			{
+				if ( nBucketSizes[nBucket] == nSize )
+					Displace( nBucket );
+			}
+		}
+
+		// Buckets of one point straight at a free slot
+		int nFreeSlot = 0;
+		for ( int i = 0; i < N; i++ )
+		{
+			if ( !pNames[i] || nBucketSizes[m_nHashes[i] % N] != 1 )
+				continue;
+
+			while ( m_nSlotIndices[nFreeSlot] >= 0 )
+				nFreeSlot++;
+
+			m_nDisplacements[m_nHashes[i] % N] = -1 - nFreeSlot;
+			m_nSlotIndices[nFreeSlot] = i;
+		}
+
+		// NULL names leave slots over; they keep pointing at an index the compare rejects
+		for ( int i = 0; i < N; i++ )
+		{
+			if ( m_nSlotIndices[i] < 0 )
+				m_nSlotIndices[i] = FirstName();
+		}
+	}
+
+	// Index of the name in the array the table was built from, -1 if it's not there
+	constexpr int Find( const char *pName, int nLength ) const
+	{
+		uint32 nHash = CUtlStringToken::Hash< CASEINSENSITIVE >( pName, nLength );
+		int nIndex = m_nSlotIndices[Slot( nHash )];
+
+		return ( m_nHashes[nIndex] == nHash && m_nLengths[nIndex] == nLength && Equal( m_ppNames[nIndex], pName, nLength ) ) ? nIndex : -1;
+	}
+
+	constexpr int Find( const char *pName ) const
+	{
+		return Find( pName, ConstLength( pName ) );
+	}
+
+	// By the token of the name, trusting the hash as tokens do
+	constexpr int Find( CUtlStringToken token ) const
+	{
+		static_assert( CASEINSENSITIVE, "CUtlStringTokens are hashed lowercase, the table must be too" );
+
+		uint32 nHash = token.GetHashCode();
+		int nIndex = m_nSlotIndices[Slot( nHash )];
+
+		return m_nHashes[nIndex] == nHash ? nIndex : -1;
+	}
+
+	constexpr int Count() const { return N; }
+	constexpr const char *operator[]( int i ) const { return m_ppNames[i]; }
+
+private:
+	static constexpr int ConstLength( const char *pName )
+	{
+		int nLength = 0;
+		while ( pName[nLength] )
+			nLength++;
+
+		return nLength;
+	}
+
+	static constexpr uint8 Fold( char c )
+	{
+		return ( CASEINSENSITIVE && c >= 'A' && c <= 'Z' ) ? ( uint8 )( c | 0x20 ) : ( uint8 )c;
+	}
+
+	static constexpr bool Equal( const char *pA, const char *pB, int nLength )
+	{
+		for ( int i = 0; i < nLength; i++ )
+		{
+			if ( Fold( pA[i] ) != Fold( pB[i] ) )
+				return false;
+		}
+
+		return true;
+	}
+
+	// The murmur finalizer over the hash and the displacement, which gives a
+	// fresh slot for every displacement without hashing the name again
+	static constexpr uint32 Remix( uint32 nHash, int nDisplacement )
+	{
+		uint32 h = nHash ^ ( ( uint32 )nDisplacement * 0x9E3779B9u );
+		h ^= h >> 16;
+		h *= 0x85EBCA6Bu;
+		h ^= h >> 13;
+		h *= 0xC2B2AE35u;
+		h ^= h >> 16;
+		return h;
+	}
+
+	constexpr int Slot( uint32 nHash ) const
+	{
+		int nDisplacement = m_nDisplacements[nHash % N];
+		return nDisplacement < 0 ? -1 - nDisplacement : ( int )( Remix( nHash, nDisplacement ) % N );
+	}
+
+	STRINGTOKEN_CONSTEVAL int FirstName() const
+	{
+		for ( int i = 0; i < N; i++ )
+		{
+			if ( m_ppNames[i] )
+				return i;
+		}
+
+		CUtlPerfectHash_BuildFailed( "every name is NULL" );
+		return 0;
+	}
+
+	// Tries displacements until every name in the bucket lands in its own free slot
+	STRINGTOKEN_CONSTEVAL void Displace( int nBucket )
+	{
+		int nMembers[N] = {};
+		int nMemberCount = 0;
+		for ( int i = 0; i < N; i++ )
+		{
+			if ( m_ppNames[i] && ( int )( m_nHashes[i] % N ) == nBucket )
+				nMembers[nMemberCount++] = i;
+		}
+
+		for ( int nDisplacement = 1; nDisplacement < ( 1 << 16 ); nDisplacement++ )
+		{
+			int nSlots[N] = {};
+			bool bFits = true;
+			for ( int i = 0; i < nMemberCount && bFits; i++ )
+			{
+				nSlots[i] = ( int )( Remix( m_nHashes[nMembers[i]], nDisplacement ) % N );
+				bFits = m_nSlotIndices[nSlots[i]] < 0;
+
+				for ( int j = 0; j < i && bFits; j++ )
+				{
+					bFits = nSlots[j] != nSlots[i];
+				}
+			}
+
+			if ( bFits )
+			{
+				m_nDisplacements[nBucket] = nDisplacement;
+				for ( int i = 0; i < nMemberCount; i++ )
+				{
+					m_nSlotIndices[nSlots[i]] = nMembers[i];
+				}
+
+				return;
+			}
+		}
+
+		CUtlPerfectHash_BuildFailed( "two names hash the same, is one of them in the array twice?" );
+	}
+
+	const char *const *m_ppNames;
+
+	// Per bucket: 0 for none, below 0 the slot of a lone name, above 0 what to remix with
+	int m_nDisplacements[N] = {};
+
+	// Per slot, the index of the name in it
+	int m_nSlotIndices[N] = {};
+
+	// Per name
+	uint32 m_nHashes[N] = {};
+	int m_nLengths[N] = {};
+};
+
+template< bool CASEINSENSITIVE = false, int N >
+STRINGTOKEN_CONSTEVAL CUtlPerfectHash< N, CASEINSENSITIVE > MakePerfectHash( const char *const ( &pNames )[N] )
+{
+	return CUtlPerfectHash< N, CASEINSENSITIVE >( pNames );
+}
+
+#endif // UTLPERFECTHASH_H
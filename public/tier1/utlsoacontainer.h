@@ -362,6 +362,11 @@ public:
 	/// find the largest value of a vector attribute
 	void FindLargestMagnitudeVector( int nAttr, int *nx, int *ny, int *nz );
 
+	// Pass pErrorCalculator == NULL to cluster by plain euclidean distance over the fields, which
+	// prunes most of the search with distance bounds; the error channel then receives the squared
+	// distance. The assignments match an exhaustive search except where two centroids are within
+	// float rounding of the same distance. Samples in the SIMD padding columns are counted as
+	// with an error metric, so the centroids come out the same as a euclidean metric's would.
 	void KMeansQuantization( int const *pFieldIndices, int nNumFields,
 							 KMeansQuantizedValue *pOutValues,
 							 int nNumResultsDesired, IKMeansErrorMetric *pErrorCalculator,
@@ -373,11 +378,11 @@ public:
 	// with nSrcField == 0 will get 0, and nSrcField >0 will yield positive distances.  Note the
 	// min/max x/y/z fields don't reflect the range to be written, but rather represent the bounds
 	// of updated voxels that you want your distance field modified to take into account. This
-	// volume will be bloated based upon the nMaxDistance parameter and simd padding.  A
-	// brute-force algorithm is used, but it is threaded and simd'd. Large "nMaxDistance" values
-	// applied to large images can take a long time, as the execution time per output pixel is
-	// proportional to maxdistance^2.  The rect argument, if passed, will be modified to be the
-	// entire rectangle modified by the operation.
+	// volume will be bloated based upon the nMaxDistance parameter and simd padding.  The
+	// distances are exact (an exact euclidean distance transform, threaded by slices and rows),
+	// clamped to nMaxDistance, and the cost per voxel does not depend on nMaxDistance. Voxels in
+	// the SIMD padding columns are never taken as the nearest.  The rect argument, if passed, will
+	// be modified to be the entire rectangle modified by the operation.
 	void GenerateDistanceField( int nSrcField, int nDestField,
 								int nMaxDistance,
 								Rect3D_t *pRect = NULL );
@@ -421,9 +426,6 @@ protected:
 		m_eThreadMode = SOATHREADMODE_NONE;
 	}
 
-	void UpdateDistanceRow( int nSearchRadius, int nMinX, int nMaxX, int nY, int nZ,
-							int nSrcField, int nDestField );
-
 	// parallel helper functions. These do the work, and all take a row/column range as their first arguments.
 	void CopyAttrFromPartial( int nStartRow, int nNumRows, int nStartSlice, int nEndSlice, CSOAContainer const *pOther, int nDestAttributeIndex, int nSrcAttributeIndex );
 	void FillAttrPartial( int nStartRow, int nNumRows, int nStartSlice, int nEndSlice, int nAttr, fltx4 fl4Value );
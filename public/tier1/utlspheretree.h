@@ -418,7 +418,7 @@ inline void CUtlSphereTree::Insert( const void *pData, const Sphere_t *bounds )
 	float minCost = FLT_MAX;
 	for ( int i = 0; i < path.Count(); i++ )
 	{
-		NodeRef &sibling = Ref( path[ i ] );
+		NodeRef sibling = Ref( path[ i ] );
 		// NOTE: Can't rebalance the tree if you pair with a depth 3+ sibling
 		if ( ( sibling->maxDepth <= 2 ) && ( ComputePairingCost2( sibling, bounds, path ) < minCost ) )
 			bestSibling = i;
@@ -437,7 +437,7 @@ inline void CUtlSphereTree::Insert( const void *pData, const Sphere_t *bounds )
 	for ( int i = ( bestSibling + 1 ); i < path.Count(); i++ )
 	{
 		// Update each node's status whose descendants were modified, and rebalance it:
-		NodeRef &sibling = Ref( path[ i ] );
+		NodeRef sibling = Ref( path[ i ] );
 		SetNodeChildren( sibling, sibling.Deep(), sibling.Shallow() );
 		RebalanceSubtrees( sibling, true );
 	}
@@ -18,6 +18,7 @@
 #include "tier0/memblockallocator.h"
 #include "tier0/utlstringtoken.h"
 #include "tier1/generichash.h"
+#include "tier1/strtools_simd.h"
 #include "tier1/utlcommon.h"
 #include "tier1/utlvector.h"
 #include "tier1/utlhashtable.h"
@@ -138,14 +139,14 @@ public:
 
 	// Finds the symbol for pString
 	UtlSymLargeId_t Find( const char* pString, int nLength ) const;
-	UtlSymLargeId_t Find( const char* pString ) const { return Find( pString, V_strlen( pString ) ); }
+	UtlSymLargeId_t Find( const char* pString ) const { return Find( pString, V_strlen_simd( pString ) ); }
 
 	CUtlSymbolLarge FindString( const char* pString, int nLength ) const { return String( Find( pString, nLength ) ); }
-	CUtlSymbolLarge FindString( const char* pString ) const { return FindString( pString, V_strlen( pString ) ); }
+	CUtlSymbolLarge FindString( const char* pString ) const { return FindString( pString, V_strlen_simd( pString ) ); }
 
 	// Finds and/or creates a symbol based on the string
 	UtlSymLargeId_t Add( const char* pString, int nLength );
-	UtlSymLargeId_t Add( const char* pString ) { return Add( pString, V_strlen( pString ) ); }
+	UtlSymLargeId_t Add( const char* pString ) { return Add( pString, V_strlen_simd( pString ) ); }
 
 	CUtlSymbolLarge AddString( const char* pString, int nLength ) { return String( Add( pString, nLength ) ); }
 	CUtlSymbolLarge AddString( const char* pString ) { return String( Add( pString ) ); }
@@ -202,7 +203,7 @@ private:
 				return false;
 
 			if ( CASEINSENSITIVE )
-				return V_stricmp( pA, pB ) == 0;
+				return V_stricmp_simd( pA, pB ) == 0;
 			else
 				return V_strcmp( pA, pB ) == 0;
 		}
@@ -214,13 +215,13 @@ private:
 			if ( !pString )
 				return false;
 
-			int nLength = ( int )strlen( pString );
+			int nLength = V_strlen_simd( pString );
 
 			if ( a.m_nLength != nLength )
 				return false;
 
 			if ( CASEINSENSITIVE ) 
-				return V_strnicmp( a.m_pString, pString, a.m_nLength ) == 0; 
+				return V_strnicmp_simd( a.m_pString, pString, a.m_nLength ) == 0; 
 			else
 				return V_strncmp( a.m_pString, pString, a.m_nLength ) == 0; 
 		}
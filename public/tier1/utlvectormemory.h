@@ -22,6 +22,7 @@
 
 #include "tier0/memalloc.h"
 #include "mathlib/mathlib.h"
+#include "tier1/alloctrackermacros.h"
 
 #include "tier0/memdbgon.h"
 
@@ -42,6 +43,9 @@
 #ifdef UTLVECTORMEMORY_TRACK
 #define UTLVECTORMEMORY_TRACK_ALLOC()		MemAlloc_RegisterAllocation( "||Sum of all UtlMemory||", 0, m_nAllocationCount * sizeof(T), m_nAllocationCount * sizeof(T), 0 )
 #define UTLVECTORMEMORY_TRACK_FREE()		if ( !m_pMemory ) ; else MemAlloc_RegisterDeallocation( "||Sum of all UtlMemory||", 0, m_nAllocationCount * sizeof(T), m_nAllocationCount * sizeof(T), 0 )
+#elif defined( SOURCESDK_ALLOC_TRACKER )
+#define UTLVECTORMEMORY_TRACK_ALLOC()		if ( !this->m_nAllocationCount ) ; else ALLOC_TRACKER_ALLOC( T, this->m_nAllocationCount * sizeof(T) )
+#define UTLVECTORMEMORY_TRACK_FREE()		if ( !this->m_pMemory || !this->m_nAllocationCount || this->IsExternallyAllocated() ) ; else ALLOC_TRACKER_FREE( T, this->m_nAllocationCount * sizeof(T) )
 #else
 #define UTLVECTORMEMORY_TRACK_ALLOC()		((void)0)
 #define UTLVECTORMEMORY_TRACK_FREE()		((void)0)
@@ -680,6 +684,8 @@ void CUtlVectorMemory< T, I >::AssumeMemory( T* pMemory, I numElements )
 
 	m_bHasConstMemory = false;
 	m_bExternal = false;
+
+	UTLVECTORMEMORY_TRACK_ALLOC();
 }
 
 template< class T, class I >
@@ -688,6 +694,8 @@ void *CUtlVectorMemory< T, I >::DetachMemory()
 	if ( IsExternallyAllocated() )
 		return NULL;
 
+	UTLVECTORMEMORY_TRACK_FREE();
+
 	void *pMemory = m_pMemory;
 	m_pMemory = 0;
 	m_nAllocationCount = 0;
@@ -1358,11 +1366,15 @@ void CUtlVectorMemory_RawAllocator<T, I>::AssumeMemory( T* pMemory, I numElement
 	// Simply take the pointer but don't mark us as external
 	m_pMemory = pMemory;
 	m_nAllocationCount = numElements;
+
+	UTLVECTORMEMORY_TRACK_ALLOC();
 }
 
 template< class T, typename I >
 void *CUtlVectorMemory_RawAllocator<T, I>::DetachMemory()
 {
+	UTLVECTORMEMORY_TRACK_FREE();
+
 	void *pMemory = m_pMemory;
 	m_pMemory = 0;
 	m_nAllocationCount = 0;
@@ -1397,6 +1409,8 @@ inline void CUtlVectorMemory_RawAllocator<T, I>::EnsureCapacity( I num )
 	int new_alloc_size = CalcNewDoublingCount( m_nAllocationCount, num, 2, INT_MAX );
 	size_t adjusted_size = 0;
 
+	UTLVECTORMEMORY_TRACK_FREE();
+
 	MEM_ALLOC_CREDIT_CLASS();
 	m_pMemory = (T *)CRawAllocator::Realloc( m_pMemory, new_alloc_size * sizeof( T ), &adjusted_size );
 	m_nAllocationCount = clamp( (int)(adjusted_size / sizeof( T )), new_alloc_size, INT_MAX );
@@ -0,0 +1,29 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: Sends the TRACY_ZONE / TM_ZONE markers from tier0/vprof_tracy.h to
+//			the zone profiler in tier1/zoneprofiler.h. Include this instead of
+//			tier0/vprof_tracy.h in code that links tier1.
+//
+//=============================================================================//
+
+#ifndef VPROF_ZONEPROFILER_H
+#define VPROF_ZONEPROFILER_H
+
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include "tier0/vprof_tracy.h"
+#include "tier1/zoneprofiler.h"
+
+#undef TRACY_ZONE
+#undef TM_ZONE
+#undef TM_ZONE_FILTERED
+
+#define TRACY_ZONE( zoneName ) ZONE_PROFILE( zoneName )
+
+// format strings aren't expanded, the zone is named after the format itself
+#define TM_ZONE( level, flags, formatStr, ... ) ZONE_PROFILE( formatStr )
+#define TM_ZONE_FILTERED( context, kThreshold, kFlags, kpFormat, ... ) ZONE_PROFILE( kpFormat )
+
+#endif // VPROF_ZONEPROFILER_H
@@ -0,0 +1,373 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: Scoped profiler zones with a per-thread call tree (tier1/zoneprofiler.cpp)
+//
+// ZONE_PROFILE( "name" ) times the rest of the scope. Each thread writes its
+// finished zones (start, length, zone id, depth) into its own ring with no
+// locks; an aggregator drains the rings, cuts them into frames at
+// ZoneProfiler_FrameMark and folds them into one call tree per thread with
+// min/max/p50/p99 per frame. The frames it keeps can be written out as a
+// Chrome trace (chrome://tracing, Perfetto) or as a compact binary capture.
+//
+// When the profiler is disabled a zone costs a load and a branch, and a zone is
+// only registered the first time it runs enabled.
+//
+//=============================================================================//
+
+#ifndef ZONEPROFILER_H
+#define ZONEPROFILER_H
+
+#ifdef _WIN32
+#pragma once
+#endif
+
+#include "tier0/platform.h"
+#include "tier0/microprofiler.h"
+#include "tier0/threadtools.h"
+#include "tier1/utlvector.h"
+#include "tier0/utlstring.h"
+
+#include <atomic>
+
+class CUtlBuffer;
+
+// Zones each thread can have in flight before the aggregator drains them; must be a power of two
+#ifndef ZONE_PROFILER_RING_SIZE
+#define ZONE_PROFILER_RING_SIZE 8192
+#endif
+
+// Frames of per-node history the percentiles are taken over
+#ifndef ZONE_PROFILER_HISTORY_FRAMES
+#define ZONE_PROFILER_HISTORY_FRAMES 1024
+#endif
+
+#define ZONE_PROFILER_INVALID_ZONE 0
+
+// One finished zone. Start and length are in GetTimebaseRegister() ticks;
+// zones longer than 2^32 ticks are clamped.
+struct ZoneProfilerEvent_t
+{
+	uint64 m_nStart;
+	uint32 m_nTicks;
+	uint16 m_nZone;
+	uint16 m_nDepth;
+};
+
+class CZoneProfilerThread
+{
+public:
+	CZoneProfilerThread();
+
+	// Owner thread only
+	void Record( uint64 nStart, uint64 nEnd, uint16 nZone, uint16 nDepth )
+	{
+		uint32 nWrite = m_nWrite.load( std::memory_order_relaxed );
+		if ( nWrite - m_nReadCached >= ZONE_PROFILER_RING_SIZE )
+		{
+			m_nReadCached = m_nRead.load( std::memory_order_acquire );
+			if ( nWrite - m_nReadCached >= ZONE_PROFILER_RING_SIZE )
+			{
+				m_nDropped.store( m_nDropped.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+				return;
+			}
+		}
+
+		uint64 nTicks = nEnd - nStart;
+		ZoneProfilerEvent_t &event = m_Events[nWrite & ( ZONE_PROFILER_RING_SIZE - 1 )];
+		event.m_nStart = nStart;
+		event.m_nTicks = ( nTicks > 0xFFFFFFFFull ) ? 0xFFFFFFFFu : ( uint32 )nTicks;
+		event.m_nZone = nZone;
+		event.m_nDepth = nDepth;
+
+		m_nWrite.store( nWrite + 1, std::memory_order_release );
+	}
+
+	// Aggregator only: copies out everything written so far, returns the count
+	int Drain( CUtlVector< ZoneProfilerEvent_t > &events );
+
+	// Written by the owner thread
+	std::atomic< uint32 > m_nWrite;
+	uint32 m_nReadCached;
+	uint16 m_nDepth;
+	std::atomic< uint32 > m_nDropped;
+
+	// Written by the aggregator, on a line of its own
+	alignas( 64 ) std::atomic< uint32 > m_nRead;
+
+	// Set while a thread owns the ring; rings are reused, never freed
+	std::atomic< bool > m_bInUse;
+	ThreadId_t m_nThreadId;
+	int m_nIndex;
+	char m_szName[32];
+	CZoneProfilerThread *m_pNext;
+
+	alignas( 64 ) ZoneProfilerEvent_t m_Events[ZONE_PROFILER_RING_SIZE];
+};
+
+extern std::atomic< bool > g_bZoneProfilerEnabled;
+extern thread_local CZoneProfilerThread *g_pZoneProfilerThread;
+
+// Claims a ring for the calling thread the first time it records a zone
+CZoneProfilerThread *ZoneProfiler_AttachThread();
+
+inline CZoneProfilerThread *ZoneProfiler_GetThread()
+{
+	CZoneProfilerThread *pThread = g_pZoneProfilerThread;
+	return pThread ? pThread : ZoneProfiler_AttachThread();
+}
+
+// Zone names must outlive the profiler; string literals and __FUNCTION__ do
+uint16 ZoneProfiler_RegisterZone( const char *pszName, const char *pszFile = NULL, int nLine = 0 );
+const char *ZoneProfiler_GetZoneName( uint16 nZone );
+int ZoneProfiler_GetZoneCount();
+
+void ZoneProfiler_Enable( bool bEnable );
+inline bool ZoneProfiler_IsEnabled() { return g_bZoneProfilerEnabled.load( std::memory_order_relaxed ); }
+
+// Ends the current frame; call once a frame from the thread that drives them
+void ZoneProfiler_FrameMark();
+
+// Names the calling thread in the trees and exports
+void ZoneProfiler_SetThreadName( const char *pszName );
+
+// Gives the calling thread's ring back when the thread is about to exit
+void ZoneProfiler_DetachThread();
+
+// GetTimebaseRegister() ticks per second, measured against the wall clock
+double ZoneProfiler_GetTicksPerSecond();
+
+// A ZONE_PROFILE site. It is constant initialized, so sites in functions need no
+// static guard (the build has -fno-threadsafe-statics), and registers its zone the
+// first time it runs enabled. Threads that get there together both register, which
+// hands them the same id.
+class CZoneProfilerSite
+{
+public:
+	constexpr CZoneProfilerSite( const char *pszName, const char *pszFile, int nLine ) :
+		m_pszName( pszName ), m_pszFile( pszFile ), m_nLine( nLine ), m_nZone( ZONE_PROFILER_INVALID_ZONE )
+	{
+	}
+
+	uint16 GetZone()
+	{
+		uint16 nZone = m_nZone.load( std::memory_order_relaxed );
+		if ( nZone == ZONE_PROFILER_INVALID_ZONE )
+		{
+			nZone = ZoneProfiler_RegisterZone( m_pszName, m_pszFile, m_nLine );
+			m_nZone.store( nZone, std::memory_order_relaxed );
+		}
+
+		return nZone;
+	}
+
+private:
+	const char *m_pszName;
+	const char *m_pszFile;
+	int m_nLine;
+	std::atomic< uint16 > m_nZone;
+};
+
+class CZoneProfilerScope
+{
+public:
+	explicit CZoneProfilerScope( uint16 nZone )
+	{
+		if ( !ZoneProfiler_IsEnabled() )
+		{
+			m_pThread = NULL;
+			return;
+		}
+
+		Begin( nZone );
+	}
+
+	explicit CZoneProfilerScope( CZoneProfilerSite &site )
+	{
+		if ( !ZoneProfiler_IsEnabled() )
+		{
+			m_pThread = NULL;
+			return;
+		}
+
+		Begin( site.GetZone() );
+	}
+
+	~CZoneProfilerScope()
+	{
+		if ( m_pThread )
+		{
+			uint64 nEnd = GetTimebaseRegister();
+			m_pThread->m_nDepth = m_nDepth;
+			m_pThread->Record( m_nStart, nEnd, m_nZone, m_nDepth );
+		}
+	}
+
+private:
+	void Begin( uint16 nZone )
+	{
+		m_pThread = ZoneProfiler_GetThread();
+		m_nZone = nZone;
+		m_nDepth = m_pThread->m_nDepth++;
+		m_nStart = GetTimebaseRegister();
+	}
+
+	CZoneProfilerThread *m_pThread;
+	uint64 m_nStart;
+	uint16 m_nZone;
+	uint16 m_nDepth;
+};
+
+#define ZONE_PROFILER_CONCAT_( a, b ) a##b
+#define ZONE_PROFILER_CONCAT( a, b ) ZONE_PROFILER_CONCAT_( a, b )
+
+#define ZONE_PROFILE_( name, id ) \
+	static CZoneProfilerSite ZONE_PROFILER_CONCAT( s_ZoneProfilerSite, id )( name, __FILE__, __LINE__ ); \
+	CZoneProfilerScope ZONE_PROFILER_CONCAT( zoneProfilerScope, id )( ZONE_PROFILER_CONCAT( s_ZoneProfilerSite, id ) )
+
+// Times the rest of the enclosing scope; name has to be a constant, a string literal or __FUNCTION__
+#define ZONE_PROFILE( name ) ZONE_PROFILE_( name, __COUNTER__ )
+
+//-----------------------------------------------------------------------------
+// A run of frames as raw zones, for export. Starts are absolute ticks.
+//-----------------------------------------------------------------------------
+struct ZoneProfilerCaptureEvent_t
+{
+	uint64 m_nStart;
+	uint32 m_nTicks;
+	uint16 m_nZone;
+	uint16 m_nDepth;
+	int m_nThread;
+};
+
+class CZoneProfilerCapture
+{
+public:
+	CZoneProfilerCapture();
+
+	void Purge();
+
+	// Trace Event Format, one complete ("X") event per zone, times in microseconds from the first frame
+	void ExportChromeTrace( CUtlBuffer &buf ) const;
+
+	// Varint packed, roughly a third of the size of the events in memory
+	void ExportBinary( CUtlBuffer &buf ) const;
+	bool ImportBinary( CUtlBuffer &buf );
+
+	double m_flTicksPerSecond;
+	CUtlVector< CUtlString > m_ZoneNames;	// indexed by zone id
+	CUtlVector< CUtlString > m_ThreadNames;	// indexed by m_nThread
+	CUtlVector< uint64 > m_FrameStarts;		// one past the last frame is its end
+	CUtlVector< ZoneProfilerCaptureEvent_t > m_Events;	// by thread, then start
+};
+
+//-----------------------------------------------------------------------------
+// Drains the rings and keeps a call tree per thread. There should only be one,
+// as it is the rings' only reader. Update can run from Start's thread or be
+// called by hand; the accessors lock against it.
+//
+// A frame is folded in once the frame after it has ended too, so zones that
+// finish a little after their frame still land in it. Later ones are counted
+// in GetLateZones and left out.
+//-----------------------------------------------------------------------------
+struct ZoneProfilerNode_t
+{
+	uint16 m_nZone;			// ZONE_PROFILER_INVALID_ZONE for a thread's root
+	int m_nThread;
+	int m_nParent;
+	int m_nFirstChild;
+	int m_nNextSibling;
+};
+
+struct ZoneProfilerStats_t
+{
+	uint64 m_nCalls;		// over all frames
+	int m_nFrames;			// frames the zone ran in
+	double m_flMinMs;		// per frame, over all frames it ran in
+	double m_flMaxMs;
+	double m_flP50Ms;		// per frame, over the last ZONE_PROFILER_HISTORY_FRAMES it ran in
+	double m_flP99Ms;
+};
+
+class CZoneProfilerAggregator
+{
+public:
+	CZoneProfilerAggregator();
+	~CZoneProfilerAggregator();
+
+	// Runs Update every nIntervalMs on a thread of its own until Stop
+	void Start( int nIntervalMs = 5 );
+	void Stop();
+
+	void Update();
+
+	// Drops the trees and capture, keeps reading the rings from where it was
+	void Reset();
+
+	int GetNodeCount() const;
+	ZoneProfilerNode_t GetNode( int nNode ) const;
+	bool GetStats( int nNode, ZoneProfilerStats_t &stats ) const;
+
+	// Root of a thread's tree, -1 if it hasn't recorded a zone in a folded frame
+	int GetThreadRoot( int nThread ) const;
+	int FindChild( int nParent, const char *pszZoneName ) const;
+
+	int GetFrameCount() const;
+	uint64 GetDroppedZones() const;
+	uint64 GetLateZones() const;
+
+	// How many of the most recent frames the capture keeps
+	void SetCaptureFrames( int nFrames );
+	void GetCapture( CZoneProfilerCapture &capture ) const;
+
+private:
+	struct Node_t : ZoneProfilerNode_t
+	{
+		uint64 m_nCalls;
+		int m_nFrames;
+		uint64 m_nMinTicks;
+		uint64 m_nMaxTicks;
+		uint64 m_nFrameTicks;	// of the frame being folded
+		uint32 m_nFrameCalls;
+		CUtlVector< uint64 > m_History;
+	};
+
+	struct PendingEvent_t
+	{
+		ZoneProfilerEvent_t m_Event;
+		int m_nThread;
+	};
+
+	static uintp ThreadProc( void *pParam );
+
+	void DrainRings();
+	void FoldFrame( int nFirst, int nCount, uint64 nFrameStart );
+	int FindOrAddChild( int nParent, uint16 nZone, int nThread );
+	void TrimCapture();
+
+	mutable CThreadFastMutex m_Mutex;
+	CUtlVector< Node_t > m_Nodes;
+	CUtlVector< int > m_ThreadRoots;
+	CUtlVector< int > m_TouchedNodes;
+	CUtlVector< PendingEvent_t > m_Pending;
+	CUtlVector< ZoneProfilerEvent_t > m_DrainScratch;
+	CUtlVector< uint64 > m_FrameMarks;		// ends of frames not folded yet, [0] is the start of the next one
+	uint32 m_nFrameRead;
+	int m_nFrames;
+	uint64 m_nLateZones;
+
+	struct CaptureFrame_t
+	{
+		uint64 m_nStart;
+		uint64 m_nEnd;
+		CUtlVector< PendingEvent_t > m_Events;
+	};
+
+	int m_nCaptureFrames;
+	CUtlVector< CaptureFrame_t > m_CaptureFrames;
+
+	ThreadHandle_t m_hThread;
+	std::atomic< bool > m_bRunning;
+	int m_nIntervalMs;
+};
+
+#endif // ZONEPROFILER_H
@@ -0,0 +1,223 @@
+// The hooks are compiled in per translation unit, so this one turns them on
+// whatever the build does. The element types are only used here, which keeps
+// the tracked container code apart from the untracked copies elsewhere.
+#ifndef SOURCESDK_ALLOC_TRACKER
+#define SOURCESDK_ALLOC_TRACKER
+#endif
+
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <tier0/utlbuffer.h>
+#include <tier1/alloctrackersnapshot.h>
+#include <tier1/utlleanvector.h>
+#include <tier1/utlvector.h>
+
+#include <string.h>
+
+struct AllocTrackerTestElem_t
+{
+	int m_nValues[4];
+};
+
+struct AllocTrackerTestLeanElem_t
+{
+	int64 m_nValue;
+};
+
+struct AllocTrackerTestThreadElem_t
+{
+	int m_nValue;
+};
+
+struct AllocTrackerTestFirstUseElem_t
+{
+	int m_nValue;
+};
+
+static bool BufferContains( CUtlBuffer &buf, const char *pszString )
+{
+	CUtlVector< char > text;
+	text.AddMultipleToTail( buf.TellPut(), ( const char * )buf.Base() );
+	text.AddToTail( '\0' );
+	return strstr( text.Base(), pszString ) != NULL;
+}
+
+REGISTER_NAMED_TEST( "alloctracker.TypeNames", alloctracker_TypeNames )
+{
+	TEST_EQ( V_strcmp( AllocTracker_GetName( AllocTracker_TypeToken< AllocTrackerTestElem_t >() ), "AllocTrackerTestElem_t" ), 0 );
+	TEST_EQ( V_strcmp( AllocTracker_GetName( AllocTracker_TypeToken< CUtlVector< int > >() ), "CUtlVector<int>" ), 0 );
+	TEST_EQ( AllocTracker_TypeToken< AllocTrackerTestElem_t >(), ( uint32 )CUtlStringToken( "AllocTrackerTestElem_t" ) );
+	TEST_NULL( AllocTracker_GetName( 0x12345678 ) );
+}
+
+REGISTER_NAMED_TEST( "alloctracker.SitesAndDiff", alloctracker_SitesAndDiff )
+{
+	const uint32 nElemType = AllocTracker_TypeToken< AllocTrackerTestElem_t >();
+	const uint32 nLeanType = AllocTracker_TypeToken< AllocTrackerTestLeanElem_t >();
+
+	CAllocTrackerSnapshot before;
+	before.Capture();
+
+	// Grown and purged inside one site: every realloc is a free and an alloc there
+	{
+		ALLOC_TRACKER_SITE( "alloctracker.test.balanced" );
+
+		CUtlVector< AllocTrackerTestElem_t > vec;
+		for ( int i = 0; i < 100; i++ )
+		{
+			vec.AddToTail();
+		}
+		vec.Purge();
+	}
+
+	// Left alive outside any site
+	CUtlVector< AllocTrackerTestElem_t > kept;
+	kept.EnsureCapacity( 10 );
+
+	CUtlLeanVector< AllocTrackerTestLeanElem_t > lean;
+	{
+		ALLOC_TRACKER_SITE( "alloctracker.test.lean" );
+		lean.EnsureCapacity( 8 );
+	}
+
+	CAllocTrackerSnapshot after;
+	after.Capture();
+
+	CAllocTrackerSnapshot diff;
+	CAllocTrackerSnapshot::Diff( before, after, diff );
+
+	const AllocTrackerEntry_t *pBalanced = diff.Find( nElemType, CUtlStringToken( "alloctracker.test.balanced" ) );
+	TEST_NOT_NULL( pBalanced );
+	TEST_TRUE( pBalanced->m_nAllocs > 1 );
+	TEST_EQ( pBalanced->m_nAllocs, pBalanced->m_nFrees );
+	TEST_EQ( pBalanced->m_nAllocBytes, pBalanced->m_nFreeBytes );
+	TEST_TRUE( pBalanced->m_nAllocBytes >= 100 * ( int64 )sizeof( AllocTrackerTestElem_t ) );
+
+	const AllocTrackerEntry_t *pKept = diff.Find( nElemType );
+	TEST_NOT_NULL( pKept );
+	TEST_EQ( pKept->LiveCount(), ( int64 )1 );
+	TEST_EQ( pKept->LiveBytes(), ( int64 )( kept.NumAllocated() * sizeof( AllocTrackerTestElem_t ) ) );
+
+	const AllocTrackerEntry_t *pLean = diff.Find( nLeanType, CUtlStringToken( "alloctracker.test.lean" ) );
+	TEST_NOT_NULL( pLean );
+	TEST_EQ( pLean->LiveCount(), ( int64 )1 );
+	TEST_EQ( pLean->LiveBytes(), ( int64 )( lean.NumAllocated() * sizeof( AllocTrackerTestLeanElem_t ) ) );
+
+	// Largest live first, and the dump names both the type and the site
+	diff.SortByLiveBytes();
+	for ( int i = 1; i < diff.Count(); i++ )
+	{
+		TEST_TRUE( diff[i - 1].LiveBytes() >= diff[i].LiveBytes() );
+	}
+
+	CUtlBuffer dump( 0, 0, CUtlBuffer::TEXT_BUFFER );
+	diff.Dump( dump );
+	TEST_TRUE( BufferContains( dump, "AllocTrackerTestLeanElem_t @ alloctracker.test.lean\n" ) );
+	TEST_TRUE( BufferContains( dump, "AllocTrackerTestElem_t @ -\n" ) );
+	TEST_TRUE( BufferContains( dump, "total\n" ) );
+
+	// Freed outside the site it was made in, the type comes back to zero
+	lean.Purge();
+	kept.Purge();
+
+	CAllocTrackerSnapshot purged;
+	purged.Capture();
+	CAllocTrackerSnapshot::Diff( before, purged, diff );
+
+	int64 nLeanLive = 0;
+	int64 nElemLive = 0;
+	for ( int i = 0; i < diff.Count(); i++ )
+	{
+		if ( diff[i].m_Type == nLeanType )
+			nLeanLive += diff[i].LiveBytes();
+		else if ( diff[i].m_Type == nElemType )
+			nElemLive += diff[i].LiveBytes();
+	}
+	TEST_EQ( nLeanLive, ( int64 )0 );
+	TEST_EQ( nElemLive, ( int64 )0 );
+	TEST_TRUE( diff.Find( nLeanType, CUtlStringToken( "alloctracker.test.lean" ) )->LiveBytes() > 0 );
+}
+
+static CUtlVector< AllocTrackerTestThreadElem_t > s_ThreadVectors[3];
+
+static uintp AllocTrackerWorkerFn( void *pParam )
+{
+	for ( int i = 0; i < ARRAYSIZE( s_ThreadVectors ); i++ )
+	{
+		s_ThreadVectors[i].EnsureCapacity( 4 );
+	}
+
+	AllocTracker_DetachThread();
+	return 0;
+}
+
+REGISTER_NAMED_TEST( "alloctracker.Threads", alloctracker_Threads )
+{
+	const uint32 nType = AllocTracker_TypeToken< AllocTrackerTestThreadElem_t >();
+
+	ThreadHandle_t hWorker = CreateSimpleThread( AllocTrackerWorkerFn, NULL );
+	ThreadJoin( hWorker );
+	ReleaseThreadHandle( hWorker );
+
+	CAllocTrackerSnapshot snapshot;
+	snapshot.Capture();
+
+	const AllocTrackerEntry_t *pEntry = snapshot.Find( nType );
+	TEST_NOT_NULL( pEntry );
+	TEST_EQ( pEntry->m_nAllocs, ( int64 )3 );
+	TEST_EQ( pEntry->m_nFrees, ( int64 )0 );
+
+	// Freed on this thread, summed with what the worker counted
+	for ( int i = 0; i < ARRAYSIZE( s_ThreadVectors ); i++ )
+	{
+		s_ThreadVectors[i].Purge();
+	}
+
+	snapshot.Capture();
+	pEntry = snapshot.Find( nType );
+	TEST_NOT_NULL( pEntry );
+	TEST_EQ( pEntry->m_nFrees, ( int64 )3 );
+	TEST_EQ( pEntry->LiveBytes(), ( int64 )0 );
+}
+
+static uintp AllocTrackerFirstUseFn( void *pParam )
+{
+	{
+		ALLOC_TRACKER_SITE( "alloctracker.test.firstuse" );
+
+		CUtlVector< AllocTrackerTestFirstUseElem_t > vec;
+		vec.EnsureCapacity( 4 );
+	}
+
+	AllocTracker_DetachThread();
+	return 0;
+}
+
+REGISTER_NAMED_TEST( "alloctracker.FirstUseThreads", alloctracker_FirstUseThreads )
+{
+	// Neither the type nor the site has been seen before the threads get to them together
+	ThreadHandle_t hWorkers[8];
+	for ( int i = 0; i < ARRAYSIZE( hWorkers ); i++ )
+	{
+		hWorkers[i] = CreateSimpleThread( AllocTrackerFirstUseFn, NULL );
+	}
+
+	for ( int i = 0; i < ARRAYSIZE( hWorkers ); i++ )
+	{
+		ThreadJoin( hWorkers[i] );
+		ReleaseThreadHandle( hWorkers[i] );
+	}
+
+	CAllocTrackerSnapshot snapshot;
+	snapshot.Capture();
+
+	const uint32 nType = AllocTracker_TypeToken< AllocTrackerTestFirstUseElem_t >();
+	TEST_EQ( nType, ( uint32 )CUtlStringToken( "AllocTrackerTestFirstUseElem_t" ) );
+	TEST_EQ( V_strcmp( AllocTracker_GetName( CUtlStringToken( "alloctracker.test.firstuse" ) ), "alloctracker.test.firstuse" ), 0 );
+
+	const AllocTrackerEntry_t *pEntry = snapshot.Find( nType, CUtlStringToken( "alloctracker.test.firstuse" ) );
+	TEST_NOT_NULL( pEntry );
+	TEST_EQ( pEntry->m_nAllocs, ( int64 )ARRAYSIZE( hWorkers ) );
+	TEST_EQ( pEntry->LiveBytes(), ( int64 )0 );
+}
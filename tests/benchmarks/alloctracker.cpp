@@ -0,0 +1,66 @@
+// On for this translation unit only, so the tracked rows below can be read against
+// the untracked CUtlVector rows of the utlvector benchmarks.
+#ifndef SOURCESDK_ALLOC_TRACKER
+#define SOURCESDK_ALLOC_TRACKER
+#endif
+
+#include "common/benchmark.h"
+
+#include <tier1/alloctrackersnapshot.h>
+#include <tier1/utlvector.h>
+
+struct AllocTrackerBenchmarkElem_t
+{
+	int m_nValue;
+};
+
+static void BenchmarkGrowAndPurge( BenchmarkState &state )
+{
+	CUtlVector< AllocTrackerBenchmarkElem_t > vec;
+
+	while ( state.KeepRunning() )
+	{
+		vec.EnsureCapacity( 64 );
+		BenchmarkDoNotOptimize( vec.Base() );
+		vec.Purge();
+	}
+
+	state.SetItemsProcessed( state.Iterations() );
+}
+
+REGISTER_NAMED_BENCHMARK( "AllocTracker/record alloc and free", AllocTracker_RecordAllocFree )
+{
+	const uint32 nType = AllocTracker_TypeToken< AllocTrackerBenchmarkElem_t >();
+
+	while ( state.KeepRunning() )
+	{
+		AllocTracker_RecordAlloc( nType, 64 );
+		AllocTracker_RecordFree( nType, 64 );
+	}
+
+	state.SetItemsProcessed( state.Iterations() );
+}
+
+REGISTER_NAMED_BENCHMARK( "AllocTracker/CUtlVector grow and purge", AllocTracker_GrowAndPurge )
+{
+	BenchmarkGrowAndPurge( state );
+}
+
+REGISTER_NAMED_BENCHMARK( "AllocTracker/CUtlVector grow and purge in a site", AllocTracker_GrowAndPurgeSite )
+{
+	ALLOC_TRACKER_SITE( "AllocTracker benchmark" );
+	BenchmarkGrowAndPurge( state );
+}
+
+REGISTER_NAMED_BENCHMARK( "AllocTracker/Capture", AllocTracker_Capture )
+{
+	CAllocTrackerSnapshot snapshot;
+
+	while ( state.KeepRunning() )
+	{
+		snapshot.Capture();
+		BenchmarkDoNotOptimize( snapshot.Count() );
+	}
+
+	state.SetItemsProcessed( state.Iterations() );
+}
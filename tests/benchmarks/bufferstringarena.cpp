@@ -0,0 +1,70 @@
+#include "common/benchmark.h"
+
+#include <tier0/bufferstring.h>
+#include <tier1/bufferstringarena.h>
+
+// One iteration is one call of something like ConVarRefAbstract::SetValueInternal
+// or a ToString: two values formatted and a line put together from them that's
+// longer than the inline bytes of any of the strings. The arena rows open a scope
+// per iteration, as the call would.
+
+template< typename T >
+static void FormatCall( int nIteration )
+{
+	T prev_str, new_str, line;
+
+	prev_str.Format( "%d %.3f %s", nIteration, nIteration * 0.25f, "models/characters/player/ct_sas/ct_sas_variant_a.vmdl" );
+	new_str.Format( "%d %.3f %s", nIteration + 1, nIteration * 0.5f, "models/characters/player/ct_sas/ct_sas_variant_b.vmdl" );
+
+	for ( int i = 0; i < 4; i++ )
+	{
+		line.AppendFormat( "[%d] \"%s\" -> \"%s\"; ", i, prev_str.Get(), new_str.Get() );
+	}
+
+	BenchmarkDoNotOptimize( line.Get() );
+}
+
+REGISTER_NAMED_BENCHMARK( "CBufferString/format", CBufferString_Format )
+{
+	int nIteration = 0;
+	while ( state.KeepRunning() )
+	{
+		FormatCall< CBufferString >( nIteration++ );
+	}
+
+	state.SetItemsProcessed( state.Iterations() );
+}
+
+REGISTER_NAMED_BENCHMARK( "CBufferStringN<256>/format", CBufferStringN256_Format )
+{
+	int nIteration = 0;
+	while ( state.KeepRunning() )
+	{
+		FormatCall< CBufferStringN< 256 > >( nIteration++ );
+	}
+
+	state.SetItemsProcessed( state.Iterations() );
+}
+
+REGISTER_NAMED_BENCHMARK( "CArenaBufferString/format, no scope", CArenaBufferString_FormatNoScope )
+{
+	int nIteration = 0;
+	while ( state.KeepRunning() )
+	{
+		FormatCall< CArenaBufferString >( nIteration++ );
+	}
+
+	state.SetItemsProcessed( state.Iterations() );
+}
+
+REGISTER_NAMED_BENCHMARK( "CArenaBufferString/format", CArenaBufferString_Format )
+{
+	int nIteration = 0;
+	while ( state.KeepRunning() )
+	{
+		CBufferStringArenaScope scope;
+		FormatCall< CArenaBufferString >( nIteration++ );
+	}
+
+	state.SetItemsProcessed( state.Iterations() );
+}
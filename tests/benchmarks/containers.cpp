@@ -0,0 +1,4 @@
+#include "common/benchmark.h"
+#include "benchmarks/containers.h"
+
+SOURCESDK_CONTAINER_BENCHMARKS( REGISTER_CONTAINER_BENCHMARKS )
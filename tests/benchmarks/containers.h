@@ -0,0 +1,418 @@
+#ifndef SOURCESDK_TESTS_BENCHMARKS_CONTAINERS_H
+#define SOURCESDK_TESTS_BENCHMARKS_CONTAINERS_H
+
+#include "common/benchmark.h"
+
+#include <tier0/platform.h>
+#include <tier0/utlsymbol.h>
+#include <tier1/keyvalues3.h>
+#include <tier1/utldict.h>
+#include <tier1/utlhash.h>
+#include <tier1/utlhashtable.h>
+#include <tier1/utlmap.h>
+#include <tier1/utlrbtree.h>
+#include <tier1/utlstringmap.h>
+#include <tier1/utlvector.h>
+
+#include <stdio.h>
+
+// Insert, find, iterate and erase for the keyed containers, all driven from the table
+// at the bottom with the same keys in the same order, so their rows compare directly.
+
+// Elements each benchmark iteration inserts, finds, visits or erases
+static const int s_nContainerBenchmarkSize = 1024;
+
+// Distinct keys in a fixed shuffled order, so trees and hashes don't see sorted runs
+inline const int *GetContainerBenchmarkKeys()
+{
+	static int s_nKeys[s_nContainerBenchmarkSize];
+	static bool s_bBuilt = false;
+	if ( !s_bBuilt )
+	{
+		for ( int i = 0; i < s_nContainerBenchmarkSize; i++ )
+		{
+			s_nKeys[i] = i * 16 + 3;
+		}
+
+		unsigned int nSeed = 0x5EED1234u;
+		for ( int i = s_nContainerBenchmarkSize - 1; i > 0; i-- )
+		{
+			nSeed = nSeed * 1664525u + 1013904223u;
+			const int j = ( int )( ( nSeed >> 8 ) % ( unsigned int )( i + 1 ) );
+			const int nKey = s_nKeys[i];
+			s_nKeys[i] = s_nKeys[j];
+			s_nKeys[j] = nKey;
+		}
+
+		s_bBuilt = true;
+	}
+
+	return s_nKeys;
+}
+
+// The keys as identifier-like strings, for the string keyed containers
+inline const char *GetContainerBenchmarkName( int nIndex )
+{
+	static char s_szNames[s_nContainerBenchmarkSize][32];
+	static bool s_bBuilt = false;
+	if ( !s_bBuilt )
+	{
+		const int *pKeys = GetContainerBenchmarkKeys();
+		for ( int i = 0; i < s_nContainerBenchmarkSize; i++ )
+		{
+			snprintf( s_szNames[i], sizeof( s_szNames[i] ), "m_entity_property_%d", pKeys[i] );
+		}
+
+		s_bBuilt = true;
+	}
+
+	return s_szNames[nIndex];
+}
+
+//-----------------------------------------------------------------------------
+// The four benchmarks, over a traits struct per container:
+//   Container_t                     default constructible
+//   s_nFinds                        keys Find looks up, spread evenly over all of them
+//   Clear( c ), Count( c )
+//   Insert( c, nKey, i )            i is the key's index, for its name and value
+//   Find( c, nKey, i ), Erase( c, nKey, i )
+//   Iterate( c )                    visits every element and returns a sum of them
+//-----------------------------------------------------------------------------
+template < typename Traits > void FillContainerBenchmark( typename Traits::Container_t &container )
+{
+	const int *pKeys = GetContainerBenchmarkKeys();
+	for ( int i = 0; i < s_nContainerBenchmarkSize; i++ )
+	{
+		Traits::Insert( container, pKeys[i], i );
+	}
+}
+
+template < typename Traits > void ContainerBenchmarkInsert( BenchmarkState &state )
+{
+	typename Traits::Container_t container;
+
+	while ( state.KeepRunning() )
+	{
+		Traits::Clear( container );
+		FillContainerBenchmark< Traits >( container );
+	}
+
+	BenchmarkDoNotOptimize( Traits::Count( container ) );
+	state.SetItemsProcessed( state.Iterations() * s_nContainerBenchmarkSize );
+}
+
+template < typename Traits > void ContainerBenchmarkFind( BenchmarkState &state )
+{
+	typename Traits::Container_t container;
+	FillContainerBenchmark< Traits >( container );
+
+	const int nStride = s_nContainerBenchmarkSize / Traits::s_nFinds;
+	const int *pKeys = GetContainerBenchmarkKeys();
+	while ( state.KeepRunning() )
+	{
+		int nFound = 0;
+		for ( int i = 0; i < s_nContainerBenchmarkSize; i += nStride )
+		{
+			nFound += Traits::Find( container, pKeys[i], i );
+		}
+
+		BenchmarkDoNotOptimize( nFound );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * Traits::s_nFinds );
+}
+
+template < typename Traits > void ContainerBenchmarkIterate( BenchmarkState &state )
+{
+	typename Traits::Container_t container;
+	FillContainerBenchmark< Traits >( container );
+
+	while ( state.KeepRunning() )
+	{
+		BenchmarkDoNotOptimize( Traits::Iterate( container ) );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nContainerBenchmarkSize );
+}
+
+template < typename Traits > void ContainerBenchmarkErase( BenchmarkState &state )
+{
+	typename Traits::Container_t container;
+
+	const int *pKeys = GetContainerBenchmarkKeys();
+	while ( state.KeepRunning() )
+	{
+		state.PauseTiming();
+		Traits::Clear( container );
+		FillContainerBenchmark< Traits >( container );
+		state.ResumeTiming();
+
+		for ( int i = 0; i < s_nContainerBenchmarkSize; i++ )
+		{
+			Traits::Erase( container, pKeys[i], i );
+		}
+	}
+
+	BenchmarkDoNotOptimize( Traits::Count( container ) );
+	state.SetItemsProcessed( state.Iterations() * s_nContainerBenchmarkSize );
+}
+
+//-----------------------------------------------------------------------------
+// Containers
+//-----------------------------------------------------------------------------
+
+// Find is a linear scan, so it looks up a handful of keys rather than all of them.
+// Erase takes from the front, swapping the last element in.
+struct CUtlVectorBenchmark
+{
+	using Container_t = CUtlVector< int >;
+	static const int s_nFinds = 64;
+
+	static void Clear( Container_t &vec ) { vec.RemoveAll(); }
+	static int Count( const Container_t &vec ) { return vec.Count(); }
+	static void Insert( Container_t &vec, int nKey, int i ) { vec.AddToTail( nKey ); }
+	static int Find( const Container_t &vec, int nKey, int i ) { return vec.Find( nKey ); }
+	static void Erase( Container_t &vec, int nKey, int i ) { vec.FastRemove( 0 ); }
+
+	static int Iterate( const Container_t &vec )
+	{
+		int nSum = 0;
+		FOR_EACH_VEC( vec, i )
+		{
+			nSum += vec[i];
+		}
+
+		return nSum;
+	}
+};
+
+inline bool CompareIntForBenchmark( const int &lhs, const int &rhs )
+{
+	return lhs == rhs;
+}
+
+// CUtlHash buckets by the low bits, which the keys all share, so mix them in from above
+inline unsigned int HashIntForBenchmark( const int &value )
+{
+	unsigned int nHash = ( unsigned int )value;
+	nHash ^= nHash >> 16;
+	nHash *= 0x45D9F3Bu;
+	nHash ^= nHash >> 16;
+	return nHash;
+}
+
+// A quarter as many buckets as keys, the chains CUtlHash is usually sized for
+class CBenchmarkHash : public CUtlHash< int, bool ( * )( const int &, const int & ), unsigned int ( * )( const int & ) >
+{
+public:
+	CBenchmarkHash() : CUtlHash( s_nContainerBenchmarkSize / 4, 0, 0, &CompareIntForBenchmark, &HashIntForBenchmark ) {}
+};
+
+struct CUtlHashBenchmark
+{
+	using Container_t = CBenchmarkHash;
+	static const int s_nFinds = s_nContainerBenchmarkSize;
+
+	static void Clear( Container_t &hash ) { hash.RemoveAll(); }
+	static int Count( Container_t &hash ) { return hash.Count(); }
+	static void Insert( Container_t &hash, int nKey, int i ) { hash.Insert( nKey ); }
+	static int Find( Container_t &hash, int nKey, int i ) { return ( int )hash.Find( nKey ); }
+	static void Erase( Container_t &hash, int nKey, int i ) { hash.Remove( hash.Find( nKey ) ); }
+
+	static int Iterate( Container_t &hash )
+	{
+		int nSum = 0;
+		for ( UtlHashHandle_t h = hash.GetFirstHandle(); h != hash.InvalidHandle(); h = hash.GetNextHandle( h ) )
+		{
+			nSum += hash[h];
+		}
+
+		return nSum;
+	}
+};
+
+struct CUtlHashtableBenchmark
+{
+	using Container_t = CUtlHashtable< int, int >;
+	static const int s_nFinds = s_nContainerBenchmarkSize;
+
+	static void Clear( Container_t &table ) { table.RemoveAll(); }
+	static int Count( const Container_t &table ) { return table.Count(); }
+	static void Insert( Container_t &table, int nKey, int i ) { table.Insert( nKey, i ); }
+	static int Find( const Container_t &table, int nKey, int i ) { return ( int )table.Find( nKey ); }
+	static void Erase( Container_t &table, int nKey, int i ) { table.Remove( nKey ); }
+
+	static int Iterate( const Container_t &table )
+	{
+		int nSum = 0;
+		for ( UtlHashHandle_t h = table.FirstHandle(); h != table.InvalidHandle(); h = table.NextHandle( h ) )
+		{
+			nSum += table.Element( h );
+		}
+
+		return nSum;
+	}
+};
+
+struct CUtlRBTreeBenchmark
+{
+	using Container_t = CUtlRBTree< int, CDefLess< int >, int >;
+	static const int s_nFinds = s_nContainerBenchmarkSize;
+
+	static void Clear( Container_t &tree ) { tree.RemoveAll(); }
+	static int Count( const Container_t &tree ) { return tree.Count(); }
+	static void Insert( Container_t &tree, int nKey, int i ) { tree.Insert( nKey ); }
+	static int Find( const Container_t &tree, int nKey, int i ) { return tree.Find( nKey ); }
+	static void Erase( Container_t &tree, int nKey, int i ) { tree.Remove( nKey ); }
+
+	static int Iterate( const Container_t &tree )
+	{
+		int nSum = 0;
+		for ( int i = tree.FirstInorder(); i != tree.InvalidIndex(); i = tree.NextInorder( i ) )
+		{
+			nSum += tree[i];
+		}
+
+		return nSum;
+	}
+};
+
+struct CUtlMapBenchmark
+{
+	using Container_t = CUtlMap< int, int >;
+	static const int s_nFinds = s_nContainerBenchmarkSize;
+
+	static void Clear( Container_t &map ) { map.RemoveAll(); }
+	static int Count( const Container_t &map ) { return map.Count(); }
+	static void Insert( Container_t &map, int nKey, int i ) { map.Insert( nKey, i ); }
+	static int Find( const Container_t &map, int nKey, int i ) { return map.Find( nKey ); }
+	static void Erase( Container_t &map, int nKey, int i ) { map.Remove( nKey ); }
+
+	static int Iterate( const Container_t &map )
+	{
+		int nSum = 0;
+		FOR_EACH_MAP( map, i )
+		{
+			nSum += map.Key( i ) + map[i];
+		}
+
+		return nSum;
+	}
+};
+
+// The dictionary copies its names on insert and frees them on erase, so both rows include that
+struct CUtlDictBenchmark
+{
+	using Container_t = CUtlDict< int >;
+	static const int s_nFinds = s_nContainerBenchmarkSize;
+
+	static void Clear( Container_t &dict ) { dict.RemoveAll(); }
+	static int Count( const Container_t &dict ) { return dict.Count(); }
+	static void Insert( Container_t &dict, int nKey, int i ) { dict.Insert( GetContainerBenchmarkName( i ), i ); }
+	static int Find( const Container_t &dict, int nKey, int i ) { return dict.Find( GetContainerBenchmarkName( i ) ); }
+	static void Erase( Container_t &dict, int nKey, int i ) { dict.Remove( GetContainerBenchmarkName( i ) ); }
+
+	static int Iterate( const Container_t &dict )
+	{
+		int nSum = 0;
+		FOR_EACH_DICT( dict, i )
+		{
+			nSum += dict[i] + dict.GetElementName( i )[0];
+		}
+
+		return nSum;
+	}
+};
+
+// Removed symbols keep their ids, so the table is cleared before it is filled again
+struct CUtlSymbolTableBenchmark
+{
+	using Container_t = CUtlSymbolTable;
+	static const int s_nFinds = s_nContainerBenchmarkSize;
+
+	static void Clear( Container_t &table ) { table.RemoveAll(); }
+	static int Count( const Container_t &table ) { return table.GetNumStrings(); }
+	static void Insert( Container_t &table, int nKey, int i ) { table.AddString( GetContainerBenchmarkName( i ) ); }
+	static int Find( const Container_t &table, int nKey, int i ) { return ( int )table.Find( GetContainerBenchmarkName( i ) ).GetId(); }
+	static void Erase( Container_t &table, int nKey, int i ) { table.Remove( table.Find( GetContainerBenchmarkName( i ) ) ); }
+
+	static int Iterate( const Container_t &table )
+	{
+		int nSum = 0;
+		FOR_EACH_SYMBOL( table, i )
+		{
+			nSum += table.String( i )[0];
+		}
+
+		return nSum;
+	}
+};
+
+struct CUtlStringMapBenchmark
+{
+	using Container_t = CUtlStringMap< int >;
+	static const int s_nFinds = s_nContainerBenchmarkSize;
+
+	static void Clear( Container_t &map ) { map.Clear(); }
+	static int Count( const Container_t &map ) { return map.GetNumStrings(); }
+	static void Insert( Container_t &map, int nKey, int i ) { map.Insert( GetContainerBenchmarkName( i ), i ); }
+	static int Find( Container_t &map, int nKey, int i ) { return map[map.Find( GetContainerBenchmarkName( i ) ).GetId()]; }
+	static void Erase( Container_t &map, int nKey, int i ) { map.FindAndRemove( GetContainerBenchmarkName( i ) ); }
+
+	static int Iterate( Container_t &map )
+	{
+		int nSum = 0;
+		for ( CUtlSymbol i = map.Head(); i.IsValid(); i = map.Next( i ) )
+		{
+			nSum += map[i.GetId()];
+		}
+
+		return nSum;
+	}
+};
+
+// A table of int members, the shape entity and schema data mostly has
+struct KeyValues3Benchmark
+{
+	using Container_t = KeyValues3;
+	static const int s_nFinds = s_nContainerBenchmarkSize;
+
+	static void Clear( Container_t &kv ) { kv.SetToNull(); }
+	static int Count( const Container_t &kv ) { return kv.GetMemberCount(); }
+	static void Insert( Container_t &kv, int nKey, int i ) { kv.SetMemberInt( CKV3MemberName::Make( GetContainerBenchmarkName( i ) ), i ); }
+	static int Find( const Container_t &kv, int nKey, int i ) { return kv.GetMemberInt( CKV3MemberName::Make( GetContainerBenchmarkName( i ) ) ); }
+	static void Erase( Container_t &kv, int nKey, int i ) { kv.RemoveMember( CKV3MemberName::Make( GetContainerBenchmarkName( i ) ) ); }
+
+	static int Iterate( const Container_t &kv )
+	{
+		int nSum = 0;
+		FOR_EACH_KV3_TABLE( kv, i )
+		{
+			nSum += kv.GetMember( i )->GetInt() + kv.GetMemberName( i )[0];
+		}
+
+		return nSum;
+	}
+};
+
+//-----------------------------------------------------------------------------
+// The table: name the rows are reported under, traits
+//-----------------------------------------------------------------------------
+#define SOURCESDK_CONTAINER_BENCHMARKS( X ) \
+	X( "CUtlVector", CUtlVectorBenchmark ) \
+	X( "CUtlHash", CUtlHashBenchmark ) \
+	X( "CUtlHashtable", CUtlHashtableBenchmark ) \
+	X( "CUtlRBTree", CUtlRBTreeBenchmark ) \
+	X( "CUtlMap", CUtlMapBenchmark ) \
+	X( "CUtlDict", CUtlDictBenchmark ) \
+	X( "CUtlSymbolTable", CUtlSymbolTableBenchmark ) \
+	X( "CUtlStringMap", CUtlStringMapBenchmark ) \
+	X( "KeyValues3", KeyValues3Benchmark )
+
+#define REGISTER_CONTAINER_BENCHMARKS( container_name, traits ) \
+	static BenchmarkRegistration traits##_Insert_registration( container_name "/Insert", &ContainerBenchmarkInsert< traits > ); \
+	static BenchmarkRegistration traits##_Find_registration( container_name "/Find", &ContainerBenchmarkFind< traits > ); \
+	static BenchmarkRegistration traits##_Iterate_registration( container_name "/Iterate", &ContainerBenchmarkIterate< traits > ); \
+	static BenchmarkRegistration traits##_Erase_registration( container_name "/Erase", &ContainerBenchmarkErase< traits > );
+
+#endif // SOURCESDK_TESTS_BENCHMARKS_CONTAINERS_H
@@ -0,0 +1,103 @@
+#include "common/benchmark.h"
+
+#include <tier0/characterset.h>
+#include <tier0/utlbuffer.h>
+#include <tier1/convar.h>
+
+#include <string.h>
+
+// What a server tokenizes all day: short client commands, chat lines and RCON commands
+// with quoted values. ParseToken is the loop CCommand::Tokenize ran before, copy included.
+
+static const char *s_pBenchmarkCommands[] =
+{
+	"+attack",
+	"jointeam 3 0",
+	"say \"gg wp, that was a close round - rematch?\"",
+	"buy ak47; buy vesthelm; buy smokegrenade",
+	"sv_cheats 1",
+	"rcon_password \"hunter2\"",
+	"exec server_competitive_config_with_a_long_name.cfg // reload",
+	"mp_warmup_end",
+	"bot_add_ct expert \"Some Bot Name\"",
+	"setpos 1234.500000 -567.250000 128.031250;setang 0.000000 90.000000 0.000000",
+};
+
+static characterset_t *GetBenchmarkBreakSet()
+{
+	static characterset_t s_BreakSet;
+	static bool s_bBuilt = false;
+	if ( !s_bBuilt )
+	{
+		CharacterSetBuild( &s_BreakSet, "{}()':" );
+		s_bBuilt = true;
+	}
+
+	return &s_BreakSet;
+}
+
+static int GetBenchmarkCommandBytes()
+{
+	int nBytes = 0;
+	for ( int i = 0; i < ARRAYSIZE( s_pBenchmarkCommands ); i++ )
+	{
+		nBytes += V_strlen( s_pBenchmarkCommands[i] );
+	}
+
+	return nBytes;
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlBuffer::ParseToken/commands", CUtlBuffer_ParseToken_Commands )
+{
+	const characterset_t *pBreakSet = GetBenchmarkBreakSet();
+	char szCommand[512];
+	char szArgv[512];
+
+	while ( state.KeepRunning() )
+	{
+		int nArgs = 0;
+		for ( int i = 0; i < ARRAYSIZE( s_pBenchmarkCommands ); i++ )
+		{
+			int nLen = V_strlen( s_pBenchmarkCommands[i] );
+			memcpy( szCommand, s_pBenchmarkCommands[i], nLen + 1 );
+
+			CUtlBuffer bufParse( szCommand, nLen, static_cast< CUtlBuffer::BufferFlags_t >( CUtlBuffer::TEXT_BUFFER | CUtlBuffer::READ_ONLY ) );
+			int nArgvBufferSize = 0;
+			while ( bufParse.IsValid() )
+			{
+				int nSize = bufParse.ParseToken( pBreakSet, szArgv + nArgvBufferSize, sizeof( szArgv ) - nArgvBufferSize, true );
+				if ( nSize < 0 )
+					break;
+
+				nArgvBufferSize += nSize + 1;
+				nArgs++;
+			}
+		}
+
+		BenchmarkDoNotOptimize( nArgs );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * ARRAYSIZE( s_pBenchmarkCommands ) );
+	state.SetBytesProcessed( state.Iterations() * GetBenchmarkCommandBytes() );
+}
+
+REGISTER_NAMED_BENCHMARK( "CCommand::Tokenize/commands", CCommand_Tokenize_Commands )
+{
+	const characterset_t *pBreakSet = GetBenchmarkBreakSet();
+	CCommand command;
+
+	while ( state.KeepRunning() )
+	{
+		int nArgs = 0;
+		for ( int i = 0; i < ARRAYSIZE( s_pBenchmarkCommands ); i++ )
+		{
+			command.Tokenize( s_pBenchmarkCommands[i], pBreakSet );
+			nArgs += command.ArgC();
+		}
+
+		BenchmarkDoNotOptimize( nArgs );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * ARRAYSIZE( s_pBenchmarkCommands ) );
+	state.SetBytesProcessed( state.Iterations() * GetBenchmarkCommandBytes() );
+}
@@ -0,0 +1,204 @@
+#include "common/benchmark.h"
+
+#include <tier1/generichash.h>
+
+#include <string.h>
+
+static uint8 *GetHashBenchmarkInput()
+{
+	static uint8 s_Input[4096];
+	static bool s_bInitialized = false;
+
+	if ( !s_bInitialized )
+	{
+		for ( int i = 0; i < ( int )sizeof( s_Input ); i++ )
+		{
+			s_Input[i] = ( uint8 )( 'A' + ( i * 7 ) % 58 );
+		}
+
+		s_bInitialized = true;
+	}
+
+	return s_Input;
+}
+
+// Each iteration hashes a different (overlapping) window so that the keys are not loop-invariant
+template < typename HashFunction >
+static void RunHashBenchmark( BenchmarkState &state, int nLength, HashFunction hashFunction )
+{
+	const uint8 *pInput = GetHashBenchmarkInput();
+	const int nWindow = ( int )( 4096 - nLength ) + 1;
+	int nOffset = 0;
+
+	while ( state.KeepRunning() )
+	{
+		BenchmarkDoNotOptimize( hashFunction( pInput + nOffset, nLength ) );
+
+		if ( ++nOffset >= nWindow || nOffset >= 64 )
+			nOffset = 0;
+	}
+
+	state.SetBytesProcessed( state.Iterations() * nLength );
+}
+
+#define HASH_BENCHMARKS_FOR_LENGTH( length ) \
+	REGISTER_NAMED_BENCHMARK( "MurmurHash2/" #length, MurmurHash2_##length ) \
+	{ \
+		RunHashBenchmark( state, length, []( const uint8 *p, int n ) { return MurmurHash2( p, n, 0x31415926 ); } ); \
+	} \
+	REGISTER_NAMED_BENCHMARK( "MurmurHash2LowerCase/" #length, MurmurHash2LowerCase_##length ) \
+	{ \
+		RunHashBenchmark( state, length, []( const uint8 *p, int n ) { return MurmurHash2LowerCase( ( const char * )p, n, 0x31415926 ); } ); \
+	} \
+	REGISTER_NAMED_BENCHMARK( "MurmurHash64/" #length, MurmurHash64_##length ) \
+	{ \
+		RunHashBenchmark( state, length, []( const uint8 *p, int n ) { return MurmurHash64( p, n, 0x31415926 ); } ); \
+	} \
+	REGISTER_NAMED_BENCHMARK( "HashBlock/" #length, HashBlock_##length ) \
+	{ \
+		RunHashBenchmark( state, length, []( const uint8 *p, int n ) { return HashBlock( p, n ); } ); \
+	} \
+	REGISTER_NAMED_BENCHMARK( "FastHash64/" #length, FastHash64_##length ) \
+	{ \
+		RunHashBenchmark( state, length, []( const uint8 *p, int n ) { return FastHash64( p, n ); } ); \
+	} \
+	REGISTER_NAMED_BENCHMARK( "FastHash64Caseless/" #length, FastHash64Caseless_##length ) \
+	{ \
+		RunHashBenchmark( state, length, []( const uint8 *p, int n ) { return FastHash64Caseless( p, n ); } ); \
+	} \
+	REGISTER_NAMED_BENCHMARK( "FastHash128/" #length, FastHash128_##length ) \
+	{ \
+		RunHashBenchmark( state, length, []( const uint8 *p, int n ) { return FastHash128( p, n ).m_nLow; } ); \
+	}
+
+HASH_BENCHMARKS_FOR_LENGTH( 8 )
+HASH_BENCHMARKS_FOR_LENGTH( 16 )
+HASH_BENCHMARKS_FOR_LENGTH( 32 )
+HASH_BENCHMARKS_FOR_LENGTH( 64 )
+HASH_BENCHMARKS_FOR_LENGTH( 4096 )
+
+REGISTER_NAMED_BENCHMARK( "CFastHashState/4096x16", CFastHashState_4096x16 )
+{
+	// Streaming throughput with a chunk size that does not line up with stripes
+	const uint8 *pInput = GetHashBenchmarkInput();
+
+	while ( state.KeepRunning() )
+	{
+		CFastHashState hashState;
+
+		for ( int nOffset = 0; nOffset < 4096; nOffset += 256 )
+		{
+			hashState.Update( pInput + nOffset, 256 );
+		}
+
+		BenchmarkDoNotOptimize( hashState.Digest64() );
+	}
+
+	state.SetBytesProcessed( state.Iterations() * 4096 );
+}
+
+// Field and keyvalue names: 1024 of them, 4 to 27 bytes long, in mixed case
+static const int k_nKeyBenchmarkCount = 1024;
+
+struct KeyBenchmarkKeys_t
+{
+	const char *m_pKeys[k_nKeyBenchmarkCount];
+	int m_nLengths[k_nKeyBenchmarkCount];
+	int m_nTotalLength;
+};
+
+static const KeyBenchmarkKeys_t &GetKeyBenchmarkKeys()
+{
+	static KeyBenchmarkKeys_t s_Keys;
+	static char s_Names[k_nKeyBenchmarkCount][32];
+
+	if ( !s_Keys.m_nTotalLength )
+	{
+		const char *pInput = ( const char * )GetHashBenchmarkInput();
+		uint32 nState = 1;
+
+		for ( int i = 0; i < k_nKeyBenchmarkCount; i++ )
+		{
+			nState = nState * 1664525 + 1013904223;
+			int nLength = 4 + ( nState >> 24 ) % 24;
+
+			memcpy( s_Names[i], "m_", 2 );
+			memcpy( s_Names[i] + 2, pInput + ( nState >> 8 ) % 2048, nLength - 2 );
+			s_Names[i][nLength] = 0;
+
+			s_Keys.m_pKeys[i] = s_Names[i];
+			s_Keys.m_nLengths[i] = nLength;
+			s_Keys.m_nTotalLength += nLength;
+		}
+	}
+
+	return s_Keys;
+}
+
+// The lowered copy MurmurHash2LowerCase used to hash, for the baseline row
+static uint32 MurmurHash2LowerCaseCopy( const char *pString, int nLength, uint32 nSeed )
+{
+	char *p = ( char * )stackalloc( nLength + 1 );
+	for ( int i = 0; i < nLength; i++ )
+	{
+		p[i] = TOLOWERU( pString[i] );
+	}
+
+	return MurmurHash2( p, nLength, nSeed );
+}
+
+template < typename HashFunction >
+static void RunKeyHashBenchmark( BenchmarkState &state, HashFunction hashFunction )
+{
+	const KeyBenchmarkKeys_t &keys = GetKeyBenchmarkKeys();
+	static uint32 s_nHashes[k_nKeyBenchmarkCount];
+
+	while ( state.KeepRunning() )
+	{
+		for ( int i = 0; i < k_nKeyBenchmarkCount; i++ )
+		{
+			s_nHashes[i] = hashFunction( keys.m_pKeys[i], keys.m_nLengths[i] );
+		}
+
+		BenchmarkDoNotOptimize( s_nHashes );
+	}
+
+	state.SetBytesProcessed( state.Iterations() * keys.m_nTotalLength );
+}
+
+static void RunKeyHashBatchBenchmark( BenchmarkState &state, int nLevel )
+{
+	const KeyBenchmarkKeys_t &keys = GetKeyBenchmarkKeys();
+	static uint32 s_nHashes[k_nKeyBenchmarkCount];
+	MurmurHash2SetSIMDLevel( nLevel );
+
+	while ( state.KeepRunning() )
+	{
+		MurmurHash2LowerCaseBatch( keys.m_pKeys, keys.m_nLengths, k_nKeyBenchmarkCount, 0x31415926, s_nHashes );
+		BenchmarkDoNotOptimize( s_nHashes );
+	}
+
+	state.SetBytesProcessed( state.Iterations() * keys.m_nTotalLength );
+	MurmurHash2SetSIMDLevel( 2 );
+}
+
+REGISTER_NAMED_BENCHMARK( "MurmurHash2LowerCase/1024 keys/copy", MurmurHash2LowerCase_Keys_Copy )
+{
+	RunKeyHashBenchmark( state, []( const char *p, int n ) { return MurmurHash2LowerCaseCopy( p, n, 0x31415926 ); } );
+}
+
+REGISTER_NAMED_BENCHMARK( "MurmurHash2LowerCase/1024 keys/fused", MurmurHash2LowerCase_Keys_Fused )
+{
+	RunKeyHashBenchmark( state, []( const char *p, int n ) { return MurmurHash2LowerCase( p, n, 0x31415926 ); } );
+}
+
+// Without AVX2 the second row falls back to the first
+REGISTER_NAMED_BENCHMARK( "MurmurHash2LowerCaseBatch/1024 keys/scalar", MurmurHash2LowerCaseBatch_Keys_Scalar )
+{
+	RunKeyHashBatchBenchmark( state, 0 );
+}
+
+REGISTER_NAMED_BENCHMARK( "MurmurHash2LowerCaseBatch/1024 keys/AVX2", MurmurHash2LowerCaseBatch_Keys_AVX2 )
+{
+	RunKeyHashBatchBenchmark( state, 2 );
+}
@@ -0,0 +1,187 @@
+#include "common/benchmark.h"
+
+#include <mstristrip.h>
+#include <tier1/utlvector.h>
+
+#include <math.h>
+
+// WORD indices cap a mesh at 64k vertices, so the 1M triangles are 8 meshes of 255 x 255
+// quads (65536 vertices, 130050 triangles each), every one shuffled into random order as
+// an exporter that doesn't care would leave them. Stripify is quadratic in the triangle
+// count, so it gets compared on small meshes only.
+
+static const int s_nBenchmarkMeshes = 8;
+static const int s_nBenchmarkMeshSize = 255;
+static const int s_nBenchmarkSmallMeshSize = 32;
+
+struct BenchmarkMesh_t
+{
+	CUtlVector< WORD > m_Indices;
+	CUtlVector< float > m_Positions;
+};
+
+static void BuildBenchmarkMesh( BenchmarkMesh_t &mesh, int nSize, uint32 nSeed )
+{
+	const int nVertsPerRow = nSize + 1;
+
+	// A bumpy sphere-ish sheet, so the clusters face all sorts of ways
+	mesh.m_Positions.SetCount( nVertsPerRow * nVertsPerRow * 3 );
+	for ( int y = 0; y < nVertsPerRow; y++ )
+	{
+		for ( int x = 0; x < nVertsPerRow; x++ )
+		{
+			float flTheta = x * 6.2831853f / nSize;
+			float flPhi = y * 3.1415926f / nSize;
+			float flRadius = 1.0f + 0.1f * sinf( flTheta * 7.0f ) * sinf( flPhi * 5.0f );
+			float *pPosition = &mesh.m_Positions[( y * nVertsPerRow + x ) * 3];
+			pPosition[0] = flRadius * sinf( flPhi ) * cosf( flTheta );
+			pPosition[1] = flRadius * sinf( flPhi ) * sinf( flTheta );
+			pPosition[2] = flRadius * cosf( flPhi );
+		}
+	}
+
+	mesh.m_Indices.SetCount( nSize * nSize * 6 );
+	for ( int y = 0; y < nSize; y++ )
+	{
+		for ( int x = 0; x < nSize; x++ )
+		{
+			WORD *pQuad = &mesh.m_Indices[( y * nSize + x ) * 6];
+			int nCorner = y * nVertsPerRow + x;
+			pQuad[0] = nCorner;
+			pQuad[1] = nCorner + 1;
+			pQuad[2] = nCorner + nVertsPerRow;
+			pQuad[3] = nCorner + 1;
+			pQuad[4] = nCorner + nVertsPerRow + 1;
+			pQuad[5] = nCorner + nVertsPerRow;
+		}
+	}
+
+	int nNumTris = mesh.m_Indices.Count() / 3;
+	for ( int i = nNumTris - 1; i > 0; i-- )
+	{
+		nSeed = nSeed * 1664525 + 1013904223;
+		int j = ( nSeed >> 8 ) % ( i + 1 );
+		for ( int k = 0; k < 3; k++ )
+		{
+			WORD nTemp = mesh.m_Indices[i * 3 + k];
+			mesh.m_Indices[i * 3 + k] = mesh.m_Indices[j * 3 + k];
+			mesh.m_Indices[j * 3 + k] = nTemp;
+		}
+	}
+}
+
+static BenchmarkMesh_t *GetBenchmarkMeshes( int nSize )
+{
+	static BenchmarkMesh_t s_LargeMeshes[s_nBenchmarkMeshes];
+	static BenchmarkMesh_t s_SmallMeshes[s_nBenchmarkMeshes];
+
+	BenchmarkMesh_t *pMeshes = ( nSize == s_nBenchmarkMeshSize ) ? s_LargeMeshes : s_SmallMeshes;
+	if ( !pMeshes[0].m_Indices.Count() )
+	{
+		for ( int i = 0; i < s_nBenchmarkMeshes; i++ )
+		{
+			BuildBenchmarkMesh( pMeshes[i], nSize, 12345 + i );
+		}
+	}
+
+	return pMeshes;
+}
+
+static void BenchmarkOptimizeVertexCache( BenchmarkState &state, int nSize, bool bOverdraw )
+{
+	BenchmarkMesh_t *pMeshes = GetBenchmarkMeshes( nSize );
+	long long nTriangles = 0;
+
+	while ( state.KeepRunning() )
+	{
+		for ( int i = 0; i < s_nBenchmarkMeshes; i++ )
+		{
+			int nNumIndices = 0;
+			WORD *pIndices = NULL;
+			OptimizeVertexCache( pMeshes[i].m_Indices.Count() / 3, pMeshes[i].m_Indices.Base(), &nNumIndices, &pIndices,
+				bOverdraw ? pMeshes[i].m_Positions.Base() : NULL );
+
+			BenchmarkDoNotOptimize( pIndices[0] );
+			delete [] pIndices;
+			nTriangles += nNumIndices / 3;
+		}
+	}
+
+	state.SetItemsProcessed( nTriangles );
+}
+
+static void BenchmarkOptimizeVertexCacheBatch( BenchmarkState &state, int nThreads )
+{
+	BenchmarkMesh_t *pMeshes = GetBenchmarkMeshes( s_nBenchmarkMeshSize );
+	VERTEXCACHEMESH meshes[s_nBenchmarkMeshes];
+	long long nTriangles = 0;
+
+	while ( state.KeepRunning() )
+	{
+		for ( int i = 0; i < s_nBenchmarkMeshes; i++ )
+		{
+			meshes[i].numtris = pMeshes[i].m_Indices.Count() / 3;
+			meshes[i].ptriangles = pMeshes[i].m_Indices.Base();
+			meshes[i].pvertexpositions = pMeshes[i].m_Positions.Base();
+			meshes[i].vertexstride = 0;
+		}
+
+		OptimizeVertexCacheBatch( s_nBenchmarkMeshes, meshes, nThreads );
+
+		for ( int i = 0; i < s_nBenchmarkMeshes; i++ )
+		{
+			BenchmarkDoNotOptimize( meshes[i].pindices[0] );
+			delete [] meshes[i].pindices;
+			nTriangles += meshes[i].numtris;
+		}
+	}
+
+	state.SetItemsProcessed( nTriangles );
+}
+
+REGISTER_NAMED_BENCHMARK( "Stripify/8 x 2048 triangles", Stripify_Small )
+{
+	BenchmarkMesh_t *pMeshes = GetBenchmarkMeshes( s_nBenchmarkSmallMeshSize );
+	long long nTriangles = 0;
+
+	while ( state.KeepRunning() )
+	{
+		for ( int i = 0; i < s_nBenchmarkMeshes; i++ )
+		{
+			int nNumIndices = 0;
+			WORD *pIndices = NULL;
+			Stripify( pMeshes[i].m_Indices.Count() / 3, pMeshes[i].m_Indices.Base(), &nNumIndices, &pIndices );
+
+			BenchmarkDoNotOptimize( pIndices[0] );
+			delete [] pIndices;
+			nTriangles += pMeshes[i].m_Indices.Count() / 3;
+		}
+	}
+
+	state.SetItemsProcessed( nTriangles );
+}
+
+REGISTER_NAMED_BENCHMARK( "OptimizeVertexCache/8 x 2048 triangles", OptimizeVertexCache_Small )
+{
+	BenchmarkOptimizeVertexCache( state, s_nBenchmarkSmallMeshSize, false );
+}
+
+REGISTER_NAMED_BENCHMARK( "OptimizeVertexCache/1M triangles", OptimizeVertexCache_1M )
+{
+	BenchmarkOptimizeVertexCache( state, s_nBenchmarkMeshSize, false );
+}
+
+REGISTER_NAMED_BENCHMARK( "OptimizeVertexCache/1M triangles/overdraw", OptimizeVertexCache_1M_Overdraw )
+{
+	BenchmarkOptimizeVertexCache( state, s_nBenchmarkMeshSize, true );
+}
+
+REGISTER_NAMED_BENCHMARK( "OptimizeVertexCacheBatch/1M triangles/overdraw/1 thread", OptimizeVertexCacheBatch_1M_1 )
+{
+	BenchmarkOptimizeVertexCacheBatch( state, 1 );
+}
+
+REGISTER_NAMED_BENCHMARK( "OptimizeVertexCacheBatch/1M triangles/overdraw/4 threads", OptimizeVertexCacheBatch_1M_4 )
+{
+	BenchmarkOptimizeVertexCacheBatch( state, 4 );
+}
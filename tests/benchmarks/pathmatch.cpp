@@ -0,0 +1,140 @@
+#include "common/benchmark.h"
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+// tier1/pathmatch.cpp has no header, these match its definitions
+enum PathMod_t
+{
+	kPathUnchanged,
+	kPathLowered,
+	kPathChanged,
+	kPathFailed,
+};
+
+PathMod_t pathmatch( const char *pszIn, char **ppszOut, bool bAllowBasenameMismatch, char *pszOutBuf, size_t OutBufLen );
+
+static const int s_nPathmatchDirs = 16;
+static const int s_nPathmatchSubDirs = 8;
+static const int s_nPathmatchFiles = 64;
+static const int s_nPathmatchQueries = 100000;
+
+// A mixed-case tree in the working directory plus queries that only match it
+// case-insensitively. Built before any benchmark runs so the setup stays out of the
+// measurements, and left in place for the next run (benchmarks exit without teardown).
+class CPathmatchTree
+{
+public:
+	CPathmatchTree()
+	{
+		char szRoot[448];
+
+		if ( !getcwd( szRoot, sizeof( szRoot ) - 32 ) )
+			return;
+
+		strcat( szRoot, "/pathmatch_benchmark_tree" );
+		mkdir( szRoot, 0755 );
+
+		m_sRoot = szRoot;
+
+		char szPath[512];
+
+		for ( int nDir = 0; nDir < s_nPathmatchDirs; nDir++ )
+		{
+			snprintf( szPath, sizeof( szPath ), "%s/Materials%02d", szRoot, nDir );
+			mkdir( szPath, 0755 );
+
+			for ( int nSubDir = 0; nSubDir < s_nPathmatchSubDirs; nSubDir++ )
+			{
+				snprintf( szPath, sizeof( szPath ), "%s/Materials%02d/Models_%d", szRoot, nDir, nSubDir );
+				mkdir( szPath, 0755 );
+
+				for ( int nFile = 0; nFile < s_nPathmatchFiles; nFile++ )
+				{
+					snprintf( szPath, sizeof( szPath ), "%s/Materials%02d/Models_%d/Prop_%03d.VMat_c", szRoot, nDir, nSubDir, nFile );
+					close( open( szPath, O_CREAT | O_WRONLY, 0644 ) );
+				}
+
+				BackdateDirectory( "%s/Materials%02d/Models_%d", nDir, nSubDir );
+			}
+
+			BackdateDirectory( "%s/Materials%02d", nDir, 0 );
+		}
+
+		BackdateDirectory( "%s", 0, 0 );
+
+		uint32_t nState = 0x2545f491;
+
+		m_Queries.reserve( s_nPathmatchQueries );
+
+		for ( int i = 0; i < s_nPathmatchQueries; i++ )
+		{
+			nState = nState * 1664525 + 1013904223;
+
+			snprintf( szPath, sizeof( szPath ), "%s/Materials%02d/Models_%d/Prop_%03d.VMat_c", szRoot,
+			          ( int )( ( nState >> 8 ) % s_nPathmatchDirs ),
+			          ( int )( ( nState >> 16 ) % s_nPathmatchSubDirs ),
+			          ( int )( ( nState >> 20 ) % s_nPathmatchFiles ) );
+
+			// Flip the case of letters below the root so neither the path nor its lowered form exists
+			for ( char *p = szPath + m_sRoot.length(); *p; p++ )
+			{
+				nState = nState * 1664525 + 1013904223;
+
+				if ( ( ( *p >= 'a' && *p <= 'z' ) || ( *p >= 'A' && *p <= 'Z' ) ) && ( nState & 0x10000 ) )
+					*p ^= 0x20;
+			}
+
+			m_Queries.push_back( szPath );
+		}
+	}
+
+	// Directories older than pathmatch's racy window are the steady state on a server
+	void BackdateDirectory( const char *pszFormat, int nDir, int nSubDir )
+	{
+		char szPath[512];
+		snprintf( szPath, sizeof( szPath ), pszFormat, m_sRoot.c_str(), nDir, nSubDir );
+
+		struct timespec times[2];
+		times[0].tv_sec = times[1].tv_sec = 1000000000;
+		times[0].tv_nsec = times[1].tv_nsec = 0;
+		utimensat( AT_FDCWD, szPath, times, 0 );
+	}
+
+	std::string m_sRoot;
+	std::vector< std::string > m_Queries;
+};
+
+static CPathmatchTree s_PathmatchTree;
+
+REGISTER_NAMED_BENCHMARK( "pathmatch/MixedCase100k", pathmatch_MixedCase100k )
+{
+	char szBuffer[512];
+	long long nResolved = 0;
+
+	while ( state.KeepRunning() )
+	{
+		for ( size_t i = 0; i < s_PathmatchTree.m_Queries.size(); i++ )
+		{
+			char *pszOut = NULL;
+			PathMod_t eResult = pathmatch( s_PathmatchTree.m_Queries[i].c_str(), &pszOut, false, szBuffer, sizeof( szBuffer ) );
+
+			if ( eResult == kPathChanged )
+				nResolved++;
+
+			if ( pszOut && pszOut != szBuffer )
+				free( pszOut );
+		}
+	}
+
+	BenchmarkDoNotOptimize( nResolved );
+	state.SetItemsProcessed( state.Iterations() * ( long long )s_PathmatchTree.m_Queries.size() );
+}
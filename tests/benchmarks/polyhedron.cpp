@@ -0,0 +1,176 @@
+#include "common/benchmark.h"
+
+#include <mathlib/polyhedron.h>
+
+#include <math.h>
+
+// Brush-like convexes: rotated boxes with up to eight of their corners and edges bevelled off.
+// Each iteration builds all s_nBenchmarkBrushes of them from their planes.
+
+static const int s_nBenchmarkBrushes = 256;
+static const int s_nMaxBrushPlanes = 14;
+static const float s_flOnPlaneEpsilon = 0.01f;
+
+struct BenchmarkBrush_t
+{
+	float m_Planes[s_nMaxBrushPlanes * 4];
+	int m_nPlanes;
+};
+
+static float BenchmarkRandom( uint32 &nSeed )
+{
+	nSeed = nSeed * 1664525 + 1013904223;
+	return ( ( nSeed >> 8 ) & 0xffff ) * ( 1.0f / 65536.0f );
+}
+
+static const BenchmarkBrush_t *GetBenchmarkBrushes()
+{
+	static BenchmarkBrush_t s_Brushes[s_nBenchmarkBrushes];
+	static bool s_bInitialized = false;
+
+	if ( !s_bInitialized )
+	{
+		uint32 nSeed = 12345;
+
+		for ( int i = 0; i < s_nBenchmarkBrushes; i++ )
+		{
+			BenchmarkBrush_t &brush = s_Brushes[i];
+
+			QAngle angles( BenchmarkRandom( nSeed ) * 360.0f, BenchmarkRandom( nSeed ) * 360.0f, BenchmarkRandom( nSeed ) * 360.0f );
+			Vector vCenter( BenchmarkRandom( nSeed ) * 8000.0f - 4000.0f, BenchmarkRandom( nSeed ) * 8000.0f - 4000.0f, BenchmarkRandom( nSeed ) * 2000.0f - 1000.0f );
+			Vector vExtents( 16.0f + BenchmarkRandom( nSeed ) * 240.0f, 16.0f + BenchmarkRandom( nSeed ) * 240.0f, 16.0f + BenchmarkRandom( nSeed ) * 240.0f );
+
+			matrix3x4_t rotation;
+			AngleMatrix( angles, rotation );
+
+			brush.m_nPlanes = 0;
+			for ( int nAxis = 0; nAxis < 3; nAxis++ )
+			{
+				Vector vAxis;
+				MatrixGetColumn( rotation, nAxis, vAxis );
+
+				for ( int nSign = -1; nSign <= 1; nSign += 2 )
+				{
+					float *pPlane = &brush.m_Planes[brush.m_nPlanes++ * 4];
+					Vector vNormal = vAxis * ( float )nSign;
+					pPlane[0] = vNormal.x;
+					pPlane[1] = vNormal.y;
+					pPlane[2] = vNormal.z;
+					pPlane[3] = vNormal.Dot( vCenter ) + vExtents[nAxis];
+				}
+			}
+
+			int nBevels = i % 9;
+			for ( int j = 0; j < nBevels; j++ )
+			{
+				Vector vLocal( BenchmarkRandom( nSeed ) * 2.0f - 1.0f, BenchmarkRandom( nSeed ) * 2.0f - 1.0f, BenchmarkRandom( nSeed ) * 2.0f - 1.0f );
+				VectorNormalize( vLocal );
+
+				Vector vNormal;
+				VectorRotate( vLocal, rotation, vNormal );
+
+				float flSupport = fabsf( vLocal.x ) * vExtents.x + fabsf( vLocal.y ) * vExtents.y + fabsf( vLocal.z ) * vExtents.z;
+				float *pPlane = &brush.m_Planes[brush.m_nPlanes++ * 4];
+				pPlane[0] = vNormal.x;
+				pPlane[1] = vNormal.y;
+				pPlane[2] = vNormal.z;
+				pPlane[3] = vNormal.Dot( vCenter ) + flSupport * ( 0.6f + BenchmarkRandom( nSeed ) * 0.35f );
+			}
+		}
+
+		s_bInitialized = true;
+	}
+
+	return s_Brushes;
+}
+
+REGISTER_NAMED_BENCHMARK( "GeneratePolyhedronFromPlanes/256", GeneratePolyhedronFromPlanes_256 )
+{
+	const BenchmarkBrush_t *pBrushes = GetBenchmarkBrushes();
+
+	while ( state.KeepRunning() )
+	{
+		for ( int i = 0; i < s_nBenchmarkBrushes; i++ )
+		{
+			CPolyhedron *pPolyhedron = GeneratePolyhedronFromPlanes( pBrushes[i].m_Planes, pBrushes[i].m_nPlanes, s_flOnPlaneEpsilon, true );
+			BenchmarkDoNotOptimize( pPolyhedron->iVertexCount );
+			pPolyhedron->Release();
+		}
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBrushes );
+}
+
+REGISTER_NAMED_BENCHMARK( "GeneratePolyhedronFromPlanes/256/Scratch", GeneratePolyhedronFromPlanes_256_Scratch )
+{
+	const BenchmarkBrush_t *pBrushes = GetBenchmarkBrushes();
+	CPolyhedronClipScratch scratch;
+
+	while ( state.KeepRunning() )
+	{
+		for ( int i = 0; i < s_nBenchmarkBrushes; i++ )
+		{
+			CPolyhedron *pPolyhedron = GeneratePolyhedronFromPlanes( pBrushes[i].m_Planes, pBrushes[i].m_nPlanes, s_flOnPlaneEpsilon, scratch, true );
+			BenchmarkDoNotOptimize( pPolyhedron->iVertexCount );
+		}
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBrushes );
+}
+
+// Clipping an existing box by the bevel planes only, which skips the loose AABB search
+static CPolyhedron **GetBenchmarkBoxes()
+{
+	static CPolyhedron *s_pBoxes[s_nBenchmarkBrushes];
+	static bool s_bInitialized = false;
+
+	if ( !s_bInitialized )
+	{
+		const BenchmarkBrush_t *pBrushes = GetBenchmarkBrushes();
+
+		for ( int i = 0; i < s_nBenchmarkBrushes; i++ )
+		{
+			s_pBoxes[i] = GeneratePolyhedronFromPlanes( pBrushes[i].m_Planes, 6, s_flOnPlaneEpsilon );
+		}
+
+		s_bInitialized = true;
+	}
+
+	return s_pBoxes;
+}
+
+REGISTER_NAMED_BENCHMARK( "ClipPolyhedron/256", ClipPolyhedron_256 )
+{
+	const BenchmarkBrush_t *pBrushes = GetBenchmarkBrushes();
+	CPolyhedron **pBoxes = GetBenchmarkBoxes();
+
+	while ( state.KeepRunning() )
+	{
+		for ( int i = 0; i < s_nBenchmarkBrushes; i++ )
+		{
+			CPolyhedron *pPolyhedron = ClipPolyhedron( pBoxes[i], pBrushes[i].m_Planes + 6 * 4, pBrushes[i].m_nPlanes - 6, s_flOnPlaneEpsilon, true );
+			BenchmarkDoNotOptimize( pPolyhedron->iVertexCount );
+			pPolyhedron->Release();
+		}
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBrushes );
+}
+
+REGISTER_NAMED_BENCHMARK( "ClipPolyhedron/256/Scratch", ClipPolyhedron_256_Scratch )
+{
+	const BenchmarkBrush_t *pBrushes = GetBenchmarkBrushes();
+	CPolyhedron **pBoxes = GetBenchmarkBoxes();
+	CPolyhedronClipScratch scratch;
+
+	while ( state.KeepRunning() )
+	{
+		for ( int i = 0; i < s_nBenchmarkBrushes; i++ )
+		{
+			CPolyhedron *pPolyhedron = ClipPolyhedron( pBoxes[i], pBrushes[i].m_Planes + 6 * 4, pBrushes[i].m_nPlanes - 6, s_flOnPlaneEpsilon, scratch, true );
+			BenchmarkDoNotOptimize( pPolyhedron->iVertexCount );
+		}
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBrushes );
+}
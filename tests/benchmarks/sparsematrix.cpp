@@ -0,0 +1,241 @@
+#include "common/benchmark.h"
+
+#include <tier1/sparsematrix.h>
+
+// A 1M x 1M matrix with 8 non-zeros per row, half of them near the diagonal as a mesh would
+// give and half anywhere, so the vector reads are neither all cached nor all misses. The
+// products are also run on 4 threads, which only helps on a machine with the cores for it.
+
+static const int s_nBenchmarkRows = 1 << 20;
+static const int s_nBenchmarkRowNonZeros = 8;
+static const int s_nBenchmarkBuildTriplets = 20000;
+static const int s_nBenchmarkDenseColumns = 16;
+static const int s_nBenchmarkLaplacianSize = 256;
+
+static uint32 BenchmarkRandom( uint32 &nSeed )
+{
+	nSeed = nSeed * 1664525 + 1013904223;
+	return nSeed >> 8;
+}
+
+static void FillBenchmarkTriplets( CUtlVector< CSparseMatrix::Triplet_t > &triplets, int nNumRows, int nRowNonZeros, uint32 nSeed )
+{
+	triplets.SetCount( nNumRows * nRowNonZeros );
+
+	for ( int i = 0; i < triplets.Count(); i++ )
+	{
+		CSparseMatrix::Triplet_t &triplet = triplets[i];
+		triplet.m_nRow = i / nRowNonZeros;
+
+		if ( i & 1 )
+			triplet.m_nColumnNumber = BenchmarkRandom( nSeed ) % nNumRows;
+		else
+			triplet.m_nColumnNumber = ( triplet.m_nRow + ( int )( BenchmarkRandom( nSeed ) % 64 ) ) % nNumRows;
+
+		triplet.m_flValue = 1.0f + ( BenchmarkRandom( nSeed ) & 255 ) * ( 1.0f / 256.0f );
+	}
+}
+
+static const CSparseMatrix &GetBenchmarkMatrix()
+{
+	static CSparseMatrix s_Matrix;
+	static bool s_bInitialized = false;
+
+	if ( !s_bInitialized )
+	{
+		CUtlVector< CSparseMatrix::Triplet_t > triplets;
+		FillBenchmarkTriplets( triplets, s_nBenchmarkRows, s_nBenchmarkRowNonZeros, 12345 );
+		s_Matrix.SetFromTriplets( s_nBenchmarkRows, s_nBenchmarkRows, triplets.Base(), triplets.Count() );
+		s_bInitialized = true;
+	}
+
+	return s_Matrix;
+}
+
+static void FillBenchmarkVector( CUtlVector< float > &vector, int nCount )
+{
+	vector.SetCount( nCount );
+
+	for ( int i = 0; i < nCount; i++ )
+	{
+		vector[i] = ( float )( i % 1000 ) * 0.001f;
+	}
+}
+
+REGISTER_NAMED_BENCHMARK( "CSparseMatrix::SetElement/20000", CSparseMatrix_SetElement_20000 )
+{
+	CUtlVector< CSparseMatrix::Triplet_t > triplets;
+	FillBenchmarkTriplets( triplets, s_nBenchmarkBuildTriplets / s_nBenchmarkRowNonZeros, s_nBenchmarkRowNonZeros, 777 );
+
+	while ( state.KeepRunning() )
+	{
+		CSparseMatrix matrix;
+		matrix.SetDimensions( triplets.Count() / s_nBenchmarkRowNonZeros, triplets.Count() / s_nBenchmarkRowNonZeros );
+
+		// Same triplets as the builder gets, in reverse so rows don't arrive top to bottom
+		for ( int i = triplets.Count() - 1; i >= 0; i-- )
+		{
+			const CSparseMatrix::Triplet_t &triplet = triplets[i];
+			matrix.SetElement( triplet.m_nRow, triplet.m_nColumnNumber, matrix.Element( triplet.m_nRow, triplet.m_nColumnNumber ) + triplet.m_flValue );
+		}
+
+		BenchmarkDoNotOptimize( matrix.NonZeroCount() );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBuildTriplets );
+}
+
+REGISTER_NAMED_BENCHMARK( "CSparseMatrixBuilder::Build/20000", CSparseMatrixBuilder_Build_20000 )
+{
+	CUtlVector< CSparseMatrix::Triplet_t > triplets;
+	FillBenchmarkTriplets( triplets, s_nBenchmarkBuildTriplets / s_nBenchmarkRowNonZeros, s_nBenchmarkRowNonZeros, 777 );
+
+	while ( state.KeepRunning() )
+	{
+		CSparseMatrixBuilder builder;
+		builder.SetDimensions( triplets.Count() / s_nBenchmarkRowNonZeros, triplets.Count() / s_nBenchmarkRowNonZeros );
+
+		for ( int i = triplets.Count() - 1; i >= 0; i-- )
+		{
+			builder.AddElement( triplets[i].m_nRow, triplets[i].m_nColumnNumber, triplets[i].m_flValue );
+		}
+
+		CSparseMatrix matrix;
+		builder.Build( &matrix );
+		BenchmarkDoNotOptimize( matrix.NonZeroCount() );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBuildTriplets );
+}
+
+REGISTER_NAMED_BENCHMARK( "CSparseMatrix::SetFromTriplets/8M", CSparseMatrix_SetFromTriplets_8M )
+{
+	CUtlVector< CSparseMatrix::Triplet_t > triplets;
+	FillBenchmarkTriplets( triplets, s_nBenchmarkRows, s_nBenchmarkRowNonZeros, 12345 );
+
+	while ( state.KeepRunning() )
+	{
+		CSparseMatrix matrix;
+		matrix.SetFromTriplets( s_nBenchmarkRows, s_nBenchmarkRows, triplets.Base(), triplets.Count() );
+		BenchmarkDoNotOptimize( matrix.NonZeroCount() );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * triplets.Count() );
+}
+
+REGISTER_NAMED_BENCHMARK( "Scalar::MultiplyVector/8M", Scalar_MultiplyVector_8M )
+{
+	const CSparseMatrix &matrix = GetBenchmarkMatrix();
+	CUtlVector< float > vector, result;
+	FillBenchmarkVector( vector, s_nBenchmarkRows );
+	result.SetCount( s_nBenchmarkRows );
+
+	while ( state.KeepRunning() )
+	{
+		// The loop MatrixMath::MatrixMultiply runs per output column
+		for ( int i = 0; i < matrix.Height(); i++ )
+		{
+			int nCount = matrix.m_rowDescriptors[i].m_nNonZeroCount;
+			int nDataIndex = matrix.m_rowDescriptors[i].m_nDataIndex;
+			float flDot = 0;
+			for ( int j = 0; j < nCount; j++ )
+			{
+				flDot += matrix.m_entries[nDataIndex + j].m_flValue * vector[matrix.m_entries[nDataIndex + j].m_nColumnNumber];
+			}
+			result[i] = flDot;
+		}
+
+		BenchmarkDoNotOptimize( result[0] );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * matrix.NonZeroCount() );
+}
+
+REGISTER_NAMED_BENCHMARK( "CSparseMatrix::MultiplyVector/8M", CSparseMatrix_MultiplyVector_8M )
+{
+	const CSparseMatrix &matrix = GetBenchmarkMatrix();
+	CUtlVector< float > vector, result;
+	FillBenchmarkVector( vector, s_nBenchmarkRows );
+	result.SetCount( s_nBenchmarkRows );
+
+	while ( state.KeepRunning() )
+	{
+		matrix.MultiplyVector( vector.Base(), result.Base() );
+		BenchmarkDoNotOptimize( result[0] );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * matrix.NonZeroCount() );
+}
+
+REGISTER_NAMED_BENCHMARK( "CSparseMatrix::MultiplyVector/8M/4 threads", CSparseMatrix_MultiplyVector_8M_Threads )
+{
+	const CSparseMatrix &matrix = GetBenchmarkMatrix();
+	CUtlVector< float > vector, result;
+	FillBenchmarkVector( vector, s_nBenchmarkRows );
+	result.SetCount( s_nBenchmarkRows );
+
+	while ( state.KeepRunning() )
+	{
+		matrix.MultiplyVector( vector.Base(), result.Base(), 4 );
+		BenchmarkDoNotOptimize( result[0] );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * matrix.NonZeroCount() );
+}
+
+REGISTER_NAMED_BENCHMARK( "CSparseMatrix::MultiplyDense/8M x 16", CSparseMatrix_MultiplyDense_8M_16 )
+{
+	const CSparseMatrix &matrix = GetBenchmarkMatrix();
+	CUtlVector< float > dense, result;
+	FillBenchmarkVector( dense, s_nBenchmarkRows * s_nBenchmarkDenseColumns );
+	result.SetCount( s_nBenchmarkRows * s_nBenchmarkDenseColumns );
+
+	while ( state.KeepRunning() )
+	{
+		matrix.MultiplyDense( dense.Base(), s_nBenchmarkDenseColumns, result.Base() );
+		BenchmarkDoNotOptimize( result[0] );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * matrix.NonZeroCount() * s_nBenchmarkDenseColumns );
+}
+
+REGISTER_NAMED_BENCHMARK( "CSparseMatrix::SolveConjugateGradient/256x256", CSparseMatrix_SolveConjugateGradient_256x256 )
+{
+	// The 5 point Laplacian of a 256x256 grid, solved to 1e-5
+	const int nSize = s_nBenchmarkLaplacianSize;
+	CSparseMatrixBuilder builder;
+	builder.SetDimensions( nSize * nSize, nSize * nSize );
+	for ( int i = 0; i < nSize * nSize; i++ )
+	{
+		builder.AddElement( i, i, 4.01f );
+		if ( i % nSize )
+			builder.AddElement( i, i - 1, -1.0f );
+		if ( ( i + 1 ) % nSize )
+			builder.AddElement( i, i + 1, -1.0f );
+		if ( i >= nSize )
+			builder.AddElement( i, i - nSize, -1.0f );
+		if ( i + nSize < nSize * nSize )
+			builder.AddElement( i, i + nSize, -1.0f );
+	}
+
+	CSparseMatrix matrix;
+	builder.Build( &matrix );
+
+	CUtlVector< float > rhs, solution;
+	FillBenchmarkVector( rhs, nSize * nSize );
+	solution.SetCount( nSize * nSize );
+
+	int nIterations = 0;
+	while ( state.KeepRunning() )
+	{
+		for ( int i = 0; i < solution.Count(); i++ )
+		{
+			solution[i] = 0.0f;
+		}
+
+		nIterations += matrix.SolveConjugateGradient( rhs.Base(), solution.Base(), 1000, 1.0e-5f );
+		BenchmarkDoNotOptimize( solution[0] );
+	}
+
+	state.SetItemsProcessed( nIterations );
+}
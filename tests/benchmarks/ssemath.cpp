@@ -0,0 +1,320 @@
+#include "common/benchmark.h"
+
+#include <mathlib/mathlib.h>
+#include <mathlib/ssemath.h>
+
+// One call per box against one call for all of them, over the same bounds. The batched
+// entry points are run with and without the fltx8 path.
+
+static const int s_nBenchmarkBoxes = 4096;
+
+struct BenchmarkBoxes_t
+{
+	FourVectors m_Mins[s_nBenchmarkBoxes / 4];
+	FourVectors m_Maxs[s_nBenchmarkBoxes / 4];
+	Vector m_MinsAoS[s_nBenchmarkBoxes];
+	Vector m_MaxsAoS[s_nBenchmarkBoxes];
+};
+
+static BenchmarkBoxes_t &GetBenchmarkBoxes()
+{
+	static BenchmarkBoxes_t s_Boxes;
+	static bool s_bInitialized = false;
+
+	if ( !s_bInitialized )
+	{
+		uint32 nSeed = 12345;
+
+		for ( int i = 0; i < s_nBenchmarkBoxes; i++ )
+		{
+			float flValues[6];
+
+			for ( int k = 0; k < 6; k++ )
+			{
+				nSeed = nSeed * 1664525 + 1013904223;
+				flValues[k] = ( ( nSeed >> 8 ) & 0xffff ) * ( 1.0f / 65536.0f );
+			}
+
+			Vector vCenter( flValues[0] * 8000.0f - 4000.0f, flValues[1] * 8000.0f - 4000.0f, flValues[2] * 2000.0f - 1000.0f );
+			Vector vExtents( 8.0f + flValues[3] * 64.0f, 8.0f + flValues[4] * 64.0f, 8.0f + flValues[5] * 64.0f );
+
+			s_Boxes.m_MinsAoS[i] = vCenter - vExtents;
+			s_Boxes.m_MaxsAoS[i] = vCenter + vExtents;
+
+			s_Boxes.m_Mins[i >> 2].X( i & 3 ) = s_Boxes.m_MinsAoS[i].x;
+			s_Boxes.m_Mins[i >> 2].Y( i & 3 ) = s_Boxes.m_MinsAoS[i].y;
+			s_Boxes.m_Mins[i >> 2].Z( i & 3 ) = s_Boxes.m_MinsAoS[i].z;
+			s_Boxes.m_Maxs[i >> 2].X( i & 3 ) = s_Boxes.m_MaxsAoS[i].x;
+			s_Boxes.m_Maxs[i >> 2].Y( i & 3 ) = s_Boxes.m_MaxsAoS[i].y;
+			s_Boxes.m_Maxs[i >> 2].Z( i & 3 ) = s_Boxes.m_MaxsAoS[i].z;
+		}
+
+		s_bInitialized = true;
+	}
+
+	return s_Boxes;
+}
+
+static const Frustum_t &GetBenchmarkFrustum()
+{
+	static Frustum_t s_Frustum;
+	static bool s_bInitialized = false;
+
+	if ( !s_bInitialized )
+	{
+		s_Frustum.CreatePerspectiveFrustum( vec3_origin, QAngle( 0.0f, 45.0f, 0.0f ), 4.0f, 4000.0f, 90.0f, 16.0f / 9.0f );
+		s_bInitialized = true;
+	}
+
+	return s_Frustum;
+}
+
+REGISTER_NAMED_BENCHMARK( "Frustum_t::CullBox/4096", Frustum_t_CullBox_4096 )
+{
+	const BenchmarkBoxes_t &boxes = GetBenchmarkBoxes();
+	const Frustum_t &frustum = GetBenchmarkFrustum();
+
+	while ( state.KeepRunning() )
+	{
+		int nCulled = 0;
+
+		for ( int i = 0; i < s_nBenchmarkBoxes; i++ )
+		{
+			nCulled += frustum.CullBox( boxes.m_MinsAoS[i], boxes.m_MaxsAoS[i] );
+		}
+
+		BenchmarkDoNotOptimize( nCulled );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBoxes );
+}
+
+static void RunCullBoxesBenchmark( BenchmarkState &state, bool bSIMD8 )
+{
+	const BenchmarkBoxes_t &boxes = GetBenchmarkBoxes();
+	const Frustum_t &frustum = GetBenchmarkFrustum();
+	static uint32 s_nCulled[s_nBenchmarkBoxes / 32];
+
+	const bool bWasEnabled = MathLib_SIMD8Enabled();
+	MathLib_SetSIMD8Enabled( bSIMD8 );
+
+	while ( state.KeepRunning() )
+	{
+		BenchmarkDoNotOptimize( frustum.CullBoxes( boxes.m_Mins, boxes.m_Maxs, s_nBenchmarkBoxes, s_nCulled ) );
+	}
+
+	MathLib_SetSIMD8Enabled( bWasEnabled );
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBoxes );
+}
+
+REGISTER_NAMED_BENCHMARK( "Frustum_t::CullBoxes/4096/4", Frustum_t_CullBoxes_4096_4 )
+{
+	RunCullBoxesBenchmark( state, false );
+}
+
+REGISTER_NAMED_BENCHMARK( "Frustum_t::CullBoxes/4096/8", Frustum_t_CullBoxes_4096_8 )
+{
+	RunCullBoxesBenchmark( state, true );
+}
+
+REGISTER_NAMED_BENCHMARK( "TransformAABB/4096", TransformAABB_4096 )
+{
+	const BenchmarkBoxes_t &boxes = GetBenchmarkBoxes();
+	static Vector s_MinsOut[s_nBenchmarkBoxes], s_MaxsOut[s_nBenchmarkBoxes];
+
+	matrix3x4_t transform;
+	AngleMatrix( QAngle( 10.0f, 20.0f, 30.0f ), Vector( 1.0f, 2.0f, 3.0f ), transform );
+
+	while ( state.KeepRunning() )
+	{
+		for ( int i = 0; i < s_nBenchmarkBoxes; i++ )
+		{
+			TransformAABB( transform, boxes.m_MinsAoS[i], boxes.m_MaxsAoS[i], s_MinsOut[i], s_MaxsOut[i] );
+		}
+
+		BenchmarkDoNotOptimize( s_MinsOut[0].x );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBoxes );
+}
+
+static void RunTransformAABBsBenchmark( BenchmarkState &state, bool bSIMD8 )
+{
+	const BenchmarkBoxes_t &boxes = GetBenchmarkBoxes();
+	static FourVectors s_MinsOut[s_nBenchmarkBoxes / 4], s_MaxsOut[s_nBenchmarkBoxes / 4];
+
+	matrix3x4_t transform;
+	AngleMatrix( QAngle( 10.0f, 20.0f, 30.0f ), Vector( 1.0f, 2.0f, 3.0f ), transform );
+
+	const bool bWasEnabled = MathLib_SIMD8Enabled();
+	MathLib_SetSIMD8Enabled( bSIMD8 );
+
+	while ( state.KeepRunning() )
+	{
+		TransformAABBs( transform, boxes.m_Mins, boxes.m_Maxs, s_nBenchmarkBoxes, s_MinsOut, s_MaxsOut );
+		BenchmarkDoNotOptimize( s_MinsOut[0].x );
+	}
+
+	MathLib_SetSIMD8Enabled( bWasEnabled );
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBoxes );
+}
+
+REGISTER_NAMED_BENCHMARK( "TransformAABBs/4096/4", TransformAABBs_4096_4 )
+{
+	RunTransformAABBsBenchmark( state, false );
+}
+
+REGISTER_NAMED_BENCHMARK( "TransformAABBs/4096/8", TransformAABBs_4096_8 )
+{
+	RunTransformAABBsBenchmark( state, true );
+}
+
+// Per-quaternion calls against the batched ones, over a pose of s_nBenchmarkBones bones.
+
+static const int s_nBenchmarkBones = 4096;
+
+struct BenchmarkPose_t
+{
+	Quaternion m_P[s_nBenchmarkBones];
+	Quaternion m_Q[s_nBenchmarkBones];
+	Vector m_Pos[s_nBenchmarkBones];
+	int m_nParents[s_nBenchmarkBones];
+};
+
+static BenchmarkPose_t &GetBenchmarkPose()
+{
+	static BenchmarkPose_t s_Pose;
+	static bool s_bInitialized = false;
+
+	if ( !s_bInitialized )
+	{
+		for ( int i = 0; i < s_nBenchmarkBones; i++ )
+		{
+			AngleQuaternion( RadianEuler( i * 0.37f, i * -0.21f, i * 0.13f ), s_Pose.m_P[i] );
+			AngleQuaternion( RadianEuler( i * -0.11f, i * 0.29f, i * 0.47f ), s_Pose.m_Q[i] );
+			s_Pose.m_Pos[i].Init( i * 0.5f, 1.0f, -2.0f );
+
+			// a few long chains, like a skeleton's spine and limbs
+			s_Pose.m_nParents[i] = ( i % 16 ) ? i - 1 : -1;
+		}
+
+		s_bInitialized = true;
+	}
+
+	return s_Pose;
+}
+
+REGISTER_NAMED_BENCHMARK( "QuaternionSlerp/4096", QuaternionSlerp_4096 )
+{
+	const BenchmarkPose_t &pose = GetBenchmarkPose();
+	static Quaternion s_Out[s_nBenchmarkBones];
+
+	while ( state.KeepRunning() )
+	{
+		for ( int i = 0; i < s_nBenchmarkBones; i++ )
+		{
+			QuaternionSlerp( pose.m_P[i], pose.m_Q[i], 0.3f, s_Out[i] );
+		}
+
+		BenchmarkDoNotOptimize( s_Out[0].x );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBones );
+}
+
+REGISTER_NAMED_BENCHMARK( "QuaternionSlerps/4096", QuaternionSlerps_4096 )
+{
+	const BenchmarkPose_t &pose = GetBenchmarkPose();
+	static Quaternion s_Out[s_nBenchmarkBones];
+
+	while ( state.KeepRunning() )
+	{
+		QuaternionSlerps( pose.m_P, pose.m_Q, 0.3f, s_nBenchmarkBones, s_Out );
+		BenchmarkDoNotOptimize( s_Out[0].x );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBones );
+}
+
+REGISTER_NAMED_BENCHMARK( "QuaternionBlend/4096", QuaternionBlend_4096 )
+{
+	const BenchmarkPose_t &pose = GetBenchmarkPose();
+	static Quaternion s_Out[s_nBenchmarkBones];
+
+	while ( state.KeepRunning() )
+	{
+		for ( int i = 0; i < s_nBenchmarkBones; i++ )
+		{
+			QuaternionBlend( pose.m_P[i], pose.m_Q[i], 0.3f, s_Out[i] );
+		}
+
+		BenchmarkDoNotOptimize( s_Out[0].x );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBones );
+}
+
+REGISTER_NAMED_BENCHMARK( "QuaternionBlends/4096", QuaternionBlends_4096 )
+{
+	const BenchmarkPose_t &pose = GetBenchmarkPose();
+	static Quaternion s_Out[s_nBenchmarkBones];
+
+	while ( state.KeepRunning() )
+	{
+		QuaternionBlends( pose.m_P, pose.m_Q, 0.3f, s_nBenchmarkBones, s_Out );
+		BenchmarkDoNotOptimize( s_Out[0].x );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBones );
+}
+
+REGISTER_NAMED_BENCHMARK( "QuaternionMatrix/4096", QuaternionMatrix_4096 )
+{
+	const BenchmarkPose_t &pose = GetBenchmarkPose();
+	static matrix3x4a_t s_Out[s_nBenchmarkBones];
+
+	while ( state.KeepRunning() )
+	{
+		for ( int i = 0; i < s_nBenchmarkBones; i++ )
+		{
+			QuaternionMatrix( pose.m_P[i], pose.m_Pos[i], s_Out[i] );
+		}
+
+		BenchmarkDoNotOptimize( s_Out[0][0][0] );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBones );
+}
+
+REGISTER_NAMED_BENCHMARK( "QuaternionMatrices/4096", QuaternionMatrices_4096 )
+{
+	const BenchmarkPose_t &pose = GetBenchmarkPose();
+	static matrix3x4a_t s_Out[s_nBenchmarkBones];
+
+	while ( state.KeepRunning() )
+	{
+		QuaternionMatrices( pose.m_P, pose.m_Pos, s_nBenchmarkBones, s_Out );
+		BenchmarkDoNotOptimize( s_Out[0][0][0] );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBones );
+}
+
+REGISTER_NAMED_BENCHMARK( "ConcatBoneTransforms/4096", ConcatBoneTransforms_4096 )
+{
+	const BenchmarkPose_t &pose = GetBenchmarkPose();
+	static matrix3x4a_t s_Local[s_nBenchmarkBones], s_Out[s_nBenchmarkBones];
+
+	QuaternionMatrices( pose.m_P, pose.m_Pos, s_nBenchmarkBones, s_Local );
+
+	matrix3x4a_t rootTransform;
+	AngleMatrix( QAngle( 10.0f, 20.0f, 30.0f ), Vector( 1.0f, 2.0f, 3.0f ), rootTransform );
+
+	while ( state.KeepRunning() )
+	{
+		ConcatBoneTransforms( rootTransform, s_Local, pose.m_nParents, s_nBenchmarkBones, s_Out );
+		BenchmarkDoNotOptimize( s_Out[0][0][0] );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkBones );
+}
@@ -0,0 +1,213 @@
+#include "common/benchmark.h"
+
+#include <mathlib/ssemath8.h>
+#include <mathlib/simdvectormatrix.h>
+
+// Each kernel is run once through the 4-wide code and once through the 8-wide one. The
+// batched entry points are toggled with MathLib_SetSIMD8Enabled so both sides go through
+// exactly the same call; on a CPU without AVX2 the "8" variants measure the fallback.
+
+static const int s_nBenchmarkVectors = 1024;
+
+static FourVectors *GetBenchmarkPositions()
+{
+	static FourVectors s_Positions[s_nBenchmarkVectors];
+	static bool s_bInitialized = false;
+
+	if ( !s_bInitialized )
+	{
+		for ( int i = 0; i < s_nBenchmarkVectors; i++ )
+		{
+			for ( int j = 0; j < 4; j++ )
+			{
+				int n = i * 4 + j;
+				s_Positions[i].X( j ) = -200.0f + n * 0.097f;
+				s_Positions[i].Y( j ) = 50.0f - n * 0.031f;
+				s_Positions[i].Z( j ) = 0.5f + n * 0.013f;
+			}
+		}
+
+		s_bInitialized = true;
+	}
+
+	return s_Positions;
+}
+
+static void RunNoiseBenchmark( BenchmarkState &state, bool bSIMD8 )
+{
+	static fltx4 s_Results[s_nBenchmarkVectors];
+	const FourVectors *pPositions = GetBenchmarkPositions();
+	const bool bWasEnabled = MathLib_SIMD8Enabled();
+
+	MathLib_SetSIMD8Enabled( bSIMD8 );
+
+	while ( state.KeepRunning() )
+	{
+		NoiseSIMD( pPositions, s_Results, s_nBenchmarkVectors );
+		BenchmarkDoNotOptimize( s_Results[0] );
+	}
+
+	MathLib_SetSIMD8Enabled( bWasEnabled );
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkVectors * 4 );
+}
+
+REGISTER_NAMED_BENCHMARK( "NoiseSIMD/4", NoiseSIMD_4 )
+{
+	RunNoiseBenchmark( state, false );
+}
+
+REGISTER_NAMED_BENCHMARK( "NoiseSIMD/8", NoiseSIMD_8 )
+{
+	RunNoiseBenchmark( state, true );
+}
+
+static void PowBatch4( const FourVectors *pInput, fltx4 *pOutput, int nCount, float flExponent )
+{
+	for ( int i = 0; i < nCount; i++ )
+	{
+		pOutput[i] = PowSIMD( AbsSIMD( pInput[i].z ), flExponent );
+	}
+}
+
+static SIMD8_TARGET void PowBatch8( const FourVectors *pInput, fltx4 *pOutput, int nCount, float flExponent )
+{
+	for ( int i = 0; i + 1 < nCount; i += 2 )
+	{
+		fltx8 result = PowSIMD( AbsSIMD( CombineSIMD8( pInput[i].z, pInput[i + 1].z ) ), flExponent );
+		pOutput[i] = LowerSIMD( result );
+		pOutput[i + 1] = UpperSIMD( result );
+	}
+}
+
+REGISTER_NAMED_BENCHMARK( "PowSIMD/4", PowSIMD_4 )
+{
+	static fltx4 s_Results[s_nBenchmarkVectors];
+	const FourVectors *pPositions = GetBenchmarkPositions();
+
+	while ( state.KeepRunning() )
+	{
+		PowBatch4( pPositions, s_Results, s_nBenchmarkVectors, 2.5f );
+		BenchmarkDoNotOptimize( s_Results[0] );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkVectors * 4 );
+}
+
+REGISTER_NAMED_BENCHMARK( "PowSIMD/8", PowSIMD_8 )
+{
+	static fltx4 s_Results[s_nBenchmarkVectors];
+	const FourVectors *pPositions = GetBenchmarkPositions();
+
+	if ( !MathLib_SIMD8Enabled() )
+		return;
+
+	while ( state.KeepRunning() )
+	{
+		PowBatch8( pPositions, s_Results, s_nBenchmarkVectors, 2.5f );
+		BenchmarkDoNotOptimize( s_Results[0] );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkVectors * 4 );
+}
+
+static void SinCosBatch4( const FourVectors *pInput, fltx4 *pOutput, int nCount )
+{
+	for ( int i = 0; i < nCount; i++ )
+	{
+		fltx4 sine, cosine;
+		SinCos3SIMD( sine, cosine, pInput[i].x );
+		pOutput[i] = AddSIMD( sine, cosine );
+	}
+}
+
+static SIMD8_TARGET void SinCosBatch8( const FourVectors *pInput, fltx4 *pOutput, int nCount )
+{
+	for ( int i = 0; i + 1 < nCount; i += 2 )
+	{
+		fltx8 sine, cosine;
+		SinCosSIMD( sine, cosine, CombineSIMD8( pInput[i].x, pInput[i + 1].x ) );
+
+		fltx8 result = AddSIMD( sine, cosine );
+		pOutput[i] = LowerSIMD( result );
+		pOutput[i + 1] = UpperSIMD( result );
+	}
+}
+
+REGISTER_NAMED_BENCHMARK( "SinCosSIMD/4", SinCosSIMD_4 )
+{
+	static fltx4 s_Results[s_nBenchmarkVectors];
+	const FourVectors *pPositions = GetBenchmarkPositions();
+
+	while ( state.KeepRunning() )
+	{
+		SinCosBatch4( pPositions, s_Results, s_nBenchmarkVectors );
+		BenchmarkDoNotOptimize( s_Results[0] );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkVectors * 4 );
+}
+
+REGISTER_NAMED_BENCHMARK( "SinCosSIMD/8", SinCosSIMD_8 )
+{
+	static fltx4 s_Results[s_nBenchmarkVectors];
+	const FourVectors *pPositions = GetBenchmarkPositions();
+
+	if ( !MathLib_SIMD8Enabled() )
+		return;
+
+	while ( state.KeepRunning() )
+	{
+		SinCosBatch8( pPositions, s_Results, s_nBenchmarkVectors );
+		BenchmarkDoNotOptimize( s_Results[0] );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkVectors * 4 );
+}
+
+static void FillVectorMatrix( CSIMDVectorMatrix &matrix, const Vector &value )
+{
+	for ( int y = 0; y < matrix.m_nHeight; y++ )
+	{
+		for ( int x = 0; x < matrix.m_nPaddedWidth; x++ )
+		{
+			matrix.CompoundElement( x, y ).DuplicateVector( value );
+		}
+	}
+}
+
+static void RunVectorMatrixBenchmark( BenchmarkState &state, bool bSIMD8 )
+{
+	const int nWidth = 256, nHeight = 64;
+
+	CSIMDVectorMatrix image, other;
+	image.SetSize( nWidth, nHeight );
+	other.SetSize( nWidth, nHeight );
+
+	const bool bWasEnabled = MathLib_SIMD8Enabled();
+	MathLib_SetSIMD8Enabled( bSIMD8 );
+
+	while ( state.KeepRunning() )
+	{
+		FillVectorMatrix( image, Vector( 0.25f, 0.5f, 0.75f ) );
+		FillVectorMatrix( other, Vector( 0.125f, 0.25f, 0.125f ) );
+
+		image += other;
+		image *= Vector( 1.5f, 0.5f, 1.25f );
+		image.RaiseToPower( 2.2f );
+
+		BenchmarkDoNotOptimize( image.CompoundElement( 0, 0 ).x );
+	}
+
+	MathLib_SetSIMD8Enabled( bWasEnabled );
+	state.SetItemsProcessed( state.Iterations() * nWidth * nHeight );
+}
+
+REGISTER_NAMED_BENCHMARK( "CSIMDVectorMatrix/4", CSIMDVectorMatrix_4 )
+{
+	RunVectorMatrixBenchmark( state, false );
+}
+
+REGISTER_NAMED_BENCHMARK( "CSIMDVectorMatrix/8", CSIMDVectorMatrix_8 )
+{
+	RunVectorMatrixBenchmark( state, true );
+}
@@ -0,0 +1,209 @@
+#include "common/benchmark.h"
+
+#include <tier0/strtools.h>
+#include <tier1/strtools_simd.h>
+
+#include <string.h>
+
+// Each function on a short string, a convar name of at most 16 bytes, and a long one
+// the size of a chat line or asset path list. The tier0 rows are the functions the
+// tier1 callers used before; the others pin a level of the SIMD versions. Levels the
+// CPU doesn't have fall back to the best it does, so those rows repeat.
+
+enum EBenchmarkString
+{
+	BENCHMARK_STRING_SHORT,
+	BENCHMARK_STRING_LONG,
+	BENCHMARK_STRING_COUNT
+};
+
+// -1 for the tier0 function
+#define BENCHMARK_LEVEL_TIER0 -1
+
+struct BenchmarkStrings_t
+{
+	// The string, the same with its case swapped, and a piece of its end to search for
+	char m_szString[512];
+	char m_szSwapped[512];
+	char m_szSearch[32];
+	int m_nLength;
+};
+
+static const BenchmarkStrings_t &GetBenchmarkStrings( EBenchmarkString eString )
+{
+	static BenchmarkStrings_t s_Strings[BENCHMARK_STRING_COUNT];
+
+	BenchmarkStrings_t &strings = s_Strings[eString];
+	if ( !strings.m_nLength )
+	{
+		if ( eString == BENCHMARK_STRING_SHORT )
+		{
+			V_strncpy( strings.m_szString, "mp_RoundTime_Defuse", 17 );
+		}
+		else
+		{
+			const char *pText = "Models/Characters/Player/CT_Sas/CT_Sas_Variant_A.vmdl; ";
+			while ( V_strlen( strings.m_szString ) + V_strlen( pText ) < 400 )
+			{
+				V_strncat( strings.m_szString, pText, sizeof( strings.m_szString ) );
+			}
+		}
+
+		strings.m_nLength = V_strlen( strings.m_szString );
+		for ( int i = 0; i <= strings.m_nLength; i++ )
+		{
+			char c = strings.m_szString[i];
+			strings.m_szSwapped[i] = ( ( c | 0x20 ) >= 'a' && ( c | 0x20 ) <= 'z' ) ? ( c ^ 0x20 ) : c;
+		}
+
+		int nSearchLength = ( eString == BENCHMARK_STRING_SHORT ) ? 4 : 12;
+		V_strncpy( strings.m_szSearch, strings.m_szString + strings.m_nLength - nSearchLength - 1, nSearchLength + 1 );
+	}
+
+	return strings;
+}
+
+static void BenchmarkStrlen( BenchmarkState &state, EBenchmarkString eString, int nLevel )
+{
+	const BenchmarkStrings_t &strings = GetBenchmarkStrings( eString );
+	V_StrSetSIMDLevel( nLevel );
+
+	while ( state.KeepRunning() )
+	{
+		const char *pString = strings.m_szString;
+		BenchmarkDoNotOptimize( pString );
+		BenchmarkDoNotOptimize( nLevel == BENCHMARK_LEVEL_TIER0 ? V_strlen( pString ) : V_strlen_simd( pString ) );
+	}
+
+	state.SetBytesProcessed( state.Iterations() * strings.m_nLength );
+	V_StrSetSIMDLevel( 2 );
+}
+
+// Equal but for case, so the whole string is compared
+static void BenchmarkStricmp( BenchmarkState &state, EBenchmarkString eString, int nLevel )
+{
+	const BenchmarkStrings_t &strings = GetBenchmarkStrings( eString );
+	V_StrSetSIMDLevel( nLevel );
+
+	while ( state.KeepRunning() )
+	{
+		const char *pString = strings.m_szString;
+		BenchmarkDoNotOptimize( pString );
+		BenchmarkDoNotOptimize( nLevel == BENCHMARK_LEVEL_TIER0 ? V_stricmp_fast( pString, strings.m_szSwapped ) : V_stricmp_simd( pString, strings.m_szSwapped ) );
+	}
+
+	state.SetBytesProcessed( state.Iterations() * strings.m_nLength );
+	V_StrSetSIMDLevel( 2 );
+}
+
+static void BenchmarkStrnicmp( BenchmarkState &state, EBenchmarkString eString, int nLevel )
+{
+	const BenchmarkStrings_t &strings = GetBenchmarkStrings( eString );
+	int nCount = strings.m_nLength - 1;
+	V_StrSetSIMDLevel( nLevel );
+
+	while ( state.KeepRunning() )
+	{
+		const char *pString = strings.m_szString;
+		BenchmarkDoNotOptimize( pString );
+		BenchmarkDoNotOptimize( nLevel == BENCHMARK_LEVEL_TIER0 ? V_strnicmp( pString, strings.m_szSwapped, nCount ) : V_strnicmp_simd( pString, strings.m_szSwapped, nCount ) );
+	}
+
+	state.SetBytesProcessed( state.Iterations() * nCount );
+	V_StrSetSIMDLevel( 2 );
+}
+
+// Found at the end, so the whole string is searched
+static void BenchmarkStrstr( BenchmarkState &state, EBenchmarkString eString, int nLevel )
+{
+	const BenchmarkStrings_t &strings = GetBenchmarkStrings( eString );
+	V_StrSetSIMDLevel( nLevel );
+
+	while ( state.KeepRunning() )
+	{
+		const char *pString = strings.m_szString;
+		BenchmarkDoNotOptimize( pString );
+		BenchmarkDoNotOptimize( nLevel == BENCHMARK_LEVEL_TIER0 ? V_strstr( pString, strings.m_szSearch ) : V_strstr_simd( pString, strings.m_szSearch ) );
+	}
+
+	state.SetBytesProcessed( state.Iterations() * strings.m_nLength );
+	V_StrSetSIMDLevel( 2 );
+}
+
+static void BenchmarkStristr( BenchmarkState &state, EBenchmarkString eString, int nLevel )
+{
+	const BenchmarkStrings_t &strings = GetBenchmarkStrings( eString );
+	V_StrSetSIMDLevel( nLevel );
+
+	while ( state.KeepRunning() )
+	{
+		const char *pString = strings.m_szSwapped;
+		BenchmarkDoNotOptimize( pString );
+		BenchmarkDoNotOptimize( nLevel == BENCHMARK_LEVEL_TIER0 ? V_stristr( pString, strings.m_szSearch ) : V_stristr_simd( pString, strings.m_szSearch ) );
+	}
+
+	state.SetBytesProcessed( state.Iterations() * strings.m_nLength );
+	V_StrSetSIMDLevel( 2 );
+}
+
+// tier0 has no copying version, so its row is V_strncpy followed by V_strlower
+static void BenchmarkStrtolower( BenchmarkState &state, EBenchmarkString eString, int nLevel )
+{
+	const BenchmarkStrings_t &strings = GetBenchmarkStrings( eString );
+	char szOut[sizeof( strings.m_szString )];
+	V_StrSetSIMDLevel( nLevel );
+
+	while ( state.KeepRunning() )
+	{
+		if ( nLevel == BENCHMARK_LEVEL_TIER0 )
+		{
+			V_strncpy( szOut, strings.m_szString, sizeof( szOut ) );
+			V_strlower( szOut );
+		}
+		else
+		{
+			V_strtolower_simd( strings.m_szString, szOut, sizeof( szOut ) );
+		}
+
+		BenchmarkDoNotOptimize( szOut );
+	}
+
+	state.SetBytesProcessed( state.Iterations() * strings.m_nLength );
+	V_StrSetSIMDLevel( 2 );
+}
+
+#define REGISTER_STRTOOLS_SIMD_BENCHMARKS( name, function, string, string_name ) \
+	REGISTER_NAMED_BENCHMARK( name "/" string_name "/tier0", function##_##string##_Tier0 ) \
+	{ \
+		Benchmark##function( state, BENCHMARK_STRING_##string, BENCHMARK_LEVEL_TIER0 ); \
+	} \
+	REGISTER_NAMED_BENCHMARK( name "/" string_name "/scalar", function##_##string##_Scalar ) \
+	{ \
+		Benchmark##function( state, BENCHMARK_STRING_##string, 0 ); \
+	} \
+	REGISTER_NAMED_BENCHMARK( name "/" string_name "/SSE2", function##_##string##_SSE2 ) \
+	{ \
+		Benchmark##function( state, BENCHMARK_STRING_##string, 1 ); \
+	} \
+	REGISTER_NAMED_BENCHMARK( name "/" string_name "/AVX2", function##_##string##_AVX2 ) \
+	{ \
+		Benchmark##function( state, BENCHMARK_STRING_##string, 2 ); \
+	}
+
+REGISTER_STRTOOLS_SIMD_BENCHMARKS( "V_strlen", Strlen, SHORT, "16 bytes" )
+REGISTER_STRTOOLS_SIMD_BENCHMARKS( "V_strlen", Strlen, LONG, "400 bytes" )
+
+REGISTER_STRTOOLS_SIMD_BENCHMARKS( "V_stricmp", Stricmp, SHORT, "16 bytes" )
+REGISTER_STRTOOLS_SIMD_BENCHMARKS( "V_stricmp", Stricmp, LONG, "400 bytes" )
+
+REGISTER_STRTOOLS_SIMD_BENCHMARKS( "V_strnicmp", Strnicmp, SHORT, "16 bytes" )
+REGISTER_STRTOOLS_SIMD_BENCHMARKS( "V_strnicmp", Strnicmp, LONG, "400 bytes" )
+
+REGISTER_STRTOOLS_SIMD_BENCHMARKS( "V_strstr", Strstr, SHORT, "16 bytes" )
+REGISTER_STRTOOLS_SIMD_BENCHMARKS( "V_strstr", Strstr, LONG, "400 bytes" )
+
+REGISTER_STRTOOLS_SIMD_BENCHMARKS( "V_stristr", Stristr, SHORT, "16 bytes" )
+REGISTER_STRTOOLS_SIMD_BENCHMARKS( "V_stristr", Stristr, LONG, "400 bytes" )
+
+REGISTER_STRTOOLS_SIMD_BENCHMARKS( "V_strtolower", Strtolower, SHORT, "16 bytes" )
+REGISTER_STRTOOLS_SIMD_BENCHMARKS( "V_strtolower", Strtolower, LONG, "400 bytes" )
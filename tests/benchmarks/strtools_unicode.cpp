@@ -0,0 +1,149 @@
+#include "common/benchmark.h"
+
+#include <tier1/strtools_unicode.h>
+#include <tier1/utlvector.h>
+
+#include <string.h>
+
+// 64KB of each kind of text: English ASCII, French (mostly ASCII with the odd 2 byte
+// accent) and Chinese (3 byte characters with ASCII punctuation and spaces), plus a
+// chat line sized string. Each runs on the scalar loop, SSE4.1 and AVX2; levels the
+// CPU doesn't have fall back to the best it does, so those rows repeat.
+
+static const int s_nBenchmarkCorpusBytes = 64 * 1024;
+
+enum EBenchmarkCorpus
+{
+	BENCHMARK_CORPUS_ASCII,
+	BENCHMARK_CORPUS_LATIN,
+	BENCHMARK_CORPUS_CJK,
+	BENCHMARK_CORPUS_CHAT,
+	BENCHMARK_CORPUS_COUNT
+};
+
+static const char *s_pBenchmarkCorpusText[BENCHMARK_CORPUS_COUNT] =
+{
+	"The quick brown fox jumps over the lazy dog while the server validates every chat message. ",
+	"L'\xC3\xA9t\xC3\xA9 dernier, nous sommes all\xC3\xA9s \xC3\xA0 la plage pr\xC3\xA8s de la for\xC3\xAAt, c'\xC3\xA9tait g\xC3\xA9nial. ",
+	"\xE6\x88\x91\xE4\xBB\xAC\xE5\x9C\xA8\xE6\xB8\xB8\xE6\x88\x8F\xE9\x87\x8C\xE8\x81\x8A\xE5\xA4\xA9\xEF\xBC\x8C"
+		"\xE6\x9C\x8D\xE5\x8A\xA1\xE5\x99\xA8\xE6\xA3\x80\xE6\x9F\xA5\xE6\xAF\x8F\xE4\xB8\x80\xE6\x9D\xA1\xE6\xB6\x88\xE6\x81\xAF\xE3\x80\x82 ",
+	"gg wp, that was a close round \xE2\x80\x94 rematch? \xF0\x9F\x98\x80",
+};
+
+static const char *GetBenchmarkCorpus( EBenchmarkCorpus eCorpus, int *pnBytes )
+{
+	static CUtlVector< char > s_Corpora[BENCHMARK_CORPUS_COUNT];
+
+	CUtlVector< char > &corpus = s_Corpora[eCorpus];
+	if ( !corpus.Count() )
+	{
+		const char *pText = s_pBenchmarkCorpusText[eCorpus];
+		int nTextLength = strlen( pText );
+		int nTargetLength = ( eCorpus == BENCHMARK_CORPUS_CHAT ) ? nTextLength : s_nBenchmarkCorpusBytes;
+
+		while ( corpus.Count() + nTextLength <= nTargetLength )
+		{
+			corpus.AddMultipleToTail( nTextLength, pText );
+		}
+		corpus.AddToTail( 0 );
+	}
+
+	*pnBytes = corpus.Count() - 1;
+	return corpus.Base();
+}
+
+static void BenchmarkUnicodeValidate( BenchmarkState &state, EBenchmarkCorpus eCorpus, int nLevel )
+{
+	int nBytes;
+	const char *pCorpus = GetBenchmarkCorpus( eCorpus, &nBytes );
+	Q_UnicodeSetSIMDLevel( nLevel );
+
+	while ( state.KeepRunning() )
+	{
+		BenchmarkDoNotOptimize( Q_UnicodeValidate( pCorpus ) );
+	}
+
+	state.SetBytesProcessed( state.Iterations() * nBytes );
+	Q_UnicodeSetSIMDLevel( 2 );
+}
+
+static void BenchmarkUnicodeLength( BenchmarkState &state, EBenchmarkCorpus eCorpus, int nLevel )
+{
+	int nBytes;
+	const char *pCorpus = GetBenchmarkCorpus( eCorpus, &nBytes );
+	Q_UnicodeSetSIMDLevel( nLevel );
+
+	while ( state.KeepRunning() )
+	{
+		BenchmarkDoNotOptimize( Q_UnicodeLength( pCorpus ) );
+	}
+
+	state.SetBytesProcessed( state.Iterations() * nBytes );
+	Q_UnicodeSetSIMDLevel( 2 );
+}
+
+static void BenchmarkUTF8ToUTF16( BenchmarkState &state, EBenchmarkCorpus eCorpus, int nLevel )
+{
+	int nBytes;
+	const char *pCorpus = GetBenchmarkCorpus( eCorpus, &nBytes );
+	CUtlVector< uchar16 > output;
+	output.SetCount( nBytes + 1 );
+	Q_UnicodeSetSIMDLevel( nLevel );
+
+	while ( state.KeepRunning() )
+	{
+		BenchmarkDoNotOptimize( Q_UTF8ToUTF16( pCorpus, output.Base(), output.Count() * sizeof( uchar16 ), STRINGCONVERT_REPLACE ) );
+	}
+
+	state.SetBytesProcessed( state.Iterations() * nBytes );
+	Q_UnicodeSetSIMDLevel( 2 );
+}
+
+static void BenchmarkUTF8ToUTF32( BenchmarkState &state, EBenchmarkCorpus eCorpus, int nLevel )
+{
+	int nBytes;
+	const char *pCorpus = GetBenchmarkCorpus( eCorpus, &nBytes );
+	CUtlVector< uchar32 > output;
+	output.SetCount( nBytes + 1 );
+	Q_UnicodeSetSIMDLevel( nLevel );
+
+	while ( state.KeepRunning() )
+	{
+		BenchmarkDoNotOptimize( Q_UTF8ToUTF32( pCorpus, output.Base(), output.Count() * sizeof( uchar32 ), STRINGCONVERT_REPLACE ) );
+	}
+
+	state.SetBytesProcessed( state.Iterations() * nBytes );
+	Q_UnicodeSetSIMDLevel( 2 );
+}
+
+#define REGISTER_UNICODE_BENCHMARKS( function, corpus, corpus_name ) \
+	REGISTER_NAMED_BENCHMARK( "Q_" #function "/" corpus_name "/scalar", function##_##corpus##_Scalar ) \
+	{ \
+		Benchmark##function( state, BENCHMARK_CORPUS_##corpus, 0 ); \
+	} \
+	REGISTER_NAMED_BENCHMARK( "Q_" #function "/" corpus_name "/SSE4.1", function##_##corpus##_SSE41 ) \
+	{ \
+		Benchmark##function( state, BENCHMARK_CORPUS_##corpus, 1 ); \
+	} \
+	REGISTER_NAMED_BENCHMARK( "Q_" #function "/" corpus_name "/AVX2", function##_##corpus##_AVX2 ) \
+	{ \
+		Benchmark##function( state, BENCHMARK_CORPUS_##corpus, 2 ); \
+	}
+
+REGISTER_UNICODE_BENCHMARKS( UnicodeValidate, ASCII, "ASCII 64KB" )
+REGISTER_UNICODE_BENCHMARKS( UnicodeValidate, LATIN, "Latin 64KB" )
+REGISTER_UNICODE_BENCHMARKS( UnicodeValidate, CJK, "CJK 64KB" )
+REGISTER_UNICODE_BENCHMARKS( UnicodeValidate, CHAT, "chat line" )
+
+REGISTER_UNICODE_BENCHMARKS( UnicodeLength, ASCII, "ASCII 64KB" )
+REGISTER_UNICODE_BENCHMARKS( UnicodeLength, LATIN, "Latin 64KB" )
+REGISTER_UNICODE_BENCHMARKS( UnicodeLength, CJK, "CJK 64KB" )
+
+REGISTER_UNICODE_BENCHMARKS( UTF8ToUTF16, ASCII, "ASCII 64KB" )
+REGISTER_UNICODE_BENCHMARKS( UTF8ToUTF16, LATIN, "Latin 64KB" )
+REGISTER_UNICODE_BENCHMARKS( UTF8ToUTF16, CJK, "CJK 64KB" )
+REGISTER_UNICODE_BENCHMARKS( UTF8ToUTF16, CHAT, "chat line" )
+
+REGISTER_UNICODE_BENCHMARKS( UTF8ToUTF32, ASCII, "ASCII 64KB" )
+REGISTER_UNICODE_BENCHMARKS( UTF8ToUTF32, LATIN, "Latin 64KB" )
+REGISTER_UNICODE_BENCHMARKS( UTF8ToUTF32, CJK, "CJK 64KB" )
@@ -0,0 +1,136 @@
+#include "common/benchmark.h"
+
+#include <tier0/basetypes.h>
+#include <tier0/cache_hints.h>
+#include <tier0/threadtools.h>
+#include <threads.h>
+
+#include <mutex>
+
+// RunThreadsOnIndividual's old GetThreadWork took a critical section per item, which is what
+// the mutex dispenser below does; the other one is the CThreadWorkDispenser it uses now. The
+// items are a few dozen cycles each, about as small as the tools' work gets, so the numbers
+// are mostly the cost of handing them out. Past the machine's core count the threads just
+// time-slice, so only the counts up to it say anything about scaling.
+
+static const int s_nBenchmarkWorkItems = 1 << 20;
+
+class CMutexWorkDispenser
+{
+public:
+	void Init( int nWorkCount )
+	{
+		m_nDispatch = 0;
+		m_nWorkCount = nWorkCount;
+	}
+
+	int GetThreadWork()
+	{
+		std::lock_guard< std::mutex > lock( m_Mutex );
+
+		if ( m_nDispatch == m_nWorkCount )
+			return -1;
+
+		return m_nDispatch++;
+	}
+
+private:
+	std::mutex m_Mutex;
+	int m_nDispatch;
+	int m_nWorkCount;
+};
+
+struct BenchmarkWorkThread_t
+{
+	CMutexWorkDispenser *m_pMutexDispenser;
+	CThreadWorkDispenser *m_pDispenser;
+	uint32 m_nResult;
+	byte m_Pad[CACHE_LINE_SIZE];
+};
+
+static inline uint32 BenchmarkWorkItem( uint32 nResult, int iWorkItem )
+{
+	uint32 nHash = iWorkItem * 2654435761u;
+	return nResult + ( nHash ^ ( nHash >> 15 ) );
+}
+
+static uintp MutexWorkThreadFn( void *pParam )
+{
+	BenchmarkWorkThread_t *pThread = ( BenchmarkWorkThread_t * )pParam;
+
+	int iWorkItem;
+	while ( ( iWorkItem = pThread->m_pMutexDispenser->GetThreadWork() ) != -1 )
+	{
+		pThread->m_nResult = BenchmarkWorkItem( pThread->m_nResult, iWorkItem );
+	}
+
+	return 0;
+}
+
+static uintp DispenserWorkThreadFn( void *pParam )
+{
+	BenchmarkWorkThread_t *pThread = ( BenchmarkWorkThread_t * )pParam;
+
+	int nStart, nEnd;
+	while ( pThread->m_pDispenser->GetChunk( &nStart, &nEnd ) )
+	{
+		for ( int iWorkItem = nStart; iWorkItem < nEnd; iWorkItem++ )
+		{
+			pThread->m_nResult = BenchmarkWorkItem( pThread->m_nResult, iWorkItem );
+		}
+	}
+
+	return 0;
+}
+
+static void BenchmarkRunThreads( BenchmarkState &state, int nThreads, bool bMutex )
+{
+	CMutexWorkDispenser mutexDispenser;
+	CThreadWorkDispenser dispenser;
+	BenchmarkWorkThread_t threadData[MAX_TOOL_THREADS];
+	ThreadHandle_t hThreads[MAX_TOOL_THREADS];
+
+	while ( state.KeepRunning() )
+	{
+		mutexDispenser.Init( s_nBenchmarkWorkItems );
+		dispenser.Init( s_nBenchmarkWorkItems, nThreads );
+
+		for ( int i = 0; i < nThreads; i++ )
+		{
+			threadData[i].m_pMutexDispenser = &mutexDispenser;
+			threadData[i].m_pDispenser = &dispenser;
+			threadData[i].m_nResult = 0;
+			hThreads[i] = CreateSimpleThread( bMutex ? MutexWorkThreadFn : DispenserWorkThreadFn, &threadData[i] );
+		}
+
+		uint32 nResult = 0;
+		for ( int i = 0; i < nThreads; i++ )
+		{
+			ThreadJoin( hThreads[i] );
+			ReleaseThreadHandle( hThreads[i] );
+			nResult += threadData[i].m_nResult;
+		}
+
+		BenchmarkDoNotOptimize( nResult );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkWorkItems );
+}
+
+#define REGISTER_RUN_THREADS_BENCHMARKS( threads ) \
+	REGISTER_NAMED_BENCHMARK( "Mutex::GetThreadWork/1M/" #threads " threads", Mutex_GetThreadWork_1M_##threads ) \
+	{ \
+		BenchmarkRunThreads( state, threads, true ); \
+	} \
+	REGISTER_NAMED_BENCHMARK( "CThreadWorkDispenser::GetChunk/1M/" #threads " threads", CThreadWorkDispenser_GetChunk_1M_##threads ) \
+	{ \
+		BenchmarkRunThreads( state, threads, false ); \
+	}
+
+REGISTER_RUN_THREADS_BENCHMARKS( 1 )
+REGISTER_RUN_THREADS_BENCHMARKS( 2 )
+REGISTER_RUN_THREADS_BENCHMARKS( 4 )
+REGISTER_RUN_THREADS_BENCHMARKS( 8 )
+REGISTER_RUN_THREADS_BENCHMARKS( 16 )
+REGISTER_RUN_THREADS_BENCHMARKS( 32 )
+REGISTER_RUN_THREADS_BENCHMARKS( 64 )
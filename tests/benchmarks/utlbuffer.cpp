@@ -0,0 +1,112 @@
+#include "common/benchmark.h"
+#include "benchmarks/containers.h"
+
+#include <tier0/utlbuffer.h>
+
+// A byte stream rather than a keyed container: insert appends, find seeks to a
+// record and reads it, iterate reads every record in order and erase clears the
+// whole stream, the way a reused network or save buffer is emptied.
+
+static void FillBenchmarkBuffer( CUtlBuffer &buf )
+{
+	const int *pKeys = GetContainerBenchmarkKeys();
+	for ( int i = 0; i < s_nContainerBenchmarkSize; i++ )
+	{
+		buf.PutInt( pKeys[i] );
+	}
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlBuffer/Insert", CUtlBuffer_Insert )
+{
+	CUtlBuffer buf;
+
+	while ( state.KeepRunning() )
+	{
+		buf.Clear();
+		FillBenchmarkBuffer( buf );
+	}
+
+	BenchmarkDoNotOptimize( buf.TellPut() );
+	state.SetItemsProcessed( state.Iterations() * s_nContainerBenchmarkSize );
+	state.SetBytesProcessed( state.Iterations() * s_nContainerBenchmarkSize * ( long long )sizeof( int ) );
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlBuffer/Insert string", CUtlBuffer_InsertString )
+{
+	CUtlBuffer buf;
+	long long nBytes = 0;
+
+	while ( state.KeepRunning() )
+	{
+		buf.Clear();
+		for ( int i = 0; i < s_nContainerBenchmarkSize; i++ )
+		{
+			buf.PutString( GetContainerBenchmarkName( i ) );
+		}
+
+		nBytes += buf.TellPut();
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nContainerBenchmarkSize );
+	state.SetBytesProcessed( nBytes );
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlBuffer/Find", CUtlBuffer_Find )
+{
+	CUtlBuffer buf;
+	FillBenchmarkBuffer( buf );
+
+	const int *pKeys = GetContainerBenchmarkKeys();
+	while ( state.KeepRunning() )
+	{
+		int nSum = 0;
+		for ( int i = 0; i < s_nContainerBenchmarkSize; i++ )
+		{
+			buf.SeekGet( CUtlBuffer::SEEK_HEAD, ( pKeys[i] >> 4 ) * ( int )sizeof( int ) );
+			nSum += buf.GetInt();
+		}
+
+		BenchmarkDoNotOptimize( nSum );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nContainerBenchmarkSize );
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlBuffer/Iterate", CUtlBuffer_Iterate )
+{
+	CUtlBuffer buf;
+	FillBenchmarkBuffer( buf );
+
+	while ( state.KeepRunning() )
+	{
+		buf.SeekGet( CUtlBuffer::SEEK_HEAD, 0 );
+
+		int nSum = 0;
+		for ( int i = 0; i < s_nContainerBenchmarkSize; i++ )
+		{
+			nSum += buf.GetInt();
+		}
+
+		BenchmarkDoNotOptimize( nSum );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nContainerBenchmarkSize );
+	state.SetBytesProcessed( state.Iterations() * s_nContainerBenchmarkSize * ( long long )sizeof( int ) );
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlBuffer/Erase", CUtlBuffer_Erase )
+{
+	CUtlBuffer buf;
+
+	while ( state.KeepRunning() )
+	{
+		state.PauseTiming();
+		FillBenchmarkBuffer( buf );
+		state.ResumeTiming();
+
+		buf.Clear();
+	}
+
+	BenchmarkDoNotOptimize( buf.TellPut() );
+	state.SetItemsProcessed( state.Iterations() * s_nContainerBenchmarkSize );
+}
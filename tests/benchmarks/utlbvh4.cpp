@@ -0,0 +1,343 @@
+#include "common/benchmark.h"
+
+#include <tier1/utlbvh4.h>
+
+// CUtlSphereTree needs collisionutils.h, which not every checkout of the SDK ships
+#if __has_include( <collisionutils.h> )
+#include <tier1/utlspheretree.h>
+#define BENCHMARK_SPHERE_TREE 1
+#endif
+
+#include <math.h>
+
+// The same 100k primitives in both trees: CUtlSphereTree gets the bounding sphere of
+// each box, CUtlBVH4 the box itself. Queries are run in batches of s_nBenchmarkQueries
+// and a linear scan over the boxes gives the baseline.
+
+static const int s_nBenchmarkPrimitives = 100000;
+static const int s_nBenchmarkQueries = 256;
+
+struct BenchmarkScene_t
+{
+	CUtlVector< CUtlBVH4::Primitive_t > m_Primitives;
+	CUtlVector< Vector4D > m_Spheres;
+	CUtlVector< const void * > m_Data;
+	Vector4D m_QuerySpheres[s_nBenchmarkQueries];
+	Vector m_RayStarts[s_nBenchmarkQueries];
+	Vector m_RayDeltas[s_nBenchmarkQueries];
+	Vector4D m_CutPlanes[4];
+};
+
+static float BenchmarkRandom( uint32 &nSeed )
+{
+	nSeed = nSeed * 1664525 + 1013904223;
+	return ( ( nSeed >> 8 ) & 0xffff ) * ( 1.0f / 65536.0f );
+}
+
+static BenchmarkScene_t &GetBenchmarkScene()
+{
+	static BenchmarkScene_t s_Scene;
+	static bool s_bInitialized = false;
+
+	if ( !s_bInitialized )
+	{
+		uint32 nSeed = 12345;
+
+		s_Scene.m_Primitives.SetCount( s_nBenchmarkPrimitives );
+		s_Scene.m_Spheres.SetCount( s_nBenchmarkPrimitives );
+		s_Scene.m_Data.SetCount( s_nBenchmarkPrimitives );
+
+		for ( int i = 0; i < s_nBenchmarkPrimitives; i++ )
+		{
+			// Mostly small props with the odd large one, spread over a 16k x 16k x 2k world
+			Vector vCenter( BenchmarkRandom( nSeed ) * 16000.0f - 8000.0f, BenchmarkRandom( nSeed ) * 16000.0f - 8000.0f, BenchmarkRandom( nSeed ) * 2000.0f - 1000.0f );
+			float flScale = ( i % 50 ) ? 8.0f + BenchmarkRandom( nSeed ) * 32.0f : 128.0f + BenchmarkRandom( nSeed ) * 256.0f;
+			Vector vExtents( flScale * ( 0.5f + BenchmarkRandom( nSeed ) ), flScale * ( 0.5f + BenchmarkRandom( nSeed ) ), flScale * ( 0.5f + BenchmarkRandom( nSeed ) ) );
+
+			CUtlBVH4::Primitive_t &prim = s_Scene.m_Primitives[i];
+			prim.m_vMins = vCenter - vExtents;
+			prim.m_vMaxs = vCenter + vExtents;
+			prim.m_pData = ( const void * )( intp )( i + 1 );
+
+			s_Scene.m_Spheres[i].Init( vCenter.x, vCenter.y, vCenter.z, vExtents.Length() );
+			s_Scene.m_Data[i] = prim.m_pData;
+		}
+
+		for ( int i = 0; i < s_nBenchmarkQueries; i++ )
+		{
+			s_Scene.m_QuerySpheres[i].Init( BenchmarkRandom( nSeed ) * 16000.0f - 8000.0f, BenchmarkRandom( nSeed ) * 16000.0f - 8000.0f, BenchmarkRandom( nSeed ) * 2000.0f - 1000.0f, 64.0f + BenchmarkRandom( nSeed ) * 448.0f );
+
+			s_Scene.m_RayStarts[i].Init( BenchmarkRandom( nSeed ) * 16000.0f - 8000.0f, BenchmarkRandom( nSeed ) * 16000.0f - 8000.0f, BenchmarkRandom( nSeed ) * 2000.0f - 1000.0f );
+			s_Scene.m_RayDeltas[i].Init( BenchmarkRandom( nSeed ) * 4000.0f - 2000.0f, BenchmarkRandom( nSeed ) * 4000.0f - 2000.0f, BenchmarkRandom( nSeed ) * 400.0f - 200.0f );
+		}
+
+		// Roughly a 90 degree view cone looking down +x from the origin, 4000 units deep
+		s_Scene.m_CutPlanes[0].Init( M_SQRT1_2, M_SQRT1_2, 0.0f, 0.0f );
+		s_Scene.m_CutPlanes[1].Init( M_SQRT1_2, -M_SQRT1_2, 0.0f, 0.0f );
+		s_Scene.m_CutPlanes[2].Init( -1.0f, 0.0f, 0.0f, -4000.0f );
+		s_Scene.m_CutPlanes[3].Init( 0.0f, 0.0f, -1.0f, -500.0f );
+
+		s_bInitialized = true;
+	}
+
+	return s_Scene;
+}
+
+static const CUtlBVH4 &GetBenchmarkBVH()
+{
+	static CUtlBVH4 s_Tree;
+
+	if ( !s_Tree.Count() )
+	{
+		const BenchmarkScene_t &scene = GetBenchmarkScene();
+		s_Tree.Build( scene.m_Primitives.Base(), scene.m_Primitives.Count(), 4 );
+	}
+
+	return s_Tree;
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlBVH4::Build/100000", CUtlBVH4_Build_100000 )
+{
+	const BenchmarkScene_t &scene = GetBenchmarkScene();
+	CUtlBVH4 tree;
+
+	while ( state.KeepRunning() )
+	{
+		tree.Build( scene.m_Primitives.Base(), scene.m_Primitives.Count() );
+		BenchmarkDoNotOptimize( tree.NodeCount() );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkPrimitives );
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlBVH4::Build/100000/threads:4", CUtlBVH4_Build_100000_Threads4 )
+{
+	const BenchmarkScene_t &scene = GetBenchmarkScene();
+	CUtlBVH4 tree;
+
+	while ( state.KeepRunning() )
+	{
+		tree.Build( scene.m_Primitives.Base(), scene.m_Primitives.Count(), 4 );
+		BenchmarkDoNotOptimize( tree.NodeCount() );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkPrimitives );
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlBVH4::Refit/100000", CUtlBVH4_Refit_100000 )
+{
+	const BenchmarkScene_t &scene = GetBenchmarkScene();
+	CUtlBVH4 tree;
+	tree.Build( scene.m_Primitives.Base(), scene.m_Primitives.Count() );
+
+	while ( state.KeepRunning() )
+	{
+		for ( int i = 0; i < s_nBenchmarkPrimitives; i++ )
+		{
+			tree.SetPrimitiveBounds( i, scene.m_Primitives[i].m_vMins, scene.m_Primitives[i].m_vMaxs );
+		}
+
+		tree.Refit();
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkPrimitives );
+}
+
+REGISTER_NAMED_BENCHMARK( "BruteForce::IntersectWithSphere/100000", BruteForce_IntersectWithSphere_100000 )
+{
+	const BenchmarkScene_t &scene = GetBenchmarkScene();
+	CUtlVector< void * > result;
+
+	while ( state.KeepRunning() )
+	{
+		int nHits = 0;
+		for ( int q = 0; q < s_nBenchmarkQueries; q++ )
+		{
+			const Vector4D &sphere = scene.m_QuerySpheres[q];
+			result.RemoveAll();
+
+			for ( int i = 0; i < s_nBenchmarkPrimitives; i++ )
+			{
+				const CUtlBVH4::Primitive_t &prim = scene.m_Primitives[i];
+				float flDistSqr = 0.0f;
+				for ( int c = 0; c < 3; c++ )
+				{
+					float flDist = MAX( MAX( prim.m_vMins[c] - sphere[c], sphere[c] - prim.m_vMaxs[c] ), 0.0f );
+					flDistSqr += flDist * flDist;
+				}
+
+				if ( flDistSqr <= sphere.w * sphere.w )
+					result.AddToTail( ( void * )prim.m_pData );
+			}
+
+			nHits += result.Count();
+		}
+
+		BenchmarkDoNotOptimize( nHits );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkQueries );
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlBVH4::IntersectWithSphere/100000", CUtlBVH4_IntersectWithSphere_100000 )
+{
+	const BenchmarkScene_t &scene = GetBenchmarkScene();
+	const CUtlBVH4 &tree = GetBenchmarkBVH();
+	CUtlVector< void * > result;
+
+	while ( state.KeepRunning() )
+	{
+		int nHits = 0;
+		for ( int q = 0; q < s_nBenchmarkQueries; q++ )
+		{
+			nHits += tree.IntersectWithSphere( scene.m_QuerySpheres[q], true, result );
+		}
+
+		BenchmarkDoNotOptimize( nHits );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkQueries );
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlBVH4::IntersectWithRay/100000", CUtlBVH4_IntersectWithRay_100000 )
+{
+	const BenchmarkScene_t &scene = GetBenchmarkScene();
+	const CUtlBVH4 &tree = GetBenchmarkBVH();
+	CUtlVector< void * > result;
+
+	while ( state.KeepRunning() )
+	{
+		int nHits = 0;
+		for ( int q = 0; q < s_nBenchmarkQueries; q++ )
+		{
+			nHits += tree.IntersectWithRay( scene.m_RayStarts[q], scene.m_RayDeltas[q], result );
+		}
+
+		BenchmarkDoNotOptimize( nHits );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkQueries );
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlBVH4::CutByPlanes/100000", CUtlBVH4_CutByPlanes_100000 )
+{
+	const BenchmarkScene_t &scene = GetBenchmarkScene();
+	const CUtlBVH4 &tree = GetBenchmarkBVH();
+	CUtlBVH4::Cut cut( &tree );
+	CUtlVector< void * > result;
+
+	while ( state.KeepRunning() )
+	{
+		tree.CutByPlanes( &cut, NULL, CUtlBVH4::Cut::PARTIAL_INTERSECTIONS, scene.m_CutPlanes, ARRAYSIZE( scene.m_CutPlanes ) );
+		BenchmarkDoNotOptimize( cut.GetLeaves( result ) );
+	}
+
+	state.SetItemsProcessed( state.Iterations() );
+}
+
+#ifdef BENCHMARK_SPHERE_TREE
+
+static const CUtlSphereTree &GetBenchmarkSphereTree()
+{
+	static CUtlSphereTree s_Tree;
+	static bool s_bInitialized = false;
+
+	if ( !s_bInitialized )
+	{
+		const BenchmarkScene_t &scene = GetBenchmarkScene();
+		for ( int i = 0; i < s_nBenchmarkPrimitives; i++ )
+		{
+			s_Tree.Insert( scene.m_Data[i], &scene.m_Spheres[i] );
+		}
+
+		s_bInitialized = true;
+	}
+
+	return s_Tree;
+}
+
+// Inserting 100k spheres takes seconds, far longer than the harness runs a benchmark for, so the
+// tree is built up front rather than by whichever query benchmark happens to run first
+static const CUtlSphereTree &s_BenchmarkSphereTree = GetBenchmarkSphereTree();
+
+REGISTER_NAMED_BENCHMARK( "CUtlSphereTree::Insert/100000", CUtlSphereTree_Insert_100000 )
+{
+	const BenchmarkScene_t &scene = GetBenchmarkScene();
+	CUtlSphereTree tree;
+
+	while ( state.KeepRunning() )
+	{
+		tree.RemoveAll();
+		for ( int i = 0; i < s_nBenchmarkPrimitives; i++ )
+		{
+			tree.Insert( scene.m_Data[i], &scene.m_Spheres[i] );
+		}
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkPrimitives );
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlSphereTree::IntersectWithSphere/100000", CUtlSphereTree_IntersectWithSphere_100000 )
+{
+	const BenchmarkScene_t &scene = GetBenchmarkScene();
+	const CUtlSphereTree &tree = s_BenchmarkSphereTree;
+	CUtlVector< void * > result;
+
+	while ( state.KeepRunning() )
+	{
+		int nHits = 0;
+		for ( int q = 0; q < s_nBenchmarkQueries; q++ )
+		{
+			nHits += tree.IntersectWithSphere( scene.m_QuerySpheres[q], true, result );
+		}
+
+		BenchmarkDoNotOptimize( nHits );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkQueries );
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlSphereTree::IntersectWithRay/100000", CUtlSphereTree_IntersectWithRay_100000 )
+{
+	const BenchmarkScene_t &scene = GetBenchmarkScene();
+	const CUtlSphereTree &tree = s_BenchmarkSphereTree;
+	CUtlVector< void * > result;
+
+	while ( state.KeepRunning() )
+	{
+		int nHits = 0;
+		for ( int q = 0; q < s_nBenchmarkQueries; q++ )
+		{
+			Vector vStart = scene.m_RayStarts[q], vDelta = scene.m_RayDeltas[q];
+			nHits += tree.IntersectWithRay( vStart, vDelta, result );
+		}
+
+		BenchmarkDoNotOptimize( nHits );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkQueries );
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlSphereTree::CutByPlanes/100000", CUtlSphereTree_CutByPlanes_100000 )
+{
+	const BenchmarkScene_t &scene = GetBenchmarkScene();
+	const CUtlSphereTree &tree = s_BenchmarkSphereTree;
+	CUtlSphereTree::Cut cut( &tree );
+	CUtlVector< void * > result;
+	Vector4D planes[ARRAYSIZE( scene.m_CutPlanes )];
+
+	for ( int i = 0; i < ARRAYSIZE( planes ); i++ )
+	{
+		planes[i] = scene.m_CutPlanes[i];
+	}
+
+	while ( state.KeepRunning() )
+	{
+		tree.CutByPlanes( &cut, NULL, CUtlSphereTree::Cut::PARTIAL_INTERSECTIONS, planes, ARRAYSIZE( planes ) );
+		BenchmarkDoNotOptimize( cut.GetLeaves( result ) );
+	}
+
+	state.SetItemsProcessed( state.Iterations() );
+}
+
+#endif // BENCHMARK_SPHERE_TREE
@@ -0,0 +1,137 @@
+#include "common/benchmark.h"
+
+#include <tier1/utlintervaltree.h>
+
+// 100k intervals over [0, 1000000), mostly short with the odd long one, probed by
+// s_nBenchmarkQueries short intervals either one call at a time or in one batch.
+
+typedef CUtlIntervalTree< int, float > BenchmarkTree_t;
+
+static const int s_nBenchmarkIntervals = 100000;
+static const int s_nBenchmarkQueries = 1024;
+
+struct BenchmarkIntervals_t
+{
+	CUtlVector< BenchmarkTree_t::Value_t > m_Intervals;
+	BenchmarkTree_t::Interval_t m_Checks[s_nBenchmarkQueries];
+	BenchmarkTree_t m_Tree;
+};
+
+static float BenchmarkRandom( uint32 &nSeed )
+{
+	nSeed = nSeed * 1664525 + 1013904223;
+	return ( ( nSeed >> 8 ) & 0xffff ) * ( 1.0f / 65536.0f );
+}
+
+static BenchmarkIntervals_t &GetBenchmarkIntervals()
+{
+	static BenchmarkIntervals_t s_Intervals;
+	static bool s_bInitialized = false;
+
+	if ( !s_bInitialized )
+	{
+		uint32 nSeed = 12345;
+
+		s_Intervals.m_Intervals.SetCount( s_nBenchmarkIntervals );
+
+		for ( int i = 0; i < s_nBenchmarkIntervals; i++ )
+		{
+			float flLow = ( BenchmarkRandom( nSeed ) + BenchmarkRandom( nSeed ) * ( 1.0f / 65536.0f ) ) * 1000000.0f;
+			float flLength = ( i % 100 ) ? BenchmarkRandom( nSeed ) * 40.0f : BenchmarkRandom( nSeed ) * 20000.0f;
+
+			s_Intervals.m_Intervals[i].SetLowVal( flLow );
+			s_Intervals.m_Intervals[i].SetHighVal( flLow + flLength );
+			s_Intervals.m_Intervals[i].m_Data = i;
+		}
+
+		for ( int i = 0; i < s_nBenchmarkQueries; i++ )
+		{
+			float flLow = BenchmarkRandom( nSeed ) * 1000000.0f;
+			s_Intervals.m_Checks[i].SetLowVal( flLow );
+			s_Intervals.m_Checks[i].SetHighVal( flLow + BenchmarkRandom( nSeed ) * 200.0f );
+		}
+
+		CUtlVector< BenchmarkTree_t::Value_t > input;
+		input.AddMultipleToTail( s_nBenchmarkIntervals, s_Intervals.m_Intervals.Base() );
+		s_Intervals.m_Tree.BuildTree( input.Base(), input.Count() );
+
+		s_bInitialized = true;
+	}
+
+	return s_Intervals;
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlIntervalTree::FindOverlaps/100k", CUtlIntervalTree_FindOverlaps_100k )
+{
+	const BenchmarkIntervals_t &intervals = GetBenchmarkIntervals();
+	CUtlVector< BenchmarkTree_t::Value_t > results;
+
+	while ( state.KeepRunning() )
+	{
+		results.RemoveAll();
+
+		for ( int i = 0; i < s_nBenchmarkQueries; i++ )
+		{
+			intervals.m_Tree.FindOverlaps( intervals.m_Checks[i], results, false );
+		}
+
+		BenchmarkDoNotOptimize( results.Count() );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkQueries );
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlIntervalTree::FindOverlaps/100k/Batch", CUtlIntervalTree_FindOverlaps_100k_Batch )
+{
+	const BenchmarkIntervals_t &intervals = GetBenchmarkIntervals();
+	CUtlVector< BenchmarkTree_t::Value_t > results;
+	static int s_nResultStarts[s_nBenchmarkQueries + 1];
+
+	while ( state.KeepRunning() )
+	{
+		results.RemoveAll();
+		intervals.m_Tree.FindOverlaps( intervals.m_Checks, s_nBenchmarkQueries, results, s_nResultStarts );
+
+		BenchmarkDoNotOptimize( results.Count() );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkQueries );
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlIntervalTree::BuildTree/100k", CUtlIntervalTree_BuildTree_100k )
+{
+	const BenchmarkIntervals_t &intervals = GetBenchmarkIntervals();
+	CUtlVector< BenchmarkTree_t::Value_t > input;
+	BenchmarkTree_t tree;
+
+	while ( state.KeepRunning() )
+	{
+		input.RemoveAll();
+		input.AddMultipleToTail( s_nBenchmarkIntervals, intervals.m_Intervals.Base() );
+		tree.BuildTree( input.Base(), input.Count() );
+
+		BenchmarkDoNotOptimize( tree.Count() );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkIntervals );
+}
+
+REGISTER_NAMED_BENCHMARK( "CUtlIntervalTree::Insert/100k", CUtlIntervalTree_Insert_100k )
+{
+	const BenchmarkIntervals_t &intervals = GetBenchmarkIntervals();
+	BenchmarkTree_t tree;
+
+	while ( state.KeepRunning() )
+	{
+		tree.RemoveAll();
+
+		for ( int i = 0; i < s_nBenchmarkIntervals; i++ )
+		{
+			tree.Insert( intervals.m_Intervals[i] );
+		}
+
+		BenchmarkDoNotOptimize( tree.Count() );
+	}
+
+	state.SetItemsProcessed( state.Iterations() * s_nBenchmarkIntervals );
+}
@@ -0,0 +1,101 @@
+#include "common/benchmark.h"
+
+#include <tier1/zoneprofiler.h>
+
+// What a zone costs the code it wraps: off, on, and a CMicroProfiler Begin/End pair
+// for scale, which is the same two timebase reads. The aggregator runs on the same
+// thread every few thousand zones, so the enabled rows include its share as well.
+
+static const int s_nZonesPerDrain = ZONE_PROFILER_RING_SIZE / 2;
+
+static CZoneProfilerAggregator &GetBenchmarkAggregator()
+{
+	static CZoneProfilerAggregator s_Aggregator;
+	return s_Aggregator;
+}
+
+static void BenchmarkZone( BenchmarkState &state, bool bEnabled )
+{
+	CZoneProfilerAggregator &aggregator = GetBenchmarkAggregator();
+	ZoneProfiler_Enable( bEnabled );
+
+	int nZones = 0;
+	while ( state.KeepRunning() )
+	{
+		{
+			ZONE_PROFILE( "BenchmarkZone" );
+			BenchmarkDoNotOptimize( nZones );
+		}
+
+		if ( ++nZones == s_nZonesPerDrain )
+		{
+			ZoneProfiler_FrameMark();
+			aggregator.Update();
+			nZones = 0;
+		}
+	}
+
+	ZoneProfiler_Enable( false );
+	aggregator.Update();
+	state.SetItemsProcessed( state.Iterations() );
+}
+
+REGISTER_NAMED_BENCHMARK( "ZONE_PROFILE/disabled", ZoneProfile_Disabled )
+{
+	BenchmarkZone( state, false );
+}
+
+REGISTER_NAMED_BENCHMARK( "ZONE_PROFILE/enabled", ZoneProfile_Enabled )
+{
+	BenchmarkZone( state, true );
+}
+
+REGISTER_NAMED_BENCHMARK( "ZONE_PROFILE/enabled nested 4", ZoneProfile_EnabledNested )
+{
+	CZoneProfilerAggregator &aggregator = GetBenchmarkAggregator();
+	ZoneProfiler_Enable( true );
+
+	int nZones = 0;
+	while ( state.KeepRunning() )
+	{
+		ZONE_PROFILE( "Outer" );
+		{
+			ZONE_PROFILE( "Middle" );
+			{
+				ZONE_PROFILE( "Inner" );
+				{
+					ZONE_PROFILE( "Leaf" );
+					BenchmarkDoNotOptimize( nZones );
+				}
+			}
+		}
+
+		nZones += 4;
+		if ( nZones >= s_nZonesPerDrain )
+		{
+			ZoneProfiler_FrameMark();
+			aggregator.Update();
+			nZones = 0;
+		}
+	}
+
+	ZoneProfiler_Enable( false );
+	aggregator.Update();
+	state.SetItemsProcessed( state.Iterations() * 4 );
+}
+
+REGISTER_NAMED_BENCHMARK( "CMicroProfiler/Begin End", CMicroProfiler_BeginEnd )
+{
+	CMicroProfiler profiler;
+	int nZones = 0;
+
+	while ( state.KeepRunning() )
+	{
+		profiler.Begin();
+		BenchmarkDoNotOptimize( nZones );
+		profiler.End();
+	}
+
+	BenchmarkDoNotOptimize( profiler.m_numCalls );
+	state.SetItemsProcessed( state.Iterations() );
+}
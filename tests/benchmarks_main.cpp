@@ -0,0 +1,7 @@
+#include "common/benchmark.h"
+#include "common/source2_main.h"
+
+int main( int argc, char **argv )
+{
+	Source2TestExit( RunAllBenchmarks( argc, argv ) );
+}
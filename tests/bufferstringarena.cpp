@@ -0,0 +1,136 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <tier1/bufferstringarena.h>
+
+#include <cstring>
+
+REGISTER_NAMED_TEST( "CArenaBufferString.OutsideScope", CArenaBufferString_OutsideScope )
+{
+	TEST_NULL( g_pBufferStringArena );
+
+	CArenaBufferString str;
+	TEST_FALSE( str.IsInArena() );
+
+	str.AppendFormat( "%s = %d", "sv_cheats", 1 );
+	TEST_TRUE( str == "sv_cheats = 1" );
+	TEST_EQ( str.Format( "%d", 42 ), 2 );
+	TEST_TRUE( str == "42" );
+}
+
+REGISTER_NAMED_TEST( "CArenaBufferString.ScopeNotEntered", CArenaBufferString_ScopeNotEntered )
+{
+	CBufferStringArenaScope scope( false );
+	TEST_NULL( g_pBufferStringArena );
+
+	CArenaBufferString str;
+	TEST_FALSE( str.IsInArena() );
+	TEST_FALSE( str.Reserve( 512 ) );
+	TEST_EQ( BufferStringArena_GetThread()->GetScopeDepth(), 0 );
+}
+
+REGISTER_NAMED_TEST( "CArenaBufferString.FormatInArena", CArenaBufferString_FormatInArena )
+{
+	CBufferStringArenaScope scope;
+	TEST_NOT_NULL( g_pBufferStringArena );
+
+	CArenaBufferString str;
+	TEST_TRUE( str.IsInArena() );
+	TEST_TRUE( str.IsEmpty() );
+
+	TEST_EQ( str.Format( "%s = %d", "mp_timelimit", 20 ), 17 );
+	TEST_TRUE( str == "mp_timelimit = 20" );
+	TEST_EQ( str.AppendFormat( " (%.1f)", 1.5 ), 23 );
+	TEST_TRUE( str == "mp_timelimit = 20 (1.5)" );
+
+	// Past the capacity it was made with, still in the arena
+	char szLong[1024];
+	memset( szLong, 'x', sizeof( szLong ) - 1 );
+	szLong[sizeof( szLong ) - 1] = '\0';
+
+	TEST_EQ( str.AppendFormat( "%s", szLong ), 23 + 1023 );
+	TEST_TRUE( str.IsInArena() );
+	TEST_TRUE( str.StartsWith( "mp_timelimit = 20 (1.5)xxx" ) );
+	TEST_TRUE( str.EndsWith( "xxx" ) );
+
+	// Grown by tier0 it moves to the heap, contents and all
+	CArenaBufferString small( 8 );
+	TEST_TRUE( small.IsInArena() );
+	small.Set( szLong, 100 );
+	TEST_FALSE( small.IsInArena() );
+	TEST_EQ( small.Length(), 100 );
+	TEST_EQ( strncmp( small.Get(), szLong, 100 ), 0 );
+}
+
+REGISTER_NAMED_TEST( "CArenaBufferString.LastInFirstOut", CArenaBufferString_LastInFirstOut )
+{
+	CBufferStringArenaScope scope;
+	CBufferStringArena *pArena = g_pBufferStringArena;
+
+	uint64 nStart = pArena->GetPosition();
+	const char *pFirst;
+	{
+		CArenaBufferString str;
+		str = "first";
+		pFirst = str.Get();
+		TEST_EQ( pArena->GetPosition(), nStart + CArenaBufferString::DEFAULT_CAPACITY + 1 );
+	}
+
+	TEST_EQ( pArena->GetPosition(), nStart );
+
+	CArenaBufferString again;
+	TEST_EQ( again.Get(), pFirst );
+
+	// The newest string grows where it is
+	TEST_TRUE( again.Reserve( 1000 ) );
+	TEST_EQ( again.Get(), pFirst );
+	TEST_TRUE( again.IsInArena() );
+}
+
+REGISTER_NAMED_TEST( "CArenaBufferString.ScopeExitPromotes", CArenaBufferString_ScopeExitPromotes )
+{
+	CArenaBufferString *pEscaped;
+	{
+		CBufferStringArenaScope outer;
+		uint64 nStart = g_pBufferStringArena->GetPosition();
+
+		CArenaBufferString kept;
+		kept = "outer";
+		{
+			CBufferStringArenaScope inner;
+
+			// Grown in the inner scope, it moves into the inner scope's part of the arena
+			TEST_TRUE( kept.Reserve( 4000 ) );
+			kept.AppendFormat( " grown %d", 1 );
+			TEST_TRUE( kept.IsInArena() );
+
+			pEscaped = new CArenaBufferString;
+			pEscaped->Format( "escaped %s", "string" );
+			TEST_TRUE( pEscaped->IsInArena() );
+		}
+
+		// Both were still in the inner scope's part, so they're on the heap now
+		TEST_FALSE( kept.IsInArena() );
+		TEST_TRUE( kept == "outer grown 1" );
+		TEST_FALSE( pEscaped->IsInArena() );
+		TEST_TRUE( *pEscaped == "escaped string" );
+
+		// What the outer scope made stays where it is
+		CArenaBufferString str;
+		str = "still outer";
+		{
+			CBufferStringArenaScope inner;
+			CArenaBufferString other;
+			other = "inner";
+		}
+		TEST_TRUE( str.IsInArena() );
+		TEST_TRUE( str == "still outer" );
+		TEST_TRUE( g_pBufferStringArena->GetPosition() > nStart );
+	}
+
+	TEST_NULL( g_pBufferStringArena );
+	TEST_TRUE( *pEscaped == "escaped string" );
+
+	// Destroyed outside any scope, it's only a heap string by now
+	delete pEscaped;
+}
@@ -0,0 +1,436 @@
+#include "common/benchmark.h"
+
+#include <tier0/microprofiler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static const long long s_nMaxBenchmarkIterations = 1000000000LL;
+
+struct BenchmarkOptions
+{
+	const char *m_pFilter = nullptr;
+	double m_flMinSeconds = 0.1;
+	int m_nWarmupRuns = 1;
+	int m_nRepetitions = 5;
+	const char *m_pJsonPath = nullptr;
+	const char *m_pBaselinePath = nullptr;
+};
+
+struct BenchmarkResult
+{
+	std::string m_Name;
+	long long m_nIterations;
+	int m_nRepetitions;
+	double m_flMinNs;
+	double m_flMedianNs;
+	double m_flMeanNs;
+	double m_flStdDevNs;
+	double m_flMedianTicks;
+	double m_flBytesPerSecond;
+	double m_flItemsPerSecond;
+};
+
+static BenchmarkRegistration *&GetBenchmarkList()
+{
+	static BenchmarkRegistration *s_pBenchmarks = nullptr;
+	return s_pBenchmarks;
+}
+
+void RegisterBenchmark( const char *pName, BenchmarkFunction pFunction )
+{
+	new BenchmarkRegistration( pName, pFunction );
+}
+
+BenchmarkRegistration::BenchmarkRegistration( const char *pName, BenchmarkFunction pFunction )
+ : m_pName( pName ),
+   m_pFunction( pFunction ),
+   m_pNext( GetBenchmarkList() )
+{
+	GetBenchmarkList() = this;
+}
+
+static double GetBenchmarkSeconds()
+{
+	return std::chrono::duration< double >( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+BenchmarkState::BenchmarkState( long long nIterations )
+ : m_nIterations( nIterations ),
+   m_nRemaining( nIterations ),
+   m_nBytesProcessed( 0 ),
+   m_nItemsProcessed( 0 ),
+   m_flPausedSeconds( 0.0 ),
+   m_nPausedTicks( 0 ),
+   m_flPauseStart( 0.0 ),
+   m_nPauseStartTicks( 0 )
+{
+}
+
+void BenchmarkState::PauseTiming()
+{
+	m_nPauseStartTicks = GetTimebaseRegister();
+	m_flPauseStart = GetBenchmarkSeconds();
+}
+
+void BenchmarkState::ResumeTiming()
+{
+	m_flPausedSeconds += GetBenchmarkSeconds() - m_flPauseStart;
+	m_nPausedTicks += GetTimebaseRegister() - m_nPauseStartTicks;
+}
+
+struct BenchmarkMeasurement
+{
+	double m_flSeconds;
+	double m_flTicks;
+};
+
+static BenchmarkMeasurement MeasureBenchmark( BenchmarkFunction pFunction, BenchmarkState &state )
+{
+	const double flStart = GetBenchmarkSeconds();
+	const unsigned long long nStartTicks = GetTimebaseRegister();
+	pFunction( state );
+	const unsigned long long nEndTicks = GetTimebaseRegister();
+	const double flEnd = GetBenchmarkSeconds();
+
+	BenchmarkMeasurement measurement;
+	measurement.m_flSeconds = std::max( flEnd - flStart - state.m_flPausedSeconds, 0.0 );
+	measurement.m_flTicks = ( double )( nEndTicks - nStartTicks - state.m_nPausedTicks );
+	return measurement;
+}
+
+// Finds an iteration count whose run takes at least flMinSeconds. The runs it
+// takes on the way also warm up caches, the allocator and the branch predictors.
+static long long CalibrateBenchmark( BenchmarkFunction pFunction, double flMinSeconds )
+{
+	long long nIterations = 1;
+
+	for ( ;; )
+	{
+		BenchmarkState state( nIterations );
+		const double flSeconds = MeasureBenchmark( pFunction, state ).m_flSeconds;
+
+		if ( flSeconds >= flMinSeconds || nIterations >= s_nMaxBenchmarkIterations )
+		{
+			return nIterations;
+		}
+
+		// Aim a bit past the target so the next measurement is usually the last one
+		const double flScale = flSeconds > 0.0 ? ( flMinSeconds * 1.4 ) / flSeconds : 100.0;
+		long long nNextIterations = ( long long )( ( double )nIterations * ( flScale < 100.0 ? flScale : 100.0 ) );
+
+		nIterations = nNextIterations > nIterations ? nNextIterations : nIterations + 1;
+
+		if ( nIterations > s_nMaxBenchmarkIterations )
+		{
+			nIterations = s_nMaxBenchmarkIterations;
+		}
+	}
+}
+
+static double GetMedian( std::vector< double > values )
+{
+	std::sort( values.begin(), values.end() );
+
+	const size_t nHalf = values.size() / 2;
+	return ( values.size() & 1 ) ? values[nHalf] : ( values[nHalf - 1] + values[nHalf] ) * 0.5;
+}
+
+static BenchmarkResult RunBenchmark( const BenchmarkRegistration *pBenchmark, const BenchmarkOptions &options )
+{
+	const long long nIterations = CalibrateBenchmark( pBenchmark->m_pFunction, options.m_flMinSeconds );
+
+	for ( int i = 0; i < options.m_nWarmupRuns; i++ )
+	{
+		BenchmarkState state( nIterations );
+		MeasureBenchmark( pBenchmark->m_pFunction, state );
+	}
+
+	std::vector< double > nsPerOp;
+	std::vector< double > ticksPerOp;
+	long long nBytesProcessed = 0;
+	long long nItemsProcessed = 0;
+
+	for ( int i = 0; i < options.m_nRepetitions; i++ )
+	{
+		BenchmarkState state( nIterations );
+		const BenchmarkMeasurement measurement = MeasureBenchmark( pBenchmark->m_pFunction, state );
+
+		nsPerOp.push_back( measurement.m_flSeconds * 1e9 / ( double )nIterations );
+		ticksPerOp.push_back( measurement.m_flTicks / ( double )nIterations );
+		nBytesProcessed = state.m_nBytesProcessed;
+		nItemsProcessed = state.m_nItemsProcessed;
+	}
+
+	BenchmarkResult result;
+	result.m_Name = pBenchmark->m_pName;
+	result.m_nIterations = nIterations;
+	result.m_nRepetitions = options.m_nRepetitions;
+	result.m_flMinNs = *std::min_element( nsPerOp.begin(), nsPerOp.end() );
+	result.m_flMedianNs = GetMedian( nsPerOp );
+	result.m_flMedianTicks = GetMedian( ticksPerOp );
+
+	double flSum = 0.0;
+	for ( double flNs : nsPerOp )
+	{
+		flSum += flNs;
+	}
+	result.m_flMeanNs = flSum / ( double )nsPerOp.size();
+
+	double flSquares = 0.0;
+	for ( double flNs : nsPerOp )
+	{
+		flSquares += ( flNs - result.m_flMeanNs ) * ( flNs - result.m_flMeanNs );
+	}
+	result.m_flStdDevNs = nsPerOp.size() > 1 ? std::sqrt( flSquares / ( double )( nsPerOp.size() - 1 ) ) : 0.0;
+
+	// Throughput is taken at the median, the totals being the same every repetition
+	const double flMedianSeconds = result.m_flMedianNs * ( double )nIterations * 1e-9;
+	result.m_flBytesPerSecond = ( nBytesProcessed && flMedianSeconds > 0.0 ) ? ( double )nBytesProcessed / flMedianSeconds : 0.0;
+	result.m_flItemsPerSecond = ( nItemsProcessed && flMedianSeconds > 0.0 ) ? ( double )nItemsProcessed / flMedianSeconds : 0.0;
+
+	return result;
+}
+
+static void WriteJsonString( FILE *pFile, const std::string &str )
+{
+	fputc( '"', pFile );
+
+	for ( unsigned char c : str )
+	{
+		if ( c == '"' || c == '\\' )
+		{
+			fputc( '\\', pFile );
+			fputc( c, pFile );
+		}
+		else if ( c < 0x20 )
+		{
+			fprintf( pFile, "\\u%04x", c );
+		}
+		else
+		{
+			fputc( c, pFile );
+		}
+	}
+
+	fputc( '"', pFile );
+}
+
+// One benchmark per line, so a baseline can be read back a line at a time
+static bool WriteJsonResults( const char *pPath, const BenchmarkOptions &options, const std::vector< BenchmarkResult > &results )
+{
+	FILE *pFile = fopen( pPath, "w" );
+	if ( !pFile )
+	{
+		return false;
+	}
+
+	fprintf( pFile, "{\n\"context\": {\"min_time\": %g, \"warmup\": %d, \"repetitions\": %d},\n\"benchmarks\": [\n", options.m_flMinSeconds, options.m_nWarmupRuns, options.m_nRepetitions );
+
+	for ( size_t i = 0; i < results.size(); i++ )
+	{
+		const BenchmarkResult &result = results[i];
+
+		fprintf( pFile, "{\"name\": " );
+		WriteJsonString( pFile, result.m_Name );
+		fprintf( pFile, ", \"iterations\": %lld, \"repetitions\": %d, \"median_ns\": %.4f, \"min_ns\": %.4f, \"mean_ns\": %.4f, \"stddev_ns\": %.4f, \"median_ticks\": %.4f, \"bytes_per_second\": %.1f, \"items_per_second\": %.1f}%s\n",
+		         result.m_nIterations, result.m_nRepetitions, result.m_flMedianNs, result.m_flMinNs, result.m_flMeanNs, result.m_flStdDevNs,
+		         result.m_flMedianTicks, result.m_flBytesPerSecond, result.m_flItemsPerSecond, ( i + 1 < results.size() ) ? "," : "" );
+	}
+
+	fprintf( pFile, "]\n}\n" );
+
+	const bool bWritten = !ferror( pFile );
+	fclose( pFile );
+	return bWritten;
+}
+
+struct BenchmarkBaseline
+{
+	std::string m_Name;
+	double m_flMedianNs;
+};
+
+// Reads back what WriteJsonResults wrote, it isn't a general JSON parser
+static bool ReadJsonBaseline( const char *pPath, std::vector< BenchmarkBaseline > &baseline )
+{
+	FILE *pFile = fopen( pPath, "r" );
+	if ( !pFile )
+	{
+		return false;
+	}
+
+	char szLine[4096];
+	while ( fgets( szLine, sizeof( szLine ), pFile ) )
+	{
+		const char *pName = strstr( szLine, "{\"name\": \"" );
+		const char *pMedian = strstr( szLine, "\"median_ns\": " );
+		if ( !pName || !pMedian )
+		{
+			continue;
+		}
+
+		BenchmarkBaseline entry;
+		for ( const char *p = pName + strlen( "{\"name\": \"" ); *p && *p != '"'; p++ )
+		{
+			if ( *p == '\\' && p[1] == 'u' && strlen( p ) >= 6 )
+			{
+				entry.m_Name += ( char )strtol( std::string( p + 2, 4 ).c_str(), nullptr, 16 );
+				p += 5;
+				continue;
+			}
+
+			if ( *p == '\\' && p[1] )
+			{
+				p++;
+			}
+
+			entry.m_Name += *p;
+		}
+
+		entry.m_flMedianNs = strtod( pMedian + strlen( "\"median_ns\": " ), nullptr );
+		baseline.push_back( entry );
+	}
+
+	fclose( pFile );
+	return true;
+}
+
+static const BenchmarkBaseline *FindBaseline( const std::vector< BenchmarkBaseline > &baseline, const char *pName )
+{
+	for ( const BenchmarkBaseline &entry : baseline )
+	{
+		if ( entry.m_Name == pName )
+		{
+			return &entry;
+		}
+	}
+
+	return nullptr;
+}
+
+static const char *GetBenchmarkOption( const char *pArg, const char *pOption )
+{
+	const size_t nLength = strlen( pOption );
+	return strncmp( pArg, pOption, nLength ) == 0 ? pArg + nLength : nullptr;
+}
+
+static bool ParseBenchmarkOptions( int argc, char **argv, BenchmarkOptions &options )
+{
+	for ( int i = 1; i < argc; i++ )
+	{
+		const char *pArg = argv[i];
+		const char *pValue;
+
+		if ( ( pValue = GetBenchmarkOption( pArg, "--filter=" ) ) != nullptr )
+		{
+			options.m_pFilter = pValue;
+		}
+		else if ( ( pValue = GetBenchmarkOption( pArg, "--min-time=" ) ) != nullptr )
+		{
+			options.m_flMinSeconds = std::max( atof( pValue ), 0.001 );
+		}
+		else if ( ( pValue = GetBenchmarkOption( pArg, "--warmup=" ) ) != nullptr )
+		{
+			options.m_nWarmupRuns = std::max( atoi( pValue ), 0 );
+		}
+		else if ( ( pValue = GetBenchmarkOption( pArg, "--repetitions=" ) ) != nullptr )
+		{
+			options.m_nRepetitions = std::max( atoi( pValue ), 1 );
+		}
+		else if ( ( pValue = GetBenchmarkOption( pArg, "--json=" ) ) != nullptr )
+		{
+			options.m_pJsonPath = pValue;
+		}
+		else if ( ( pValue = GetBenchmarkOption( pArg, "--baseline=" ) ) != nullptr )
+		{
+			options.m_pBaselinePath = pValue;
+		}
+		else
+		{
+			fprintf( stderr, "Unknown benchmark option \"%s\"\n"
+			                 "Options: --filter=<text> --min-time=<seconds> --warmup=<count> --repetitions=<count> --json=<file> --baseline=<file>\n", pArg );
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int RunAllBenchmarks( int argc, char **argv )
+{
+	BenchmarkOptions options;
+	if ( !ParseBenchmarkOptions( argc, argv, options ) )
+	{
+		return 1;
+	}
+
+	std::vector< BenchmarkBaseline > baseline;
+	if ( options.m_pBaselinePath && !ReadJsonBaseline( options.m_pBaselinePath, baseline ) )
+	{
+		fprintf( stderr, "Could not read the benchmark baseline \"%s\"\n", options.m_pBaselinePath );
+		return 1;
+	}
+
+	std::vector< BenchmarkResult > results;
+
+	for ( BenchmarkRegistration *pBenchmark = GetBenchmarkList(); pBenchmark; pBenchmark = pBenchmark->m_pNext )
+	{
+		if ( options.m_pFilter && !strstr( pBenchmark->m_pName, options.m_pFilter ) )
+		{
+			continue;
+		}
+
+		printf( "[ BENCH    ] %s\n", pBenchmark->m_pName );
+		fflush( stdout );
+
+		const BenchmarkResult result = RunBenchmark( pBenchmark, options );
+
+		printf( "[     DONE ] %s: %lld iterations x %d, %.2f ns/op (min %.2f, mean %.2f +- %.2f), %.1f ticks/op",
+		        pBenchmark->m_pName, result.m_nIterations, result.m_nRepetitions,
+		        result.m_flMedianNs, result.m_flMinNs, result.m_flMeanNs, result.m_flStdDevNs, result.m_flMedianTicks );
+
+		if ( result.m_flBytesPerSecond > 0.0 )
+		{
+			printf( ", %.3f GB/s", result.m_flBytesPerSecond / 1e9 );
+		}
+
+		if ( result.m_flItemsPerSecond > 0.0 )
+		{
+			printf( ", %.3f M items/s", result.m_flItemsPerSecond / 1e6 );
+		}
+
+		const BenchmarkBaseline *pBaseline = FindBaseline( baseline, pBenchmark->m_pName );
+		if ( pBaseline && pBaseline->m_flMedianNs > 0.0 )
+		{
+			printf( ", %+.1f%% vs baseline", ( result.m_flMedianNs / pBaseline->m_flMedianNs - 1.0 ) * 100.0 );
+		}
+
+		printf( "\n\n" );
+		fflush( stdout );
+
+		results.push_back( result );
+	}
+
+	printf( "Benchmarks run: %d\n", ( int )results.size() );
+	fflush( stdout );
+
+	if ( options.m_pJsonPath && !WriteJsonResults( options.m_pJsonPath, options, results ) )
+	{
+		fprintf( stderr, "Could not write the benchmark results to \"%s\"\n", options.m_pJsonPath );
+		return 1;
+	}
+
+	return 0;
+}
+
+int RunAllBenchmarks()
+{
+	return RunAllBenchmarks( 0, nullptr );
+}
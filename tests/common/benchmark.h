@@ -0,0 +1,84 @@
+#ifndef SOURCESDK_TESTS_COMMON_BENCHMARK_H
+#define SOURCESDK_TESTS_COMMON_BENCHMARK_H
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+class BenchmarkState
+{
+public:
+	explicit BenchmarkState( long long nIterations );
+
+	// Loop condition for the timed region: while ( state.KeepRunning() ) { ... }
+	bool KeepRunning() { return m_nRemaining-- > 0; }
+
+	long long Iterations() const { return m_nIterations; }
+
+	// Totals over all iterations, used to report throughput
+	void SetBytesProcessed( long long nBytes ) { m_nBytesProcessed = nBytes; }
+	void SetItemsProcessed( long long nItems ) { m_nItemsProcessed = nItems; }
+
+	// Leaves per-iteration setup out of the measurement. Each pair costs two clock
+	// reads of its own, so only use it around setup that dwarfs them.
+	void PauseTiming();
+	void ResumeTiming();
+
+	long long m_nIterations;
+	long long m_nRemaining;
+	long long m_nBytesProcessed;
+	long long m_nItemsProcessed;
+
+	double m_flPausedSeconds;
+	unsigned long long m_nPausedTicks;
+	double m_flPauseStart;
+	unsigned long long m_nPauseStartTicks;
+};
+
+using BenchmarkFunction = void ( * )( BenchmarkState &state );
+
+void RegisterBenchmark( const char *pName, BenchmarkFunction pFunction );
+
+// Options, all optional:
+//   --filter=<text>       only run benchmarks whose name contains text
+//   --min-time=<seconds>  shortest repetition, iterations are scaled to reach it (default 0.1)
+//   --warmup=<count>      untimed runs before the repetitions (default 1)
+//   --repetitions=<count> timed runs the summary is taken over (default 5)
+//   --json=<file>         write the results there
+//   --baseline=<file>     compare against the results of an earlier --json run
+int RunAllBenchmarks( int argc, char **argv );
+int RunAllBenchmarks();
+
+class BenchmarkRegistration
+{
+public:
+	BenchmarkRegistration( const char *pName, BenchmarkFunction pFunction );
+
+	const char *m_pName;
+	BenchmarkFunction m_pFunction;
+	BenchmarkRegistration *m_pNext;
+};
+
+// Keeps the compiler from discarding a computed value
+template < typename T > inline void BenchmarkDoNotOptimize( const T &value )
+{
+#if defined( _MSC_VER ) && !defined( __clang__ )
+	static volatile const void *s_pSink;
+	s_pSink = &value;
+	_ReadWriteBarrier();
+#else
+	asm volatile( "" : : "r,m"( value ) : "memory" );
+#endif
+}
+
+#define REGISTER_BENCHMARK( name ) \
+	static void name( BenchmarkState &state ); \
+	static BenchmarkRegistration name##_registration( #name, &name ); \
+	static void name( BenchmarkState &state )
+
+#define REGISTER_NAMED_BENCHMARK( benchmark_name, function_name ) \
+	static void function_name( BenchmarkState &state ); \
+	static BenchmarkRegistration function_name##_registration( benchmark_name, &function_name ); \
+	static void function_name( BenchmarkState &state )
+
+#endif // SOURCESDK_TESTS_COMMON_BENCHMARK_H
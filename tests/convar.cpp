@@ -0,0 +1,497 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <tier0/characterset.h>
+#include <tier0/utlbuffer.h>
+#include <tier1/convar.h>
+#include <tier1/utlvector.h>
+#include <icvar.h>
+
+#include <new>
+#include <string.h>
+
+// CCommand::Tokenize used to copy the command and pull it apart with CUtlBuffer::ParseToken;
+// it has to come up with the same args and ArgS as that did, for every command that fit.
+
+static characterset_t s_TestBreakSet;
+
+struct ReferenceCommand_t
+{
+	CUtlVector< CUtlString > m_Args;
+	int m_nArgv0Size = 0;
+};
+
+static void ReferenceTokenize( const char *pCommand, ReferenceCommand_t &reference )
+{
+	static char s_ArgSBuffer[4096];
+	static char s_Token[4096];
+
+	int nLen = V_strlen( pCommand );
+	memcpy( s_ArgSBuffer, pCommand, nLen + 1 );
+
+	CUtlBuffer bufParse( s_ArgSBuffer, nLen, static_cast< CUtlBuffer::BufferFlags_t >( CUtlBuffer::TEXT_BUFFER | CUtlBuffer::READ_ONLY ) );
+	while ( bufParse.IsValid() )
+	{
+		int nStartGet = bufParse.TellGet();
+		int nSize = bufParse.ParseToken( &s_TestBreakSet, s_Token, sizeof( s_Token ), true );
+		if ( nSize < 0 )
+			break;
+
+		if ( reference.m_Args.Count() == 1 )
+		{
+			int nArgv0Size = bufParse.TellGet();
+			if ( s_ArgSBuffer[nArgv0Size - 1] == '\"' )
+				--nArgv0Size;
+			nArgv0Size -= nSize;
+			if ( nArgv0Size > nStartGet && s_ArgSBuffer[nArgv0Size - 1] == '\"' )
+				--nArgv0Size;
+			reference.m_nArgv0Size = nArgv0Size;
+		}
+
+		reference.m_Args.AddToTail( CUtlString( s_Token ) );
+	}
+}
+
+static bool CommandMatchesReference( const char *pCommand, const CCommand &command )
+{
+	ReferenceCommand_t reference;
+	ReferenceTokenize( pCommand, reference );
+
+	if ( command.ArgC() != reference.m_Args.Count() )
+		return false;
+
+	for ( int i = 0; i < command.ArgC(); i++ )
+	{
+		if ( V_strcmp( command.Arg( i ), reference.m_Args[i].Get() ) )
+			return false;
+
+		if ( command.ArgView( i ) != std::string_view( reference.m_Args[i].Get() ) )
+			return false;
+	}
+
+	return !V_strcmp( command.ArgS(), reference.m_nArgv0Size ? pCommand + reference.m_nArgv0Size : "" ) &&
+		!V_strcmp( command.GetCommandString(), command.ArgC() ? pCommand : "" );
+}
+
+REGISTER_NAMED_TEST( "convar.CCommand.Tokenize", convar_CCommand_Tokenize )
+{
+	CharacterSetBuild( &s_TestBreakSet, "{}()':" );
+
+	CCommand command;
+	TEST_TRUE( command.Tokenize( "say \"hello world\" again", &s_TestBreakSet ) );
+	TEST_EQ( command.ArgC(), 3 );
+	TEST_EQ( V_strcmp( command.Arg( 0 ), "say" ), 0 );
+	TEST_EQ( V_strcmp( command.Arg( 1 ), "hello world" ), 0 );
+	TEST_EQ( V_strcmp( command.ArgS(), "\"hello world\" again" ), 0 );
+	TEST_EQ( V_strcmp( command.GetCommandString(), "say \"hello world\" again" ), 0 );
+	TEST_EQ( command.ArgView( 1 ).size(), ( size_t )11 );
+	TEST_EQ( command.ArgView( 2 ).size(), ( size_t )5 );
+	TEST_EQ( command.ArgView( 3 ).size(), ( size_t )0 );
+	TEST_EQ( V_strcmp( command.Arg( 3 ), "" ), 0 );
+
+	// Breaks are tokens of their own, comments run to the end of the line
+	TEST_TRUE( command.Tokenize( "bind k {+attack;+jump} // keys\nignored", &s_TestBreakSet ) );
+	TEST_EQ( command.ArgC(), 6 );
+	TEST_EQ( V_strcmp( command.Arg( 2 ), "{" ), 0 );
+	TEST_EQ( V_strcmp( command.Arg( 3 ), "+attack;+jump" ), 0 );
+	TEST_EQ( V_strcmp( command.Arg( 4 ), "}" ), 0 );
+	TEST_EQ( V_strcmp( command.Arg( 5 ), "ignored" ), 0 );
+
+	// "foo"bar is two args and ArgS starts at bar
+	TEST_TRUE( command.Tokenize( "\"foo\"bar baz", &s_TestBreakSet ) );
+	TEST_EQ( command.ArgC(), 3 );
+	TEST_EQ( V_strcmp( command.ArgS(), "bar baz" ), 0 );
+
+	TEST_EQ( command.FindArg( "-port" ), -1 );
+	TEST_TRUE( command.Tokenize( "map de_dust2 -port 27015", &s_TestBreakSet ) );
+	TEST_EQ( command.FindArg( "-PORT" ), 3 );
+	TEST_EQ( command.FindArgInt( "-port", 0 ), 27015 );
+
+	TEST_FALSE( command.Tokenize( "", &s_TestBreakSet ) );
+	TEST_EQ( command.ArgC(), 0 );
+	TEST_EQ( V_strcmp( command.ArgS(), "" ), 0 );
+
+	// Commands no longer have to fit in the old 512 byte buffers
+	char szLong[2048];
+	V_strncpy( szLong, "echo", sizeof( szLong ) );
+	for ( int i = 0; i < 300; i++ )
+	{
+		V_strcat_safe( szLong, " {x}" );
+	}
+	TEST_TRUE( command.Tokenize( szLong, &s_TestBreakSet ) );
+	TEST_EQ( command.ArgC(), 1 + 300 * 3 );
+	TEST_EQ( V_strcmp( command.Arg( 900 ), "}" ), 0 );
+	TEST_TRUE( CommandMatchesReference( szLong, command ) );
+
+	// Re-tokenizing its own ArgS, which lives in the buffer being copied into
+	TEST_TRUE( command.Tokenize( "alpha beta \"gamma delta\"", &s_TestBreakSet ) );
+	TEST_TRUE( command.Tokenize( command.ArgS(), &s_TestBreakSet ) );
+	TEST_EQ( command.ArgC(), 2 );
+	TEST_EQ( V_strcmp( command.Arg( 0 ), "beta" ), 0 );
+	TEST_EQ( V_strcmp( command.ArgS(), "\"gamma delta\"" ), 0 );
+}
+
+REGISTER_NAMED_TEST( "convar.CCommand.MatchesParseToken", convar_CCommand_MatchesParseToken )
+{
+	CharacterSetBuild( &s_TestBreakSet, "{}()':" );
+
+	static const char *s_pPieces[] =
+	{
+		"sv_cheats", "1", " ", "  ", "\t", "\n", "\"", "\"quoted arg\"", "\"\"", "{", "}", "(", ":", "'",
+		"//", "/", "a_rather_long_argument_that_spans_more_than_one_block", "-port", "27015", "x",
+		"\r\n", ";", "+jump", "\x01", "\x7F",
+	};
+
+	uint32 nSeed = 1;
+	char szCommand[512];
+	CCommand command;
+	bool bAllMatch = true;
+
+	for ( int nTest = 0; nTest < 20000 && bAllMatch; nTest++ )
+	{
+		nSeed = nSeed * 1664525 + 1013904223;
+		int nPieces = ( nSeed >> 8 ) % 24;
+
+		szCommand[0] = '\0';
+		for ( int i = 0; i < nPieces; i++ )
+		{
+			nSeed = nSeed * 1664525 + 1013904223;
+			V_strcat_safe( szCommand, s_pPieces[( nSeed >> 8 ) % ARRAYSIZE( s_pPieces )] );
+		}
+
+		command.Tokenize( szCommand, &s_TestBreakSet );
+		bAllMatch = CommandMatchesReference( szCommand, command );
+	}
+
+	TEST_TRUE( bAllMatch );
+}
+
+// Setting a value goes through ICvar for the filter and the callbacks. The real one is the engine's,
+// this one lets everything through and keeps the strings the global change callbacks were given.
+// convar.cpp looks at CCvar's list of global callbacks to decide whether to format those strings,
+// and a CCvar can't be constructed here (its console commands need the engine), so the fake is
+// built in storage the size of one and keeps its list where CCvar has it.
+struct TestGlobalChange_t
+{
+	int m_nCalls = 0;
+	CUtlString m_NewValue;
+	CUtlString m_OldValue;
+};
+
+static TestGlobalChange_t s_TestGlobalChange;
+
+// What the filter callback was given, and whether it lets the value through
+struct TestFilter_t
+{
+	bool m_bReject = false;
+	int m_nCalls = 0;
+	const CVValue_t *m_pOldValue = NULL;
+	int m_nOldValue = 0;
+};
+
+static TestFilter_t s_TestFilter;
+
+class CTestCvar : public ICvar
+{
+public:
+	CUtlVector<FnChangeCallbackGlobal_t> &GlobalChangeCallbacks() { return reinterpret_cast<CCvar *>( this )->m_GlobalChangeCBList; }
+
+	virtual bool Connect( CreateInterfaceFn factory ) { return true; }
+	virtual void Disconnect() {}
+	virtual void *QueryInterface( const char *pInterfaceName ) { return NULL; }
+	virtual InitReturnVal_t Init() { return INIT_OK; }
+	virtual void Shutdown() {}
+	virtual void PreShutdown() {}
+	virtual const AppSystemInfo_t *GetDependencies() { return NULL; }
+	virtual AppSystemTier_t GetTier() { return APP_SYSTEM_TIER_OTHER; }
+	virtual void Reconnect( CreateInterfaceFn factory, const char *pInterfaceName ) {}
+	virtual bool IsSingleton() { return true; }
+	virtual AppSystemBuildType_t GetBuildType() { return APP_SYSTEM_BUILD_RELEASE; }
+
+	virtual ConVarRef FindConVar( const char *name, bool allow_defensive ) { return ConVarRef(); }
+	virtual ConVarRef FindFirstConVar() { return ConVarRef(); }
+	virtual ConVarRef FindNextConVar( ConVarRef prev ) { return ConVarRef(); }
+	virtual void CallChangeCallback( ConVarRef cvar, const CSplitScreenSlot nSlot, const CVValue_t *pNewValue, const CVValue_t *pOldValue, void *__unk01 ) {}
+	virtual void IterateConVarCallbacks( ConVarRef cvar, FnCvarCallbacksReader_t cb ) {}
+	virtual bool CallFilterCallback( ConVarRef cvar, const CSplitScreenSlot nSlot, const CVValue_t *pNewValue, const CVValue_t *pOldValue, void *__unk01 )
+	{
+		s_TestFilter.m_nCalls++;
+		s_TestFilter.m_pOldValue = pOldValue;
+		s_TestFilter.m_nOldValue = pOldValue->m_i32Value;
+		return !s_TestFilter.m_bReject;
+	}
+	virtual ConCommandRef FindConCommand( const char *name, bool allow_defensive ) { return ConCommandRef(); }
+	virtual ConCommandRef FindFirstConCommand() { return ConCommandRef(); }
+	virtual ConCommandRef FindNextConCommand( ConCommandRef prev ) { return ConCommandRef(); }
+	virtual void DispatchConCommand( ConCommandRef cmd, const CCommandContext &ctx, const CCommand &args ) {}
+
+	virtual void InstallGlobalChangeCallback( FnChangeCallbackGlobal_t callback ) { GlobalChangeCallbacks().AddToTail( callback ); }
+	virtual void RemoveGlobalChangeCallback( FnChangeCallbackGlobal_t callback ) { GlobalChangeCallbacks().FindAndRemove( callback ); }
+	virtual void CallGlobalChangeCallbacks( ConVarRefAbstract *ref, CSplitScreenSlot nSlot, const char *newValue, const char *oldValue, void *__unk01 )
+	{
+		s_TestGlobalChange.m_nCalls++;
+		s_TestGlobalChange.m_NewValue = newValue;
+		s_TestGlobalChange.m_OldValue = oldValue;
+
+		FOR_EACH_VEC( GlobalChangeCallbacks(), i )
+		{
+			GlobalChangeCallbacks()[i]( ref, nSlot, newValue, oldValue, __unk01 );
+		}
+	}
+
+	virtual void ResetConVarsToDefaultValuesByFlag( uint64 nFlag ) {}
+	virtual void SetMaxSplitScreenSlots( int nSlots ) {}
+	virtual void RegisterCreationListeners( IConVarListener *callbacks ) {}
+	virtual void RemoveCreationListeners( IConVarListener *callbacks ) {}
+	virtual void ResetConVarsToDefaultValuesByName( const char *pszPrefix ) {}
+	virtual ConVarSnapshot_t *TakeConVarSnapshot( void ) { return NULL; }
+	virtual void ResetConVarsToSnapshot( ConVarSnapshot_t *pSnapshot ) {}
+	virtual void DestroyConVarSnapshot( ConVarSnapshot_t *pSnapshot ) {}
+	virtual characterset_t *GetCharacterSet( void ) { return NULL; }
+	virtual void SetConVarsFromGameInfo( KeyValues *pKV ) {}
+	virtual void StripDevelopmentFlags() {}
+	virtual int GetTotalUserInfoCvarsByteSize() { return 0; }
+	virtual void CopyUserInfoCvarDefaults( uint8 *buffer, int from, int to, bool copy_or_cleanup ) {}
+	virtual void GetCompletionResults( const CCommand &command, CUtlVector< CUtlString > &completions, bool *successful ) {}
+	virtual void RegisterConVar( const ConVarCreation_t &setup, uint64 nAdditionalFlags, ConVarRef *pCvarRef, ConVarData **pCvarData ) {}
+	virtual void UnregisterConVarCallbacks( ConVarRef cvar ) {}
+	virtual void LockConVarValueInitialisation( bool state ) {}
+	virtual ConVarData *GetConVarData( ConVarRef cvar ) { return NULL; }
+	virtual ConCommandRef RegisterConCommand( const ConCommandCreation_t &setup, uint64 nAdditionalFlags ) { return ConCommandRef(); }
+	virtual void UnregisterConCommandCallbacks( ConCommandRef cmd ) {}
+	virtual ConCommandData *GetConCommandData( ConCommandRef cmd ) { return NULL; }
+	virtual void QueueThreadSetValue( ConVarRefAbstract *ref, CSplitScreenSlot nSlot, void *__unk01, CVValue_t *value ) {}
+};
+
+// Puts the fake in place of g_pCVar for as long as it's in scope
+class CTestCvarScope
+{
+public:
+	CTestCvarScope()
+	{
+		memset( m_Storage, 0, sizeof( m_Storage ) );
+		m_pCvar = new ( m_Storage ) CTestCvar;
+		new ( &m_pCvar->GlobalChangeCallbacks() ) CUtlVector<FnChangeCallbackGlobal_t>();
+
+		m_pPrevCvar = g_pCVar;
+		g_pCVar = m_pCvar;
+		s_TestGlobalChange = TestGlobalChange_t();
+		s_TestFilter = TestFilter_t();
+	}
+
+	~CTestCvarScope()
+	{
+		g_pCVar = m_pPrevCvar;
+		m_pCvar->GlobalChangeCallbacks().~CUtlVector();
+		m_pCvar->~CTestCvar();
+	}
+
+	CTestCvar *operator->() { return m_pCvar; }
+
+private:
+	alignas( CCvar ) uint8 m_Storage[sizeof( CCvar )];
+	CTestCvar *m_pCvar;
+	ICvar *m_pPrevCvar;
+};
+
+// A registered convar of its own, with its value constructed
+class CTestConVar
+{
+public:
+	CTestConVar( EConVarType type, const char *pszValue ) : m_Data( type ), m_Ref( ConVarRef(), &m_Data )
+	{
+		m_Data.Construct( -1 );
+		m_Data.TypeTraits()->StringToValue( pszValue, m_Data.Value( -1 ) );
+	}
+
+	~CTestConVar() { m_Data.Destruct( -1 ); }
+
+	ConVarRefAbstract *Ref() { return &m_Ref; }
+	const CVValue_t *Value() { return m_Data.Value( -1 ); }
+
+private:
+	ConVarData m_Data;
+	ConVarRefAbstract m_Ref;
+};
+
+struct TestValueChange_t
+{
+	ConVarRefAbstract *m_pRef;
+	int m_nNewValue;
+	int m_nOldValue;
+};
+
+static CUtlVector<TestValueChange_t> s_TestValueChanges;
+
+static void TestValueChangeCallback( ConVarRefAbstract *ref, CSplitScreenSlot nSlot, const CVValue_t *pNewValue, const CVValue_t *pOldValue )
+{
+	TestValueChange_t change = { ref, pNewValue->m_i32Value, pOldValue->m_i32Value };
+	s_TestValueChanges.AddToTail( change );
+}
+
+static int s_nTestGlobalCallbacks;
+
+static void TestGlobalChangeCallback( ConVarRefAbstract *ref, CSplitScreenSlot nSlot, const char *pNewValue, const char *pOldValue, void *__unk01 )
+{
+	s_nTestGlobalCallbacks++;
+}
+
+REGISTER_NAMED_TEST( "convar.ValueChangeCallbacks", convar_ValueChangeCallbacks )
+{
+	CTestCvarScope cvar;
+	CTestConVar var( EConVarType_Int32, "1" );
+	s_TestValueChanges.RemoveAll();
+
+	ConVar_InstallValueChangeCallback( TestValueChangeCallback );
+
+	// Called with the values themselves
+	TEST_TRUE( var.Ref()->SetString( "5" ) );
+	TEST_EQ( var.Ref()->GetInt(), 5 );
+	TEST_EQ( s_TestValueChanges.Count(), 1 );
+	TEST_EQ( s_TestValueChanges[0].m_pRef, var.Ref() );
+	TEST_EQ( s_TestValueChanges[0].m_nNewValue, 5 );
+	TEST_EQ( s_TestValueChanges[0].m_nOldValue, 1 );
+
+	// Not when nothing changed
+	TEST_TRUE( var.Ref()->SetString( " 5 " ) );
+	TEST_EQ( s_TestValueChanges.Count(), 1 );
+
+	var.Ref()->SetInt( 7 );
+	TEST_EQ( s_TestValueChanges.Count(), 2 );
+	TEST_EQ( s_TestValueChanges[1].m_nNewValue, 7 );
+	TEST_EQ( s_TestValueChanges[1].m_nOldValue, 5 );
+
+	// And no more once removed
+	ConVar_RemoveValueChangeCallback( TestValueChangeCallback );
+	var.Ref()->SetInt( 8 );
+	TEST_EQ( s_TestValueChanges.Count(), 2 );
+	TEST_EQ( var.Ref()->GetInt(), 8 );
+}
+
+REGISTER_NAMED_TEST( "convar.GlobalChangeStrings", convar_GlobalChangeStrings )
+{
+	CTestCvarScope cvar;
+	CTestConVar var( EConVarType_Int32, "1" );
+	CTestConVar str( EConVarType_String, "short" );
+
+	// Nobody takes the strings, so they aren't formatted
+	TEST_TRUE( var.Ref()->SetString( "5" ) );
+	TEST_EQ( s_TestGlobalChange.m_nCalls, 1 );
+	TEST_EQ( V_strcmp( s_TestGlobalChange.m_NewValue.Get(), "" ), 0 );
+	TEST_EQ( V_strcmp( s_TestGlobalChange.m_OldValue.Get(), "" ), 0 );
+
+	// Once someone does, they are
+	s_nTestGlobalCallbacks = 0;
+	cvar->InstallGlobalChangeCallback( TestGlobalChangeCallback );
+	TEST_TRUE( var.Ref()->SetString( "-12" ) );
+	TEST_EQ( s_nTestGlobalCallbacks, 1 );
+	TEST_EQ( V_strcmp( s_TestGlobalChange.m_NewValue.Get(), "-12" ), 0 );
+	TEST_EQ( V_strcmp( s_TestGlobalChange.m_OldValue.Get(), "5" ), 0 );
+
+	// Longer than the buffers start out as
+	char szLong[600];
+	memset( szLong, 'x', sizeof( szLong ) - 1 );
+	szLong[sizeof( szLong ) - 1] = '\0';
+	TEST_TRUE( str.Ref()->SetString( szLong ) );
+	TEST_EQ( V_strcmp( s_TestGlobalChange.m_NewValue.Get(), szLong ), 0 );
+	TEST_EQ( V_strcmp( s_TestGlobalChange.m_OldValue.Get(), "short" ), 0 );
+
+	cvar->RemoveGlobalChangeCallback( TestGlobalChangeCallback );
+	TEST_TRUE( var.Ref()->SetString( "3" ) );
+	TEST_EQ( s_nTestGlobalCallbacks, 2 );
+	TEST_EQ( V_strcmp( s_TestGlobalChange.m_NewValue.Get(), "" ), 0 );
+}
+
+REGISTER_NAMED_TEST( "convar.FilterSnapshot", convar_FilterSnapshot )
+{
+	CTestCvarScope cvar;
+	CTestConVar var( EConVarType_Int32, "1" );
+
+	// The filter is given a copy of the value, not the one stored
+	var.Ref()->SetInt( 4 );
+	TEST_EQ( s_TestFilter.m_nCalls, 1 );
+	TEST_EQ( s_TestFilter.m_nOldValue, 1 );
+	TEST_TRUE( s_TestFilter.m_pOldValue != var.Value() );
+	TEST_EQ( var.Ref()->GetInt(), 4 );
+
+	// Turned away, the value stays as it was
+	s_TestFilter.m_bReject = true;
+	var.Ref()->SetInt( 9 );
+	TEST_EQ( s_TestFilter.m_nCalls, 2 );
+	TEST_EQ( s_TestFilter.m_nOldValue, 4 );
+	TEST_EQ( var.Ref()->GetInt(), 4 );
+	TEST_EQ( s_TestGlobalChange.m_nCalls, 1 );
+}
+
+static int s_nTestCallbackVarValue;
+
+// Reads the other convar from inside the callback, to see whether it has been set yet
+static CTestConVar *s_pTestOtherVar;
+
+static void TestBatchValueChangeCallback( ConVarRefAbstract *ref, CSplitScreenSlot nSlot, const CVValue_t *pNewValue, const CVValue_t *pOldValue )
+{
+	TestValueChangeCallback( ref, nSlot, pNewValue, pOldValue );
+	s_nTestCallbackVarValue = s_pTestOtherVar->Ref()->GetInt();
+}
+
+REGISTER_NAMED_TEST( "convar.SetValues", convar_SetValues )
+{
+	CTestCvarScope cvar;
+	CTestConVar a( EConVarType_Int32, "1" ), b( EConVarType_Int32, "2" ), c( EConVarType_Int32, "3" );
+	s_TestValueChanges.RemoveAll();
+	s_pTestOtherVar = &b;
+
+	ConVar_InstallValueChangeCallback( TestBatchValueChangeCallback );
+
+	// Every value is in before the first callback, and a value that doesn't parse is skipped
+	ConVarSetValue_t values[] =
+	{
+		{ a.Ref(), "10" },
+		{ b.Ref(), " 20 " },
+		{ c.Ref(), "not a number" },
+	};
+	TEST_EQ( ConVarRefAbstract::SetValues( values, ARRAYSIZE( values ) ), 2 );
+	TEST_EQ( a.Ref()->GetInt(), 10 );
+	TEST_EQ( b.Ref()->GetInt(), 20 );
+	TEST_EQ( c.Ref()->GetInt(), 3 );
+	TEST_EQ( s_nTestCallbackVarValue, 20 );
+
+	TEST_EQ( s_TestValueChanges.Count(), 2 );
+	TEST_EQ( s_TestValueChanges[0].m_pRef, a.Ref() );
+	TEST_EQ( s_TestValueChanges[0].m_nNewValue, 10 );
+	TEST_EQ( s_TestValueChanges[0].m_nOldValue, 1 );
+	TEST_EQ( s_TestValueChanges[1].m_pRef, b.Ref() );
+	TEST_EQ( s_TestValueChanges[1].m_nNewValue, 20 );
+	TEST_EQ( s_TestValueChanges[1].m_nOldValue, 2 );
+
+	// Set twice is one change, from before the batch to the last value
+	s_TestValueChanges.RemoveAll();
+	ConVarSetValue_t twice[] =
+	{
+		{ a.Ref(), "11" },
+		{ c.Ref(), "30" },
+		{ a.Ref(), "12", 0 },
+	};
+	TEST_EQ( ConVarRefAbstract::SetValues( twice, ARRAYSIZE( twice ) ), 3 );
+	TEST_EQ( a.Ref()->GetInt(), 12 );
+	TEST_EQ( s_TestValueChanges.Count(), 2 );
+	TEST_EQ( s_TestValueChanges[0].m_pRef, a.Ref() );
+	TEST_EQ( s_TestValueChanges[0].m_nNewValue, 12 );
+	TEST_EQ( s_TestValueChanges[0].m_nOldValue, 10 );
+	TEST_EQ( s_TestValueChanges[1].m_pRef, c.Ref() );
+	TEST_EQ( s_TestValueChanges[1].m_nNewValue, 30 );
+	TEST_EQ( s_TestValueChanges[1].m_nOldValue, 3 );
+
+	// And back where it started is no change at all
+	s_TestValueChanges.RemoveAll();
+	ConVarSetValue_t back[] =
+	{
+		{ b.Ref(), "21" },
+		{ b.Ref(), "20" },
+	};
+	TEST_EQ( ConVarRefAbstract::SetValues( back, ARRAYSIZE( back ) ), 2 );
+	TEST_EQ( b.Ref()->GetInt(), 20 );
+	TEST_EQ( s_TestValueChanges.Count(), 0 );
+
+	ConVar_RemoveValueChangeCallback( TestBatchValueChangeCallback );
+}
@@ -0,0 +1,240 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <tier1/dirwatcher_inotify.h>
+#include <tier1/utlvector.h>
+
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+struct TestChangedFiles_t
+{
+	CUtlVector< CUtlString > m_vecFiles;
+
+	bool HasFile( const char *pchRelPath ) const
+	{
+		for ( int i = 0; i < m_vecFiles.Count(); i++ )
+		{
+			if ( !V_strcmp( m_vecFiles[i].String(), pchRelPath ) )
+				return true;
+		}
+
+		return false;
+	}
+};
+
+static void TestChangedFile( const char *pchRelPath, void *pContext )
+{
+	( ( TestChangedFiles_t * )pContext )->m_vecFiles.AddToTail( CUtlString( pchRelPath ) );
+}
+
+static bool TestMakeDir( const char *pchBase, const char *pchRelDir )
+{
+	char szPath[512];
+	snprintf( szPath, sizeof( szPath ), "%s/%s", pchBase, pchRelDir );
+	return mkdir( szPath, 0755 ) == 0;
+}
+
+static bool TestWriteFile( const char *pchBase, const char *pchRelPath )
+{
+	char szPath[512];
+	snprintf( szPath, sizeof( szPath ), "%s/%s", pchBase, pchRelPath );
+
+	int fd = open( szPath, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+	if ( fd < 0 )
+		return false;
+
+	bool bWritten = write( fd, pchRelPath, strlen( pchRelPath ) ) > 0;
+	close( fd );
+	return bWritten;
+}
+
+static void TestRemoveTree( const char *pchBase )
+{
+	char szCommand[600];
+	snprintf( szCommand, sizeof( szCommand ), "rm -rf '%s'", pchBase );
+	if ( system( szCommand ) != 0 )
+		fprintf( stderr, "couldn't remove %s\n", pchBase );
+}
+
+REGISTER_NAMED_TEST( "CDirWatcherINotify.AddWatchRecursive", CDirWatcherINotify_AddWatchRecursive )
+{
+	char szBase[] = "/tmp/sourcesdk_dirwatcher_XXXXXX";
+	TEST_NOT_NULL( mkdtemp( szBase ) );
+
+	TEST_TRUE( TestMakeDir( szBase, "a" ) );
+	TEST_TRUE( TestMakeDir( szBase, "a/b" ) );
+	TEST_TRUE( TestMakeDir( szBase, "a/b/c" ) );
+	TEST_TRUE( TestMakeDir( szBase, "d" ) );
+	TEST_TRUE( TestWriteFile( szBase, "a/b/old.txt" ) );
+
+	TestChangedFiles_t changed;
+	CDirWatcherINotify watcher( TestChangedFile, &changed );
+	TEST_TRUE( watcher.BInit( szBase ) );
+
+	// The base dir and all four below it, and what was there before isn't a change
+	TEST_EQ( watcher.GetWatchCount(), 5 );
+	watcher.ReadEvents();
+	TEST_EQ( changed.m_vecFiles.Count(), 0 );
+
+	// Nested all the way down
+	TEST_TRUE( TestWriteFile( szBase, "a/b/c/deep.txt" ) );
+	TEST_TRUE( TestWriteFile( szBase, "top.txt" ) );
+	watcher.ReadEvents();
+	TEST_TRUE( changed.HasFile( "a/b/c/deep.txt" ) );
+	TEST_TRUE( changed.HasFile( "top.txt" ) );
+	TEST_FALSE( changed.HasFile( "a/b/old.txt" ) );
+
+	// A directory made since, with files in it before the watcher gets to see it
+	changed.m_vecFiles.RemoveAll();
+	TEST_TRUE( TestMakeDir( szBase, "d/new" ) );
+	TEST_TRUE( TestMakeDir( szBase, "d/new/deeper" ) );
+	TEST_TRUE( TestWriteFile( szBase, "d/new/deeper/early.txt" ) );
+	watcher.ReadEvents();
+	TEST_TRUE( changed.HasFile( "d/new/deeper/early.txt" ) );
+	TEST_EQ( watcher.GetWatchCount(), 7 );
+
+	// And watched from then on
+	changed.m_vecFiles.RemoveAll();
+	TEST_TRUE( TestWriteFile( szBase, "d/new/deeper/later.txt" ) );
+	watcher.ReadEvents();
+	TEST_TRUE( changed.HasFile( "d/new/deeper/later.txt" ) );
+
+	// Removed directories give their watches back
+	TestRemoveTree( ( CUtlString( szBase ) + "/d" ).String() );
+	watcher.ReadEvents();
+	TEST_EQ( watcher.GetWatchCount(), 4 );
+	TEST_EQ( watcher.GetOverflowCount(), 0 );
+
+	TestRemoveTree( szBase );
+}
+
+static bool TestRename( const char *pchFromBase, const char *pchFrom, const char *pchToBase, const char *pchTo )
+{
+	char szFrom[512], szTo[512];
+	snprintf( szFrom, sizeof( szFrom ), "%s/%s", pchFromBase, pchFrom );
+	snprintf( szTo, sizeof( szTo ), "%s/%s", pchToBase, pchTo );
+	return rename( szFrom, szTo ) == 0;
+}
+
+REGISTER_NAMED_TEST( "CDirWatcherINotify.RenameDir", CDirWatcherINotify_RenameDir )
+{
+	char szBase[] = "/tmp/sourcesdk_dirwatcher_XXXXXX";
+	char szOutside[] = "/tmp/sourcesdk_dirwatcher_out_XXXXXX";
+	TEST_NOT_NULL( mkdtemp( szBase ) );
+	TEST_NOT_NULL( mkdtemp( szOutside ) );
+
+	TEST_TRUE( TestMakeDir( szBase, "old" ) );
+	TEST_TRUE( TestMakeDir( szBase, "old/sub" ) );
+	TEST_TRUE( TestMakeDir( szBase, "gone" ) );
+
+	TestChangedFiles_t changed;
+	CDirWatcherINotify watcher( TestChangedFile, &changed );
+	TEST_TRUE( watcher.BInit( szBase ) );
+	TEST_EQ( watcher.GetWatchCount(), 4 );
+
+	// Renamed in the tree, it keeps its watches under the new name
+	TEST_TRUE( TestRename( szBase, "old", szBase, "new" ) );
+	watcher.ReadEvents();
+	TEST_EQ( watcher.GetWatchCount(), 4 );
+
+	changed.m_vecFiles.RemoveAll();
+	TEST_TRUE( TestWriteFile( szBase, "new/after.txt" ) );
+	TEST_TRUE( TestWriteFile( szBase, "new/sub/deep.txt" ) );
+	watcher.ReadEvents();
+	TEST_TRUE( changed.HasFile( "new/after.txt" ) );
+	TEST_TRUE( changed.HasFile( "new/sub/deep.txt" ) );
+	TEST_FALSE( changed.HasFile( "old/after.txt" ) );
+
+	// Moved out of the tree, its watch goes with nothing to pair it with
+	TEST_TRUE( TestRename( szBase, "gone", szOutside, "gone" ) );
+	watcher.ReadEvents();
+	TEST_EQ( watcher.GetWatchCount(), 3 );
+
+	changed.m_vecFiles.RemoveAll();
+	TEST_TRUE( TestWriteFile( szOutside, "gone/outside.txt" ) );
+	watcher.ReadEvents();
+	TEST_EQ( changed.m_vecFiles.Count(), 0 );
+	TEST_EQ( watcher.GetOverflowCount(), 0 );
+
+	TestRemoveTree( szOutside );
+	TestRemoveTree( szBase );
+}
+
+REGISTER_NAMED_TEST( "CDirWatcherINotify.OverflowRescan", CDirWatcherINotify_OverflowRescan )
+{
+	// The kernel queues this many events per instance before it drops the rest
+	int nMaxQueued = 16384;
+	FILE *pFile = fopen( "/proc/sys/fs/inotify/max_queued_events", "r" );
+	if ( pFile )
+	{
+		if ( fscanf( pFile, "%d", &nMaxQueued ) != 1 )
+			nMaxQueued = 16384;
+		fclose( pFile );
+	}
+
+	// Too big a queue to fill in a test
+	if ( nMaxQueued > 1024 * 1024 )
+		return;
+
+	char szBase[] = "/tmp/sourcesdk_dirwatcher_XXXXXX";
+	TEST_NOT_NULL( mkdtemp( szBase ) );
+	TEST_TRUE( TestMakeDir( szBase, "sub" ) );
+	TEST_TRUE( TestWriteFile( szBase, "untouched.txt" ) );
+
+	// An hour old, a file written in the same clock tick as the watcher started counts as changed
+	char szUntouched[512];
+	snprintf( szUntouched, sizeof( szUntouched ), "%s/untouched.txt", szBase );
+	struct timeval rgTimes[2];
+	gettimeofday( &rgTimes[0], NULL );
+	rgTimes[0].tv_sec -= 3600;
+	rgTimes[1] = rgTimes[0];
+	TEST_EQ( utimes( szUntouched, rgTimes ), 0 );
+
+	TestChangedFiles_t changed;
+	CDirWatcherINotify watcher( TestChangedFile, &changed );
+	TEST_TRUE( watcher.BInit( szBase ) );
+
+	// Identical events in a row are merged, so the writes go back and forth between two files
+	char szPathA[512], szPathB[512];
+	snprintf( szPathA, sizeof( szPathA ), "%s/a.bin", szBase );
+	snprintf( szPathB, sizeof( szPathB ), "%s/sub/b.bin", szBase );
+	int fdA = open( szPathA, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+	int fdB = open( szPathB, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+	TEST_TRUE( fdA >= 0 && fdB >= 0 );
+
+	int cFailedWrites = 0;
+	for ( int i = 0; i < nMaxQueued; i++ )
+	{
+		if ( pwrite( fdA, "a", 1, i ) != 1 || pwrite( fdB, "b", 1, i ) != 1 )
+			cFailedWrites++;
+	}
+
+	close( fdA );
+	close( fdB );
+	TEST_EQ( cFailedWrites, 0 );
+
+	// Past the overflow its event is dropped, the rescan finds it by its time instead
+	TEST_TRUE( TestWriteFile( szBase, "sub/late.txt" ) );
+
+	watcher.ReadEvents();
+	TEST_EQ( watcher.GetOverflowCount(), 1 );
+	TEST_TRUE( changed.HasFile( "a.bin" ) );
+	TEST_TRUE( changed.HasFile( "sub/b.bin" ) );
+	TEST_TRUE( changed.HasFile( "sub/late.txt" ) );
+	TEST_FALSE( changed.HasFile( "untouched.txt" ) );
+
+	// Back to events after
+	changed.m_vecFiles.RemoveAll();
+	TEST_TRUE( TestWriteFile( szBase, "sub/after.txt" ) );
+	watcher.ReadEvents();
+	TEST_EQ( watcher.GetOverflowCount(), 1 );
+	TEST_TRUE( changed.HasFile( "sub/after.txt" ) );
+
+	TestRemoveTree( szBase );
+}
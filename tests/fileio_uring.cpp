@@ -0,0 +1,314 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <tier0/basetypes.h>
+#include <tier0/threadtools.h>
+#include <tier1/fileio_uring.h>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef IOURING_FILEIO
+
+// The byte at a file offset, so any piece of the file can be checked on its own
+static uint8 TestFileByte( uint64 ulOffset )
+{
+	return ( uint8 )( ( ulOffset * 2654435761u ) >> 13 );
+}
+
+static void TestFillBytes( uint8 *pubData, uint64 ulOffset, uint32 cubData )
+{
+	for ( uint32 i = 0; i < cubData; i++ )
+	{
+		pubData[i] = TestFileByte( ulOffset + i );
+	}
+}
+
+static int TestOpenTempFile()
+{
+	char szPath[] = "/tmp/sourcesdk_fileio_uring_XXXXXX";
+	int fd = mkstemp( szPath );
+	if ( fd >= 0 )
+		unlink( szPath );
+	return fd;
+}
+
+// Number of bytes that don't match TestFileByte, or -1 when the file isn't cubExpected long
+static int64 TestCountBadBytes( int fd, uint64 cubExpected )
+{
+	if ( lseek( fd, 0, SEEK_END ) != ( off_t )cubExpected )
+		return -1;
+
+	int64 cBad = 0;
+	uint8 rgubBuffer[64 * 1024];
+	for ( uint64 ulOffset = 0; ulOffset < cubExpected; )
+	{
+		ssize_t cubRead = pread( fd, rgubBuffer, sizeof( rgubBuffer ), ulOffset );
+		if ( cubRead <= 0 )
+			return -1;
+
+		for ( ssize_t i = 0; i < cubRead; i++ )
+		{
+			if ( rgubBuffer[i] != TestFileByte( ulOffset + i ) )
+				cBad++;
+		}
+
+		ulOffset += cubRead;
+	}
+
+	return cBad;
+}
+
+static void TestReleaseCounted( void *pvData, void *pContext )
+{
+	free( pvData );
+	( *( int * )pContext )++;
+}
+
+// Staged writes, copied writes too big to stage and owned buffers, in that order, from ulOffset on
+static bool TestWriteMix( CFileWriterURing *pURing, uint64 *pcubWritten, int *pcReleased, int *pcOwned )
+{
+	static const uint32 s_rgcubSizes[] = { 1, 100, 4095, 4096, 70000, 300 * 1024, 2 * 1024 * 1024 };
+
+	for ( int iPass = 0; iPass < 4; iPass++ )
+	{
+		for ( uint32 cubData : s_rgcubSizes )
+		{
+			uint8 *pubData = ( uint8 * )malloc( cubData );
+			TestFillBytes( pubData, *pcubWritten, cubData );
+
+			bool bOk;
+			if ( iPass & 1 )
+			{
+				( *pcOwned )++;
+				bOk = pURing->WriteOwned( pubData, cubData, pcubWritten, TestReleaseCounted, pcReleased );
+			}
+			else
+			{
+				bOk = pURing->Write( pubData, cubData, pcubWritten );
+				free( pubData );
+			}
+
+			if ( !bOk )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+REGISTER_NAMED_TEST( "CFileWriterURing.ShortWrites", CFileWriterURing_ShortWrites )
+{
+	int fd = TestOpenTempFile();
+	TEST_TRUE( fd >= 0 );
+
+	CFileWriterURing *pURing = CFileWriterURing::Create( fd, 4 * 1024 * 1024 );
+	if ( !pURing )
+	{
+		// no io_uring here, CFileWriter writes synchronously then
+		close( fd );
+		return;
+	}
+
+	// Every request comes back short at least once past 4k, and the rest has to be sent again
+	pURing->SetMaxBytesPerSubmit( 4096 );
+
+	uint64 cubWritten = 0;
+	int cReleased = 0, cOwned = 0;
+	TEST_TRUE( TestWriteMix( pURing, &cubWritten, &cReleased, &cOwned ) );
+	TEST_TRUE( pURing->Flush() );
+
+	TEST_EQ( cReleased, cOwned );
+	TEST_EQ( TestCountBadBytes( fd, cubWritten ), ( int64 )0 );
+
+	delete pURing;
+	close( fd );
+}
+
+REGISTER_NAMED_TEST( "CFileWriterURing.Unregistered", CFileWriterURing_Unregistered )
+{
+	int fd = TestOpenTempFile();
+	TEST_TRUE( fd >= 0 );
+
+	// As when registering the staging buffers fails: every write is a copy of its own
+	CFileWriterURing *pURing = CFileWriterURing::Create( fd, 1024 * 1024, false );
+	if ( !pURing )
+	{
+		close( fd );
+		return;
+	}
+
+	TEST_FALSE( pURing->BStagingRegistered() );
+	pURing->SetMaxBytesPerSubmit( 65536 );
+
+	uint64 cubWritten = 0;
+	int cReleased = 0, cOwned = 0;
+	TEST_TRUE( TestWriteMix( pURing, &cubWritten, &cReleased, &cOwned ) );
+
+	// Left for the destructor to flush
+	delete pURing;
+
+	TEST_EQ( cReleased, cOwned );
+	TEST_EQ( TestCountBadBytes( fd, cubWritten ), ( int64 )0 );
+	close( fd );
+}
+
+REGISTER_NAMED_TEST( "CFileWriterURing.SyncData", CFileWriterURing_SyncData )
+{
+	int fd = TestOpenTempFile();
+	TEST_TRUE( fd >= 0 );
+
+	CFileWriterURing *pURing = CFileWriterURing::Create( fd, 64 * 1024 * 1024 );
+	if ( !pURing )
+	{
+		close( fd );
+		return;
+	}
+
+	pURing->SetMaxBytesPerSubmit( 16384 );
+
+	// Everything written before the sync is done with by the time it returns, the
+	// writes that were still being sent in pieces included
+	uint64 cubWritten = 0;
+	int cReleased = 0, cOwned = 0;
+	for ( int iRound = 0; iRound < 8; iRound++ )
+	{
+		TEST_TRUE( TestWriteMix( pURing, &cubWritten, &cReleased, &cOwned ) );
+		TEST_TRUE( pURing->SyncData() );
+
+		TEST_EQ( cReleased, cOwned );
+		TEST_EQ( TestCountBadBytes( fd, cubWritten ), ( int64 )0 );
+	}
+
+	delete pURing;
+	close( fd );
+}
+
+static const int s_nTestWriterThreads = 8;
+static const int s_nTestWritesPerThread = 2000;
+
+struct TestWriterThread_t
+{
+	CFileWriterURing *m_pURing;
+	uint64 *m_pcubWritten;
+	int m_nThread;
+	int m_cFailed;
+};
+
+// Each record is its length, the thread and a sequence number, then bytes made from those
+static uint8 TestRecordByte( uint32 nThread, uint32 nSeq, uint32 i )
+{
+	return ( uint8 )( nThread * 31 + nSeq * 7 + i );
+}
+
+static uintp TestWriterThreadFn( void *pParam )
+{
+	TestWriterThread_t *pThread = ( TestWriterThread_t * )pParam;
+
+	uint8 rgubRecord[9000];
+	for ( uint32 nSeq = 0; nSeq < ( uint32 )s_nTestWritesPerThread; nSeq++ )
+	{
+		uint32 cubRecord = 12 + ( nSeq * 977 + pThread->m_nThread * 131 ) % ( sizeof( rgubRecord ) - 12 );
+		uint32 rgHeader[3] = { cubRecord, ( uint32 )pThread->m_nThread, nSeq };
+		memcpy( rgubRecord, rgHeader, sizeof( rgHeader ) );
+		for ( uint32 i = 12; i < cubRecord; i++ )
+		{
+			rgubRecord[i] = TestRecordByte( pThread->m_nThread, nSeq, i );
+		}
+
+		if ( !pThread->m_pURing->Write( rgubRecord, cubRecord, pThread->m_pcubWritten ) )
+			pThread->m_cFailed++;
+
+		if ( nSeq % 500 == 499 && !pThread->m_pURing->SyncData() )
+			pThread->m_cFailed++;
+	}
+
+	return 0;
+}
+
+REGISTER_NAMED_TEST( "CFileWriterURing.Threads", CFileWriterURing_Threads )
+{
+	int fd = TestOpenTempFile();
+	TEST_TRUE( fd >= 0 );
+
+	// A low in-flight limit, so writers keep waiting on each other's completions
+	CFileWriterURing *pURing = CFileWriterURing::Create( fd, 512 * 1024 );
+	if ( !pURing )
+	{
+		close( fd );
+		return;
+	}
+
+	pURing->SetMaxBytesPerSubmit( 32768 );
+
+	uint64 cubWritten = 0;
+	TestWriterThread_t threadData[s_nTestWriterThreads];
+	ThreadHandle_t hThreads[s_nTestWriterThreads];
+	for ( int i = 0; i < s_nTestWriterThreads; i++ )
+	{
+		threadData[i].m_pURing = pURing;
+		threadData[i].m_pcubWritten = &cubWritten;
+		threadData[i].m_nThread = i;
+		threadData[i].m_cFailed = 0;
+		hThreads[i] = CreateSimpleThread( TestWriterThreadFn, &threadData[i] );
+	}
+
+	// All joined before anything is checked, a failed check returns from the test
+	int cFailed = 0;
+	for ( int i = 0; i < s_nTestWriterThreads; i++ )
+	{
+		ThreadJoin( hThreads[i] );
+		ReleaseThreadHandle( hThreads[i] );
+		cFailed += threadData[i].m_cFailed;
+	}
+
+	TEST_EQ( cFailed, 0 );
+
+	TEST_TRUE( pURing->Flush() );
+	delete pURing;
+
+	// The records may be in any order between threads, but each is whole and a thread's are in sequence
+	TEST_EQ( ( uint64 )lseek( fd, 0, SEEK_END ), cubWritten );
+
+	uint8 *pubFile = ( uint8 * )malloc( cubWritten );
+	TEST_EQ( ( uint64 )pread( fd, pubFile, cubWritten, 0 ), cubWritten );
+
+	uint32 rgnNextSeq[s_nTestWriterThreads] = {};
+	int cBadRecords = 0;
+	for ( uint64 ulOffset = 0; ulOffset < cubWritten; )
+	{
+		uint32 rgHeader[3];
+		memcpy( rgHeader, pubFile + ulOffset, sizeof( rgHeader ) );
+		if ( rgHeader[0] < 12 || ulOffset + rgHeader[0] > cubWritten || rgHeader[1] >= ( uint32 )s_nTestWriterThreads || rgHeader[2] != rgnNextSeq[rgHeader[1]] )
+		{
+			cBadRecords++;
+			break;
+		}
+
+		for ( uint32 i = 12; i < rgHeader[0]; i++ )
+		{
+			if ( pubFile[ulOffset + i] != TestRecordByte( rgHeader[1], rgHeader[2], i ) )
+			{
+				cBadRecords++;
+				break;
+			}
+		}
+
+		rgnNextSeq[rgHeader[1]]++;
+		ulOffset += rgHeader[0];
+	}
+
+	free( pubFile );
+
+	TEST_EQ( cBadRecords, 0 );
+	for ( int i = 0; i < s_nTestWriterThreads; i++ )
+	{
+		TEST_EQ( rgnNextSeq[i], ( uint32 )s_nTestWritesPerThread );
+	}
+
+	close( fd );
+}
+
+#endif // IOURING_FILEIO
@@ -0,0 +1,212 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <tier0/utlstringtoken.h>
+#include <tier1/generichash.h>
+
+#include <string.h>
+
+static void FillHashInput( uint8 *pBuffer, int nSize )
+{
+	uint32 nState = 0x12345678;
+
+	for ( int i = 0; i < nSize; i++ )
+	{
+		nState = nState * 1664525 + 1013904223;
+		pBuffer[i] = ( uint8 )( nState >> 24 );
+	}
+}
+
+REGISTER_NAMED_TEST( "FastHash.SeedAndLengthSensitive", FastHash_SeedAndLengthSensitive )
+{
+	// Every length bucket should react to both the seed and a single flipped byte.
+	static uint8 s_Input[4096 + 1];
+	FillHashInput( s_Input, sizeof( s_Input ) );
+
+	const int nLengths[] = { 0, 1, 3, 4, 8, 9, 16, 17, 64, 128, 129, 240, 241, 1024, 1025, 4096 };
+
+	for ( int nLength : nLengths )
+	{
+		const uint64 nHash = FastHash64( s_Input, nLength );
+
+		TEST_EQ( FastHash64( s_Input, nLength ), nHash );
+		TEST_NE( FastHash64( s_Input, nLength, 1 ), nHash );
+		TEST_NE( FastHash64( s_Input, nLength + 1 ), nHash );
+		TEST_TRUE( FastHash128( s_Input, nLength ) != FastHash128( s_Input, nLength, 1 ) );
+
+		if ( nLength )
+		{
+			s_Input[nLength / 2] ^= 0x01;
+			TEST_NE( FastHash64( s_Input, nLength ), nHash );
+			s_Input[nLength / 2] ^= 0x01;
+		}
+	}
+}
+
+REGISTER_NAMED_TEST( "FastHash.CaselessMatchesLowerCase", FastHash_CaselessMatchesLowerCase )
+{
+	// Caseless variants should equal the case-sensitive hash of the lower-cased input.
+	static char s_Mixed[2048];
+	static char s_Lower[2048];
+
+	for ( int i = 0; i < ( int )sizeof( s_Mixed ); i++ )
+	{
+		// Covers letters on both sides of the folding range and bytes >= 0x80
+		const char c = ( char )( 0x3a + ( i * 7 ) % 0xc5 );
+		s_Mixed[i] = c;
+		s_Lower[i] = ( c >= 'A' && c <= 'Z' ) ? ( char )( c + ( 'a' - 'A' ) ) : c;
+	}
+
+	const int nLengths[] = { 0, 2, 5, 12, 31, 100, 200, 240, 500, 2048 };
+
+	for ( int nLength : nLengths )
+	{
+		TEST_EQ( FastHash64Caseless( s_Mixed, nLength, 7 ), FastHash64( s_Lower, nLength, 7 ) );
+		TEST_TRUE( FastHash128Caseless( s_Mixed, nLength ) == FastHash128( s_Lower, nLength ) );
+	}
+
+	TEST_EQ( FastHashStringCaseless64( "Hello_World" ), FastHashString64( "hello_world" ) );
+	TEST_NE( FastHashString64( "Hello_World" ), FastHashString64( "hello_world" ) );
+}
+
+REGISTER_NAMED_TEST( "FastHash.StreamingMatchesOneShot", FastHash_StreamingMatchesOneShot )
+{
+	// Any split of the input across Update() calls should digest to the one-shot value.
+	static uint8 s_Input[3000];
+	FillHashInput( s_Input, sizeof( s_Input ) );
+
+	const int nLengths[] = { 0, 7, 240, 241, 256, 257, 320, 1024, 1025, 2048, 3000 };
+	const int nChunks[] = { 1, 13, 64, 255, 256, 257, 1000 };
+
+	for ( int nLength : nLengths )
+	{
+		for ( int nChunk : nChunks )
+		{
+			for ( int bCaseless = 0; bCaseless < 2; bCaseless++ )
+			{
+				CFastHashState state( 42, bCaseless != 0 );
+
+				for ( int nOffset = 0; nOffset < nLength; nOffset += nChunk )
+				{
+					state.Update( s_Input + nOffset, ( nLength - nOffset ) < nChunk ? ( nLength - nOffset ) : nChunk );
+				}
+
+				TEST_EQ( state.GetTotalLength(), ( uint64 )nLength );
+
+				if ( bCaseless )
+				{
+					TEST_EQ( state.Digest64(), FastHash64Caseless( s_Input, nLength, 42 ) );
+					TEST_TRUE( state.Digest128() == FastHash128Caseless( s_Input, nLength, 42 ) );
+				}
+				else
+				{
+					TEST_EQ( state.Digest64(), FastHash64( s_Input, nLength, 42 ) );
+					TEST_TRUE( state.Digest128() == FastHash128( s_Input, nLength, 42 ) );
+				}
+			}
+		}
+	}
+}
+
+REGISTER_NAMED_TEST( "FastHash.Functors", FastHash_Functors )
+{
+	// Opt-in functors should agree with the folded 64-bit hashes.
+	FastStringHashFunctor stringHash;
+	FastCaselessStringHashFunctor caselessHash;
+	FastBlockHashFunctor< uint64 > blockHash;
+
+	const uint64 nKey = 0x0123456789abcdefull;
+
+	TEST_EQ( stringHash( "alpha" ), FastHashFold32( FastHashString64( "alpha" ) ) );
+	TEST_EQ( caselessHash( "ALPHA" ), stringHash( "alpha" ) );
+	TEST_EQ( blockHash( nKey ), FastHashFold32( FastHash64( &nKey, sizeof( nKey ) ) ) );
+}
+
+// What MurmurHash2LowerCase used to be: a lowered copy, then MurmurHash2
+static uint32 MurmurHash2LowerCaseCopy( const char *pString, int nLength, uint32 nSeed )
+{
+	static char s_Lowered[512];
+
+	for ( int i = 0; i < nLength; i++ )
+	{
+		s_Lowered[i] = ( char )TOLOWERU( ( uint8 )pString[i] );
+	}
+
+	return MurmurHash2( s_Lowered, nLength, nSeed );
+}
+
+REGISTER_NAMED_TEST( "MurmurHash2.LowerCaseMatchesCopy", MurmurHash2_LowerCaseMatchesCopy )
+{
+	// Letters, the bytes either side of them and high bytes, which are left alone
+	static const char s_Alphabet[] = "aAzZ@[`{_09\x80\xC1\xFF";
+	static char s_Input[300];
+	uint32 nState = 7;
+
+	for ( int i = 0; i < ( int )sizeof( s_Input ); i++ )
+	{
+		nState = nState * 1664525 + 1013904223;
+		s_Input[i] = s_Alphabet[( nState >> 24 ) % ( sizeof( s_Alphabet ) - 1 )];
+	}
+
+	for ( int nOffset = 0; nOffset < 4; nOffset++ )
+	{
+		for ( int nLength = 0; nLength <= 256; nLength++ )
+		{
+			TEST_EQ( MurmurHash2LowerCase( s_Input + nOffset, nLength, 0x31415926 ), MurmurHash2LowerCaseCopy( s_Input + nOffset, nLength, 0x31415926 ) );
+		}
+	}
+
+	TEST_EQ( MurmurHash2LowerCase( "Models/Player.VMDL", STRINGTOKEN_MURMURHASH_SEED ), CUtlStringToken( "models/player.vmdl" ).GetHashCode() );
+	TEST_EQ( MakeStringToken2( "m_iHealth" ).GetHashCode(), CUtlStringToken( "m_ihealth" ).GetHashCode() );
+}
+
+REGISTER_NAMED_TEST( "MurmurHash2.LowerCaseBatch", MurmurHash2_LowerCaseBatch )
+{
+	// Keys of mixed lengths, every fifth ending just short of a page boundary where
+	// the wide loads have to stop
+	const int nPage = 4096;
+	const int nKeys = 203;
+	alignas( 4096 ) static char s_Pages[nKeys / 5 + 1][nPage];
+	static char s_Keys[nKeys][80];
+	static const char *s_pKeys[nKeys];
+	static int s_nLengths[nKeys];
+	static uint32 s_nExpected[nKeys], s_nActual[nKeys + 1];
+
+	uint32 nState = 11;
+	for ( int i = 0; i < nKeys; i++ )
+	{
+		nState = nState * 1664525 + 1013904223;
+		s_nLengths[i] = ( i & 1 ) ? ( nState >> 24 ) % 24 : ( nState >> 24 ) % 79;
+
+		char *pKey = ( i % 5 == 0 ) ? s_Pages[i / 5] + nPage - 1 - s_nLengths[i] - ( i % 3 ) : s_Keys[i];
+		for ( int j = 0; j < s_nLengths[i]; j++ )
+		{
+			nState = nState * 1664525 + 1013904223;
+			pKey[j] = ( char )( ( nState >> 24 ) % 0xFF + 1 );
+		}
+		pKey[s_nLengths[i]] = 0;
+
+		s_pKeys[i] = pKey;
+		s_nExpected[i] = MurmurHash2LowerCaseCopy( pKey, s_nLengths[i], 0x31415926 );
+	}
+
+	int nMaxLevel = MurmurHash2SetSIMDLevel( 2 );
+	for ( int nLevel = 0; nLevel <= nMaxLevel; nLevel++ )
+	{
+		MurmurHash2SetSIMDLevel( nLevel );
+
+		for ( int nCount : { 0, 1, 3, 4, 7, 8, 9, 17, nKeys } )
+		{
+			memset( s_nActual, 0, sizeof( s_nActual ) );
+			MurmurHash2LowerCaseBatch( s_pKeys, s_nLengths, nCount, 0x31415926, s_nActual );
+			TEST_EQ( memcmp( s_nActual, s_nExpected, nCount * sizeof( uint32 ) ), 0 );
+			TEST_EQ( s_nActual[nCount], 0u );
+		}
+
+		memset( s_nActual, 0, sizeof( s_nActual ) );
+		MurmurHash2LowerCaseBatch( s_pKeys, NULL, nKeys, 0x31415926, s_nActual );
+		TEST_EQ( memcmp( s_nActual, s_nExpected, sizeof( s_nExpected ) ), 0 );
+	}
+
+	MurmurHash2SetSIMDLevel( 2 );
+}
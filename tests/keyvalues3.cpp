@@ -176,6 +176,25 @@ REGISTER_NAMED_TEST( "KeyValues3.Primitives", KeyValues3_Primitives )
 	TEST_TRUE( kv.GetBool() );
 }
 
+REGISTER_NAMED_TEST( "KeyValues3.TypeNames", KeyValues3_TypeNames )
+{
+	// Type names should map back to the type and subtype they were printed from.
+	KeyValues3 kv;
+
+	kv.SetInt( 5 );
+	TEST_EQ( KeyValues3::GetTypeFromString( kv.GetTypeAsString() ), kv.GetType() );
+	TEST_EQ( KeyValues3::GetSubTypeFromString( kv.GetSubTypeAsString() ), kv.GetSubType() );
+
+	kv.SetString( "value" );
+	TEST_EQ( KeyValues3::GetTypeFromString( kv.GetTypeAsString() ), KV3_TYPE_STRING );
+	TEST_EQ( KeyValues3::GetSubTypeFromString( kv.GetSubTypeAsString() ), KV3_SUBTYPE_STRING );
+
+	TEST_EQ( KeyValues3::GetTypeFromString( "table" ), KV3_TYPE_TABLE );
+	TEST_EQ( KeyValues3::GetSubTypeFromString( "rotation_vector" ), KV3_SUBTYPE_ROTATION_VECTOR );
+	TEST_EQ( KeyValues3::GetTypeFromString( "tables" ), KV3_TYPE_INVALID );
+	TEST_EQ( KeyValues3::GetSubTypeFromString( "<unknown>" ), KV3_SUBTYPE_INVALID );
+}
+
 REGISTER_NAMED_TEST( "KeyValues3.Array", KeyValues3_Array )
 {
 	// Array storage should allocate elements, expose them and support removal.
@@ -228,6 +247,26 @@ REGISTER_NAMED_TEST( "KeyValues3.Table", KeyValues3_Table )
 	TEST_EQ( kv.GetMemberInt( "answer", -1 ), -1 );
 }
 
+REGISTER_NAMED_TEST( "KeyValues3.MemberNameArrays", KeyValues3_MemberNameArrays )
+{
+	// Member names built from a char buffer should only cover the string in it.
+	char szName[64];
+	memset( szName, 'x', sizeof( szName ) );
+	V_strncpy( szName, "answer", sizeof( szName ) );
+
+	CKV3MemberName name( szName );
+	TEST_EQ( name.GetHashCode(), CKV3MemberName( "answer" ).GetHashCode() );
+
+	CKV3MemberNameWithStorage stored( szName );
+	TEST_EQ( stored.GetHashCode(), CKV3MemberName( "answer" ).GetHashCode() );
+	TEST_EQ( stored.GetStorage().Length(), 6 );
+
+	KeyValues3 kv;
+	kv.SetMemberInt( "answer", 42 );
+	TEST_EQ( kv.GetMemberInt( name ), 42 );
+	TEST_EQ( FindRequiredMember( kv, "answer" )->GetInt(), 42 );
+}
+
 REGISTER_NAMED_TEST( "KeyValues3.LoadText.KV1", KeyValues3_LoadText_KV1 )
 {
 	KeyValues3 kv;
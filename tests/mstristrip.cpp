@@ -0,0 +1,206 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <mstristrip.h>
+#include <tier1/utlvector.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// A ( nSize + 1 ) x ( nSize + 1 ) vertex grid wrapped around a cylinder, two triangles per
+// quad, with the triangles shuffled so the input order has no locality at all
+static void BuildGrid( CUtlVector< WORD > &indices, CUtlVector< float > &positions, int nSize, uint32 nSeed )
+{
+	const int nVertsPerRow = nSize + 1;
+
+	positions.SetCount( nVertsPerRow * nVertsPerRow * 3 );
+	for ( int y = 0; y < nVertsPerRow; y++ )
+	{
+		for ( int x = 0; x < nVertsPerRow; x++ )
+		{
+			float flAngle = x * 6.2831853f / nSize;
+			float *pPosition = &positions[( y * nVertsPerRow + x ) * 3];
+			pPosition[0] = cosf( flAngle );
+			pPosition[1] = sinf( flAngle );
+			pPosition[2] = ( float )y / nSize;
+		}
+	}
+
+	indices.SetCount( nSize * nSize * 6 );
+	for ( int y = 0; y < nSize; y++ )
+	{
+		for ( int x = 0; x < nSize; x++ )
+		{
+			WORD *pQuad = &indices[( y * nSize + x ) * 6];
+			int nCorner = y * nVertsPerRow + x;
+			pQuad[0] = nCorner;
+			pQuad[1] = nCorner + 1;
+			pQuad[2] = nCorner + nVertsPerRow;
+			pQuad[3] = nCorner + 1;
+			pQuad[4] = nCorner + nVertsPerRow + 1;
+			pQuad[5] = nCorner + nVertsPerRow;
+		}
+	}
+
+	int nNumTris = indices.Count() / 3;
+	for ( int i = nNumTris - 1; i > 0; i-- )
+	{
+		nSeed = nSeed * 1664525 + 1013904223;
+		int j = ( nSeed >> 8 ) % ( i + 1 );
+		for ( int k = 0; k < 3; k++ )
+		{
+			WORD nTemp = indices[i * 3 + k];
+			indices[i * 3 + k] = indices[j * 3 + k];
+			indices[j * 3 + k] = nTemp;
+		}
+	}
+}
+
+static int CompareTriangles( const void *pLeft, const void *pRight )
+{
+	return memcmp( pLeft, pRight, 3 * sizeof( WORD ) );
+}
+
+// Checks that pIndices holds exactly the triangles of the input, each with its winding kept
+static bool IsSameTriangles( const CUtlVector< WORD > &input, const WORD *pIndices, int nNumIndices )
+{
+	if ( nNumIndices != input.Count() )
+		return false;
+
+	CUtlVector< WORD > expected, actual;
+	expected.CopyArray( input.Base(), input.Count() );
+	actual.CopyArray( pIndices, nNumIndices );
+	qsort( expected.Base(), expected.Count() / 3, 3 * sizeof( WORD ), CompareTriangles );
+	qsort( actual.Base(), actual.Count() / 3, 3 * sizeof( WORD ), CompareTriangles );
+
+	return !memcmp( expected.Base(), actual.Base(), expected.Count() * sizeof( WORD ) );
+}
+
+REGISTER_NAMED_TEST( "mstristrip.ComputeACMR", mstristrip_ComputeACMR )
+{
+	WORD nOneTriangle[] = { 0, 1, 2 };
+	TEST_EQ( ComputeACMR( 3, nOneTriangle, 16 ), 3.0f );
+
+	// The second triangle shares an edge, the third is the first again
+	WORD nThreeTriangles[] = { 0, 1, 2, 2, 1, 3, 0, 1, 2 };
+	TEST_EQ( ComputeACMR( 9, nThreeTriangles, 16 ), 4.0f / 3.0f );
+
+	// A cache of 3 has lost vert 0 by the time it's needed again, and reloading it pushes out 1 and 2
+	TEST_EQ( ComputeACMR( 9, nThreeTriangles, 3 ), 7.0f / 3.0f );
+
+	TEST_EQ( ComputeACMR( 0, nOneTriangle, 16 ), 0.0f );
+}
+
+REGISTER_NAMED_TEST( "mstristrip.OptimizeVertexCache", mstristrip_OptimizeVertexCache )
+{
+	CUtlVector< WORD > input;
+	CUtlVector< float > positions;
+	BuildGrid( input, positions, 64, 1234 );
+
+	int nNumTris = input.Count() / 3;
+	int nNumIndices = 0;
+	WORD *pIndices = NULL;
+
+	TEST_EQ( OptimizeVertexCache( nNumTris, input.Base(), &nNumIndices, &pIndices ), nNumTris * 3 );
+	TEST_EQ( nNumIndices, nNumTris * 3 );
+	TEST_TRUE( IsSameTriangles( input, pIndices, nNumIndices ) );
+
+	// A regular grid gets close to one vert per two triangles; the shuffled input is near 3
+	float flInputACMR = ComputeACMR( input.Count(), input.Base(), 16 );
+	float flOptimizedACMR = ComputeACMR( nNumIndices, pIndices, 16 );
+	TEST_TRUE( flInputACMR > 2.5f );
+	TEST_TRUE( flOptimizedACMR < 0.8f );
+
+	// The vertex permutation works on the output the same way it does on strips
+	int nNumVerts = positions.Count() / 3;
+	WORD *pPermutation = NULL;
+	CUtlVector< WORD > original;
+	original.CopyArray( pIndices, nNumIndices );
+	ComputeVertexPermutation( nNumIndices, pIndices, &nNumVerts, &pPermutation );
+
+	bool bRemapped = true;
+	int nNextNewVert = 0;
+	for ( int i = 0; i < nNumIndices; i++ )
+	{
+		if ( pPermutation[pIndices[i]] != original[i] || pIndices[i] > nNextNewVert )
+			bRemapped = false;
+
+		if ( pIndices[i] == nNextNewVert )
+			nNextNewVert++;
+	}
+	TEST_TRUE( bRemapped );
+	TEST_EQ( nNextNewVert, nNumVerts );
+
+	delete [] pPermutation;
+	delete [] pIndices;
+
+	// Degenerate and repeated triangles go through untouched
+	WORD nDegenerate[] = { 0, 1, 2, 2, 2, 3, 0, 1, 2, 4, 4, 4 };
+	CUtlVector< WORD > degenerate;
+	degenerate.CopyArray( nDegenerate, ARRAYSIZE( nDegenerate ) );
+	TEST_EQ( OptimizeVertexCache( 4, degenerate.Base(), &nNumIndices, &pIndices ), 12 );
+	TEST_TRUE( IsSameTriangles( degenerate, pIndices, nNumIndices ) );
+	delete [] pIndices;
+
+	TEST_EQ( OptimizeVertexCache( 0, input.Base(), &nNumIndices, &pIndices ), 0 );
+}
+
+REGISTER_NAMED_TEST( "mstristrip.OverdrawClusters", mstristrip_OverdrawClusters )
+{
+	CUtlVector< WORD > input;
+	CUtlVector< float > positions;
+	BuildGrid( input, positions, 96, 4321 );
+
+	int nNumTris = input.Count() / 3;
+	int nNumIndices = 0;
+	WORD *pCacheOnly = NULL;
+	WORD *pClustered = NULL;
+
+	OptimizeVertexCache( nNumTris, input.Base(), &nNumIndices, &pCacheOnly );
+	OptimizeVertexCache( nNumTris, input.Base(), &nNumIndices, &pClustered, positions.Base(), 3 * sizeof( float ) );
+
+	TEST_TRUE( IsSameTriangles( input, pClustered, nNumIndices ) );
+
+	// Sorting the clusters may only lose a little of the cache reuse
+	float flCacheOnlyACMR = ComputeACMR( nNumIndices, pCacheOnly, 16 );
+	float flClusteredACMR = ComputeACMR( nNumIndices, pClustered, 16 );
+	TEST_TRUE( flClusteredACMR < flCacheOnlyACMR * 1.1f );
+
+	delete [] pCacheOnly;
+	delete [] pClustered;
+}
+
+REGISTER_NAMED_TEST( "mstristrip.OptimizeVertexCacheBatch", mstristrip_OptimizeVertexCacheBatch )
+{
+	const int nNumMeshes = 9;
+
+	CUtlVector< WORD > inputs[nNumMeshes];
+	CUtlVector< float > positions[nNumMeshes];
+	VERTEXCACHEMESH meshes[nNumMeshes];
+
+	for ( int i = 0; i < nNumMeshes; i++ )
+	{
+		BuildGrid( inputs[i], positions[i], 8 + i * 5, 100 + i );
+		meshes[i].numtris = inputs[i].Count() / 3;
+		meshes[i].ptriangles = inputs[i].Base();
+		meshes[i].pvertexpositions = ( i & 1 ) ? positions[i].Base() : NULL;
+		meshes[i].vertexstride = 0;
+	}
+
+	OptimizeVertexCacheBatch( nNumMeshes, meshes, 4 );
+
+	// Each mesh comes out the same as on its own
+	for ( int i = 0; i < nNumMeshes; i++ )
+	{
+		int nNumIndices = 0;
+		WORD *pIndices = NULL;
+		OptimizeVertexCache( meshes[i].numtris, inputs[i].Base(), &nNumIndices, &pIndices, meshes[i].pvertexpositions );
+
+		TEST_EQ( meshes[i].numindices, nNumIndices );
+		TEST_TRUE( !memcmp( meshes[i].pindices, pIndices, nNumIndices * sizeof( WORD ) ) );
+
+		delete [] pIndices;
+		delete [] meshes[i].pindices;
+	}
+}
@@ -0,0 +1,285 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <mathlib/polyhedron.h>
+#include <tier0/threadtools.h>
+
+#include <math.h>
+
+static const float s_flOnPlaneEpsilon = 0.01f;
+
+static float TestRandom( uint32 &nSeed )
+{
+	nSeed = nSeed * 1664525 + 1013904223;
+	return ( ( nSeed >> 8 ) & 0xffff ) * ( 1.0f / 65536.0f );
+}
+
+// A rotated box with a few of its corners and edges bevelled off, like a typical brush.
+// Returns the plane count, pPlanes needs room for 4 * 14 floats.
+static int MakeBrushPlanes( float *pPlanes, uint32 nSeed )
+{
+	QAngle angles( TestRandom( nSeed ) * 360.0f, TestRandom( nSeed ) * 360.0f, TestRandom( nSeed ) * 360.0f );
+	Vector vCenter( TestRandom( nSeed ) * 2000.0f - 1000.0f, TestRandom( nSeed ) * 2000.0f - 1000.0f, TestRandom( nSeed ) * 2000.0f - 1000.0f );
+	Vector vExtents( 16.0f + TestRandom( nSeed ) * 240.0f, 16.0f + TestRandom( nSeed ) * 240.0f, 16.0f + TestRandom( nSeed ) * 240.0f );
+
+	matrix3x4_t rotation;
+	AngleMatrix( angles, rotation );
+
+	int nPlanes = 0;
+	for ( int nAxis = 0; nAxis < 3; nAxis++ )
+	{
+		Vector vAxis;
+		MatrixGetColumn( rotation, nAxis, vAxis );
+
+		for ( int nSign = -1; nSign <= 1; nSign += 2 )
+		{
+			Vector vNormal = vAxis * ( float )nSign;
+			pPlanes[nPlanes * 4 + 0] = vNormal.x;
+			pPlanes[nPlanes * 4 + 1] = vNormal.y;
+			pPlanes[nPlanes * 4 + 2] = vNormal.z;
+			pPlanes[nPlanes * 4 + 3] = vNormal.Dot( vCenter ) + vExtents[nAxis];
+			nPlanes++;
+		}
+	}
+
+	int nBevels = nSeed % 9;
+	for ( int i = 0; i < nBevels; i++ )
+	{
+		Vector vLocal( TestRandom( nSeed ) * 2.0f - 1.0f, TestRandom( nSeed ) * 2.0f - 1.0f, TestRandom( nSeed ) * 2.0f - 1.0f );
+		VectorNormalize( vLocal );
+
+		Vector vNormal;
+		VectorRotate( vLocal, rotation, vNormal );
+
+		// Support distance of the box along the normal, pulled in so the plane cuts something
+		float flSupport = fabsf( vLocal.x ) * vExtents.x + fabsf( vLocal.y ) * vExtents.y + fabsf( vLocal.z ) * vExtents.z;
+		pPlanes[nPlanes * 4 + 0] = vNormal.x;
+		pPlanes[nPlanes * 4 + 1] = vNormal.y;
+		pPlanes[nPlanes * 4 + 2] = vNormal.z;
+		pPlanes[nPlanes * 4 + 3] = vNormal.Dot( vCenter ) + flSupport * ( 0.6f + TestRandom( nSeed ) * 0.35f );
+		nPlanes++;
+	}
+
+	return nPlanes;
+}
+
+// Each line is used by exactly two polygons, once in each direction, the polygons are closed
+// loops wound clockwise seen from outside, and every point is inside all the planes.
+static bool IsValidPolyhedron( const CPolyhedron *pPolyhedron, const float *pPlanes, int nPlanes )
+{
+	CUtlVector< int > lineUses;
+	lineUses.SetCount( pPolyhedron->iLineCount );
+	for ( int i = 0; i < lineUses.Count(); i++ )
+	{
+		lineUses[i] = 0;
+	}
+
+	for ( int i = 0; i < pPolyhedron->iPolygonCount; i++ )
+	{
+		const Polyhedron_IndexedPolygon_t &polygon = pPolyhedron->pPolygons[i];
+		if ( polygon.iIndexCount < 3 )
+			return false;
+
+		Vector vWinding( 0.0f, 0.0f, 0.0f );
+		for ( int j = 0; j < polygon.iIndexCount; j++ )
+		{
+			const Polyhedron_IndexedLineReference_t &reference = pPolyhedron->pIndices[polygon.iFirstIndex + j];
+			const Polyhedron_IndexedLineReference_t &next = pPolyhedron->pIndices[polygon.iFirstIndex + ( j + 1 ) % polygon.iIndexCount];
+			const Polyhedron_IndexedLine_t &line = pPolyhedron->pLines[reference.iLineIndex];
+			const Polyhedron_IndexedLine_t &nextLine = pPolyhedron->pLines[next.iLineIndex];
+
+			if ( line.iPointIndices[reference.iEndPointIndex] != nextLine.iPointIndices[1 - next.iEndPointIndex] )
+				return false;
+
+			lineUses[reference.iLineIndex] += reference.iEndPointIndex ? 1 : 16;
+
+			vWinding += CrossProduct( pPolyhedron->pVertices[line.iPointIndices[1 - reference.iEndPointIndex]], pPolyhedron->pVertices[line.iPointIndices[reference.iEndPointIndex]] );
+		}
+
+		if ( vWinding.Dot( polygon.polyNormal ) >= 0.0f )
+			return false;
+	}
+
+	for ( int i = 0; i < lineUses.Count(); i++ )
+	{
+		if ( lineUses[i] != 17 )
+			return false;
+	}
+
+	for ( int i = 0; i < pPolyhedron->iVertexCount; i++ )
+	{
+		for ( int j = 0; j < nPlanes; j++ )
+		{
+			if ( DotProduct( *( const Vector * )&pPlanes[j * 4], pPolyhedron->pVertices[i] ) - pPlanes[j * 4 + 3] > 0.1f )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+// Same points (in any order) and the same number of lines and polygons
+static bool MatchesPolyhedron( const CPolyhedron *pA, const CPolyhedron *pB )
+{
+	if ( pA->iVertexCount != pB->iVertexCount || pA->iLineCount != pB->iLineCount || pA->iPolygonCount != pB->iPolygonCount )
+		return false;
+
+	for ( int i = 0; i < pA->iVertexCount; i++ )
+	{
+		bool bFound = false;
+		for ( int j = 0; j < pB->iVertexCount && !bFound; j++ )
+		{
+			bFound = pA->pVertices[i].DistToSqr( pB->pVertices[j] ) < 0.01f * 0.01f;
+		}
+
+		if ( !bFound )
+			return false;
+	}
+
+	return true;
+}
+
+REGISTER_NAMED_TEST( "CPolyhedron.GenerateBox", CPolyhedron_GenerateBox )
+{
+	const float planes[6 * 4] =
+	{
+		1.0f, 0.0f, 0.0f, 10.0f,	-1.0f, 0.0f, 0.0f, 10.0f,
+		0.0f, 1.0f, 0.0f, 20.0f,	0.0f, -1.0f, 0.0f, 20.0f,
+		0.0f, 0.0f, 1.0f, 30.0f,	0.0f, 0.0f, -1.0f, 30.0f,
+	};
+
+	CPolyhedronClipScratch scratch;
+	CPolyhedron *pBox = GeneratePolyhedronFromPlanes( planes, 6, s_flOnPlaneEpsilon, scratch );
+	TEST_NOT_NULL( pBox );
+	TEST_EQ( ( int )pBox->iVertexCount, 8 );
+	TEST_EQ( ( int )pBox->iLineCount, 12 );
+	TEST_EQ( ( int )pBox->iIndexCount, 24 );
+	TEST_EQ( ( int )pBox->iPolygonCount, 6 );
+	TEST_TRUE( IsValidPolyhedron( pBox, planes, 6 ) );
+
+	CPolyhedron *pLinked = GeneratePolyhedronFromPlanes( planes, 6, s_flOnPlaneEpsilon );
+	TEST_TRUE( MatchesPolyhedron( pBox, pLinked ) );
+	pLinked->Release();
+
+	// Planes that don't cut leave it alone, planes that cut everything away leave nothing
+	const float outside[4] = { 1.0f, 0.0f, 0.0f, 50.0f };
+	CPolyhedron *pSame = ClipPolyhedron( pBox, outside, 1, s_flOnPlaneEpsilon, scratch, true );
+	TEST_TRUE( MatchesPolyhedron( pBox, pSame ) );
+
+	const float behind[4] = { -1.0f, 0.0f, 0.0f, -10.0f };
+	TEST_NULL( ClipPolyhedron( pBox, behind, 1, s_flOnPlaneEpsilon, scratch ) );
+
+	pBox->Release();
+}
+
+REGISTER_NAMED_TEST( "CPolyhedron.GenerateBrushes", CPolyhedron_GenerateBrushes )
+{
+	// The reentrant version should give the same shapes as the linked one
+	CPolyhedronClipScratch scratch;
+
+	for ( int i = 0; i < 500; i++ )
+	{
+		float planes[14 * 4];
+		int nPlanes = MakeBrushPlanes( planes, 0x9e3779b9 * ( i + 1 ) );
+
+		CPolyhedron *pLinked = GeneratePolyhedronFromPlanes( planes, nPlanes, s_flOnPlaneEpsilon );
+		CPolyhedron *pReentrant = GeneratePolyhedronFromPlanes( planes, nPlanes, s_flOnPlaneEpsilon, scratch, ( i & 1 ) != 0 );
+
+		TEST_NOT_NULL( pLinked );
+		TEST_NOT_NULL( pReentrant );
+		TEST_TRUE( IsValidPolyhedron( pReentrant, planes, nPlanes ) );
+		TEST_TRUE( MatchesPolyhedron( pReentrant, pLinked ) );
+
+		pLinked->Release();
+		pReentrant->Release();
+	}
+}
+
+REGISTER_NAMED_TEST( "CPolyhedron.ClipBrushes", CPolyhedron_ClipBrushes )
+{
+	CPolyhedronClipScratch scratch;
+
+	for ( int i = 0; i < 200; i++ )
+	{
+		float planes[14 * 4];
+		int nPlanes = MakeBrushPlanes( planes, 0x85ebca6b * ( i + 1 ) );
+		CPolyhedron *pBrush = GeneratePolyhedronFromPlanes( planes, 6, s_flOnPlaneEpsilon );
+		TEST_NOT_NULL( pBrush );
+
+		// Cut the plain box by the bevels, both from a separate polyhedron and from the scratch's own output
+		CPolyhedron *pLinked = ClipPolyhedron( pBrush, planes + 6 * 4, nPlanes - 6, s_flOnPlaneEpsilon );
+		CPolyhedron *pReentrant = ClipPolyhedron( pBrush, planes + 6 * 4, nPlanes - 6, s_flOnPlaneEpsilon, scratch );
+		TEST_TRUE( IsValidPolyhedron( pReentrant, planes, nPlanes ) );
+		TEST_TRUE( MatchesPolyhedron( pReentrant, pLinked ) );
+
+		CPolyhedron *pInPlace = ClipPolyhedron( pBrush, planes + 6 * 4, 0, s_flOnPlaneEpsilon, scratch, true );
+		for ( int j = 6; j < nPlanes; j++ )
+		{
+			pInPlace = ClipPolyhedron( pInPlace, planes + j * 4, 1, s_flOnPlaneEpsilon, scratch, true );
+			TEST_NOT_NULL( pInPlace );
+		}
+		TEST_TRUE( MatchesPolyhedron( pInPlace, pLinked ) );
+
+		pBrush->Release();
+		pLinked->Release();
+		pReentrant->Release();
+	}
+}
+
+struct PolyhedronThreadWork_t
+{
+	int m_nFirstBrush;
+	int m_nBrushCount;
+	int *m_pVertexCounts;
+};
+
+static uintp PolyhedronThreadFunc( void *pParam )
+{
+	const PolyhedronThreadWork_t &work = *( const PolyhedronThreadWork_t * )pParam;
+	CPolyhedronClipScratch scratch;
+
+	for ( int i = 0; i < work.m_nBrushCount; i++ )
+	{
+		float planes[14 * 4];
+		int nPlanes = MakeBrushPlanes( planes, 0xc2b2ae35 * ( work.m_nFirstBrush + i + 1 ) );
+
+		CPolyhedron *pPolyhedron = GeneratePolyhedronFromPlanes( planes, nPlanes, s_flOnPlaneEpsilon, scratch, true );
+		work.m_pVertexCounts[work.m_nFirstBrush + i] = pPolyhedron ? pPolyhedron->iVertexCount : -1;
+	}
+
+	return 0;
+}
+
+REGISTER_NAMED_TEST( "CPolyhedron.Concurrent", CPolyhedron_Concurrent )
+{
+	// Each thread with its own scratch gets the same results as doing it all on one thread
+	const int nThreads = 4;
+	const int nBrushesPerThread = 300;
+	int nSerialCounts[nThreads * nBrushesPerThread];
+	int nThreadedCounts[nThreads * nBrushesPerThread];
+
+	PolyhedronThreadWork_t serial = { 0, nThreads * nBrushesPerThread, nSerialCounts };
+	PolyhedronThreadFunc( &serial );
+
+	PolyhedronThreadWork_t work[nThreads];
+	ThreadHandle_t hThreads[nThreads];
+	for ( int i = 0; i < nThreads; i++ )
+	{
+		work[i].m_nFirstBrush = i * nBrushesPerThread;
+		work[i].m_nBrushCount = nBrushesPerThread;
+		work[i].m_pVertexCounts = nThreadedCounts;
+		hThreads[i] = CreateSimpleThread( PolyhedronThreadFunc, &work[i] );
+	}
+
+	for ( int i = 0; i < nThreads; i++ )
+	{
+		ThreadJoin( hThreads[i] );
+		ReleaseThreadHandle( hThreads[i] );
+	}
+
+	for ( int i = 0; i < nThreads * nBrushesPerThread; i++ )
+	{
+		TEST_TRUE( nSerialCounts[i] > 0 );
+		TEST_EQ( nThreadedCounts[i], nSerialCounts[i] );
+	}
+}
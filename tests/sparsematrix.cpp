@@ -0,0 +1,320 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <tier1/sparsematrix.h>
+
+#include <math.h>
+
+static float RandomValue( uint32 &nSeed )
+{
+	nSeed = nSeed * 1664525 + 1013904223;
+	return ( ( nSeed >> 8 ) & 0xffff ) * ( 1.0f / 32768.0f ) - 1.0f;
+}
+
+static int RandomIndex( uint32 &nSeed, int nRange )
+{
+	nSeed = nSeed * 1664525 + 1013904223;
+	return ( nSeed >> 8 ) % nRange;
+}
+
+// Deterministic triplets in no particular order, with repeated positions and some pairs that cancel out
+static void FillTriplets( CUtlVector< CSparseMatrix::Triplet_t > &triplets, int nNumRows, int nNumCols, int nCount, uint32 nSeed )
+{
+	triplets.RemoveAll();
+
+	for ( int i = 0; i < nCount; i++ )
+	{
+		CSparseMatrix::Triplet_t triplet;
+		triplet.m_nRow = RandomIndex( nSeed, nNumRows );
+		triplet.m_nColumnNumber = ( i % 5 ) ? RandomIndex( nSeed, nNumCols ) : ( triplet.m_nRow * 7 ) % nNumCols;
+		triplet.m_flValue = ( i % 11 ) ? RandomValue( nSeed ) : 0.0f;
+		triplets.AddToTail( triplet );
+
+		if ( i % 17 == 0 )
+		{
+			triplet.m_flValue = -triplet.m_flValue;
+			triplets.AddToTail( triplet );
+		}
+	}
+}
+
+// Checks the storage invariants: rows packed back to back, columns strictly increasing, no zeros
+static bool IsWellFormed( const CSparseMatrix &matrix )
+{
+	int nDataIndex = 0;
+	for ( int i = 0; i < matrix.Height(); i++ )
+	{
+		const CSparseMatrix::RowDescriptor_t &row = matrix.m_rowDescriptors[i];
+		if ( row.m_nDataIndex != nDataIndex )
+			return false;
+
+		for ( int j = 0; j < row.m_nNonZeroCount; j++ )
+		{
+			const CSparseMatrix::NonZeroValueDescriptor_t &entry = matrix.m_entries[nDataIndex + j];
+			if ( entry.m_flValue == 0.0f || entry.m_nColumnNumber < 0 || entry.m_nColumnNumber >= matrix.Width() )
+				return false;
+
+			if ( j && matrix.m_entries[nDataIndex + j - 1].m_nColumnNumber >= entry.m_nColumnNumber )
+				return false;
+		}
+
+		nDataIndex += row.m_nNonZeroCount;
+	}
+
+	return nDataIndex == matrix.NonZeroCount();
+}
+
+// A 2D grid Laplacian plus a little on the diagonal, which is symmetric positive definite
+static void BuildLaplacian( CSparseMatrix &matrix, int nSize )
+{
+	CSparseMatrixBuilder builder;
+	builder.SetDimensions( nSize * nSize, nSize * nSize );
+
+	for ( int y = 0; y < nSize; y++ )
+	{
+		for ( int x = 0; x < nSize; x++ )
+		{
+			int nIndex = y * nSize + x;
+			builder.AddElement( nIndex, nIndex, 4.1f );
+
+			if ( x > 0 )
+				builder.AddElement( nIndex, nIndex - 1, -1.0f );
+
+			if ( x + 1 < nSize )
+				builder.AddElement( nIndex, nIndex + 1, -1.0f );
+
+			if ( y > 0 )
+				builder.AddElement( nIndex, nIndex - nSize, -1.0f );
+
+			if ( y + 1 < nSize )
+				builder.AddElement( nIndex, nIndex + nSize, -1.0f );
+		}
+	}
+
+	builder.Build( &matrix );
+}
+
+REGISTER_NAMED_TEST( "CSparseMatrix.SetFromTriplets", CSparseMatrix_SetFromTriplets )
+{
+	// Some rows get far more than the insertion sort handles
+	for ( int nCase = 0; nCase < 3; nCase++ )
+	{
+		const int nNumRows = ( nCase == 2 ) ? 4 : 50;
+		const int nNumCols = 40 + nCase * 30;
+
+		CUtlVector< CSparseMatrix::Triplet_t > triplets;
+		FillTriplets( triplets, nNumRows, nNumCols, 600, 1234 + nCase );
+
+		CSparseMatrix reference;
+		reference.SetDimensions( nNumRows, nNumCols );
+		for ( int i = 0; i < triplets.Count(); i++ )
+		{
+			const CSparseMatrix::Triplet_t &triplet = triplets[i];
+			reference.SetElement( triplet.m_nRow, triplet.m_nColumnNumber, reference.Element( triplet.m_nRow, triplet.m_nColumnNumber ) + triplet.m_flValue );
+		}
+
+		CSparseMatrix matrix;
+		matrix.SetFromTriplets( nNumRows, nNumCols, triplets.Base(), triplets.Count() );
+
+		TEST_TRUE( IsWellFormed( matrix ) );
+		TEST_EQ( matrix.Height(), nNumRows );
+		TEST_EQ( matrix.Width(), nNumCols );
+
+		// Sums may round differently in a different order, but what's stored has to match
+		bool bMatches = true;
+		for ( int i = 0; i < nNumRows; i++ )
+		{
+			for ( int j = 0; j < nNumCols; j++ )
+			{
+				if ( fabsf( matrix.Element( i, j ) - reference.Element( i, j ) ) > 1.0e-5f )
+					bMatches = false;
+			}
+		}
+		TEST_TRUE( bMatches );
+
+		// Replacing the contents starts from scratch
+		matrix.SetFromTriplets( nNumRows, nNumCols, triplets.Base(), 0 );
+		TEST_EQ( matrix.NonZeroCount(), 0 );
+		TEST_TRUE( IsWellFormed( matrix ) );
+	}
+}
+
+REGISTER_NAMED_TEST( "CSparseMatrix.Builder", CSparseMatrix_Builder )
+{
+	CSparseMatrixBuilder builder;
+	builder.SetDimensions( 3, 4 );
+	builder.AddElement( 2, 3, 1.0f );
+	builder.AddElement( 0, 1, 2.0f );
+	builder.AddElement( 2, 0, 3.0f );
+	builder.AddElement( 0, 1, 0.5f );
+	builder.AddElement( 1, 2, 1.0f );
+	builder.AddElement( 1, 2, -1.0f );
+	TEST_EQ( builder.Count(), 6 );
+
+	CSparseMatrix matrix;
+	builder.Build( &matrix );
+
+	TEST_TRUE( IsWellFormed( matrix ) );
+	TEST_EQ( matrix.NonZeroCount(), 3 );
+	TEST_EQ( matrix.Element( 0, 1 ), 2.5f );
+	TEST_EQ( matrix.Element( 1, 2 ), 0.0f );
+	TEST_EQ( matrix.Element( 2, 0 ), 3.0f );
+	TEST_EQ( matrix.Element( 2, 3 ), 1.0f );
+
+	// The result is an ordinary CSparseMatrix, SetElement keeps working on it
+	matrix.SetElement( 1, 1, 4.0f );
+	matrix.SetElement( 2, 0, 0.0f );
+	TEST_TRUE( IsWellFormed( matrix ) );
+	TEST_EQ( matrix.Element( 1, 1 ), 4.0f );
+	TEST_EQ( matrix.NonZeroCount(), 3 );
+
+	builder.SetDimensions( 2, 2 );
+	TEST_EQ( builder.Count(), 0 );
+}
+
+REGISTER_NAMED_TEST( "CSparseMatrix.MultiplyVector", CSparseMatrix_MultiplyVector )
+{
+	// Large enough for the threaded path, with rows from empty to a few hundred long
+	const int nNumRows = 4000;
+	const int nNumCols = 2000;
+
+	CUtlVector< CSparseMatrix::Triplet_t > triplets;
+	uint32 nSeed = 99;
+	for ( int i = 0; i < nNumRows; i++ )
+	{
+		int nRowCount = ( i % 10 == 0 ) ? 0 : ( i % 97 == 0 ) ? 300 : 1 + RandomIndex( nSeed, 40 );
+		for ( int j = 0; j < nRowCount; j++ )
+		{
+			CSparseMatrix::Triplet_t triplet = { i, RandomIndex( nSeed, nNumCols ), RandomValue( nSeed ) };
+			triplets.AddToTail( triplet );
+		}
+	}
+
+	CSparseMatrix matrix;
+	matrix.SetFromTriplets( nNumRows, nNumCols, triplets.Base(), triplets.Count() );
+	TEST_TRUE( matrix.NonZeroCount() > 65536 );
+
+	CUtlVector< float > vector;
+	vector.SetCount( nNumCols );
+	for ( int i = 0; i < nNumCols; i++ )
+	{
+		vector[i] = RandomValue( nSeed );
+	}
+
+	CUtlVector< float > expected;
+	expected.SetCount( nNumRows );
+	for ( int i = 0; i < nNumRows; i++ )
+	{
+		double flSum = 0;
+		for ( int j = 0; j < matrix.m_rowDescriptors[i].m_nNonZeroCount; j++ )
+		{
+			const CSparseMatrix::NonZeroValueDescriptor_t &entry = matrix.m_entries[matrix.m_rowDescriptors[i].m_nDataIndex + j];
+			flSum += double( entry.m_flValue ) * vector[entry.m_nColumnNumber];
+		}
+		expected[i] = float( flSum );
+	}
+
+	for ( int nThreads = 1; nThreads <= 4; nThreads += 3 )
+	{
+		CUtlVector< float > result;
+		result.SetCount( nNumRows );
+		matrix.MultiplyVector( vector.Base(), result.Base(), nThreads );
+
+		bool bMatches = true;
+		for ( int i = 0; i < nNumRows; i++ )
+		{
+			if ( fabsf( result[i] - expected[i] ) > 1.0e-4f )
+				bMatches = false;
+		}
+		TEST_TRUE( bMatches );
+	}
+}
+
+REGISTER_NAMED_TEST( "CSparseMatrix.MultiplyDense", CSparseMatrix_MultiplyDense )
+{
+	const int nNumRows = 60;
+	const int nNumCols = 45;
+
+	CUtlVector< CSparseMatrix::Triplet_t > triplets;
+	FillTriplets( triplets, nNumRows, nNumCols, 900, 4321 );
+
+	CSparseMatrix matrix;
+	matrix.SetFromTriplets( nNumRows, nNumCols, triplets.Base(), triplets.Count() );
+
+	// Column counts that hit each of the 16 wide, 4 wide and scalar loops
+	const int nColumnCounts[] = { 1, 3, 4, 16, 23, 37 };
+	for ( int c = 0; c < ARRAYSIZE( nColumnCounts ); c++ )
+	{
+		const int nColumns = nColumnCounts[c];
+		uint32 nSeed = 7 + c;
+
+		CUtlVector< float > dense, result;
+		dense.SetCount( nNumCols * nColumns );
+		result.SetCount( nNumRows * nColumns );
+		for ( int i = 0; i < dense.Count(); i++ )
+		{
+			dense[i] = RandomValue( nSeed );
+		}
+
+		matrix.MultiplyDense( dense.Base(), nColumns, result.Base(), 2 );
+
+		bool bMatches = true;
+		for ( int i = 0; i < nNumRows; i++ )
+		{
+			for ( int k = 0; k < nColumns; k++ )
+			{
+				double flSum = 0;
+				for ( int j = 0; j < nNumCols; j++ )
+				{
+					flSum += double( matrix.Element( i, j ) ) * dense[j * nColumns + k];
+				}
+
+				if ( fabs( result[i * nColumns + k] - flSum ) > 1.0e-4 )
+					bMatches = false;
+			}
+		}
+		TEST_TRUE( bMatches );
+	}
+}
+
+REGISTER_NAMED_TEST( "CSparseMatrix.SolveConjugateGradient", CSparseMatrix_SolveConjugateGradient )
+{
+	const int nSize = 40;
+	const int nCount = nSize * nSize;
+
+	CSparseMatrix matrix;
+	BuildLaplacian( matrix, nSize );
+	TEST_TRUE( IsWellFormed( matrix ) );
+
+	CUtlVector< float > expected, rhs, solution;
+	expected.SetCount( nCount );
+	rhs.SetCount( nCount );
+	solution.SetCount( nCount );
+
+	uint32 nSeed = 2024;
+	for ( int i = 0; i < nCount; i++ )
+	{
+		expected[i] = RandomValue( nSeed );
+		solution[i] = 0.0f;
+	}
+	matrix.MultiplyVector( expected.Base(), rhs.Base() );
+
+	int nIterations = matrix.SolveConjugateGradient( rhs.Base(), solution.Base(), 500, 1.0e-6f, 2 );
+	TEST_TRUE( nIterations > 0 && nIterations < 500 );
+
+	float flMaxError = 0.0f;
+	for ( int i = 0; i < nCount; i++ )
+	{
+		flMaxError = MAX( flMaxError, fabsf( solution[i] - expected[i] ) );
+	}
+	TEST_TRUE( flMaxError < 1.0e-4f );
+
+	// Starting from the answer takes no iterations, running out of them reports failure
+	TEST_EQ( matrix.SolveConjugateGradient( rhs.Base(), solution.Base(), 500, 1.0e-3f ), 0 );
+
+	for ( int i = 0; i < nCount; i++ )
+	{
+		solution[i] = 0.0f;
+	}
+	TEST_EQ( matrix.SolveConjugateGradient( rhs.Base(), solution.Base(), 2, 1.0e-6f ), -1 );
+}
@@ -0,0 +1,304 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <mathlib/mathlib.h>
+#include <mathlib/ssemath.h>
+
+#include <math.h>
+
+// Deterministic boxes scattered around the origin, some of them degenerate
+static void FillBoxes( FourVectors *pMins, FourVectors *pMaxs, Vector *pMinsAoS, Vector *pMaxsAoS, int nBoxes )
+{
+	uint32 nSeed = 0x2545f491;
+
+	for ( int i = 0; i < ( nBoxes + 3 ) / 4 * 4; i++ )
+	{
+		float flValues[6];
+
+		for ( int k = 0; k < 6; k++ )
+		{
+			nSeed = nSeed * 1664525 + 1013904223;
+			flValues[k] = ( ( nSeed >> 8 ) & 0xffff ) * ( 1.0f / 65536.0f );
+		}
+
+		Vector vCenter( flValues[0] * 4000.0f - 2000.0f, flValues[1] * 4000.0f - 2000.0f, flValues[2] * 1000.0f - 500.0f );
+		Vector vExtents( flValues[3] * 100.0f, flValues[4] * 100.0f, ( i % 7 ) ? flValues[5] * 100.0f : 0.0f );
+
+		pMins[i >> 2].X( i & 3 ) = vCenter.x - vExtents.x;
+		pMins[i >> 2].Y( i & 3 ) = vCenter.y - vExtents.y;
+		pMins[i >> 2].Z( i & 3 ) = vCenter.z - vExtents.z;
+		pMaxs[i >> 2].X( i & 3 ) = vCenter.x + vExtents.x;
+		pMaxs[i >> 2].Y( i & 3 ) = vCenter.y + vExtents.y;
+		pMaxs[i >> 2].Z( i & 3 ) = vCenter.z + vExtents.z;
+
+		if ( i < nBoxes )
+		{
+			pMinsAoS[i] = vCenter - vExtents;
+			pMaxsAoS[i] = vCenter + vExtents;
+		}
+	}
+}
+
+static bool IsBitSet( const uint32 *pBits, int i )
+{
+	return ( pBits[i >> 5] >> ( i & 31 ) ) & 1;
+}
+
+REGISTER_NAMED_TEST( "Frustum_t.CullBoxes", Frustum_t_CullBoxes )
+{
+	// The batched cull should agree with CullBox box for box, on both the 4 and 8 wide paths.
+	const int nBoxes = 203;
+	static FourVectors s_Mins[( nBoxes + 3 ) / 4], s_Maxs[( nBoxes + 3 ) / 4];
+	static FourVectors s_Centers[( nBoxes + 3 ) / 4], s_Extents[( nBoxes + 3 ) / 4];
+	static Vector s_MinsAoS[nBoxes], s_MaxsAoS[nBoxes];
+
+	FillBoxes( s_Mins, s_Maxs, s_MinsAoS, s_MaxsAoS, nBoxes );
+
+	for ( int g = 0; g < ( nBoxes + 3 ) / 4; g++ )
+	{
+		s_Centers[g] = s_Mins[g];
+		s_Centers[g] += s_Maxs[g];
+		s_Centers[g] *= 0.5f;
+		s_Extents[g] = s_Maxs[g];
+		s_Extents[g] -= s_Centers[g];
+	}
+
+	Frustum_t frustum;
+	frustum.CreatePerspectiveFrustum( Vector( 10.0f, -20.0f, 30.0f ), QAngle( 10.0f, 35.0f, 0.0f ), 4.0f, 3000.0f, 90.0f, 16.0f / 9.0f );
+
+	const bool bSIMD8 = MathLib_SIMD8Enabled();
+
+	for ( int nPass = 0; nPass < 2; nPass++ )
+	{
+		MathLib_SetSIMD8Enabled( nPass == 0 );
+
+		uint32 nCulled[( nBoxes + 31 ) / 32], nCulledCenterExtents[( nBoxes + 31 ) / 32];
+		int nCount = frustum.CullBoxes( s_Mins, s_Maxs, nBoxes, nCulled );
+		int nCountCenterExtents = frustum.CullBoxesCenterExtents( s_Centers, s_Extents, nBoxes, nCulledCenterExtents );
+
+		int nExpected = 0, nExpectedCenterExtents = 0;
+
+		for ( int i = 0; i < nBoxes; i++ )
+		{
+			Vector vCenter = s_Centers[i >> 2].Vec( i & 3 );
+			Vector vExtents = s_Extents[i >> 2].Vec( i & 3 );
+
+			bool bCulled = frustum.CullBox( s_MinsAoS[i], s_MaxsAoS[i] );
+			bool bCulledCenterExtents = frustum.CullBoxCenterExtents( vCenter, vExtents );
+
+			TEST_EQ( IsBitSet( nCulled, i ), bCulled );
+			TEST_EQ( IsBitSet( nCulledCenterExtents, i ), bCulledCenterExtents );
+
+			nExpected += bCulled;
+			nExpectedCenterExtents += bCulledCenterExtents;
+		}
+
+		TEST_EQ( nCount, nExpected );
+		TEST_EQ( nCountCenterExtents, nExpectedCenterExtents );
+
+		// the view should see some of the boxes but not all of them
+		TEST_TRUE( nExpected > 0 && nExpected < nBoxes );
+
+		// nothing past the last box
+		TEST_EQ( nCulled[nBoxes >> 5] >> ( nBoxes & 31 ), 0u );
+	}
+
+	MathLib_SetSIMD8Enabled( bSIMD8 );
+}
+
+REGISTER_NAMED_TEST( "TransformAABBs", TransformAABBs )
+{
+	// Both batched transforms should give TransformAABB's result for every box.
+	const int nBoxes = 37;
+	static FourVectors s_Mins[( nBoxes + 3 ) / 4], s_Maxs[( nBoxes + 3 ) / 4];
+	static FourVectors s_MinsOut[( nBoxes + 3 ) / 4], s_MaxsOut[( nBoxes + 3 ) / 4];
+	static Vector s_MinsAoS[nBoxes], s_MaxsAoS[nBoxes];
+	static matrix3x4_t s_Transforms[nBoxes];
+
+	FillBoxes( s_Mins, s_Maxs, s_MinsAoS, s_MaxsAoS, nBoxes );
+
+	for ( int i = 0; i < nBoxes; i++ )
+	{
+		AngleMatrix( QAngle( i * 17.0f, i * -31.0f, i * 7.0f ), Vector( i * 3.0f, -100.0f, i * -0.5f ), s_Transforms[i] );
+	}
+
+	const bool bSIMD8 = MathLib_SIMD8Enabled();
+
+	for ( int nPass = 0; nPass < 3; nPass++ )
+	{
+		MathLib_SetSIMD8Enabled( nPass == 0 );
+
+		if ( nPass < 2 )
+			TransformAABBs( s_Transforms[5], s_Mins, s_Maxs, nBoxes, s_MinsOut, s_MaxsOut );
+		else
+			TransformAABBs( s_Transforms, s_Mins, s_Maxs, nBoxes, s_MinsOut, s_MaxsOut );
+
+		for ( int i = 0; i < nBoxes; i++ )
+		{
+			Vector vMins, vMaxs;
+			TransformAABB( nPass < 2 ? s_Transforms[5] : s_Transforms[i], s_MinsAoS[i], s_MaxsAoS[i], vMins, vMaxs );
+
+			Vector vMinsOut = s_MinsOut[i >> 2].Vec( i & 3 );
+			Vector vMaxsOut = s_MaxsOut[i >> 2].Vec( i & 3 );
+
+			for ( int c = 0; c < 3; c++ )
+			{
+				TEST_TRUE( fabsf( vMinsOut[c] - vMins[c] ) <= 1e-3f );
+				TEST_TRUE( fabsf( vMaxsOut[c] - vMaxs[c] ) <= 1e-3f );
+			}
+		}
+	}
+
+	MathLib_SetSIMD8Enabled( bSIMD8 );
+}
+
+REGISTER_NAMED_TEST( "BoxOnPlaneSideSIMD.Batch", BoxOnPlaneSideSIMD_Batch )
+{
+	// The batched plane test should match BoxOnPlaneSideSIMD for planes facing every octant.
+	const int nBoxes = 45;
+	static FourVectors s_Mins[( nBoxes + 3 ) / 4], s_Maxs[( nBoxes + 3 ) / 4];
+	static Vector s_MinsAoS[nBoxes], s_MaxsAoS[nBoxes];
+
+	FillBoxes( s_Mins, s_Maxs, s_MinsAoS, s_MaxsAoS, nBoxes );
+
+	for ( int nOctant = 0; nOctant < 8; nOctant++ )
+	{
+		cplane_t plane;
+		plane.normal = Vector( ( nOctant & 1 ) ? -0.48f : 0.6f, ( nOctant & 2 ) ? -0.64f : 0.36f, ( nOctant & 4 ) ? -0.6f : 0.72f );
+		VectorNormalize( plane.normal );
+		plane.dist = 25.0f * nOctant - 100.0f;
+		plane.type = PLANE_ANYZ;
+
+		uint8 nSides[nBoxes];
+		BoxOnPlaneSideSIMD( s_Mins, s_Maxs, nBoxes, &plane, nSides, 1.0f );
+
+		for ( int i = 0; i < nBoxes; i++ )
+		{
+			VectorAligned vMins( s_MinsAoS[i] ), vMaxs( s_MaxsAoS[i] );
+			fltx4 mins = SetWSIMD( LoadAlignedSIMD( vMins ), Four_Ones );
+			fltx4 maxs = SetWSIMD( LoadAlignedSIMD( vMaxs ), Four_Ones );
+			int nExpected = BoxOnPlaneSideSIMD( mins, maxs, &plane, 1.0f );
+
+			TEST_EQ( ( int )nSides[i], nExpected );
+		}
+	}
+}
+
+// Deterministic unit quaternions, including pairs on opposite hemispheres and identical pairs
+static void FillQuaternions( Quaternion *pP, Quaternion *pQ, Vector *pPos, int nCount )
+{
+	for ( int i = 0; i < nCount; i++ )
+	{
+		AngleQuaternion( QAngle( i * 23.0f, i * -41.0f, i * 13.0f ), pP[i] );
+		AngleQuaternion( QAngle( i * -7.0f + 90.0f, i * 29.0f, i * 3.0f - 45.0f ), pQ[i] );
+
+		if ( i % 3 == 0 )
+			pQ[i] = -pQ[i];
+		if ( i % 11 == 0 )
+			pQ[i] = pP[i];
+
+		pPos[i] = Vector( i * 1.5f, -i * 2.0f, 8.0f );
+	}
+}
+
+REGISTER_NAMED_TEST( "QuaternionSlerps", QuaternionSlerps )
+{
+	// The batched slerp and blend should match QuaternionSlerp and QuaternionBlend for every pair.
+	const int nCount = 43;
+	Quaternion p[nCount], q[nCount], out[nCount];
+	Vector pos[nCount];
+
+	FillQuaternions( p, q, pos, nCount );
+
+	for ( int nStep = 0; nStep <= 8; nStep++ )
+	{
+		float t = nStep / 8.0f;
+
+		QuaternionSlerps( p, q, t, nCount, out );
+		for ( int i = 0; i < nCount; i++ )
+		{
+			Quaternion expected;
+			QuaternionSlerp( p[i], q[i], t, expected );
+
+			for ( int c = 0; c < 4; c++ )
+			{
+				TEST_TRUE( fabsf( out[i][c] - expected[c] ) <= 1e-5f );
+			}
+		}
+
+		QuaternionBlends( p, q, t, nCount, out );
+		for ( int i = 0; i < nCount; i++ )
+		{
+			Quaternion expected;
+			QuaternionBlend( p[i], q[i], t, expected );
+
+			for ( int c = 0; c < 4; c++ )
+			{
+				TEST_TRUE( fabsf( out[i][c] - expected[c] ) <= 1e-5f );
+			}
+		}
+	}
+
+	// in place
+	Quaternion inPlace[nCount];
+	memcpy( inPlace, p, sizeof( inPlace ) );
+	QuaternionSlerps( inPlace, q, 0.25f, nCount, inPlace );
+	QuaternionSlerps( p, q, 0.25f, nCount, out );
+	TEST_TRUE( memcmp( inPlace, out, sizeof( out ) ) == 0 );
+}
+
+REGISTER_NAMED_TEST( "QuaternionMatrices", QuaternionMatrices )
+{
+	// QuaternionMatrices should match QuaternionMatrix, and ConcatBoneTransforms a ConcatTransforms walk of the hierarchy.
+	const int nCount = 23;
+	static const int s_nParents[nCount] = { -1, 0, 1, 2, 3, 1, 5, 6, 1, 8, 9, 0, 11, 12, 0, 14, 15, -1, 17, 17, 19, 20, 2 };
+	Quaternion p[nCount], q[nCount];
+	Vector pos[nCount];
+	static matrix3x4a_t s_Local[nCount], s_World[nCount];
+
+	FillQuaternions( p, q, pos, nCount );
+
+	for ( int nSize = 0; nSize <= nCount; nSize += 5 )
+	{
+		QuaternionMatrices( p, pos, nSize, s_Local );
+
+		for ( int i = 0; i < nSize; i++ )
+		{
+			matrix3x4_t expected;
+			QuaternionMatrix( p[i], pos[i], expected );
+
+			for ( int r = 0; r < 3; r++ )
+			{
+				for ( int c = 0; c < 4; c++ )
+				{
+					TEST_TRUE( fabsf( s_Local[i][r][c] - expected[r][c] ) <= 1e-5f );
+				}
+			}
+		}
+	}
+
+	QuaternionMatrices( p, pos, nCount, s_Local );
+
+	matrix3x4a_t root;
+	AngleMatrix( QAngle( 10.0f, 200.0f, -30.0f ), Vector( 100.0f, -50.0f, 25.0f ), root );
+
+	ConcatBoneTransforms( root, s_Local, s_nParents, nCount, s_World );
+
+	for ( int i = 0; i < nCount; i++ )
+	{
+		matrix3x4_t expected;
+		ConcatTransforms( ( s_nParents[i] >= 0 ) ? s_World[s_nParents[i]] : root, s_Local[i], expected );
+
+		for ( int r = 0; r < 3; r++ )
+		{
+			for ( int c = 0; c < 4; c++ )
+			{
+				TEST_TRUE( fabsf( s_World[i][r][c] - expected[r][c] ) <= 1e-4f );
+			}
+		}
+	}
+
+	// in place gives the same
+	ConcatBoneTransforms( root, s_Local, s_nParents, nCount, s_Local );
+	TEST_TRUE( memcmp( s_Local, s_World, sizeof( s_World ) ) == 0 );
+}
@@ -0,0 +1,305 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <mathlib/ssemath8.h>
+#include <mathlib/ssequaternion8.h>
+#include <mathlib/simdvectormatrix.h>
+
+#include <math.h>
+
+// fltx8 code only runs inside SIMD8_TARGET functions, so each test computes into plain
+// floats there and checks the results outside.
+
+static float s_flInputA[8] = { -3.5f, -1.0f, -0.25f, 0.0f, 0.5f, 1.0f, 2.75f, 100.0f };
+static float s_flInputB[8] = { 2.0f, -1.0f, 0.75f, -0.5f, 0.5f, 4.0f, -8.0f, 0.125f };
+
+struct Fltx8OpResults_t
+{
+	float m_flAdd[8];
+	float m_flMul[8];
+	float m_flMadd[8];
+	float m_flMsub[8];
+	float m_flMin[8];
+	float m_flMax[8];
+	float m_flSelect[8];
+	float m_flFloor[8];
+	float m_flRsqrt[8];
+	float m_flRoundTrip[8];
+	int m_nGtMask;
+	int m_nSignMask;
+};
+
+static SIMD8_TARGET void ComputeFltx8Ops( Fltx8OpResults_t &results )
+{
+	fltx8 a = LoadUnalignedSIMD8( s_flInputA );
+	fltx8 b = LoadUnalignedSIMD8( s_flInputB );
+
+	StoreUnalignedSIMD( results.m_flAdd, AddSIMD( a, b ) );
+	StoreUnalignedSIMD( results.m_flMul, MulSIMD( a, b ) );
+	StoreUnalignedSIMD( results.m_flMadd, MaddSIMD( a, b, ReplicateX8( 1.0f ) ) );
+	StoreUnalignedSIMD( results.m_flMsub, MsubSIMD( a, b, ReplicateX8( 1.0f ) ) );
+	StoreUnalignedSIMD( results.m_flMin, MinSIMD( a, b ) );
+	StoreUnalignedSIMD( results.m_flMax, MaxSIMD( a, b ) );
+	StoreUnalignedSIMD( results.m_flSelect, MaskedAssign( CmpGtSIMD( a, b ), a, b ) );
+	StoreUnalignedSIMD( results.m_flFloor, FloorSIMD( a ) );
+	StoreUnalignedSIMD( results.m_flRsqrt, ReciprocalSqrtSIMD( AbsSIMD( b ) ) );
+	StoreUnalignedSIMD( results.m_flRoundTrip, CombineSIMD8( LowerSIMD( a ), UpperSIMD( a ) ) );
+
+	results.m_nGtMask = TestSignSIMD( CmpGtSIMD( a, b ) );
+	results.m_nSignMask = TestSignSIMD( a );
+}
+
+REGISTER_NAMED_TEST( "fltx8.Ops", fltx8_Ops )
+{
+	// Every lane should match the scalar result, and the masks should be in lane order.
+	if ( !MathLib_SIMD8Enabled() )
+		return;
+
+	Fltx8OpResults_t results;
+	ComputeFltx8Ops( results );
+
+	int nGtMask = 0, nSignMask = 0;
+
+	for ( int i = 0; i < 8; i++ )
+	{
+		float a = s_flInputA[i], b = s_flInputB[i];
+
+		TEST_EQ( results.m_flAdd[i], a + b );
+		TEST_EQ( results.m_flMul[i], a * b );
+		TEST_EQ( results.m_flMadd[i], a * b + 1.0f );
+		TEST_EQ( results.m_flMsub[i], 1.0f - a * b );
+		TEST_EQ( results.m_flMin[i], a < b ? a : b );
+		TEST_EQ( results.m_flMax[i], a > b ? a : b );
+		TEST_EQ( results.m_flSelect[i], a > b ? a : b );
+		// the fltx4 FloorSIMD the emulated one forwards to is only exact for non-negative values
+		if ( a >= 0.0f )
+			TEST_EQ( results.m_flFloor[i], floorf( a ) );
+
+		TEST_TRUE( fabsf( results.m_flRsqrt[i] - 1.0f / sqrtf( fabsf( b ) ) ) < 1e-5f * results.m_flRsqrt[i] );
+		TEST_EQ( results.m_flRoundTrip[i], a );
+
+		if ( a > b )
+			nGtMask |= 1 << i;
+
+		if ( signbit( a ) )
+			nSignMask |= 1 << i;
+	}
+
+	TEST_EQ( results.m_nGtMask, nGtMask );
+	TEST_EQ( results.m_nSignMask, nSignMask );
+}
+
+static SIMD8_TARGET void ComputeSinCos8( const float *pRadians, float *pSine, float *pCosine, int nCount )
+{
+	for ( int i = 0; i < nCount; i += 8 )
+	{
+		fltx8 sine, cosine;
+		SinCosSIMD( sine, cosine, LoadUnalignedSIMD8( pRadians + i ) );
+		StoreUnalignedSIMD( pSine + i, sine );
+		StoreUnalignedSIMD( pCosine + i, cosine );
+	}
+}
+
+REGISTER_NAMED_TEST( "fltx8.SinCos", fltx8_SinCos )
+{
+	// The polynomial should stay within a few ulps of libm across several periods.
+	if ( !MathLib_SIMD8Enabled() )
+		return;
+
+	const int nCount = 4096;
+	static float s_flRadians[nCount], s_flSine[nCount], s_flCosine[nCount];
+
+	for ( int i = 0; i < nCount; i++ )
+	{
+		s_flRadians[i] = -100.0f + 200.0f * i / nCount;
+	}
+
+	ComputeSinCos8( s_flRadians, s_flSine, s_flCosine, nCount );
+
+	for ( int i = 0; i < nCount; i++ )
+	{
+		TEST_TRUE( fabs( s_flSine[i] - sin( ( double )s_flRadians[i] ) ) < 2e-6 );
+		TEST_TRUE( fabs( s_flCosine[i] - cos( ( double )s_flRadians[i] ) ) < 2e-6 );
+	}
+}
+
+static SIMD8_TARGET void ComputePow8( const float *pInput, float *pOutput, float flExponent )
+{
+	StoreUnalignedSIMD( pOutput, PowSIMD( LoadUnalignedSIMD8( pInput ), flExponent ) );
+}
+
+REGISTER_NAMED_TEST( "fltx8.Pow", fltx8_Pow )
+{
+	// PowSIMD on fltx8 should agree with the fltx4 version for whole, fractional and negative powers.
+	if ( !MathLib_SIMD8Enabled() )
+		return;
+
+	const float flInput[8] = { 0.125f, 0.5f, 0.9f, 1.0f, 1.5f, 2.0f, 3.25f, 10.0f };
+	const float flExponents[] = { 0.0f, 1.0f, 2.0f, 2.25f, 2.5f, 3.75f, -1.0f, -2.5f };
+
+	for ( float flExponent : flExponents )
+	{
+		float flResult8[8], flResult4[8];
+		ComputePow8( flInput, flResult8, flExponent );
+
+		StoreUnalignedSIMD( flResult4, PowSIMD( LoadUnalignedSIMD( flInput ), flExponent ) );
+		StoreUnalignedSIMD( flResult4 + 4, PowSIMD( LoadUnalignedSIMD( flInput + 4 ), flExponent ) );
+
+		for ( int i = 0; i < 8; i++ )
+		{
+			TEST_TRUE( fabsf( flResult8[i] - flResult4[i] ) <= 1e-5f * fabsf( flResult4[i] ) );
+		}
+	}
+}
+
+static void FillNoisePositions( FourVectors *pPositions, int nCount )
+{
+	for ( int i = 0; i < nCount; i++ )
+	{
+		for ( int j = 0; j < 4; j++ )
+		{
+			int n = i * 4 + j;
+			pPositions[i].X( j ) = -50.0f + n * 0.37f;
+			pPositions[i].Y( j ) = 20.0f - n * 0.11f;
+			pPositions[i].Z( j ) = n * 0.05f;
+		}
+	}
+}
+
+REGISTER_NAMED_TEST( "fltx8.Noise", fltx8_Noise )
+{
+	// The batched NoiseSIMD should give the 4-wide results whichever path it takes, odd tail included.
+	const int nCount = 63;
+	static FourVectors s_Positions[nCount];
+	static fltx4 s_Results4[nCount], s_Results8[nCount];
+
+	FillNoisePositions( s_Positions, nCount );
+
+	for ( int i = 0; i < nCount; i++ )
+	{
+		s_Results4[i] = NoiseSIMD( s_Positions[i] );
+	}
+
+	NoiseSIMD( s_Positions, s_Results8, nCount );
+
+	for ( int i = 0; i < nCount; i++ )
+	{
+		for ( int j = 0; j < 4; j++ )
+		{
+			TEST_TRUE( SubFloat( s_Results8[i], j ) >= -1.0f && SubFloat( s_Results8[i], j ) <= 1.0f );
+			TEST_TRUE( fabsf( SubFloat( s_Results8[i], j ) - SubFloat( s_Results4[i], j ) ) < 1e-5f );
+		}
+	}
+}
+
+static void FillVectorMatrix( CSIMDVectorMatrix &matrix, int nWidth, int nHeight, float flBias )
+{
+	matrix.SetSize( nWidth, nHeight );
+
+	for ( int y = 0; y < nHeight; y++ )
+	{
+		for ( int x = 0; x < matrix.m_nPaddedWidth; x++ )
+		{
+			FourVectors &v = matrix.CompoundElement( x, y );
+
+			for ( int j = 0; j < 4; j++ )
+			{
+				v.X( j ) = flBias + 0.01f * ( x * 4 + j ) + 0.1f * y;
+				v.Y( j ) = flBias + 0.02f * ( x * 4 + j );
+				v.Z( j ) = flBias + 0.03f * y;
+			}
+		}
+	}
+}
+
+REGISTER_NAMED_TEST( "CSIMDVectorMatrix.SIMD8", CSIMDVectorMatrix_SIMD8 )
+{
+	// The 8-wide image ops should match the 4-wide ones, including an odd number of FourVectors.
+	const int nWidth = 13, nHeight = 3;
+
+	CSIMDVectorMatrix wide, narrow, other;
+	FillVectorMatrix( wide, nWidth, nHeight, 0.5f );
+	FillVectorMatrix( narrow, nWidth, nHeight, 0.5f );
+	FillVectorMatrix( other, nWidth, nHeight, 0.25f );
+
+	const bool bSIMD8 = MathLib_SIMD8Enabled();
+
+	wide += other;
+	wide *= Vector( 0.5f, 2.0f, 3.0f );
+	wide.RaiseToPower( 2.5f );
+
+	MathLib_SetSIMD8Enabled( false );
+	narrow += other;
+	narrow *= Vector( 0.5f, 2.0f, 3.0f );
+	narrow.RaiseToPower( 2.5f );
+	MathLib_SetSIMD8Enabled( bSIMD8 );
+
+	for ( int y = 0; y < nHeight; y++ )
+	{
+		for ( int x = 0; x < nWidth; x++ )
+		{
+			Vector vWide = wide.Element( x, y );
+			Vector vNarrow = narrow.Element( x, y );
+
+			TEST_TRUE( fabsf( vWide.x - vNarrow.x ) <= 1e-5f * fabsf( vNarrow.x ) );
+			TEST_TRUE( fabsf( vWide.y - vNarrow.y ) <= 1e-5f * fabsf( vNarrow.y ) );
+			TEST_TRUE( fabsf( vWide.z - vNarrow.z ) <= 1e-5f * fabsf( vNarrow.z ) );
+		}
+	}
+}
+
+static SIMD8_TARGET void RotateEight( const FourQuaternions &q0, const FourQuaternions &q1, FourVectors &v0, FourVectors &v1 )
+{
+	EightQuaternions quats;
+	quats.LoadFourQuaternions( q0, q1 );
+	quats.Normalize();
+
+	EightVectors vecs;
+	vecs.LoadFourVectors( v0, v1 );
+	quats.RotateEightVectors( &vecs );
+	vecs.StoreFourVectors( v0, v1 );
+}
+
+REGISTER_NAMED_TEST( "EightQuaternions.RotateEightVectors", EightQuaternions_RotateEightVectors )
+{
+	// Rotating through EightQuaternions should match two FourQuaternions rotations.
+	if ( !MathLib_SIMD8Enabled() )
+		return;
+
+	FourQuaternions q[2];
+	FourVectors v8[2], v4[2];
+
+	for ( int i = 0; i < 2; i++ )
+	{
+		for ( int j = 0; j < 4; j++ )
+		{
+			int n = i * 4 + j;
+			Quaternion quat( 0.1f * n, 0.5f - 0.05f * n, 0.3f, 1.0f );
+			float flInvLen = 1.0f / sqrtf( quat.x * quat.x + quat.y * quat.y + quat.z * quat.z + quat.w * quat.w );
+
+			SubFloat( q[i].x, j ) = quat.x * flInvLen;
+			SubFloat( q[i].y, j ) = quat.y * flInvLen;
+			SubFloat( q[i].z, j ) = quat.z * flInvLen;
+			SubFloat( q[i].w, j ) = quat.w * flInvLen;
+
+			v4[i].X( j ) = 1.0f + n;
+			v4[i].Y( j ) = -2.0f * n;
+			v4[i].Z( j ) = 0.5f;
+		}
+
+		v8[i] = v4[i];
+		q[i].RotateFourVectors( &v4[i] );
+	}
+
+	RotateEight( q[0], q[1], v8[0], v8[1] );
+
+	for ( int i = 0; i < 2; i++ )
+	{
+		for ( int j = 0; j < 4; j++ )
+		{
+			TEST_TRUE( fabsf( v8[i].X( j ) - v4[i].X( j ) ) < 1e-4f );
+			TEST_TRUE( fabsf( v8[i].Y( j ) - v4[i].Y( j ) ) < 1e-4f );
+			TEST_TRUE( fabsf( v8[i].Z( j ) - v4[i].Z( j ) ) < 1e-4f );
+		}
+	}
+}
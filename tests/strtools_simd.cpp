@@ -0,0 +1,194 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <tier1/strtools_simd.h>
+
+#include <string.h>
+
+// The bytes either side of 'A'-'Z' and 'a'-'z' are where a wrong fold shows, and the
+// high bytes must come through untouched, so the random strings are made of those.
+static const char s_StrSIMDTestAlphabet[] = "aAbBzZyY@[`{09 \x80\xC1\xE1\xFF";
+
+static uint32 StrSIMDTestRandom( uint32 &nSeed )
+{
+	nSeed = nSeed * 1664525 + 1013904223;
+	return nSeed >> 8;
+}
+
+static void BuildStrSIMDTestString( char *pOut, int nLength, int nAlphabet, uint32 &nSeed )
+{
+	for ( int i = 0; i < nLength; i++ )
+	{
+		pOut[i] = s_StrSIMDTestAlphabet[StrSIMDTestRandom( nSeed ) % nAlphabet];
+	}
+
+	pOut[nLength] = 0;
+}
+
+REGISTER_NAMED_TEST( "strtools_simd.KnownStrings", strtools_simd_KnownStrings )
+{
+	static const char s_szLong[] = "The Quick Brown Fox Jumps Over The Lazy Dog, The Quick Brown Fox Jumps Over The Lazy Dog";
+	int nMaxLevel = V_StrSetSIMDLevel( 2 );
+
+	for ( int nLevel = 0; nLevel <= nMaxLevel; nLevel++ )
+	{
+		V_StrSetSIMDLevel( nLevel );
+
+		TEST_EQ( V_strlen_simd( "" ), 0 );
+		TEST_EQ( V_strlen_simd( "sv_cheats" ), 9 );
+		TEST_EQ( V_strlen_simd( s_szLong ), ( int )strlen( s_szLong ) );
+
+		TEST_EQ( V_stricmp_simd( "SV_Cheats", "sv_cheats" ), 0 );
+		TEST_EQ( V_stricmp_simd( "", "" ), 0 );
+		TEST_TRUE( V_stricmp_simd( "sv_cheat", "sv_cheats" ) < 0 );
+		TEST_TRUE( V_stricmp_simd( "B", "a" ) > 0 );
+		TEST_TRUE( V_stricmp_simd( "[", "a" ) < 0 );			// '[' sits between 'Z' and 'a'
+		TEST_TRUE( V_stricmp_simd( "\xE9", "\xC9" ) > 0 );	// not folded
+		TEST_EQ( V_stricmp_simd( s_szLong, "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG, THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG" ), 0 );
+
+		TEST_EQ( V_strnicmp_simd( "mp_Timelimit", "MP_TIMELEFT", 7 ), 0 );
+		TEST_TRUE( V_strnicmp_simd( "mp_Timelimit", "MP_TIMELEFT", 9 ) > 0 );
+		TEST_EQ( V_strnicmp_simd( "abc", "xyz", 0 ), 0 );
+		TEST_EQ( V_strnicmp_simd( "abc", "ABC", 100 ), 0 );
+
+		TEST_EQ( V_strstr_simd( s_szLong, "Lazy Dog" ), s_szLong + 35 );
+		TEST_NULL( V_strstr_simd( s_szLong, "lazy dog" ) );
+		TEST_EQ( V_strstr_simd( s_szLong, "" ), s_szLong );
+		TEST_NULL( V_strstr_simd( "", "a" ) );
+		TEST_EQ( V_stristr_simd( s_szLong, "lAZY dOG" ), s_szLong + 35 );
+		TEST_EQ( V_stristr_simd( s_szLong, "g" ), s_szLong + 42 );
+		TEST_NULL( V_stristr_simd( s_szLong, "cat" ) );
+
+		char szLower[sizeof( s_szLong )];
+		memcpy( szLower, s_szLong, sizeof( szLower ) );
+		TEST_EQ( V_strlower_simd( szLower ), szLower );
+		TEST_EQ( strcmp( szLower, "the quick brown fox jumps over the lazy dog, the quick brown fox jumps over the lazy dog" ), 0 );
+
+		char szOut[8];
+		TEST_EQ( V_strtolower_simd( "Models/Player.VMDL", szOut, sizeof( szOut ) ), 7 );
+		TEST_EQ( strcmp( szOut, "models/" ), 0 );
+		TEST_EQ( V_strtolower_simd( "ABC", szOut, sizeof( szOut ) ), 3 );
+		TEST_EQ( strcmp( szOut, "abc" ), 0 );
+	}
+
+	V_StrSetSIMDLevel( 2 );
+}
+
+REGISTER_NAMED_TEST( "strtools_simd.MatchesScalar", strtools_simd_MatchesScalar )
+{
+	// Strings end on both sides of a page boundary, so the wide loads have to stop short there
+	const int nPage = 4096;
+	alignas( 4096 ) static char s_Buffer[3 * nPage];
+	alignas( 4096 ) static char s_Search[3 * nPage];
+	static char s_String[512];
+	static char s_Expected[576], s_Actual[576];
+
+	uint32 nSeed = 1;
+	int nMaxLevel = V_StrSetSIMDLevel( 2 );
+	bool bAllMatch = true;
+
+	for ( int nTest = 0; nTest < 20000 && bAllMatch; nTest++ )
+	{
+		// Small alphabets make for long equal runs and plenty of near matches
+		int nAlphabet = 2 + StrSIMDTestRandom( nSeed ) % ( sizeof( s_StrSIMDTestAlphabet ) - 2 );
+		int nLength = StrSIMDTestRandom( nSeed ) % ( ( nTest & 1 ) ? 20 : 300 );
+		BuildStrSIMDTestString( s_String, nLength, nAlphabet, nSeed );
+
+		int nOffset = ( nTest & 2 ) ? nPage - nLength + ( int )( StrSIMDTestRandom( nSeed ) % 64 ) - 48 : ( int )( StrSIMDTestRandom( nSeed ) % 64 );
+		nOffset = clamp( nOffset, 0, nPage - 1 );
+		char *pString = s_Buffer + nPage + nOffset;
+		memcpy( pString, s_String, nLength + 1 );
+
+		// The other side is a copy with some case flipped and maybe one byte changed,
+		// or a piece of the string to search for, again ending near a page boundary
+		int nSearchLength;
+		char *pSearch;
+		if ( nTest & 4 )
+		{
+			int nStart = nLength ? StrSIMDTestRandom( nSeed ) % nLength : 0;
+			nSearchLength = nLength ? StrSIMDTestRandom( nSeed ) % ( nLength - nStart + 1 ) : 0;
+			pSearch = s_Search + 2 * nPage - nSearchLength - ( StrSIMDTestRandom( nSeed ) % 4 ) - 1;
+			memcpy( pSearch, pString + nStart, nSearchLength );
+		}
+		else
+		{
+			nSearchLength = nLength;
+			pSearch = s_Search + nPage + ( ( nTest & 8 ) ? nPage - nLength - 1 : StrSIMDTestRandom( nSeed ) % 64 );
+			memcpy( pSearch, pString, nSearchLength );
+		}
+		pSearch[nSearchLength] = 0;
+
+		for ( int i = 0; i < nSearchLength; i++ )
+		{
+			if ( StrSIMDTestRandom( nSeed ) & 1 )
+				pSearch[i] ^= ( ( pSearch[i] | 0x20 ) >= 'a' && ( pSearch[i] | 0x20 ) <= 'z' ) ? 0x20 : 0;
+		}
+		if ( nSearchLength && !( StrSIMDTestRandom( nSeed ) & 3 ) )
+		{
+			pSearch[StrSIMDTestRandom( nSeed ) % nSearchLength] = s_StrSIMDTestAlphabet[StrSIMDTestRandom( nSeed ) % nAlphabet];
+		}
+
+		int nCount = ( int )( StrSIMDTestRandom( nSeed ) % ( nLength + 40 ) );
+		int nOutSize = 1 + ( int )( StrSIMDTestRandom( nSeed ) % ( nLength + 40 ) );
+
+		V_StrSetSIMDLevel( 0 );
+		int nExpectedLength = V_strlen_simd( pString );
+		int nExpectedCmp = V_stricmp_simd( pString, pSearch );
+		int nExpectedNCmp = V_strnicmp_simd( pString, pSearch, nCount );
+		const char *pExpectedStr = V_strstr_simd( pString, pSearch );
+		const char *pExpectedIStr = V_stristr_simd( pString, pSearch );
+		memset( s_Expected, 0x5A, sizeof( s_Expected ) );
+		int nExpectedLowered = V_strtolower_simd( pString, s_Expected, nOutSize );
+
+		// The scalar path against libc while we're at it
+		TEST_EQ( nExpectedLength, ( int )strlen( pString ) );
+		TEST_EQ( pExpectedStr, strstr( pString, pSearch ) );
+
+		for ( int nLevel = 1; nLevel <= nMaxLevel; nLevel++ )
+		{
+			V_StrSetSIMDLevel( nLevel );
+
+			memset( s_Actual, 0x5A, sizeof( s_Actual ) );
+			int nActualLowered = V_strtolower_simd( pString, s_Actual, nOutSize );
+
+			if ( V_strlen_simd( pString ) != nExpectedLength ||
+				V_stricmp_simd( pString, pSearch ) != nExpectedCmp ||
+				V_stricmp_simd( pSearch, pString ) != -nExpectedCmp ||
+				V_strnicmp_simd( pString, pSearch, nCount ) != nExpectedNCmp ||
+				V_strstr_simd( pString, pSearch ) != pExpectedStr ||
+				V_stristr_simd( pString, pSearch ) != pExpectedIStr ||
+				nActualLowered != nExpectedLowered ||
+				memcmp( s_Actual, s_Expected, sizeof( s_Expected ) ) )
+			{
+				bAllMatch = false;
+				TEST_EQ( V_strlen_simd( pString ), nExpectedLength );
+				TEST_EQ( V_stricmp_simd( pString, pSearch ), nExpectedCmp );
+				TEST_EQ( V_stricmp_simd( pSearch, pString ), -nExpectedCmp );
+				TEST_EQ( V_strnicmp_simd( pString, pSearch, nCount ), nExpectedNCmp );
+				TEST_EQ( V_strstr_simd( pString, pSearch ), pExpectedStr );
+				TEST_EQ( V_stristr_simd( pString, pSearch ), pExpectedIStr );
+				TEST_EQ( nActualLowered, nExpectedLowered );
+				TEST_EQ( memcmp( s_Actual, s_Expected, sizeof( s_Expected ) ), 0 );
+			}
+
+			// In place, on a copy so the next level sees the original
+			memcpy( s_String, pString, nLength + 1 );
+			V_strlower_simd( pString );
+			if ( nOutSize > nLength && memcmp( pString, s_Expected, nLength + 1 ) )
+			{
+				bAllMatch = false;
+				TEST_EQ( memcmp( pString, s_Expected, nLength + 1 ), 0 );
+			}
+			memcpy( pString, s_String, nLength + 1 );
+		}
+
+		// Past the end of the string a bounded compare is the whole compare
+		if ( nCount > nLength )
+		{
+			TEST_EQ( nExpectedNCmp, nExpectedCmp );
+		}
+	}
+
+	TEST_TRUE( bAllMatch );
+	V_StrSetSIMDLevel( 2 );
+}
@@ -0,0 +1,175 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <tier1/strtools_unicode.h>
+
+#include <string.h>
+
+// Every SIMD level has to give exactly what the scalar decoder gives, errors and CESU-8
+// included, so the strings below are random mixes of the awkward cases and each one is
+// run through the scalar path first as the reference.
+
+static const char *s_pUnicodeTestPieces[] =
+{
+	"a", "Hello, world ", "0123456789abcdefghijklmnopqrstuvwxyz",
+	"\xC3\xA9", "\xD0\x9F\xD1\x80\xD0\xB8", "\xC2\x80",							// 2 byte
+	"\xE4\xB8\xAD\xE6\x96\x87", "\xEF\xBC\x8C", "\xEF\xB7\x8F", "\xEF\xBF\xBD",	// 3 byte, U+FDCF and U+FFFD are fine
+	"\xF0\x9F\x98\x80", "\xF0\x9F\xBF\xBD", "\xF4\x8F\xBF\xBD",					// 4 byte
+	"\xED\xA0\xBD\xED\xB8\x80",													// CESU-8 surrogate pair
+	"\xEF\xB7\x90", "\xEF\xB7\xAF", "\xEF\xBF\xBE", "\xEF\xBF\xBF",				// noncharacters
+	"\xF0\x9F\xBF\xBF", "\xF4\x8F\xBF\xBE",
+	"\x80", "\xBF\xBF", "\xC0\x80", "\xC1\xBF", "\xE0\x80\x80", "\xED\xA0\x80",	// invalid
+	"\xF5\x80\x80\x80", "\xF4\x90\x80\x80", "\xF8\x88\x80\x80\x80", "\xFF",
+	"\xE4\xB8", "\xF0\x9F\x98", "\xC3",											// truncated
+};
+
+static uint32 UnicodeTestRandom( uint32 &nSeed )
+{
+	nSeed = nSeed * 1664525 + 1013904223;
+	return nSeed >> 8;
+}
+
+// Mostly one kind of text with the odd other piece in it, like real strings
+static int BuildUnicodeTestString( char *pOut, int nMaxBytes, uint32 &nSeed )
+{
+	int nPieces = ARRAYSIZE( s_pUnicodeTestPieces );
+	int nMain = UnicodeTestRandom( nSeed ) % 14;
+	int nOddOneOut = 2 + UnicodeTestRandom( nSeed ) % 40;
+	int nTarget = UnicodeTestRandom( nSeed ) % nMaxBytes;
+
+	int nLength = 0;
+	while ( nLength < nTarget )
+	{
+		const char *pPiece = s_pUnicodeTestPieces[( UnicodeTestRandom( nSeed ) % nOddOneOut ) ? nMain : UnicodeTestRandom( nSeed ) % nPieces];
+		int nPieceLength = strlen( pPiece );
+		if ( nLength + nPieceLength > nMaxBytes )
+			break;
+
+		memcpy( pOut + nLength, pPiece, nPieceLength );
+		nLength += nPieceLength;
+	}
+
+	pOut[nLength] = 0;
+	return nLength;
+}
+
+struct UnicodeTestResults_t
+{
+	bool m_bValid;
+	int m_nLength;
+	int m_nUTF16Bytes;
+	int m_nUTF32Bytes;
+	int m_nTruncatedUTF16Bytes;
+	uchar16 m_UTF16[1024];
+	uchar32 m_UTF32[1024];
+	uchar16 m_TruncatedUTF16[1024];
+	int m_nRepairReplace;
+	int m_nRepairSkip;
+	char m_RepairedReplace[1024];
+	char m_RepairedSkip[1024];
+};
+
+static void RunUnicodeFunctions( const char *pUTF8, int nTruncatedBytes, UnicodeTestResults_t &results )
+{
+	memset( &results, 0, sizeof( results ) );
+
+	results.m_bValid = Q_UnicodeValidate( pUTF8 );
+	results.m_nLength = Q_UnicodeLength( pUTF8 );
+
+	TEST_EQ( Q_UTF8ToUTF16( pUTF8, NULL, 0, STRINGCONVERT_REPLACE ), Q_UTF8ToUTF16( pUTF8, results.m_UTF16, sizeof( results.m_UTF16 ), STRINGCONVERT_REPLACE ) );
+	results.m_nUTF16Bytes = Q_UTF8ToUTF16( pUTF8, results.m_UTF16, sizeof( results.m_UTF16 ), STRINGCONVERT_SKIP );
+	results.m_nUTF32Bytes = Q_UTF8ToUTF32( pUTF8, results.m_UTF32, sizeof( results.m_UTF32 ), STRINGCONVERT_REPLACE );
+	results.m_nTruncatedUTF16Bytes = Q_UTF8ToUTF16( pUTF8, results.m_TruncatedUTF16, nTruncatedBytes, STRINGCONVERT_REPLACE );
+
+	strcpy( results.m_RepairedReplace, pUTF8 );
+	strcpy( results.m_RepairedSkip, pUTF8 );
+	results.m_nRepairReplace = Q_UnicodeRepair( results.m_RepairedReplace, STRINGCONVERT_REPLACE );
+	results.m_nRepairSkip = Q_UnicodeRepair( results.m_RepairedSkip, STRINGCONVERT_SKIP );
+}
+
+REGISTER_NAMED_TEST( "strtools_unicode.KnownStrings", strtools_unicode_KnownStrings )
+{
+	Q_UnicodeSetSIMDLevel( 2 );
+
+	// Long enough to go through the vector path, with the interesting bit in the middle
+	char szText[256];
+	strcpy( szText, "The quick brown fox jumps over \xED\xA0\xBD\xED\xB8\x80 the lazy dog, again and again" );
+
+	// CESU-8 isn't valid, but decodes as one character
+	TEST_TRUE( !Q_UnicodeValidate( szText ) );
+	TEST_EQ( Q_UnicodeLength( szText ), 31 + 1 + 30 );
+
+	uchar32 utf32[128];
+	TEST_EQ( Q_UTF8ToUTF32( szText, utf32, sizeof( utf32 ), STRINGCONVERT_REPLACE ), ( 62 + 1 ) * ( int )sizeof( uchar32 ) );
+	TEST_EQ( ( uint32 )utf32[31], 0x1F600u );
+	TEST_EQ( ( uint32 )utf32[32], ( uint32 )' ' );
+
+	strcpy( szText, "\xE4\xB8\xAD\xE6\x96\x87\xE4\xB8\xAD\xE6\x96\x87\xE4\xB8\xAD\xE6\x96\x87 \xF0\x9F\x98\x80 caf\xC3\xA9 \xD0\x9F\xD1\x80\xD0\xB8" );
+	TEST_TRUE( Q_UnicodeValidate( szText ) );
+	TEST_EQ( Q_UnicodeLength( szText ), 6 + 1 + 1 + 1 + 4 + 1 + 3 );
+
+	uchar16 utf16[128];
+	TEST_EQ( Q_UTF8ToUTF16( szText, NULL, 0, STRINGCONVERT_REPLACE ), ( 17 + 1 + 1 ) * ( int )sizeof( uchar16 ) );
+	TEST_EQ( Q_UTF8ToUTF16( szText, utf16, sizeof( utf16 ), STRINGCONVERT_REPLACE ), ( 17 + 1 + 1 ) * ( int )sizeof( uchar16 ) );
+	TEST_EQ( ( uint32 )utf16[0], 0x4E2Du );
+	TEST_EQ( ( uint32 )utf16[7], 0xD83Du );
+	TEST_EQ( ( uint32 )utf16[8], 0xDE00u );
+	TEST_EQ( ( uint32 )utf16[13], 0xE9u );
+
+	// A noncharacter far enough in to be in a vector block
+	strcpy( szText, "0123456789abcdefghijklmnopqrstuvwxyz\xEF\xBF\xBE" );
+	TEST_TRUE( !Q_UnicodeValidate( szText ) );
+	TEST_EQ( Q_UnicodeRepair( szText, STRINGCONVERT_SKIP ), 37 );
+	TEST_EQ( ( int )strlen( szText ), 36 );
+
+	TEST_TRUE( Q_UnicodeValidate( "" ) );
+	TEST_EQ( Q_UnicodeLength( "" ), 0 );
+}
+
+REGISTER_NAMED_TEST( "strtools_unicode.MatchesScalar", strtools_unicode_MatchesScalar )
+{
+	// Strings end on both sides of a page boundary, so the scanners have to stop short there
+	const int nPage = 4096;
+	alignas( 4096 ) static char s_Buffer[3 * nPage];
+	static char s_String[1024];
+	static UnicodeTestResults_t s_Expected, s_Actual;
+
+	uint32 nSeed = 1;
+	int nMaxLevel = Q_UnicodeSetSIMDLevel( 2 );
+	bool bAllMatch = true;
+
+	for ( int nTest = 0; nTest < 4000 && bAllMatch; nTest++ )
+	{
+		int nLength = BuildUnicodeTestString( s_String, ( nTest & 1 ) ? 64 : 900, nSeed );
+		int nOffset = ( nTest & 2 ) ? nPage - nLength + ( int )( UnicodeTestRandom( nSeed ) % 64 ) - 32 : ( int )( UnicodeTestRandom( nSeed ) % 64 );
+		nOffset = clamp( nOffset, 0, nPage );
+		char *pString = s_Buffer + nPage + nOffset;
+		memcpy( pString, s_String, nLength + 1 );
+
+		int nTruncatedBytes = ( int )( UnicodeTestRandom( nSeed ) % ( 2 * nLength + 8 ) );
+
+		Q_UnicodeSetSIMDLevel( 0 );
+		RunUnicodeFunctions( pString, nTruncatedBytes, s_Expected );
+
+		for ( int nLevel = 1; nLevel <= nMaxLevel; nLevel++ )
+		{
+			Q_UnicodeSetSIMDLevel( nLevel );
+			RunUnicodeFunctions( pString, nTruncatedBytes, s_Actual );
+
+			if ( memcmp( &s_Expected, &s_Actual, sizeof( s_Expected ) ) )
+			{
+				bAllMatch = false;
+				TEST_EQ( s_Actual.m_bValid, s_Expected.m_bValid );
+				TEST_EQ( s_Actual.m_nLength, s_Expected.m_nLength );
+				TEST_EQ( s_Actual.m_nUTF16Bytes, s_Expected.m_nUTF16Bytes );
+				TEST_EQ( s_Actual.m_nUTF32Bytes, s_Expected.m_nUTF32Bytes );
+				TEST_EQ( s_Actual.m_nTruncatedUTF16Bytes, s_Expected.m_nTruncatedUTF16Bytes );
+				TEST_EQ( s_Actual.m_nRepairReplace, s_Expected.m_nRepairReplace );
+				TEST_EQ( s_Actual.m_nRepairSkip, s_Expected.m_nRepairSkip );
+			}
+		}
+	}
+
+	TEST_TRUE( bAllMatch );
+	Q_UnicodeSetSIMDLevel( 2 );
+}
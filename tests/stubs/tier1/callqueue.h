@@ -0,0 +1,33 @@
+// Stands in for tier1/callqueue.h, which pulls in tier1/jobthread.h (see vstdlib/jobthread.h here).
+// Calls are kept until ParallelCallQueued and then run on the job threads.
+
+#ifndef TESTS_STUBS_CALLQUEUE_H
+#define TESTS_STUBS_CALLQUEUE_H
+
+#include "vstdlib/jobthread.h"
+
+#include <functional>
+#include <vector>
+
+class CCallQueue
+{
+public:
+	template < typename OBJECT_TYPE_PTR, typename FUNCTION_TYPE, typename... ARG_TYPES >
+	void QueueCall( OBJECT_TYPE_PTR pObject, FUNCTION_TYPE pfnProxied, ARG_TYPES... args )
+	{
+		m_Calls.push_back( [=]() { ( pObject->*pfnProxied )( args... ); } );
+	}
+
+	void ParallelCallQueued( IThreadPool *pPool = NULL )
+	{
+		ParallelProcess( m_Calls.data(), ( unsigned )m_Calls.size(), CallQueued );
+		m_Calls.clear();
+	}
+
+private:
+	static void CallQueued( std::function<void()> &call ) { call(); }
+
+	std::vector< std::function<void()> > m_Calls;
+};
+
+#endif // TESTS_STUBS_CALLQUEUE_H
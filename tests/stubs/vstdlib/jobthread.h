@@ -0,0 +1,79 @@
+// The job system is in vstdlib, which isn't part of this tree, and tier1/jobthread.h doesn't build
+// on its own. This stands in for the parallel loops tier1 sources use, so tests can build them in:
+// items are handed out the same way, to a few plain threads.
+
+#ifndef TESTS_STUBS_JOBTHREAD_H
+#define TESTS_STUBS_JOBTHREAD_H
+
+#include <tier0/platform.h>
+
+#include <atomic>
+#include <thread>
+
+class IThreadPool;
+
+#define TEST_JOBTHREAD_THREADS 4
+
+template < typename FUNC_TYPE >
+inline void TestRunOnJobThreads( FUNC_TYPE const &func )
+{
+	std::thread threads[TEST_JOBTHREAD_THREADS - 1];
+	for ( std::thread &thread : threads )
+	{
+		thread = std::thread( func );
+	}
+
+	func();
+
+	for ( std::thread &thread : threads )
+	{
+		thread.join();
+	}
+}
+
+template < typename ITEM_TYPE >
+inline void ParallelProcess( ITEM_TYPE *pItems, unsigned nItems, void (*pfnProcess)( ITEM_TYPE & ), void (*pfnBegin)() = NULL, void (*pfnEnd)() = NULL, int nMaxParallel = INT_MAX )
+{
+	std::atomic<unsigned> nNext( 0 );
+	TestRunOnJobThreads( [&]()
+	{
+		if ( pfnBegin )
+			pfnBegin();
+
+		for ( unsigned i = nNext++; i < nItems; i = nNext++ )
+		{
+			pfnProcess( pItems[i] );
+		}
+
+		if ( pfnEnd )
+			pfnEnd();
+	} );
+}
+
+template < typename CONTEXT_TYPE >
+inline void ParallelLoopProcessChunks( IThreadPool *pPool, CONTEXT_TYPE *pContext, int nStart, int nCount, int nChunkSize, void (*pfnProcess)( CONTEXT_TYPE*, int, int ), void (*pfnBegin)() = NULL, void (*pfnEnd)() = NULL, int nMaxParallel = INT_MAX )
+{
+	std::atomic<int> nNext( nStart );
+	const int nLimit = nStart + nCount;
+	TestRunOnJobThreads( [&]()
+	{
+		if ( pfnBegin )
+			pfnBegin();
+
+		for ( int nIndex = nNext.fetch_add( nChunkSize ); nIndex < nLimit; nIndex = nNext.fetch_add( nChunkSize ) )
+		{
+			pfnProcess( pContext, nIndex, MIN( nChunkSize, nLimit - nIndex ) );
+		}
+
+		if ( pfnEnd )
+			pfnEnd();
+	} );
+}
+
+template < typename CONTEXT_TYPE >
+inline void ParallelLoopProcess( IThreadPool *pPool, CONTEXT_TYPE *pContext, int nStart, int nCount, void (*pfnProcess)( CONTEXT_TYPE*, int, int ), void (*pfnBegin)() = NULL, void (*pfnEnd)() = NULL, int nMaxParallel = INT_MAX )
+{
+	ParallelLoopProcessChunks( pPool, pContext, nStart, nCount, 1, pfnProcess, pfnBegin, pfnEnd, nMaxParallel );
+}
+
+#endif // TESTS_STUBS_JOBTHREAD_H
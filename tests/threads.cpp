@@ -0,0 +1,94 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <tier0/basetypes.h>
+#include <tier0/threadtools.h>
+#include <threads.h>
+
+#include <string.h>
+
+static const int s_nTestWorkItems = 100003;
+static const int s_nTestThreads = 8;
+
+struct TestWorkThread_t
+{
+	CThreadWorkDispenser *m_pDispenser;
+	int32 volatile *m_pHandedOut;
+	int m_nChunks;
+};
+
+static uintp TestWorkThreadFn( void *pParam )
+{
+	TestWorkThread_t *pThread = ( TestWorkThread_t * )pParam;
+
+	int nStart, nEnd;
+	while ( pThread->m_pDispenser->GetChunk( &nStart, &nEnd ) )
+	{
+		pThread->m_nChunks++;
+		for ( int i = nStart; i < nEnd; i++ )
+		{
+			ThreadInterlockedIncrement( &pThread->m_pHandedOut[i] );
+		}
+	}
+
+	return 0;
+}
+
+REGISTER_NAMED_TEST( "threads.CThreadWorkDispenser", threads_CThreadWorkDispenser )
+{
+	CThreadWorkDispenser dispenser;
+
+	// On one thread the chunks come out in order, shrinking to single items at the end
+	dispenser.Init( 100, 2 );
+	int nStart, nEnd, nExpectedStart = 0, nLastChunk = 100;
+	while ( dispenser.GetChunk( &nStart, &nEnd ) )
+	{
+		TEST_EQ( nStart, nExpectedStart );
+		TEST_TRUE( nEnd > nStart );
+		TEST_TRUE( nEnd - nStart <= nLastChunk );
+		nLastChunk = nEnd - nStart;
+		nExpectedStart = nEnd;
+	}
+	TEST_EQ( nExpectedStart, 100 );
+	TEST_EQ( nLastChunk, 1 );
+	TEST_EQ( dispenser.Dispatched(), 100 );
+	TEST_TRUE( !dispenser.GetChunk( &nStart, &nEnd ) );
+
+	dispenser.Init( 0, 4 );
+	TEST_TRUE( !dispenser.GetChunk( &nStart, &nEnd ) );
+
+	// Across threads every item goes out exactly once
+	static int32 volatile s_nHandedOut[s_nTestWorkItems];
+	memset( ( void * )s_nHandedOut, 0, sizeof( s_nHandedOut ) );
+
+	dispenser.Init( s_nTestWorkItems, s_nTestThreads );
+
+	TestWorkThread_t threadData[s_nTestThreads];
+	ThreadHandle_t hThreads[s_nTestThreads];
+	for ( int i = 0; i < s_nTestThreads; i++ )
+	{
+		threadData[i].m_pDispenser = &dispenser;
+		threadData[i].m_pHandedOut = s_nHandedOut;
+		threadData[i].m_nChunks = 0;
+		hThreads[i] = CreateSimpleThread( TestWorkThreadFn, &threadData[i] );
+	}
+
+	int nChunks = 0;
+	for ( int i = 0; i < s_nTestThreads; i++ )
+	{
+		ThreadJoin( hThreads[i] );
+		ReleaseThreadHandle( hThreads[i] );
+		nChunks += threadData[i].m_nChunks;
+	}
+
+	bool bAllOnce = true;
+	for ( int i = 0; i < s_nTestWorkItems; i++ )
+	{
+		if ( s_nHandedOut[i] != 1 )
+			bAllOnce = false;
+	}
+	TEST_TRUE( bAllOnce );
+
+	// Far fewer trips to the shared counter than items
+	TEST_TRUE( nChunks < s_nTestWorkItems / 100 );
+}
@@ -0,0 +1,338 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <tier1/utlbvh4.h>
+#include <mathlib/mathlib.h>
+
+#include <math.h>
+
+// Deterministic boxes of mixed sizes, a few of them flat. pData is the index + 1.
+static void FillPrimitives( CUtlVector< CUtlBVH4::Primitive_t > &primitives, int nCount, uint32 nSeed )
+{
+	primitives.SetCount( nCount );
+
+	for ( int i = 0; i < nCount; i++ )
+	{
+		float flValues[6];
+
+		for ( int k = 0; k < 6; k++ )
+		{
+			nSeed = nSeed * 1664525 + 1013904223;
+			flValues[k] = ( ( nSeed >> 8 ) & 0xffff ) * ( 1.0f / 65536.0f );
+		}
+
+		Vector vCenter( flValues[0] * 4000.0f - 2000.0f, flValues[1] * 4000.0f - 2000.0f, flValues[2] * 1000.0f - 500.0f );
+		Vector vExtents( 1.0f + flValues[3] * 40.0f, 1.0f + flValues[4] * 40.0f, ( i % 9 ) ? 1.0f + flValues[5] * 40.0f : 0.0f );
+
+		primitives[i].m_vMins = vCenter - vExtents;
+		primitives[i].m_vMaxs = vCenter + vExtents;
+		primitives[i].m_pData = ( const void * )( intp )( i + 1 );
+	}
+}
+
+// Checks that the query returned exactly the primitives flagged in pExpected, each once
+static bool MatchesExpected( const CUtlVector< void * > &result, int nReturned, const bool *pExpected, int nCount )
+{
+	CUtlVector< bool > found;
+	found.SetCount( nCount );
+	for ( int i = 0; i < nCount; i++ )
+	{
+		found[i] = false;
+	}
+
+	for ( int i = 0; i < result.Count(); i++ )
+	{
+		int nIndex = ( int )( intp )result[i] - 1;
+		if ( nIndex < 0 || nIndex >= nCount || found[nIndex] || !pExpected[nIndex] )
+			return false;
+
+		found[nIndex] = true;
+	}
+
+	int nExpected = 0;
+	for ( int i = 0; i < nCount; i++ )
+	{
+		nExpected += pExpected[i];
+	}
+
+	return nReturned == nExpected && result.Count() == nExpected;
+}
+
+static bool RayHitsBox( const Vector &vStart, const Vector &vDelta, const Vector &vMins, const Vector &vMaxs )
+{
+	float flNear = 0.0f, flFar = 1.0f;
+
+	for ( int i = 0; i < 3; i++ )
+	{
+		float flDelta = vDelta[i];
+		if ( fabsf( flDelta ) < 1e-20f )
+			flDelta = flDelta < 0.0f ? -1e-20f : 1e-20f;
+
+		float flInvDelta = 1.0f / flDelta;
+		float t1 = ( vMins[i] - vStart[i] ) * flInvDelta;
+		float t2 = ( vMaxs[i] - vStart[i] ) * flInvDelta;
+		flNear = MAX( flNear, MIN( t1, t2 ) );
+		flFar = MIN( flFar, MAX( t1, t2 ) );
+	}
+
+	return flNear <= flFar;
+}
+
+static bool SphereTouchesBox( const Vector4D &sphere, const Vector &vMins, const Vector &vMaxs, bool bPartial )
+{
+	float flNearSqr = 0.0f, flFarSqr = 0.0f;
+
+	for ( int i = 0; i < 3; i++ )
+	{
+		float flNear = MAX( MAX( vMins[i] - sphere[i], sphere[i] - vMaxs[i] ), 0.0f );
+		float flFar = MAX( sphere[i] - vMins[i], vMaxs[i] - sphere[i] );
+		flNearSqr += flNear * flNear;
+		flFarSqr += flFar * flFar;
+	}
+
+	return ( bPartial ? flNearSqr : flFarSqr ) <= sphere.w * sphere.w;
+}
+
+static void CheckQueries( const CUtlBVH4 &tree, const CUtlVector< CUtlBVH4::Primitive_t > &primitives )
+{
+	const int nCount = primitives.Count();
+	CUtlVector< bool > expected;
+	expected.SetCount( nCount );
+	CUtlVector< void * > result;
+
+	for ( int nRay = 0; nRay < 16; nRay++ )
+	{
+		Vector vStart( -2500.0f + nRay * 300.0f, -2400.0f, -600.0f + nRay * 70.0f );
+		Vector vDelta( 5000.0f - nRay * 550.0f, 4800.0f, ( nRay & 3 ) ? 0.0f : 700.0f );
+
+		for ( int i = 0; i < nCount; i++ )
+		{
+			expected[i] = RayHitsBox( vStart, vDelta, primitives[i].m_vMins, primitives[i].m_vMaxs );
+		}
+
+		TEST_TRUE( MatchesExpected( result, tree.IntersectWithRay( vStart, vDelta, result ), expected.Base(), nCount ) );
+	}
+
+	for ( int nSphere = 0; nSphere < 16; nSphere++ )
+	{
+		Vector4D sphere( -1800.0f + nSphere * 240.0f, 1500.0f - nSphere * 190.0f, nSphere * 20.0f - 150.0f, 50.0f + nSphere * 40.0f );
+
+		for ( int nPartial = 0; nPartial < 2; nPartial++ )
+		{
+			for ( int i = 0; i < nCount; i++ )
+			{
+				expected[i] = SphereTouchesBox( sphere, primitives[i].m_vMins, primitives[i].m_vMaxs, nPartial != 0 );
+			}
+
+			TEST_TRUE( MatchesExpected( result, tree.IntersectWithSphere( sphere, nPartial != 0, result ), expected.Base(), nCount ) );
+		}
+	}
+
+	for ( int nBox = 0; nBox < 8; nBox++ )
+	{
+		Vector vMins( -2000.0f + nBox * 400.0f, -1000.0f, -200.0f );
+		Vector vMaxs( vMins.x + 300.0f + nBox * 100.0f, 1200.0f - nBox * 250.0f, 300.0f );
+
+		for ( int i = 0; i < nCount; i++ )
+		{
+			expected[i] = primitives[i].m_vMins.x <= vMaxs.x && primitives[i].m_vMaxs.x >= vMins.x &&
+				primitives[i].m_vMins.y <= vMaxs.y && primitives[i].m_vMaxs.y >= vMins.y &&
+				primitives[i].m_vMins.z <= vMaxs.z && primitives[i].m_vMaxs.z >= vMins.z;
+		}
+
+		TEST_TRUE( MatchesExpected( result, tree.IntersectWithBox( vMins, vMaxs, result ), expected.Base(), nCount ) );
+	}
+
+	for ( int nFrustum = 0; nFrustum < 4; nFrustum++ )
+	{
+		Frustum_t frustum;
+		frustum.CreatePerspectiveFrustum( Vector( nFrustum * 200.0f, -100.0f, 20.0f ), QAngle( 5.0f, nFrustum * 95.0f, 0.0f ), 4.0f, 1500.0f + nFrustum * 500.0f, 75.0f, 16.0f / 9.0f );
+
+		for ( int i = 0; i < nCount; i++ )
+		{
+			expected[i] = !frustum.CullBox( primitives[i].m_vMins, primitives[i].m_vMaxs );
+		}
+
+		TEST_TRUE( MatchesExpected( result, tree.IntersectWithFrustum( frustum, result ), expected.Base(), nCount ) );
+	}
+}
+
+REGISTER_NAMED_TEST( "CUtlBVH4.Queries", CUtlBVH4_Queries )
+{
+	// Every query should return exactly what testing each primitive on its own finds,
+	// including for trees too small to fill a node.
+	const int nCounts[] = { 1, 2, 4, 5, 17, 3000 };
+
+	for ( int c = 0; c < ARRAYSIZE( nCounts ); c++ )
+	{
+		CUtlVector< CUtlBVH4::Primitive_t > primitives;
+		FillPrimitives( primitives, nCounts[c], 0x9e3779b9 + c );
+
+		CUtlBVH4 tree;
+		tree.Build( primitives.Base(), primitives.Count() );
+
+		TEST_EQ( tree.Count(), nCounts[c] );
+		TEST_TRUE( tree.NodeCount() >= 1 && tree.NodeCount() <= MAX( nCounts[c] - 1, 1 ) );
+
+		CheckQueries( tree, primitives );
+	}
+
+	CUtlBVH4 empty;
+	CUtlVector< void * > result;
+	TEST_EQ( empty.IntersectWithSphere( Vector4D( 0.0f, 0.0f, 0.0f, 1e6f ), true, result ), 0 );
+	TEST_EQ( result.Count(), 0 );
+}
+
+REGISTER_NAMED_TEST( "CUtlBVH4.MaxResults", CUtlBVH4_MaxResults )
+{
+	// As with CUtlSphereTree, maxResults caps what is returned but not the count.
+	CUtlVector< CUtlBVH4::Primitive_t > primitives;
+	FillPrimitives( primitives, 500, 1234 );
+
+	CUtlBVH4 tree;
+	tree.Build( primitives.Base(), primitives.Count() );
+
+	CUtlVector< void * > result;
+	int nTotal = tree.IntersectWithSphere( Vector4D( 0.0f, 0.0f, 0.0f, 1e6f ), true, result );
+	TEST_EQ( nTotal, 500 );
+	TEST_EQ( result.Count(), 500 );
+
+	TEST_EQ( tree.IntersectWithSphere( Vector4D( 0.0f, 0.0f, 0.0f, 1e6f ), true, result, 10 ), 500 );
+	TEST_EQ( result.Count(), 10 );
+
+	CUtlBVH4::Cut cut( &tree );
+	TEST_EQ( cut.GetLeaves( result, 7 ), 500 );
+	TEST_EQ( result.Count(), 7 );
+}
+
+// What CutByPlanes should leave of a single box
+static bool BoxSurvivesCut( const Vector &vMins, const Vector &vMaxs, const Vector4D *pPlanes, int nPlanes, int nCutFlags )
+{
+	const bool bOr = ( nCutFlags & CUtlBVH4::Cut::OR_INTERSECTIONS ) != 0;
+	bool bPass = !bOr, bFail = bOr;
+
+	Vector vCenter = ( vMins + vMaxs ) * 0.5f;
+	Vector vExtents = ( vMaxs - vMins ) * 0.5f;
+
+	for ( int i = 0; i < nPlanes; i++ )
+	{
+		const Vector4D &plane = pPlanes[i];
+		float flDist = plane.x * vCenter.x + ( plane.y * vCenter.y + plane.z * vCenter.z ) - plane.w;
+		float flRadius = fabsf( plane.x ) * vExtents.x + ( fabsf( plane.y ) * vExtents.y + fabsf( plane.z ) * vExtents.z );
+
+		if ( bOr )
+		{
+			bPass = bPass || flDist >= flRadius;
+			bFail = bFail && flDist < -flRadius;
+		}
+		else
+		{
+			bPass = bPass && flDist >= flRadius;
+			bFail = bFail || flDist < -flRadius;
+		}
+	}
+
+	return bPass || ( !bFail && ( nCutFlags & CUtlBVH4::Cut::PARTIAL_INTERSECTIONS ) );
+}
+
+REGISTER_NAMED_TEST( "CUtlBVH4.CutByPlanes", CUtlBVH4_CutByPlanes )
+{
+	// Cuts in all four modes, then refined in place and used to restrict a query.
+	const int nCount = 2000;
+	CUtlVector< CUtlBVH4::Primitive_t > primitives;
+	FillPrimitives( primitives, nCount, 777 );
+
+	CUtlBVH4 tree;
+	tree.Build( primitives.Base(), primitives.Count() );
+
+	Vector4D planes[3];
+	planes[0].Init( 0.6f, 0.8f, 0.0f, -300.0f );
+	planes[1].Init( -1.0f, 0.0f, 0.0f, -900.0f );
+	planes[2].Init( 0.0f, -0.6f, 0.8f, -500.0f );
+
+	CUtlVector< bool > expected;
+	expected.SetCount( nCount );
+	CUtlVector< void * > result;
+
+	for ( int nCutFlags = 0; nCutFlags < 4; nCutFlags++ )
+	{
+		CUtlBVH4::Cut cut( &tree );
+		tree.CutByPlanes( &cut, NULL, nCutFlags, planes, 3 );
+
+		for ( int i = 0; i < nCount; i++ )
+		{
+			expected[i] = BoxSurvivesCut( primitives[i].m_vMins, primitives[i].m_vMaxs, planes, 3, nCutFlags );
+		}
+
+		TEST_TRUE( MatchesExpected( result, cut.GetLeaves( result ), expected.Base(), nCount ) );
+
+		// Refining in place only ever removes primitives
+		Vector4D refine( 0.0f, 1.0f, 0.0f, 0.0f );
+		tree.CutByPlanes( &cut, &cut, nCutFlags, &refine, 1 );
+
+		for ( int i = 0; i < nCount; i++ )
+		{
+			expected[i] = expected[i] && BoxSurvivesCut( primitives[i].m_vMins, primitives[i].m_vMaxs, &refine, 1, nCutFlags );
+		}
+
+		TEST_TRUE( MatchesExpected( result, cut.GetLeaves( result ), expected.Base(), nCount ) );
+
+		// A query through the cut only sees what is left in it
+		Vector4D sphere( 500.0f, 500.0f, 0.0f, 900.0f );
+		for ( int i = 0; i < nCount; i++ )
+		{
+			expected[i] = expected[i] && SphereTouchesBox( sphere, primitives[i].m_vMins, primitives[i].m_vMaxs, true );
+		}
+
+		TEST_TRUE( MatchesExpected( result, tree.IntersectWithSphere( sphere, true, result, 0, &cut ), expected.Base(), nCount ) );
+	}
+}
+
+REGISTER_NAMED_TEST( "CUtlBVH4.Refit", CUtlBVH4_Refit )
+{
+	// After moving every primitive and refitting, queries should see the new positions.
+	const int nCount = 1500;
+	CUtlVector< CUtlBVH4::Primitive_t > primitives;
+	FillPrimitives( primitives, nCount, 4242 );
+
+	CUtlBVH4 tree;
+	tree.Build( primitives.Base(), primitives.Count() );
+
+	for ( int i = 0; i < nCount; i++ )
+	{
+		Vector vOffset( ( i % 13 ) * 37.0f - 200.0f, ( i % 7 ) * -51.0f + 150.0f, ( i % 5 ) * 11.0f );
+		primitives[i].m_vMins += vOffset;
+		primitives[i].m_vMaxs += vOffset;
+		tree.SetPrimitiveBounds( i, primitives[i].m_vMins, primitives[i].m_vMaxs );
+	}
+
+	tree.Refit();
+	CheckQueries( tree, primitives );
+}
+
+REGISTER_NAMED_TEST( "CUtlBVH4.ParallelBuild", CUtlBVH4_ParallelBuild )
+{
+	// A threaded build has to produce a tree that holds every primitive exactly once.
+	const int nCount = 20000;
+	CUtlVector< CUtlBVH4::Primitive_t > primitives;
+	FillPrimitives( primitives, nCount, 31337 );
+
+	CUtlBVH4 tree;
+	tree.Build( primitives.Base(), primitives.Count(), 4 );
+
+	TEST_EQ( tree.Count(), nCount );
+	TEST_TRUE( tree.NodeCount() <= nCount - 1 );
+
+	CUtlVector< bool > expected;
+	expected.SetCount( nCount );
+	for ( int i = 0; i < nCount; i++ )
+	{
+		expected[i] = true;
+	}
+
+	CUtlVector< void * > result;
+	CUtlBVH4::Cut cut( &tree );
+	TEST_TRUE( MatchesExpected( result, cut.GetLeaves( result ), expected.Base(), nCount ) );
+
+	CheckQueries( tree, primitives );
+}
@@ -0,0 +1,201 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <tier1/utlintervaltree.h>
+
+typedef CUtlIntervalTree< int, int > IntervalTree_t;
+
+// Deterministic intervals of mixed lengths over [0, 10000), a few of them empty. m_Data is the index.
+static void FillIntervals( CUtlVector< IntervalTree_t::Value_t > &intervals, int nCount, uint32 nSeed )
+{
+	intervals.SetCount( nCount );
+
+	for ( int i = 0; i < nCount; i++ )
+	{
+		nSeed = nSeed * 1664525 + 1013904223;
+		int nLow = ( nSeed >> 8 ) % 10000;
+		nSeed = nSeed * 1664525 + 1013904223;
+		int nLength = ( i % 7 ) ? ( nSeed >> 8 ) % ( ( i % 13 ) ? 50 : 2000 ) : 0;
+
+		intervals[i].SetLowVal( nLow );
+		intervals[i].SetHighVal( nLow + nLength );
+		intervals[i].m_Data = i;
+	}
+}
+
+static IntervalTree_t::Interval_t MakeCheck( int nProbe )
+{
+	uint32 nSeed = nProbe * 2654435761u;
+	IntervalTree_t::Interval_t check;
+	check.SetLowVal( ( int )( ( nSeed >> 4 ) % 10400 ) - 200 );
+	check.SetHighVal( check.GetLowVal() + ( int )( ( nSeed >> 20 ) % ( ( nProbe & 3 ) ? 100 : 1500 ) ) );
+	return check;
+}
+
+// Checks that the results are exactly the intervals overlapping check, each once
+static bool MatchesBruteForce( const IntervalTree_t::Value_t *pResults, int nResults, const CUtlVector< IntervalTree_t::Value_t > &intervals, const IntervalTree_t::Interval_t &check, bool bStrict )
+{
+	CUtlVector< bool > found;
+	found.SetCount( intervals.Count() );
+	for ( int i = 0; i < intervals.Count(); i++ )
+	{
+		found[i] = false;
+	}
+
+	for ( int i = 0; i < nResults; i++ )
+	{
+		int nIndex = pResults[i].m_Data;
+		if ( nIndex < 0 || nIndex >= intervals.Count() || found[nIndex] || !check.IsOverlapping( intervals[nIndex], bStrict ) )
+			return false;
+
+		found[nIndex] = true;
+	}
+
+	int nExpected = 0;
+	for ( int i = 0; i < intervals.Count(); i++ )
+	{
+		nExpected += check.IsOverlapping( intervals[i], bStrict );
+	}
+
+	return nResults == nExpected;
+}
+
+static void CheckTree( const IntervalTree_t &tree, const CUtlVector< IntervalTree_t::Value_t > &intervals )
+{
+	TEST_EQ( tree.Count(), intervals.Count() );
+
+	CUtlVector< IntervalTree_t::Value_t > results;
+
+	for ( int nProbe = 0; nProbe < 64; nProbe++ )
+	{
+		IntervalTree_t::Interval_t check = MakeCheck( nProbe );
+
+		for ( int nStrict = 0; nStrict < 2; nStrict++ )
+		{
+			results.RemoveAll();
+			tree.FindOverlaps( check, results, false, nStrict != 0 );
+			TEST_TRUE( MatchesBruteForce( results.Base(), results.Count(), intervals, check, nStrict != 0 ) );
+		}
+
+		results.RemoveAll();
+		tree.FindOverlaps( check, results, true );
+		TEST_TRUE( MatchesBruteForce( results.Base(), results.Count(), intervals, check, false ) );
+
+		for ( int i = 1; i < results.Count(); i++ )
+		{
+			TEST_TRUE( results[i - 1].GetLowVal() <= results[i].GetLowVal() );
+		}
+	}
+}
+
+REGISTER_NAMED_TEST( "CUtlIntervalTree.BuildTree", CUtlIntervalTree_BuildTree )
+{
+	// Sizes around the edges of a full implicit tree as well as a large one
+	const int nCounts[] = { 0, 1, 2, 3, 7, 8, 100, 5000 };
+
+	for ( int c = 0; c < ARRAYSIZE( nCounts ); c++ )
+	{
+		CUtlVector< IntervalTree_t::Value_t > intervals;
+		FillIntervals( intervals, nCounts[c], 0x9e3779b9 + c );
+
+		// BuildTree sorts its input, so hand it a copy
+		CUtlVector< IntervalTree_t::Value_t > input;
+		input.AddMultipleToTail( intervals.Count(), intervals.Base() );
+
+		IntervalTree_t tree;
+		tree.BuildTree( input.Base(), input.Count() );
+
+		CheckTree( tree, intervals );
+	}
+}
+
+REGISTER_NAMED_TEST( "CUtlIntervalTree.BatchFindOverlaps", CUtlIntervalTree_BatchFindOverlaps )
+{
+	CUtlVector< IntervalTree_t::Value_t > intervals;
+	FillIntervals( intervals, 3000, 4321 );
+
+	CUtlVector< IntervalTree_t::Value_t > input;
+	input.AddMultipleToTail( intervals.Count(), intervals.Base() );
+
+	IntervalTree_t tree;
+	tree.BuildTree( input.Base(), input.Count() );
+
+	// Also put a few through the insert buffer so both paths are covered
+	for ( int i = 0; i < 5; i++ )
+	{
+		IntervalTree_t::Value_t extra;
+		extra.SetLowVal( 1000 * i );
+		extra.SetHighVal( 1000 * i + 300 );
+		extra.m_Data = intervals.Count();
+		intervals.AddToTail( extra );
+		tree.Insert( extra );
+	}
+
+	const int nChecks = 200;
+	IntervalTree_t::Interval_t checks[nChecks];
+	for ( int i = 0; i < nChecks; i++ )
+	{
+		checks[i] = MakeCheck( nChecks - i );
+	}
+
+	for ( int nStrict = 0; nStrict < 2; nStrict++ )
+	{
+		// Existing contents of the results vector are left alone
+		CUtlVector< IntervalTree_t::Value_t > results;
+		results.AddToTail( intervals[0] );
+
+		int nStarts[nChecks + 1];
+		tree.FindOverlaps( checks, nChecks, results, nStarts, nStrict != 0 );
+
+		TEST_EQ( nStarts[0], 1 );
+		TEST_EQ( nStarts[nChecks], results.Count() );
+
+		for ( int i = 0; i < nChecks; i++ )
+		{
+			TEST_TRUE( nStarts[i] <= nStarts[i + 1] );
+			TEST_TRUE( MatchesBruteForce( results.Base() + nStarts[i], nStarts[i + 1] - nStarts[i], intervals, checks[i], nStrict != 0 ) );
+		}
+	}
+}
+
+REGISTER_NAMED_TEST( "CUtlIntervalTree.Insert", CUtlIntervalTree_Insert )
+{
+	// Growing one interval at a time goes through the insert buffer and every merge size
+	CUtlVector< IntervalTree_t::Value_t > intervals;
+	FillIntervals( intervals, 2500, 777 );
+
+	IntervalTree_t tree;
+	CUtlVector< IntervalTree_t::Value_t > inserted;
+
+	for ( int i = 0; i < intervals.Count(); i++ )
+	{
+		tree.Insert( intervals[i] );
+		inserted.AddToTail( intervals[i] );
+
+		if ( i == 0 || i == 31 || i == 32 || i == 100 || i == 1023 || i == intervals.Count() - 1 )
+		{
+			CheckTree( tree, inserted );
+		}
+	}
+
+	// Inserting after a build keeps what was built, building again replaces everything
+	CUtlVector< IntervalTree_t::Value_t > input;
+	input.AddMultipleToTail( 1000, intervals.Base() );
+	tree.BuildTree( input.Base(), input.Count() );
+
+	inserted.RemoveAll();
+	inserted.AddMultipleToTail( 1000, intervals.Base() );
+	for ( int i = 1000; i < 1300; i++ )
+	{
+		tree.Insert( intervals[i] );
+		inserted.AddToTail( intervals[i] );
+	}
+	CheckTree( tree, inserted );
+
+	tree.RemoveAll();
+	TEST_EQ( tree.Count(), 0 );
+
+	CUtlVector< IntervalTree_t::Value_t > results;
+	tree.FindOverlaps( MakeCheck( 1 ), results, false );
+	TEST_EQ( results.Count(), 0 );
+}
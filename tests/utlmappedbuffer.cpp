@@ -0,0 +1,139 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <tier1/utlmappedbuffer.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+// Writes nSize bytes of a known pattern to a scratch file and returns its name
+static const char *WriteMappedTestFile( const char *pTag, int nSize )
+{
+	static char s_szFileName[256];
+	snprintf( s_szFileName, sizeof( s_szFileName ), "utlmappedbuffer_%s_%d.bin", pTag, ( int )getpid() );
+
+	FILE *pFile = fopen( s_szFileName, "wb" );
+
+	for ( int i = 0; i < nSize; i++ )
+	{
+		fputc( ( i * 31 + 7 ) & 0xff, pFile );
+	}
+
+	fclose( pFile );
+	return s_szFileName;
+}
+
+REGISTER_NAMED_TEST( "CUtlMappedBuffer.ReadWholeFile", CUtlMappedBuffer_ReadWholeFile )
+{
+	// A small file should be mapped in one window and read through the CUtlBuffer interface.
+	const int nSize = 10000;
+	const char *pFileName = WriteMappedTestFile( "whole", nSize );
+
+	{
+		CUtlMappedBuffer mapped;
+
+		TEST_TRUE( mapped.Open( pFileName, CUtlMappedBuffer::ACCESS_SEQUENTIAL ) );
+		TEST_TRUE( mapped.IsOpen() );
+		TEST_EQ( mapped.GetFileSize(), ( uint64 )nSize );
+		TEST_EQ( mapped.GetWindowOffset(), ( uint64 )0 );
+		TEST_EQ( mapped.GetWindowSize(), ( uint32 )nSize );
+
+		CUtlBuffer &buffer = mapped.GetBuffer();
+
+		TEST_TRUE( buffer.IsReadOnly() );
+		TEST_EQ( buffer.TellGet(), 0 );
+		TEST_EQ( buffer.TellPut(), nSize );
+
+		unsigned char bytes[16];
+		buffer.Get( bytes, sizeof( bytes ) );
+
+		for ( int i = 0; i < ( int )sizeof( bytes ); i++ )
+		{
+			TEST_EQ( bytes[i], ( unsigned char )( ( i * 31 + 7 ) & 0xff ) );
+		}
+
+		// Writes land in private copies of the pages, never in the file
+		mapped.Base()[0] ^= 0xff;
+	}
+
+	{
+		CUtlMappedBuffer mapped;
+
+		TEST_TRUE( mapped.Open( pFileName ) );
+		TEST_EQ( mapped.Base()[0], ( unsigned char )7 );
+	}
+
+	remove( pFileName );
+}
+
+REGISTER_NAMED_TEST( "CUtlMappedBuffer.Windows", CUtlMappedBuffer_Windows )
+{
+	// Windows at unaligned offsets should expose exactly the requested bytes.
+	const int nSize = 200000;
+	const char *pFileName = WriteMappedTestFile( "windows", nSize );
+
+	CUtlMappedBuffer mapped;
+	TEST_TRUE( mapped.Open( pFileName ) );
+
+	TEST_TRUE( mapped.MapWindow( 70001, 5000, CUtlMappedBuffer::ACCESS_RANDOM ) );
+	TEST_EQ( mapped.GetWindowOffset(), ( uint64 )70001 );
+	TEST_EQ( mapped.GetWindowSize(), ( uint32 )5000 );
+	TEST_EQ( mapped.GetBuffer().TellPut(), 5000 );
+	TEST_EQ( mapped.Base()[0], ( unsigned char )( ( 70001 * 31 + 7 ) & 0xff ) );
+	TEST_EQ( mapped.Base()[4999], ( unsigned char )( ( 75000 * 31 + 7 ) & 0xff ) );
+
+	// Walking the file window by window should visit every byte once
+	uint64 nVisited = 0;
+
+	for ( uint64 nOffset = 0; nOffset < ( uint64 )nSize; nOffset += mapped.GetWindowSize() )
+	{
+		TEST_TRUE( mapped.MapWindow( nOffset, 65536 ) );
+		TEST_EQ( mapped.Base()[0], ( unsigned char )( ( nOffset * 31 + 7 ) & 0xff ) );
+		nVisited += mapped.GetWindowSize();
+	}
+
+	TEST_EQ( nVisited, ( uint64 )nSize );
+	TEST_FALSE( mapped.MapNextWindow() );
+
+	// MapNextWindow picks up where the current window ends and takes the rest
+	TEST_TRUE( mapped.MapWindow( 0, 65536 ) );
+	TEST_TRUE( mapped.MapNextWindow() );
+	TEST_EQ( mapped.GetWindowOffset(), ( uint64 )65536 );
+	TEST_EQ( mapped.GetWindowSize(), ( uint32 )( nSize - 65536 ) );
+
+	// Past the end of the file is rejected, the very end is an empty window
+	TEST_FALSE( mapped.MapWindow( nSize + 1, 16 ) );
+	TEST_TRUE( mapped.MapWindow( nSize, 16 ) );
+	TEST_EQ( mapped.GetWindowSize(), ( uint32 )0 );
+
+	mapped.Close();
+	TEST_FALSE( mapped.IsOpen() );
+
+	remove( pFileName );
+}
+
+REGISTER_NAMED_TEST( "CUtlMappedBuffer.EmptyAndMissing", CUtlMappedBuffer_EmptyAndMissing )
+{
+	// Empty files open with an empty buffer; missing files fail to open.
+	const char *pFileName = WriteMappedTestFile( "empty", 0 );
+
+	CUtlMappedBuffer mapped;
+	TEST_TRUE( mapped.Open( pFileName ) );
+	TEST_EQ( mapped.GetFileSize(), ( uint64 )0 );
+	TEST_EQ( mapped.GetWindowSize(), ( uint32 )0 );
+	TEST_EQ( mapped.GetBuffer().TellPut(), 0 );
+	TEST_FALSE( mapped.MapNextWindow() );
+
+	mapped.Close();
+	remove( pFileName );
+
+	TEST_FALSE( mapped.Open( "utlmappedbuffer_does_not_exist.bin" ) );
+	TEST_FALSE( mapped.IsOpen() );
+}
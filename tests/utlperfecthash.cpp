@@ -0,0 +1,77 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <tier1/utlperfecthash.h>
+
+#include <string.h>
+
+static constexpr const char *s_pszPerfectHashTestNames[] =
+{
+	"Generic", "Local Player", "Other Players", "Entities", "Sounds", "Events", "Voice",
+	"String Table", "Move", "String Command", "Signon", "System", nullptr, "User Messages",
+	"Client Messages", "Spawn Groups", "Game Engine", "Hltv Replay", "Decals",
+};
+
+REGISTER_NAMED_TEST( "CUtlPerfectHash.FindsEveryName", CUtlPerfectHash_FindsEveryName )
+{
+	static constexpr auto s_Table = MakePerfectHash( s_pszPerfectHashTestNames );
+	static_assert( s_Table.Find( "Spawn Groups" ) == 15, "looked up by the compiler too" );
+
+	for ( int i = 0; i < ARRAYSIZE( s_pszPerfectHashTestNames ); i++ )
+	{
+		if ( !s_pszPerfectHashTestNames[i] )
+			continue;
+
+		// A copy, so it's the text that's matched and not the pointer
+		char szName[64];
+		strcpy( szName, s_pszPerfectHashTestNames[i] );
+		TEST_EQ( s_Table.Find( szName ), i );
+		TEST_EQ( s_Table.Find( szName, ( int )strlen( szName ) ), i );
+	}
+
+	TEST_EQ( s_Table.Find( "generic" ), -1 );
+	TEST_EQ( s_Table.Find( "Generic2" ), -1 );
+	TEST_EQ( s_Table.Find( "Generi" ), -1 );
+	TEST_EQ( s_Table.Find( "" ), -1 );
+	TEST_EQ( s_Table.Find( "Decals", 5 ), -1 );
+	TEST_EQ( s_Table.Count(), ( int )ARRAYSIZE( s_pszPerfectHashTestNames ) );
+}
+
+REGISTER_NAMED_TEST( "CUtlPerfectHash.CaseInsensitive", CUtlPerfectHash_CaseInsensitive )
+{
+	static constexpr auto s_Table = MakePerfectHash< true >( s_pszPerfectHashTestNames );
+
+	TEST_EQ( s_Table.Find( "hltv replay" ), 17 );
+	TEST_EQ( s_Table.Find( "LOCAL PLAYER" ), 1 );
+	TEST_EQ( s_Table.Find( "Local Players" ), -1 );
+
+	// Tokens are lowercase hashes, so they find the name without hashing again
+	TEST_EQ( s_Table.Find( CUtlStringToken( "game engine" ) ), 16 );
+	TEST_EQ( s_Table.Find( CUtlStringToken( MakeStringToken( "String Command" ) ) ), 9 );
+	TEST_EQ( s_Table.Find( CUtlStringToken( "not a group" ) ), -1 );
+}
+
+REGISTER_NAMED_TEST( "CUtlPerfectHash.Sizes", CUtlPerfectHash_Sizes )
+{
+	// One name, and enough that most buckets need a displacement
+	static constexpr const char *s_pszOne[] = { "only" };
+	static constexpr const char *s_pszMany[] =
+	{
+		"a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l", "m", "n", "o", "p",
+		"q", "r", "s", "t", "u", "v", "w", "x", "y", "z", "aa", "bb", "cc", "dd", "ee", "ff",
+		"gg", "hh", "ii", "jj", "kk", "ll", "mm", "nn", "oo", "pp", "qq", "rr", "ss", "tt", "uu", "vv",
+		"ww", "xx", "yy", "zz", "aaa", "bbb", "ccc", "ddd", "eee", "fff", "ggg", "hhh", "iii", "jjj", "kkk", "lll",
+	};
+
+	static constexpr auto s_One = MakePerfectHash( s_pszOne );
+	static constexpr auto s_Many = MakePerfectHash( s_pszMany );
+
+	TEST_EQ( s_One.Find( "only" ), 0 );
+	TEST_EQ( s_One.Find( "other" ), -1 );
+
+	for ( int i = 0; i < ARRAYSIZE( s_pszMany ); i++ )
+	{
+		TEST_EQ( s_Many.Find( s_pszMany[i] ), i );
+	}
+	TEST_EQ( s_Many.Find( "mmm" ), -1 );
+}
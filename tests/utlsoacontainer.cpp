@@ -0,0 +1,310 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <tier1/utlsoacontainer.h>
+#include <tier1/utlvector.h>
+
+#include <math.h>
+#include <string.h>
+
+static float TestRandom( uint32 *pnSeed )
+{
+	*pnSeed = *pnSeed * 1664525 + 1013904223;
+	return ( ( *pnSeed >> 8 ) & 0xffff ) * ( 1.0f / 65536.0f );
+}
+
+// Spheres of 0.95 (inside) in a volume of 0, with a speckle of single voxels on both sides of the threshold
+static void FillBlobs( CSOAContainer &container, int nField, int nBlobs, uint32 nSeed )
+{
+	const int nWidth = container.NumCols(), nHeight = container.NumRows(), nDepth = container.NumSlices();
+	for ( int z = 0; z < nDepth; z++ )
+	{
+		for ( int y = 0; y < nHeight; y++ )
+		{
+			for ( int x = 0; x < nWidth; x++ )
+			{
+				container.FloatValue( nField, x, y, z ) = 0.0f;
+			}
+		}
+	}
+
+	for ( int b = 0; b < nBlobs; b++ )
+	{
+		float flX = TestRandom( &nSeed ) * nWidth, flY = TestRandom( &nSeed ) * nHeight, flZ = TestRandom( &nSeed ) * nDepth;
+		float flRadius = 1.0f + TestRandom( &nSeed ) * 0.2f * MAX( nWidth, nHeight );
+		for ( int z = 0; z < nDepth; z++ )
+		{
+			for ( int y = 0; y < nHeight; y++ )
+			{
+				for ( int x = 0; x < nWidth; x++ )
+				{
+					if ( ( x - flX ) * ( x - flX ) + ( y - flY ) * ( y - flY ) + ( z - flZ ) * ( z - flZ ) < flRadius * flRadius )
+						container.FloatValue( nField, x, y, z ) = 0.95f;
+				}
+			}
+		}
+	}
+
+	for ( int z = 0; z < nDepth; z++ )
+	{
+		for ( int y = 0; y < nHeight; y++ )
+		{
+			for ( int x = 0; x < nWidth; x++ )
+			{
+				if ( TestRandom( &nSeed ) < 0.01f )
+					container.FloatValue( nField, x, y, z ) = TestRandom( &nSeed ) < 0.5f ? 0.9f : 0.91f;
+			}
+		}
+	}
+}
+
+// The brute-force search GenerateDistanceField used to do for each voxel, minus the SIMD padding columns
+static float ReferenceDistance( CSOAContainer &container, int nSrcField, int nSearchRadius, int x, int y, int z )
+{
+	float flReferenceValue = container.FloatValue( nSrcField, x, y, z );
+	bool bInside = flReferenceValue > 0.9f;
+	float flClosestDistance = nSearchRadius;
+
+	for ( int z1 = MAX( 0, z - nSearchRadius ); z1 <= MIN( container.NumSlices() - 1, z + nSearchRadius ); z1++ )
+	{
+		for ( int y1 = MAX( 0, y - nSearchRadius ); y1 <= MIN( container.NumRows() - 1, y + nSearchRadius ); y1++ )
+		{
+			for ( int x1 = MAX( 0, x - nSearchRadius ); x1 <= MIN( container.NumCols() - 1, x + nSearchRadius ); x1++ )
+			{
+				if ( ( container.FloatValue( nSrcField, x1, y1, z1 ) > 0.9f ) == bInside )
+					continue;
+
+				float flDistance = sqrtf( ( float )( ( x1 - x ) * ( x1 - x ) + ( y1 - y ) * ( y1 - y ) + ( z1 - z ) * ( z1 - z ) ) );
+				flClosestDistance = MIN( flClosestDistance, flDistance );
+			}
+		}
+	}
+
+	return bInside ? flClosestDistance : -flClosestDistance;
+}
+
+static const float s_flTestUnwritten = 12345.0f;
+
+// Number of voxels that differ from the old search, in bits; voxels still at s_flTestUnwritten are skipped
+static int CountDistanceMismatches( CSOAContainer &container, int nSrcField, int nDestField, int nSearchRadius )
+{
+	int cMismatches = 0;
+	for ( int z = 0; z < container.NumSlices(); z++ )
+	{
+		for ( int y = 0; y < container.NumRows(); y++ )
+		{
+			for ( int x = 0; x < container.NumCols(); x++ )
+			{
+				float flDistance = container.FloatValue( nDestField, x, y, z );
+				if ( flDistance == s_flTestUnwritten )
+					continue;
+
+				float flExpected = ReferenceDistance( container, nSrcField, nSearchRadius, x, y, z );
+				if ( memcmp( &flDistance, &flExpected, sizeof( float ) ) )
+					cMismatches++;
+			}
+		}
+	}
+
+	return cMismatches;
+}
+
+static void FillUnwritten( CSOAContainer &container, int nField )
+{
+	for ( int z = 0; z < container.NumSlices(); z++ )
+	{
+		for ( int y = 0; y < container.NumRows(); y++ )
+		{
+			for ( int x = 0; x < container.NumCols(); x++ )
+			{
+				container.FloatValue( nField, x, y, z ) = s_flTestUnwritten;
+			}
+		}
+	}
+}
+
+REGISTER_NAMED_TEST( "CSOAContainer.GenerateDistanceField", CSOAContainer_GenerateDistanceField )
+{
+	// width, height, depth, max distance; widths that aren't a multiple of 4 leave padding in every row
+	static const int s_rgnSizes[][4] =
+	{
+		{ 16, 16, 16, 4 }, { 32, 8, 12, 6 }, { 20, 20, 5, 3 }, { 13, 7, 9, 5 }, { 8, 8, 1, 3 },
+		{ 24, 1, 1, 5 }, { 12, 12, 12, 0 }, { 12, 12, 12, 1 }, { 30, 18, 10, 40 }, { 7, 9, 6, 2 },
+	};
+
+	for ( int i = 0; i < ARRAYSIZE( s_rgnSizes ); i++ )
+	{
+		const int nWidth = s_rgnSizes[i][0], nHeight = s_rgnSizes[i][1], nDepth = s_rgnSizes[i][2], nMaxDistance = s_rgnSizes[i][3];
+
+		CSOAContainer container( nWidth, nHeight, nDepth, 0, ATTRDATATYPE_FLOAT, 1, ATTRDATATYPE_FLOAT, -1 );
+		FillBlobs( container, 0, 4, 1 + i );
+
+		FillUnwritten( container, 1 );
+		container.GenerateDistanceField( 0, 1, nMaxDistance );
+		TEST_EQ( CountDistanceMismatches( container, 0, 1, nMaxDistance ), 0 );
+
+		// Every voxel is written without a rect
+		for ( int z = 0; z < nDepth; z++ )
+		{
+			for ( int y = 0; y < nHeight; y++ )
+			{
+				for ( int x = 0; x < nWidth; x++ )
+				{
+					TEST_NE( container.FloatValue( 1, x, y, z ), s_flTestUnwritten );
+				}
+			}
+		}
+
+		// With a rect, which comes back bloated by the max distance the way it always has
+		Rect3D_t rect;
+		rect.x = nWidth / 4;
+		rect.y = nHeight / 3;
+		rect.z = nDepth / 3;
+		rect.width = nWidth / 3 + 1;
+		rect.height = nHeight / 3 + 1;
+		rect.depth = MAX( 1, nDepth / 4 );
+
+		int nMinX = MAX( 0, rect.x - nMaxDistance ), nMaxX = MIN( nWidth - 1, rect.x + rect.width - 1 + nMaxDistance );
+		int nMinY = MAX( 0, rect.y - nMaxDistance ), nMaxY = MIN( nHeight - 1, rect.y + rect.height - 1 + nMaxDistance );
+		int nMinZ = MAX( 0, rect.z - nMaxDistance ), nMaxZ = MIN( nDepth - 1, rect.z + rect.depth + nMaxDistance );
+
+		FillUnwritten( container, 1 );
+		container.GenerateDistanceField( 0, 1, nMaxDistance, &rect );
+		TEST_EQ( CountDistanceMismatches( container, 0, 1, nMaxDistance ), 0 );
+
+		TEST_EQ( rect.x, nMinX );
+		TEST_EQ( rect.y, nMinY );
+		TEST_EQ( rect.z, nMaxZ );
+		TEST_EQ( rect.width, 1 + nMaxX - nMinX );
+		TEST_EQ( rect.height, 1 + nMaxY - nMinY );
+		TEST_EQ( rect.depth, 1 + nMaxZ - nMinZ );
+
+		// The whole of the bloated rect is written
+		for ( int z = nMinZ; z <= nMaxZ; z++ )
+		{
+			for ( int y = nMinY; y <= nMaxY; y++ )
+			{
+				for ( int x = nMinX; x <= nMaxX; x++ )
+				{
+					TEST_NE( container.FloatValue( 1, x, y, z ), s_flTestUnwritten );
+				}
+			}
+		}
+	}
+}
+
+// What KMeansQuantization did before it had a path of its own for a NULL metric
+class CTestEuclideanErrorMetric : public IKMeansErrorMetric
+{
+public:
+	CTestEuclideanErrorMetric( int nNumFields ) : m_nNumFields( nNumFields ) {}
+
+	virtual void CalculateError( KMeansSampleDescriptor const &sampleAddresses, FourVectors const &v4SamplePositions,
+								 KMeansQuantizedValue const &valueToCompareAgainst, fltx4 *pErrOut )
+	{
+		fltx4 fl4Error = Four_Zeros;
+		for ( int c = 0; c < m_nNumFields; c++ )
+		{
+			fltx4 fl4Delta = SubSIMD( sampleAddresses( c ), valueToCompareAgainst.m_fl4Values[c] );
+			fl4Error = MaddSIMD( fl4Delta, fl4Delta, fl4Error );
+		}
+		*pErrOut = fl4Error;
+	}
+
+private:
+	int m_nNumFields;
+};
+
+static void RunKMeans( CSOAContainer &container, IKMeansErrorMetric *pMetric, int nNumValues, int nNumIterations, CUtlVector< float > &centroids )
+{
+	static const int s_rgnFields[3] = { 0, 1, 2 };
+
+	CUtlVector< KMeansQuantizedValue > values;
+	values.SetCount( nNumValues );
+	container.KMeansQuantization( s_rgnFields, ARRAYSIZE( s_rgnFields ), values.Base(), nNumValues, pMetric, 3, nNumIterations, 4 );
+
+	centroids.SetCount( nNumValues * ARRAYSIZE( s_rgnFields ) );
+	for ( int n = 0; n < nNumValues; n++ )
+	{
+		for ( int c = 0; c < ARRAYSIZE( s_rgnFields ); c++ )
+		{
+			centroids[n * ARRAYSIZE( s_rgnFields ) + c] = SubFloat( values[n].m_fl4Values[c], 0 );
+		}
+	}
+}
+
+REGISTER_NAMED_TEST( "CSOAContainer.KMeansQuantization", CSOAContainer_KMeansQuantization )
+{
+	// width, height, depth, values, iterations
+	static const int s_rgnSizes[][5] =
+	{
+		{ 16, 16, 4, 8, 6 }, { 32, 8, 8, 16, 10 }, { 8, 8, 8, 1, 3 }, { 12, 12, 2, 5, 1 },
+		{ 13, 5, 3, 6, 5 }, { 7, 9, 4, 5, 8 }, { 30, 11, 3, 12, 9 }, { 33, 17, 5, 20, 15 },
+	};
+
+	for ( int i = 0; i < ARRAYSIZE( s_rgnSizes ); i++ )
+	{
+		const int nWidth = s_rgnSizes[i][0], nHeight = s_rgnSizes[i][1], nDepth = s_rgnSizes[i][2];
+
+		// Three fields clustered around five levels, indices in 3 and the error in 4
+		CSOAContainer euclidean( nWidth, nHeight, nDepth, 0, ATTRDATATYPE_FLOAT, 1, ATTRDATATYPE_FLOAT, 2, ATTRDATATYPE_FLOAT,
+								 3, ATTRDATATYPE_FLOAT, 4, ATTRDATATYPE_FLOAT, -1 );
+		CSOAContainer metric( nWidth, nHeight, nDepth, 0, ATTRDATATYPE_FLOAT, 1, ATTRDATATYPE_FLOAT, 2, ATTRDATATYPE_FLOAT,
+							  3, ATTRDATATYPE_FLOAT, 4, ATTRDATATYPE_FLOAT, -1 );
+
+		uint32 nSeed = 1 + i;
+		for ( int f = 0; f < 3; f++ )
+		{
+			for ( int z = 0; z < nDepth; z++ )
+			{
+				for ( int y = 0; y < nHeight; y++ )
+				{
+					for ( int x = 0; x < nWidth; x++ )
+					{
+						float flValue = TestRandom( &nSeed );
+						if ( !f )
+							flValue = flValue * 0.2f + ( ( z * nHeight + y ) * nWidth + x ) % 5 * 0.2f;
+
+						euclidean.FloatValue( f, x, y, z ) = flValue;
+						metric.FloatValue( f, x, y, z ) = flValue;
+					}
+				}
+			}
+		}
+
+		// The padding at the end of the rows is counted either way, so it has to hold the same
+		for ( int f = 0; f < 3; f++ )
+		{
+			for ( int z = 0; z < nDepth; z++ )
+			{
+				for ( int y = 0; y < nHeight; y++ )
+				{
+					memcpy( metric.RowPtr<float>( f, y, z ), euclidean.RowPtr<float>( f, y, z ), metric.NumQuadsPerRow() * sizeof( fltx4 ) );
+				}
+			}
+		}
+
+		CUtlVector< float > euclideanCentroids, metricCentroids;
+		CTestEuclideanErrorMetric errorMetric( 3 );
+		RunKMeans( euclidean, NULL, s_rgnSizes[i][3], s_rgnSizes[i][4], euclideanCentroids );
+		RunKMeans( metric, &errorMetric, s_rgnSizes[i][3], s_rgnSizes[i][4], metricCentroids );
+
+		// Bit for bit, padding and all
+		TEST_EQ( memcmp( euclideanCentroids.Base(), metricCentroids.Base(), euclideanCentroids.Count() * sizeof( float ) ), 0 );
+
+		int cMismatches = 0;
+		for ( int z = 0; z < nDepth; z++ )
+		{
+			for ( int y = 0; y < nHeight; y++ )
+			{
+				if ( memcmp( euclidean.RowPtr<float>( 3, y, z ), metric.RowPtr<float>( 3, y, z ), nWidth * sizeof( float ) ) ||
+					 memcmp( euclidean.RowPtr<float>( 4, y, z ), metric.RowPtr<float>( 4, y, z ), nWidth * sizeof( float ) ) )
+				{
+					cMismatches++;
+				}
+			}
+		}
+
+		TEST_EQ( cMismatches, 0 );
+	}
+}
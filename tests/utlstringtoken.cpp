@@ -3,6 +3,8 @@
 
 #include <tier0/utlstringtoken.h>
 
+#include <string.h>
+
 REGISTER_NAMED_TEST( "CUtlStringToken.HashAndCompare", CUtlStringToken_HashAndCompare )
 {
 	// String tokens should hash case-insensitively and compare against text and peers.
@@ -19,3 +21,59 @@ REGISTER_NAMED_TEST( "CUtlStringToken.HashAndCompare", CUtlStringToken_HashAndCo
 
 	TEST_EQ( nHash, token.GetHashCode() );
 }
+
+REGISTER_NAMED_TEST( "CUtlStringToken.CompileTimeLiterals", CUtlStringToken_CompileTimeLiterals )
+{
+	// Literal tokens are hashed by the compiler and must match what the run time hashes
+	static constexpr CUtlStringToken s_Token( "m_vecOrigin" );
+	static_assert( s_Token.GetHashCode() == CUtlStringToken::Hash( "M_VECORIGIN", 11 ), "literal and upper case hash differently" );
+
+	constexpr uint32 nExact = CUtlStringToken::Hash< false >( "m_vecOrigin", 11 );
+
+	const char *pszRuntime = "m_vecOrigin";
+	TEST_EQ( s_Token.GetHashCode(), ( MakeStringToken< true, false >( pszRuntime ) ) );
+	TEST_EQ( nExact, ( MakeStringToken< false, false >( pszRuntime ) ) );
+	TEST_EQ( nExact, CUtlStringToken::Hash< false >( pszRuntime, 11 ) );
+}
+
+template < int N >
+static CUtlStringToken ForwardedStringToken( const char (&pName)[N] )
+{
+	return CUtlStringToken( pName );
+}
+
+REGISTER_NAMED_TEST( "CUtlStringToken.CharArrays", CUtlStringToken_CharArrays )
+{
+	// A buffer is hashed up to its terminator, not over whatever is left past it
+	char szBuffer[32];
+	memset( szBuffer, 'x', sizeof( szBuffer ) );
+	memcpy( szBuffer, "m_vecOrigin", sizeof( "m_vecOrigin" ) );
+	TEST_EQ( CUtlStringToken( szBuffer ).GetHashCode(), CUtlStringToken( "m_vecOrigin" ).GetHashCode() );
+
+	const char szPadded[32] = "m_vecOrigin";
+	TEST_EQ( CUtlStringToken( szPadded ).GetHashCode(), CUtlStringToken( "m_vecOrigin" ).GetHashCode() );
+
+	// A literal passed on as an array still takes the array constructor
+	TEST_EQ( ForwardedStringToken( "m_vecOrigin" ).GetHashCode(), CUtlStringToken( "m_vecOrigin" ).GetHashCode() );
+}
+
+REGISTER_NAMED_TEST( "CUtlStringToken.HighByteTails", CUtlStringToken_HighByteTails )
+{
+	// The last 1-3 bytes are read as char, a run time token has to do the same to match a literal
+	static constexpr CUtlStringToken s_Tail1( "Abcd\xC3" );
+	static constexpr CUtlStringToken s_Tail2( "Abcd\xC3\xA9" );
+	static constexpr CUtlStringToken s_Tail3( "Abcd\xE2\x82\xAC" );
+	constexpr uint32 nExact3 = CUtlStringToken::Hash< false >( "Abcd\xE2\x82\xAC", 7 );
+
+	const char *pszTail1 = "aBCD\xC3";
+	const char *pszTail2 = "aBCD\xC3\xA9";
+	const char *pszTail3 = "aBCD\xE2\x82\xAC";
+	TEST_EQ( MakeStringToken2( pszTail1 ).GetHashCode(), s_Tail1.GetHashCode() );
+	TEST_EQ( MakeStringToken2( pszTail2 ).GetHashCode(), s_Tail2.GetHashCode() );
+	TEST_EQ( MakeStringToken2( pszTail3 ).GetHashCode(), s_Tail3.GetHashCode() );
+	TEST_EQ( CUtlStringToken( pszTail3, 7 ).GetHashCode(), s_Tail3.GetHashCode() );
+
+	const char *pszExact3 = "Abcd\xE2\x82\xAC";
+	TEST_EQ( ( MakeStringToken2< false >( pszExact3 ).GetHashCode() ), nExact3 );
+	TEST_EQ( ( MakeStringToken2< false >( pszTail3 ).GetHashCode() ), ( CUtlStringToken::Hash< false >( pszTail3, 7 ) ) );
+}
@@ -0,0 +1,210 @@
+#include "common/assert.h"
+#include "common/macros.h"
+
+#include <tier0/utlbuffer.h>
+#include <tier1/zoneprofiler.h>
+
+#include <string.h>
+
+// The profiler is process wide, so one test drives it start to finish: a main thread
+// and a worker record a few frames, then the tree, the stats and both exports are checked.
+
+static void SpinTicks( uint64 nTicks )
+{
+	uint64 nStart = GetTimebaseRegister();
+	while ( GetTimebaseRegister() - nStart < nTicks )
+	{
+	}
+}
+
+static void RecordTestFrame( int nFrame )
+{
+	ZONE_PROFILE( "Frame" );
+
+	{
+		ZONE_PROFILE( "Physics" );
+		SpinTicks( 2000 + ( nFrame % 4 ) * 1000 );
+	}
+
+	for ( int i = 0; i < 3; i++ )
+	{
+		ZONE_PROFILE( "Entity" );
+		SpinTicks( 500 );
+	}
+}
+
+static int s_nWorkerThread;
+
+static uintp ZoneProfilerWorkerFn( void *pParam )
+{
+	ZoneProfiler_SetThreadName( "worker" );
+	s_nWorkerThread = ZoneProfiler_GetThread()->m_nIndex;
+
+	{
+		ZONE_PROFILE( "Job" );
+		SpinTicks( 1000 );
+	}
+
+	ZoneProfiler_DetachThread();
+	return 0;
+}
+
+static uintp ZoneProfilerFirstUseFn( void *pParam )
+{
+	{
+		ZONE_PROFILE( "FirstUse" );
+	}
+
+	ZoneProfiler_DetachThread();
+	return 0;
+}
+
+static bool BufferContains( CUtlBuffer &buf, const char *pszString )
+{
+	CUtlVector< char > text;
+	text.AddMultipleToTail( buf.TellPut(), ( const char * )buf.Base() );
+	text.AddToTail( '\0' );
+	return strstr( text.Base(), pszString ) != NULL;
+}
+
+REGISTER_NAMED_TEST( "zoneprofiler.FramesTreeAndExport", zoneprofiler_FramesTreeAndExport )
+{
+	// Off, a zone records nothing and isn't registered
+	int nZonesBefore = ZoneProfiler_GetZoneCount();
+	{
+		ZONE_PROFILE( "Disabled" );
+	}
+	TEST_TRUE( !g_pZoneProfilerThread || g_pZoneProfilerThread->m_nWrite.load() == 0 );
+	TEST_EQ( ZoneProfiler_GetZoneCount(), nZonesBefore );
+
+	CZoneProfilerAggregator aggregator;
+	aggregator.SetCaptureFrames( 4 );
+	ZoneProfiler_Enable( true );
+	ZoneProfiler_SetThreadName( "main \"game\"" );
+	int nMainThread = ZoneProfiler_GetThread()->m_nIndex;
+
+	// Before the first frame mark, so not in any frame
+	{
+		ZONE_PROFILE( "Frame" );
+	}
+
+	ZoneProfiler_FrameMark();
+	for ( int nFrame = 0; nFrame < 10; nFrame++ )
+	{
+		RecordTestFrame( nFrame );
+		if ( nFrame == 5 )
+		{
+			ThreadHandle_t hWorker = CreateSimpleThread( ZoneProfilerWorkerFn, NULL );
+			ThreadJoin( hWorker );
+			ReleaseThreadHandle( hWorker );
+		}
+
+		ZoneProfiler_FrameMark();
+		aggregator.Update();
+	}
+
+	// Frame 9 waits for the frame after it to end
+	TEST_EQ( aggregator.GetFrameCount(), 9 );
+	ZoneProfiler_FrameMark();
+	aggregator.Update();
+	TEST_EQ( aggregator.GetFrameCount(), 10 );
+	TEST_EQ( aggregator.GetLateZones(), ( uint64 )1 );
+	TEST_EQ( aggregator.GetDroppedZones(), ( uint64 )0 );
+
+	int nRoot = aggregator.GetThreadRoot( nMainThread );
+	TEST_TRUE( nRoot >= 0 );
+	int nFrameNode = aggregator.FindChild( nRoot, "Frame" );
+	int nPhysics = aggregator.FindChild( nFrameNode, "Physics" );
+	int nEntity = aggregator.FindChild( nFrameNode, "Entity" );
+	TEST_TRUE( nFrameNode >= 0 );
+	TEST_TRUE( nPhysics >= 0 );
+	TEST_TRUE( nEntity >= 0 );
+	TEST_EQ( aggregator.FindChild( nRoot, "Entity" ), -1 );
+	TEST_EQ( aggregator.GetNode( nEntity ).m_nParent, nFrameNode );
+
+	ZoneProfilerStats_t stats;
+	TEST_TRUE( aggregator.GetStats( nEntity, stats ) );
+	TEST_EQ( stats.m_nCalls, ( uint64 )30 );
+	TEST_EQ( stats.m_nFrames, 10 );
+
+	TEST_TRUE( aggregator.GetStats( nPhysics, stats ) );
+	TEST_EQ( stats.m_nCalls, ( uint64 )10 );
+	TEST_TRUE( stats.m_flMinMs > 0.0 );
+	TEST_TRUE( stats.m_flMinMs <= stats.m_flP50Ms );
+	TEST_TRUE( stats.m_flP50Ms <= stats.m_flP99Ms );
+	TEST_TRUE( stats.m_flP99Ms <= stats.m_flMaxMs );
+
+	ZoneProfilerStats_t frameStats;
+	TEST_TRUE( aggregator.GetStats( nFrameNode, frameStats ) );
+	TEST_TRUE( frameStats.m_flMinMs >= stats.m_flMinMs );
+
+	// The worker has a tree of its own
+	int nWorkerRoot = aggregator.GetThreadRoot( s_nWorkerThread );
+	TEST_TRUE( nWorkerRoot >= 0 && nWorkerRoot != nRoot );
+	TEST_TRUE( aggregator.FindChild( nWorkerRoot, "Job" ) >= 0 );
+	TEST_EQ( aggregator.FindChild( nRoot, "Job" ), -1 );
+
+	// The capture keeps the last 4 frames: 5 zones a frame on the main thread
+	CZoneProfilerCapture capture;
+	aggregator.GetCapture( capture );
+	TEST_EQ( capture.m_FrameStarts.Count(), 5 );
+	TEST_EQ( capture.m_Events.Count(), 4 * 5 );
+	TEST_TRUE( capture.m_flTicksPerSecond > 0.0 );
+
+	CUtlBuffer json( 0, 0, CUtlBuffer::TEXT_BUFFER );
+	capture.ExportChromeTrace( json );
+	TEST_TRUE( BufferContains( json, "\"traceEvents\":[" ) );
+	TEST_TRUE( BufferContains( json, "{\"ph\":\"X\",\"name\":\"Physics\"" ) );
+	TEST_TRUE( BufferContains( json, "\"args\":{\"name\":\"main \\\"game\\\"\"}" ) );
+
+	CUtlBuffer binary;
+	capture.ExportBinary( binary );
+	TEST_TRUE( binary.TellPut() < capture.m_Events.Count() * ( int )sizeof( ZoneProfilerEvent_t ) );
+
+	CZoneProfilerCapture imported;
+	TEST_TRUE( imported.ImportBinary( binary ) );
+	TEST_EQ( imported.m_flTicksPerSecond == capture.m_flTicksPerSecond, true );
+	TEST_EQ( imported.m_ZoneNames.Count(), capture.m_ZoneNames.Count() );
+	TEST_EQ( imported.m_ThreadNames.Count(), capture.m_ThreadNames.Count() );
+	TEST_EQ( V_strcmp( imported.m_ThreadNames[nMainThread].Get(), "main \"game\"" ), 0 );
+	TEST_EQ( imported.m_FrameStarts.Count(), capture.m_FrameStarts.Count() );
+	TEST_EQ( imported.m_Events.Count(), capture.m_Events.Count() );
+	TEST_EQ( memcmp( imported.m_FrameStarts.Base(), capture.m_FrameStarts.Base(), capture.m_FrameStarts.Count() * sizeof( uint64 ) ), 0 );
+
+	bool bEventsMatch = true;
+	for ( int i = 0; i < capture.m_Events.Count(); i++ )
+	{
+		const ZoneProfilerCaptureEvent_t &a = capture.m_Events[i];
+		const ZoneProfilerCaptureEvent_t &b = imported.m_Events[i];
+		bEventsMatch &= a.m_nStart == b.m_nStart && a.m_nTicks == b.m_nTicks && a.m_nZone == b.m_nZone && a.m_nDepth == b.m_nDepth && a.m_nThread == b.m_nThread;
+	}
+	TEST_TRUE( bEventsMatch );
+
+	// Cut short, it doesn't load
+	CUtlBuffer truncated;
+	truncated.Put( binary.Base(), binary.TellPut() - 3 );
+	TEST_FALSE( imported.ImportBinary( truncated ) );
+
+	// A full ring drops zones rather than wait for the aggregator
+	for ( int i = 0; i < ZONE_PROFILER_RING_SIZE + 10; i++ )
+	{
+		ZONE_PROFILE( "Flood" );
+	}
+	TEST_EQ( aggregator.GetDroppedZones(), ( uint64 )10 );
+
+	// Threads reaching a site for the first time together register it once
+	int nZonesBeforeFirstUse = ZoneProfiler_GetZoneCount();
+	ThreadHandle_t hFirstUse[8];
+	for ( int i = 0; i < 8; i++ )
+		hFirstUse[i] = CreateSimpleThread( ZoneProfilerFirstUseFn, NULL );
+	for ( int i = 0; i < 8; i++ )
+	{
+		ThreadJoin( hFirstUse[i] );
+		ReleaseThreadHandle( hFirstUse[i] );
+	}
+	TEST_EQ( ZoneProfiler_GetZoneCount(), nZonesBeforeFirstUse + 1 );
+	TEST_EQ( V_strcmp( ZoneProfiler_GetZoneName( ( uint16 )nZonesBeforeFirstUse ), "FirstUse" ), 0 );
+
+	ZoneProfiler_Enable( false );
+	aggregator.Update();
+}
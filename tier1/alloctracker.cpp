@@ -0,0 +1,404 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: Allocation tracking for the tier1 containers
+//
+//=============================================================================//
+
+#include "tier1/alloctrackersnapshot.h"
+#include "tier0/threadtools.h"
+#include "tier0/utlbuffer.h"
+#include "tier0/strtools.h"
+
+#include <algorithm>
+
+// memdbgon must be the last include file in a .cpp file!!!
+#include "tier0/memdbgon.h"
+
+COMPILE_TIME_ASSERT( ( ALLOC_TRACKER_THREAD_SLOTS & ( ALLOC_TRACKER_THREAD_SLOTS - 1 ) ) == 0 );
+
+thread_local CAllocTrackerThread *g_pAllocTrackerThread;
+thread_local uint32 g_nAllocTrackerSite = ALLOC_TRACKER_NO_SITE;
+
+static std::atomic< CAllocTrackerThread * > s_pAllocTrackerThreads( NULL );
+
+//-----------------------------------------------------------------------------
+// Names. A list rather than a CUtlVector: the registry is written while a
+// type token is being made, and a tracked container here would need one.
+//-----------------------------------------------------------------------------
+struct AllocTrackerName_t
+{
+	uint32 m_nToken;
+	const char *m_pszName;
+	AllocTrackerName_t *m_pNext;
+};
+
+// Function statics, so types and sites registered during static init of other files find them constructed
+static CThreadFastMutex &AllocTrackerNamesMutex()
+{
+	static CThreadFastMutex s_Mutex;
+	return s_Mutex;
+}
+
+static AllocTrackerName_t *&AllocTrackerNames()
+{
+	static AllocTrackerName_t *s_pNames = NULL;
+	return s_pNames;
+}
+
+// Function statics aren't guarded (-fno-threadsafe-statics), construct the mutex before any thread can race for it
+static const bool s_bAllocTrackerNamesConstructed = ( AllocTrackerNamesMutex(), true );
+
+// pszName is kept, not copied
+static uint32 AllocTracker_AddName( const char *pszName, int nLength, bool bOwned )
+{
+	uint32 nToken = CUtlStringToken( pszName, nLength ).GetHashCode();
+
+	AUTO_LOCK_FM( AllocTrackerNamesMutex() );
+
+	AllocTrackerName_t *&pNames = AllocTrackerNames();
+	for ( AllocTrackerName_t *pName = pNames; pName; pName = pName->m_pNext )
+	{
+		if ( pName->m_nToken == nToken )
+		{
+			if ( bOwned )
+			{
+				delete[] pszName;
+			}
+
+			return nToken;
+		}
+	}
+
+	AllocTrackerName_t *pName = new AllocTrackerName_t;
+	pName->m_nToken = nToken;
+	pName->m_pszName = pszName;
+	pName->m_pNext = pNames;
+	pNames = pName;
+
+	return nToken;
+}
+
+uint32 AllocTracker_RegisterSite( const char *pszName )
+{
+	return AllocTracker_AddName( pszName, V_strlen( pszName ), false );
+}
+
+// Cuts T out of the signature of AllocTracker_TypeToken< T >, which is
+// "uint32 AllocTracker_TypeToken() [with T = Foo; uint32 = unsigned int]" for
+// GCC and Clang, "unsigned int __cdecl AllocTracker_TypeToken<struct Foo>(void)"
+// for MSVC
+uint32 AllocTracker_RegisterType( const char *pszFunctionSignature )
+{
+	const char *pszStart = V_strstr( pszFunctionSignature, "T = " );
+	const char *pszEnd = NULL;
+	if ( pszStart )
+	{
+		pszStart += 4;
+
+		// Up to the first ';' or ']' outside the type's own brackets
+		int nDepth = 0;
+		for ( pszEnd = pszStart; *pszEnd; pszEnd++ )
+		{
+			if ( *pszEnd == '<' || *pszEnd == '(' || *pszEnd == '[' )
+				nDepth++;
+			else if ( ( *pszEnd == '>' || *pszEnd == ')' || *pszEnd == ']' ) && nDepth-- == 0 )
+				break;
+			else if ( *pszEnd == ';' && !nDepth )
+				break;
+		}
+	}
+	else if ( ( pszStart = V_strstr( pszFunctionSignature, "AllocTracker_TypeToken<" ) ) != NULL )
+	{
+		pszStart += V_strlen( "AllocTracker_TypeToken<" );
+		pszEnd = V_strstr( pszStart, ">(void)" );
+		if ( !pszEnd )
+		{
+			pszEnd = pszStart + V_strlen( pszStart );
+		}
+
+		if ( !V_strncmp( pszStart, "class ", 6 ) )
+			pszStart += 6;
+		else if ( !V_strncmp( pszStart, "struct ", 7 ) )
+			pszStart += 7;
+	}
+	else
+	{
+		pszStart = pszFunctionSignature;
+		pszEnd = pszStart + V_strlen( pszStart );
+	}
+
+	int nLength = ( int )( pszEnd - pszStart );
+	char *pszName = new char[nLength + 1];
+	V_memcpy( pszName, pszStart, nLength );
+	pszName[nLength] = '\0';
+
+	return AllocTracker_AddName( pszName, nLength, true );
+}
+
+const char *AllocTracker_GetName( uint32 nToken )
+{
+	AUTO_LOCK_FM( AllocTrackerNamesMutex() );
+
+	for ( AllocTrackerName_t *pName = AllocTrackerNames(); pName; pName = pName->m_pNext )
+	{
+		if ( pName->m_nToken == nToken )
+			return pName->m_pszName;
+	}
+
+	return NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Threads
+//-----------------------------------------------------------------------------
+CAllocTrackerThread::CAllocTrackerThread() :
+	m_bInUse( false ),
+	m_pNext( NULL )
+{
+	for ( int i = -1; i < ALLOC_TRACKER_THREAD_SLOTS; i++ )
+	{
+		AllocTrackerCounter_t &counter = ( i < 0 ) ? m_Overflow : m_Counters[i];
+		counter.m_nTag.store( 0, std::memory_order_relaxed );
+		counter.m_nAllocs.store( 0, std::memory_order_relaxed );
+		counter.m_nFrees.store( 0, std::memory_order_relaxed );
+		counter.m_nAllocBytes.store( 0, std::memory_order_relaxed );
+		counter.m_nFreeBytes.store( 0, std::memory_order_relaxed );
+	}
+}
+
+// Gives the counters back when a thread that attached exits
+class CAllocTrackerThreadExit
+{
+public:
+	~CAllocTrackerThreadExit()
+	{
+		AllocTracker_DetachThread();
+	}
+};
+
+CAllocTrackerThread *AllocTracker_AttachThread()
+{
+	static thread_local CAllocTrackerThreadExit s_ThreadExit;
+	(void)s_ThreadExit;
+
+	if ( g_pAllocTrackerThread )
+		return g_pAllocTrackerThread;
+
+	// A thread that picks up counters another thread left keeps adding to
+	// them, the totals are over all threads anyway
+	CAllocTrackerThread *pThread = NULL;
+	for ( CAllocTrackerThread *pFree = s_pAllocTrackerThreads.load( std::memory_order_acquire ); pFree; pFree = pFree->m_pNext )
+	{
+		bool bInUse = false;
+		if ( !pFree->m_bInUse.load( std::memory_order_relaxed ) && pFree->m_bInUse.compare_exchange_strong( bInUse, true, std::memory_order_acquire ) )
+		{
+			pThread = pFree;
+			break;
+		}
+	}
+
+	if ( !pThread )
+	{
+		pThread = new CAllocTrackerThread;
+		pThread->m_bInUse.store( true, std::memory_order_relaxed );
+
+		CAllocTrackerThread *pHead = s_pAllocTrackerThreads.load( std::memory_order_relaxed );
+		do
+		{
+			pThread->m_pNext = pHead;
+		}
+		while ( !s_pAllocTrackerThreads.compare_exchange_weak( pHead, pThread, std::memory_order_release, std::memory_order_relaxed ) );
+	}
+
+	g_pAllocTrackerThread = pThread;
+	return pThread;
+}
+
+void AllocTracker_DetachThread()
+{
+	CAllocTrackerThread *pThread = g_pAllocTrackerThread;
+	if ( !pThread )
+		return;
+
+	g_pAllocTrackerThread = NULL;
+	pThread->m_bInUse.store( false, std::memory_order_release );
+}
+
+//-----------------------------------------------------------------------------
+// Snapshots
+//-----------------------------------------------------------------------------
+static bool AllocTrackerEntryLess( const AllocTrackerEntry_t &a, const AllocTrackerEntry_t &b )
+{
+	if ( a.m_Type.GetHashCode() != b.m_Type.GetHashCode() )
+		return a.m_Type.GetHashCode() < b.m_Type.GetHashCode();
+
+	return a.m_Site.GetHashCode() < b.m_Site.GetHashCode();
+}
+
+static void AllocTrackerReadCounter( const AllocTrackerCounter_t &counter, AllocTrackerEntry_t &entry )
+{
+	entry.m_nAllocs = counter.m_nAllocs.load( std::memory_order_relaxed );
+	entry.m_nFrees = counter.m_nFrees.load( std::memory_order_relaxed );
+	entry.m_nAllocBytes = counter.m_nAllocBytes.load( std::memory_order_relaxed );
+	entry.m_nFreeBytes = counter.m_nFreeBytes.load( std::memory_order_relaxed );
+}
+
+void CAllocTrackerSnapshot::Capture()
+{
+	CUtlVector< AllocTrackerEntry_t > entries;
+	entries.EnsureCapacity( ALLOC_TRACKER_THREAD_SLOTS );
+
+	for ( CAllocTrackerThread *pThread = s_pAllocTrackerThreads.load( std::memory_order_acquire ); pThread; pThread = pThread->m_pNext )
+	{
+		for ( int i = 0; i < ALLOC_TRACKER_THREAD_SLOTS; i++ )
+		{
+			const AllocTrackerCounter_t &counter = pThread->m_Counters[i];
+			uint64 nTag = counter.m_nTag.load( std::memory_order_acquire );
+			if ( !nTag )
+				continue;
+
+			AllocTrackerEntry_t &entry = entries[entries.AddToTail()];
+			entry.m_Type = CUtlStringToken( ( uint32 )( nTag >> 32 ) );
+			entry.m_Site = CUtlStringToken( ( uint32 )nTag );
+			AllocTrackerReadCounter( counter, entry );
+		}
+
+		// Whatever didn't fit in the table goes in as type and site 0
+		AllocTrackerEntry_t &overflow = entries[entries.AddToTail()];
+		overflow.m_Type = CUtlStringToken( 0u );
+		overflow.m_Site = CUtlStringToken( ( uint32 )ALLOC_TRACKER_NO_SITE );
+		AllocTrackerReadCounter( pThread->m_Overflow, overflow );
+		if ( !overflow.m_nAllocs && !overflow.m_nFrees )
+		{
+			entries.RemoveMultipleFromTail( 1 );
+		}
+	}
+
+	std::sort( entries.Base(), entries.Base() + entries.Count(), AllocTrackerEntryLess );
+
+	// Threads that counted the same tag fold into one entry
+	int nOut = 0;
+	for ( int i = 0; i < entries.Count(); i++ )
+	{
+		if ( nOut && !AllocTrackerEntryLess( entries[nOut - 1], entries[i] ) )
+		{
+			AllocTrackerEntry_t &entry = entries[nOut - 1];
+			entry.m_nAllocs += entries[i].m_nAllocs;
+			entry.m_nFrees += entries[i].m_nFrees;
+			entry.m_nAllocBytes += entries[i].m_nAllocBytes;
+			entry.m_nFreeBytes += entries[i].m_nFreeBytes;
+		}
+		else
+		{
+			entries[nOut++] = entries[i];
+		}
+	}
+
+	entries.SetCountNonDestructively( nOut );
+	m_Entries.Swap( entries );
+}
+
+void CAllocTrackerSnapshot::Diff( const CAllocTrackerSnapshot &before, const CAllocTrackerSnapshot &after, CAllocTrackerSnapshot &out )
+{
+	Assert( &out != &before && &out != &after );
+
+	out.m_Entries.RemoveAll();
+
+	// Both are ordered by tag, and every tag in before is in after too
+	int nBefore = 0;
+	for ( int i = 0; i < after.m_Entries.Count(); i++ )
+	{
+		const AllocTrackerEntry_t &entry = after.m_Entries[i];
+		while ( nBefore < before.m_Entries.Count() && AllocTrackerEntryLess( before.m_Entries[nBefore], entry ) )
+		{
+			nBefore++;
+		}
+
+		AllocTrackerEntry_t diff = entry;
+		if ( nBefore < before.m_Entries.Count() && !AllocTrackerEntryLess( entry, before.m_Entries[nBefore] ) )
+		{
+			const AllocTrackerEntry_t &prev = before.m_Entries[nBefore];
+			diff.m_nAllocs -= prev.m_nAllocs;
+			diff.m_nFrees -= prev.m_nFrees;
+			diff.m_nAllocBytes -= prev.m_nAllocBytes;
+			diff.m_nFreeBytes -= prev.m_nFreeBytes;
+		}
+
+		if ( diff.m_nAllocs || diff.m_nFrees )
+		{
+			out.m_Entries.AddToTail( diff );
+		}
+	}
+}
+
+void CAllocTrackerSnapshot::SortByLiveBytes()
+{
+	std::stable_sort( m_Entries.Base(), m_Entries.Base() + m_Entries.Count(), []( const AllocTrackerEntry_t &a, const AllocTrackerEntry_t &b )
+	{
+		return a.LiveBytes() > b.LiveBytes();
+	} );
+}
+
+const AllocTrackerEntry_t *CAllocTrackerSnapshot::Find( CUtlStringToken type, CUtlStringToken site ) const
+{
+	for ( int i = 0; i < m_Entries.Count(); i++ )
+	{
+		if ( m_Entries[i].m_Type == type && m_Entries[i].m_Site == site )
+			return &m_Entries[i];
+	}
+
+	return NULL;
+}
+
+int64 CAllocTrackerSnapshot::LiveBytes() const
+{
+	int64 nBytes = 0;
+	for ( int i = 0; i < m_Entries.Count(); i++ )
+	{
+		nBytes += m_Entries[i].LiveBytes();
+	}
+
+	return nBytes;
+}
+
+static void AllocTrackerPrintName( CUtlBuffer &buf, uint32 nToken, const char *pszNone )
+{
+	const char *pszName = !nToken ? pszNone : AllocTracker_GetName( nToken );
+	if ( pszName )
+		buf.Printf( "%s", pszName );
+	else
+		buf.Printf( "0x%08x", nToken );
+}
+
+void CAllocTrackerSnapshot::Dump( CUtlBuffer &buf, int nMaxEntries ) const
+{
+	int nCount = ( nMaxEntries < 0 ) ? m_Entries.Count() : MIN( nMaxEntries, m_Entries.Count() );
+
+	buf.Printf( "%14s %10s %10s %10s  %s\n", "live bytes", "live", "allocs", "frees", "type @ site" );
+
+	AllocTrackerEntry_t total = {};
+	for ( int i = 0; i < m_Entries.Count(); i++ )
+	{
+		const AllocTrackerEntry_t &entry = m_Entries[i];
+		total.m_nAllocs += entry.m_nAllocs;
+		total.m_nFrees += entry.m_nFrees;
+		total.m_nAllocBytes += entry.m_nAllocBytes;
+		total.m_nFreeBytes += entry.m_nFreeBytes;
+
+		if ( i >= nCount )
+			continue;
+
+		buf.Printf( "%14lld %10lld %10lld %10lld  ", ( long long )entry.LiveBytes(), ( long long )entry.LiveCount(), ( long long )entry.m_nAllocs, ( long long )entry.m_nFrees );
+		AllocTrackerPrintName( buf, entry.m_Type.GetHashCode(), "(past the tag table)" );
+		buf.PutString( " @ " );
+		AllocTrackerPrintName( buf, entry.m_Site.GetHashCode(), "-" );
+		buf.PutString( "\n" );
+	}
+
+	if ( nCount < m_Entries.Count() )
+	{
+		buf.Printf( "%14s %10s %10s %10s  (%d more)\n", "", "", "", "", m_Entries.Count() - nCount );
+	}
+
+	buf.Printf( "%14lld %10lld %10lld %10lld  total\n", ( long long )total.LiveBytes(), ( long long )total.LiveCount(), ( long long )total.m_nAllocs, ( long long )total.m_nFrees );
+}
@@ -0,0 +1,316 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: Per-thread bump arena for transient CBufferStrings
+//
+//=============================================================================//
+
+#include "tier1/bufferstringarena.h"
+#include "tier0/dbg.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// memdbgon must be the last include file in a .cpp file!!!
+#include "tier0/memdbgon.h"
+
+thread_local CBufferStringArena *g_pBufferStringArena;
+
+//-----------------------------------------------------------------------------
+// The arena
+//-----------------------------------------------------------------------------
+CBufferStringArena::CBufferStringArena() :
+	m_pFirst( NULL ),
+	m_pBlock( NULL ),
+	m_nUsed( 0 ),
+	m_nBlocks( 0 ),
+	m_pStrings( NULL ),
+	m_nScopePosition( 0 ),
+	m_nScopeDepth( 0 )
+{
+}
+
+CBufferStringArena::~CBufferStringArena()
+{
+	Assert( !m_nScopeDepth && !m_pStrings );
+
+	while ( m_pFirst )
+	{
+		Block_t *pNext = m_pFirst->m_pNext;
+		free( m_pFirst );
+		m_pFirst = pNext;
+	}
+}
+
+char *CBufferStringArena::Alloc( int nBytes, uint64 &nPosition )
+{
+	if ( nBytes > BLOCK_SIZE )
+		return NULL;
+
+	// Blocks stay after a rewind, so past the first scope this is a walk down the list
+	if ( !m_pBlock || m_nUsed + nBytes > BLOCK_SIZE )
+	{
+		Block_t *pNext = m_pBlock ? m_pBlock->m_pNext : m_pFirst;
+		if ( !pNext )
+		{
+			pNext = ( Block_t * )malloc( sizeof( Block_t ) + BLOCK_SIZE );
+			pNext->m_pNext = NULL;
+			pNext->m_nIndex = m_nBlocks++;
+
+			( m_pBlock ? m_pBlock->m_pNext : m_pFirst ) = pNext;
+		}
+
+		m_pBlock = pNext;
+		m_nUsed = 0;
+	}
+
+	nPosition = GetPosition();
+
+	char *pBuffer = m_pBlock->Data() + m_nUsed;
+	m_nUsed += nBytes;
+	return pBuffer;
+}
+
+bool CBufferStringArena::Extend( uint64 nPosition, int nOldBytes, int nNewBytes )
+{
+	if ( nPosition < m_nScopePosition || nPosition + nOldBytes != GetPosition() || m_nUsed - nOldBytes + nNewBytes > BLOCK_SIZE )
+		return false;
+
+	m_nUsed += nNewBytes - nOldBytes;
+	return true;
+}
+
+void CBufferStringArena::Free( uint64 nPosition, int nBytes )
+{
+	// A scope's mark must not be freed past, what's below it is still the outer scope's
+	if ( nPosition >= m_nScopePosition && nPosition + nBytes == GetPosition() )
+	{
+		m_nUsed -= nBytes;
+	}
+}
+
+void CBufferStringArena::Link( CArenaBufferString *pString )
+{
+	Assert( !m_pStrings || m_pStrings->m_nArenaPosition < pString->m_nArenaPosition );
+
+	pString->m_pPrev = NULL;
+	pString->m_pNext = m_pStrings;
+
+	if ( m_pStrings )
+		m_pStrings->m_pPrev = pString;
+
+	m_pStrings = pString;
+}
+
+void CBufferStringArena::Unlink( CArenaBufferString *pString )
+{
+	if ( pString->m_pPrev )
+		pString->m_pPrev->m_pNext = pString->m_pNext;
+	else
+		m_pStrings = pString->m_pNext;
+
+	if ( pString->m_pNext )
+		pString->m_pNext->m_pPrev = pString->m_pPrev;
+}
+
+void CBufferStringArena::EnterScope( uint64 &nPrevScopePosition )
+{
+	nPrevScopePosition = m_nScopePosition;
+	m_nScopePosition = GetPosition();
+
+	if ( !m_nScopeDepth++ )
+		g_pBufferStringArena = this;
+}
+
+void CBufferStringArena::LeaveScope( const Mark_t &mark, uint64 nPrevScopePosition )
+{
+	// Whatever of the scope's part of the arena is still in use belongs to strings
+	// the scope didn't outlive; they're the newest, so they're at the head
+	while ( m_pStrings && m_pStrings->m_nArenaPosition >= m_nScopePosition )
+	{
+		m_pStrings->Promote();
+	}
+
+	m_pBlock = mark.m_pBlock;
+	m_nUsed = mark.m_nUsed;
+	m_nScopePosition = nPrevScopePosition;
+
+	if ( !--m_nScopeDepth )
+		g_pBufferStringArena = NULL;
+}
+
+CBufferStringArena *BufferStringArena_GetThread()
+{
+	static thread_local CBufferStringArena s_Arena;
+	return &s_Arena;
+}
+
+//-----------------------------------------------------------------------------
+// Scopes
+//-----------------------------------------------------------------------------
+CBufferStringArenaScope::CBufferStringArenaScope( bool bEnter ) :
+	m_pArena( bEnter ? BufferStringArena_GetThread() : NULL )
+{
+	if ( !m_pArena )
+		return;
+
+	m_Mark = m_pArena->GetMark();
+	m_pArena->EnterScope( m_nPrevScopePosition );
+}
+
+CBufferStringArenaScope::~CBufferStringArenaScope()
+{
+	if ( m_pArena )
+		m_pArena->LeaveScope( m_Mark, m_nPrevScopePosition );
+}
+
+//-----------------------------------------------------------------------------
+// Strings
+//-----------------------------------------------------------------------------
+void CArenaBufferString::Attach( int nCapacity )
+{
+	CBufferStringArena *pArena = g_pBufferStringArena;
+
+	char *pBuffer = pArena->Alloc( nCapacity + 1, m_nArenaPosition );
+	if ( !pBuffer )
+		return;
+
+	// Not ours to free, and tier0 moves it to the heap when it needs more. It's told
+	// a byte less than there is, so the terminator fits however it's counted
+	pBuffer[0] = '\0';
+	SetPtr( pBuffer, nCapacity, 0, false, true );
+
+	m_pArenaBuffer = pBuffer;
+	m_nArenaCapacity = nCapacity;
+	pArena->Link( this );
+}
+
+void CArenaBufferString::Detach()
+{
+	// The scope that gave the buffer promotes the string before it ends, so one is still open
+	CBufferStringArena *pArena = g_pBufferStringArena;
+	AssertMsg( pArena, "CArenaBufferString detached outside of a CBufferStringArenaScope" );
+	if ( !pArena )
+	{
+		m_pArenaBuffer = NULL;
+		return;
+	}
+
+	pArena->Unlink( this );
+	pArena->Free( m_nArenaPosition, m_nArenaCapacity + 1 );
+	m_pArenaBuffer = NULL;
+}
+
+void CArenaBufferString::Assign( const char *pString, int nLen )
+{
+	if ( nLen < 0 )
+		nLen = V_strlen( pString );
+
+	Reserve( nLen );
+	Set( pString, nLen );
+}
+
+void CArenaBufferString::Promote()
+{
+	if ( !m_pArenaBuffer )
+		return;
+
+	if ( IsInArena() )
+		EnsureOwnedAllocation( BS_AO_HEAP_ALLOCATION );
+
+	Detach();
+}
+
+bool CArenaBufferString::Reserve( int nCapacity )
+{
+	if ( !IsInArena() || nCapacity >= CBufferStringArena::BLOCK_SIZE - 1 )
+		return false;
+
+	if ( nCapacity < m_nArenaCapacity )
+		return true;
+
+	// Doubled, so a string built up a piece at a time moves a few times at most
+	int nNewCapacity = MIN( MAX( nCapacity + 1, 2 * m_nArenaCapacity ), CBufferStringArena::BLOCK_SIZE - 1 );
+
+	CBufferStringArena *pArena = g_pBufferStringArena;
+	if ( !pArena->Extend( m_nArenaPosition, m_nArenaCapacity + 1, nNewCapacity + 1 ) )
+	{
+		uint64 nPosition;
+		char *pBuffer = pArena->Alloc( nNewCapacity + 1, nPosition );
+		if ( !pBuffer )
+			return false;
+
+		// The old buffer is given back with the scope, the new one is the newest
+		memcpy( pBuffer, m_pArenaBuffer, Length() + 1 );
+
+		pArena->Unlink( this );
+		m_pArenaBuffer = pBuffer;
+		m_nArenaPosition = nPosition;
+		pArena->Link( this );
+	}
+
+	m_nArenaCapacity = nNewCapacity;
+	SetPtr( m_pArenaBuffer, nNewCapacity, Length(), false, true );
+	return true;
+}
+
+int CArenaBufferString::AppendFormatV( const char *pFormat, va_list params )
+{
+	if ( !IsInArena() )
+	{
+		BaseClass::AppendFormatV( pFormat, params );
+		return Length();
+	}
+
+	int nLength = Length();
+
+	// Straight into the room that's left, which also says how much room it takes
+	va_list paramsCopy;
+	va_copy( paramsCopy, params );
+	int nAdded = vsnprintf( m_pArenaBuffer + nLength, m_nArenaCapacity - nLength, pFormat, paramsCopy );
+	va_end( paramsCopy );
+
+	if ( nAdded < 0 )
+	{
+		m_pArenaBuffer[nLength] = '\0';
+		return nLength;
+	}
+
+	if ( nLength + nAdded >= m_nArenaCapacity )
+	{
+		m_pArenaBuffer[nLength] = '\0';
+
+		if ( !Reserve( nLength + nAdded ) )
+		{
+			BaseClass::AppendFormatV( pFormat, params );
+			return Length();
+		}
+
+		vsnprintf( m_pArenaBuffer + nLength, nAdded + 1, pFormat, params );
+	}
+
+	SetLength( nLength + nAdded );
+	return Length();
+}
+
+int CArenaBufferString::AppendFormat( const char *pFormat, ... )
+{
+	va_list params;
+	va_start( params, pFormat );
+	int nLength = AppendFormatV( pFormat, params );
+	va_end( params );
+
+	return nLength;
+}
+
+int CArenaBufferString::Format( const char *pFormat, ... )
+{
+	Clear();
+
+	va_list params;
+	va_start( params, pFormat );
+	int nLength = AppendFormatV( pFormat, params );
+	va_end( params );
+
+	return nLength;
+}
@@ -14,12 +14,25 @@
 #include "tier0/characterset.h"
 #include "tier0/strtools.h"
 #include "tier0/utlbuffer.h"
+#include "tier1/bufferstringarena.h"
 #include "tier1/convar.h"
+#include "tier1/strtools_simd.h"
 #include "tier1/utlvector.h"
 #include "tier1/tier1.h"
 #include "icvar.h"
 #include "tier0/dbg.h"
 #include "color.h"
+#if !defined( PLATFORM_PPC ) && ( defined( _M_X64 ) || defined( _M_IX86 ) || defined( __x86_64__ ) || defined( __i386__ ) )
+#define COMMAND_TOKENIZER_SIMD 1
+#else
+#define COMMAND_TOKENIZER_SIMD 0
+#endif
+#if COMMAND_TOKENIZER_SIMD
+#include <smmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
 #if defined( _X360 )
 #include "xbox/xbox_console.h"
 #endif
@@ -375,6 +388,92 @@ bool ConVar_Unregister( )
 }
 
 
+//-----------------------------------------------------------------------------
+// Tokenizer break set. CUtlBuffer::ParseToken looks each byte up in the
+// characterset_t as it copies it; here the breaks, the quote and everything up
+// to the space are folded into a 256-bit table, so the end of a word can be
+// found 16 bytes at a time and the word copied in one go. Each thread keeps the
+// last break set it tokenized with and only rebuilds if that changes.
+//-----------------------------------------------------------------------------
+class CCommandBreakSet
+{
+public:
+	void Init( const characterset_t *pBreakSet )
+	{
+		if ( m_pSource == pBreakSet && !memcmp( m_BreakSet.set, pBreakSet->set, sizeof( m_BreakSet.set ) ) )
+			return;
+
+		m_pSource = pBreakSet;
+		m_BreakSet = *pBreakSet;
+		memset( m_EndsWordRows, 0, sizeof( m_EndsWordRows ) );
+
+		for ( int c = 0; c < 256; c++ )
+		{
+			m_bEndsWord[c] = m_BreakSet.set[c] || c == '\"' || c <= ' ';
+			if ( m_bEndsWord[c] )
+			{
+				m_EndsWordRows[c >> 7][c & 0x0F] |= 1 << ( ( c >> 4 ) & 7 );
+			}
+		}
+	}
+
+	// isspace() in the C locale, which is what CUtlBuffer::EatWhiteSpace goes by
+	bool IsSpace( char c ) const { return c == ' ' || ( c >= '\t' && c <= '\r' ); }
+	bool IsBreak( char c ) const { return m_BreakSet.set[(uint8)c] != 0; }
+	bool EndsWord( char c ) const { return m_bEndsWord[(uint8)c]; }
+
+	// First byte in [nStart, nEnd) that ends a word, or nEnd
+	int FindWordEnd( const char *pText, int nStart, int nEnd ) const
+	{
+		int i = nStart;
+
+#if COMMAND_TOKENIZER_SIMD
+		if ( i + 16 <= nEnd )
+		{
+			// Bit (c >> 4) & 7 of row c & 15 in the low (c < 0x80) or high table
+			const __m128i nibbleMask = _mm_set1_epi8( 0x0F );
+			const __m128i bitSelect = _mm_setr_epi8( 1, 2, 4, 8, 16, 32, 64, (char)128, 1, 2, 4, 8, 16, 32, 64, (char)128 );
+			const __m128i rowsLow = _mm_load_si128( (const __m128i *)m_EndsWordRows[0] );
+			const __m128i rowsHigh = _mm_load_si128( (const __m128i *)m_EndsWordRows[1] );
+
+			for ( ; i + 16 <= nEnd; i += 16 )
+			{
+				__m128i input = _mm_loadu_si128( (const __m128i *)( pText + i ) );
+				__m128i lowNibble = _mm_and_si128( input, nibbleMask );
+				__m128i row = _mm_blendv_epi8( _mm_shuffle_epi8( rowsLow, lowNibble ), _mm_shuffle_epi8( rowsHigh, lowNibble ), input );
+				__m128i bit = _mm_shuffle_epi8( bitSelect, _mm_and_si128( _mm_srli_epi16( input, 4 ), nibbleMask ) );
+
+				uint32 nEndsWordMask = _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_and_si128( row, bit ), bit ) );
+				if ( nEndsWordMask )
+				{
+#ifdef _MSC_VER
+					unsigned long nIndex;
+					_BitScanForward( &nIndex, nEndsWordMask );
+					return i + nIndex;
+#else
+					return i + __builtin_ctz( nEndsWordMask );
+#endif
+				}
+			}
+		}
+#endif
+
+		while ( i < nEnd && !EndsWord( pText[i] ) )
+		{
+			i++;
+		}
+
+		return i;
+	}
+
+private:
+	const characterset_t *m_pSource;
+	characterset_t m_BreakSet;
+	bool m_bEndsWord[256];
+	alignas( 16 ) uint8 m_EndsWordRows[2][16];
+};
+
+
 //-----------------------------------------------------------------------------
 // Tokenizer class
 //-----------------------------------------------------------------------------
@@ -393,7 +492,7 @@ CCommand::CCommand( int nArgC, const char **ppArgV ) : CCommand()
 	for ( int i = 0; i < nArgC; ++i )
 	{
 		m_Args.AddToTail( pBuf );
-		int nLen = V_strlen( ppArgV[i] );
+		int nLen = V_strlen_simd( ppArgV[i] );
 		memcpy( pBuf, ppArgV[i], nLen+1 );
 		if ( i == 0 )
 		{
@@ -454,64 +553,82 @@ bool CCommand::Tokenize( const char *pCommand, const characterset_t *pBreakSet )
 		pBreakSet = DefaultBreakSet();
 	}
 
+	static thread_local CCommandBreakSet s_BreakSet;
+	s_BreakSet.Init( pBreakSet );
+
 	// Copy the current command into a temp buffer
 	// NOTE: This is here to avoid the pointers returned by DequeueNextCommand
-	// to become invalid by calling AddText. Is there a way we can avoid the memcpy?
-	int nLen = V_strlen( pCommand );
-	if ( nLen >= m_ArgSBuffer.Count() - 1 )
+	// to become invalid by calling AddText. It's the only copy of the whole
+	// command; the buffers grow to fit and never shrink, so a command that
+	// already lives in m_ArgSBuffer is never moved out from under us.
+	int nLen = V_strlen_simd( pCommand );
+	if ( m_ArgSBuffer.Count() <= nLen )
 	{
-		Warning( "CCommand::Tokenize: Encountered command which overflows the tokenizer buffer.. Skipping!\n" );
-		return false;
+		m_ArgSBuffer.SetCount( nLen + 1 );
 	}
 
 	memmove( m_ArgSBuffer.Base(), pCommand, nLen + 1 );
 
-	// Parse the current command into the current command buffer
-	CUtlBuffer bufParse( m_ArgSBuffer.Base(), nLen, static_cast<CUtlBuffer::BufferFlags_t>(CUtlBuffer::TEXT_BUFFER | CUtlBuffer::READ_ONLY) );
-	int nArgvBufferSize = 0;
-	while ( bufParse.IsValid() )
+	// A token takes at most twice its length in argv, a one character break plus its terminator
+	if ( m_ArgvBuffer.Count() < 2 * nLen + 1 )
 	{
-		char *pArgvBuf = &m_ArgvBuffer[nArgvBufferSize];
-		int nMaxLen = m_ArgvBuffer.Count() - nArgvBufferSize;
-		int nStartGet = bufParse.TellGet();
-		int	nSize = bufParse.ParseToken( pBreakSet, pArgvBuf, nMaxLen, true );
-		if ( nSize < 0 )
+		m_ArgvBuffer.SetCount( 2 * nLen + 1 );
+	}
+
+	// Same tokens as CUtlBuffer::ParseToken with comments on: quoted strings,
+	// single break characters and words ended by a break, a quote or whitespace
+	const char *pText = m_ArgSBuffer.Base();
+	char *pArgvBuf = m_ArgvBuffer.Base();
+	int nGet = 0;
+	while ( true )
+	{
+		while ( nGet < nLen && s_BreakSet.IsSpace( pText[nGet] ) )
+		{
+			++nGet;
+		}
+
+		if ( nGet + 1 < nLen && pText[nGet] == '/' && pText[nGet + 1] == '/' )
+		{
+			const char *pEndOfLine = (const char *)memchr( pText + nGet + 2, '\n', nLen - nGet - 2 );
+			nGet = pEndOfLine ? pEndOfLine - pText + 1 : nLen;
+			continue;
+		}
+
+		if ( nGet >= nLen )
 			break;
 
-		// Check for overflow condition
-		if ( nMaxLen == nSize )
+		int nTokenStart = nGet;
+		const char *pToken = pText + nGet;
+		int nSize;
+		if ( *pToken == '\"' )
 		{
-			Reset();
-			return false;
+			const char *pEndQuote = (const char *)memchr( pToken + 1, '\"', nLen - nGet - 1 );
+			++pToken;
+			nSize = pEndQuote ? pEndQuote - pToken : nLen - nGet - 1;
+			nGet += nSize + ( pEndQuote ? 2 : 1 );
+		}
+		else if ( s_BreakSet.IsBreak( *pToken ) )
+		{
+			nSize = 1;
+			++nGet;
+		}
+		else
+		{
+			nGet = s_BreakSet.FindWordEnd( pText, nGet + 1, nLen );
+			nSize = nGet - nTokenStart;
 		}
 
+		// ArgS starts at the second token, with its opening quote if it has one
 		if ( m_Args.Count() == 1 )
 		{
-			// Deal with the case where the arguments were quoted
-			m_nArgv0Size = bufParse.TellGet();
-			bool bFoundEndQuote = m_ArgSBuffer[m_nArgv0Size-1] == '\"';
-			if ( bFoundEndQuote )
-			{
-				--m_nArgv0Size;
-			}
-			m_nArgv0Size -= nSize;
+			m_nArgv0Size = nTokenStart;
 			Assert( m_nArgv0Size != 0 );
-
-			// The StartGet check is to handle this case: "foo"bar
-			// which will parse into 2 different args. ArgS should point to bar.
-			bool bFoundStartQuote = ( m_nArgv0Size > nStartGet ) && ( m_ArgSBuffer[m_nArgv0Size-1] == '\"' );
-			Assert( bFoundEndQuote == bFoundStartQuote );
-			if ( bFoundStartQuote )
-			{
-				--m_nArgv0Size;
-			}
 		}
 
+		memcpy( pArgvBuf, pToken, nSize );
+		pArgvBuf[nSize] = '\0';
 		m_Args.AddToTail( pArgvBuf );
-		nArgvBufferSize += nSize + 1;
-
-		if(nArgvBufferSize >= m_ArgvBuffer.Count())
-			break;
+		pArgvBuf += nSize + 1;
 	}
 
 	return true;
@@ -526,7 +643,7 @@ int CCommand::FindArg( const char *pName ) const
 	int nArgC = ArgC();
 	for ( int i = 1; i < nArgC; i++ )
 	{
-		if ( !V_stricmp_fast( Arg(i), pName ) )
+		if ( !V_stricmp_simd( Arg(i), pName ) )
 			return (i+1) < nArgC ? i+1 : -1;
 	}
 	return -1;
@@ -662,6 +779,28 @@ void ConVarRefAbstract::InvalidateConVarData( EConVarType type )
 		m_ConVarData = GetCvarTypeTraits( type )->m_InvalidCvarData;
 }
 
+//-----------------------------------------------------------------------------
+// Value change callbacks of this module, see ConVar_InstallValueChangeCallback
+//-----------------------------------------------------------------------------
+static CUtlVector<FnGenericChangeCallback_t> s_ValueChangeCallbacks;
+
+void ConVar_InstallValueChangeCallback( FnGenericChangeCallback_t callback )
+{
+	Assert( callback && !s_ValueChangeCallbacks.HasElement( callback ) );
+	s_ValueChangeCallbacks.AddToTail( callback );
+}
+
+void ConVar_RemoveValueChangeCallback( FnGenericChangeCallback_t callback )
+{
+	s_ValueChangeCallbacks.FindAndRemove( callback );
+}
+
+// ICvar's global change callbacks are the only ones that take the values as strings
+static bool ConVar_HasGlobalChangeCallbacks()
+{
+	return g_pCVar && static_cast<CCvar *>( g_pCVar )->m_GlobalChangeCBList.Count() > 0;
+}
+
 void ConVarRefAbstract::CallChangeCallbacks( CSplitScreenSlot slot, CVValue_t *new_value, CVValue_t *prev_value, const char *new_str, const char *prev_str )
 {
 	if(slot.Get() == -1)
@@ -672,6 +811,34 @@ void ConVarRefAbstract::CallChangeCallbacks( CSplitScreenSlot slot, CVValue_t *n
 		g_pCVar->CallChangeCallback( *this, slot, new_value, prev_value );
 		g_pCVar->CallGlobalChangeCallbacks( this, slot, new_str, prev_str );
 	}
+
+	FOR_EACH_VEC( s_ValueChangeCallbacks, i )
+	{
+		s_ValueChangeCallbacks[i]( this, slot, new_value, prev_value );
+	}
+}
+
+void ConVarRefAbstract::CallChangeCallbacks( CSplitScreenSlot slot, CVValue_t *new_value, CVValue_t *prev_value, CArenaBufferString &new_str, CArenaBufferString &prev_str )
+{
+	if(ConVar_HasGlobalChangeCallbacks())
+	{
+		// ValueToString sets the string through CBufferString &, so it only stays in the arena
+		// if it fits what's there; strings are the only values that get past the default room
+		if(GetType() == EConVarType_String)
+		{
+			prev_str.Reserve( prev_value->m_StringValue.Length() );
+			new_str.Reserve( new_value->m_StringValue.Length() );
+		}
+
+		TypeTraits()->ValueToString( prev_value, prev_str );
+		TypeTraits()->ValueToString( new_value, new_str );
+
+		CallChangeCallbacks( slot, new_value, prev_value, new_str.Get(), prev_str.Get() );
+	}
+	else
+	{
+		CallChangeCallbacks( slot, new_value, prev_value, "", "" );
+	}
 }
 
 void ConVarRefAbstract::SetOrQueueValueInternal( CSplitScreenSlot slot, CVValue_t *value )
@@ -693,36 +860,46 @@ void ConVarRefAbstract::QueueSetValueInternal( CSplitScreenSlot slot, CVValue_t
 		g_pCVar->QueueThreadSetValue( this, slot, nullptr, value );
 }
 
-void ConVarRefAbstract::SetValueInternal( CSplitScreenSlot slot, CVValue_t *value )
+bool ConVarRefAbstract::ApplyValueInternal( CSplitScreenSlot slot, CVValue_t *value, CVValue_t *prev_value )
 {
 	CVValue_t *curr_value = m_ConVarData->ValueOrDefault( slot );
 
-	CVValue_t prev;
-	TypeTraits()->Construct( &prev );
-	TypeTraits()->Copy( &prev, *curr_value );
+	// The filter gets a copy, it can't see or change the stored value while it runs
+	TypeTraits()->Construct( prev_value );
+	TypeTraits()->Copy( prev_value, *curr_value );
 
-	if(g_pCVar->CallFilterCallback( *this, slot, value, &prev ))
+	if(!g_pCVar->CallFilterCallback( *this, slot, value, prev_value ))
 	{
-		TypeTraits()->Destruct( curr_value );
+		TypeTraits()->Destruct( prev_value );
+		return false;
+	}
 
-		TypeTraits()->Construct( curr_value );
-		TypeTraits()->Copy( curr_value, *value );
-		m_ConVarData->Clamp( slot );
+	TypeTraits()->Destruct( curr_value );
+	TypeTraits()->Construct( curr_value );
+	TypeTraits()->Copy( curr_value, *value );
+	m_ConVarData->Clamp( slot );
 
-		if(!m_ConVarData->IsEqual( slot, &prev ))
-		{
-			CBufferString prev_str, new_str;
+	if(m_ConVarData->IsEqual( slot, prev_value ))
+	{
+		TypeTraits()->Destruct( prev_value );
+		return false;
+	}
 
-			TypeTraits()->ValueToString( &prev, prev_str );
-			TypeTraits()->ValueToString( curr_value, new_str );
+	m_ConVarData->IncrementTimesChanged();
+	return true;
+}
 
-			m_ConVarData->IncrementTimesChanged();
+void ConVarRefAbstract::SetValueInternal( CSplitScreenSlot slot, CVValue_t *value )
+{
+	CVValue_t prev;
+	if(ApplyValueInternal( slot, value, &prev ))
+	{
+		CBufferStringArenaScope scope( ConVar_HasGlobalChangeCallbacks() );
+		CArenaBufferString prev_str, new_str;
+		CallChangeCallbacks( slot, m_ConVarData->ValueOrDefault( slot ), &prev, new_str, prev_str );
 
-			CallChangeCallbacks( slot, curr_value, &prev, new_str.Get(), prev_str.Get() );
-		}
+		TypeTraits()->Destruct( &prev );
 	}
-
-	TypeTraits()->Destruct( &prev );
 }
 
 bool ConVarRefAbstract::SetString( CUtlString string, CSplitScreenSlot slot )
@@ -749,6 +926,114 @@ bool ConVarRefAbstract::SetString( CUtlString string, CSplitScreenSlot slot )
 	return success;
 }
 
+// -1 is the first slot
+static bool SameSplitScreenSlot( CSplitScreenSlot a, CSplitScreenSlot b )
+{
+	return MAX( a.Get(), 0 ) == MAX( b.Get(), 0 );
+}
+
+int ConVarRefAbstract::SetValues( const ConVarSetValue_t *values, int count )
+{
+	struct ChangedValue_t
+	{
+		ConVarRefAbstract *m_pConVar;
+		CSplitScreenSlot m_Slot;
+		CVValue_t m_PrevValue;
+	};
+
+	CUtlVectorFixedGrowable<ChangedValue_t, 64> changed;
+	int parsed = 0;
+
+	for(int i = 0; i < count; i++)
+	{
+		ConVarRefAbstract *ref = values[i].m_pConVar;
+		CSplitScreenSlot slot = values[i].m_Slot;
+
+		if(!ref->m_ConVarData->Value( slot ))
+		{
+			parsed++;
+			continue;
+		}
+
+		CUtlString string( values[i].m_pszValue );
+		if(ref->GetType() != EConVarType_String)
+			string.Trim( "\t\n\v\f\r " );
+
+		CVValue_t new_value;
+		ref->TypeTraits()->Construct( &new_value );
+
+		if(ref->TypeTraits()->StringToValue( string.Get(), &new_value ))
+		{
+			if(ref->m_ConVarData->IsFlagSet( FCVAR_PERFORMING_CALLBACKS ))
+			{
+				ref->QueueSetValueInternal( slot, &new_value );
+			}
+			else
+			{
+				// A cvar set more than once in a batch changes once, from the value it had
+				// before the batch to the last one it was given
+				int existing = changed.InvalidIndex();
+				FOR_EACH_VEC( changed, j )
+				{
+					if(changed[j].m_pConVar->m_ConVarData == ref->m_ConVarData && SameSplitScreenSlot( changed[j].m_Slot, slot ))
+					{
+						existing = j;
+						break;
+					}
+				}
+
+				if(existing != changed.InvalidIndex())
+				{
+					CVValue_t prev;
+					if(ref->ApplyValueInternal( slot, &new_value, &prev ))
+						ref->TypeTraits()->Destruct( &prev );
+				}
+				else
+				{
+					ChangedValue_t *change = changed.AddToTailGetPtr();
+					if(ref->ApplyValueInternal( slot, &new_value, &change->m_PrevValue ))
+					{
+						change->m_pConVar = ref;
+						change->m_Slot = slot;
+					}
+					else
+					{
+						changed.RemoveMultipleFromTail( 1 );
+					}
+				}
+			}
+
+			parsed++;
+		}
+
+		ref->TypeTraits()->Destruct( &new_value );
+	}
+
+	// Set back to where it was before the batch, nothing changed after all
+	FOR_EACH_VEC_BACK( changed, i )
+	{
+		ConVarRefAbstract *ref = changed[i].m_pConVar;
+		if(ref->m_ConVarData->IsEqual( changed[i].m_Slot, &changed[i].m_PrevValue ))
+		{
+			ref->TypeTraits()->Destruct( &changed[i].m_PrevValue );
+			changed.Remove( i );
+		}
+	}
+
+	// Every value is in before the first callback runs, and the strings are formatted
+	// into the same two buffers throughout
+	CBufferStringArenaScope scope( ConVar_HasGlobalChangeCallbacks() );
+	CArenaBufferString prev_str, new_str;
+	FOR_EACH_VEC( changed, i )
+	{
+		ConVarRefAbstract *ref = changed[i].m_pConVar;
+		ref->CallChangeCallbacks( changed[i].m_Slot, ref->m_ConVarData->ValueOrDefault( changed[i].m_Slot ), &changed[i].m_PrevValue, new_str, prev_str );
+		ref->TypeTraits()->Destruct( &changed[i].m_PrevValue );
+	}
+
+	return parsed;
+}
+
 void ConVarRefAbstract::Revert( CSplitScreenSlot slot )
 {
 	CBufferString buf;
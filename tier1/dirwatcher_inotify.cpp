@@ -0,0 +1,266 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: inotify backend for CDirWatcher
+//
+//=============================================================================//
+
+#include "tier1/dirwatcher_inotify.h"
+#include "tier0/dbg.h"
+#include "tier0/strtools.h"
+#include "tier1/utlvector.h"
+
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// memdbgon must be the last include file in a .cpp file!!!
+#include "tier0/memdbgon.h"
+
+// what makes a file show up in the change list; directories are tracked separately
+static const uint32 k_unDirWatchINotifyMask = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+	IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK;
+
+// room for a few hundred events per read
+static const int k_cubDirWatchEventBuffer = 8 * 1024;
+
+// File times are stamped from the coarse clock, which runs up to a tick behind the
+// precise one; read with the precise one, a file changed right after a read could
+// look older than it and be missed by the next rescan
+static void GetDirWatchTime( struct timespec *pTime )
+{
+	clock_gettime( CLOCK_REALTIME_COARSE, pTime );
+}
+
+static CUtlString JoinPath( const CUtlString &sDir, const char *pchName )
+{
+	if ( sDir.IsEmpty() )
+		return CUtlString( pchName );
+
+	CUtlString sPath( sDir );
+	sPath += "/";
+	sPath += pchName;
+	return sPath;
+}
+
+CDirWatcherINotify::CDirWatcherINotify( ChangedFileFunc_t pfnChangedFile, void *pContext ) :
+	m_pfnChangedFile( pfnChangedFile ),
+	m_pContext( pContext ),
+	m_fdINotify( -1 ),
+	m_mapWatchDirs( DefLessFunc( int ) ),
+	m_cOverflows( 0 ),
+	m_pEventBuffer( NULL )
+{
+	m_LastReadTime.tv_sec = 0;
+	m_LastReadTime.tv_nsec = 0;
+}
+
+CDirWatcherINotify::~CDirWatcherINotify()
+{
+	// closing the descriptor drops all of its watches
+	if ( m_fdINotify >= 0 )
+		close( m_fdINotify );
+
+	free( m_pEventBuffer );
+}
+
+bool CDirWatcherINotify::BInit( const char *pchDir )
+{
+	Assert( m_fdINotify < 0 );
+
+	m_fdINotify = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+	if ( m_fdINotify < 0 )
+	{
+		AssertMsg1( false, "inotify_init1 failed (%d)", errno );
+		return false;
+	}
+
+	m_pEventBuffer = malloc( k_cubDirWatchEventBuffer );
+	m_BaseDir = pchDir;
+	GetDirWatchTime( &m_LastReadTime );
+
+	AddWatchRecursive( CUtlString( "" ), NULL );
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: watches sRelDir and every directory below it. Files newer than
+//			pModifiedSince are reported, pass NULL to report nothing
+//-----------------------------------------------------------------------------
+void CDirWatcherINotify::AddWatchRecursive( const CUtlString &sRelDir, const struct timespec *pModifiedSince )
+{
+	CUtlString sFullPath = sRelDir.IsEmpty() ? m_BaseDir : JoinPath( m_BaseDir, sRelDir );
+
+	// watching a directory twice hands back the same descriptor, so rescans can come through here too
+	int wd = inotify_add_watch( m_fdINotify, sFullPath.String(), k_unDirWatchINotifyMask );
+	if ( wd < 0 )
+	{
+		// ENOSPC means fs.inotify.max_user_watches has been hit
+		AssertMsg2( errno == ENOENT || errno == EACCES || errno == ENOTDIR, "inotify_add_watch failed on %s (%d)", sFullPath.String(), errno );
+		return;
+	}
+
+	m_mapWatchDirs.InsertOrReplace( wd, sRelDir );
+
+	DIR *dir = opendir( sFullPath.String() );
+	if ( !dir )
+		return;
+
+	struct dirent *pDirent;
+	while ( ( pDirent = readdir( dir ) ) != NULL )
+	{
+		if ( !V_strcmp( pDirent->d_name, "." ) || !V_strcmp( pDirent->d_name, ".." ) )
+			continue;
+
+		CUtlString sRelPath = JoinPath( sRelDir, pDirent->d_name );
+		CUtlString sFullChild = JoinPath( m_BaseDir, sRelPath );
+
+		struct stat st;
+		if ( lstat( sFullChild.String(), &st ) != 0 )
+			continue;
+
+		if ( S_ISDIR( st.st_mode ) )
+		{
+			AddWatchRecursive( sRelPath, pModifiedSince );
+		}
+		else if ( pModifiedSince &&
+			( st.st_mtim.tv_sec > pModifiedSince->tv_sec ||
+			( st.st_mtim.tv_sec == pModifiedSince->tv_sec && st.st_mtim.tv_nsec >= pModifiedSince->tv_nsec ) ) )
+		{
+			m_pfnChangedFile( sRelPath.String(), m_pContext );
+		}
+	}
+
+	closedir( dir );
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: stops watching sRelDir and every directory below it, for a directory
+//			moved out of the tree
+//-----------------------------------------------------------------------------
+void CDirWatcherINotify::RemoveWatchRecursive( const CUtlString &sRelDir )
+{
+	CUtlString sPrefix = JoinPath( sRelDir, "" );
+
+	CUtlVector< int > vecRemove;
+	FOR_EACH_MAP_FAST( m_mapWatchDirs, iWatch )
+	{
+		const CUtlString &sDir = m_mapWatchDirs[iWatch];
+		if ( !V_strcmp( sDir.String(), sRelDir.String() ) || !V_strncmp( sDir.String(), sPrefix.String(), sPrefix.Length() ) )
+			vecRemove.AddToTail( iWatch );
+	}
+
+	// the IN_IGNORED these give finds the watch gone already
+	FOR_EACH_VEC( vecRemove, i )
+	{
+		inotify_rm_watch( m_fdINotify, m_mapWatchDirs.Key( vecRemove[i] ) );
+		m_mapWatchDirs.RemoveAt( vecRemove[i] );
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: drains the inotify queue into the change list
+//-----------------------------------------------------------------------------
+void CDirWatcherINotify::ReadEvents()
+{
+	if ( m_fdINotify < 0 )
+		return;
+
+	// anything that changes from here on will either be read below or picked up by the next call
+	struct timespec readTime;
+	GetDirWatchTime( &readTime );
+
+	// directories moved from somewhere watched, by cookie, until the IN_MOVED_TO that
+	// pairs with them; the kernel queues both halves of a rename together
+	struct MovedDir_t
+	{
+		uint32 m_nCookie;
+		CUtlString m_sRelDir;
+	};
+	CUtlVector< MovedDir_t > vecMovedDirs;
+
+	bool bOverflowed = false;
+	for ( ;; )
+	{
+		ssize_t cubRead = read( m_fdINotify, m_pEventBuffer, k_cubDirWatchEventBuffer );
+		if ( cubRead < 0 && errno == EINTR )
+			continue;
+		if ( cubRead <= 0 )
+			break;	// EAGAIN, queue is empty
+
+		for ( ssize_t iOffset = 0; iOffset < cubRead; )
+		{
+			const struct inotify_event *pEvent = (const struct inotify_event *)( (const uint8 *)m_pEventBuffer + iOffset );
+			iOffset += sizeof( struct inotify_event ) + pEvent->len;
+
+			if ( pEvent->mask & IN_Q_OVERFLOW )
+			{
+				// events were dropped, all overflows in this batch share one rescan
+				bOverflowed = true;
+				continue;
+			}
+
+			int iWatch = m_mapWatchDirs.Find( pEvent->wd );
+			if ( !m_mapWatchDirs.IsValidIndex( iWatch ) )
+				continue;
+
+			if ( pEvent->mask & IN_IGNORED )
+			{
+				// watch is gone (directory deleted or moved away)
+				m_mapWatchDirs.RemoveAt( iWatch );
+				continue;
+			}
+
+			// a moved directory keeps its watch descriptor, IN_MOVED_TO in its new parent
+			// gives it its new name and a move out of the tree is seen from IN_MOVED_FROM
+			if ( pEvent->mask & ( IN_DELETE_SELF | IN_MOVE_SELF ) )
+				continue;
+
+			if ( !pEvent->len )
+				continue;
+
+			CUtlString sRelPath = JoinPath( m_mapWatchDirs[iWatch], pEvent->name );
+
+			if ( pEvent->mask & IN_ISDIR )
+			{
+				if ( pEvent->mask & IN_MOVED_FROM )
+				{
+					MovedDir_t movedDir = { pEvent->cookie, sRelPath };
+					vecMovedDirs.AddToTail( movedDir );
+				}
+
+				// files can land in a new directory before we get a watch on it, so report everything in there
+				if ( pEvent->mask & ( IN_CREATE | IN_MOVED_TO ) )
+				{
+					FOR_EACH_VEC_BACK( vecMovedDirs, i )
+					{
+						if ( vecMovedDirs[i].m_nCookie == pEvent->cookie )
+							vecMovedDirs.Remove( i );
+					}
+
+					static const struct timespec s_AllFiles = { 0, 0 };
+					AddWatchRecursive( sRelPath, &s_AllFiles );
+				}
+				continue;
+			}
+
+			m_pfnChangedFile( sRelPath.String(), m_pContext );
+		}
+	}
+
+	// moved somewhere that isn't watched
+	FOR_EACH_VEC( vecMovedDirs, i )
+	{
+		RemoveWatchRecursive( vecMovedDirs[i].m_sRelDir );
+	}
+
+	if ( bOverflowed )
+	{
+		m_cOverflows++;
+		AddWatchRecursive( CUtlString( "" ), &m_LastReadTime );
+	}
+
+	m_LastReadTime = readTime;
+}
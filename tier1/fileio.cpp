@@ -143,6 +143,7 @@ static int FileSelect( const char *name, const char *mask );
 #endif 
 
 #include "tier1/fileio.h"
+#include "tier1/fileio_uring.h"
 #include "tier0/utlbuffer.h"
 #include "tier0/strtools.h"
 #include <errno.h>
@@ -152,6 +153,10 @@ static int FileSelect( const char *name, const char *mask );
 #include "winlite.h"
 #endif
 
+#if defined( _LINUX )
+#include "tier1/dirwatcher_inotify.h"
+#endif
+
 #if defined( ASYNC_FILEIO )
 #ifdef _WIN32
 #include "winlite.h"
@@ -729,7 +734,7 @@ bool CDirIterator::BCurrentIsMarkedForArchive() const
 //-----------------------------------------------------------------------------
 CFileWriter::CFileWriter( bool bAsync ) 
 { 
-#ifdef ASYNC_FILEIO
+#if defined( ASYNC_FILEIO ) || defined( IOURING_FILEIO )
     m_bDefaultAsync = bAsync;
 #else
     m_bDefaultAsync = false;
@@ -740,6 +745,10 @@ CFileWriter::CFileWriter( bool bAsync )
     m_cubOutstanding = 0;
     m_cubWritten = 0;
     m_unThreadID = 0;
+#ifdef _LINUX
+	m_pURing = NULL;
+#endif
+	m_cubMaxInFlight = 10*k_nMegabyte;
 }
 
 
@@ -866,6 +875,18 @@ bool CFileWriter::BSetFile( const char *pchFile, bool bAllowOpenExisting )
         off_t offset = lseek( (intptr_t)m_hFileDest, 0, SEEK_END );
         m_cubWritten = offset;
     }
+
+#ifdef IOURING_FILEIO
+    if ( m_bAsync && m_hFileDest != INVALID_HANDLE_VALUE )
+    {
+        // no ring (old kernel, seccomp, ...) means plain blocking writes
+        m_pURing = CFileWriterURing::Create( (intptr_t)m_hFileDest, m_cubMaxInFlight );
+        if ( !m_pURing )
+            m_bAsync = false;
+    }
+#else
+    m_bAsync = false;
+#endif
 #else
 #error
 #endif
@@ -963,6 +984,13 @@ bool CFileWriter::Write( const void *pvData, uint32 cubData )
     return false;
 #else
     BOOL bRet = 0;
+#ifdef IOURING_FILEIO
+    if ( m_pURing )
+    {
+        // assigns the file offset and advances m_cubWritten under the ring lock
+        return m_pURing->Write( pvData, cubData, &m_cubWritten );
+    }
+#endif
 #ifdef ASYNC_FILEIO
     if ( m_bAsync )
     {
@@ -973,7 +1001,7 @@ bool CFileWriter::Write( const void *pvData, uint32 cubData )
 		}
 
 		// make sure we don't have too much data outstanding
-		while ( m_cubOutstanding > (10*k_nMegabyte) )
+		while ( m_cubOutstanding > m_cubMaxInFlight )
 		{
 			::SleepEx( 10, TRUE );
 		}
@@ -1057,6 +1085,69 @@ bool CFileWriter::Write( const void *pvData, uint32 cubData )
 #endif // _PS3
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: writes a buffer the caller gives up, without copying it when the
+//			backend can write straight out of it
+//-----------------------------------------------------------------------------
+bool CFileWriter::WriteOwned( void *pvData, uint32 cubData, FileWriterReleaseFunc_t pfnRelease, void *pContext )
+{
+#ifdef IOURING_FILEIO
+    if ( m_pURing )
+        return m_pURing->WriteOwned( pvData, cubData, &m_cubWritten, pfnRelease, pContext );
+#endif
+
+    bool bRet = Write( pvData, cubData );
+
+    if ( pfnRelease )
+        pfnRelease( pvData, pContext );
+    else
+        FreePv( pvData );
+
+    return bRet;
+}
+
+
+//-----------------------------------------------------------------------------
+// Purpose: waits for outstanding writes and forces the file data to disk
+//-----------------------------------------------------------------------------
+bool CFileWriter::SyncData()
+{
+    if ( m_hFileDest == INVALID_HANDLE_VALUE )
+        return false;
+
+#ifdef IOURING_FILEIO
+    if ( m_pURing )
+        return m_pURing->SyncData();
+#endif
+
+    Flush();
+
+#ifdef _WIN32
+    return ::FlushFileBuffers( m_hFileDest ) != 0;
+#elif defined( _LINUX )
+    return fdatasync( (intptr_t)m_hFileDest ) == 0;
+#elif defined( POSIX )
+    return fsync( (intptr_t)m_hFileDest ) == 0;
+#else
+    return true;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// Purpose: sets how much written data may be queued before writers wait
+//-----------------------------------------------------------------------------
+void CFileWriter::SetMaxBytesInFlight( uint32 cubMaxInFlight )
+{
+    m_cubMaxInFlight = cubMaxInFlight;
+
+#ifdef IOURING_FILEIO
+    if ( m_pURing )
+        m_pURing->SetMaxBytesInFlight( cubMaxInFlight );
+#endif
+}
+
+
 //-----------------------------------------------------------------------------
 // Purpose: Convenient printf with no dynamic memory allocation
 //-----------------------------------------------------------------------------
@@ -1092,6 +1183,15 @@ void CFileWriter::Flush()
     FlushFileBuffers( m_hFileDest );
 #endif
 
+#ifdef IOURING_FILEIO
+    // completions are reaped by whoever holds the ring lock, so any thread can wait here
+    if ( m_pURing )
+    {
+        m_pURing->Flush();
+        return;
+    }
+#endif
+
     if ( m_unThreadID == ThreadGetCurrentId() )
 	{
 		// wait for all writes to be complete
@@ -1129,6 +1229,11 @@ void CFileWriter::Close()
     {
 		Flush();
 
+#ifdef IOURING_FILEIO
+		delete m_pURing;
+		m_pURing = NULL;
+#endif
+
 		// temp handle to avoid double close in threaded environment
 		HANDLE hFileDest = m_hFileDest;
        	m_hFileDest = INVALID_HANDLE_VALUE; 
@@ -1198,6 +1303,32 @@ struct DirWatcherOverlapped : public OVERLAPPED
 // a buffer full of file names
 static const int k_cubDirWatchBufferSize = 8 * 1024;
 
+#ifdef _LINUX
+//-----------------------------------------------------------------------------
+// Purpose: hands what the inotify backend finds to the change list, m_pOverlapped
+//			holds the backend
+//-----------------------------------------------------------------------------
+class CDirWatcherFriend
+{
+public:
+	static void ChangedFile( const char *pchRelPath, void *pContext )
+	{
+		( (CDirWatcher *)pContext )->AddFileToChangeList( pchRelPath );
+	}
+
+	static CDirWatcherINotify *GetINotify( CDirWatcher *pDirWatch )
+	{
+		return (CDirWatcherINotify *)pDirWatch->m_pOverlapped;
+	}
+
+	static void Shutdown( CDirWatcher *pDirWatch )
+	{
+		delete GetINotify( pDirWatch );
+		pDirWatch->m_pOverlapped = NULL;
+	}
+};
+#endif
+
 
 //-----------------------------------------------------------------------------
 // Purpose: directory watching
@@ -1242,6 +1373,8 @@ CDirWatcher::~CDirWatcher()
 		FSEventStreamRelease( (FSEventStreamRef)m_WatcherStream );		
 		m_WatcherStream = 0;
 	}
+#elif defined(_LINUX)
+	CDirWatcherFriend::Shutdown( this );
 #endif
 	if ( m_pFileInfo )
 	{
@@ -1372,7 +1505,6 @@ static void fsevents_callback( ConstFSEventStreamRef streamRef, void *clientCall
 
 
 
-
 #endif
 
 //-----------------------------------------------------------------------------
@@ -1429,6 +1561,22 @@ void CDirWatcher::SetDirToWatch( const char *pchDir )
 	gettimeofday( &tv, NULL );
 	TIMEVAL_TO_TIMESPEC( &tv, &m_modTime );
 		
+#elif defined(_LINUX)
+	// only one directory at a time, drop whatever we were watching before
+	CDirWatcherFriend::Shutdown( this );
+
+	char szFullPath[MAX_PATH];
+	Q_MakeAbsolutePath( szFullPath, sizeof(szFullPath), strPath.GetUTF8Path() );
+	Q_StripTrailingSlash( szFullPath );
+
+	CDirWatcherINotify *pINotify = new CDirWatcherINotify( &CDirWatcherFriend::ChangedFile, this );
+	if ( !pINotify->BInit( szFullPath ) )
+	{
+		delete pINotify;
+		return;
+	}
+
+	m_pOverlapped = pINotify;
 #else
 	Assert( !"Impl me" );
 #endif
@@ -1476,6 +1624,10 @@ bool CDirWatcher::GetChangedFile( CUtlString *psFile )
 	// this will trigger any pending directory reads
 	// this does get hit other places in the code; so the callback can happen at any time
 	::SleepEx( 0, TRUE );
+#elif defined(_LINUX)
+	// pull in whatever inotify has queued up since the last call
+	if ( m_pOverlapped )
+		CDirWatcherFriend::GetINotify( this )->ReadEvents();
 #endif
 
 	if ( !m_listChangedFiles.Count() )
@@ -0,0 +1,683 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: io_uring write backend for CFileWriter
+//
+//=============================================================================//
+
+#include "tier1/fileio_uring.h"
+
+#ifdef IOURING_FILEIO
+#include "tier0/dbg.h"
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// memdbgon must be the last include file in a .cpp file!!!
+#include "tier0/memdbgon.h"
+
+class CFileWriterURingAutoLock
+{
+public:
+	CFileWriterURingAutoLock( pthread_mutex_t *pMutex ) : m_pMutex( pMutex ) { pthread_mutex_lock( m_pMutex ); }
+	~CFileWriterURingAutoLock() { pthread_mutex_unlock( m_pMutex ); }
+private:
+	pthread_mutex_t *m_pMutex;
+};
+
+static int sys_io_uring_setup( unsigned entries, io_uring_params *pParams )
+{
+	return (int)syscall( __NR_io_uring_setup, entries, pParams );
+}
+
+static int sys_io_uring_enter( int fd, unsigned toSubmit, unsigned minComplete, unsigned flags )
+{
+	return (int)syscall( __NR_io_uring_enter, fd, toSubmit, minComplete, flags, NULL, 0 );
+}
+
+static int sys_io_uring_register( int fd, unsigned opcode, const void *pArg, unsigned nArgs )
+{
+	return (int)syscall( __NR_io_uring_register, fd, opcode, pArg, nArgs );
+}
+
+CFileWriterURing::CFileWriterURing( int fd, uint32 cubMaxInFlight )
+{
+	m_fd = fd;
+	m_fdRing = -1;
+	m_pSQRing = MAP_FAILED;
+	m_pCQRing = MAP_FAILED;
+	m_cubSQRing = 0;
+	m_cubCQRing = 0;
+	m_pSQEs = (io_uring_sqe *)MAP_FAILED;
+	m_cubSQEs = 0;
+	m_cUnsubmitted = 0;
+	m_cInFlight = 0;
+	m_cubInFlight = 0;
+	m_cubMaxInFlight = cubMaxInFlight;
+	m_cubMaxPerSubmit = 0;
+	m_bError = false;
+	m_cCompleted = 0;
+	m_nNextSeq = 1;
+	m_pubStaging = NULL;
+	m_iCurStaging = -1;
+	m_cubCurStaging = 0;
+	m_ulCurStagingOffset = 0;
+	memset( m_rgbStagingBusy, 0, sizeof( m_rgbStagingBusy ) );
+
+	m_pFreeRequests = NULL;
+	for ( int i = k_cFileWriterURingEntries - 1; i >= 0; i-- )
+	{
+		m_Requests[i].m_pNextFree = m_pFreeRequests;
+		m_pFreeRequests = &m_Requests[i];
+	}
+
+	pthread_mutex_init( &m_Mutex, NULL );
+	pthread_cond_init( &m_ReapedCond, NULL );
+	m_bWaiting = false;
+}
+
+CFileWriterURing *CFileWriterURing::Create( int fd, uint32 cubMaxInFlight, bool bRegisterBuffers )
+{
+	CFileWriterURing *pURing = new CFileWriterURing( fd, cubMaxInFlight );
+	if ( !pURing->BInit( bRegisterBuffers ) )
+	{
+		delete pURing;
+		return NULL;
+	}
+
+	return pURing;
+}
+
+bool CFileWriterURing::BInit( bool bRegisterBuffers )
+{
+	io_uring_params params;
+	memset( &params, 0, sizeof( params ) );
+
+	m_fdRing = sys_io_uring_setup( k_cFileWriterURingEntries, &params );
+	if ( m_fdRing < 0 )
+		return false;
+
+	m_cubSQRing = params.sq_off.array + params.sq_entries * sizeof( unsigned );
+	m_cubCQRing = params.cq_off.cqes + params.cq_entries * sizeof( io_uring_cqe );
+
+	bool bSingleMmap = ( params.features & IORING_FEAT_SINGLE_MMAP ) != 0;
+	if ( bSingleMmap )
+	{
+		m_cubSQRing = m_cubCQRing = MAX( m_cubSQRing, m_cubCQRing );
+	}
+
+	m_pSQRing = mmap( NULL, m_cubSQRing, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fdRing, IORING_OFF_SQ_RING );
+	if ( m_pSQRing == MAP_FAILED )
+		return false;
+
+	m_pCQRing = bSingleMmap ? m_pSQRing : mmap( NULL, m_cubCQRing, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fdRing, IORING_OFF_CQ_RING );
+	if ( m_pCQRing == MAP_FAILED )
+		return false;
+
+	m_cubSQEs = params.sq_entries * sizeof( io_uring_sqe );
+	m_pSQEs = (io_uring_sqe *)mmap( NULL, m_cubSQEs, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fdRing, IORING_OFF_SQES );
+	if ( m_pSQEs == MAP_FAILED )
+		return false;
+
+	uint8 *pubSQ = (uint8 *)m_pSQRing;
+	m_pSQHead = (unsigned *)( pubSQ + params.sq_off.head );
+	m_pSQTail = (unsigned *)( pubSQ + params.sq_off.tail );
+	m_pSQArray = (unsigned *)( pubSQ + params.sq_off.array );
+	m_unSQMask = *(unsigned *)( pubSQ + params.sq_off.ring_mask );
+
+	uint8 *pubCQ = (uint8 *)m_pCQRing;
+	m_pCQHead = (unsigned *)( pubCQ + params.cq_off.head );
+	m_pCQTail = (unsigned *)( pubCQ + params.cq_off.tail );
+	m_unCQMask = *(unsigned *)( pubCQ + params.cq_off.ring_mask );
+	m_pCQEs = (io_uring_cqe *)( pubCQ + params.cq_off.cqes );
+
+	if ( !bRegisterBuffers )
+		return true;
+
+	// staging memory is registered once, so fixed writes skip the per-call page pinning
+	m_pubStaging = (uint8 *)mmap( NULL, k_cFileWriterStagingBuffers * k_cubFileWriterStagingBuffer, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+	if ( m_pubStaging == MAP_FAILED )
+	{
+		m_pubStaging = NULL;
+		return false;
+	}
+
+	struct iovec rgIOVec[k_cFileWriterStagingBuffers];
+	for ( int i = 0; i < k_cFileWriterStagingBuffers; i++ )
+	{
+		rgIOVec[i].iov_base = m_pubStaging + i * k_cubFileWriterStagingBuffer;
+		rgIOVec[i].iov_len = k_cubFileWriterStagingBuffer;
+	}
+
+	// registration can fail with a low RLIMIT_MEMLOCK, the ring itself is still useful then
+	if ( sys_io_uring_register( m_fdRing, IORING_REGISTER_BUFFERS, rgIOVec, k_cFileWriterStagingBuffers ) < 0 )
+	{
+		munmap( m_pubStaging, k_cFileWriterStagingBuffers * k_cubFileWriterStagingBuffer );
+		m_pubStaging = NULL;
+	}
+
+	return true;
+}
+
+CFileWriterURing::~CFileWriterURing()
+{
+	if ( m_fdRing >= 0 )
+	{
+		Flush();
+	}
+
+	if ( m_pubStaging )
+		munmap( m_pubStaging, k_cFileWriterStagingBuffers * k_cubFileWriterStagingBuffer );
+	if ( m_pSQEs != MAP_FAILED )
+		munmap( m_pSQEs, m_cubSQEs );
+	if ( m_pCQRing != MAP_FAILED && m_pCQRing != m_pSQRing )
+		munmap( m_pCQRing, m_cubCQRing );
+	if ( m_pSQRing != MAP_FAILED )
+		munmap( m_pSQRing, m_cubSQRing );
+	if ( m_fdRing >= 0 )
+		close( m_fdRing );
+
+	pthread_cond_destroy( &m_ReapedCond );
+	pthread_mutex_destroy( &m_Mutex );
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: grabs a request slot, waiting on completions if all are in use
+//-----------------------------------------------------------------------------
+FileWriterURingRequest_t *CFileWriterURing::AllocRequest()
+{
+	while ( !m_pFreeRequests )
+	{
+		if ( !WaitForCompletion() )
+			return NULL;
+	}
+
+	FileWriterURingRequest_t *pRequest = m_pFreeRequests;
+	m_pFreeRequests = pRequest->m_pNextFree;
+	memset( pRequest, 0, sizeof( *pRequest ) );
+	pRequest->m_iStagingBuffer = -1;
+	return pRequest;
+}
+
+void CFileWriterURing::FreeRequest( FileWriterURingRequest_t *pRequest )
+{
+	pRequest->m_pNextFree = m_pFreeRequests;
+	m_pFreeRequests = pRequest;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: puts a request on the submission ring, it goes to the kernel on the next enter
+//-----------------------------------------------------------------------------
+void CFileWriterURing::QueueRequest( FileWriterURingRequest_t *pRequest )
+{
+	// request slots == ring entries and every request holds one slot, so the SQ can't overflow
+	unsigned unTail = *m_pSQTail;
+	unsigned unIndex = unTail & m_unSQMask;
+	io_uring_sqe *pSQE = &m_pSQEs[unIndex];
+
+	memset( pSQE, 0, sizeof( *pSQE ) );
+	pSQE->fd = m_fd;
+	pSQE->user_data = (uint64)(uintptr_t)pRequest;
+
+	// the rest of a short write keeps the place of the write
+	if ( !pRequest->m_nSeq )
+		pRequest->m_nSeq = m_nNextSeq++;
+
+	if ( pRequest->m_bSync )
+	{
+		pSQE->opcode = IORING_OP_FSYNC;
+		pSQE->fsync_flags = IORING_FSYNC_DATASYNC;
+	}
+	else
+	{
+		uint32 cubLeft = pRequest->m_cubData - pRequest->m_cubDone;
+		if ( m_cubMaxPerSubmit && cubLeft > m_cubMaxPerSubmit )
+			cubLeft = m_cubMaxPerSubmit;
+
+		pSQE->opcode = ( pRequest->m_iStagingBuffer >= 0 ) ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+		pSQE->addr = (uint64)(uintptr_t)( pRequest->m_pubData + pRequest->m_cubDone );
+		pSQE->len = cubLeft;
+		pSQE->off = pRequest->m_ulOffset + pRequest->m_cubDone;
+		if ( pRequest->m_iStagingBuffer >= 0 )
+			pSQE->buf_index = (uint16)pRequest->m_iStagingBuffer;
+	}
+
+	m_pSQArray[unIndex] = unIndex;
+	__atomic_store_n( m_pSQTail, unTail + 1, __ATOMIC_RELEASE );
+
+	m_cUnsubmitted++;
+	m_cInFlight++;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: queues the current staging buffer if it holds anything
+//-----------------------------------------------------------------------------
+void CFileWriterURing::QueueStaging()
+{
+	if ( m_iCurStaging < 0 || !m_cubCurStaging )
+		return;
+
+	FileWriterURingRequest_t *pRequest = AllocRequest();
+	if ( !pRequest )
+		return;
+
+	// another thread may have queued it while this one waited for the slot
+	if ( m_iCurStaging < 0 || !m_cubCurStaging )
+	{
+		FreeRequest( pRequest );
+		return;
+	}
+
+	pRequest->m_pubData = m_pubStaging + m_iCurStaging * k_cubFileWriterStagingBuffer;
+	pRequest->m_cubData = m_cubCurStaging;
+	pRequest->m_ulOffset = m_ulCurStagingOffset;
+	pRequest->m_iStagingBuffer = m_iCurStaging;
+
+	m_cubInFlight += m_cubCurStaging;
+	m_iCurStaging = -1;
+	m_cubCurStaging = 0;
+
+	QueueRequest( pRequest );
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: hands everything queued to the kernel without waiting for any of it
+//-----------------------------------------------------------------------------
+bool CFileWriterURing::Submit()
+{
+	while ( m_cUnsubmitted )
+	{
+		int nRet = sys_io_uring_enter( m_fdRing, m_cUnsubmitted, 0, 0 );
+		if ( nRet < 0 )
+		{
+			if ( errno == EINTR )
+				continue;
+
+			// out of kernel resources for now, the entries stay queued for the next enter
+			if ( errno == EAGAIN || errno == EBUSY )
+				return true;
+
+			m_bError = true;
+			return false;
+		}
+
+		if ( !nRet )
+			break;
+
+		m_cUnsubmitted -= MIN( (uint32)nRet, m_cUnsubmitted );
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: returns once at least one request has completed (or nothing is in
+//			flight). Called with the lock held; the thread that sleeps in the
+//			kernel drops it while it does, so the others can keep queueing
+//-----------------------------------------------------------------------------
+bool CFileWriterURing::WaitForCompletion()
+{
+	uint32 cCompleted = m_cCompleted;
+
+	for ( ;; )
+	{
+		if ( !m_bWaiting )
+			ReapCompletions();
+
+		// short writes reaped here went back on the ring, they go to the kernel now
+		if ( m_cCompleted != cCompleted || !m_cInFlight )
+			return Submit();
+
+		if ( m_bWaiting )
+		{
+			// someone else is in the kernel already, it reaps and wakes everyone
+			pthread_cond_wait( &m_ReapedCond, &m_Mutex );
+			continue;
+		}
+
+		// whatever is still unsubmitted goes in with the wait
+		uint32 cToSubmit = m_cUnsubmitted;
+		m_cUnsubmitted = 0;
+		m_bWaiting = true;
+
+		pthread_mutex_unlock( &m_Mutex );
+		int nRet = sys_io_uring_enter( m_fdRing, cToSubmit, 1, IORING_ENTER_GETEVENTS );
+		int nErrno = errno;
+		pthread_mutex_lock( &m_Mutex );
+
+		m_bWaiting = false;
+
+		bool bFailed = false;
+		if ( nRet < 0 )
+		{
+			m_cUnsubmitted += cToSubmit;
+			if ( nErrno != EINTR && nErrno != EAGAIN && nErrno != EBUSY )
+			{
+				m_bError = true;
+				bFailed = true;
+			}
+		}
+		else
+		{
+			m_cUnsubmitted += cToSubmit - MIN( (uint32)nRet, cToSubmit );
+		}
+
+		ReapCompletions();
+		pthread_cond_broadcast( &m_ReapedCond );
+
+		if ( bFailed )
+			return false;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: takes what the kernel has posted; short writes go back on the ring
+//			for the rest, and are sent with the next submit like the requests that
+//			need another try
+//-----------------------------------------------------------------------------
+void CFileWriterURing::ReapCompletions()
+{
+	unsigned unHead = *m_pCQHead;
+	unsigned unTail = __atomic_load_n( m_pCQTail, __ATOMIC_ACQUIRE );
+
+	while ( unHead != unTail )
+	{
+		io_uring_cqe *pCQE = &m_pCQEs[unHead & m_unCQMask];
+		FileWriterURingRequest_t *pRequest = (FileWriterURingRequest_t *)(uintptr_t)pCQE->user_data;
+		int nResult = pCQE->res;
+
+		unHead++;
+		__atomic_store_n( m_pCQHead, unHead, __ATOMIC_RELEASE );
+
+		m_cInFlight--;
+
+		// Requests belong to the thread that submitted them and are canceled when it exits,
+		// which any writer may do; whoever reaps one sends it again
+		if ( nResult == -ECANCELED || nResult == -EINTR || nResult == -EAGAIN )
+		{
+			QueueRequest( pRequest );
+			continue;
+		}
+
+		if ( nResult < 0 )
+		{
+			AssertMsg1( false, "CFileWriter io_uring request failed (%d)", nResult );
+			m_bError = true;
+		}
+		else if ( !pRequest->m_bSync )
+		{
+			pRequest->m_cubDone += nResult;
+			if ( pRequest->m_cubDone < pRequest->m_cubData )
+			{
+				if ( nResult > 0 )
+				{
+					// short write, send the rest
+					QueueRequest( pRequest );
+					continue;
+				}
+
+				// nothing written and nothing to say why, asking again would only spin
+				AssertMsg2( false, "CFileWriter io_uring write stopped at %u of %u bytes", pRequest->m_cubDone, pRequest->m_cubData );
+				m_bError = true;
+			}
+		}
+
+		CompleteRequest( pRequest );
+	}
+}
+
+void CFileWriterURing::CompleteRequest( FileWriterURingRequest_t *pRequest )
+{
+	if ( pRequest->m_bSync )
+	{
+		*(bool *)pRequest->m_pContext = true;
+	}
+	else
+	{
+		m_cubInFlight -= pRequest->m_cubData;
+
+		if ( pRequest->m_iStagingBuffer >= 0 )
+		{
+			m_rgbStagingBusy[pRequest->m_iStagingBuffer] = false;
+		}
+		else if ( pRequest->m_pfnRelease )
+		{
+			pRequest->m_pfnRelease( pRequest->m_pubData, pRequest->m_pContext );
+		}
+		else
+		{
+			free( pRequest->m_pubData );
+		}
+	}
+
+	m_cCompleted++;
+	pRequest->m_nSeq = 0;
+	FreeRequest( pRequest );
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: waits until cubIncoming more bytes fit under the in-flight limit
+//-----------------------------------------------------------------------------
+bool CFileWriterURing::WaitForInFlight( uint32 cubIncoming )
+{
+	while ( m_cInFlight && m_cubInFlight + cubIncoming > m_cubMaxInFlight )
+	{
+		if ( !WaitForCompletion() )
+			return false;
+	}
+
+	return true;
+}
+
+bool CFileWriterURing::Write( const void *pvData, uint32 cubData, uint64 *pcubWritten )
+{
+	CFileWriterURingAutoLock lock( &m_Mutex );
+
+	if ( m_bError )
+		return false;
+
+	const uint8 *pubData = (const uint8 *)pvData;
+	uint64 ulOffset = *pcubWritten;
+	*pcubWritten += cubData;
+
+	if ( !m_pubStaging || cubData >= k_cubFileWriterStagingBuffer )
+	{
+		// nothing to stage into (or not worth it), hand over a private copy
+		void *pvCopy = malloc( cubData );
+		memcpy( pvCopy, pubData, cubData );
+
+		QueueStaging();
+
+		FileWriterURingRequest_t *pRequest = NULL;
+		if ( WaitForInFlight( cubData ) )
+			pRequest = AllocRequest();
+
+		if ( !pRequest )
+		{
+			free( pvCopy );
+			return false;
+		}
+
+		pRequest->m_pubData = (uint8 *)pvCopy;
+		pRequest->m_cubData = cubData;
+		pRequest->m_ulOffset = ulOffset;
+		m_cubInFlight += cubData;
+		QueueRequest( pRequest );
+		return Submit();
+	}
+
+	while ( cubData )
+	{
+		// a staging buffer holds one run of the file; other threads write while this
+		// one waits, so whatever they left in it may not end where this write goes on
+		if ( m_iCurStaging >= 0 && ( m_cubCurStaging == k_cubFileWriterStagingBuffer || m_ulCurStagingOffset + m_cubCurStaging != ulOffset ) )
+			QueueStaging();
+
+		if ( m_iCurStaging < 0 )
+		{
+			int iFree = -1;
+			for ( int i = 0; i < k_cFileWriterStagingBuffers; i++ )
+			{
+				if ( !m_rgbStagingBusy[i] )
+				{
+					iFree = i;
+					break;
+				}
+			}
+
+			if ( iFree < 0 )
+			{
+				// all of them are with the kernel, wait for one to come back
+				if ( !WaitForCompletion() || m_bError )
+					return false;
+				continue;
+			}
+
+			m_iCurStaging = iFree;
+			m_rgbStagingBusy[m_iCurStaging] = true;
+			m_cubCurStaging = 0;
+			m_ulCurStagingOffset = ulOffset;
+		}
+
+		uint32 cubCopy = MIN( cubData, k_cubFileWriterStagingBuffer - m_cubCurStaging );
+		memcpy( m_pubStaging + m_iCurStaging * k_cubFileWriterStagingBuffer + m_cubCurStaging, pubData, cubCopy );
+		m_cubCurStaging += cubCopy;
+		pubData += cubCopy;
+		ulOffset += cubCopy;
+		cubData -= cubCopy;
+
+		if ( m_cubCurStaging == k_cubFileWriterStagingBuffer )
+		{
+			if ( !WaitForInFlight( k_cubFileWriterStagingBuffer ) )
+				return false;
+
+			QueueStaging();
+			if ( !Submit() )
+				return false;
+		}
+	}
+
+	return !m_bError;
+}
+
+bool CFileWriterURing::WriteOwned( void *pvData, uint32 cubData, uint64 *pcubWritten, CFileWriter::FileWriterReleaseFunc_t pfnRelease, void *pContext )
+{
+	CFileWriterURingAutoLock lock( &m_Mutex );
+
+	FileWriterURingRequest_t *pRequest = NULL;
+	if ( !m_bError )
+	{
+		// whatever was staged before this buffer goes out in the same submission
+		QueueStaging();
+		if ( WaitForInFlight( cubData ) )
+			pRequest = AllocRequest();
+	}
+
+	if ( !pRequest )
+	{
+		if ( pfnRelease )
+			pfnRelease( pvData, pContext );
+		else
+			free( pvData );
+		return false;
+	}
+
+	// taken last, the waits above may have let other writers go first
+	pRequest->m_pubData = (uint8 *)pvData;
+	pRequest->m_cubData = cubData;
+	pRequest->m_ulOffset = *pcubWritten;
+	pRequest->m_pfnRelease = pfnRelease;
+	pRequest->m_pContext = pContext;
+
+	*pcubWritten += cubData;
+	m_cubInFlight += cubData;
+
+	QueueRequest( pRequest );
+	return Submit();
+}
+
+bool CFileWriterURing::FlushLocked()
+{
+	QueueStaging();
+
+	while ( m_cInFlight )
+	{
+		if ( !WaitForCompletion() )
+			return false;
+	}
+
+	return !m_bError;
+}
+
+bool CFileWriterURing::Flush()
+{
+	CFileWriterURingAutoLock lock( &m_Mutex );
+	return FlushLocked();
+}
+
+bool CFileWriterURing::SyncData()
+{
+	CFileWriterURingAutoLock lock( &m_Mutex );
+
+	QueueStaging();
+
+	// An IOSQE_IO_DRAIN fsync would only wait for what has been submitted so far, and the
+	// rest of a short write is submitted again later. So the writes before this one are
+	// waited for whole, then the fsync goes out on its own
+	uint64 nSeq = m_nNextSeq;
+	while ( BWritesQueuedBefore( nSeq ) )
+	{
+		if ( !WaitForCompletion() )
+			return false;
+	}
+
+	FileWriterURingRequest_t *pRequest = AllocRequest();
+	if ( !pRequest )
+		return false;
+
+	bool bSynced = false;
+	pRequest->m_bSync = true;
+	pRequest->m_pContext = &bSynced;
+	QueueRequest( pRequest );
+
+	while ( !bSynced )
+	{
+		if ( !WaitForCompletion() )
+			return false;
+	}
+
+	return !m_bError;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: whether any write queued before nSeq is still with the kernel
+//-----------------------------------------------------------------------------
+bool CFileWriterURing::BWritesQueuedBefore( uint64 nSeq ) const
+{
+	for ( int i = 0; i < k_cFileWriterURingEntries; i++ )
+	{
+		const FileWriterURingRequest_t &request = m_Requests[i];
+		if ( request.m_nSeq && request.m_nSeq < nSeq && !request.m_bSync )
+			return true;
+	}
+
+	return false;
+}
+
+void CFileWriterURing::SetMaxBytesInFlight( uint32 cubMaxInFlight )
+{
+	CFileWriterURingAutoLock lock( &m_Mutex );
+	m_cubMaxInFlight = cubMaxInFlight;
+}
+
+void CFileWriterURing::SetMaxBytesPerSubmit( uint32 cubMaxPerSubmit )
+{
+	CFileWriterURingAutoLock lock( &m_Mutex );
+	m_cubMaxPerSubmit = cubMaxPerSubmit;
+}
+#endif // IOURING_FILEIO
@@ -343,14 +343,73 @@ uint32 MurmurHash2( const void * key, int len, uint32 seed )
 	return h;
 }
 
-uint32 MurmurHash2LowerCase( char const *pString, int len, uint32 nSeed )
+// ASCII 'A'-'Z' -> 'a'-'z' on the four bytes of a word, the same fold TOLOWERU does on each
+static FORCEINLINE uint32 MurmurHashFoldCase32( uint32 w )
+{
+	uint32 nHeptets = w & 0x7F7F7F7F;
+	uint32 nIsGeA = nHeptets + ( 0x80 - 'A' ) * 0x01010101;
+	uint32 nIsGtZ = nHeptets + ( 0x80 - 'Z' - 1 ) * 0x01010101;
+	uint32 nUpper = nIsGeA & ~nIsGtZ & ~w & 0x80808080;
+	return w | ( nUpper >> 2 );
+}
+
+// Lowers each word as it's read rather than copying the string first. SIGNEDTAIL reads the
+// last 1-3 bytes as char the way CUtlStringToken::Hash does, MurmurHash2 reads them unsigned
+template < bool LOWERCASE, bool SIGNEDTAIL >
+static FORCEINLINE uint32 MurmurHash2Fused( char const *pString, int len, uint32 nSeed )
 {
-	char *p = ( char * ) stackalloc( len + 1 );
-	for( int i = 0; i < len ; i++ )
+	const uint32 m = 0x5bd1e995;
+	const int r = 24;
+
+	uint32 h = nSeed ^ len;
+
+	const unsigned char * data = (const unsigned char *)pString;
+
+	while(len >= 4)
+	{
+		uint32 k;
+		memcpy( &k, data, sizeof( k ) );
+		k = LittleDWord( k );
+		if ( LOWERCASE )
+			k = MurmurHashFoldCase32( k );
+
+		k *= m; 
+		k ^= k >> r; 
+		k *= m; 
+
+		h *= m; 
+		h ^= k;
+
+		data += 4;
+		len -= 4;
+	}
+
+	uint32 tail[3] = { 0, 0, 0 };
+	for ( int i = 0; i < len; i++ )
 	{
-		p[i] = TOLOWERU( pString[i] );
+		tail[i] = SIGNEDTAIL ? (uint32)(signed char)data[i] : (uint32)data[i];
+		if ( LOWERCASE )
+			tail[i] = TOLOWERU( tail[i] );
 	}
-	return MurmurHash2(p, len, nSeed ); 
+
+	switch(len)
+	{
+	case 3: h ^= tail[2] << 16;
+	case 2: h ^= tail[1] << 8;
+	case 1: h ^= tail[0];
+		h *= m;
+	};
+
+	h ^= h >> 13;
+	h *= m;
+	h ^= h >> 15;
+
+	return h;
+}
+
+uint32 MurmurHash2LowerCase( char const *pString, int len, uint32 nSeed )
+{
+	return MurmurHash2Fused< true, false >( pString, len, nSeed );
 }
 
 uint32 MurmurHash2LowerCase( char const *pString, uint32 nSeed )
@@ -358,6 +417,203 @@ uint32 MurmurHash2LowerCase( char const *pString, uint32 nSeed )
 	return MurmurHash2LowerCase( pString, (uint32)V_strlen(pString), nSeed );
 }
 
+uint32 MurmurHash2StringToken( char const *pString, int nLength, uint32 nSeed, bool bLowerCase )
+{
+	return bLowerCase ? MurmurHash2Fused< true, true >( pString, nLength, nSeed ) : MurmurHash2Fused< false, true >( pString, nLength, nSeed );
+}
+
+//-----------------------------------------------------------------------------
+// Murmur hash, lowercase, many strings at once
+//
+// Each AVX2 lane runs the hash of one string. A group of lanes reads its
+// strings 16 bytes at a time and transposes the rows so that every register
+// holds the same word of each string, then folds the case; a lane stops taking
+// words once its string runs out, takes its 1-3 byte tail as a word of its
+// own and joins the final mix with the rest. Four SSE2 lanes, with no 32-bit
+// multiply to use, came out slower than a call per string, so there are none.
+//-----------------------------------------------------------------------------
+#if !defined( PLATFORM_PPC ) && ( defined( _M_X64 ) || defined( _M_IX86 ) || defined( __x86_64__ ) || defined( __i386__ ) )
+#define MURMURHASH_SIMD 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#include "tier1/processor_detect.h"
+#else
+#define MURMURHASH_SIMD 0
+#endif
+
+static int s_nMurmurHashSIMDLevel = -1;
+
+static void MurmurHash2LowerCaseBatch_Scalar( const char *const *ppStrings, const int *pnLengths, int nCount, uint32 nSeed, uint32 *pHashes )
+{
+	for ( int i = 0; i < nCount; i++ )
+	{
+		pHashes[i] = MurmurHash2LowerCase( ppStrings[i], pnLengths ? pnLengths[i] : V_strlen( ppStrings[i] ), nSeed );
+	}
+}
+
+#if MURMURHASH_SIMD
+
+// gcc and clang need the AVX2 path enabled per function, MSVC lets the intrinsics through.
+// The row loads can read past the end of a string, never into the next page.
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define MURMURHASH_AVX2_TARGET __attribute__(( target( "avx2" ) ))
+#define MURMURHASH_NO_SANITIZE __attribute__(( no_sanitize_address ))
+#else
+#define MURMURHASH_AVX2_TARGET
+#define MURMURHASH_NO_SANITIZE
+#endif
+
+static ALIGN16 const uint8 s_MurmurHashZeroRow[16] ALIGN16_POST = {};
+
+// 16 bytes of 0xFF then 16 of 0, 16 - n in keeps the first n bytes of a row
+static const uint8 s_MurmurHashRowMasks[32] =
+{
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+// The 16 bytes of a string from nOffset on, zeroes past its end.
+// Lengths are all over the place, so there's no branching on them.
+static MURMURHASH_NO_SANITIZE FORCEINLINE __m128i MurmurHashLoadRow( const char *pString, int nLength, int nOffset )
+{
+	int nLeft = nLength - nOffset;
+	const char *p = nLeft > 0 ? pString + nOffset : ( const char * )s_MurmurHashZeroRow;
+
+	if ( nLeft >= 16 || ( ( uintp )p & 4095 ) <= 4096 - 16 )
+	{
+		__m128i mask = _mm_loadu_si128( ( const __m128i * )( s_MurmurHashRowMasks + 16 - clamp( nLeft, 0, 16 ) ) );
+		return _mm_and_si128( _mm_loadu_si128( ( const __m128i * )p ), mask );
+	}
+
+	ALIGN16 uint8 tail[16] ALIGN16_POST = {};
+	memcpy( tail, p, nLeft );
+	return _mm_load_si128( ( const __m128i * )tail );
+}
+
+// 'A'-'Z' moved to the bottom of the signed range, where a single compare finds them
+static MURMURHASH_AVX2_TARGET FORCEINLINE __m256i MurmurHashFoldCase_AVX2( __m256i v )
+{
+	__m256i upper = _mm256_cmpgt_epi8( _mm256_set1_epi8( ( char )( 0x80 + 26 ) ), _mm256_add_epi8( v, _mm256_set1_epi8( ( char )( 0x80 - 'A' ) ) ) );
+	return _mm256_or_si256( v, _mm256_and_si256( upper, _mm256_set1_epi8( 0x20 ) ) );
+}
+
+// Two groups of lanes go at once: each word's hash waits on the multiply of the one
+// before it, and the other group's words fill the wait
+#define MURMURHASH_GROUPS 2
+
+static MURMURHASH_AVX2_TARGET void MurmurHash2LowerCaseBatch_AVX2( const char *const *ppStrings, const int *pnLengths, int nCount, uint32 nSeed, uint32 *pHashes )
+{
+	const int nLanes = 8 * MURMURHASH_GROUPS;
+	const __m256i m = _mm256_set1_epi32( 0x5bd1e995 );
+
+	for ( ; nCount >= nLanes; nCount -= nLanes, ppStrings += nLanes, pHashes += nLanes )
+	{
+		int nLengths[nLanes];
+		int nMaxLength = 0;
+		for ( int i = 0; i < nLanes; i++ )
+		{
+			nLengths[i] = pnLengths ? pnLengths[i] : V_strlen( ppStrings[i] );
+			nMaxLength = MAX( nMaxLength, nLengths[i] );
+		}
+		if ( pnLengths )
+			pnLengths += nLanes;
+
+		__m256i blocks[MURMURHASH_GROUPS], hasTail[MURMURHASH_GROUPS], tail[MURMURHASH_GROUPS], h[MURMURHASH_GROUPS];
+		for ( int g = 0; g < MURMURHASH_GROUPS; g++ )
+		{
+			__m256i length = _mm256_loadu_si256( ( const __m256i * )( nLengths + 8 * g ) );
+			blocks[g] = _mm256_srli_epi32( length, 2 );
+			hasTail[g] = _mm256_xor_si256( _mm256_cmpeq_epi32( _mm256_and_si256( length, _mm256_set1_epi32( 3 ) ), _mm256_setzero_si256() ), _mm256_set1_epi32( -1 ) );
+			tail[g] = _mm256_setzero_si256();
+			h[g] = _mm256_xor_si256( _mm256_set1_epi32( nSeed ), length );
+		}
+
+		for ( int nOffset = 0; nOffset < nMaxLength; nOffset += 16 )
+		{
+			__m256i words[MURMURHASH_GROUPS][4];
+			for ( int g = 0; g < MURMURHASH_GROUPS; g++ )
+			{
+				// Strings 0-3 in the low halves, 4-7 in the high ones, so the transpose keeps the lanes in order
+				const char *const *ppRow = ppStrings + 8 * g;
+				const int *pnRowLength = nLengths + 8 * g;
+				__m256i r0 = _mm256_inserti128_si256( _mm256_castsi128_si256( MurmurHashLoadRow( ppRow[0], pnRowLength[0], nOffset ) ), MurmurHashLoadRow( ppRow[4], pnRowLength[4], nOffset ), 1 );
+				__m256i r1 = _mm256_inserti128_si256( _mm256_castsi128_si256( MurmurHashLoadRow( ppRow[1], pnRowLength[1], nOffset ) ), MurmurHashLoadRow( ppRow[5], pnRowLength[5], nOffset ), 1 );
+				__m256i r2 = _mm256_inserti128_si256( _mm256_castsi128_si256( MurmurHashLoadRow( ppRow[2], pnRowLength[2], nOffset ) ), MurmurHashLoadRow( ppRow[6], pnRowLength[6], nOffset ), 1 );
+				__m256i r3 = _mm256_inserti128_si256( _mm256_castsi128_si256( MurmurHashLoadRow( ppRow[3], pnRowLength[3], nOffset ) ), MurmurHashLoadRow( ppRow[7], pnRowLength[7], nOffset ), 1 );
+
+				__m256i t0 = _mm256_unpacklo_epi32( r0, r1 ), t1 = _mm256_unpacklo_epi32( r2, r3 );
+				__m256i t2 = _mm256_unpackhi_epi32( r0, r1 ), t3 = _mm256_unpackhi_epi32( r2, r3 );
+				words[g][0] = MurmurHashFoldCase_AVX2( _mm256_unpacklo_epi64( t0, t1 ) );
+				words[g][1] = MurmurHashFoldCase_AVX2( _mm256_unpackhi_epi64( t0, t1 ) );
+				words[g][2] = MurmurHashFoldCase_AVX2( _mm256_unpacklo_epi64( t2, t3 ) );
+				words[g][3] = MurmurHashFoldCase_AVX2( _mm256_unpackhi_epi64( t2, t3 ) );
+			}
+
+			int nSteps = MIN( 4, ( nMaxLength - nOffset + 3 ) / 4 );
+			for ( int j = 0; j < nSteps; j++ )
+			{
+				__m256i block = _mm256_set1_epi32( nOffset / 4 + j );
+				for ( int g = 0; g < MURMURHASH_GROUPS; g++ )
+				{
+					__m256i k = _mm256_mullo_epi32( words[g][j], m );
+					k = _mm256_mullo_epi32( _mm256_xor_si256( k, _mm256_srli_epi32( k, 24 ) ), m );
+
+					__m256i hWord = _mm256_xor_si256( _mm256_mullo_epi32( h[g], m ), k );
+					h[g] = _mm256_blendv_epi8( h[g], hWord, _mm256_cmpgt_epi32( blocks[g], block ) );
+					tail[g] = _mm256_blendv_epi8( tail[g], words[g][j], _mm256_cmpeq_epi32( blocks[g], block ) );
+				}
+			}
+		}
+
+		for ( int g = 0; g < MURMURHASH_GROUPS; g++ )
+		{
+			__m256i hTail = _mm256_blendv_epi8( h[g], _mm256_mullo_epi32( _mm256_xor_si256( h[g], tail[g] ), m ), hasTail[g] );
+			__m256i hFinal = _mm256_mullo_epi32( _mm256_xor_si256( hTail, _mm256_srli_epi32( hTail, 13 ) ), m );
+			_mm256_storeu_si256( ( __m256i * )( pHashes + 8 * g ), _mm256_xor_si256( hFinal, _mm256_srli_epi32( hFinal, 15 ) ) );
+		}
+	}
+
+	_mm256_zeroupper();
+	MurmurHash2LowerCaseBatch_Scalar( ppStrings, pnLengths, nCount, nSeed, pHashes );
+}
+
+int MurmurHash2SetSIMDLevel( int nLevel )
+{
+	static bool s_bAVX2 = CheckAVX2Technology();
+	s_nMurmurHashSIMDLevel = clamp( nLevel, 0, s_bAVX2 ? 2 : 1 );
+	return s_nMurmurHashSIMDLevel;
+}
+
+#else // !MURMURHASH_SIMD
+
+int MurmurHash2SetSIMDLevel( int nLevel )
+{
+	s_nMurmurHashSIMDLevel = 0;
+	return 0;
+}
+
+#endif // MURMURHASH_SIMD
+
+int MurmurHash2GetSIMDLevel()
+{
+	if ( s_nMurmurHashSIMDLevel < 0 )
+		MurmurHash2SetSIMDLevel( 2 );
+
+	return s_nMurmurHashSIMDLevel;
+}
+
+void MurmurHash2LowerCaseBatch( const char *const *ppStrings, const int *pnLengths, int nCount, uint32 nSeed, uint32 *pHashes )
+{
+#if MURMURHASH_SIMD
+	if ( MurmurHash2GetSIMDLevel() == 2 )
+	{
+		MurmurHash2LowerCaseBatch_AVX2( ppStrings, pnLengths, nCount, nSeed, pHashes );
+		return;
+	}
+#endif
+
+	MurmurHash2LowerCaseBatch_Scalar( ppStrings, pnLengths, nCount, nSeed, pHashes );
+}
+
 //-----------------------------------------------------------------------------
 // Murmur hash, 64 bit- endian neutral
 //-----------------------------------------------------------------------------
@@ -418,3 +674,833 @@ uint64 MurmurHash64( const void * key, int len, uint32 seed )
 
 	return h;
 }
+
+//-----------------------------------------------------------------------------
+// FastHash
+//
+// Follows the XXH3 construction: inputs up to 240 bytes take dedicated
+// scalar paths built around a 64x64->128 multiply-fold, longer inputs are
+// accumulated in 64-byte stripes into eight 64-bit lanes (two SSE2 registers
+// per half stripe) that get scrambled every 1024 bytes.
+//
+// The secret below was generated by:
+/*
+void MakeFastHashSecret()
+{
+	uint64 s = 0x3501A674;
+
+	printf( "static const uint8 g_FastHashSecret[192] =\n{\n" );
+
+	for ( int i = 0; i < 24; i++ )
+	{
+		// splitmix64
+		s += 0x9E3779B97F4A7C15ull;
+		uint64 z = s;
+		z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+		z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBull;
+		z ^= z >> 31;
+
+		if ( ( i & 1 ) == 0 )
+			printf( "\t" );
+		for ( int j = 0; j < 8; j++ )
+			printf( "0x%02x, ", ( uint8 )( z >> ( j * 8 ) ) );
+		if ( i & 1 )
+			printf( "\n" );
+	}
+	printf( "};\n" );
+}
+*/
+//-----------------------------------------------------------------------------
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define FASTHASH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined( _MSC_VER ) && defined( _M_X64 )
+#include <intrin.h>
+#endif
+
+static ALIGN16 const uint8 g_FastHashSecret[CFastHashState::SECRET_SIZE] ALIGN16_POST =
+{
+	0x0d, 0x2b, 0x2e, 0x10, 0xe9, 0x0f, 0xf5, 0x0c, 0xae, 0x1d, 0x5f, 0x90, 0x06, 0x24, 0xec, 0x94,
+	0x77, 0xad, 0x8e, 0xdb, 0x55, 0xe7, 0x8e, 0x6f, 0x6e, 0x59, 0x03, 0x1f, 0x39, 0xf8, 0x88, 0x55,
+	0xe2, 0x1d, 0x7a, 0xd8, 0x1d, 0x28, 0x45, 0x9f, 0xa5, 0x0b, 0x9e, 0xb6, 0xf3, 0xb2, 0x15, 0x14,
+	0xfb, 0xd6, 0x71, 0x9a, 0x88, 0xa8, 0xcf, 0xe3, 0xcb, 0x23, 0x42, 0x9d, 0x6e, 0x81, 0xce, 0xc8,
+	0x3d, 0x90, 0x5e, 0x75, 0x7d, 0x2f, 0x2f, 0x67, 0xe1, 0x6e, 0xc3, 0x17, 0x23, 0x98, 0xa5, 0x1b,
+	0xb3, 0x49, 0x05, 0x6d, 0x83, 0x40, 0xfd, 0xda, 0x96, 0x35, 0xf2, 0xfd, 0x2d, 0x23, 0xa3, 0xe9,
+	0x9b, 0x0d, 0x8b, 0xd1, 0x5d, 0xa4, 0xb5, 0xf2, 0x94, 0x3a, 0x9d, 0x92, 0xf9, 0x43, 0x0f, 0x3c,
+	0x92, 0x5f, 0xbf, 0x01, 0xaa, 0xac, 0xda, 0x21, 0xc2, 0xdb, 0x26, 0x2a, 0xfa, 0x24, 0x4d, 0xe9,
+	0x42, 0xdb, 0xb9, 0x8e, 0xac, 0x3e, 0xb6, 0x7f, 0x68, 0x01, 0x7e, 0xbb, 0x7f, 0xe1, 0x9c, 0xed,
+	0x55, 0xa2, 0x84, 0x47, 0x95, 0x74, 0x8d, 0xaf, 0x70, 0x11, 0xef, 0x5d, 0x57, 0x44, 0x92, 0x5d,
+	0x26, 0xd2, 0x19, 0x38, 0x87, 0x98, 0x15, 0xe4, 0x7d, 0xf2, 0x18, 0xb8, 0x0e, 0xec, 0x34, 0xed,
+	0x7c, 0x8f, 0x64, 0x35, 0xef, 0xb9, 0xb3, 0xdc, 0x31, 0xd0, 0xdb, 0x14, 0x45, 0x09, 0x0c, 0x3b,
+};
+
+static const uint32 k_nFastHashPrime32_1 = 0x9E3779B1U;
+static const uint32 k_nFastHashPrime32_2 = 0x85EBCA77U;
+static const uint32 k_nFastHashPrime32_3 = 0xC2B2AE3DU;
+static const uint64 k_nFastHashPrime64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64 k_nFastHashPrime64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64 k_nFastHashPrime64_3 = 0x165667B19E3779F9ULL;
+static const uint64 k_nFastHashPrime64_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64 k_nFastHashPrime64_5 = 0x27D4EB2F165667C5ULL;
+static const uint64 k_nFastHashPrimeMx1 = 0x165667919E3779F9ULL;
+static const uint64 k_nFastHashPrimeMx2 = 0x9FB21C651E98DF25ULL;
+
+static const int k_nFastHashSecretSize = CFastHashState::SECRET_SIZE;
+static const int k_nFastHashStripeLen = CFastHashState::STRIPE_LEN;
+static const int k_nFastHashSecretConsumeRate = 8;
+static const int k_nFastHashStripesPerBlock = ( k_nFastHashSecretSize - k_nFastHashStripeLen ) / k_nFastHashSecretConsumeRate;
+static const int k_nFastHashBlockLen = k_nFastHashStripeLen * k_nFastHashStripesPerBlock;
+static const int k_nFastHashMidSizeMax = 240;
+static const int k_nFastHashMidSizeStartOffset = 3;
+static const int k_nFastHashMidSizeLastOffset = 17;
+static const int k_nFastHashSecretSizeMin = 136;
+static const int k_nFastHashLastAccStart = 7;
+static const int k_nFastHashMergeAccsStart = 11;
+
+// ASCII 'A'-'Z' -> 'a'-'z' on every byte of a word, bytes >= 0x80 are left alone
+static FORCEINLINE uint64 FastHashFoldCase64( uint64 w )
+{
+	const uint64 nOnes = 0x0101010101010101ULL;
+	uint64 nHeptets = w & ( 0x7F * nOnes );
+	uint64 nIsGeA = nHeptets + ( 0x80 - 'A' ) * nOnes;
+	uint64 nIsGtZ = nHeptets + ( 0x80 - 'Z' - 1 ) * nOnes;
+	uint64 nUpper = nIsGeA & ~nIsGtZ & ~w & ( 0x80 * nOnes );
+	return w | ( nUpper >> 2 );
+}
+
+static FORCEINLINE uint8 FastHashFoldCase8( uint8 c )
+{
+	return ( uint8 )TOLOWERU( c );
+}
+
+template < bool bCaseless >
+static FORCEINLINE uint8 FastHashRead8( const uint8 *p )
+{
+	return bCaseless ? FastHashFoldCase8( *p ) : *p;
+}
+
+template < bool bCaseless >
+static FORCEINLINE uint32 FastHashRead32( const uint8 *p )
+{
+	uint32 n;
+	memcpy( &n, p, sizeof( n ) );
+	n = LittleDWord( n );
+	return bCaseless ? ( uint32 )FastHashFoldCase64( n ) : n;
+}
+
+template < bool bCaseless >
+static FORCEINLINE uint64 FastHashRead64( const uint8 *p )
+{
+	uint64 n;
+	memcpy( &n, p, sizeof( n ) );
+	n = LittleQWord( n );
+	return bCaseless ? FastHashFoldCase64( n ) : n;
+}
+
+static FORCEINLINE uint64 FastHashReadSecret64( const uint8 *p )
+{
+	return FastHashRead64< false >( p );
+}
+
+static FORCEINLINE uint32 FastHashReadSecret32( const uint8 *p )
+{
+	return FastHashRead32< false >( p );
+}
+
+static FORCEINLINE void FastHashWrite64( uint8 *p, uint64 n )
+{
+	n = LittleQWord( n );
+	memcpy( p, &n, sizeof( n ) );
+}
+
+static FORCEINLINE uint64 FastHashRotl64( uint64 n, int nBits )
+{
+	return ( n << nBits ) | ( n >> ( 64 - nBits ) );
+}
+
+static FORCEINLINE uint32 FastHashRotl32( uint32 n, int nBits )
+{
+	return ( n << nBits ) | ( n >> ( 32 - nBits ) );
+}
+
+static FORCEINLINE uint32 FastHashSwap32( uint32 n )
+{
+	return ( ( n << 24 ) & 0xff000000 ) | ( ( n << 8 ) & 0x00ff0000 ) | ( ( n >> 8 ) & 0x0000ff00 ) | ( ( n >> 24 ) & 0x000000ff );
+}
+
+static FORCEINLINE uint64 FastHashSwap64( uint64 n )
+{
+	return ( ( uint64 )FastHashSwap32( ( uint32 )n ) << 32 ) | FastHashSwap32( ( uint32 )( n >> 32 ) );
+}
+
+static FORCEINLINE FastHash128_t FastHashMul64to128( uint64 lhs, uint64 rhs )
+{
+	FastHash128_t r;
+#if defined( __SIZEOF_INT128__ )
+	__uint128_t nProduct = ( __uint128_t )lhs * rhs;
+	r.m_nLow = ( uint64 )nProduct;
+	r.m_nHigh = ( uint64 )( nProduct >> 64 );
+#elif defined( _MSC_VER ) && defined( _M_X64 )
+	r.m_nLow = _umul128( lhs, rhs, &r.m_nHigh );
+#else
+	uint64 nLoLo = ( lhs & 0xFFFFFFFF ) * ( rhs & 0xFFFFFFFF );
+	uint64 nHiLo = ( lhs >> 32 ) * ( rhs & 0xFFFFFFFF );
+	uint64 nLoHi = ( lhs & 0xFFFFFFFF ) * ( rhs >> 32 );
+	uint64 nHiHi = ( lhs >> 32 ) * ( rhs >> 32 );
+	uint64 nCross = ( nLoLo >> 32 ) + ( nHiLo & 0xFFFFFFFF ) + nLoHi;
+	r.m_nHigh = ( nHiLo >> 32 ) + ( nCross >> 32 ) + nHiHi;
+	r.m_nLow = ( nCross << 32 ) | ( nLoLo & 0xFFFFFFFF );
+#endif
+	return r;
+}
+
+static FORCEINLINE uint64 FastHashMul128Fold64( uint64 lhs, uint64 rhs )
+{
+	FastHash128_t r = FastHashMul64to128( lhs, rhs );
+	return r.m_nLow ^ r.m_nHigh;
+}
+
+static FORCEINLINE uint64 FastHashAvalanche( uint64 h )
+{
+	h ^= h >> 37;
+	h *= k_nFastHashPrimeMx1;
+	h ^= h >> 32;
+	return h;
+}
+
+static FORCEINLINE uint64 FastHashAvalanche64( uint64 h )
+{
+	h ^= h >> 33;
+	h *= k_nFastHashPrime64_2;
+	h ^= h >> 29;
+	h *= k_nFastHashPrime64_3;
+	h ^= h >> 32;
+	return h;
+}
+
+static FORCEINLINE uint64 FastHashRrmxmx( uint64 h, uint64 nLength )
+{
+	h ^= FastHashRotl64( h, 49 ) ^ FastHashRotl64( h, 24 );
+	h *= k_nFastHashPrimeMx2;
+	h ^= ( h >> 35 ) + nLength;
+	h *= k_nFastHashPrimeMx2;
+	h ^= h >> 28;
+	return h;
+}
+
+template < bool bCaseless >
+static FORCEINLINE uint64 FastHashMix16( const uint8 *pInput, const uint8 *pSecret, uint64 nSeed )
+{
+	uint64 nInputLo = FastHashRead64< bCaseless >( pInput );
+	uint64 nInputHi = FastHashRead64< bCaseless >( pInput + 8 );
+	return FastHashMul128Fold64( nInputLo ^ ( FastHashReadSecret64( pSecret ) + nSeed ),
+								 nInputHi ^ ( FastHashReadSecret64( pSecret + 8 ) - nSeed ) );
+}
+
+template < bool bCaseless >
+static FORCEINLINE FastHash128_t FastHashMix32( FastHash128_t acc, const uint8 *pInput1, const uint8 *pInput2, const uint8 *pSecret, uint64 nSeed )
+{
+	acc.m_nLow += FastHashMix16< bCaseless >( pInput1, pSecret, nSeed );
+	acc.m_nLow ^= FastHashRead64< bCaseless >( pInput2 ) + FastHashRead64< bCaseless >( pInput2 + 8 );
+	acc.m_nHigh += FastHashMix16< bCaseless >( pInput2, pSecret + 16, nSeed );
+	acc.m_nHigh ^= FastHashRead64< bCaseless >( pInput1 ) + FastHashRead64< bCaseless >( pInput1 + 8 );
+	return acc;
+}
+
+//-----------------------------------------------------------------------------
+// Stripe accumulation and scrambling
+//-----------------------------------------------------------------------------
+#ifdef FASTHASH_SSE2
+
+static FORCEINLINE __m128i FastHashFoldCaseSIMD( __m128i data )
+{
+	// Signed compares leave bytes >= 0x80 untouched, which is what we want
+	const __m128i vA = _mm_set1_epi8( 'A' - 1 );
+	const __m128i vZ = _mm_set1_epi8( 'Z' + 1 );
+	const __m128i vCaseBit = _mm_set1_epi8( 0x20 );
+	__m128i upper = _mm_and_si128( _mm_cmpgt_epi8( data, vA ), _mm_cmplt_epi8( data, vZ ) );
+	return _mm_or_si128( data, _mm_and_si128( upper, vCaseBit ) );
+}
+
+template < bool bCaseless >
+static FORCEINLINE void FastHashAccumulate512( uint64 *RESTRICT pAcc, const uint8 *RESTRICT pInput, const uint8 *RESTRICT pSecret )
+{
+	__m128i *pAccVec = ( __m128i * )pAcc;
+
+	for ( int i = 0; i < 4; i++ )
+	{
+		__m128i data = _mm_loadu_si128( ( const __m128i * )pInput + i );
+		if ( bCaseless )
+			data = FastHashFoldCaseSIMD( data );
+
+		__m128i key = _mm_loadu_si128( ( const __m128i * )pSecret + i );
+		__m128i dataKey = _mm_xor_si128( data, key );
+		__m128i dataKeyLo = _mm_shuffle_epi32( dataKey, _MM_SHUFFLE( 0, 3, 0, 1 ) );
+		__m128i product = _mm_mul_epu32( dataKey, dataKeyLo );
+		__m128i dataSwap = _mm_shuffle_epi32( data, _MM_SHUFFLE( 1, 0, 3, 2 ) );
+		__m128i sum = _mm_add_epi64( _mm_load_si128( pAccVec + i ), dataSwap );
+		_mm_store_si128( pAccVec + i, _mm_add_epi64( product, sum ) );
+	}
+}
+
+static FORCEINLINE void FastHashScrambleAcc( uint64 *RESTRICT pAcc, const uint8 *RESTRICT pSecret )
+{
+	__m128i *pAccVec = ( __m128i * )pAcc;
+	const __m128i prime32 = _mm_set1_epi32( ( int )k_nFastHashPrime32_1 );
+
+	for ( int i = 0; i < 4; i++ )
+	{
+		__m128i acc = _mm_load_si128( pAccVec + i );
+		__m128i data = _mm_xor_si128( acc, _mm_srli_epi64( acc, 47 ) );
+		__m128i dataKey = _mm_xor_si128( data, _mm_loadu_si128( ( const __m128i * )pSecret + i ) );
+		__m128i dataKeyHi = _mm_shuffle_epi32( dataKey, _MM_SHUFFLE( 0, 3, 0, 1 ) );
+		__m128i productLo = _mm_mul_epu32( dataKey, prime32 );
+		__m128i productHi = _mm_mul_epu32( dataKeyHi, prime32 );
+		_mm_store_si128( pAccVec + i, _mm_add_epi64( productLo, _mm_slli_epi64( productHi, 32 ) ) );
+	}
+}
+
+#else // !FASTHASH_SSE2
+
+template < bool bCaseless >
+static FORCEINLINE void FastHashAccumulate512( uint64 *RESTRICT pAcc, const uint8 *RESTRICT pInput, const uint8 *RESTRICT pSecret )
+{
+	for ( int i = 0; i < 8; i++ )
+	{
+		uint64 nData = FastHashRead64< bCaseless >( pInput + 8 * i );
+		uint64 nDataKey = nData ^ FastHashReadSecret64( pSecret + 8 * i );
+		pAcc[i ^ 1] += nData;
+		pAcc[i] += ( nDataKey & 0xFFFFFFFF ) * ( nDataKey >> 32 );
+	}
+}
+
+static FORCEINLINE void FastHashScrambleAcc( uint64 *RESTRICT pAcc, const uint8 *RESTRICT pSecret )
+{
+	for ( int i = 0; i < 8; i++ )
+	{
+		uint64 nAcc = pAcc[i];
+		nAcc ^= nAcc >> 47;
+		nAcc ^= FastHashReadSecret64( pSecret + 8 * i );
+		nAcc *= k_nFastHashPrime32_1;
+		pAcc[i] = nAcc;
+	}
+}
+
+#endif // FASTHASH_SSE2
+
+template < bool bCaseless >
+static FORCEINLINE void FastHashAccumulate( uint64 *RESTRICT pAcc, const uint8 *RESTRICT pInput, const uint8 *RESTRICT pSecret, size_t nStripes )
+{
+	for ( size_t n = 0; n < nStripes; n++ )
+	{
+		FastHashAccumulate512< bCaseless >( pAcc, pInput + n * k_nFastHashStripeLen, pSecret + n * k_nFastHashSecretConsumeRate );
+	}
+}
+
+static FORCEINLINE void FastHashInitAcc( uint64 *pAcc )
+{
+	pAcc[0] = k_nFastHashPrime32_3;
+	pAcc[1] = k_nFastHashPrime64_1;
+	pAcc[2] = k_nFastHashPrime64_2;
+	pAcc[3] = k_nFastHashPrime64_3;
+	pAcc[4] = k_nFastHashPrime64_4;
+	pAcc[5] = k_nFastHashPrime32_2;
+	pAcc[6] = k_nFastHashPrime64_5;
+	pAcc[7] = k_nFastHashPrime32_1;
+}
+
+static FORCEINLINE void FastHashInitSecret( uint8 *pCustomSecret, uint64 nSeed )
+{
+	for ( int i = 0; i < k_nFastHashSecretSize / 16; i++ )
+	{
+		FastHashWrite64( pCustomSecret + 16 * i, FastHashReadSecret64( g_FastHashSecret + 16 * i ) + nSeed );
+		FastHashWrite64( pCustomSecret + 16 * i + 8, FastHashReadSecret64( g_FastHashSecret + 16 * i + 8 ) - nSeed );
+	}
+}
+
+template < bool bCaseless >
+static void FastHashLongLoop( uint64 *RESTRICT pAcc, const uint8 *RESTRICT pInput, size_t nLength, const uint8 *RESTRICT pSecret )
+{
+	size_t nBlocks = ( nLength - 1 ) / k_nFastHashBlockLen;
+
+	for ( size_t n = 0; n < nBlocks; n++ )
+	{
+		FastHashAccumulate< bCaseless >( pAcc, pInput + n * k_nFastHashBlockLen, pSecret, k_nFastHashStripesPerBlock );
+		FastHashScrambleAcc( pAcc, pSecret + k_nFastHashSecretSize - k_nFastHashStripeLen );
+	}
+
+	// Last partial block
+	size_t nStripes = ( ( nLength - 1 ) - ( k_nFastHashBlockLen * nBlocks ) ) / k_nFastHashStripeLen;
+	FastHashAccumulate< bCaseless >( pAcc, pInput + nBlocks * k_nFastHashBlockLen, pSecret, nStripes );
+
+	// Last stripe
+	FastHashAccumulate512< bCaseless >( pAcc, pInput + nLength - k_nFastHashStripeLen, pSecret + k_nFastHashSecretSize - k_nFastHashStripeLen - k_nFastHashLastAccStart );
+}
+
+static FORCEINLINE uint64 FastHashMergeAccs( const uint64 *pAcc, const uint8 *pSecret, uint64 nStart )
+{
+	uint64 nResult = nStart;
+
+	for ( int i = 0; i < 4; i++ )
+	{
+		nResult += FastHashMul128Fold64( pAcc[2 * i] ^ FastHashReadSecret64( pSecret + 16 * i ),
+										 pAcc[2 * i + 1] ^ FastHashReadSecret64( pSecret + 16 * i + 8 ) );
+	}
+
+	return FastHashAvalanche( nResult );
+}
+
+static FORCEINLINE uint64 FastHashFinalizeLong64( const uint64 *pAcc, const uint8 *pSecret, uint64 nLength )
+{
+	return FastHashMergeAccs( pAcc, pSecret + k_nFastHashMergeAccsStart, nLength * k_nFastHashPrime64_1 );
+}
+
+static FORCEINLINE FastHash128_t FastHashFinalizeLong128( const uint64 *pAcc, const uint8 *pSecret, uint64 nLength )
+{
+	FastHash128_t h;
+	h.m_nLow = FastHashMergeAccs( pAcc, pSecret + k_nFastHashMergeAccsStart, nLength * k_nFastHashPrime64_1 );
+	h.m_nHigh = FastHashMergeAccs( pAcc, pSecret + k_nFastHashSecretSize - k_nFastHashStripeLen - k_nFastHashMergeAccsStart, ~( nLength * k_nFastHashPrime64_2 ) );
+	return h;
+}
+
+//-----------------------------------------------------------------------------
+// 64-bit
+//-----------------------------------------------------------------------------
+template < bool bCaseless >
+static uint64 FastHash64Short( const uint8 *pInput, size_t nLength, const uint8 *pSecret, uint64 nSeed )
+{
+	if ( nLength > 16 )
+	{
+		if ( nLength <= 128 )
+		{
+			uint64 nAcc = nLength * k_nFastHashPrime64_1;
+
+			if ( nLength > 32 )
+			{
+				if ( nLength > 64 )
+				{
+					if ( nLength > 96 )
+					{
+						nAcc += FastHashMix16< bCaseless >( pInput + 48, pSecret + 96, nSeed );
+						nAcc += FastHashMix16< bCaseless >( pInput + nLength - 64, pSecret + 112, nSeed );
+					}
+					nAcc += FastHashMix16< bCaseless >( pInput + 32, pSecret + 64, nSeed );
+					nAcc += FastHashMix16< bCaseless >( pInput + nLength - 48, pSecret + 80, nSeed );
+				}
+				nAcc += FastHashMix16< bCaseless >( pInput + 16, pSecret + 32, nSeed );
+				nAcc += FastHashMix16< bCaseless >( pInput + nLength - 32, pSecret + 48, nSeed );
+			}
+			nAcc += FastHashMix16< bCaseless >( pInput + 0, pSecret + 0, nSeed );
+			nAcc += FastHashMix16< bCaseless >( pInput + nLength - 16, pSecret + 16, nSeed );
+
+			return FastHashAvalanche( nAcc );
+		}
+
+		// 129-240
+		uint64 nAcc = nLength * k_nFastHashPrime64_1;
+		int nRounds = ( int )nLength / 16;
+
+		for ( int i = 0; i < 8; i++ )
+		{
+			nAcc += FastHashMix16< bCaseless >( pInput + 16 * i, pSecret + 16 * i, nSeed );
+		}
+
+		nAcc = FastHashAvalanche( nAcc );
+
+		for ( int i = 8; i < nRounds; i++ )
+		{
+			nAcc += FastHashMix16< bCaseless >( pInput + 16 * i, pSecret + 16 * ( i - 8 ) + k_nFastHashMidSizeStartOffset, nSeed );
+		}
+
+		nAcc += FastHashMix16< bCaseless >( pInput + nLength - 16, pSecret + k_nFastHashSecretSizeMin - k_nFastHashMidSizeLastOffset, nSeed );
+
+		return FastHashAvalanche( nAcc );
+	}
+
+	if ( nLength > 8 )
+	{
+		uint64 nBitflip1 = ( FastHashReadSecret64( pSecret + 24 ) ^ FastHashReadSecret64( pSecret + 32 ) ) + nSeed;
+		uint64 nBitflip2 = ( FastHashReadSecret64( pSecret + 40 ) ^ FastHashReadSecret64( pSecret + 48 ) ) - nSeed;
+		uint64 nInputLo = FastHashRead64< bCaseless >( pInput ) ^ nBitflip1;
+		uint64 nInputHi = FastHashRead64< bCaseless >( pInput + nLength - 8 ) ^ nBitflip2;
+		uint64 nAcc = nLength + FastHashSwap64( nInputLo ) + nInputHi + FastHashMul128Fold64( nInputLo, nInputHi );
+
+		return FastHashAvalanche( nAcc );
+	}
+
+	if ( nLength >= 4 )
+	{
+		nSeed ^= ( uint64 )FastHashSwap32( ( uint32 )nSeed ) << 32;
+
+		uint32 nInput1 = FastHashRead32< bCaseless >( pInput );
+		uint32 nInput2 = FastHashRead32< bCaseless >( pInput + nLength - 4 );
+		uint64 nBitflip = ( FastHashReadSecret64( pSecret + 8 ) ^ FastHashReadSecret64( pSecret + 16 ) ) - nSeed;
+		uint64 nInput64 = nInput2 + ( ( uint64 )nInput1 << 32 );
+
+		return FastHashRrmxmx( nInput64 ^ nBitflip, nLength );
+	}
+
+	if ( nLength > 0 )
+	{
+		uint32 c1 = FastHashRead8< bCaseless >( pInput );
+		uint32 c2 = FastHashRead8< bCaseless >( pInput + ( nLength >> 1 ) );
+		uint32 c3 = FastHashRead8< bCaseless >( pInput + nLength - 1 );
+		uint32 nCombined = ( c1 << 16 ) | ( c2 << 24 ) | ( c3 << 0 ) | ( ( uint32 )nLength << 8 );
+		uint64 nBitflip = ( FastHashReadSecret32( pSecret ) ^ FastHashReadSecret32( pSecret + 4 ) ) + nSeed;
+
+		return FastHashAvalanche64( ( uint64 )nCombined ^ nBitflip );
+	}
+
+	return FastHashAvalanche64( nSeed ^ ( FastHashReadSecret64( pSecret + 56 ) ^ FastHashReadSecret64( pSecret + 64 ) ) );
+}
+
+template < bool bCaseless >
+static uint64 FastHash64Internal( const void *pKey, size_t nLength, uint64 nSeed )
+{
+	const uint8 *pInput = ( const uint8 * )pKey;
+
+	if ( nLength <= k_nFastHashMidSizeMax )
+		return FastHash64Short< bCaseless >( pInput, nLength, g_FastHashSecret, nSeed );
+
+	ALIGN16 uint64 acc[CFastHashState::ACC_COUNT] ALIGN16_POST;
+	FastHashInitAcc( acc );
+
+	if ( nSeed == 0 )
+	{
+		FastHashLongLoop< bCaseless >( acc, pInput, nLength, g_FastHashSecret );
+		return FastHashFinalizeLong64( acc, g_FastHashSecret, nLength );
+	}
+
+	ALIGN16 uint8 customSecret[k_nFastHashSecretSize] ALIGN16_POST;
+	FastHashInitSecret( customSecret, nSeed );
+	FastHashLongLoop< bCaseless >( acc, pInput, nLength, customSecret );
+	return FastHashFinalizeLong64( acc, customSecret, nLength );
+}
+
+uint64 FastHash64( const void *pKey, size_t nLength, uint64 nSeed )
+{
+	return FastHash64Internal< false >( pKey, nLength, nSeed );
+}
+
+uint64 FastHash64Caseless( const void *pKey, size_t nLength, uint64 nSeed )
+{
+	return FastHash64Internal< true >( pKey, nLength, nSeed );
+}
+
+uint64 FastHashString64( const char *pszKey, uint64 nSeed )
+{
+	return FastHash64Internal< false >( pszKey, V_strlen( pszKey ), nSeed );
+}
+
+uint64 FastHashStringCaseless64( const char *pszKey, uint64 nSeed )
+{
+	return FastHash64Internal< true >( pszKey, V_strlen( pszKey ), nSeed );
+}
+
+//-----------------------------------------------------------------------------
+// 128-bit
+//-----------------------------------------------------------------------------
+template < bool bCaseless >
+static FastHash128_t FastHash128Short( const uint8 *pInput, size_t nLength, const uint8 *pSecret, uint64 nSeed )
+{
+	FastHash128_t h;
+
+	if ( nLength > 16 )
+	{
+		FastHash128_t acc;
+		acc.m_nLow = nLength * k_nFastHashPrime64_1;
+		acc.m_nHigh = 0;
+
+		if ( nLength <= 128 )
+		{
+			if ( nLength > 32 )
+			{
+				if ( nLength > 64 )
+				{
+					if ( nLength > 96 )
+					{
+						acc = FastHashMix32< bCaseless >( acc, pInput + 48, pInput + nLength - 64, pSecret + 96, nSeed );
+					}
+					acc = FastHashMix32< bCaseless >( acc, pInput + 32, pInput + nLength - 48, pSecret + 64, nSeed );
+				}
+				acc = FastHashMix32< bCaseless >( acc, pInput + 16, pInput + nLength - 32, pSecret + 32, nSeed );
+			}
+			acc = FastHashMix32< bCaseless >( acc, pInput, pInput + nLength - 16, pSecret, nSeed );
+		}
+		else
+		{
+			// 129-240
+			int nRounds = ( int )nLength / 32;
+
+			for ( int i = 0; i < 4; i++ )
+			{
+				acc = FastHashMix32< bCaseless >( acc, pInput + 32 * i, pInput + 32 * i + 16, pSecret + 32 * i, nSeed );
+			}
+
+			acc.m_nLow = FastHashAvalanche( acc.m_nLow );
+			acc.m_nHigh = FastHashAvalanche( acc.m_nHigh );
+
+			for ( int i = 4; i < nRounds; i++ )
+			{
+				acc = FastHashMix32< bCaseless >( acc, pInput + 32 * i, pInput + 32 * i + 16, pSecret + k_nFastHashMidSizeStartOffset + 32 * ( i - 4 ), nSeed );
+			}
+
+			acc = FastHashMix32< bCaseless >( acc, pInput + nLength - 16, pInput + nLength - 32, pSecret + k_nFastHashSecretSizeMin - k_nFastHashMidSizeLastOffset - 16, 0 - nSeed );
+		}
+
+		h.m_nLow = acc.m_nLow + acc.m_nHigh;
+		h.m_nHigh = ( acc.m_nLow * k_nFastHashPrime64_1 ) + ( acc.m_nHigh * k_nFastHashPrime64_4 ) + ( ( nLength - nSeed ) * k_nFastHashPrime64_2 );
+		h.m_nLow = FastHashAvalanche( h.m_nLow );
+		h.m_nHigh = 0 - FastHashAvalanche( h.m_nHigh );
+		return h;
+	}
+
+	if ( nLength > 8 )
+	{
+		uint64 nBitflipLo = ( FastHashReadSecret64( pSecret + 32 ) ^ FastHashReadSecret64( pSecret + 40 ) ) - nSeed;
+		uint64 nBitflipHi = ( FastHashReadSecret64( pSecret + 48 ) ^ FastHashReadSecret64( pSecret + 56 ) ) + nSeed;
+		uint64 nInputLo = FastHashRead64< bCaseless >( pInput );
+		uint64 nInputHi = FastHashRead64< bCaseless >( pInput + nLength - 8 );
+
+		FastHash128_t m = FastHashMul64to128( nInputLo ^ nInputHi ^ nBitflipLo, k_nFastHashPrime64_1 );
+		m.m_nLow += ( uint64 )( nLength - 1 ) << 54;
+		nInputHi ^= nBitflipHi;
+		m.m_nHigh += nInputHi + ( uint64 )( uint32 )nInputHi * ( k_nFastHashPrime32_2 - 1 );
+		m.m_nLow ^= FastHashSwap64( m.m_nHigh );
+
+		h = FastHashMul64to128( m.m_nLow, k_nFastHashPrime64_2 );
+		h.m_nHigh += m.m_nHigh * k_nFastHashPrime64_2;
+		h.m_nLow = FastHashAvalanche( h.m_nLow );
+		h.m_nHigh = FastHashAvalanche( h.m_nHigh );
+		return h;
+	}
+
+	if ( nLength >= 4 )
+	{
+		nSeed ^= ( uint64 )FastHashSwap32( ( uint32 )nSeed ) << 32;
+
+		uint32 nInputLo = FastHashRead32< bCaseless >( pInput );
+		uint32 nInputHi = FastHashRead32< bCaseless >( pInput + nLength - 4 );
+		uint64 nInput64 = nInputLo + ( ( uint64 )nInputHi << 32 );
+		uint64 nBitflip = ( FastHashReadSecret64( pSecret + 16 ) ^ FastHashReadSecret64( pSecret + 24 ) ) + nSeed;
+
+		h = FastHashMul64to128( nInput64 ^ nBitflip, k_nFastHashPrime64_1 + ( nLength << 2 ) );
+		h.m_nHigh += h.m_nLow << 1;
+		h.m_nLow ^= h.m_nHigh >> 3;
+		h.m_nLow ^= h.m_nLow >> 35;
+		h.m_nLow *= k_nFastHashPrimeMx2;
+		h.m_nLow ^= h.m_nLow >> 28;
+		h.m_nHigh = FastHashAvalanche( h.m_nHigh );
+		return h;
+	}
+
+	if ( nLength > 0 )
+	{
+		uint32 c1 = FastHashRead8< bCaseless >( pInput );
+		uint32 c2 = FastHashRead8< bCaseless >( pInput + ( nLength >> 1 ) );
+		uint32 c3 = FastHashRead8< bCaseless >( pInput + nLength - 1 );
+		uint32 nCombinedLo = ( c1 << 16 ) | ( c2 << 24 ) | ( c3 << 0 ) | ( ( uint32 )nLength << 8 );
+		uint32 nCombinedHi = FastHashRotl32( FastHashSwap32( nCombinedLo ), 13 );
+		uint64 nBitflipLo = ( FastHashReadSecret32( pSecret ) ^ FastHashReadSecret32( pSecret + 4 ) ) + nSeed;
+		uint64 nBitflipHi = ( FastHashReadSecret32( pSecret + 8 ) ^ FastHashReadSecret32( pSecret + 12 ) ) - nSeed;
+
+		h.m_nLow = FastHashAvalanche64( ( uint64 )nCombinedLo ^ nBitflipLo );
+		h.m_nHigh = FastHashAvalanche64( ( uint64 )nCombinedHi ^ nBitflipHi );
+		return h;
+	}
+
+	h.m_nLow = FastHashAvalanche64( nSeed ^ FastHashReadSecret64( pSecret + 64 ) ^ FastHashReadSecret64( pSecret + 72 ) );
+	h.m_nHigh = FastHashAvalanche64( nSeed ^ FastHashReadSecret64( pSecret + 80 ) ^ FastHashReadSecret64( pSecret + 88 ) );
+	return h;
+}
+
+template < bool bCaseless >
+static FastHash128_t FastHash128Internal( const void *pKey, size_t nLength, uint64 nSeed )
+{
+	const uint8 *pInput = ( const uint8 * )pKey;
+
+	if ( nLength <= k_nFastHashMidSizeMax )
+		return FastHash128Short< bCaseless >( pInput, nLength, g_FastHashSecret, nSeed );
+
+	ALIGN16 uint64 acc[CFastHashState::ACC_COUNT] ALIGN16_POST;
+	FastHashInitAcc( acc );
+
+	if ( nSeed == 0 )
+	{
+		FastHashLongLoop< bCaseless >( acc, pInput, nLength, g_FastHashSecret );
+		return FastHashFinalizeLong128( acc, g_FastHashSecret, nLength );
+	}
+
+	ALIGN16 uint8 customSecret[k_nFastHashSecretSize] ALIGN16_POST;
+	FastHashInitSecret( customSecret, nSeed );
+	FastHashLongLoop< bCaseless >( acc, pInput, nLength, customSecret );
+	return FastHashFinalizeLong128( acc, customSecret, nLength );
+}
+
+FastHash128_t FastHash128( const void *pKey, size_t nLength, uint64 nSeed )
+{
+	return FastHash128Internal< false >( pKey, nLength, nSeed );
+}
+
+FastHash128_t FastHash128Caseless( const void *pKey, size_t nLength, uint64 nSeed )
+{
+	return FastHash128Internal< true >( pKey, nLength, nSeed );
+}
+
+//-----------------------------------------------------------------------------
+// Streaming
+//-----------------------------------------------------------------------------
+void CFastHashState::Reset( uint64 nSeed, bool bCaseless )
+{
+	FastHashInitAcc( m_nAcc );
+
+	if ( nSeed == 0 )
+		memcpy( m_Secret, g_FastHashSecret, sizeof( m_Secret ) );
+	else
+		FastHashInitSecret( m_Secret, nSeed );
+
+	m_nTotalLength = 0;
+	m_nSeed = nSeed;
+	m_nBufferedSize = 0;
+	m_nStripesSoFar = 0;
+	m_bCaseless = bCaseless;
+}
+
+void CFastHashState::ConsumeStripes( uint64 *pAcc, uint32 &nStripesSoFar, const uint8 *pInput, uint32 nStripes ) const
+{
+	// Input that reaches here has already been case folded
+	for ( uint32 n = 0; n < nStripes; n++ )
+	{
+		FastHashAccumulate512< false >( pAcc, pInput + n * k_nFastHashStripeLen, m_Secret + nStripesSoFar * k_nFastHashSecretConsumeRate );
+
+		if ( ++nStripesSoFar == ( uint32 )k_nFastHashStripesPerBlock )
+		{
+			FastHashScrambleAcc( pAcc, m_Secret + k_nFastHashSecretSize - k_nFastHashStripeLen );
+			nStripesSoFar = 0;
+		}
+	}
+}
+
+static void FastHashCopyToBuffer( uint8 *pDest, const uint8 *pSrc, size_t nLength, bool bCaseless )
+{
+	if ( !bCaseless )
+	{
+		memcpy( pDest, pSrc, nLength );
+		return;
+	}
+
+	size_t i = 0;
+	for ( ; i + 8 <= nLength; i += 8 )
+	{
+		FastHashWrite64( pDest + i, FastHashRead64< true >( pSrc + i ) );
+	}
+	for ( ; i < nLength; i++ )
+	{
+		pDest[i] = FastHashFoldCase8( pSrc[i] );
+	}
+}
+
+void CFastHashState::Update( const void *pData, size_t nLength )
+{
+	const uint8 *pInput = ( const uint8 * )pData;
+
+	if ( !nLength )
+		return;
+
+	m_nTotalLength += nLength;
+
+	if ( m_nBufferedSize + nLength <= BUFFER_SIZE )
+	{
+		FastHashCopyToBuffer( m_Buffer + m_nBufferedSize, pInput, nLength, m_bCaseless );
+		m_nBufferedSize += ( uint32 )nLength;
+		return;
+	}
+
+	// Only consume when more input follows, the final stripe is always
+	// handled by the digest, same as the one-shot path does
+	const uint32 nBufferStripes = BUFFER_SIZE / STRIPE_LEN;
+
+	if ( m_nBufferedSize )
+	{
+		size_t nFill = BUFFER_SIZE - m_nBufferedSize;
+		FastHashCopyToBuffer( m_Buffer + m_nBufferedSize, pInput, nFill, m_bCaseless );
+		pInput += nFill;
+		nLength -= nFill;
+
+		ConsumeStripes( m_nAcc, m_nStripesSoFar, m_Buffer, nBufferStripes );
+		m_nBufferedSize = 0;
+	}
+
+	if ( nLength > BUFFER_SIZE )
+	{
+		do
+		{
+			if ( m_bCaseless )
+			{
+				ALIGN16 uint8 folded[BUFFER_SIZE] ALIGN16_POST;
+				FastHashCopyToBuffer( folded, pInput, BUFFER_SIZE, true );
+				ConsumeStripes( m_nAcc, m_nStripesSoFar, folded, nBufferStripes );
+			}
+			else
+			{
+				ConsumeStripes( m_nAcc, m_nStripesSoFar, pInput, nBufferStripes );
+			}
+
+			pInput += BUFFER_SIZE;
+			nLength -= BUFFER_SIZE;
+		}
+		while ( nLength > BUFFER_SIZE );
+
+		// Keep the last consumed stripe around, digest may need part of it
+		FastHashCopyToBuffer( m_Buffer + BUFFER_SIZE - STRIPE_LEN, pInput - STRIPE_LEN, STRIPE_LEN, m_bCaseless );
+	}
+
+	FastHashCopyToBuffer( m_Buffer, pInput, nLength, m_bCaseless );
+	m_nBufferedSize = ( uint32 )nLength;
+}
+
+void CFastHashState::DigestLong( uint64 *pAcc ) const
+{
+	memcpy( pAcc, m_nAcc, sizeof( m_nAcc ) );
+
+	if ( m_nBufferedSize >= STRIPE_LEN )
+	{
+		uint32 nStripesSoFar = m_nStripesSoFar;
+		uint32 nStripes = ( m_nBufferedSize - 1 ) / STRIPE_LEN;
+
+		ConsumeStripes( pAcc, nStripesSoFar, m_Buffer, nStripes );
+		FastHashAccumulate512< false >( pAcc, m_Buffer + m_nBufferedSize - STRIPE_LEN, m_Secret + k_nFastHashSecretSize - k_nFastHashStripeLen - k_nFastHashLastAccStart );
+	}
+	else
+	{
+		// Stitch the last stripe together from the tail of the previous buffer
+		ALIGN16 uint8 lastStripe[STRIPE_LEN] ALIGN16_POST;
+		uint32 nCatchup = STRIPE_LEN - m_nBufferedSize;
+
+		memcpy( lastStripe, m_Buffer + BUFFER_SIZE - nCatchup, nCatchup );
+		memcpy( lastStripe + nCatchup, m_Buffer, m_nBufferedSize );
+		FastHashAccumulate512< false >( pAcc, lastStripe, m_Secret + k_nFastHashSecretSize - k_nFastHashStripeLen - k_nFastHashLastAccStart );
+	}
+}
+
+uint64 CFastHashState::Digest64() const
+{
+	if ( m_nTotalLength <= ( uint64 )k_nFastHashMidSizeMax )
+		return FastHash64Short< false >( m_Buffer, ( size_t )m_nTotalLength, g_FastHashSecret, m_nSeed );
+
+	ALIGN16 uint64 acc[ACC_COUNT] ALIGN16_POST;
+	DigestLong( acc );
+	return FastHashFinalizeLong64( acc, m_Secret, m_nTotalLength );
+}
+
+FastHash128_t CFastHashState::Digest128() const
+{
+	if ( m_nTotalLength <= ( uint64 )k_nFastHashMidSizeMax )
+		return FastHash128Short< false >( m_Buffer, ( size_t )m_nTotalLength, g_FastHashSecret, m_nSeed );
+
+	ALIGN16 uint64 acc[ACC_COUNT] ALIGN16_POST;
+	DigestLong( acc );
+	return FastHashFinalizeLong128( acc, m_Secret, m_nTotalLength );
+}
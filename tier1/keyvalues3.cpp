@@ -1,4 +1,5 @@
 #include "tier1/keyvalues3.h"
+#include "tier1/utlperfecthash.h"
 
 // memdbgon must be the last include file in a .cpp file!!!
 #include "tier0/memdbgon.h"
@@ -1086,85 +1087,99 @@ void KeyValues3::SetHasInvalidMemberNames( bool bValue )
 	pTable->SetHasInvalidMemberNames( bValue );
 }
 
+static constexpr const char *s_pszKV3Types[KV3_TYPE_COUNT] =
+{
+	"invalid",
+	"null",
+	"bool",
+	"int",
+	"uint",
+	"double",
+	"string",
+	"binary_blob",
+	"array",
+	"table"
+};
+
+static constexpr const char *s_pszKV3SubTypes[KV3_SUBTYPE_COUNT] =
+{
+	"invalid",
+	"resource",
+	"resource_name",
+	"panorama",
+	"soundevent",
+	"subclass",
+	"entity_name",
+	"localize",
+	"unspecified",
+	"null",
+	"binary_blob",
+	"array",
+	"table",
+	"bool8",
+	"char8",
+	"uchar32",
+	"int8",
+	"uint8",
+	"int16",
+	"uint16",
+	"int32",
+	"uint32",
+	"int64",
+	"uint64",
+	"float32",
+	"float64",
+	"string",
+	"pointer",
+	"color32",
+	"vector",
+	"vector2d",
+	"vector4d",
+	"rotation_vector",
+	"quaternion",
+	"qangle",
+	"matrix3x4",
+	"transform",
+	"string_token",
+	"ehandle"
+};
+
 const char* KeyValues3::GetTypeAsString() const
 {
-	static const char* s_Types[] =
-	{
-		"invalid",
-		"null",
-		"bool",
-		"int",
-		"uint",
-		"double",
-		"string",
-		"binary_blob",
-		"array",
-		"table",
-		nullptr
-	};
-
 	KV3Type_t type = GetType();
 
 	if ( type < KV3_TYPE_COUNT )
-		return s_Types[type];
+		return s_pszKV3Types[type];
 
 	return "<unknown>";
 }
 
 const char* KeyValues3::GetSubTypeAsString() const
 {
-	static const char* s_SubTypes[] =
-	{
-		"invalid",
-		"resource",
-		"resource_name",
-		"panorama",
-		"soundevent",
-		"subclass",
-		"entity_name",
-		"localize",
-		"unspecified",
-		"null",
-		"binary_blob",
-		"array",
-		"table",
-		"bool8",
-		"char8",
-		"uchar32",
-		"int8",
-		"uint8",
-		"int16",
-		"uint16",
-		"int32",
-		"uint32",
-		"int64",
-		"uint64",
-		"float32",
-		"float64",
-		"string",
-		"pointer",
-		"color32",
-		"vector",
-		"vector2d",
-		"vector4d",
-		"rotation_vector",
-		"quaternion",
-		"qangle",
-		"matrix3x4",
-		"transform",
-		"string_token",
-		"ehandle",
-		nullptr
-	};
-
 	KV3SubType_t subtype = GetSubType();
 
 	if ( subtype < KV3_SUBTYPE_COUNT )
-		return s_SubTypes[subtype];
+		return s_pszKV3SubTypes[subtype];
 
 	return "<unknown>";
 }
 
+KV3Type_t KeyValues3::GetTypeFromString( const char *pszType )
+{
+	static constexpr auto s_Table = MakePerfectHash( s_pszKV3Types );
+	int nType = s_Table.Find( pszType );
+
+	return nType < 0 ? KV3_TYPE_INVALID : ( KV3Type_t )nType;
+}
+
+KV3SubType_t KeyValues3::GetSubTypeFromString( const char *pszSubType )
+{
+	static constexpr auto s_Table = MakePerfectHash( s_pszKV3SubTypes );
+	int nSubType = s_Table.Find( pszSubType );
+
+	return nSubType < 0 ? KV3_SUBTYPE_INVALID : ( KV3SubType_t )nSubType;
+}
+
 const char* KeyValues3::ToString( CBufferString& buff, uint flags ) const
 {
 	if ( ( flags & KV3_TO_STRING_DONT_CLEAR_BUFF ) != 0 )
@@ -60,6 +60,20 @@
 // Enable to do pathmatch caching. Beware: this code isn't threadsafe.
 // #define DO_PATHMATCH_CACHE
 
+// Keep a casefolded index of every directory Descend() has to search, so resolving a
+// mismatched component is a lookup instead of a readdir of the whole directory.
+// Indexes are revalidated against the directory mtime and are safe to use from any thread.
+#ifndef NO_PATHMATCH_DIRINDEX
+#define DO_PATHMATCH_DIRINDEX
+#endif
+
+#ifdef DO_PATHMATCH_DIRINDEX
+#include <pthread.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#endif
+
 #ifdef UTF8_PATHMATCH
 #define strcasecmp utf8casecmp
 #endif
@@ -369,6 +383,139 @@ private:
     char m_c;
 };
 
+#ifdef DO_PATHMATCH_DIRINDEX
+// Casefolded form of a path component. Uses the same folding as the comparison
+// Descend() would otherwise do per entry (utf8casecmp or strcasecmp).
+static void FoldPathComponent( const char *str, std::u32string &key )
+{
+	key.clear();
+	while (*str)
+	{
+		const char ch = *str;
+#ifdef UTF8_PATHMATCH
+		if (ch & 0x80)  // same walk as fold_utf8, minus the allocation
+		{
+			uint32_t fold[3];
+			locate_case_fold_mapping(utf8codepoint(&str), fold);
+			key.push_back(fold[0]);
+			if (fold[1])
+			{
+				key.push_back(fold[1]);
+				if (fold[2])
+					key.push_back(fold[2]);
+			}
+			continue;
+		}
+#endif
+		key.push_back( (uint32_t) tolower( (unsigned char) ch ) );
+		str++;
+	}
+}
+
+// Everything in one directory, keyed by casefolded name. Only valid for as long as the
+// directory is the same inode with the same mtime it had when the entries were read.
+struct PathDirIndex_t
+{
+	dev_t m_nDev;
+	ino_t m_nIno;
+	struct timespec m_mtime;
+
+	// casefolded name -> every real name that folds to it, in readdir order
+	std::unordered_map<std::u32string, std::vector<std::string> > m_mapNames;
+};
+
+typedef std::shared_ptr<const PathDirIndex_t> PathDirIndexPtr_t;
+
+// Lookups share the lock and hold their own reference to an index, so a directory
+// being re-indexed on one thread never pulls the entries out from under another.
+static pthread_rwlock_t s_DirIndexLock = PTHREAD_RWLOCK_INITIALIZER;
+static const size_t k_cMaxDirIndexes = 8192;
+
+typedef std::unordered_map<std::string, PathDirIndexPtr_t> DirIndexMap_t;
+
+// Wrapped calls can come from other static constructors and destructors, so the
+// map is created on first use and never destroyed. Statics have no guard in this
+// build, the once makes sure threads doing their first lookup together share one map.
+static pthread_once_t s_DirIndexMapOnce = PTHREAD_ONCE_INIT;
+static DirIndexMap_t *s_pDirIndexMap;
+
+static void CreateDirIndexMap()
+{
+	s_pDirIndexMap = new DirIndexMap_t;
+}
+
+static DirIndexMap_t &GetDirIndexMap()
+{
+	pthread_once( &s_DirIndexMapOnce, CreateDirIndexMap );
+	return *s_pDirIndexMap;
+}
+
+// Directory timestamps can be as coarse as 2 seconds (and are a timer tick at best),
+// so a change landing right after our readdir may leave the mtime untouched. An index
+// of a directory modified that recently is used once and then thrown away.
+static const time_t k_cDirIndexRacySeconds = 2;
+
+static PathDirIndexPtr_t GetDirIndex( const char *pszDir )
+{
+	// not the wrapped stat, pszDir is a path we've already matched
+	struct stat st;
+	if ( fstatat( AT_FDCWD, pszDir, &st, 0 ) != 0 || !S_ISDIR( st.st_mode ) )
+		return PathDirIndexPtr_t();
+
+	// the key can be relative, the inode check below catches a chdir() in between
+	std::string sDir( pszDir );
+
+	DirIndexMap_t &mapDirIndex = GetDirIndexMap();
+
+	pthread_rwlock_rdlock( &s_DirIndexLock );
+	DirIndexMap_t::const_iterator it = mapDirIndex.find( sDir );
+	PathDirIndexPtr_t pCached = ( it != mapDirIndex.end() ) ? it->second : PathDirIndexPtr_t();
+	pthread_rwlock_unlock( &s_DirIndexLock );
+
+	if ( pCached && pCached->m_nDev == st.st_dev && pCached->m_nIno == st.st_ino &&
+		 pCached->m_mtime.tv_sec == st.st_mtim.tv_sec && pCached->m_mtime.tv_nsec == st.st_mtim.tv_nsec )
+	{
+		return pCached;
+	}
+
+	// (re)build without holding the lock, threads racing on the same directory just build it twice
+	CDirPtr spDir( __real_opendir( pszDir ) );
+	if ( !spDir )
+		return PathDirIndexPtr_t();
+
+	std::shared_ptr<PathDirIndex_t> pIndex = std::make_shared<PathDirIndex_t>();
+	pIndex->m_nDev = st.st_dev;
+	pIndex->m_nIno = st.st_ino;
+	pIndex->m_mtime = st.st_mtim;
+
+	std::u32string key;
+	struct dirent *pEntry;
+	while ( ( pEntry = readdir( spDir ) ) != NULL )
+	{
+		if ( !strcmp( pEntry->d_name, "." ) || !strcmp( pEntry->d_name, ".." ) )
+			continue;
+
+		FoldPathComponent( pEntry->d_name, key );
+		pIndex->m_mapNames[key].push_back( pEntry->d_name );
+	}
+
+	DEBUG_MSG( "Indexed '%s' (%zu names)\n", pszDir, pIndex->m_mapNames.size() );
+
+	struct timespec now;
+	clock_gettime( CLOCK_REALTIME, &now );
+	if ( now.tv_sec - st.st_mtim.tv_sec <= k_cDirIndexRacySeconds )
+		return pIndex;
+
+	pthread_rwlock_wrlock( &s_DirIndexLock );
+	if ( mapDirIndex.size() >= k_cMaxDirIndexes )
+		mapDirIndex.clear();
+	mapDirIndex[sDir] = pIndex;
+	pthread_rwlock_unlock( &s_DirIndexLock );
+
+	return pIndex;
+}
+#endif // DO_PATHMATCH_DIRINDEX
+
 
 enum PathMod_t
 {
@@ -400,8 +547,60 @@ static bool Descend( char *pPath, size_t nStartIdx, bool bAllowBasenameMismatch,
 	if ( pPath[nNextSlash] == '/' )
 		bIsDir = true;
 
+	// Work out which directory to look in; pPath[0, nDirIdx) names it when nDirIdx isn't 0
+	size_t nDirIdx = nStartIdx;
+	const char *pRoot = ".";
+	if ( nStartIdx )
+	{
+		// we have a path
+		nStartIdx++;
+	}
+	else if ( *pPath == '/' )
+	{
+		// we either start at root or cwd
+		pRoot = "/";
+		nStartIdx++;
+	}
+
+    char *pszComponent = pPath + nStartIdx;
+    size_t cbComponent = nNextSlash - nStartIdx;
+
+#ifdef DO_PATHMATCH_DIRINDEX
+	// With an index of the directory, the immediate match and the case-insensitive
+	// candidates both come from it and the only syscall is the stat validating it.
+	// "." and ".." aren't indexed, and an empty component is a doubled slash.
+	PathDirIndexPtr_t pIndex;
+	std::unordered_map<std::u32string, std::vector<std::string> >::const_iterator itFolded;
+	bool bIndexable = cbComponent && strncmp( pszComponent, ".", cbComponent ) != 0 && strncmp( pszComponent, "..", cbComponent ) != 0;
+	if ( bIndexable )
+		pIndex = nDirIdx ? GetDirIndex( CDirTrimmer( pPath, nDirIdx ) ) : GetDirIndex( pRoot );
+
+	bool bImmediateMatch = false;
+	if ( pIndex )
+	{
+		std::u32string key;
+		FoldPathComponent( CDirTrimmer( pszComponent, cbComponent ), key );
+
+		itFolded = pIndex->m_mapNames.find( key );
+		if ( itFolded != pIndex->m_mapNames.end() )
+		{
+			for ( size_t i = 0; i < itFolded->second.size() && !bImmediateMatch; i++ )
+			{
+				const std::string &sName = itFolded->second[i];
+				bImmediateMatch = sName.length() == cbComponent && memcmp( sName.data(), pszComponent, cbComponent ) == 0;
+			}
+		}
+	}
+	else
+	{
+		bImmediateMatch = __real_access( CDirTrimmer(pPath, nNextSlash), F_OK ) == 0;
+	}
+#else
+	bool bImmediateMatch = __real_access( CDirTrimmer(pPath, nNextSlash), F_OK ) == 0;
+#endif
+
 	// See if we have an immediate match
-	if ( __real_access( CDirTrimmer(pPath, nNextSlash), F_OK ) == 0 )
+	if ( bImmediateMatch )
 	{
 		if ( !bIsDir )
 			return true;
@@ -411,60 +610,72 @@ static bool Descend( char *pPath, size_t nStartIdx, bool bAllowBasenameMismatch,
 			return true;
 	}
 
-	// Start enumerating dirents
-	CDirPtr spDir;
-	if ( nStartIdx )
+#ifdef DO_PATHMATCH_DIRINDEX
+	if ( pIndex )
 	{
-		// we have a path
-		spDir = __real_opendir( CDirTrimmer( pPath, nStartIdx ) );
-		nStartIdx++;
+		if ( itFolded != pIndex->m_mapNames.end() )
+		{
+			for ( size_t i = 0; i < itFolded->second.size(); i++ )
+			{
+				const std::string &sName = itFolded->second[i];
+
+				// the case-identical name was already tried above, and a name that folds
+				// to a different length can't be copied over the component in place
+				if ( sName.length() != cbComponent || memcmp( sName.data(), pszComponent, cbComponent ) == 0 )
+					continue;
+
+				DEBUG_MSG( "\t(%zu) indexed match %s\n", nLevel, sName.c_str() );
+				memcpy( pszComponent, sName.data(), cbComponent );
+
+				if ( !bIsDir )
+					return true;
+
+				if ( Descend( pPath, nNextSlash, bAllowBasenameMismatch, nLevel+1 ) )
+					return true;
+
+				// If descend fails, try more directories
+			}
+		}
 	}
 	else
+#endif // DO_PATHMATCH_DIRINDEX
 	{
-		// we either start at root or cwd
-		const char *pRoot = ".";
-		if ( *pPath == '/' )
+		// Start enumerating dirents
+		CDirPtr spDir( __real_opendir( nDirIdx ? (const char *)CDirTrimmer( pPath, nDirIdx ) : pRoot ) );
+
+		errno = 0;
+		struct dirent *pEntry = spDir ? readdir( spDir ) : NULL;
+		while ( pEntry )
 		{
-		    pRoot = "/";
-		    nStartIdx++;
+			DEBUG_MSG( "\t(%zu) comparing %s with %s\n", nLevel, pEntry->d_name, (const char *)CDirTrimmer(pszComponent, cbComponent) );
+
+			// the candidate must match the target, but not be a case-identical match (we would
+			// have looked there in the short-circuit code above, so don't look again)
+			bool bMatches = ( strcasecmp( CDirTrimmer(pszComponent, cbComponent), pEntry->d_name ) == 0 &&
+							  strcmp( CDirTrimmer(pszComponent, cbComponent), pEntry->d_name ) != 0 );
+
+			if ( bMatches )
+			{
+				char *pSrc = pEntry->d_name;
+				char *pDst = &pPath[nStartIdx];
+				// found a match; copy it in.
+				while ( *pSrc && (*pSrc != '/') )
+				{
+					*pDst++ = *pSrc++;
+				}
+
+				if ( !bIsDir )
+					return true;
+
+				if ( Descend( pPath, nNextSlash, bAllowBasenameMismatch, nLevel+1 ) )
+					return true;
+
+				// If descend fails, try more directories
+			}
+			pEntry = readdir( spDir );
 		}
-		spDir = __real_opendir( pRoot );
 	}
 
-    errno = 0;
-    struct dirent *pEntry = spDir ? readdir( spDir ) : NULL;
-    char *pszComponent = pPath + nStartIdx;
-    size_t cbComponent = nNextSlash - nStartIdx;
-    while ( pEntry )
-    {
-        DEBUG_MSG( "\t(%zu) comparing %s with %s\n", nLevel, pEntry->d_name, (const char *)CDirTrimmer(pszComponent, cbComponent) );
-
-        // the candidate must match the target, but not be a case-identical match (we would
-        // have looked there in the short-circuit code above, so don't look again)
-        bool bMatches = ( strcasecmp( CDirTrimmer(pszComponent, cbComponent), pEntry->d_name ) == 0 &&
-                          strcmp( CDirTrimmer(pszComponent, cbComponent), pEntry->d_name ) != 0 );
-
-        if ( bMatches )
-        {
-            char *pSrc = pEntry->d_name;
-            char *pDst = &pPath[nStartIdx];
-            // found a match; copy it in.
-            while ( *pSrc && (*pSrc != '/') )
-            {
-                *pDst++ = *pSrc++;
-            }
-
-            if ( !bIsDir )
-                return true;
-
-            if ( Descend( pPath, nNextSlash, bAllowBasenameMismatch, nLevel+1 ) )
-                return true;
-
-            // If descend fails, try more directories
-        }
-        pEntry = readdir( spDir );
-    }
-
     if ( bIsDir )
     {
         DEBUG_MSG( "(%zu) readdir failed to find '%s' in '%s'\n", nLevel, (const char *)CDirTrimmer(pszComponent, cbComponent), (const char *)CDirTrimmer( pPath, nStartIdx ) );
@@ -7,8 +7,14 @@
 //=============================================================================//
 
 #if defined( POSIX )
+#include "tier0/platform.h"
+#include "processor_detect_linux.cpp"
 #else // POSIX
 
+#if defined( _WIN32 ) && !defined( _X360 )
+#include <intrin.h>
+#endif
+
 // NOTE: This has to be the last file included!
 #include "tier0/memdbgon.h"
 
@@ -19,6 +25,7 @@ bool CheckMMXTechnology(void) { return false; }
 bool CheckSSETechnology(void) { return false; }
 bool CheckSSE2Technology(void) { return false; }
 bool Check3DNowTechnology(void) { return false; }
+bool CheckAVX2Technology(void) { return false; }
 
 #elif defined( _M_X64 )
 
@@ -287,4 +294,29 @@ bool Check3DNowTechnology(void)
 
 #endif // _WIN32
 
+#if defined( _WIN32 ) && !defined( _X360 )
+
+// AVX2 and FMA3 together, and the OS saving the YMM registers on context switches
+bool CheckAVX2Technology(void)
+{
+	int info[4];
+
+	__cpuid( info, 0 );
+	if ( info[0] < 7 )
+		return false;
+
+	// FMA (bit 12), OSXSAVE (bit 27) and AVX (bit 28)
+	__cpuid( info, 1 );
+	if ( ( info[2] & 0x18001000 ) != 0x18001000 )
+		return false;
+
+	if ( ( _xgetbv( 0 ) & 6 ) != 6 )
+		return false;
+
+	__cpuidex( info, 7, 0 );
+	return ( info[1] & 0x20 ) != 0;
+}
+
+#endif // _WIN32
+
 #endif // POSIX
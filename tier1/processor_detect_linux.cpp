@@ -41,6 +41,33 @@ static void cpuid(uint32 function, uint32& out_eax, uint32& out_ebx, uint32& out
 #endif
 }
 
+static void cpuid(uint32 function, uint32 subfunction, uint32& out_eax, uint32& out_ebx, uint32& out_ecx, uint32& out_edx)
+{
+#if defined(PLATFORM_64BITS)
+	asm("mov %%rbx, %%rsi\n\t"
+		"cpuid\n\t"
+		"xchg %%rsi, %%rbx"
+		: "=a" (out_eax),
+		  "=S" (out_ebx),
+		  "=c" (out_ecx),
+		  "=d" (out_edx)
+		: "a" (function),
+		  "c" (subfunction)
+	);
+#else
+	asm("mov %%ebx, %%esi\n\t"
+		"cpuid\n\t"
+		"xchg %%esi, %%ebx"
+		: "=a" (out_eax),
+		  "=S" (out_ebx),
+		  "=c" (out_ecx),
+		  "=d" (out_edx)
+		: "a" (function),
+		  "c" (subfunction)
+	);
+#endif
+}
+
 bool CheckMMXTechnology(void)
 {
     uint32 eax,ebx,edx,unused;
@@ -78,3 +105,25 @@ bool Check3DNowTechnology(void)
     return false;
 }
 
+// AVX2 and FMA3 together, and the OS saving the YMM registers on context switches
+bool CheckAVX2Technology(void)
+{
+	uint32 eax,ebx,ecx,edx;
+	cpuid(0,eax,ebx,ecx,edx);
+
+	if ( eax < 7 )
+		return false;
+
+	// FMA (bit 12), OSXSAVE (bit 27) and AVX (bit 28)
+	cpuid(1,eax,ebx,ecx,edx);
+	if ( ( ecx & 0x18001000 ) != 0x18001000 )
+		return false;
+
+	uint32 xcr0_lo, xcr0_hi;
+	asm("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+	if ( ( xcr0_lo & 6 ) != 6 )
+		return false;
+
+	cpuid(7,0,eax,ebx,ecx,edx);
+	return ebx & 0x20;
+}
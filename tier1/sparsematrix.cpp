@@ -3,10 +3,30 @@
 //===========================================================================//
 
 #include "tier1/sparsematrix.h"
+#include "tier1/threadtools.h"
+#include "mathlib/ssemath.h"
+
+#include <stdlib.h>
 
 // memdbgon must be the last include file in a .cpp file!!!
 #include "tier0/memdbgon.h"
 
+// Below this many non-zeros a product isn't worth starting threads for
+static const int s_nMinParallelNonZeros = 65536;
+
+// Each thread takes this many row ranges on average, so uneven rows even out
+static const int s_nRowChunksPerThread = 4;
+
+// How far ahead MultiplyVector fetches the vector elements it is going to read. The columns can
+// be anywhere, so the hardware prefetcher can't guess them.
+static const int s_nVectorPrefetchDistance = 64;
+
+// Rows up to this long are sorted by insertion rather than qsort in SetFromTriplets
+static const int s_nInsertionSortMaxRow = 16;
+
+// tier1 doesn't link mathlib, so this can't read Four_Zeros
+#define SPARSE_ZERO ReplicateX4( 0.0f )
+
 
 void CSparseMatrix::AdjustAllRowIndicesAfter( int nStartRow, int nDelta )
 {
@@ -135,7 +155,359 @@ void CSparseMatrix::AppendElement( int nRow, int nColumn, float flValue )
 		m_entries.AddToTail( newDesc );
 	}
 }
-	
-	
 
 
+static int CompareNonZeroColumns( const void *pLeft, const void *pRight )
+{
+	int nLeft = static_cast<CSparseMatrix::NonZeroValueDescriptor_t const *>( pLeft )->m_nColumnNumber;
+	int nRight = static_cast<CSparseMatrix::NonZeroValueDescriptor_t const *>( pRight )->m_nColumnNumber;
+	return ( nLeft > nRight ) - ( nLeft < nRight );
+}
+
+void CSparseMatrix::SetFromTriplets( int nNumRows, int nNumCols, Triplet_t const *pTriplets, int nCount )
+{
+	SetDimensions( nNumRows, nNumCols );
+
+	// bucket the triplets by row: count, then turn the counts into starting positions
+	for( int i = 0; i < nCount; i++ )
+	{
+		Assert( pTriplets[i].m_nRow >= 0 && pTriplets[i].m_nRow < nNumRows );
+		Assert( pTriplets[i].m_nColumnNumber >= 0 && pTriplets[i].m_nColumnNumber < nNumCols );
+		m_rowDescriptors[pTriplets[i].m_nRow].m_nNonZeroCount++;
+	}
+	int nDataIndex = 0;
+	for( int i = 0; i < nNumRows; i++ )
+	{
+		m_rowDescriptors[i].m_nDataIndex = nDataIndex;
+		nDataIndex += m_rowDescriptors[i].m_nNonZeroCount;
+		m_rowDescriptors[i].m_nNonZeroCount = 0;
+	}
+	m_entries.SetCount( nCount );
+	for( int i = 0; i < nCount; i++ )
+	{
+		RowDescriptor_t &row = m_rowDescriptors[pTriplets[i].m_nRow];
+		NonZeroValueDescriptor_t &entry = m_entries[row.m_nDataIndex + row.m_nNonZeroCount++];
+		entry.m_nColumnNumber = pTriplets[i].m_nColumnNumber;
+		entry.m_flValue = pTriplets[i].m_flValue;
+	}
+
+	// now sort each row by column and pack it down, summing duplicates and dropping zeros
+	NonZeroValueDescriptor_t *pEntries = m_entries.Base();
+	int nWriteIndex = 0;
+	for( int i = 0; i < nNumRows; i++ )
+	{
+		RowDescriptor_t &row = m_rowDescriptors[i];
+		NonZeroValueDescriptor_t *pRow = pEntries + row.m_nDataIndex;
+		int nRowCount = row.m_nNonZeroCount;
+		if ( nRowCount > s_nInsertionSortMaxRow )
+		{
+			qsort( pRow, nRowCount, sizeof( NonZeroValueDescriptor_t ), CompareNonZeroColumns );
+		}
+		else
+		{
+			for( int j = 1; j < nRowCount; j++ )
+			{
+				NonZeroValueDescriptor_t value = pRow[j];
+				int k = j;
+				for( ; k > 0 && pRow[k - 1].m_nColumnNumber > value.m_nColumnNumber; k-- )
+				{
+					pRow[k] = pRow[k - 1];
+				}
+				pRow[k] = value;
+			}
+		}
+
+		row.m_nDataIndex = nWriteIndex;
+		for( int j = 0; j < nRowCount; )
+		{
+			NonZeroValueDescriptor_t value = pRow[j];
+			while( ++j < nRowCount && pRow[j].m_nColumnNumber == value.m_nColumnNumber )
+			{
+				value.m_flValue += pRow[j].m_flValue;
+			}
+			if ( value.m_flValue != 0.0 )
+			{
+				pEntries[nWriteIndex++] = value;					// never ahead of the read position
+			}
+		}
+		row.m_nNonZeroCount = nWriteIndex - row.m_nDataIndex;
+	}
+	m_entries.SetCountNonDestructively( nWriteIndex );
+	m_nHighestRowAppendedTo = nNumRows - 1;
+}
+
+
+//-----------------------------------------------------------------------------
+// Products. Each row of the output only depends on the same row of the matrix,
+// so the rows are cut into ranges with about the same amount of work and
+// handed out to the threads from a shared counter.
+//-----------------------------------------------------------------------------
+class CSparseMatrixProduct
+{
+public:
+	typedef void ( *RowRangeFunc_t )( CSparseMatrixProduct const &product, int nFirstRow, int nEndRow );
+
+	CSparseMatrixProduct( CSparseMatrix const &matrix, float const *pIn, int nColumns, float *pOut, RowRangeFunc_t pfnRows ) :
+		m_Matrix( matrix ), m_pIn( pIn ), m_nColumns( nColumns ), m_pOut( pOut ), m_pfnRows( pfnRows ), m_nNextChunk( 0 )
+	{
+	}
+
+	void Run( int nThreads );
+
+	CSparseMatrix const &m_Matrix;
+	float const *m_pIn;
+	int m_nColumns;
+	float *m_pOut;
+
+private:
+	void RunChunks();
+	static uintp ThreadFunc( void *pParam );
+
+	RowRangeFunc_t m_pfnRows;
+	CUtlVectorFixedGrowable< int, 65 > m_ChunkStarts;		// one past the end, so chunk i is [m_ChunkStarts[i], m_ChunkStarts[i+1])
+	int32 volatile m_nNextChunk;
+};
+
+void CSparseMatrixProduct::RunChunks()
+{
+	for ( ;; )
+	{
+		int nChunk = ThreadInterlockedIncrement( &m_nNextChunk ) - 1;
+		if ( nChunk >= m_ChunkStarts.Count() - 1 )
+			break;
+
+		m_pfnRows( *this, m_ChunkStarts[nChunk], m_ChunkStarts[nChunk + 1] );
+	}
+}
+
+uintp CSparseMatrixProduct::ThreadFunc( void *pParam )
+{
+	( ( CSparseMatrixProduct * )pParam )->RunChunks();
+	return 0;
+}
+
+void CSparseMatrixProduct::Run( int nThreads )
+{
+	int nNumRows = m_Matrix.Height();
+	if ( nThreads <= 1 || m_Matrix.NonZeroCount() < s_nMinParallelNonZeros )
+	{
+		m_pfnRows( *this, 0, nNumRows );
+		return;
+	}
+
+	// a row costs its non-zeros plus a bit for the row itself
+	int nChunks = nThreads * s_nRowChunksPerThread;
+	int64 nTotalWork = int64( m_Matrix.NonZeroCount() ) + nNumRows;
+	int64 nWork = 0;
+	m_ChunkStarts.AddToTail( 0 );
+	for( int i = 0; i < nNumRows; i++ )
+	{
+		nWork += m_Matrix.m_rowDescriptors[i].m_nNonZeroCount + 1;
+		if ( nWork * nChunks >= nTotalWork * m_ChunkStarts.Count() )
+		{
+			m_ChunkStarts.AddToTail( i + 1 );
+		}
+	}
+	if ( m_ChunkStarts.Tail() != nNumRows )
+	{
+		m_ChunkStarts.AddToTail( nNumRows );
+	}
+
+	RunOnSimpleThreads( MIN( nThreads, m_ChunkStarts.Count() - 1 ), ThreadFunc, this );
+}
+
+static FORCEINLINE void PrefetchVectorElements( float const *pVector, CSparseMatrix::NonZeroValueDescriptor_t const *pEntry )
+{
+	_mm_prefetch( ( const char * )&pVector[pEntry[0].m_nColumnNumber], _MM_HINT_T0 );
+	_mm_prefetch( ( const char * )&pVector[pEntry[1].m_nColumnNumber], _MM_HINT_T0 );
+	_mm_prefetch( ( const char * )&pVector[pEntry[2].m_nColumnNumber], _MM_HINT_T0 );
+	_mm_prefetch( ( const char * )&pVector[pEntry[3].m_nColumnNumber], _MM_HINT_T0 );
+}
+
+// Four non-zeros at a time into four separate sums, so the loads of the vector don't wait on
+// each other. Gathering them into a fltx4 instead costs more than the multiplies it saves.
+static void MultiplyVectorRows( CSparseMatrixProduct const &product, int nFirstRow, int nEndRow )
+{
+	CSparseMatrix const &matrix = product.m_Matrix;
+	float const *pVector = product.m_pIn;
+	CSparseMatrix::NonZeroValueDescriptor_t const *pPrefetchEnd = matrix.m_entries.Base() + matrix.m_entries.Count() - s_nVectorPrefetchDistance - 4;
+	for( int i = nFirstRow; i < nEndRow; i++ )
+	{
+		int nCount = matrix.m_rowDescriptors[i].m_nNonZeroCount;
+		CSparseMatrix::NonZeroValueDescriptor_t const *pEntry = matrix.m_entries.Base() + matrix.m_rowDescriptors[i].m_nDataIndex;
+		float flSum0 = 0, flSum1 = 0, flSum2 = 0, flSum3 = 0;
+		for( ; nCount >= 4; nCount -= 4, pEntry += 4 )
+		{
+			if ( pEntry <= pPrefetchEnd )
+			{
+				PrefetchVectorElements( pVector, pEntry + s_nVectorPrefetchDistance );
+			}
+			flSum0 += pEntry[0].m_flValue * pVector[pEntry[0].m_nColumnNumber];
+			flSum1 += pEntry[1].m_flValue * pVector[pEntry[1].m_nColumnNumber];
+			flSum2 += pEntry[2].m_flValue * pVector[pEntry[2].m_nColumnNumber];
+			flSum3 += pEntry[3].m_flValue * pVector[pEntry[3].m_nColumnNumber];
+		}
+		float flDot = ( flSum0 + flSum2 ) + ( flSum1 + flSum3 );
+		for( ; nCount > 0; nCount--, pEntry++ )
+		{
+			flDot += pEntry->m_flValue * pVector[pEntry->m_nColumnNumber];
+		}
+		product.m_pOut[i] = flDot;
+	}
+}
+
+// Each non-zero scales a whole row of the dense matrix, so this goes four output columns at a
+// time, sixteen while there are enough of them to keep four sums in registers
+static void MultiplyDenseRows( CSparseMatrixProduct const &product, int nFirstRow, int nEndRow )
+{
+	CSparseMatrix const &matrix = product.m_Matrix;
+	int nColumns = product.m_nColumns;
+	for( int i = nFirstRow; i < nEndRow; i++ )
+	{
+		int nCount = matrix.m_rowDescriptors[i].m_nNonZeroCount;
+		CSparseMatrix::NonZeroValueDescriptor_t const *pRow = matrix.m_entries.Base() + matrix.m_rowDescriptors[i].m_nDataIndex;
+		float *pOut = product.m_pOut + size_t( i ) * nColumns;
+
+		int c = 0;
+		for( ; c + 16 <= nColumns; c += 16 )
+		{
+			fltx4 fl4Sum0 = SPARSE_ZERO, fl4Sum1 = SPARSE_ZERO, fl4Sum2 = SPARSE_ZERO, fl4Sum3 = SPARSE_ZERO;
+			for( int j = 0; j < nCount; j++ )
+			{
+				fltx4 fl4Value = ReplicateX4( pRow[j].m_flValue );
+				float const *pIn = product.m_pIn + size_t( pRow[j].m_nColumnNumber ) * nColumns + c;
+				fl4Sum0 = MaddSIMD( fl4Value, LoadUnalignedSIMD( pIn ), fl4Sum0 );
+				fl4Sum1 = MaddSIMD( fl4Value, LoadUnalignedSIMD( pIn + 4 ), fl4Sum1 );
+				fl4Sum2 = MaddSIMD( fl4Value, LoadUnalignedSIMD( pIn + 8 ), fl4Sum2 );
+				fl4Sum3 = MaddSIMD( fl4Value, LoadUnalignedSIMD( pIn + 12 ), fl4Sum3 );
+			}
+			StoreUnalignedSIMD( pOut + c, fl4Sum0 );
+			StoreUnalignedSIMD( pOut + c + 4, fl4Sum1 );
+			StoreUnalignedSIMD( pOut + c + 8, fl4Sum2 );
+			StoreUnalignedSIMD( pOut + c + 12, fl4Sum3 );
+		}
+		for( ; c + 4 <= nColumns; c += 4 )
+		{
+			fltx4 fl4Sum = SPARSE_ZERO;
+			for( int j = 0; j < nCount; j++ )
+			{
+				float const *pIn = product.m_pIn + size_t( pRow[j].m_nColumnNumber ) * nColumns + c;
+				fl4Sum = MaddSIMD( ReplicateX4( pRow[j].m_flValue ), LoadUnalignedSIMD( pIn ), fl4Sum );
+			}
+			StoreUnalignedSIMD( pOut + c, fl4Sum );
+		}
+		for( ; c < nColumns; c++ )
+		{
+			float flDot = 0;
+			for( int j = 0; j < nCount; j++ )
+			{
+				flDot += pRow[j].m_flValue * product.m_pIn[size_t( pRow[j].m_nColumnNumber ) * nColumns + c];
+			}
+			pOut[c] = flDot;
+		}
+	}
+}
+
+void CSparseMatrix::MultiplyVector( float const *pVector, float *pOut, int nThreads ) const
+{
+	Assert( pVector != pOut );
+	CSparseMatrixProduct product( *this, pVector, 1, pOut, MultiplyVectorRows );
+	product.Run( nThreads );
+}
+
+void CSparseMatrix::MultiplyDense( float const *pMatrix, int nColumns, float *pOut, int nThreads ) const
+{
+	Assert( pMatrix != pOut );
+	CSparseMatrixProduct product( *this, pMatrix, nColumns, pOut, MultiplyDenseRows );
+	product.Run( nThreads );
+}
+
+
+static double SparseDot( float const *pA, float const *pB, int nCount )
+{
+	double flSum = 0;
+	for( int i = 0; i < nCount; i++ )
+	{
+		flSum += double( pA[i] ) * pB[i];
+	}
+	return flSum;
+}
+
+int CSparseMatrix::SolveConjugateGradient( float const *pB, float *pX, int nMaxIterations, float flTolerance, int nThreads ) const
+{
+	Assert( m_nNumRows == m_nNumCols );
+	int nCount = m_nNumRows;
+
+	// the preconditioner is 1 / diagonal, or 1 where the diagonal isn't stored
+	CUtlVector<float> invDiagonal, residual, preconditioned, direction, product;
+	invDiagonal.SetCount( nCount );
+	residual.SetCount( nCount );
+	preconditioned.SetCount( nCount );
+	direction.SetCount( nCount );
+	product.SetCount( nCount );
+	for( int i = 0; i < nCount; i++ )
+	{
+		float flDiagonal = Element( i, i );
+		invDiagonal[i] = ( flDiagonal != 0.0f ) ? 1.0f / flDiagonal : 1.0f;
+	}
+
+	double flThresholdSqr = double( flTolerance ) * flTolerance * SparseDot( pB, pB, nCount );
+
+	MultiplyVector( pX, residual.Base(), nThreads );
+	for( int i = 0; i < nCount; i++ )
+	{
+		residual[i] = pB[i] - residual[i];
+		preconditioned[i] = invDiagonal[i] * residual[i];
+		direction[i] = preconditioned[i];
+	}
+	double flResidualDot = SparseDot( residual.Base(), preconditioned.Base(), nCount );
+
+	for( int nIteration = 0; ; nIteration++ )
+	{
+		if ( SparseDot( residual.Base(), residual.Base(), nCount ) <= flThresholdSqr )
+		{
+			return nIteration;
+		}
+		if ( nIteration == nMaxIterations )
+		{
+			return -1;
+		}
+
+		MultiplyVector( direction.Base(), product.Base(), nThreads );
+		double flCurvature = SparseDot( direction.Base(), product.Base(), nCount );
+		if ( flCurvature <= 0.0 )
+		{
+			// either converged exactly or the matrix isn't positive definite
+			return ( flResidualDot == 0.0 ) ? nIteration : -1;
+		}
+
+		float flAlpha = float( flResidualDot / flCurvature );
+		for( int i = 0; i < nCount; i++ )
+		{
+			pX[i] += flAlpha * direction[i];
+			residual[i] -= flAlpha * product[i];
+			preconditioned[i] = invDiagonal[i] * residual[i];
+		}
+
+		double flNewResidualDot = SparseDot( residual.Base(), preconditioned.Base(), nCount );
+		float flBeta = float( flNewResidualDot / flResidualDot );
+		flResidualDot = flNewResidualDot;
+		for( int i = 0; i < nCount; i++ )
+		{
+			direction[i] = preconditioned[i] + flBeta * direction[i];
+		}
+	}
+}
+
+
+void CSparseMatrixBuilder::SetDimensions( int nNumRows, int nNumCols )
+{
+	m_nNumRows = nNumRows;
+	m_nNumCols = nNumCols;
+	m_triplets.RemoveAll();
+}
+
+void CSparseMatrixBuilder::Build( CSparseMatrix *pMatrix ) const
+{
+	pMatrix->SetFromTriplets( m_nNumRows, m_nNumCols, m_triplets.Base(), m_triplets.Count() );
+}
@@ -0,0 +1,577 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: SSE2/AVX2 versions of the hot V_ string functions
+//
+//=============================================================================//
+
+#include "tier1/strtools_simd.h"
+
+#include <string.h>
+
+#if !defined( PLATFORM_PPC ) && ( defined( _M_X64 ) || defined( _M_IX86 ) || defined( __x86_64__ ) || defined( __i386__ ) )
+#define STRTOOLS_SIMD 1
+#else
+#define STRTOOLS_SIMD 0
+#endif
+
+#if STRTOOLS_SIMD
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include "tier1/processor_detect.h"
+#endif
+
+// memdbgon must be the last include file in a .cpp file!!!
+#include "tier0/memdbgon.h"
+
+namespace // internal use only
+{
+	inline uint8 V_StrFold( uint8 c )
+	{
+		return ( uint8 )( c - 'A' ) < 26 ? ( c | 0x20 ) : c;
+	}
+
+	template< bool FOLD >
+	inline bool V_StrMatchN( const char *s1, const char *s2, int n )
+	{
+		if ( !FOLD )
+			return !memcmp( s1, s2, n );
+
+		for ( int i = 0; i < n; i++ )
+		{
+			if ( V_StrFold( s1[i] ) != V_StrFold( s2[i] ) )
+				return false;
+		}
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------------
+	// Scalar, level 0 and the tails of the SIMD loops
+	//-----------------------------------------------------------------------------
+	int V_strlen_Scalar( const char *pStr )
+	{
+		const char *p = pStr;
+		while ( *p )
+			p++;
+
+		return ( int )( p - pStr );
+	}
+
+	int V_strnicmp_Scalar( const char *s1, const char *s2, int n )
+	{
+		for ( ; n; n-- )
+		{
+			uint8 c1 = V_StrFold( *s1++ );
+			uint8 c2 = V_StrFold( *s2++ );
+			if ( c1 != c2 )
+				return c1 - c2;
+
+			if ( !c1 )
+				break;
+		}
+
+		return 0;
+	}
+
+	template< bool FOLD >
+	const char *V_strstr_Scalar( const char *pStr, const char *pSearch )
+	{
+		if ( !*pSearch )
+			return pStr;
+
+		int nSearch = V_strlen_Scalar( pSearch );
+		uint8 cFirst = FOLD ? V_StrFold( *pSearch ) : *pSearch;
+		for ( ; *pStr; pStr++ )
+		{
+			uint8 c = FOLD ? V_StrFold( *pStr ) : *pStr;
+			if ( c == cFirst && !( FOLD ? V_strnicmp_Scalar( pStr + 1, pSearch + 1, nSearch - 1 ) : strncmp( pStr + 1, pSearch + 1, nSearch - 1 ) ) )
+				return pStr;
+		}
+
+		return NULL;
+	}
+
+	char *V_strlower_Scalar( char *pStart )
+	{
+		for ( char *p = pStart; *p; p++ )
+		{
+			*p = V_StrFold( *p );
+		}
+
+		return pStart;
+	}
+
+	int V_strtolower_Scalar( const char *pIn, char *pOut, int nOutSize )
+	{
+		int i = 0;
+		for ( ; i < nOutSize - 1 && pIn[i]; i++ )
+		{
+			pOut[i] = V_StrFold( pIn[i] );
+		}
+
+		pOut[i] = '\0';
+		return i;
+	}
+
+	int s_nStrSIMDLevel = -1;
+}
+
+#if STRTOOLS_SIMD
+
+// gcc and clang need the AVX2 path enabled per function, MSVC lets the intrinsics through.
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define STRTOOLS_AVX2_TARGET __attribute__(( target( "avx2" ) ))
+#define STRTOOLS_NO_SANITIZE __attribute__(( no_sanitize_address ))
+#else
+#define STRTOOLS_AVX2_TARGET
+#define STRTOOLS_NO_SANITIZE
+#endif
+
+namespace // internal use only
+{
+	inline int V_StrLowestBit( uint32 nMask )
+	{
+#ifdef _MSC_VER
+		unsigned long nIndex;
+		_BitScanForward( &nIndex, nMask );
+		return ( int )nIndex;
+#else
+		return __builtin_ctz( nMask );
+#endif
+	}
+
+	// Whether nBytes from p stay on p's page
+	inline bool V_StrCanLoad( const void *p, int nBytes )
+	{
+		return ( ( uintp )p & 4095 ) <= ( uintp )( 4096 - nBytes );
+	}
+
+	//-----------------------------------------------------------------------------
+	// SSE2, 16 bytes a step
+	//-----------------------------------------------------------------------------
+
+	// 'A'-'Z' get 0x20 or'd in: shifted so they're the 26 lowest signed bytes
+	inline __m128i V_StrFoldSSE2( __m128i v )
+	{
+		__m128i shifted = _mm_add_epi8( v, _mm_set1_epi8( ( char )( 0x80 - 'A' ) ) );
+		__m128i upper = _mm_cmplt_epi8( shifted, _mm_set1_epi8( ( char )( 0x80 + 26 ) ) );
+		return _mm_or_si128( v, _mm_and_si128( upper, _mm_set1_epi8( 0x20 ) ) );
+	}
+
+	inline uint32 V_StrZeroMaskSSE2( __m128i v )
+	{
+		return ( uint32 )_mm_movemask_epi8( _mm_cmpeq_epi8( v, _mm_setzero_si128() ) );
+	}
+
+	// Aligned loads, which can't cross a page
+	STRTOOLS_NO_SANITIZE int V_strlen_SSE2( const char *pStr )
+	{
+		const char *p = ( const char * )( ( uintp )pStr & ~( uintp )15 );
+		uint32 nMask = V_StrZeroMaskSSE2( _mm_load_si128( ( const __m128i * )p ) ) >> ( pStr - p );
+		if ( nMask )
+			return V_StrLowestBit( nMask );
+
+		for ( ;; )
+		{
+			p += 16;
+			nMask = V_StrZeroMaskSSE2( _mm_load_si128( ( const __m128i * )p ) );
+			if ( nMask )
+				return ( int )( p - pStr ) + V_StrLowestBit( nMask );
+		}
+	}
+
+	STRTOOLS_NO_SANITIZE int V_strnicmp_SSE2( const char *s1, const char *s2, int n )
+	{
+		while ( n )
+		{
+			if ( !V_StrCanLoad( s1, 16 ) || !V_StrCanLoad( s2, 16 ) )
+			{
+				// Byte by byte up to the page end
+				uint8 c1 = V_StrFold( *s1++ );
+				uint8 c2 = V_StrFold( *s2++ );
+				if ( c1 != c2 )
+					return c1 - c2;
+
+				if ( !c1 )
+					return 0;
+
+				if ( n > 0 )
+					n--;
+
+				continue;
+			}
+
+			__m128i a = _mm_loadu_si128( ( const __m128i * )s1 );
+			__m128i b = _mm_loadu_si128( ( const __m128i * )s2 );
+			uint32 nDiffer = ( uint32 )_mm_movemask_epi8( _mm_cmpeq_epi8( V_StrFoldSSE2( a ), V_StrFoldSSE2( b ) ) ) ^ 0xFFFF;
+			uint32 nStop = nDiffer | V_StrZeroMaskSSE2( a );
+			if ( n > 0 && n < 16 )
+			{
+				// A count short of a block only looks at its start
+				nStop &= ( 1u << n ) - 1;
+				if ( !nStop )
+					return 0;
+			}
+
+			if ( nStop )
+			{
+				int i = V_StrLowestBit( nStop );
+				return V_StrFold( s1[i] ) - V_StrFold( s2[i] );
+			}
+
+			s1 += 16;
+			s2 += 16;
+			if ( n > 0 )
+				n -= 16;
+		}
+
+		return 0;
+	}
+
+	STRTOOLS_NO_SANITIZE char *V_strlower_SSE2( char *pStart )
+	{
+		char *p = pStart;
+		for ( ;; )
+		{
+			if ( V_StrCanLoad( p, 16 ) )
+			{
+				__m128i v = _mm_loadu_si128( ( const __m128i * )p );
+				if ( !V_StrZeroMaskSSE2( v ) )
+				{
+					_mm_storeu_si128( ( __m128i * )p, V_StrFoldSSE2( v ) );
+					p += 16;
+					continue;
+				}
+			}
+
+			// The last block, or the bytes up to a page end
+			if ( !*p )
+				return pStart;
+
+			*p = V_StrFold( *p );
+			p++;
+		}
+	}
+
+	STRTOOLS_NO_SANITIZE int V_strtolower_SSE2( const char *pIn, char *pOut, int nOutSize )
+	{
+		int i = 0;
+		while ( i + 16 < nOutSize && V_StrCanLoad( pIn + i, 16 ) )
+		{
+			__m128i v = _mm_loadu_si128( ( const __m128i * )( pIn + i ) );
+			if ( V_StrZeroMaskSSE2( v ) )
+				break;
+
+			_mm_storeu_si128( ( __m128i * )( pOut + i ), V_StrFoldSSE2( v ) );
+			i += 16;
+		}
+
+		return i + V_strtolower_Scalar( pIn + i, pOut + i, nOutSize - i );
+	}
+
+	// Candidates are where the first and last characters of the search both
+	// match, 16 positions a step; only those get compared in full. Both lengths
+	// are known first, so the positions past the end can be masked off.
+	template< bool FOLD >
+	STRTOOLS_NO_SANITIZE const char *V_strstr_SSE2( const char *pStr, const char *pSearch )
+	{
+		int nSearch = V_strlen_SSE2( pSearch );
+		if ( !nSearch )
+			return pStr;
+
+		int nStr = V_strlen_SSE2( pStr );
+		if ( nStr < nSearch )
+			return NULL;
+
+		const __m128i first = _mm_set1_epi8( ( char )( FOLD ? V_StrFold( pSearch[0] ) : pSearch[0] ) );
+		const __m128i last = _mm_set1_epi8( ( char )( FOLD ? V_StrFold( pSearch[nSearch - 1] ) : pSearch[nSearch - 1] ) );
+
+		int i = 0;
+		for ( ; i <= nStr - nSearch; i += 16 )
+		{
+			// The last block reads past the terminator, which is fine up to the page end
+			bool bLastBlock = i + nSearch + 15 > nStr;
+			if ( bLastBlock && ( !V_StrCanLoad( pStr + i, 16 ) || !V_StrCanLoad( pStr + i + nSearch - 1, 16 ) ) )
+				break;
+
+			__m128i a = _mm_loadu_si128( ( const __m128i * )( pStr + i ) );
+			__m128i b = _mm_loadu_si128( ( const __m128i * )( pStr + i + nSearch - 1 ) );
+			if ( FOLD )
+			{
+				a = V_StrFoldSSE2( a );
+				b = V_StrFoldSSE2( b );
+			}
+
+			uint32 nMask = ( uint32 )_mm_movemask_epi8( _mm_and_si128( _mm_cmpeq_epi8( a, first ), _mm_cmpeq_epi8( b, last ) ) );
+			if ( bLastBlock )
+				nMask &= ( 1u << ( nStr - nSearch - i + 1 ) ) - 1;
+
+			while ( nMask )
+			{
+				int nAt = i + V_StrLowestBit( nMask );
+				if ( nSearch <= 2 || V_StrMatchN< FOLD >( pStr + nAt + 1, pSearch + 1, nSearch - 2 ) )
+					return pStr + nAt;
+
+				nMask &= nMask - 1;
+			}
+		}
+
+		const uint8 cFirst = FOLD ? V_StrFold( pSearch[0] ) : pSearch[0];
+		for ( ; i <= nStr - nSearch; i++ )
+		{
+			uint8 c = FOLD ? V_StrFold( pStr[i] ) : pStr[i];
+			if ( c == cFirst && V_StrMatchN< FOLD >( pStr + i + 1, pSearch + 1, nSearch - 1 ) )
+				return pStr + i;
+		}
+
+		return NULL;
+	}
+
+	//-----------------------------------------------------------------------------
+	// AVX2, 32 bytes a step; the same loops as SSE2. The tails are the SSE2
+	// functions, which aren't VEX encoded, so the upper halves are cleared first:
+	// gcc doesn't always, and the transition costs more than the whole string.
+	//-----------------------------------------------------------------------------
+	STRTOOLS_AVX2_TARGET inline __m256i V_StrFoldAVX2( __m256i v )
+	{
+		__m256i shifted = _mm256_add_epi8( v, _mm256_set1_epi8( ( char )( 0x80 - 'A' ) ) );
+		__m256i upper = _mm256_cmpgt_epi8( _mm256_set1_epi8( ( char )( 0x80 + 26 ) ), shifted );
+		return _mm256_or_si256( v, _mm256_and_si256( upper, _mm256_set1_epi8( 0x20 ) ) );
+	}
+
+	STRTOOLS_AVX2_TARGET inline uint32 V_StrZeroMaskAVX2( __m256i v )
+	{
+		return ( uint32 )_mm256_movemask_epi8( _mm256_cmpeq_epi8( v, _mm256_setzero_si256() ) );
+	}
+
+	STRTOOLS_AVX2_TARGET STRTOOLS_NO_SANITIZE int V_strlen_AVX2( const char *pStr )
+	{
+		const char *p = ( const char * )( ( uintp )pStr & ~( uintp )31 );
+		uint32 nMask = V_StrZeroMaskAVX2( _mm256_load_si256( ( const __m256i * )p ) ) >> ( pStr - p );
+		if ( nMask )
+			return V_StrLowestBit( nMask );
+
+		for ( ;; )
+		{
+			p += 32;
+			nMask = V_StrZeroMaskAVX2( _mm256_load_si256( ( const __m256i * )p ) );
+			if ( nMask )
+				return ( int )( p - pStr ) + V_StrLowestBit( nMask );
+		}
+	}
+
+	STRTOOLS_AVX2_TARGET STRTOOLS_NO_SANITIZE int V_strnicmp_AVX2( const char *s1, const char *s2, int n )
+	{
+		while ( n )
+		{
+			if ( !V_StrCanLoad( s1, 32 ) || !V_StrCanLoad( s2, 32 ) )
+			{
+				uint8 c1 = V_StrFold( *s1++ );
+				uint8 c2 = V_StrFold( *s2++ );
+				if ( c1 != c2 )
+					return c1 - c2;
+
+				if ( !c1 )
+					return 0;
+
+				if ( n > 0 )
+					n--;
+
+				continue;
+			}
+
+			__m256i a = _mm256_loadu_si256( ( const __m256i * )s1 );
+			__m256i b = _mm256_loadu_si256( ( const __m256i * )s2 );
+			uint32 nDiffer = ~( uint32 )_mm256_movemask_epi8( _mm256_cmpeq_epi8( V_StrFoldAVX2( a ), V_StrFoldAVX2( b ) ) );
+			uint32 nStop = nDiffer | V_StrZeroMaskAVX2( a );
+			if ( n > 0 && n < 32 )
+			{
+				// A count short of a block only looks at its start
+				nStop &= ( 1u << n ) - 1;
+				if ( !nStop )
+					return 0;
+			}
+
+			if ( nStop )
+			{
+				int i = V_StrLowestBit( nStop );
+				return V_StrFold( s1[i] ) - V_StrFold( s2[i] );
+			}
+
+			s1 += 32;
+			s2 += 32;
+			if ( n > 0 )
+				n -= 32;
+		}
+
+		return 0;
+	}
+
+	STRTOOLS_AVX2_TARGET STRTOOLS_NO_SANITIZE char *V_strlower_AVX2( char *pStart )
+	{
+		char *p = pStart;
+		while ( V_StrCanLoad( p, 32 ) )
+		{
+			__m256i v = _mm256_loadu_si256( ( const __m256i * )p );
+			if ( V_StrZeroMaskAVX2( v ) )
+				break;
+
+			_mm256_storeu_si256( ( __m256i * )p, V_StrFoldAVX2( v ) );
+			p += 32;
+		}
+
+		_mm256_zeroupper();
+		V_strlower_SSE2( p );
+		return pStart;
+	}
+
+	STRTOOLS_AVX2_TARGET STRTOOLS_NO_SANITIZE int V_strtolower_AVX2( const char *pIn, char *pOut, int nOutSize )
+	{
+		int i = 0;
+		while ( i + 32 < nOutSize && V_StrCanLoad( pIn + i, 32 ) )
+		{
+			__m256i v = _mm256_loadu_si256( ( const __m256i * )( pIn + i ) );
+			if ( V_StrZeroMaskAVX2( v ) )
+				break;
+
+			_mm256_storeu_si256( ( __m256i * )( pOut + i ), V_StrFoldAVX2( v ) );
+			i += 32;
+		}
+
+		_mm256_zeroupper();
+		return i + V_strtolower_SSE2( pIn + i, pOut + i, nOutSize - i );
+	}
+
+	template< bool FOLD >
+	STRTOOLS_AVX2_TARGET STRTOOLS_NO_SANITIZE const char *V_strstr_AVX2( const char *pStr, const char *pSearch )
+	{
+		int nSearch = V_strlen_AVX2( pSearch );
+		if ( !nSearch )
+			return pStr;
+
+		int nStr = V_strlen_AVX2( pStr );
+		if ( nStr < nSearch )
+			return NULL;
+
+		const __m256i first = _mm256_set1_epi8( ( char )( FOLD ? V_StrFold( pSearch[0] ) : pSearch[0] ) );
+		const __m256i last = _mm256_set1_epi8( ( char )( FOLD ? V_StrFold( pSearch[nSearch - 1] ) : pSearch[nSearch - 1] ) );
+
+		int i = 0;
+		for ( ; i <= nStr - nSearch; i += 32 )
+		{
+			// The last block reads past the terminator, which is fine up to the page end
+			bool bLastBlock = i + nSearch + 31 > nStr;
+			if ( bLastBlock && ( !V_StrCanLoad( pStr + i, 32 ) || !V_StrCanLoad( pStr + i + nSearch - 1, 32 ) ) )
+				break;
+
+			__m256i a = _mm256_loadu_si256( ( const __m256i * )( pStr + i ) );
+			__m256i b = _mm256_loadu_si256( ( const __m256i * )( pStr + i + nSearch - 1 ) );
+			if ( FOLD )
+			{
+				a = V_StrFoldAVX2( a );
+				b = V_StrFoldAVX2( b );
+			}
+
+			uint32 nMask = ( uint32 )_mm256_movemask_epi8( _mm256_and_si256( _mm256_cmpeq_epi8( a, first ), _mm256_cmpeq_epi8( b, last ) ) );
+			if ( bLastBlock )
+				nMask &= ( 1u << ( nStr - nSearch - i + 1 ) ) - 1;
+
+			while ( nMask )
+			{
+				int nAt = i + V_StrLowestBit( nMask );
+				if ( nSearch <= 2 || V_StrMatchN< FOLD >( pStr + nAt + 1, pSearch + 1, nSearch - 2 ) )
+					return pStr + nAt;
+
+				nMask &= nMask - 1;
+			}
+		}
+
+		const uint8 cFirst = FOLD ? V_StrFold( pSearch[0] ) : pSearch[0];
+		for ( ; i <= nStr - nSearch; i++ )
+		{
+			uint8 c = FOLD ? V_StrFold( pStr[i] ) : pStr[i];
+			if ( c == cFirst && V_StrMatchN< FOLD >( pStr + i + 1, pSearch + 1, nSearch - 1 ) )
+				return pStr + i;
+		}
+
+		return NULL;
+	}
+}
+
+int V_StrSetSIMDLevel( int nLevel )
+{
+	static bool s_bAVX2 = CheckAVX2Technology();
+	s_nStrSIMDLevel = clamp( nLevel, 0, s_bAVX2 ? 2 : 1 );
+	return s_nStrSIMDLevel;
+}
+
+#else // !STRTOOLS_SIMD
+
+int V_StrSetSIMDLevel( int nLevel )
+{
+	s_nStrSIMDLevel = 0;
+	return 0;
+}
+
+#endif // STRTOOLS_SIMD
+
+int V_StrGetSIMDLevel()
+{
+	if ( s_nStrSIMDLevel < 0 )
+		V_StrSetSIMDLevel( 2 );
+
+	return s_nStrSIMDLevel;
+}
+
+#if STRTOOLS_SIMD
+#define STRTOOLS_DISPATCH( avx2, sse2, scalar ) \
+	switch ( V_StrGetSIMDLevel() ) \
+	{ \
+		case 2: return avx2; \
+		case 1: return sse2; \
+		default: return scalar; \
+	}
+#else
+#define STRTOOLS_DISPATCH( avx2, sse2, scalar ) return scalar;
+#endif
+
+int V_strlen_simd( const char *pStr )
+{
+	STRTOOLS_DISPATCH( V_strlen_AVX2( pStr ), V_strlen_SSE2( pStr ), V_strlen_Scalar( pStr ) );
+}
+
+int V_stricmp_simd( const char *s1, const char *s2 )
+{
+	STRTOOLS_DISPATCH( V_strnicmp_AVX2( s1, s2, -1 ), V_strnicmp_SSE2( s1, s2, -1 ), V_strnicmp_Scalar( s1, s2, -1 ) );
+}
+
+int V_strnicmp_simd( const char *s1, const char *s2, int n )
+{
+	STRTOOLS_DISPATCH( V_strnicmp_AVX2( s1, s2, n ), V_strnicmp_SSE2( s1, s2, n ), V_strnicmp_Scalar( s1, s2, n ) );
+}
+
+const char *V_strstr_simd( const char *pStr, const char *pSearch )
+{
+	STRTOOLS_DISPATCH( V_strstr_AVX2< false >( pStr, pSearch ), V_strstr_SSE2< false >( pStr, pSearch ), V_strstr_Scalar< false >( pStr, pSearch ) );
+}
+
+const char *V_stristr_simd( const char *pStr, const char *pSearch )
+{
+	STRTOOLS_DISPATCH( V_strstr_AVX2< true >( pStr, pSearch ), V_strstr_SSE2< true >( pStr, pSearch ), V_strstr_Scalar< true >( pStr, pSearch ) );
+}
+
+char *V_strlower_simd( char *pStart )
+{
+	STRTOOLS_DISPATCH( V_strlower_AVX2( pStart ), V_strlower_SSE2( pStart ), V_strlower_Scalar( pStart ) );
+}
+
+int V_strtolower_simd( const char *pIn, char *pOut, int nOutSize )
+{
+	if ( nOutSize <= 0 )
+		return 0;
+
+	STRTOOLS_DISPATCH( V_strtolower_AVX2( pIn, pOut, nOutSize ), V_strtolower_SSE2( pIn, pOut, nOutSize ), V_strtolower_Scalar( pIn, pOut, nOutSize ) );
+}
@@ -8,6 +8,7 @@
 
 #include "tier0/dbg.h"
 #include "tier0/strtools.h"
+#include "tier1/strtools_unicode.h"
 
 
 //-----------------------------------------------------------------------------
@@ -204,6 +205,514 @@ int Q_UTF16ToUChar32( const uchar16 *pUTF16, uchar32 &uValueOut, bool &bErrorOut
 	}
 }
 
+//-----------------------------------------------------------------------------
+// SIMD UTF-8 scanning
+//
+// The scanners below consume the longest run of complete, valid characters they can
+// prove at the start of a string, 16 (SSE4.1) or 32 (AVX2) bytes a step, and leave
+// everything else - errors, CESU-8 pairs, the bytes near a page end - to the scalar
+// loops around them, which is what keeps the results identical to Q_UTF8ToUChar32.
+// A run ends on a character boundary, either at the terminator or before the block
+// that didn't validate. Validation is Keiser & Lemire's nibble lookup, plus the
+// noncharacters (U+FDD0-U+FDEF, U+xFFFE/U+xFFFF) that Q_IsValidUChar32 also rejects.
+//-----------------------------------------------------------------------------
+
+#if !defined( PLATFORM_PPC ) && ( defined( _M_X64 ) || defined( _M_IX86 ) || defined( __x86_64__ ) || defined( __i386__ ) )
+#define UNICODE_SIMD 1
+#else
+#define UNICODE_SIMD 0
+#endif
+
+#if UNICODE_SIMD
+
+#include <smmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include "tier1/processor_detect.h"
+
+// Blocks are loaded whole and may run past the terminator, though never into the next page.
+// gcc and clang need the AVX2 path enabled per function, MSVC lets the intrinsics through.
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define UNICODE_AVX2_TARGET __attribute__(( target( "avx2" ) ))
+#define UNICODE_NO_SANITIZE __attribute__(( no_sanitize_address ))
+#else
+#define UNICODE_AVX2_TARGET
+#define UNICODE_NO_SANITIZE
+#endif
+
+namespace // internal use only
+{
+	enum EUTF8Error
+	{
+		UTF8_TOO_SHORT		= 1 << 0,	// 11______ 0_______, 11______ 11______
+		UTF8_TOO_LONG		= 1 << 1,	// 0_______ 10______
+		UTF8_OVERLONG_3		= 1 << 2,	// 11100000 100_____
+		UTF8_TOO_LARGE		= 1 << 3,	// 11110100 1001____, 11110100 101_____, 11110101+ 10______
+		UTF8_SURROGATE		= 1 << 4,	// 11101101 101_____
+		UTF8_OVERLONG_2		= 1 << 5,	// 1100000_ 10______
+		UTF8_TOO_LARGE_1000	= 1 << 6,	// 11110101+ 1000____
+		UTF8_OVERLONG_4		= 1 << 6,	// 11110000 1000____
+		UTF8_TWO_CONTS		= 1 << 7,	// 10______ 10______, unless a 3 or 4 byte lead wants it
+		UTF8_CARRY			= UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS
+	};
+
+	// The lookup tables, indexed by the high nibble of the previous byte...
+	#define UTF8_BYTE_1_HIGH \
+		UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, \
+		UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, \
+		UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, \
+		UTF8_TOO_SHORT | UTF8_OVERLONG_2, \
+		UTF8_TOO_SHORT, \
+		UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE, \
+		UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4
+
+	// ...its low nibble...
+	#define UTF8_BYTE_1_LOW \
+		UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4, \
+		UTF8_CARRY | UTF8_OVERLONG_2, \
+		UTF8_CARRY, \
+		UTF8_CARRY, \
+		UTF8_CARRY | UTF8_TOO_LARGE, \
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE, \
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000
+
+	// ...and the high nibble of the current one. A byte is an error where all three agree.
+	#define UTF8_BYTE_2_HIGH \
+		UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, \
+		UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, \
+		UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4, \
+		UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE, \
+		UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE, \
+		UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE, \
+		UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT
+
+	static const int s_nUnicodePageSize = 4096;
+
+	inline int Q_UnicodePopCount( uint32 nBits )
+	{
+#ifdef _MSC_VER
+		return __popcnt( nBits );
+#else
+		return __builtin_popcount( nBits );
+#endif
+	}
+
+	inline int Q_UnicodeFirstBit( uint32 nBits )
+	{
+#ifdef _MSC_VER
+		unsigned long nIndex;
+		_BitScanForward( &nIndex, nBits );
+		return nIndex;
+#else
+		return __builtin_ctz( nBits );
+#endif
+	}
+
+	// How many bytes at the end of a validated block belong to a character that isn't finished yet
+	inline int Q_UTF8IncompleteTail( const uint8 *pBlockEnd )
+	{
+		if ( pBlockEnd[-1] >= 0xC0 )
+			return 1;
+		if ( pBlockEnd[-2] >= 0xE0 )
+			return 2;
+		if ( pBlockEnd[-3] >= 0xF0 )
+			return 3;
+		return 0;
+	}
+
+	inline __m128i Q_UTF8InRangeSSE( __m128i input, uint8 nLow, uint8 nHigh )
+	{
+		return _mm_cmpeq_epi8( _mm_min_epu8( _mm_max_epu8( input, _mm_set1_epi8( nLow ) ), _mm_set1_epi8( nHigh ) ), input );
+	}
+
+	// Non-zero bytes wherever the block, continuing from the previous one, isn't valid UTF-8
+	inline __m128i Q_UTF8BlockErrorsSSE( __m128i input, __m128i prevInput )
+	{
+		const __m128i nibbleMask = _mm_set1_epi8( 0x0F );
+
+		__m128i prev1 = _mm_alignr_epi8( input, prevInput, 15 );
+		__m128i prev2 = _mm_alignr_epi8( input, prevInput, 14 );
+		__m128i prev3 = _mm_alignr_epi8( input, prevInput, 13 );
+
+		__m128i byte1High = _mm_shuffle_epi8( _mm_setr_epi8( UTF8_BYTE_1_HIGH ), _mm_and_si128( _mm_srli_epi16( prev1, 4 ), nibbleMask ) );
+		__m128i byte1Low = _mm_shuffle_epi8( _mm_setr_epi8( UTF8_BYTE_1_LOW ), _mm_and_si128( prev1, nibbleMask ) );
+		__m128i byte2High = _mm_shuffle_epi8( _mm_setr_epi8( UTF8_BYTE_2_HIGH ), _mm_and_si128( _mm_srli_epi16( input, 4 ), nibbleMask ) );
+		__m128i specialCases = _mm_and_si128( _mm_and_si128( byte1High, byte1Low ), byte2High );
+
+		// Bytes 2 and 3 after a 3 or 4 byte lead are where two continuations in a row are expected
+		__m128i isThirdByte = _mm_subs_epu8( prev2, _mm_set1_epi8( (char)( 0xE0 - 0x80 ) ) );
+		__m128i isFourthByte = _mm_subs_epu8( prev3, _mm_set1_epi8( (char)( 0xF0 - 0x80 ) ) );
+		__m128i must23 = _mm_and_si128( _mm_or_si128( isThirdByte, isFourthByte ), _mm_set1_epi8( (char)0x80 ) );
+		__m128i errors = _mm_xor_si128( must23, specialCases );
+
+		// Noncharacters: EF B7 90-AF, EF BF BE-BF and F0-F4 _F BF BE-BF. Only worth
+		// looking for when there's an EF or a 4 byte lead in the right place.
+		__m128i highLeads = _mm_or_si128( _mm_subs_epu8( prev2, _mm_set1_epi8( (char)0xEE ) ), _mm_subs_epu8( prev3, _mm_set1_epi8( (char)0xEF ) ) );
+		if ( _mm_testz_si128( highLeads, highLeads ) )
+			return errors;
+
+		__m128i lastFFFx = _mm_and_si128( Q_UTF8InRangeSSE( input, 0xBE, 0xBF ), _mm_cmpeq_epi8( prev1, _mm_set1_epi8( (char)0xBF ) ) );
+		__m128i planeFFFx = _mm_and_si128( _mm_cmpeq_epi8( _mm_and_si128( prev2, nibbleMask ), nibbleMask ),
+			_mm_cmpeq_epi8( _mm_max_epu8( prev3, _mm_set1_epi8( (char)0xF0 ) ), prev3 ) );
+		__m128i isEF = _mm_cmpeq_epi8( prev2, _mm_set1_epi8( (char)0xEF ) );
+		__m128i nonCharacters = _mm_or_si128(
+			_mm_and_si128( lastFFFx, _mm_or_si128( isEF, planeFFFx ) ),
+			_mm_and_si128( _mm_and_si128( isEF, _mm_cmpeq_epi8( prev1, _mm_set1_epi8( (char)0xB7 ) ) ), Q_UTF8InRangeSSE( input, 0x90, 0xAF ) ) );
+
+		return _mm_or_si128( errors, nonCharacters );
+	}
+
+	UNICODE_NO_SANITIZE int Q_UTF8ScanSSE41( const uint8 *pUTF8, int nMaxBytes, int &nCharsOut, int &nSupplementaryOut )
+	{
+		const __m128i byteIndices = _mm_setr_epi8( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 );
+		const __m128i zero = _mm_setzero_si128();
+
+		__m128i prevInput = zero;
+		bool bPrevASCII = true;
+		int nOffset = 0, nChars = 0, nSupplementary = 0;
+
+		while ( nOffset + 16 <= nMaxBytes && ( ( (uintp)( pUTF8 + nOffset ) ) & ( s_nUnicodePageSize - 1 ) ) <= s_nUnicodePageSize - 16 )
+		{
+			__m128i input = _mm_loadu_si128( (const __m128i *)( pUTF8 + nOffset ) );
+
+			// Everything from the terminator on reads as zeros, which are plain ASCII
+			int nBlockBytes = 16;
+			uint32 nZeroMask = _mm_movemask_epi8( _mm_cmpeq_epi8( input, zero ) );
+			if ( nZeroMask )
+			{
+				nBlockBytes = Q_UnicodeFirstBit( nZeroMask );
+				input = _mm_and_si128( input, _mm_cmpgt_epi8( _mm_set1_epi8( (char)nBlockBytes ), byteIndices ) );
+			}
+
+			// ASCII after ASCII can't be wrong; anything else goes through the tables
+			uint32 nHighMask = _mm_movemask_epi8( input );
+			if ( nHighMask || !bPrevASCII )
+			{
+				__m128i errors = Q_UTF8BlockErrorsSSE( input, prevInput );
+				if ( !_mm_testz_si128( errors, errors ) )
+					break;
+
+				// Characters start on every byte but 10______, 4 byte ones on 11110___
+				uint32 nBlockMask = ( 1u << nBlockBytes ) - 1;
+				nChars += Q_UnicodePopCount( _mm_movemask_epi8( _mm_cmpgt_epi8( input, _mm_set1_epi8( (char)0xBF ) ) ) & nBlockMask );
+				nSupplementary += Q_UnicodePopCount( _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_max_epu8( input, _mm_set1_epi8( (char)0xF0 ) ), input ) ) );
+			}
+			else
+			{
+				nChars += nBlockBytes;
+			}
+
+			prevInput = input;
+			bPrevASCII = !nHighMask;
+			nOffset += nBlockBytes;
+
+			if ( nZeroMask )
+				break;
+		}
+
+		// Hand a character split over the last block back to the caller
+		int nTail = ( nOffset && pUTF8[nOffset] ) ? Q_UTF8IncompleteTail( pUTF8 + nOffset ) : 0;
+		if ( nTail )
+		{
+			nOffset -= nTail;
+			nChars--;
+			nSupplementary -= pUTF8[nOffset] >= 0xF0;
+		}
+
+		nCharsOut = nChars;
+		nSupplementaryOut = nSupplementary;
+		return nOffset;
+	}
+
+	UNICODE_AVX2_TARGET inline __m256i Q_UTF8InRangeAVX2( __m256i input, uint8 nLow, uint8 nHigh )
+	{
+		return _mm256_cmpeq_epi8( _mm256_min_epu8( _mm256_max_epu8( input, _mm256_set1_epi8( nLow ) ), _mm256_set1_epi8( nHigh ) ), input );
+	}
+
+	// Same as Q_UTF8BlockErrorsSSE, 32 bytes at a time
+	UNICODE_AVX2_TARGET inline __m256i Q_UTF8BlockErrorsAVX2( __m256i input, __m256i prevInput )
+	{
+		const __m256i nibbleMask = _mm256_set1_epi8( 0x0F );
+
+		// alignr works within lanes, so the low lane gets its previous bytes from the previous block
+		__m256i prevLanes = _mm256_permute2x128_si256( prevInput, input, 0x21 );
+		__m256i prev1 = _mm256_alignr_epi8( input, prevLanes, 15 );
+		__m256i prev2 = _mm256_alignr_epi8( input, prevLanes, 14 );
+		__m256i prev3 = _mm256_alignr_epi8( input, prevLanes, 13 );
+
+		__m256i byte1High = _mm256_shuffle_epi8( _mm256_setr_epi8( UTF8_BYTE_1_HIGH, UTF8_BYTE_1_HIGH ), _mm256_and_si256( _mm256_srli_epi16( prev1, 4 ), nibbleMask ) );
+		__m256i byte1Low = _mm256_shuffle_epi8( _mm256_setr_epi8( UTF8_BYTE_1_LOW, UTF8_BYTE_1_LOW ), _mm256_and_si256( prev1, nibbleMask ) );
+		__m256i byte2High = _mm256_shuffle_epi8( _mm256_setr_epi8( UTF8_BYTE_2_HIGH, UTF8_BYTE_2_HIGH ), _mm256_and_si256( _mm256_srli_epi16( input, 4 ), nibbleMask ) );
+		__m256i specialCases = _mm256_and_si256( _mm256_and_si256( byte1High, byte1Low ), byte2High );
+
+		__m256i isThirdByte = _mm256_subs_epu8( prev2, _mm256_set1_epi8( (char)( 0xE0 - 0x80 ) ) );
+		__m256i isFourthByte = _mm256_subs_epu8( prev3, _mm256_set1_epi8( (char)( 0xF0 - 0x80 ) ) );
+		__m256i must23 = _mm256_and_si256( _mm256_or_si256( isThirdByte, isFourthByte ), _mm256_set1_epi8( (char)0x80 ) );
+		__m256i errors = _mm256_xor_si256( must23, specialCases );
+
+		__m256i highLeads = _mm256_or_si256( _mm256_subs_epu8( prev2, _mm256_set1_epi8( (char)0xEE ) ), _mm256_subs_epu8( prev3, _mm256_set1_epi8( (char)0xEF ) ) );
+		if ( _mm256_testz_si256( highLeads, highLeads ) )
+			return errors;
+
+		__m256i lastFFFx = _mm256_and_si256( Q_UTF8InRangeAVX2( input, 0xBE, 0xBF ), _mm256_cmpeq_epi8( prev1, _mm256_set1_epi8( (char)0xBF ) ) );
+		__m256i planeFFFx = _mm256_and_si256( _mm256_cmpeq_epi8( _mm256_and_si256( prev2, nibbleMask ), nibbleMask ),
+			_mm256_cmpeq_epi8( _mm256_max_epu8( prev3, _mm256_set1_epi8( (char)0xF0 ) ), prev3 ) );
+		__m256i isEF = _mm256_cmpeq_epi8( prev2, _mm256_set1_epi8( (char)0xEF ) );
+		__m256i nonCharacters = _mm256_or_si256(
+			_mm256_and_si256( lastFFFx, _mm256_or_si256( isEF, planeFFFx ) ),
+			_mm256_and_si256( _mm256_and_si256( isEF, _mm256_cmpeq_epi8( prev1, _mm256_set1_epi8( (char)0xB7 ) ) ), Q_UTF8InRangeAVX2( input, 0x90, 0xAF ) ) );
+
+		return _mm256_or_si256( errors, nonCharacters );
+	}
+
+	UNICODE_AVX2_TARGET UNICODE_NO_SANITIZE int Q_UTF8ScanAVX2( const uint8 *pUTF8, int nMaxBytes, int &nCharsOut, int &nSupplementaryOut )
+	{
+		const __m256i byteIndices = _mm256_setr_epi8( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+			16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31 );
+		const __m256i zero = _mm256_setzero_si256();
+
+		__m256i prevInput = zero;
+		bool bPrevASCII = true;
+		int nOffset = 0, nChars = 0, nSupplementary = 0;
+
+		while ( nOffset + 32 <= nMaxBytes && ( ( (uintp)( pUTF8 + nOffset ) ) & ( s_nUnicodePageSize - 1 ) ) <= s_nUnicodePageSize - 32 )
+		{
+			__m256i input = _mm256_loadu_si256( (const __m256i *)( pUTF8 + nOffset ) );
+
+			int nBlockBytes = 32;
+			uint32 nZeroMask = _mm256_movemask_epi8( _mm256_cmpeq_epi8( input, zero ) );
+			if ( nZeroMask )
+			{
+				nBlockBytes = Q_UnicodeFirstBit( nZeroMask );
+				input = _mm256_and_si256( input, _mm256_cmpgt_epi8( _mm256_set1_epi8( (char)nBlockBytes ), byteIndices ) );
+			}
+
+			uint32 nHighMask = _mm256_movemask_epi8( input );
+			if ( nHighMask || !bPrevASCII )
+			{
+				__m256i errors = Q_UTF8BlockErrorsAVX2( input, prevInput );
+				if ( !_mm256_testz_si256( errors, errors ) )
+					break;
+
+				uint32 nBlockMask = nBlockBytes < 32 ? ( 1u << nBlockBytes ) - 1 : ~0u;
+				nChars += Q_UnicodePopCount( (uint32)_mm256_movemask_epi8( _mm256_cmpgt_epi8( input, _mm256_set1_epi8( (char)0xBF ) ) ) & nBlockMask );
+				nSupplementary += Q_UnicodePopCount( (uint32)_mm256_movemask_epi8( _mm256_cmpeq_epi8( _mm256_max_epu8( input, _mm256_set1_epi8( (char)0xF0 ) ), input ) ) );
+			}
+			else
+			{
+				nChars += nBlockBytes;
+			}
+
+			prevInput = input;
+			bPrevASCII = !nHighMask;
+			nOffset += nBlockBytes;
+
+			if ( nZeroMask )
+				break;
+		}
+
+		int nTail = ( nOffset && pUTF8[nOffset] ) ? Q_UTF8IncompleteTail( pUTF8 + nOffset ) : 0;
+		if ( nTail )
+		{
+			nOffset -= nTail;
+			nChars--;
+			nSupplementary -= pUTF8[nOffset] >= 0xF0;
+		}
+
+		nCharsOut = nChars;
+		nSupplementaryOut = nSupplementary;
+		return nOffset;
+	}
+
+	inline void Q_UTF8WidenASCII( __m128i input, uchar16 *pOut )
+	{
+		_mm_storeu_si128( (__m128i *)pOut, _mm_cvtepu8_epi16( input ) );
+		_mm_storeu_si128( (__m128i *)pOut + 1, _mm_unpackhi_epi8( input, _mm_setzero_si128() ) );
+	}
+
+	inline void Q_UTF8WidenASCII( __m128i input, uchar32 *pOut )
+	{
+		_mm_storeu_si128( (__m128i *)pOut, _mm_cvtepu8_epi32( input ) );
+		_mm_storeu_si128( (__m128i *)pOut + 1, _mm_cvtepu8_epi32( _mm_srli_si128( input, 4 ) ) );
+		_mm_storeu_si128( (__m128i *)pOut + 2, _mm_cvtepu8_epi32( _mm_srli_si128( input, 8 ) ) );
+		_mm_storeu_si128( (__m128i *)pOut + 3, _mm_cvtepu8_epi32( _mm_srli_si128( input, 12 ) ) );
+	}
+
+	#undef UTF8_BYTE_1_HIGH
+	#undef UTF8_BYTE_1_LOW
+	#undef UTF8_BYTE_2_HIGH
+
+	int s_nUnicodeSIMDLevel = -1;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Pick the UTF-8 scanner, clamped to what the CPU has
+//-----------------------------------------------------------------------------
+int Q_UnicodeSetSIMDLevel( int nLevel )
+{
+	static bool s_bAVX2 = CheckAVX2Technology();
+	s_nUnicodeSIMDLevel = clamp( nLevel, 0, s_bAVX2 ? 2 : 1 );
+	return s_nUnicodeSIMDLevel;
+}
+
+#else // !UNICODE_SIMD
+
+int Q_UnicodeSetSIMDLevel( int nLevel )
+{
+	return 0;
+}
+
+#endif // UNICODE_SIMD
+
+namespace // internal use only
+{
+	// Returns how many bytes at the start of the string are complete, valid characters (never
+	// past the terminator or nMaxBytes), along with how many characters that is and how many
+	// of them are outside the BMP. May stop short anywhere on a character boundary, even at 0.
+	inline int Q_UTF8ScanValid( const char *pUTF8, int nMaxBytes, int &nChars, int &nSupplementary )
+	{
+#if UNICODE_SIMD
+		if ( s_nUnicodeSIMDLevel < 0 )
+			Q_UnicodeSetSIMDLevel( 2 );
+
+		if ( s_nUnicodeSIMDLevel == 2 )
+			return Q_UTF8ScanAVX2( (const uint8 *)pUTF8, nMaxBytes, nChars, nSupplementary );
+		if ( s_nUnicodeSIMDLevel == 1 )
+			return Q_UTF8ScanSSE41( (const uint8 *)pUTF8, nMaxBytes, nChars, nSupplementary );
+#endif
+		nChars = nSupplementary = 0;
+		return 0;
+	}
+
+	inline int Q_UTF8EncodeSupplementary( uint32 uVal, uchar16 *pOut )
+	{
+		return Q_UChar32ToUTF16( uVal, pOut );
+	}
+
+	inline int Q_UTF8EncodeSupplementary( uint32 uVal, uchar32 *pOut )
+	{
+		*pOut = uVal;
+		return 1;
+	}
+
+	// Writes a run Q_UTF8ScanValid accepted, which saves every check Q_UTF8ToUChar32 makes.
+	// Returns the number of elements written; the output has room for nBytes of them.
+	template < typename DstType >
+	int Q_UTF8DecodeValidRun( const uint8 *pUTF8, int nBytes, DstType *pOut )
+	{
+		const uint8 *pEnd = pUTF8 + nBytes;
+		DstType *pOutStart = pOut;
+
+		while ( pUTF8 < pEnd )
+		{
+			uint32 uVal = pUTF8[0];
+			if ( uVal < 0x80 )
+			{
+#if UNICODE_SIMD
+				// Widen whole blocks of ASCII, or copy as much of the block as is. There's room
+				// for the block, as nothing before here wrote more elements than it read bytes.
+				if ( pEnd - pUTF8 >= 16 )
+				{
+					__m128i input = _mm_loadu_si128( (const __m128i *)pUTF8 );
+					int nASCII = Q_UnicodeFirstBit( _mm_movemask_epi8( input ) | 0x10000 );
+					if ( nASCII == 16 )
+					{
+						Q_UTF8WidenASCII( input, pOut );
+					}
+					else
+					{
+						for ( int i = 0; i < nASCII; i++ )
+						{
+							pOut[i] = (DstType)pUTF8[i];
+						}
+					}
+
+					pUTF8 += nASCII;
+					pOut += nASCII;
+					continue;
+				}
+#endif
+				*pOut++ = (DstType)uVal;
+				pUTF8++;
+			}
+			else if ( uVal < 0xE0 )
+			{
+				*pOut++ = (DstType)( ( ( uVal & 0x1F ) << 6 ) | ( pUTF8[1] & 0x3F ) );
+				pUTF8 += 2;
+			}
+			else if ( uVal < 0xF0 )
+			{
+				*pOut++ = (DstType)( ( ( uVal & 0x0F ) << 12 ) | ( ( pUTF8[1] & 0x3F ) << 6 ) | ( pUTF8[2] & 0x3F ) );
+				pUTF8 += 3;
+			}
+			else
+			{
+				uVal = ( ( uVal & 0x07 ) << 18 ) | ( ( pUTF8[1] & 0x3F ) << 12 ) | ( ( pUTF8[2] & 0x3F ) << 6 ) | ( pUTF8[3] & 0x3F );
+				pOut += Q_UTF8EncodeSupplementary( uVal, pOut );
+				pUTF8 += 4;
+			}
+		}
+
+		return pOut - pOutStart;
+	}
+
+	// Bulk step for Q_UnicodeConvertT: converts the run of valid characters at pIn in one go and
+	// returns how many input elements that took, 0 to leave the next character to the scalar loop.
+	// Only UTF-8 input has one. With no output it only adds up the length the run would need.
+	template < typename SrcType, typename DstType >
+	inline int Q_UnicodeConvertRun( const SrcType *pIn, DstType *pOut, int nOutAvailable, int &nOut )
+	{
+		return 0;
+	}
+
+	template < typename DstType >
+	inline int Q_UTF8ConvertRun( const char *pIn, DstType *pOut, int nOutAvailable, int &nOut )
+	{
+		int nChars, nSupplementary;
+		int nBytes = Q_UTF8ScanValid( pIn, nOutAvailable, nChars, nSupplementary );
+		if ( !pOut )
+			nOut += nChars + ( sizeof( DstType ) == sizeof( uchar16 ) ? nSupplementary : 0 );
+		else if ( nBytes )
+			nOut += Q_UTF8DecodeValidRun( (const uint8 *)pIn, nBytes, pOut );
+		return nBytes;
+	}
+
+	template <>
+	inline int Q_UnicodeConvertRun( const char *pIn, uchar16 *pOut, int nOutAvailable, int &nOut )
+	{
+		return Q_UTF8ConvertRun( pIn, pOut, nOutAvailable, nOut );
+	}
+
+	template <>
+	inline int Q_UnicodeConvertRun( const char *pIn, uchar32 *pOut, int nOutAvailable, int &nOut )
+	{
+		return Q_UTF8ConvertRun( pIn, pOut, nOutAvailable, nOut );
+	}
+
+	// UTF-8 to UTF-8 is Q_UnicodeRepair, where the output is the input or behind it
+	template <>
+	inline int Q_UnicodeConvertRun( const char *pIn, char *pOut, int nOutAvailable, int &nOut )
+	{
+		int nChars, nSupplementary;
+		int nBytes = Q_UTF8ScanValid( pIn, nOutAvailable, nChars, nSupplementary );
+		if ( pOut && pOut != pIn )
+			memmove( pOut, pIn, nBytes );
+		nOut += nBytes;
+		return nBytes;
+	}
+}
+
 namespace // internal use only
 {
 	// Identity transformations and validity tests for use with Q_UnicodeConvertT
@@ -235,6 +744,16 @@ namespace // internal use only
 		{
 			while ( bStopAtNull ? ( *pIn ) : ( nInChars-- > 0 ) )
 			{
+				if ( bStopAtNull )
+				{
+					int nRun = Q_UnicodeConvertRun( pIn, (DstType *)NULL, INT_MAX, nOut );
+					if ( nRun )
+					{
+						pIn += nRun;
+						continue;
+					}
+				}
+
 				uchar32 uVal;
 				// Initialize in order to avoid /analyze warnings.
 				bool bErr = false;
@@ -266,6 +785,16 @@ namespace // internal use only
 			int nMaxOut = nOutElems - 1;
 			while ( bStopAtNull ? ( *pIn ) : ( nInChars-- > 0 ) )
 			{
+				if ( bStopAtNull )
+				{
+					int nRun = Q_UnicodeConvertRun( pIn, pOut + nOut, nMaxOut - nOut, nOut );
+					if ( nRun )
+					{
+						pIn += nRun;
+						continue;
+					}
+				}
+
 				uchar32 uVal;
 				// Initialize in order to avoid /analyze warnings.
 				bool bErr = false;
@@ -304,6 +833,14 @@ bool Q_UnicodeValidate( const char *pUTF8 )
 	bool bError = false;
 	while ( *pUTF8 )
 	{
+		int nChars, nSupplementary;
+		int nRun = Q_UTF8ScanValid( pUTF8, INT_MAX, nChars, nSupplementary );
+		if ( nRun )
+		{
+			pUTF8 += nRun;
+			continue;
+		}
+
 		uchar32 uVal;
 		// Our UTF-8 decoder silently fixes up 6-byte CESU-8 (improperly re-encoded UTF-16) sequences.
 		// However, these are technically not valid UTF-8. So if we eat 6 bytes at once, it's an error.
@@ -353,6 +890,15 @@ int Q_UnicodeLength( const char *pUTF8 )
 	int nChars = 0;
 	while ( *pUTF8 )
 	{
+		int nRunChars, nSupplementary;
+		int nRun = Q_UTF8ScanValid( pUTF8, INT_MAX, nRunChars, nSupplementary );
+		if ( nRun )
+		{
+			pUTF8 += nRun;
+			nChars += nRunChars;
+			continue;
+		}
+
 		bool bError;
 		uchar32 uVal;
 		pUTF8 += Q_UTF8ToUChar32( pUTF8, uVal, bError );
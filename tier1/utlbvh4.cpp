@@ -0,0 +1,970 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: Bulk-built 4-wide bounding volume hierarchy
+//
+//=============================================================================//
+
+#include "tier1/utlbvh4.h"
+#include "tier0/dbg.h"
+#include "tier1/threadtools.h"
+
+#include <float.h>
+
+// memdbgon must be the last include file in a .cpp file!!!
+#include "tier0/memdbgon.h"
+
+
+// Centroids are binned along each axis when looking for a split
+static const int s_nSAHBins = 16;
+
+// Below this many primitives a threaded build isn't worth starting threads for
+static const int s_nMinParallelBuildPrimitives = 4096;
+
+// tier1 doesn't link mathlib, so constants are built with ReplicateX4 rather than read from Four_Zeros and co.
+#define BVH4_ZERO ReplicateX4( 0.0f )
+
+
+//-----------------------------------------------------------------------------
+// Builder
+//-----------------------------------------------------------------------------
+struct BVH4BuildPrimitive_t
+{
+	Vector m_vMins;
+	Vector m_vMaxs;
+	Vector m_vCentroid;		// twice the center, only ever compared with other centroids
+	int m_nIndex;
+};
+
+struct BVH4BuildRange_t
+{
+	int m_nBegin;
+	int m_nEnd;
+	Vector m_vMins;
+	Vector m_vMaxs;
+};
+
+// A sub-tree left for the worker threads: its node is already allocated and
+// linked into its parent
+struct BVH4BuildTask_t
+{
+	int m_nNode;
+	int m_nBegin;
+	int m_nEnd;
+};
+
+static float HalfSurfaceArea( const Vector &vMins, const Vector &vMaxs )
+{
+	Vector vSize = vMaxs - vMins;
+	return vSize.x * vSize.y + vSize.y * vSize.z + vSize.z * vSize.x;
+}
+
+class CUtlBVH4Builder
+{
+public:
+	CUtlBVH4Builder( CUtlBVH4 &tree, BVH4BuildPrimitive_t *pPrimitives, int nTaskDepth ) :
+		m_Tree( tree ), m_pPrimitives( pPrimitives ), m_nTaskDepth( nTaskDepth ), m_nNodeCount( 1 ), m_nNextTask( 0 )
+	{
+	}
+
+	void BuildNode( int nNode, int nBegin, int nEnd, int nDepth );
+	void RunTasks();
+	void RunTasksOnThreads( int nThreads );
+
+	int NodeCount() const { return m_nNodeCount; }
+
+private:
+	static uintp ThreadFunc( void *pParam );
+
+	int AllocNode() { return ThreadInterlockedIncrement( &m_nNodeCount ) - 1; }
+	void ComputeBounds( BVH4BuildRange_t &range ) const;
+	int Split( const BVH4BuildRange_t &range );
+	int Partition( int nBegin, int nEnd, int nAxis, float flCentroidMin, float flBinScale, int nSplitBin );
+
+	CUtlBVH4 &m_Tree;
+	BVH4BuildPrimitive_t *m_pPrimitives;
+	int m_nTaskDepth;					// sub-trees at this depth are deferred to RunTasks, -1 builds everything in place
+	CUtlVector< BVH4BuildTask_t > m_Tasks;
+	int32 volatile m_nNodeCount;
+	int32 volatile m_nNextTask;
+};
+
+void CUtlBVH4Builder::ComputeBounds( BVH4BuildRange_t &range ) const
+{
+	range.m_vMins.Init( FLT_MAX, FLT_MAX, FLT_MAX );
+	range.m_vMaxs.Init( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+
+	for ( int i = range.m_nBegin; i < range.m_nEnd; i++ )
+	{
+		VectorMin( range.m_vMins, m_pPrimitives[i].m_vMins, range.m_vMins );
+		VectorMax( range.m_vMaxs, m_pPrimitives[i].m_vMaxs, range.m_vMaxs );
+	}
+}
+
+static FORCEINLINE int CentroidBin( float flCentroid, float flCentroidMin, float flBinScale )
+{
+	int nBin = ( int )( ( flCentroid - flCentroidMin ) * flBinScale );
+	return MIN( nBin, s_nSAHBins - 1 );
+}
+
+int CUtlBVH4Builder::Partition( int nBegin, int nEnd, int nAxis, float flCentroidMin, float flBinScale, int nSplitBin )
+{
+	int i = nBegin, j = nEnd - 1;
+	while ( i <= j )
+	{
+		if ( CentroidBin( m_pPrimitives[i].m_vCentroid[nAxis], flCentroidMin, flBinScale ) < nSplitBin )
+		{
+			i++;
+		}
+		else
+		{
+			V_swap( m_pPrimitives[i], m_pPrimitives[j] );
+			j--;
+		}
+	}
+
+	return i;
+}
+
+//-----------------------------------------------------------------------------
+// Reorders the range into two and returns where the second one starts. Picks the
+// binned split with the lowest surface area heuristic cost over all three axes.
+//-----------------------------------------------------------------------------
+int CUtlBVH4Builder::Split( const BVH4BuildRange_t &range )
+{
+	const int nBegin = range.m_nBegin, nEnd = range.m_nEnd;
+
+	Vector vCentroidMins( FLT_MAX, FLT_MAX, FLT_MAX ), vCentroidMaxs( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+	for ( int i = nBegin; i < nEnd; i++ )
+	{
+		VectorMin( vCentroidMins, m_pPrimitives[i].m_vCentroid, vCentroidMins );
+		VectorMax( vCentroidMaxs, m_pPrimitives[i].m_vCentroid, vCentroidMaxs );
+	}
+
+	float flBestCost = FLT_MAX, flBestBinScale = 0.0f;
+	int nBestAxis = -1, nBestBin = 0;
+
+	for ( int nAxis = 0; nAxis < 3; nAxis++ )
+	{
+		float flExtent = vCentroidMaxs[nAxis] - vCentroidMins[nAxis];
+		if ( flExtent <= 0.0f )
+			continue;
+
+		Vector vBinMins[s_nSAHBins], vBinMaxs[s_nSAHBins];
+		int nBinCount[s_nSAHBins];
+		for ( int b = 0; b < s_nSAHBins; b++ )
+		{
+			vBinMins[b].Init( FLT_MAX, FLT_MAX, FLT_MAX );
+			vBinMaxs[b].Init( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+			nBinCount[b] = 0;
+		}
+
+		const float flBinScale = s_nSAHBins / flExtent;
+		for ( int i = nBegin; i < nEnd; i++ )
+		{
+			const BVH4BuildPrimitive_t &prim = m_pPrimitives[i];
+			int b = CentroidBin( prim.m_vCentroid[nAxis], vCentroidMins[nAxis], flBinScale );
+			VectorMin( vBinMins[b], prim.m_vMins, vBinMins[b] );
+			VectorMax( vBinMaxs[b], prim.m_vMaxs, vBinMaxs[b] );
+			nBinCount[b]++;
+		}
+
+		// Sweep from the right for the cost of everything from bin b up, then from the
+		// left to evaluate splitting in front of each bin
+		float flRightCost[s_nSAHBins];
+		Vector vMins( FLT_MAX, FLT_MAX, FLT_MAX ), vMaxs( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+		int nCount = 0;
+		for ( int b = s_nSAHBins - 1; b > 0; b-- )
+		{
+			VectorMin( vMins, vBinMins[b], vMins );
+			VectorMax( vMaxs, vBinMaxs[b], vMaxs );
+			nCount += nBinCount[b];
+			flRightCost[b] = nCount ? HalfSurfaceArea( vMins, vMaxs ) * nCount : 0.0f;
+		}
+
+		vMins.Init( FLT_MAX, FLT_MAX, FLT_MAX );
+		vMaxs.Init( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+		nCount = 0;
+		for ( int b = 1; b < s_nSAHBins; b++ )
+		{
+			VectorMin( vMins, vBinMins[b - 1], vMins );
+			VectorMax( vMaxs, vBinMaxs[b - 1], vMaxs );
+			nCount += nBinCount[b - 1];
+
+			if ( !nCount || nCount == nEnd - nBegin )
+				continue;
+
+			float flCost = HalfSurfaceArea( vMins, vMaxs ) * nCount + flRightCost[b];
+			if ( flCost < flBestCost )
+			{
+				flBestCost = flCost;
+				flBestBinScale = flBinScale;
+				nBestAxis = nAxis;
+				nBestBin = b;
+			}
+		}
+	}
+
+	if ( nBestAxis >= 0 )
+	{
+		int nMid = Partition( nBegin, nEnd, nBestAxis, vCentroidMins[nBestAxis], flBestBinScale, nBestBin );
+		if ( nMid > nBegin && nMid < nEnd )
+			return nMid;
+	}
+
+	// All the centroids are in the same place; any split is as good as another
+	return ( nBegin + nEnd ) / 2;
+}
+
+//-----------------------------------------------------------------------------
+// Fills in node nNode for the primitives [nBegin, nEnd): the range is split
+// until there are four pieces, single primitives become leaves and the rest
+// become child nodes, built recursively or queued as tasks.
+//-----------------------------------------------------------------------------
+void CUtlBVH4Builder::BuildNode( int nNode, int nBegin, int nEnd, int nDepth )
+{
+	BVH4BuildRange_t ranges[4];
+	int nRanges = 0;
+
+	if ( nEnd - nBegin <= 4 )
+	{
+		for ( int i = nBegin; i < nEnd; i++ )
+		{
+			BVH4BuildRange_t &range = ranges[nRanges++];
+			range.m_nBegin = i;
+			range.m_nEnd = i + 1;
+			range.m_vMins = m_pPrimitives[i].m_vMins;
+			range.m_vMaxs = m_pPrimitives[i].m_vMaxs;
+		}
+	}
+	else
+	{
+		ranges[0].m_nBegin = nBegin;
+		ranges[0].m_nEnd = nEnd;
+		ComputeBounds( ranges[0] );
+		nRanges = 1;
+
+		while ( nRanges < 4 )
+		{
+			// Split whichever piece has the largest surface area
+			int nSplit = -1;
+			float flLargestArea = -1.0f;
+			for ( int i = 0; i < nRanges; i++ )
+			{
+				float flArea = HalfSurfaceArea( ranges[i].m_vMins, ranges[i].m_vMaxs );
+				if ( ranges[i].m_nEnd - ranges[i].m_nBegin > 1 && flArea > flLargestArea )
+				{
+					flLargestArea = flArea;
+					nSplit = i;
+				}
+			}
+
+			if ( nSplit < 0 )
+				break;
+
+			BVH4BuildRange_t &left = ranges[nSplit];
+			BVH4BuildRange_t &right = ranges[nRanges++];
+
+			int nMid = Split( left );
+			right.m_nBegin = nMid;
+			right.m_nEnd = left.m_nEnd;
+			left.m_nEnd = nMid;
+			ComputeBounds( left );
+			ComputeBounds( right );
+		}
+	}
+
+	CUtlBVH4::Node_t &node = m_Tree.m_Nodes[nNode];
+	node.m_nChildCount = nRanges;
+	node.m_nLeafMask = 0;
+	node.m_nFirstPrimitive = nBegin;
+	node.m_nPrimitiveCount = nEnd - nBegin;
+
+	for ( int i = 0; i < 4; i++ )
+	{
+		if ( i >= nRanges )
+		{
+			CUtlBVH4::SetChildBounds( node, i, Vector( FLT_MAX, FLT_MAX, FLT_MAX ), Vector( -FLT_MAX, -FLT_MAX, -FLT_MAX ) );
+			node.m_nChild[i] = -1;
+			continue;
+		}
+
+		CUtlBVH4::SetChildBounds( node, i, ranges[i].m_vMins, ranges[i].m_vMaxs );
+
+		if ( ranges[i].m_nEnd - ranges[i].m_nBegin == 1 )
+		{
+			node.m_nChild[i] = ranges[i].m_nBegin;
+			node.m_nLeafMask |= 1 << i;
+		}
+		else
+		{
+			node.m_nChild[i] = AllocNode();
+		}
+	}
+
+	for ( int i = 0; i < nRanges; i++ )
+	{
+		if ( node.m_nLeafMask & ( 1 << i ) )
+			continue;
+
+		if ( nDepth + 1 == m_nTaskDepth )
+		{
+			BVH4BuildTask_t task = { node.m_nChild[i], ranges[i].m_nBegin, ranges[i].m_nEnd };
+			m_Tasks.AddToTail( task );
+		}
+		else
+		{
+			BuildNode( node.m_nChild[i], ranges[i].m_nBegin, ranges[i].m_nEnd, nDepth + 1 );
+		}
+	}
+}
+
+void CUtlBVH4Builder::RunTasks()
+{
+	for ( ;; )
+	{
+		int nTask = ThreadInterlockedIncrement( &m_nNextTask ) - 1;
+		if ( nTask >= m_Tasks.Count() )
+			break;
+
+		const BVH4BuildTask_t &task = m_Tasks[nTask];
+		BuildNode( task.m_nNode, task.m_nBegin, task.m_nEnd, m_nTaskDepth );
+	}
+}
+
+uintp CUtlBVH4Builder::ThreadFunc( void *pParam )
+{
+	( ( CUtlBVH4Builder * )pParam )->RunTasks();
+	return 0;
+}
+
+void CUtlBVH4Builder::RunTasksOnThreads( int nThreads )
+{
+	RunOnSimpleThreads( MIN( nThreads, m_Tasks.Count() ), ThreadFunc, this );
+}
+
+
+//-----------------------------------------------------------------------------
+// CUtlBVH4
+//-----------------------------------------------------------------------------
+CUtlBVH4::CUtlBVH4()
+{
+}
+
+void CUtlBVH4::SetChildBounds( Node_t &node, int nChild, const Vector &vMins, const Vector &vMaxs )
+{
+	SubFloat( node.m_MinX, nChild ) = vMins.x;
+	SubFloat( node.m_MinY, nChild ) = vMins.y;
+	SubFloat( node.m_MinZ, nChild ) = vMins.z;
+	SubFloat( node.m_MaxX, nChild ) = vMaxs.x;
+	SubFloat( node.m_MaxY, nChild ) = vMaxs.y;
+	SubFloat( node.m_MaxZ, nChild ) = vMaxs.z;
+}
+
+// The union of a node's children; the empty lanes don't contribute
+void CUtlBVH4::GetNodeBounds( int nNode, Vector &vMins, Vector &vMaxs ) const
+{
+	const Node_t &node = m_Nodes[nNode];
+
+	fltx4 minX = MinSIMD( node.m_MinX, RotateLeft( node.m_MinX ) );
+	fltx4 minY = MinSIMD( node.m_MinY, RotateLeft( node.m_MinY ) );
+	fltx4 minZ = MinSIMD( node.m_MinZ, RotateLeft( node.m_MinZ ) );
+	fltx4 maxX = MaxSIMD( node.m_MaxX, RotateLeft( node.m_MaxX ) );
+	fltx4 maxY = MaxSIMD( node.m_MaxY, RotateLeft( node.m_MaxY ) );
+	fltx4 maxZ = MaxSIMD( node.m_MaxZ, RotateLeft( node.m_MaxZ ) );
+
+	vMins.x = MIN( SubFloat( minX, 0 ), SubFloat( minX, 2 ) );
+	vMins.y = MIN( SubFloat( minY, 0 ), SubFloat( minY, 2 ) );
+	vMins.z = MIN( SubFloat( minZ, 0 ), SubFloat( minZ, 2 ) );
+	vMaxs.x = MAX( SubFloat( maxX, 0 ), SubFloat( maxX, 2 ) );
+	vMaxs.y = MAX( SubFloat( maxY, 0 ), SubFloat( maxY, 2 ) );
+	vMaxs.z = MAX( SubFloat( maxZ, 0 ), SubFloat( maxZ, 2 ) );
+}
+
+void CUtlBVH4::Build( const Primitive_t *pPrimitives, int nCount, int nThreads )
+{
+	Purge();
+
+	if ( nCount <= 0 )
+		return;
+
+	CUtlVector< BVH4BuildPrimitive_t > buildPrimitives;
+	buildPrimitives.SetCount( nCount );
+	for ( int i = 0; i < nCount; i++ )
+	{
+		BVH4BuildPrimitive_t &prim = buildPrimitives[i];
+		prim.m_vMins = pPrimitives[i].m_vMins;
+		prim.m_vMaxs = pPrimitives[i].m_vMaxs;
+		prim.m_vCentroid = prim.m_vMins + prim.m_vMaxs;
+		prim.m_nIndex = i;
+	}
+
+	// Every node has at least two children, so there can't be more than nCount - 1 of them.
+	// Allocating them all up front lets the threads hand out indices without locking.
+	m_Nodes.SetCount( MAX( nCount - 1, 1 ) );
+	Assert( ( ( uintp )m_Nodes.Base() & 15 ) == 0 );
+
+	// Queue up enough sub-trees that an unlucky split doesn't leave threads idle
+	int nTaskDepth = -1;
+	if ( nThreads > 1 && nCount >= s_nMinParallelBuildPrimitives )
+	{
+		nTaskDepth = 1;
+		while ( ( 1 << ( 2 * nTaskDepth ) ) < nThreads * 8 && nTaskDepth < 6 )
+		{
+			nTaskDepth++;
+		}
+	}
+
+	CUtlBVH4Builder builder( *this, buildPrimitives.Base(), nTaskDepth );
+	builder.BuildNode( 0, 0, nCount, 0 );
+	builder.RunTasksOnThreads( nThreads );
+
+	m_Nodes.RemoveMultipleFromTail( m_Nodes.Count() - builder.NodeCount() );
+
+	m_Primitives.SetCount( nCount );
+	m_PrimitiveSlots.SetCount( nCount );
+	for ( int i = 0; i < nCount; i++ )
+	{
+		int nIndex = buildPrimitives[i].m_nIndex;
+		m_Primitives[i] = pPrimitives[nIndex];
+		m_PrimitiveSlots[nIndex] = i;
+	}
+}
+
+void CUtlBVH4::Build( const Vector4D *pSpheres, const void * const *ppData, int nCount, int nThreads )
+{
+	CUtlVector< Primitive_t > primitives;
+	primitives.SetCount( nCount );
+	for ( int i = 0; i < nCount; i++ )
+	{
+		Vector vRadius( pSpheres[i].w, pSpheres[i].w, pSpheres[i].w );
+		primitives[i].m_vMins = pSpheres[i].AsVector3D() - vRadius;
+		primitives[i].m_vMaxs = pSpheres[i].AsVector3D() + vRadius;
+		primitives[i].m_pData = ppData[i];
+	}
+
+	Build( primitives.Base(), nCount, nThreads );
+}
+
+void CUtlBVH4::Purge( void )
+{
+	m_Nodes.Purge();
+	m_Primitives.Purge();
+	m_PrimitiveSlots.Purge();
+}
+
+void CUtlBVH4::SetPrimitiveBounds( int nPrimitive, const Vector &vMins, const Vector &vMaxs )
+{
+	Primitive_t &prim = m_Primitives[m_PrimitiveSlots[nPrimitive]];
+	prim.m_vMins = vMins;
+	prim.m_vMaxs = vMaxs;
+}
+
+void CUtlBVH4::Refit( void )
+{
+	// Children always come after their parent, so walking backwards sees every child before its parent
+	for ( int n = m_Nodes.Count() - 1; n >= 0; n-- )
+	{
+		Node_t &node = m_Nodes[n];
+		for ( int i = 0; i < node.m_nChildCount; i++ )
+		{
+			if ( node.m_nLeafMask & ( 1 << i ) )
+			{
+				const Primitive_t &prim = m_Primitives[node.m_nChild[i]];
+				SetChildBounds( node, i, prim.m_vMins, prim.m_vMaxs );
+			}
+			else
+			{
+				Vector vMins, vMaxs;
+				GetNodeBounds( node.m_nChild[i], vMins, vMaxs );
+				SetChildBounds( node, i, vMins, vMaxs );
+			}
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Queries. Each one tests the four children of a node at once, returning a mask
+// of the ones that pass and, in nInside, the ones whose whole sub-tree passes
+// without looking any further.
+//-----------------------------------------------------------------------------
+struct BVH4RayQuery_t
+{
+	BVH4RayQuery_t( const Vector &vStart, const Vector &vDelta )
+	{
+		// A zero delta would turn the slabs into NaNs; a tiny one gives the same answer
+		Vector vInvDelta;
+		for ( int i = 0; i < 3; i++ )
+		{
+			float flDelta = vDelta[i];
+			if ( fabsf( flDelta ) < 1e-20f )
+				flDelta = flDelta < 0.0f ? -1e-20f : 1e-20f;
+			vInvDelta[i] = 1.0f / flDelta;
+		}
+
+		m_StartX = ReplicateX4( vStart.x );
+		m_StartY = ReplicateX4( vStart.y );
+		m_StartZ = ReplicateX4( vStart.z );
+		m_InvDeltaX = ReplicateX4( vInvDelta.x );
+		m_InvDeltaY = ReplicateX4( vInvDelta.y );
+		m_InvDeltaZ = ReplicateX4( vInvDelta.z );
+	}
+
+	FORCEINLINE int Test( const fltx4 &minX, const fltx4 &minY, const fltx4 &minZ, const fltx4 &maxX, const fltx4 &maxY, const fltx4 &maxZ, int &nInside ) const
+	{
+		fltx4 t1X = MulSIMD( SubSIMD( minX, m_StartX ), m_InvDeltaX );
+		fltx4 t2X = MulSIMD( SubSIMD( maxX, m_StartX ), m_InvDeltaX );
+		fltx4 t1Y = MulSIMD( SubSIMD( minY, m_StartY ), m_InvDeltaY );
+		fltx4 t2Y = MulSIMD( SubSIMD( maxY, m_StartY ), m_InvDeltaY );
+		fltx4 t1Z = MulSIMD( SubSIMD( minZ, m_StartZ ), m_InvDeltaZ );
+		fltx4 t2Z = MulSIMD( SubSIMD( maxZ, m_StartZ ), m_InvDeltaZ );
+
+		fltx4 tNear = MaxSIMD( MaxSIMD( MinSIMD( t1X, t2X ), MinSIMD( t1Y, t2Y ) ), MaxSIMD( MinSIMD( t1Z, t2Z ), BVH4_ZERO ) );
+		fltx4 tFar = MinSIMD( MinSIMD( MaxSIMD( t1X, t2X ), MaxSIMD( t1Y, t2Y ) ), MinSIMD( MaxSIMD( t1Z, t2Z ), ReplicateX4( 1.0f ) ) );
+
+		nInside = 0;
+		return TestSignSIMD( CmpLeSIMD( tNear, tFar ) );
+	}
+
+	bool RequireInside() const { return false; }
+
+	fltx4 m_StartX, m_StartY, m_StartZ;
+	fltx4 m_InvDeltaX, m_InvDeltaY, m_InvDeltaZ;
+};
+
+struct BVH4SphereQuery_t
+{
+	BVH4SphereQuery_t( const Vector4D &sphere, bool bPartial ) : m_bPartial( bPartial )
+	{
+		m_CenterX = ReplicateX4( sphere.x );
+		m_CenterY = ReplicateX4( sphere.y );
+		m_CenterZ = ReplicateX4( sphere.z );
+		m_RadiusSqr = ReplicateX4( sphere.w * sphere.w );
+	}
+
+	FORCEINLINE int Test( const fltx4 &minX, const fltx4 &minY, const fltx4 &minZ, const fltx4 &maxX, const fltx4 &maxY, const fltx4 &maxZ, int &nInside ) const
+	{
+		// Distance to the nearest point of the box...
+		fltx4 zero = BVH4_ZERO;
+		fltx4 dX = MaxSIMD( MaxSIMD( SubSIMD( minX, m_CenterX ), SubSIMD( m_CenterX, maxX ) ), zero );
+		fltx4 dY = MaxSIMD( MaxSIMD( SubSIMD( minY, m_CenterY ), SubSIMD( m_CenterY, maxY ) ), zero );
+		fltx4 dZ = MaxSIMD( MaxSIMD( SubSIMD( minZ, m_CenterZ ), SubSIMD( m_CenterZ, maxZ ) ), zero );
+		fltx4 nearSqr = AddSIMD( MulSIMD( dX, dX ), AddSIMD( MulSIMD( dY, dY ), MulSIMD( dZ, dZ ) ) );
+
+		// ...and to the farthest corner
+		fltx4 fX = MaxSIMD( SubSIMD( m_CenterX, minX ), SubSIMD( maxX, m_CenterX ) );
+		fltx4 fY = MaxSIMD( SubSIMD( m_CenterY, minY ), SubSIMD( maxY, m_CenterY ) );
+		fltx4 fZ = MaxSIMD( SubSIMD( m_CenterZ, minZ ), SubSIMD( maxZ, m_CenterZ ) );
+		fltx4 farSqr = AddSIMD( MulSIMD( fX, fX ), AddSIMD( MulSIMD( fY, fY ), MulSIMD( fZ, fZ ) ) );
+
+		nInside = TestSignSIMD( CmpLeSIMD( farSqr, m_RadiusSqr ) );
+		return TestSignSIMD( CmpLeSIMD( nearSqr, m_RadiusSqr ) );
+	}
+
+	bool RequireInside() const { return !m_bPartial; }
+
+	fltx4 m_CenterX, m_CenterY, m_CenterZ;
+	fltx4 m_RadiusSqr;
+	bool m_bPartial;
+};
+
+struct BVH4BoxQuery_t
+{
+	BVH4BoxQuery_t( const Vector &vMins, const Vector &vMaxs )
+	{
+		m_MinX = ReplicateX4( vMins.x );
+		m_MinY = ReplicateX4( vMins.y );
+		m_MinZ = ReplicateX4( vMins.z );
+		m_MaxX = ReplicateX4( vMaxs.x );
+		m_MaxY = ReplicateX4( vMaxs.y );
+		m_MaxZ = ReplicateX4( vMaxs.z );
+	}
+
+	FORCEINLINE int Test( const fltx4 &minX, const fltx4 &minY, const fltx4 &minZ, const fltx4 &maxX, const fltx4 &maxY, const fltx4 &maxZ, int &nInside ) const
+	{
+		bi32x4 overlap = AndSIMD( AndSIMD( CmpLeSIMD( minX, m_MaxX ), CmpGeSIMD( maxX, m_MinX ) ),
+			AndSIMD( AndSIMD( CmpLeSIMD( minY, m_MaxY ), CmpGeSIMD( maxY, m_MinY ) ),
+			AndSIMD( CmpLeSIMD( minZ, m_MaxZ ), CmpGeSIMD( maxZ, m_MinZ ) ) ) );
+		bi32x4 inside = AndSIMD( AndSIMD( CmpGeSIMD( minX, m_MinX ), CmpLeSIMD( maxX, m_MaxX ) ),
+			AndSIMD( AndSIMD( CmpGeSIMD( minY, m_MinY ), CmpLeSIMD( maxY, m_MaxY ) ),
+			AndSIMD( CmpGeSIMD( minZ, m_MinZ ), CmpLeSIMD( maxZ, m_MaxZ ) ) ) );
+
+		nInside = TestSignSIMD( inside );
+		return TestSignSIMD( overlap );
+	}
+
+	bool RequireInside() const { return false; }
+
+	fltx4 m_MinX, m_MinY, m_MinZ;
+	fltx4 m_MaxX, m_MaxY, m_MaxZ;
+};
+
+struct BVH4FrustumQuery_t
+{
+	struct Plane_t
+	{
+		fltx4 m_NormalX, m_NormalY, m_NormalZ;
+		fltx4 m_Dist;
+		bool m_bNegative[3];
+	};
+
+	BVH4FrustumQuery_t( const Frustum_t &frustum ) : m_nPlanes( 0 )
+	{
+		for ( int i = 0; i < 8; i++ )
+		{
+			const fourplanes_t &planes = frustum.planes[i >> 2];
+			float flNormal[3] = { SubFloat( planes.nX, i & 3 ), SubFloat( planes.nY, i & 3 ), SubFloat( planes.nZ, i & 3 ) };
+			float flDist = SubFloat( planes.dist, i & 3 );
+
+			// The unused slots have a zero normal and distance and never cull anything
+			if ( flNormal[0] == 0.0f && flNormal[1] == 0.0f && flNormal[2] == 0.0f && flDist <= 0.0f )
+				continue;
+
+			Plane_t &plane = m_Planes[m_nPlanes++];
+			plane.m_NormalX = ReplicateX4( flNormal[0] );
+			plane.m_NormalY = ReplicateX4( flNormal[1] );
+			plane.m_NormalZ = ReplicateX4( flNormal[2] );
+			plane.m_Dist = ReplicateX4( flDist );
+			for ( int c = 0; c < 3; c++ )
+			{
+				plane.m_bNegative[c] = flNormal[c] < 0.0f;
+			}
+		}
+	}
+
+	FORCEINLINE int Test( const fltx4 &minX, const fltx4 &minY, const fltx4 &minZ, const fltx4 &maxX, const fltx4 &maxY, const fltx4 &maxZ, int &nInside ) const
+	{
+		// Culled if the farthest corner along any normal is behind that plane (as Frustum_t::CullBox),
+		// entirely inside if the nearest corner is in front of all of them
+		bi32x4 culled = ( bi32x4 )BVH4_ZERO, outside = ( bi32x4 )BVH4_ZERO;
+		for ( int i = 0; i < m_nPlanes; i++ )
+		{
+			const Plane_t &plane = m_Planes[i];
+			fltx4 dotFar = AddSIMD( MulSIMD( plane.m_NormalX, plane.m_bNegative[0] ? minX : maxX ),
+				AddSIMD( MulSIMD( plane.m_NormalY, plane.m_bNegative[1] ? minY : maxY ), MulSIMD( plane.m_NormalZ, plane.m_bNegative[2] ? minZ : maxZ ) ) );
+			fltx4 dotNear = AddSIMD( MulSIMD( plane.m_NormalX, plane.m_bNegative[0] ? maxX : minX ),
+				AddSIMD( MulSIMD( plane.m_NormalY, plane.m_bNegative[1] ? maxY : minY ), MulSIMD( plane.m_NormalZ, plane.m_bNegative[2] ? maxZ : minZ ) ) );
+
+			culled = OrSIMD( culled, CmpLtSIMD( dotFar, plane.m_Dist ) );
+			outside = OrSIMD( outside, CmpLtSIMD( dotNear, plane.m_Dist ) );
+		}
+
+		nInside = ~TestSignSIMD( outside ) & 15;
+		return ~TestSignSIMD( culled ) & 15;
+	}
+
+	bool RequireInside() const { return false; }
+
+	Plane_t m_Planes[8];
+	int m_nPlanes;
+};
+
+// Replicates one primitive's box across all four lanes, for the single primitive refs of a Cut
+#define BVH4_PRIMITIVE_LANES( prim ) \
+	ReplicateX4( ( prim ).m_vMins.x ), ReplicateX4( ( prim ).m_vMins.y ), ReplicateX4( ( prim ).m_vMins.z ), \
+	ReplicateX4( ( prim ).m_vMaxs.x ), ReplicateX4( ( prim ).m_vMaxs.y ), ReplicateX4( ( prim ).m_vMaxs.z )
+
+#define BVH4_NODE_LANES( node ) \
+	( node ).m_MinX, ( node ).m_MinY, ( node ).m_MinZ, ( node ).m_MaxX, ( node ).m_MaxY, ( node ).m_MaxZ
+
+template < class QUERY >
+int CUtlBVH4::Traverse( const QUERY &query, CUtlVector< void * > &result, int maxResults, const Cut *cut ) const
+{
+	result.RemoveAll();
+	if ( !m_Nodes.Count() )
+		return 0;
+
+	Assert( !cut || cut->m_pTree == this );
+	if ( cut && cut->m_pTree != this )
+		return 0;
+
+	maxResults = maxResults ? maxResults : 0x7FFFFFFF;
+	int count = maxResults;
+
+	CUtlVectorFixedGrowable< int, 128 > stack;
+	if ( cut )
+	{
+		for ( int i = 0; i < cut->m_NodeRefs.Count(); i++ )
+		{
+			int nRef = cut->m_NodeRefs[i];
+			if ( nRef >= 0 )
+			{
+				stack.AddToTail( nRef );
+				continue;
+			}
+
+			const Primitive_t &prim = m_Primitives[~nRef];
+			int nInside;
+			int nHit = query.Test( BVH4_PRIMITIVE_LANES( prim ), nInside );
+			if ( ( query.RequireInside() ? nInside : nHit ) & 1 )
+			{
+				if ( count > 0 )
+					result.AddToTail( ( void * )prim.m_pData );
+				count--;
+			}
+		}
+	}
+	else
+	{
+		stack.AddToTail( 0 );
+	}
+
+	while ( stack.Count() )
+	{
+		const Node_t &node = m_Nodes[stack.Tail()];
+		stack.RemoveMultipleFromTail( 1 );
+
+		int nInside;
+		int nHit = query.Test( BVH4_NODE_LANES( node ), nInside ) & ( ( 1 << node.m_nChildCount ) - 1 );
+		nInside &= nHit;
+
+		int nAccept = query.RequireInside() ? nInside : nHit;
+		for ( int i = 0; i < node.m_nChildCount; i++ )
+		{
+			const int nBit = 1 << i;
+			if ( !( nHit & nBit ) )
+				continue;
+
+			if ( node.m_nLeafMask & nBit )
+			{
+				if ( nAccept & nBit )
+				{
+					if ( count > 0 )
+						result.AddToTail( ( void * )m_Primitives[node.m_nChild[i]].m_pData );
+					count--;
+				}
+			}
+			else if ( nInside & nBit )
+			{
+				GetLeavesUnderNode( node.m_nChild[i], result, count );
+			}
+			else
+			{
+				stack.AddToTail( node.m_nChild[i] );
+			}
+		}
+	}
+
+	return ( maxResults - count );
+}
+
+int CUtlBVH4::IntersectWithRay( const Vector &rayStart, const Vector &rayDelta, CUtlVector< void * > &result, int maxResults, const Cut *cut ) const
+{
+	return Traverse( BVH4RayQuery_t( rayStart, rayDelta ), result, maxResults, cut );
+}
+
+int CUtlBVH4::IntersectWithSphere( const Vector4D &sphere, bool bPartial, CUtlVector< void * > &result, int maxResults, const Cut *cut ) const
+{
+	return Traverse( BVH4SphereQuery_t( sphere, bPartial ), result, maxResults, cut );
+}
+
+int CUtlBVH4::IntersectWithBox( const Vector &vMins, const Vector &vMaxs, CUtlVector< void * > &result, int maxResults, const Cut *cut ) const
+{
+	return Traverse( BVH4BoxQuery_t( vMins, vMaxs ), result, maxResults, cut );
+}
+
+int CUtlBVH4::IntersectWithFrustum( const Frustum_t &frustum, CUtlVector< void * > &result, int maxResults, const Cut *cut ) const
+{
+	return Traverse( BVH4FrustumQuery_t( frustum ), result, maxResults, cut );
+}
+
+void CUtlBVH4::GetLeavesUnderNode( int nNode, CUtlVector< void * > &leaves, int &count ) const
+{
+	// Every sub-tree owns a contiguous run of primitive slots
+	const Node_t &node = m_Nodes[nNode];
+	for ( int i = 0; i < node.m_nPrimitiveCount; i++ )
+	{
+		if ( count > 0 )
+			leaves.AddToTail( ( void * )m_Primitives[node.m_nFirstPrimitive + i].m_pData );
+		count--;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Cut
+//-----------------------------------------------------------------------------
+CUtlBVH4::Cut::Cut( const CUtlBVH4 *pTree ) : m_pTree( pTree )
+{
+	if ( pTree->m_Nodes.Count() )
+	{
+		m_NodeRefs.AddToTail( 0 );
+	}
+}
+
+int CUtlBVH4::Cut::GetLeaves( CUtlVector< void * > &leaves, int maxLeaves ) const
+{
+	leaves.RemoveAll();
+	maxLeaves = maxLeaves ? maxLeaves : 0x7FFFFFFF;
+	int count = maxLeaves;
+
+	for ( int i = 0; i < m_NodeRefs.Count(); i++ )
+	{
+		int nRef = m_NodeRefs[i];
+		if ( nRef >= 0 )
+		{
+			m_pTree->GetLeavesUnderNode( nRef, leaves, count );
+		}
+		else
+		{
+			if ( count > 0 )
+				leaves.AddToTail( ( void * )m_pTree->m_Primitives[~nRef].m_pData );
+			count--;
+		}
+	}
+
+	return ( maxLeaves - count );
+}
+
+struct BVH4PlaneCut_t
+{
+	fltx4 m_NormalX, m_NormalY, m_NormalZ;
+	fltx4 m_AbsNormalX, m_AbsNormalY, m_AbsNormalZ;
+	fltx4 m_Dist;
+};
+
+//-----------------------------------------------------------------------------
+// Same rules as CUtlSphereTree::CutByPlanes_R, with the projected half extent of
+// each box taking the place of the sphere radius:
+//   AND:	fail any plane -> FAIL, pass all planes -> PASS, otherwise PARTIAL
+//   OR:	fail all planes -> FAIL, pass any plane -> PASS, otherwise PARTIAL
+//-----------------------------------------------------------------------------
+static FORCEINLINE void CutFourBoxesByPlanes( const BVH4PlaneCut_t *pPlanes, int numPlanes, bool bOr,
+	const fltx4 &minX, const fltx4 &minY, const fltx4 &minZ, const fltx4 &maxX, const fltx4 &maxY, const fltx4 &maxZ, int &nPass, int &nFail )
+{
+	fltx4 half = ReplicateX4( 0.5f );
+	fltx4 centerX = MulSIMD( AddSIMD( minX, maxX ), half );
+	fltx4 centerY = MulSIMD( AddSIMD( minY, maxY ), half );
+	fltx4 centerZ = MulSIMD( AddSIMD( minZ, maxZ ), half );
+	fltx4 extentX = MulSIMD( SubSIMD( maxX, minX ), half );
+	fltx4 extentY = MulSIMD( SubSIMD( maxY, minY ), half );
+	fltx4 extentZ = MulSIMD( SubSIMD( maxZ, minZ ), half );
+
+	bi32x4 none = ( bi32x4 )BVH4_ZERO;
+	bi32x4 all = CmpEqSIMD( BVH4_ZERO, BVH4_ZERO );
+	bi32x4 pass = bOr ? none : all;
+	bi32x4 fail = bOr ? all : none;
+
+	for ( int i = 0; i < numPlanes; i++ )
+	{
+		const BVH4PlaneCut_t &plane = pPlanes[i];
+		fltx4 dist = SubSIMD( AddSIMD( MulSIMD( plane.m_NormalX, centerX ), AddSIMD( MulSIMD( plane.m_NormalY, centerY ), MulSIMD( plane.m_NormalZ, centerZ ) ) ), plane.m_Dist );
+		fltx4 radius = AddSIMD( MulSIMD( plane.m_AbsNormalX, extentX ), AddSIMD( MulSIMD( plane.m_AbsNormalY, extentY ), MulSIMD( plane.m_AbsNormalZ, extentZ ) ) );
+
+		bi32x4 planePass = CmpGeSIMD( dist, radius );
+		bi32x4 planeFail = CmpLtSIMD( dist, SubSIMD( BVH4_ZERO, radius ) );
+		if ( bOr )
+		{
+			pass = OrSIMD( pass, planePass );
+			fail = AndSIMD( fail, planeFail );
+		}
+		else
+		{
+			pass = AndSIMD( pass, planePass );
+			fail = OrSIMD( fail, planeFail );
+		}
+	}
+
+	nPass = TestSignSIMD( pass );
+	nFail = TestSignSIMD( fail ) & ~nPass;
+}
+
+void CUtlBVH4::CutByPlanes( Cut *outputCut, const Cut *inputCut, int cutFlags, const Vector4D *planes, int numPlanes ) const
+{
+	Assert( outputCut );
+	if ( !outputCut || !m_Nodes.Count() )
+		return;
+
+	// Default to cutting the whole tree
+	Cut completeCut( this );
+	if ( inputCut == NULL )
+		inputCut = &completeCut;
+
+	if ( inputCut == outputCut )
+	{
+		completeCut.m_NodeRefs.RemoveAll();
+		completeCut.m_NodeRefs.AddMultipleToTail( inputCut->m_NodeRefs.Count(), inputCut->m_NodeRefs.Base() );
+		inputCut = &completeCut;
+	}
+
+	Assert( inputCut->m_pTree == this );
+	outputCut->m_NodeRefs.RemoveAll();
+
+	CUtlVectorFixedGrowable< BVH4PlaneCut_t, 8 > planeCuts;
+	planeCuts.SetCount( numPlanes );
+	for ( int i = 0; i < numPlanes; i++ )
+	{
+		BVH4PlaneCut_t &plane = planeCuts[i];
+		plane.m_NormalX = ReplicateX4( planes[i].x );
+		plane.m_NormalY = ReplicateX4( planes[i].y );
+		plane.m_NormalZ = ReplicateX4( planes[i].z );
+		plane.m_AbsNormalX = ReplicateX4( fabsf( planes[i].x ) );
+		plane.m_AbsNormalY = ReplicateX4( fabsf( planes[i].y ) );
+		plane.m_AbsNormalZ = ReplicateX4( fabsf( planes[i].z ) );
+		plane.m_Dist = ReplicateX4( planes[i].w );
+	}
+
+	const bool bOr = ( cutFlags & Cut::OR_INTERSECTIONS ) != 0;
+	const bool bPartial = ( cutFlags & Cut::PARTIAL_INTERSECTIONS ) != 0;
+
+	CUtlVectorFixedGrowable< int, 128 > stack;
+	for ( int i = 0; i < inputCut->m_NodeRefs.Count(); i++ )
+	{
+		int nRef = inputCut->m_NodeRefs[i];
+		if ( nRef >= 0 )
+		{
+			stack.AddToTail( nRef );
+			continue;
+		}
+
+		int nPass, nFail;
+		CutFourBoxesByPlanes( planeCuts.Base(), numPlanes, bOr, BVH4_PRIMITIVE_LANES( m_Primitives[~nRef] ), nPass, nFail );
+		if ( ( nPass & 1 ) || ( bPartial && !( nFail & 1 ) ) )
+		{
+			outputCut->m_NodeRefs.AddToTail( nRef );
+		}
+	}
+
+	while ( stack.Count() )
+	{
+		int nNode = stack.Tail();
+		stack.RemoveMultipleFromTail( 1 );
+
+		const Node_t &node = m_Nodes[nNode];
+		const int nValid = ( 1 << node.m_nChildCount ) - 1;
+
+		int nPass, nFail;
+		CutFourBoxesByPlanes( planeCuts.Base(), numPlanes, bOr, BVH4_NODE_LANES( node ), nPass, nFail );
+		nPass &= nValid;
+
+		// Keep the node itself rather than each of its children
+		if ( nPass == nValid )
+		{
+			outputCut->m_NodeRefs.AddToTail( nNode );
+			continue;
+		}
+
+		for ( int i = 0; i < node.m_nChildCount; i++ )
+		{
+			const int nBit = 1 << i;
+			const bool bLeaf = ( node.m_nLeafMask & nBit ) != 0;
+			const int nRef = bLeaf ? ~node.m_nChild[i] : node.m_nChild[i];
+
+			if ( nPass & nBit )
+			{
+				outputCut->m_NodeRefs.AddToTail( nRef );
+			}
+			else if ( !( nFail & nBit ) )
+			{
+				if ( !bLeaf )
+				{
+					stack.AddToTail( nRef );
+				}
+				else if ( bPartial )
+				{
+					outputCut->m_NodeRefs.AddToTail( nRef );
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,301 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: Read-only CUtlBuffer over a memory mapped file
+//
+//=============================================================================//
+
+#include "tier1/utlmappedbuffer.h"
+#include "tier0/dbg.h"
+
+#ifdef _WIN32
+#include "winlite.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// memdbgon must be the last include file in a .cpp file!!!
+#include "tier0/memdbgon.h"
+
+
+//-----------------------------------------------------------------------------
+// Granularity mapping offsets have to be aligned to
+//-----------------------------------------------------------------------------
+static uint64 GetMappingGranularity()
+{
+	static uint64 s_nGranularity = 0;
+	if ( !s_nGranularity )
+	{
+#ifdef _WIN32
+		SYSTEM_INFO info;
+		GetSystemInfo( &info );
+		s_nGranularity = info.dwAllocationGranularity;
+#else
+		s_nGranularity = (uint64)sysconf( _SC_PAGESIZE );
+#endif
+	}
+
+	return s_nGranularity;
+}
+
+
+CUtlMappedBuffer::CUtlMappedBuffer()
+{
+#ifdef _WIN32
+	m_hFile = NULL;
+	m_hMapping = NULL;
+#else
+	m_fd = -1;
+#endif
+	m_cubFile = 0;
+	m_pView = NULL;
+	m_cubView = 0;
+	m_ulWindowOffset = 0;
+	m_cubWindow = 0;
+	m_bTextBuffer = false;
+}
+
+CUtlMappedBuffer::~CUtlMappedBuffer()
+{
+	Close();
+}
+
+
+//-----------------------------------------------------------------------------
+// Purpose: opens the file and maps the first window of it
+//-----------------------------------------------------------------------------
+bool CUtlMappedBuffer::Open( const char *pszFileName, AccessHint_t eHint, bool bTextBuffer )
+{
+	Close();
+
+	m_bTextBuffer = bTextBuffer;
+
+#ifdef _WIN32
+	DWORD dwFlags = FILE_ATTRIBUTE_NORMAL;
+	if ( eHint == ACCESS_SEQUENTIAL )
+		dwFlags |= FILE_FLAG_SEQUENTIAL_SCAN;
+	else if ( eHint == ACCESS_RANDOM )
+		dwFlags |= FILE_FLAG_RANDOM_ACCESS;
+
+	HANDLE hFile = ::CreateFileA( pszFileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, dwFlags, NULL );
+	if ( hFile == INVALID_HANDLE_VALUE )
+		return false;
+
+	LARGE_INTEGER liSize;
+	if ( !::GetFileSizeEx( hFile, &liSize ) )
+	{
+		::CloseHandle( hFile );
+		return false;
+	}
+
+	m_hFile = hFile;
+	m_cubFile = liSize.QuadPart;
+
+	// CreateFileMapping refuses empty files, they just never get a view
+	if ( m_cubFile )
+	{
+		// PAGE_WRITECOPY so views can be FILE_MAP_COPY (private pages on write)
+		m_hMapping = ::CreateFileMappingA( hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL );
+		if ( !m_hMapping )
+		{
+			Close();
+			return false;
+		}
+	}
+#else
+	int fd = open( pszFileName, O_RDONLY | O_CLOEXEC );
+	if ( fd < 0 )
+		return false;
+
+	struct stat st;
+	if ( fstat( fd, &st ) != 0 || !S_ISREG( st.st_mode ) )
+	{
+		close( fd );
+		return false;
+	}
+
+	m_fd = fd;
+	m_cubFile = st.st_size;
+#endif
+
+	return MapWindow( 0, k_cubMaxWindow, eHint );
+}
+
+
+//-----------------------------------------------------------------------------
+// Purpose: unmaps and closes the file
+//-----------------------------------------------------------------------------
+void CUtlMappedBuffer::Close()
+{
+	Unmap();
+
+#ifdef _WIN32
+	if ( m_hMapping )
+	{
+		::CloseHandle( m_hMapping );
+		m_hMapping = NULL;
+	}
+
+	if ( m_hFile )
+	{
+		::CloseHandle( m_hFile );
+		m_hFile = NULL;
+	}
+#else
+	if ( m_fd >= 0 )
+	{
+		close( m_fd );
+		m_fd = -1;
+	}
+#endif
+
+	m_cubFile = 0;
+}
+
+
+void CUtlMappedBuffer::Unmap()
+{
+	// drop the buffer's reference to the view before it goes away
+	m_Buffer.SetExternalBuffer( NULL, 0, 0, CUtlBuffer::READ_ONLY );
+
+	if ( m_pView )
+	{
+#ifdef _WIN32
+		::UnmapViewOfFile( m_pView );
+#else
+		munmap( m_pView, m_cubView );
+#endif
+		m_pView = NULL;
+	}
+
+	m_cubView = 0;
+	m_ulWindowOffset = 0;
+	m_cubWindow = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// Purpose: points the buffer at a different range of the file
+//-----------------------------------------------------------------------------
+bool CUtlMappedBuffer::MapWindow( uint64 ulOffset, uint32 cubSize, AccessHint_t eHint )
+{
+	if ( !IsOpen() || ulOffset > m_cubFile )
+		return false;
+
+	Unmap();
+
+	cubSize = (uint32)MIN( (uint64)MIN( cubSize, k_cubMaxWindow ), m_cubFile - ulOffset );
+
+	m_ulWindowOffset = ulOffset;
+	m_cubWindow = cubSize;
+
+	if ( !cubSize )
+		return true;
+
+	uint64 ulViewOffset = ulOffset - ( ulOffset % GetMappingGranularity() );
+	size_t cubView = (size_t)( ulOffset - ulViewOffset ) + cubSize;
+
+#ifdef _WIN32
+	m_pView = ::MapViewOfFile( m_hMapping, FILE_MAP_COPY, (DWORD)( ulViewOffset >> 32 ), (DWORD)( ulViewOffset & 0xffffffff ), cubView );
+	if ( !m_pView )
+	{
+		m_cubWindow = 0;
+		return false;
+	}
+#else
+	// MAP_PRIVATE + PROT_WRITE is still zero-copy until something writes into a page
+	void *pView = mmap( NULL, cubView, PROT_READ | PROT_WRITE, MAP_PRIVATE, m_fd, (off_t)ulViewOffset );
+	if ( pView == MAP_FAILED )
+	{
+		m_cubWindow = 0;
+		return false;
+	}
+
+	m_pView = pView;
+#endif
+
+	m_cubView = cubView;
+
+	Advise( 0, cubSize, eHint );
+
+	int nFlags = CUtlBuffer::READ_ONLY;
+	if ( m_bTextBuffer )
+		nFlags |= CUtlBuffer::TEXT_BUFFER;
+
+	m_Buffer.SetExternalBuffer( Base(), cubSize, cubSize, (CUtlBuffer::BufferFlags_t)nFlags );
+	return true;
+}
+
+
+bool CUtlMappedBuffer::MapNextWindow( AccessHint_t eHint )
+{
+	uint64 ulNextOffset = m_ulWindowOffset + m_cubWindow;
+	if ( !IsOpen() || ulNextOffset >= m_cubFile )
+		return false;
+
+	return MapWindow( ulNextOffset, k_cubMaxWindow, eHint );
+}
+
+
+//-----------------------------------------------------------------------------
+// Purpose: passes an access pattern for part of the window on to the kernel
+//-----------------------------------------------------------------------------
+void CUtlMappedBuffer::Advise( uint32 nOffset, uint32 cubSize, AccessHint_t eHint )
+{
+	if ( !m_pView || nOffset >= m_cubWindow )
+		return;
+
+	cubSize = MIN( cubSize, m_cubWindow - nOffset );
+
+#ifdef _WIN32
+	// the open flags already carry sequential/random, prefetching is the only thing left
+	if ( eHint == ACCESS_WILLNEED )
+	{
+		typedef BOOL ( WINAPI *PrefetchVirtualMemoryFn_t )( HANDLE, ULONG_PTR, void *, ULONG );
+		static PrefetchVirtualMemoryFn_t s_pfnPrefetch = (PrefetchVirtualMemoryFn_t)::GetProcAddress( ::GetModuleHandleA( "kernel32.dll" ), "PrefetchVirtualMemory" );
+		if ( s_pfnPrefetch )
+		{
+			struct { void *pAddress; SIZE_T nBytes; } range = { Base() + nOffset, cubSize };
+			s_pfnPrefetch( ::GetCurrentProcess(), 1, &range, 0 );
+		}
+	}
+#else
+	int nAdvice;
+	switch ( eHint )
+	{
+	case ACCESS_SEQUENTIAL:
+		nAdvice = MADV_SEQUENTIAL;
+		break;
+	case ACCESS_RANDOM:
+		nAdvice = MADV_RANDOM;
+		break;
+	case ACCESS_WILLNEED:
+		nAdvice = MADV_WILLNEED;
+		break;
+	default:
+		nAdvice = MADV_NORMAL;
+		break;
+	}
+
+	// madvise wants a page aligned start
+	uint8 *pStart = Base() + nOffset;
+	uint8 *pAligned = (uint8 *)( (uintp)pStart & ~( (uintp)GetMappingGranularity() - 1 ) );
+	madvise( pAligned, ( pStart - pAligned ) + cubSize, nAdvice );
+#endif
+}
+
+
+unsigned char *CUtlMappedBuffer::Base()
+{
+	if ( !m_pView )
+		return NULL;
+
+	return (unsigned char *)m_pView + ( m_ulWindowOffset % GetMappingGranularity() );
+}
+
+const unsigned char *CUtlMappedBuffer::Base() const
+{
+	return const_cast<CUtlMappedBuffer *>( this )->Base();
+}
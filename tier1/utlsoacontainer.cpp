@@ -15,6 +15,7 @@
 #include "mathlib/halton.h"
 #include "vstdlib/jobthread.h"
 #include "tier1/callqueue.h"
+#include "tier1/utlvector.h"
 
 
 // memdbgon must be the last include file in a .cpp file!!!
@@ -886,6 +887,197 @@ void KMeansQuantizationWorkUnit::Process( void )
 	}
 }
 
+// Plain euclidean k-means over the fields themselves, which is what KMeansQuantization does when it
+// is not given an error metric. The assignment is Hamerly's ("Making k-means even faster"): each
+// sample keeps an upper bound on the distance to its centroid and a lower bound on the distance to
+// all the others, and only searches every centroid once their movement has made the bounds overlap.
+struct KMeansEuclideanContext_t
+{
+	CSOAContainer *m_pContainer;
+	int const *m_pFieldIndices;
+	int m_nNumFields;
+	int m_nFieldToStoreIndexInto;
+	int m_nErrorChannel;								// only written on the last pass
+	KMeansQuantizedValue const *m_pValues;
+	int m_nNumValues;
+	float const *m_pDrift;								// how far each centroid moved in the last update
+	float const *m_pHalfSeparation;						// half the distance from each centroid to the nearest other one
+	float m_flMaxDrift;
+	fltx4 *m_pUpperBounds;								// a quad per quad of samples, rows and slices packed
+	fltx4 *m_pLowerBounds;
+	bool m_bFirstPass;
+	bool m_bLastPass;
+};
+
+static FORCEINLINE fltx4 GatherKMeansValues( float const *pPerValue, fltx4 const &fl4Index )
+{
+	ALIGN16 float flValues[4] ALIGN16_POST;
+	for( int s = 0; s < 4; s++ )
+	{
+		flValues[s] = pPerValue[( int )SubFloat( fl4Index, s )];
+	}
+	return LoadAlignedSIMD( flValues );
+}
+
+// squared distance from four samples to the centroids they are assigned to
+static FORCEINLINE fltx4 KMeansAssignedDistSqr( KMeansEuclideanContext_t const &context, fltx4 const *pSample, fltx4 const &fl4Index )
+{
+	int nIndex[4];
+	for( int s = 0; s < 4; s++ )
+	{
+		nIndex[s] = ( int )SubFloat( fl4Index, s );
+	}
+
+	fltx4 fl4DistSqr = Four_Zeros;
+	for( int c = 0; c < context.m_nNumFields; c++ )
+	{
+		ALIGN16 float flCentroid[4] ALIGN16_POST;
+		for( int s = 0; s < 4; s++ )
+		{
+			flCentroid[s] = SubFloat( context.m_pValues[nIndex[s]].m_fl4Values[c], 0 );
+		}
+		fltx4 fl4Delta = SubSIMD( pSample[c], LoadAlignedSIMD( flCentroid ) );
+		fl4DistSqr = MaddSIMD( fl4Delta, fl4Delta, fl4DistSqr );
+	}
+	return fl4DistSqr;
+}
+
+static void KMeansAssignEuclidean( KMeansEuclideanContext_t *pContext, int nStartRow, int nNumRows )
+{
+	CSOAContainer *pContainer = pContext->m_pContainer;
+	const int nNumFields = pContext->m_nNumFields;
+	const int nQuadsPerRow = pContainer->NumQuadsPerRow();
+	const fltx4 fl4MaxDrift = ReplicateX4( pContext->m_flMaxDrift );
+
+	for( int nRow = nStartRow; nRow < nStartRow + nNumRows; nRow++ )
+	{
+		const int nY = nRow % pContainer->NumRows();
+		const int nZ = nRow / pContainer->NumRows();
+
+		fltx4 const *pFields[MAX_SOA_FIELDS];
+		for( int c = 0; c < nNumFields; c++ )
+		{
+			pFields[c] = pContainer->RowPtr<fltx4>( pContext->m_pFieldIndices[c], nY, nZ );
+		}
+		fltx4 *pIndexOut = pContainer->RowPtr<fltx4>( pContext->m_nFieldToStoreIndexInto, nY, nZ );
+		fltx4 *pErrOut = NULL;
+		if ( pContext->m_bLastPass && ( pContext->m_nErrorChannel != -1 ) )
+		{
+			pErrOut = pContainer->RowPtr<fltx4>( pContext->m_nErrorChannel, nY, nZ );
+		}
+		fltx4 *pUpper = pContext->m_pUpperBounds + nRow * nQuadsPerRow;
+		fltx4 *pLower = pContext->m_pLowerBounds + nRow * nQuadsPerRow;
+
+		for( int q = 0; q < nQuadsPerRow; q++ )
+		{
+			fltx4 fl4Sample[MAX_SOA_FIELDS];
+			for( int c = 0; c < nNumFields; c++ )
+			{
+				fl4Sample[c] = pFields[c][q];
+			}
+
+			if ( !pContext->m_bFirstPass )
+			{
+				// still closer to their centroid than it can be to any other?
+				fltx4 fl4Index = pIndexOut[q];
+				fltx4 fl4Upper = AddSIMD( pUpper[q], GatherKMeansValues( pContext->m_pDrift, fl4Index ) );
+				fltx4 fl4Lower = SubSIMD( pLower[q], fl4MaxDrift );
+				fltx4 fl4Bound = MaxSIMD( GatherKMeansValues( pContext->m_pHalfSeparation, fl4Index ), fl4Lower );
+				bool bKeep = ( TestSignSIMD( CmpLtSIMD( fl4Upper, fl4Bound ) ) == 0xf );
+				if ( !bKeep || pErrOut )
+				{
+					// the upper bound may just have drifted too far: tighten it and try again
+					fltx4 fl4DistSqr = KMeansAssignedDistSqr( *pContext, fl4Sample, fl4Index );
+					fl4Upper = SqrtSIMD( fl4DistSqr );
+					bKeep = ( TestSignSIMD( CmpLtSIMD( fl4Upper, fl4Bound ) ) == 0xf );
+					if ( bKeep && pErrOut )
+					{
+						pErrOut[q] = fl4DistSqr;
+					}
+				}
+				if ( bKeep )
+				{
+					pUpper[q] = fl4Upper;
+					pLower[q] = fl4Lower;
+					continue;
+				}
+			}
+
+			// simd closest match search, tracking the second closest for the lower bound
+			fltx4 fl4SampleIdx = Four_Zeros;
+			fltx4 fl4ClosestError = Four_FLT_MAX;
+			fltx4 fl4SecondError = Four_FLT_MAX;
+			fltx4 fl4BestSampleIdx = Four_Zeros;
+			for( int n = 0; n < pContext->m_nNumValues; n++ )
+			{
+				fltx4 const *pCentroid = pContext->m_pValues[n].m_fl4Values;
+				fltx4 fl4TrialError = Four_Zeros;
+				for( int c = 0; c < nNumFields; c++ )
+				{
+					fltx4 fl4Delta = SubSIMD( fl4Sample[c], pCentroid[c] );
+					fl4TrialError = MaddSIMD( fl4Delta, fl4Delta, fl4TrialError );
+				}
+				bi32x4 fl4BetterMask = CmpLeSIMD( fl4TrialError, fl4ClosestError );
+				fl4SecondError = MaskedAssign( fl4BetterMask, fl4ClosestError, MinSIMD( fl4SecondError, fl4TrialError ) );
+				fl4BestSampleIdx = MaskedAssign( fl4BetterMask, fl4SampleIdx, fl4BestSampleIdx );
+				fl4ClosestError = MaskedAssign( fl4BetterMask, fl4TrialError, fl4ClosestError );
+				fl4SampleIdx = AddSIMD( fl4SampleIdx, Four_Ones );
+			}
+			pIndexOut[q] = fl4BestSampleIdx;
+			pUpper[q] = SqrtSIMD( fl4ClosestError );
+			pLower[q] = SqrtSIMD( fl4SecondError );
+			if ( pErrOut )
+			{
+				pErrOut[q] = fl4ClosestError;
+			}
+		}
+	}
+}
+
+// Adds the samples to the centroids they were assigned. The sums have to come out bit for bit the
+// same as the error metric path's, so this goes in its order: every lane of every quad, the
+// padding at the end of a row included, with each row adding into the accumulators of the job
+// that would have had it
+static void KMeansAccumulateEuclidean( CSOAContainer &data, int const *pFieldIndices, int nNumFields,
+									   KMeansQuantizedValue *pOutValues, int nFieldToStoreIndexInto )
+{
+	for( int nZ = 0; nZ < data.NumSlices(); nZ++ )
+	{
+		for( int nY = 0; nY < data.NumRows(); nY++ )
+		{
+			const int nJob = nY % QUANTIZER_NJOBS;
+			fltx4 const *pIndex = data.RowPtr<fltx4>( nFieldToStoreIndexInto, nY, nZ );
+			fltx4 const *pFields[MAX_SOA_FIELDS];
+			for( int c = 0; c < nNumFields; c++ )
+			{
+				pFields[c] = data.RowPtr<fltx4>( pFieldIndices[c], nY, nZ );
+			}
+			for( int q = 0; q < data.NumQuadsPerRow(); q++ )
+			{
+				for( int s = 0; s < 4; s++ )
+				{
+					int nIdx = ( int )SubFloat( pIndex[q], s );
+					for( int c = 0; c < nNumFields; c++ )
+					{
+						pOutValues[nIdx].m_flValueAccumulators[nJob][c] += SubFloat( pFields[c][q], s );
+					}
+					pOutValues[nIdx].m_flWeightAccumulators[nJob] += 1.0;
+				}
+			}
+		}
+	}
+}
+
+static float KMeansCentroidDistance( float const *pA, float const *pB, int nNumFields )
+{
+	float flDistSqr = 0;
+	for( int c = 0; c < nNumFields; c++ )
+	{
+		flDistSqr += ( pA[c] - pB[c] ) * ( pA[c] - pB[c] );
+	}
+	return sqrtf( flDistSqr );
+}
+
 // kmeans quantization
 void CSOAContainer:: KMeansQuantization( int const *pFieldIndices, int nNumFields, 
 										 KMeansQuantizedValue *pOutValues,
@@ -909,6 +1101,32 @@ void CSOAContainer:: KMeansQuantization( int const *pFieldIndices, int nNumField
 		}
 	}
 
+	// without an error metric, plain euclidean distance lets the assignment skip most of the search
+	KMeansEuclideanContext_t euclidean;
+	CUtlVector< float > oldValues, drift, halfSeparation;
+	if ( !pErrorCalculator )
+	{
+		euclidean.m_pContainer = this;
+		euclidean.m_pFieldIndices = pFieldIndices;
+		euclidean.m_nNumFields = nNumFields;
+		euclidean.m_nFieldToStoreIndexInto = nFieldToStoreIndexInto;
+		euclidean.m_nErrorChannel = nChannelToReceiveErrorSignal;
+		euclidean.m_pValues = pOutValues;
+		euclidean.m_nNumValues = nNumResultsDesired;
+		euclidean.m_flMaxDrift = 0;
+		euclidean.m_bFirstPass = true;
+
+		oldValues.SetCount( nNumResultsDesired * nNumFields );
+		drift.SetCount( nNumResultsDesired );
+		halfSeparation.SetCount( nNumResultsDesired );
+		euclidean.m_pDrift = drift.Base();
+		euclidean.m_pHalfSeparation = halfSeparation.Base();
+
+		size_t nBoundsSize = NumQuadsPerRow() * NumRows() * NumSlices() * sizeof( fltx4 );
+		euclidean.m_pUpperBounds = reinterpret_cast<fltx4 *>( MemAlloc_AllocAligned( nBoundsSize, 16 ) );
+		euclidean.m_pLowerBounds = reinterpret_cast<fltx4 *>( MemAlloc_AllocAligned( nBoundsSize, 16 ) );
+	}
+
 	// now,. run iterations
 	while( nNumIterations-- )
 	{
@@ -917,21 +1135,35 @@ void CSOAContainer:: KMeansQuantization( int const *pFieldIndices, int nNumField
 			memset( pOutValues[i].m_flValueAccumulators, 0, sizeof( pOutValues[i].m_flValueAccumulators ) );
 			memset( pOutValues[i].m_flWeightAccumulators, 0, sizeof( pOutValues[i].m_flWeightAccumulators ) );
 		}
-		// now, find the closest matches for all data samples, in parallel
-		KMeansQuantizationWorkUnit jobs[QUANTIZER_NJOBS];
-		for( int i = 0; i < QUANTIZER_NJOBS; i++ )
+		if ( !pErrorCalculator )
 		{
-			jobs[i].m_pContainer = this;
-			jobs[i].m_nRowIndex = i;
-			jobs[i].m_nNumResultsDesired = nNumResultsDesired;
-			jobs[i].m_pErrorCalculator = pErrorCalculator;
-			jobs[i].m_pFieldIndices = pFieldIndices;
-			jobs[i].m_nNumFields = nNumFields;
-			jobs[i].m_nFieldToStoreIndexInto = nFieldToStoreIndexInto;
-			jobs[i].m_pOutValues = pOutValues;
-			jobs[i].m_nErrorChannel = nChannelToReceiveErrorSignal;
+			euclidean.m_bLastPass = ( nNumIterations == 0 );
+			int nNumRowsTotal = NumRows() * NumSlices();
+			ParallelLoopProcessChunks( (IThreadPool *)NULL, &euclidean, 0, nNumRowsTotal, MIN( nNumRowsTotal, 256 ), KMeansAssignEuclidean );
+			euclidean.m_bFirstPass = false;
+			if ( nNumIterations )
+			{
+				KMeansAccumulateEuclidean( *this, pFieldIndices, nNumFields, pOutValues, nFieldToStoreIndexInto );
+			}
+		}
+		else
+		{
+			// now, find the closest matches for all data samples, in parallel
+			KMeansQuantizationWorkUnit jobs[QUANTIZER_NJOBS];
+			for( int i = 0; i < QUANTIZER_NJOBS; i++ )
+			{
+				jobs[i].m_pContainer = this;
+				jobs[i].m_nRowIndex = i;
+				jobs[i].m_nNumResultsDesired = nNumResultsDesired;
+				jobs[i].m_pErrorCalculator = pErrorCalculator;
+				jobs[i].m_pFieldIndices = pFieldIndices;
+				jobs[i].m_nNumFields = nNumFields;
+				jobs[i].m_nFieldToStoreIndexInto = nFieldToStoreIndexInto;
+				jobs[i].m_pOutValues = pOutValues;
+				jobs[i].m_nErrorChannel = nChannelToReceiveErrorSignal;
+			}
+			ParallelProcess( jobs, ARRAYSIZE( jobs ), DoKMeansWork );
 		}
-		ParallelProcess( jobs, ARRAYSIZE( jobs ), DoKMeansWork );
 		if ( nNumIterations )						// don't refine the results after the last pass
 		{
 			for( int n = 0; n < nNumResultsDesired; n++ )
@@ -949,76 +1181,396 @@ void CSOAContainer:: KMeansQuantization( int const *pFieldIndices, int nNumField
 				float flOOWeight = 1.0 / MAX( FLT_EPSILON, pOutValues[n].m_flWeightAccumulators[0] );
 				for( int c = 0; c < nNumFields; c++ )
 				{
+					if ( !pErrorCalculator )
+					{
+						oldValues[n * nNumFields + c] = SubFloat( pOutValues[n].m_fl4Values[c], 0 );
+					}
 					pOutValues[n].m_fl4Values[c] = ReplicateX4( pOutValues[n].m_flValueAccumulators[0][c] * flOOWeight );
 				}				
-				pErrorCalculator->PostAdjustQuantizedValue( pOutValues[n] );
+				if ( pErrorCalculator )
+				{
+					pErrorCalculator->PostAdjustQuantizedValue( pOutValues[n] );
+				}
+			}
+			if ( pErrorCalculator )
+			{
+				pErrorCalculator->PostStep( pFieldIndices, nNumFields, pOutValues, nNumResultsDesired, nFieldToStoreIndexInto, *this );
+			}
+			else
+			{
+				// how far the centroids moved, and how far apart they now are, for the bounds
+				CUtlVector< float > newValues;
+				newValues.SetCount( nNumResultsDesired * nNumFields );
+				euclidean.m_flMaxDrift = 0;
+				for( int n = 0; n < nNumResultsDesired; n++ )
+				{
+					for( int c = 0; c < nNumFields; c++ )
+					{
+						newValues[n * nNumFields + c] = SubFloat( pOutValues[n].m_fl4Values[c], 0 );
+					}
+					drift[n] = KMeansCentroidDistance( &oldValues[n * nNumFields], &newValues[n * nNumFields], nNumFields );
+					euclidean.m_flMaxDrift = MAX( euclidean.m_flMaxDrift, drift[n] );
+				}
+				for( int n = 0; n < nNumResultsDesired; n++ )
+				{
+					float flNearest = FLT_MAX;
+					for( int m = 0; m < nNumResultsDesired; m++ )
+					{
+						if ( m != n )
+						{
+							flNearest = MIN( flNearest, KMeansCentroidDistance( &newValues[n * nNumFields], &newValues[m * nNumFields], nNumFields ) );
+						}
+					}
+					halfSeparation[n] = 0.5f * flNearest;
+				}
+			}
+		}
+	}
+
+	if ( !pErrorCalculator )
+	{
+		MemAlloc_FreeAligned( euclidean.m_pUpperBounds );
+		MemAlloc_FreeAligned( euclidean.m_pLowerBounds );
+	}
+}
+
+// Voxels with a source value above this are inside the surface
+static const float s_flDistanceFieldThreshold = 0.9f;
+
+// Width of the blocks of lines the y and z passes of the distance transform gather at once, so
+// that a block of a row is one cache line
+#define DISTANCE_TRANSFORM_BLOCK 16
+
+// Below this max distance, taking the minimum over the rows that can still be under the cap directly
+// is cheaper than building the envelope, as it goes four columns at a time without branches
+#define DISTANCE_WINDOW_MAX_RADIUS 32
+#define DISTANCE_WINDOW_BLOCK_QUADS 16
+
+// State shared by the passes of GenerateDistanceField. The passes work on a volume of signed
+// squared distances (in voxels, capped at m_flCap), positive for voxels inside the surface and
+// negative for outside ones. A voxel only ever needs the distance to the other class, so one
+// float per voxel holds both transforms and its sign says which one it belongs to.
+struct DistanceFieldContext_t
+{
+	CSOAContainer *m_pContainer;
+	int m_nSrcField;
+	int m_nDestField;
+	float m_flMaxDistance;
+	float m_flCap;
+	int m_nWindow;						// > 0 to use DistanceWindowPlane rather than the envelope
+
+	// the voxels the transform runs over: the output region grown by the max distance
+	int m_nMinX, m_nMinY, m_nMinZ;
+	int m_nNumCols, m_nNumRows, m_nNumSlices;
+
+	// the voxels written to nDestField
+	int m_nOutMinX, m_nOutMaxX, m_nOutMinY, m_nOutMaxY, m_nOutMinZ, m_nOutMaxZ;
+
+	// the work volume, either nDestField itself or a separate allocation. Rows are 16 byte aligned
+	// and padded to whole quads.
+	float *m_pWork;
+	size_t m_nWorkRowStride;
+	size_t m_nWorkSliceStride;
+
+	FORCEINLINE float *WorkRow( int nY, int nZ ) const
+	{
+		return m_pWork + ( nY - m_nMinY ) * m_nWorkRowStride + ( nZ - m_nMinZ ) * m_nWorkSliceStride;
+	}
+};
+
+// Per-job scratch for the line transforms
+struct DistanceTransformScratch_t
+{
+	CUtlVector< float > m_Lines;			// DISTANCE_TRANSFORM_BLOCK lines, one after the other
+	CUtlVector< int > m_Position;			// the lower envelope: where each parabola is centered,
+	CUtlVector< float > m_Height;			// its height there,
+	CUtlVector< double > m_Start;			// and where it becomes the lowest one
+	fltx4 *m_pBlockCopy;					// for DistanceWindowPlane instead
+
+	DistanceTransformScratch_t( int nLength, bool bWindow )
+	{
+		m_pBlockCopy = NULL;
+		if ( bWindow )
+		{
+			m_pBlockCopy = reinterpret_cast<fltx4 *>( MemAlloc_AllocAligned( DISTANCE_WINDOW_BLOCK_QUADS * nLength * sizeof( fltx4 ), 16 ) );
+			return;
+		}
+		m_Lines.SetCount( DISTANCE_TRANSFORM_BLOCK * nLength );
+		m_Position.SetCount( nLength );
+		m_Height.SetCount( nLength );
+		m_Start.SetCount( nLength + 1 );
+	}
+
+	~DistanceTransformScratch_t()
+	{
+		if ( m_pBlockCopy )
+		{
+			MemAlloc_FreeAligned( m_pBlockCopy );
+		}
+	}
+};
+
+// Felzenszwalb & Huttenlocher, "Distance Transforms of Sampled Functions": one pass of the exact
+// squared euclidean distance transform along a line, as the lower envelope of the parabolas
+// f( q ) + ( p - q )^2. Each line holds both transforms (see DistanceFieldContext_t), so the
+// envelope is built twice; parabolas that start at or above the cap can never bring a voxel
+// under it and are left out.
+static void DistanceTransformLine( float *pLine, int nLength, float flCap, DistanceTransformScratch_t &scratch )
+{
+	int *pPosition = scratch.m_Position.Base();
+	float *pHeight = scratch.m_Height.Base();
+	double *pStart = scratch.m_Start.Base();
+
+	int nNumInside = 0;
+	for ( int p = 0; p < nLength; p++ )
+	{
+		nNumInside += ( pLine[p] > 0.0f );
+	}
+
+	for ( int nPass = 0; nPass < 2; nPass++ )
+	{
+		// pass 0 is the distance to the nearest inside voxel, which the outside voxels want, and
+		// pass 1 the other way round. Most lines are all one class and only need one of them.
+		const bool bTargetInside = ( nPass == 0 );
+		if ( nNumInside == ( bTargetInside ? nLength : 0 ) )
+			continue;
+
+		int k = -1;
+		for ( int q = 0; q < nLength; q++ )
+		{
+			const bool bInside = pLine[q] > 0.0f;
+			const float flHeight = ( bInside == bTargetInside ) ? 0.0f : fabsf( pLine[q] );
+			if ( flHeight >= flCap )
+				continue;
+
+			const double flOffset = (double)flHeight + (double)q * q;
+			double flStart = -FLT_MAX;
+			while ( k >= 0 )
+			{
+				flStart = ( flOffset - ( (double)pHeight[k] + (double)pPosition[k] * pPosition[k] ) ) / ( 2.0 * ( q - pPosition[k] ) );
+				if ( flStart > pStart[k] )
+					break;
+				k--;
 			}
-			pErrorCalculator->PostStep( pFieldIndices, nNumFields, pOutValues, nNumResultsDesired, nFieldToStoreIndexInto, *this );
+			k++;
+			pPosition[k] = q;
+			pHeight[k] = flHeight;
+			pStart[k] = ( k > 0 ) ? flStart : -FLT_MAX;
+		}
+		pStart[k + 1] = FLT_MAX;
+
+		int j = 0;
+		for ( int p = 0; p < nLength; p++ )
+		{
+			const bool bInside = pLine[p] > 0.0f;
+			if ( bInside == bTargetInside )
+				continue;
+
+			float flDistSqr = flCap;
+			if ( k >= 0 )
+			{
+				while ( pStart[j + 1] < p )
+				{
+					j++;
+				}
+				const float flDelta = (float)( p - pPosition[j] );
+				flDistSqr = MIN( flDelta * flDelta + pHeight[j], flCap );
+			}
+			pLine[p] = bInside ? flDistSqr : -flDistSqr;
 		}
 	}
 }
 
-#define THRESH 0.9
+// First pass, along x: thresholds the source and finds the nearest voxel of the other class on
+// the same row with a sweep each way
+static void DistanceFieldXPass( DistanceFieldContext_t *pContext, int nStartSlice, int nNumSlices )
+{
+	const int nNumCols = pContext->m_nNumCols;
+	const float flCap = pContext->m_flCap;
+
+	for ( int z = nStartSlice; z < nStartSlice + nNumSlices; z++ )
+	{
+		for ( int y = pContext->m_nMinY; y < pContext->m_nMinY + pContext->m_nNumRows; y++ )
+		{
+			float const *pSrc = pContext->m_pContainer->RowPtr<float>( pContext->m_nSrcField, y, z ) + pContext->m_nMinX;
+			float *pWork = pContext->WorkRow( y, z );
+
+			int nLastInside = INT_MIN / 2, nLastOutside = INT_MIN / 2;
+			for ( int x = 0; x < nNumCols; x++ )
+			{
+				const bool bInside = pSrc[x] > s_flDistanceFieldThreshold;
+				( bInside ? nLastInside : nLastOutside ) = x;
+				const float flDelta = (float)( x - ( bInside ? nLastOutside : nLastInside ) );
+				const float flDistSqr = MIN( flDelta * flDelta, flCap );
+				pWork[x] = bInside ? flDistSqr : -flDistSqr;
+			}
+
+			int nNextInside = INT_MAX / 2, nNextOutside = INT_MAX / 2;
+			for ( int x = nNumCols - 1; x >= 0; x-- )
+			{
+				const bool bInside = pWork[x] > 0.0f;
+				( bInside ? nNextInside : nNextOutside ) = x;
+				const float flDelta = (float)( ( bInside ? nNextOutside : nNextInside ) - x );
+				const float flDistSqr = MIN( flDelta * flDelta, fabsf( pWork[x] ) );
+				pWork[x] = bInside ? flDistSqr : -flDistSqr;
+			}
+		}
+	}
+}
 
-void CSOAContainer::UpdateDistanceRow( int nSearchRadius, int nMinX, int nMaxX, int nY, int nZ,
-									   int nSrcField, int nDestField )
+// Gathers DISTANCE_TRANSFORM_BLOCK columns at a time of a plane whose lines run across rows
+// nStride floats apart, transforms them, and writes them back
+static void DistanceTransformPlane( float *pPlane, size_t nStride, int nNumCols, int nLength, float flCap, DistanceTransformScratch_t &scratch )
 {
-	float const *pDataIn = RowPtr<float>( nSrcField, nY, nZ ) + nMinX;
-	float *pDataOut = RowPtr<float>( nDestField, nY, nZ ) + nMinX;
-
-	int nStartY = MAX( 0, nY - nSearchRadius );
-	int nEndY = MIN( NumRows() - 1, nY + nSearchRadius );
-
-	int nStartZ = MAX( 0, nZ - nSearchRadius );
-	int nEndZ = MIN( NumSlices() - 1, nZ + nSearchRadius );
-
-	fltx4 fl4Thresh = ReplicateX4( THRESH );
-	for( int x = nMinX; x <= nMaxX; x++ )
-	{
-		float flReferenceValue = *( pDataIn++ );
-		// map it to 0 or 1
-		fltx4 fl4ReferenceValue = ( flReferenceValue > THRESH ) ? Four_Ones: Four_Zeros;
-		fltx4 fl4ClosestDistance = ReplicateX4( nSearchRadius );
-		// now, we need to walk over a (3d) window around the sample
-		int nStartX = MAX( 0, x - nSearchRadius );
-		int nEndX = MIN( NumCols() - 1, x + nSearchRadius );
-		// pad to simd values
-		nStartX = nStartX & ~3;
-		nEndX = nEndX & ~3;
-		int nCount = 1 + ( ( nEndX - nStartX ) / 4 );
-		for( int z1 = nStartZ; z1 <= nEndZ; z1++ )
+	float *pLines = scratch.m_Lines.Base();
+
+	for ( int x = 0; x < nNumCols; x += DISTANCE_TRANSFORM_BLOCK )
+	{
+		const int nBlock = MIN( DISTANCE_TRANSFORM_BLOCK, nNumCols - x );
+
+		for ( int i = 0; i < nLength; i++ )
 		{
-			for( int y1 = nStartY; y1 <= nEndY; y1++ )
+			float const *pRow = pPlane + i * nStride + x;
+			for ( int b = 0; b < nBlock; b++ )
 			{
-				fltx4 fl4YZDist = ReplicateX4( ( y1 - nY ) * ( y1 - nY ) + ( z1 - nZ ) * ( z1 - nZ ) );
-				fltx4 fl4SrcXDiff = AddSIMD( ReplicateX4( nStartX - x ), g_SIMD_0123 );
-				fltx4 *pfl4SrcData = RowPtr<fltx4>( nSrcField, y1, z1 ) + ( nStartX / 4 );
-				for( int x1 = 0; x1 < nCount; x1++ )
+				pLines[b * nLength + i] = pRow[b];
+			}
+		}
+
+		for ( int b = 0; b < nBlock; b++ )
+		{
+			DistanceTransformLine( pLines + b * nLength, nLength, flCap, scratch );
+		}
+
+		for ( int i = 0; i < nLength; i++ )
+		{
+			float *pRow = pPlane + i * nStride + x;
+			for ( int b = 0; b < nBlock; b++ )
+			{
+				pRow[b] = pLines[b * nLength + i];
+			}
+		}
+	}
+}
+
+// Same as DistanceTransformPlane for nWindow = ceil( sqrt( flCap ) ) - 1, the furthest row that can
+// still contribute. A voxel's sign picks which transform it takes: flipping the sign of every value
+// by it makes the voxels of its own class negative, so they drop out of max( v, 0 ). Each block of
+// columns is copied out first, which also keeps power of two row strides from thrashing the cache.
+static void DistanceWindowPlane( float *pPlane, size_t nStride, int nNumCols, int nLength, int nWindow, float flCap, fltx4 *pBlockCopy )
+{
+	fltx4 fl4DistSqr[2 * DISTANCE_WINDOW_MAX_RADIUS - 1];
+	Assert( nWindow < DISTANCE_WINDOW_MAX_RADIUS );
+
+	for ( int d = -nWindow; d <= nWindow; d++ )
+	{
+		fl4DistSqr[d + nWindow] = ReplicateX4( (float)( d * d ) );
+	}
+
+	const fltx4 fl4Cap = ReplicateX4( flCap );
+	const fltx4 fl4SignMask = LoadAlignedSIMD( g_SIMD_signmask );
+	const int nNumQuads = ( nNumCols + 3 ) >> 2;
+	const size_t nQuadStride = nStride >> 2;
+
+	for ( int q0 = 0; q0 < nNumQuads; q0 += DISTANCE_WINDOW_BLOCK_QUADS )
+	{
+		const int nBlock = MIN( DISTANCE_WINDOW_BLOCK_QUADS, nNumQuads - q0 );
+		fltx4 *pBlock = reinterpret_cast<fltx4 *>( pPlane ) + q0;
+
+		for ( int i = 0; i < nLength; i++ )
+		{
+			memcpy( pBlockCopy + i * nBlock, pBlock + i * nQuadStride, nBlock * sizeof( fltx4 ) );
+		}
+
+		for ( int i = 0; i < nLength; i++ )
+		{
+			const int nFirst = MAX( -nWindow, -i );
+			const int nLast = MIN( nWindow, nLength - 1 - i );
+			fltx4 const *pCenter = pBlockCopy + i * nBlock;
+			fltx4 *pOut = pBlock + i * nQuadStride;
+			for ( int b = 0; b < nBlock; b++ )
+			{
+				const fltx4 fl4Sign = AndSIMD( fl4SignMask, pCenter[b] );
+				fltx4 fl4Min = fl4Cap;
+				for ( int d = nFirst; d <= nLast; d++ )
 				{
-					// fetch the source data, mapping it to 1 or 0.
-					fltx4 fl4SrcData = *( pfl4SrcData++ );
-					fl4SrcData = MaskedAssign( CmpGtSIMD( fl4SrcData, fl4Thresh ), Four_Ones, Four_Zeros );
-					fltx4 fl4Distance = SqrtSIMD( AddSIMD( MulSIMD( fl4SrcXDiff, fl4SrcXDiff ), fl4YZDist ) );
-					fl4ClosestDistance = MaskedAssign( 
-						AndNotSIMD( CmpEqSIMD( fl4SrcData, fl4ReferenceValue ), CmpLtSIMD( fl4Distance, fl4ClosestDistance ) ),
-						fl4Distance, fl4ClosestDistance );
-					fl4SrcXDiff = AddSIMD( fl4SrcXDiff, Four_Fours );
+					fltx4 fl4Height = MaxSIMD( XorSIMD( pCenter[d * nBlock + b], fl4Sign ), Four_Zeros );
+					fl4Min = MinSIMD( fl4Min, AddSIMD( fl4Height, fl4DistSqr[d + nWindow] ) );
 				}
+				pOut[b] = XorSIMD( fl4Min, fl4Sign );
 			}
 		}
-		// we have found the closest different voxel. store it
-		float flClosestDistance = MIN( MIN( SubFloat( fl4ClosestDistance, 0 ), SubFloat( fl4ClosestDistance, 1 ) ),
-									   MIN( SubFloat( fl4ClosestDistance, 2 ), SubFloat( fl4ClosestDistance, 3 ) ) );
-		flClosestDistance = MIN( flClosestDistance, nSearchRadius );
-		if ( flReferenceValue <= THRESH )
+	}
+}
+
+// Second pass, along y, a slice at a time
+static void DistanceFieldYPass( DistanceFieldContext_t *pContext, int nStartSlice, int nNumSlices )
+{
+	DistanceTransformScratch_t scratch( pContext->m_nNumRows, pContext->m_nWindow > 0 );
+
+	for ( int z = nStartSlice; z < nStartSlice + nNumSlices; z++ )
+	{
+		float *pPlane = pContext->WorkRow( pContext->m_nMinY, z );
+		if ( pContext->m_nWindow )
+		{
+			DistanceWindowPlane( pPlane, pContext->m_nWorkRowStride, pContext->m_nNumCols, pContext->m_nNumRows, pContext->m_nWindow, pContext->m_flCap, scratch.m_pBlockCopy );
+		}
+		else
+		{
+			DistanceTransformPlane( pPlane, pContext->m_nWorkRowStride, pContext->m_nNumCols, pContext->m_nNumRows, pContext->m_flCap, scratch );
+		}
+	}
+}
+
+// Third pass, along z, a row at a time
+static void DistanceFieldZPass( DistanceFieldContext_t *pContext, int nStartRow, int nNumRows )
+{
+	DistanceTransformScratch_t scratch( pContext->m_nNumSlices, pContext->m_nWindow > 0 );
+
+	for ( int y = nStartRow; y < nStartRow + nNumRows; y++ )
+	{
+		float *pPlane = pContext->WorkRow( y, pContext->m_nMinZ );
+		if ( pContext->m_nWindow )
+		{
+			DistanceWindowPlane( pPlane, pContext->m_nWorkSliceStride, pContext->m_nNumCols, pContext->m_nNumSlices, pContext->m_nWindow, pContext->m_flCap, scratch.m_pBlockCopy );
+		}
+		else
 		{
-			flClosestDistance = -flClosestDistance;
+			DistanceTransformPlane( pPlane, pContext->m_nWorkSliceStride, pContext->m_nNumCols, pContext->m_nNumSlices, pContext->m_flCap, scratch );
 		}
-		*( pDataOut++ ) = flClosestDistance;
 	}
 }
 
+// Last pass: signed distances from the signed squared ones, into the output region
+static void DistanceFieldResolvePass( DistanceFieldContext_t *pContext, int nStartSlice, int nNumSlices )
+{
+	const fltx4 fl4Cap = ReplicateX4( pContext->m_flCap );
+	const fltx4 fl4MaxDistance = ReplicateX4( pContext->m_flMaxDistance );
+	const fltx4 fl4SignMask = LoadAlignedSIMD( g_SIMD_signmask );
+	const int nNumCols = 1 + pContext->m_nOutMaxX - pContext->m_nOutMinX;
+
+	for ( int z = nStartSlice; z < nStartSlice + nNumSlices; z++ )
+	{
+		for ( int y = pContext->m_nOutMinY; y <= pContext->m_nOutMaxY; y++ )
+		{
+			float const *pWork = pContext->WorkRow( y, z ) + ( pContext->m_nOutMinX - pContext->m_nMinX );
+			float *pOut = pContext->m_pContainer->RowPtr<float>( pContext->m_nDestField, y, z ) + pContext->m_nOutMinX;
 
+			int x = 0;
+			for ( ; x + 4 <= nNumCols; x += 4 )
+			{
+				fltx4 fl4DistSqr = LoadUnalignedSIMD( pWork + x );
+				fltx4 fl4Dist = MinSIMD( SqrtSIMD( MinSIMD( AndNotSIMD( fl4SignMask, fl4DistSqr ), fl4Cap ) ), fl4MaxDistance );
+				StoreUnalignedSIMD( pOut + x, OrSIMD( fl4Dist, AndSIMD( fl4SignMask, fl4DistSqr ) ) );
+			}
+			for ( ; x < nNumCols; x++ )
+			{
+				float flDist = MIN( sqrtf( MIN( fabsf( pWork[x] ), pContext->m_flCap ) ), pContext->m_flMaxDistance );
+				pOut[x] = ( pWork[x] > 0.0f ) ? flDist : -flDist;
+			}
+		}
+	}
+}
 
 void CSOAContainer::GenerateDistanceField( int nSrcField, int nDestField,
 										   int nMaxDistance,
@@ -1066,16 +1618,65 @@ void CSOAContainer::GenerateDistanceField( int nSrcField, int nDestField,
 		pRect->depth = 1 + nMaxZ - nMinZ;
 	}
 
-	CCallQueue workList;
-	for( int z = nMinZ; z <= nMaxZ; z++ )
+	if ( ( nMinX > nMaxX ) || ( nMinY > nMaxY ) || ( nMinZ > nMaxZ ) )
+		return;
+
+	DistanceFieldContext_t context;
+	context.m_pContainer = this;
+	context.m_nSrcField = nSrcField;
+	context.m_nDestField = nDestField;
+	context.m_flMaxDistance = MAX( 0, nMaxDistance );
+	// the cap only has to keep the sign of a voxel when nMaxDistance is 0
+	context.m_flCap = MAX( 1.0f, context.m_flMaxDistance * context.m_flMaxDistance );
+	context.m_nWindow = ( nMaxDistance < DISTANCE_WINDOW_MAX_RADIUS ) ? MAX( 1, nMaxDistance ) - 1 : 0;
+	context.m_nOutMinX = nMinX;
+	context.m_nOutMaxX = nMaxX;
+	context.m_nOutMinY = nMinY;
+	context.m_nOutMaxY = nMaxY;
+	context.m_nOutMinZ = nMinZ;
+	context.m_nOutMaxZ = nMaxZ;
+
+	// voxels up to nMaxDistance outside the output region can still be the nearest ones
+	context.m_nMinX = MAX( 0, nMinX - nMaxDistance );
+	context.m_nMinY = MAX( 0, nMinY - nMaxDistance );
+	context.m_nMinZ = MAX( 0, nMinZ - nMaxDistance );
+	context.m_nNumCols = 1 + MIN( NumCols() - 1, nMaxX + nMaxDistance ) - context.m_nMinX;
+	context.m_nNumRows = 1 + MIN( NumRows() - 1, nMaxY + nMaxDistance ) - context.m_nMinY;
+	context.m_nNumSlices = 1 + MIN( NumSlices() - 1, nMaxZ + nMaxDistance ) - context.m_nMinZ;
+
+	// when the output is the whole volume, work in nDestField itself
+	float *pSeparateWork = NULL;
+	if ( ( 1 + nMaxX - nMinX == NumCols() ) && ( 1 + nMaxY - nMinY == NumRows() ) &&
+		 ( 1 + nMaxZ - nMinZ == NumSlices() ) && ( nSrcField != nDestField ) )
 	{
-		for( int y = nMinY; y <= nMaxY; y++ )
-		{
-			workList.QueueCall( this, &CSOAContainer::UpdateDistanceRow,
-								nMaxDistance, nMinX, nMaxX, y, z, nSrcField, nDestField );
-		}
+		context.m_pWork = RowPtr<float>( nDestField, 0, 0 );
+		context.m_nWorkRowStride = m_nRowStrideInBytes[nDestField] / sizeof( float );
+		context.m_nWorkSliceStride = m_nSliceStrideInBytes[nDestField] / sizeof( float );
+	}
+	else
+	{
+		context.m_nWorkRowStride = ( context.m_nNumCols + 3 ) & ~3;
+		context.m_nWorkSliceStride = context.m_nWorkRowStride * context.m_nNumRows;
+		pSeparateWork = reinterpret_cast<float *>( MemAlloc_AllocAligned( context.m_nWorkSliceStride * context.m_nNumSlices * sizeof( float ), 16 ) );
+		context.m_pWork = pSeparateWork;
+	}
+
+	const int nFirstSlice = context.m_nMinZ, nSlices = context.m_nNumSlices;
+	ParallelLoopProcessChunks( (IThreadPool *)NULL, &context, nFirstSlice, nSlices, nSlices, DistanceFieldXPass );
+	if ( context.m_nNumRows > 1 )
+	{
+		ParallelLoopProcessChunks( (IThreadPool *)NULL, &context, nFirstSlice, nSlices, nSlices, DistanceFieldYPass );
+	}
+	if ( context.m_nNumSlices > 1 )
+	{
+		ParallelLoopProcessChunks( (IThreadPool *)NULL, &context, context.m_nMinY, context.m_nNumRows, context.m_nNumRows, DistanceFieldZPass );
+	}
+	ParallelLoopProcessChunks( (IThreadPool *)NULL, &context, nMinZ, 1 + nMaxZ - nMinZ, 1 + nMaxZ - nMinZ, DistanceFieldResolvePass );
+
+	if ( pSeparateWork )
+	{
+		MemAlloc_FreeAligned( pSeparateWork );
 	}
-	workList.ParallelCallQueued();
 }
 
 void CSOAContainer::CopyRegionFrom( CSOAContainer const &src, int nSrcAttr, int nDestAttr,
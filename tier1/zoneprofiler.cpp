@@ -0,0 +1,987 @@
+//========= Copyright Valve Corporation, All rights reserved. ============//
+//
+// Purpose: Scoped profiler zones with a per-thread call tree
+//
+//=============================================================================//
+
+#include "tier1/zoneprofiler.h"
+#include "tier0/utlbuffer.h"
+#include "tier0/strtools.h"
+
+#include <algorithm>
+#include <chrono>
+
+// memdbgon must be the last include file in a .cpp file!!!
+#include "tier0/memdbgon.h"
+
+COMPILE_TIME_ASSERT( ( ZONE_PROFILER_RING_SIZE & ( ZONE_PROFILER_RING_SIZE - 1 ) ) == 0 );
+COMPILE_TIME_ASSERT( sizeof( ZoneProfilerEvent_t ) == 16 );
+
+// Frame marks not read by the aggregator yet; it only loses them if it falls this far behind
+#define ZONE_PROFILER_FRAME_RING_SIZE 256
+
+static const uint32 s_nBinaryCaptureMagic = 0x46525A50; // "PZRF"
+static const uint32 s_nBinaryCaptureVersion = 1;
+
+std::atomic< bool > g_bZoneProfilerEnabled( false );
+thread_local CZoneProfilerThread *g_pZoneProfilerThread;
+
+static std::atomic< CZoneProfilerThread * > s_pZoneProfilerThreads( NULL );
+static std::atomic< int > s_nZoneProfilerThreads( 0 );
+
+static uint64 s_FrameMarks[ZONE_PROFILER_FRAME_RING_SIZE];
+static std::atomic< uint32 > s_nFrameMarkWrite( 0 );
+
+struct ZoneProfilerZone_t
+{
+	const char *m_pszName;
+	const char *m_pszFile;
+	int m_nLine;
+};
+
+// Function statics, so zones registered during static init of other files find them constructed
+static CThreadFastMutex &ZoneRegistryMutex()
+{
+	static CThreadFastMutex s_Mutex;
+	return s_Mutex;
+}
+
+static CUtlVector< ZoneProfilerZone_t > &ZoneRegistry()
+{
+	static CUtlVector< ZoneProfilerZone_t > s_Zones;
+	return s_Zones;
+}
+
+// Function statics aren't guarded (-fno-threadsafe-statics), construct both before any thread can race for them
+static const bool s_bZoneRegistryConstructed = ( ZoneRegistryMutex(), ZoneRegistry(), true );
+
+//-----------------------------------------------------------------------------
+// Zones and threads
+//-----------------------------------------------------------------------------
+uint16 ZoneProfiler_RegisterZone( const char *pszName, const char *pszFile, int nLine )
+{
+	AUTO_LOCK_FM( ZoneRegistryMutex() );
+
+	CUtlVector< ZoneProfilerZone_t > &zones = ZoneRegistry();
+	if ( !zones.Count() )
+	{
+		ZoneProfilerZone_t &invalid = zones[zones.AddToTail()];
+		invalid.m_pszName = "";
+		invalid.m_pszFile = "";
+		invalid.m_nLine = 0;
+	}
+
+	if ( !pszName )
+		return ZONE_PROFILER_INVALID_ZONE;
+
+	// Zones with the same name are the same node, wherever they are
+	for ( int i = 1; i < zones.Count(); i++ )
+	{
+		if ( zones[i].m_pszName == pszName || !V_strcmp( zones[i].m_pszName, pszName ) )
+			return ( uint16 )i;
+	}
+
+	if ( zones.Count() > 0xFFFF )
+		return ZONE_PROFILER_INVALID_ZONE;
+
+	ZoneProfilerZone_t &zone = zones[zones.AddToTail()];
+	zone.m_pszName = pszName;
+	zone.m_pszFile = pszFile ? pszFile : "";
+	zone.m_nLine = nLine;
+	return ( uint16 )( zones.Count() - 1 );
+}
+
+const char *ZoneProfiler_GetZoneName( uint16 nZone )
+{
+	AUTO_LOCK_FM( ZoneRegistryMutex() );
+
+	CUtlVector< ZoneProfilerZone_t > &zones = ZoneRegistry();
+	return ( nZone < zones.Count() ) ? zones[nZone].m_pszName : "";
+}
+
+int ZoneProfiler_GetZoneCount()
+{
+	AUTO_LOCK_FM( ZoneRegistryMutex() );
+	return ZoneRegistry().Count();
+}
+
+CZoneProfilerThread::CZoneProfilerThread() :
+	m_nWrite( 0 ),
+	m_nReadCached( 0 ),
+	m_nDepth( 0 ),
+	m_nDropped( 0 ),
+	m_nRead( 0 ),
+	m_bInUse( false ),
+	m_nThreadId( 0 ),
+	m_nIndex( -1 ),
+	m_pNext( NULL )
+{
+	m_szName[0] = '\0';
+}
+
+int CZoneProfilerThread::Drain( CUtlVector< ZoneProfilerEvent_t > &events )
+{
+	uint32 nRead = m_nRead.load( std::memory_order_relaxed );
+	uint32 nWrite = m_nWrite.load( std::memory_order_acquire );
+	int nCount = ( int )( nWrite - nRead );
+	if ( !nCount )
+		return 0;
+
+	// Copied in at most two runs, either side of the wrap
+	uint32 nFirst = nRead & ( ZONE_PROFILER_RING_SIZE - 1 );
+	int nFirstRun = MIN( nCount, ( int )( ZONE_PROFILER_RING_SIZE - nFirst ) );
+	events.AddMultipleToTail( nFirstRun, &m_Events[nFirst] );
+	if ( nFirstRun < nCount )
+	{
+		events.AddMultipleToTail( nCount - nFirstRun, &m_Events[0] );
+	}
+
+	m_nRead.store( nWrite, std::memory_order_release );
+	return nCount;
+}
+
+// Gives the ring back when a thread that attached exits
+class CZoneProfilerThreadExit
+{
+public:
+	~CZoneProfilerThreadExit()
+	{
+		ZoneProfiler_DetachThread();
+	}
+};
+
+CZoneProfilerThread *ZoneProfiler_AttachThread()
+{
+	static thread_local CZoneProfilerThreadExit s_ThreadExit;
+	(void)s_ThreadExit;
+
+	if ( g_pZoneProfilerThread )
+		return g_pZoneProfilerThread;
+
+	CZoneProfilerThread *pThread = NULL;
+	for ( CZoneProfilerThread *pFree = s_pZoneProfilerThreads.load( std::memory_order_acquire ); pFree; pFree = pFree->m_pNext )
+	{
+		bool bInUse = false;
+		if ( !pFree->m_bInUse.load( std::memory_order_relaxed ) && pFree->m_bInUse.compare_exchange_strong( bInUse, true, std::memory_order_acquire ) )
+		{
+			pThread = pFree;
+			break;
+		}
+	}
+
+	if ( !pThread )
+	{
+		pThread = new CZoneProfilerThread;
+		pThread->m_bInUse.store( true, std::memory_order_relaxed );
+		pThread->m_nIndex = s_nZoneProfilerThreads.fetch_add( 1, std::memory_order_relaxed );
+
+		CZoneProfilerThread *pHead = s_pZoneProfilerThreads.load( std::memory_order_relaxed );
+		do
+		{
+			pThread->m_pNext = pHead;
+		}
+		while ( !s_pZoneProfilerThreads.compare_exchange_weak( pHead, pThread, std::memory_order_release, std::memory_order_relaxed ) );
+	}
+
+	pThread->m_nDepth = 0;
+	pThread->m_nThreadId = ThreadGetCurrentId();
+	V_snprintf( pThread->m_szName, sizeof( pThread->m_szName ), "thread %llu", ( unsigned long long )pThread->m_nThreadId );
+
+	g_pZoneProfilerThread = pThread;
+	return pThread;
+}
+
+void ZoneProfiler_DetachThread()
+{
+	CZoneProfilerThread *pThread = g_pZoneProfilerThread;
+	if ( !pThread )
+		return;
+
+	g_pZoneProfilerThread = NULL;
+	pThread->m_bInUse.store( false, std::memory_order_release );
+}
+
+void ZoneProfiler_SetThreadName( const char *pszName )
+{
+	V_strncpy( ZoneProfiler_GetThread()->m_szName, pszName, sizeof( CZoneProfilerThread::m_szName ) );
+}
+
+//-----------------------------------------------------------------------------
+// Frames and time
+//-----------------------------------------------------------------------------
+struct ZoneProfilerClockBase_t
+{
+	ZoneProfilerClockBase_t() :
+		m_nTicks( GetTimebaseRegister() ),
+		m_Time( std::chrono::steady_clock::now() )
+	{
+	}
+
+	uint64 m_nTicks;
+	std::chrono::steady_clock::time_point m_Time;
+};
+
+static ZoneProfilerClockBase_t &ZoneProfilerClockBase()
+{
+	static ZoneProfilerClockBase_t s_Base;
+	return s_Base;
+}
+
+void ZoneProfiler_Enable( bool bEnable )
+{
+	ZoneProfilerClockBase();
+	ZoneProfiler_RegisterZone( NULL );
+
+	g_bZoneProfilerEnabled.store( bEnable, std::memory_order_relaxed );
+}
+
+void ZoneProfiler_FrameMark()
+{
+	uint32 nWrite = s_nFrameMarkWrite.load( std::memory_order_relaxed );
+	s_FrameMarks[nWrite % ZONE_PROFILER_FRAME_RING_SIZE] = GetTimebaseRegister();
+	s_nFrameMarkWrite.store( nWrite + 1, std::memory_order_release );
+}
+
+double ZoneProfiler_GetTicksPerSecond()
+{
+	const ZoneProfilerClockBase_t &base = ZoneProfilerClockBase();
+
+	// Short spans measure badly, so the first calls wait until there is a usable one
+	std::chrono::steady_clock::time_point now;
+	uint64 nTicks;
+	do
+	{
+		now = std::chrono::steady_clock::now();
+		nTicks = GetTimebaseRegister();
+	}
+	while ( now - base.m_Time < std::chrono::milliseconds( 10 ) );
+
+	double flSeconds = std::chrono::duration< double >( now - base.m_Time ).count();
+	return ( double )( nTicks - base.m_nTicks ) / flSeconds;
+}
+
+//-----------------------------------------------------------------------------
+// Aggregator
+//-----------------------------------------------------------------------------
+CZoneProfilerAggregator::CZoneProfilerAggregator() :
+	m_nFrameRead( s_nFrameMarkWrite.load( std::memory_order_acquire ) ),
+	m_nFrames( 0 ),
+	m_nLateZones( 0 ),
+	m_nCaptureFrames( 60 ),
+	m_hThread( NULL ),
+	m_bRunning( false ),
+	m_nIntervalMs( 5 )
+{
+}
+
+CZoneProfilerAggregator::~CZoneProfilerAggregator()
+{
+	Stop();
+}
+
+uintp CZoneProfilerAggregator::ThreadProc( void *pParam )
+{
+	CZoneProfilerAggregator *pAggregator = static_cast< CZoneProfilerAggregator * >( pParam );
+	while ( pAggregator->m_bRunning.load( std::memory_order_acquire ) )
+	{
+		pAggregator->Update();
+		ThreadSleep( pAggregator->m_nIntervalMs );
+	}
+
+	return 0;
+}
+
+void CZoneProfilerAggregator::Start( int nIntervalMs )
+{
+	if ( m_hThread )
+		return;
+
+	m_nIntervalMs = MAX( nIntervalMs, 1 );
+	m_bRunning.store( true, std::memory_order_release );
+	m_hThread = CreateSimpleThread( &CZoneProfilerAggregator::ThreadProc, this );
+}
+
+void CZoneProfilerAggregator::Stop()
+{
+	if ( !m_hThread )
+		return;
+
+	m_bRunning.store( false, std::memory_order_release );
+	ThreadJoin( m_hThread );
+	ReleaseThreadHandle( m_hThread );
+	m_hThread = NULL;
+}
+
+void CZoneProfilerAggregator::Reset()
+{
+	AUTO_LOCK_FM( m_Mutex );
+
+	m_Nodes.Purge();
+	m_ThreadRoots.Purge();
+	m_TouchedNodes.Purge();
+	m_Pending.Purge();
+	m_FrameMarks.Purge();
+	m_CaptureFrames.Purge();
+	m_nFrames = 0;
+	m_nLateZones = 0;
+}
+
+void CZoneProfilerAggregator::DrainRings()
+{
+	// Frame marks first: a zone drained now that started before a mark read now is in that frame
+	uint32 nFrameWrite = s_nFrameMarkWrite.load( std::memory_order_acquire );
+	if ( nFrameWrite - m_nFrameRead > ZONE_PROFILER_FRAME_RING_SIZE )
+	{
+		m_nFrameRead = nFrameWrite - ZONE_PROFILER_FRAME_RING_SIZE;
+	}
+
+	for ( ; m_nFrameRead != nFrameWrite; m_nFrameRead++ )
+	{
+		m_FrameMarks.AddToTail( s_FrameMarks[m_nFrameRead % ZONE_PROFILER_FRAME_RING_SIZE] );
+	}
+
+	for ( CZoneProfilerThread *pThread = s_pZoneProfilerThreads.load( std::memory_order_acquire ); pThread; pThread = pThread->m_pNext )
+	{
+		m_DrainScratch.RemoveAll();
+		if ( !pThread->Drain( m_DrainScratch ) )
+			continue;
+
+		// Nothing before the first frame mark belongs to a frame
+		uint64 nFrameStart = m_FrameMarks.Count() ? m_FrameMarks[0] : ~0ull;
+		for ( int i = 0; i < m_DrainScratch.Count(); i++ )
+		{
+			const ZoneProfilerEvent_t &event = m_DrainScratch[i];
+			if ( event.m_nStart < nFrameStart )
+			{
+				m_nLateZones++;
+				continue;
+			}
+
+			PendingEvent_t &pending = m_Pending[m_Pending.AddToTail()];
+			pending.m_Event = event;
+			pending.m_nThread = pThread->m_nIndex;
+		}
+	}
+}
+
+int CZoneProfilerAggregator::FindOrAddChild( int nParent, uint16 nZone, int nThread )
+{
+	if ( nParent < 0 )
+	{
+		if ( nThread >= m_ThreadRoots.Count() )
+		{
+			int nOldCount = m_ThreadRoots.Count();
+			m_ThreadRoots.SetCount( nThread + 1 );
+			for ( int i = nOldCount; i < m_ThreadRoots.Count(); i++ )
+			{
+				m_ThreadRoots[i] = -1;
+			}
+		}
+
+		if ( m_ThreadRoots[nThread] >= 0 )
+			return m_ThreadRoots[nThread];
+	}
+	else
+	{
+		for ( int nChild = m_Nodes[nParent].m_nFirstChild; nChild >= 0; nChild = m_Nodes[nChild].m_nNextSibling )
+		{
+			if ( m_Nodes[nChild].m_nZone == nZone )
+				return nChild;
+		}
+	}
+
+	int nNode = m_Nodes.AddToTail();
+	Node_t &node = m_Nodes[nNode];
+	node.m_nZone = nZone;
+	node.m_nThread = nThread;
+	node.m_nParent = nParent;
+	node.m_nFirstChild = -1;
+	node.m_nNextSibling = -1;
+	node.m_nCalls = 0;
+	node.m_nFrames = 0;
+	node.m_nMinTicks = ~0ull;
+	node.m_nMaxTicks = 0;
+	node.m_nFrameTicks = 0;
+	node.m_nFrameCalls = 0;
+
+	if ( nParent < 0 )
+	{
+		m_ThreadRoots[nThread] = nNode;
+	}
+	else
+	{
+		node.m_nNextSibling = m_Nodes[nParent].m_nFirstChild;
+		m_Nodes[nParent].m_nFirstChild = nNode;
+	}
+
+	return nNode;
+}
+
+static bool PendingEventLess( const ZoneProfilerCaptureEvent_t &a, const ZoneProfilerCaptureEvent_t &b )
+{
+	if ( a.m_nThread != b.m_nThread )
+		return a.m_nThread < b.m_nThread;
+	if ( a.m_nStart != b.m_nStart )
+		return a.m_nStart < b.m_nStart;
+	return a.m_nDepth < b.m_nDepth;
+}
+
+void CZoneProfilerAggregator::FoldFrame( int nFirst, int nCount, uint64 nFrameStart )
+{
+	PendingEvent_t *pEvents = m_Pending.Base() + nFirst;
+	std::sort( pEvents, pEvents + nCount, []( const PendingEvent_t &a, const PendingEvent_t &b )
+	{
+		if ( a.m_nThread != b.m_nThread )
+			return a.m_nThread < b.m_nThread;
+		if ( a.m_Event.m_nStart != b.m_Event.m_nStart )
+			return a.m_Event.m_nStart < b.m_Event.m_nStart;
+		return a.m_Event.m_nDepth < b.m_Event.m_nDepth;
+	} );
+
+	// The open zone at each depth; a zone whose parent was dropped from a full ring goes under the root
+	struct OpenZone_t
+	{
+		int m_nNode;
+		uint64 m_nStart;
+		uint64 m_nEnd;
+	};
+	CUtlVectorFixedGrowable< OpenZone_t, 64 > openZones;
+
+	int nThread = -1;
+	int nRoot = -1;
+	for ( int i = 0; i < nCount; i++ )
+	{
+		const ZoneProfilerEvent_t &event = pEvents[i].m_Event;
+		if ( pEvents[i].m_nThread != nThread )
+		{
+			nThread = pEvents[i].m_nThread;
+			nRoot = FindOrAddChild( -1, ZONE_PROFILER_INVALID_ZONE, nThread );
+			openZones.RemoveAll();
+		}
+
+		int nParent = nRoot;
+		if ( event.m_nDepth > 0 && event.m_nDepth <= openZones.Count() )
+		{
+			const OpenZone_t &parent = openZones[event.m_nDepth - 1];
+			if ( parent.m_nNode >= 0 && parent.m_nStart <= event.m_nStart && event.m_nStart + event.m_nTicks <= parent.m_nEnd )
+			{
+				nParent = parent.m_nNode;
+			}
+		}
+
+		int nNode = FindOrAddChild( nParent, event.m_nZone, nThread );
+		if ( !m_Nodes[nNode].m_nFrameCalls )
+		{
+			m_TouchedNodes.AddToTail( nNode );
+		}
+		m_Nodes[nNode].m_nFrameTicks += event.m_nTicks;
+		m_Nodes[nNode].m_nFrameCalls++;
+
+		// The root's time is the thread's time in its outermost zones
+		if ( nParent == nRoot )
+		{
+			if ( !m_Nodes[nRoot].m_nFrameCalls )
+			{
+				m_TouchedNodes.AddToTail( nRoot );
+			}
+			m_Nodes[nRoot].m_nFrameTicks += event.m_nTicks;
+			m_Nodes[nRoot].m_nFrameCalls++;
+		}
+
+		while ( openZones.Count() <= event.m_nDepth )
+		{
+			OpenZone_t &empty = openZones[openZones.AddToTail()];
+			empty.m_nNode = -1;
+		}
+		openZones.SetCountNonDestructively( event.m_nDepth + 1 );
+		OpenZone_t &open = openZones[event.m_nDepth];
+		open.m_nNode = nNode;
+		open.m_nStart = event.m_nStart;
+		open.m_nEnd = event.m_nStart + event.m_nTicks;
+	}
+
+	for ( int i = 0; i < m_TouchedNodes.Count(); i++ )
+	{
+		Node_t &node = m_Nodes[m_TouchedNodes[i]];
+		node.m_nCalls += node.m_nFrameCalls;
+		node.m_nMinTicks = MIN( node.m_nMinTicks, node.m_nFrameTicks );
+		node.m_nMaxTicks = MAX( node.m_nMaxTicks, node.m_nFrameTicks );
+
+		if ( node.m_History.Count() < ZONE_PROFILER_HISTORY_FRAMES )
+		{
+			node.m_History.AddToTail( node.m_nFrameTicks );
+		}
+		else
+		{
+			node.m_History[node.m_nFrames % ZONE_PROFILER_HISTORY_FRAMES] = node.m_nFrameTicks;
+		}
+
+		node.m_nFrames++;
+		node.m_nFrameTicks = 0;
+		node.m_nFrameCalls = 0;
+	}
+	m_TouchedNodes.RemoveAll();
+
+	if ( m_nCaptureFrames > 0 )
+	{
+		CaptureFrame_t &frame = m_CaptureFrames[m_CaptureFrames.AddToTail()];
+		frame.m_nStart = nFrameStart;
+		frame.m_nEnd = m_FrameMarks[1];
+		frame.m_Events.AddMultipleToTail( nCount, pEvents );
+		TrimCapture();
+	}
+
+	m_nFrames++;
+}
+
+void CZoneProfilerAggregator::TrimCapture()
+{
+	int nExtraFrames = m_CaptureFrames.Count() - m_nCaptureFrames;
+	if ( nExtraFrames > 0 )
+	{
+		m_CaptureFrames.RemoveMultipleFromHead( nExtraFrames );
+	}
+}
+
+void CZoneProfilerAggregator::Update()
+{
+	AUTO_LOCK_FM( m_Mutex );
+
+	DrainRings();
+
+	// A frame is folded once the one after it has ended as well
+	while ( m_FrameMarks.Count() >= 3 )
+	{
+		uint64 nFrameStart = m_FrameMarks[0];
+		uint64 nFrameEnd = m_FrameMarks[1];
+
+		// Move the frame's zones to the front, keeping the rest in order
+		PendingEvent_t *pPending = m_Pending.Base();
+		int nInFrame = std::stable_partition( pPending, pPending + m_Pending.Count(), [nFrameEnd]( const PendingEvent_t &pending )
+		{
+			return pending.m_Event.m_nStart < nFrameEnd;
+		} ) - pPending;
+
+		FoldFrame( 0, nInFrame, nFrameStart );
+		m_Pending.RemoveMultipleFromHead( nInFrame );
+		m_FrameMarks.Remove( 0 );
+	}
+}
+
+int CZoneProfilerAggregator::GetNodeCount() const
+{
+	AUTO_LOCK_FM( m_Mutex );
+	return m_Nodes.Count();
+}
+
+ZoneProfilerNode_t CZoneProfilerAggregator::GetNode( int nNode ) const
+{
+	AUTO_LOCK_FM( m_Mutex );
+	return m_Nodes[nNode];
+}
+
+bool CZoneProfilerAggregator::GetStats( int nNode, ZoneProfilerStats_t &stats ) const
+{
+	CUtlVectorFixedGrowable< uint64, 256 > history;
+	{
+		AUTO_LOCK_FM( m_Mutex );
+
+		if ( !m_Nodes.IsValidIndex( nNode ) )
+			return false;
+
+		const Node_t &node = m_Nodes[nNode];
+		stats.m_nCalls = node.m_nCalls;
+		stats.m_nFrames = node.m_nFrames;
+		stats.m_flMinMs = node.m_nFrames ? ( double )node.m_nMinTicks : 0.0;
+		stats.m_flMaxMs = ( double )node.m_nMaxTicks;
+		history.AddMultipleToTail( node.m_History.Count(), node.m_History.Base() );
+	}
+
+	double flMsPerTick = 1000.0 / ZoneProfiler_GetTicksPerSecond();
+	stats.m_flMinMs *= flMsPerTick;
+	stats.m_flMaxMs *= flMsPerTick;
+	stats.m_flP50Ms = 0.0;
+	stats.m_flP99Ms = 0.0;
+
+	if ( history.Count() )
+	{
+		// Nearest rank
+		std::sort( history.Base(), history.Base() + history.Count() );
+		int nP50 = ( history.Count() * 50 + 99 ) / 100 - 1;
+		int nP99 = ( history.Count() * 99 + 99 ) / 100 - 1;
+		stats.m_flP50Ms = history[MAX( nP50, 0 )] * flMsPerTick;
+		stats.m_flP99Ms = history[MAX( nP99, 0 )] * flMsPerTick;
+	}
+
+	return true;
+}
+
+int CZoneProfilerAggregator::GetThreadRoot( int nThread ) const
+{
+	AUTO_LOCK_FM( m_Mutex );
+	return m_ThreadRoots.IsValidIndex( nThread ) ? m_ThreadRoots[nThread] : -1;
+}
+
+int CZoneProfilerAggregator::FindChild( int nParent, const char *pszZoneName ) const
+{
+	AUTO_LOCK_FM( m_Mutex );
+
+	if ( !m_Nodes.IsValidIndex( nParent ) )
+		return -1;
+
+	for ( int nChild = m_Nodes[nParent].m_nFirstChild; nChild >= 0; nChild = m_Nodes[nChild].m_nNextSibling )
+	{
+		if ( !V_strcmp( ZoneProfiler_GetZoneName( m_Nodes[nChild].m_nZone ), pszZoneName ) )
+			return nChild;
+	}
+
+	return -1;
+}
+
+int CZoneProfilerAggregator::GetFrameCount() const
+{
+	AUTO_LOCK_FM( m_Mutex );
+	return m_nFrames;
+}
+
+uint64 CZoneProfilerAggregator::GetDroppedZones() const
+{
+	uint64 nDropped = 0;
+	for ( CZoneProfilerThread *pThread = s_pZoneProfilerThreads.load( std::memory_order_acquire ); pThread; pThread = pThread->m_pNext )
+	{
+		nDropped += pThread->m_nDropped.load( std::memory_order_relaxed );
+	}
+
+	return nDropped;
+}
+
+uint64 CZoneProfilerAggregator::GetLateZones() const
+{
+	AUTO_LOCK_FM( m_Mutex );
+	return m_nLateZones;
+}
+
+void CZoneProfilerAggregator::SetCaptureFrames( int nFrames )
+{
+	AUTO_LOCK_FM( m_Mutex );
+
+	m_nCaptureFrames = MAX( nFrames, 0 );
+	TrimCapture();
+}
+
+void CZoneProfilerAggregator::GetCapture( CZoneProfilerCapture &capture ) const
+{
+	capture.Purge();
+	capture.m_flTicksPerSecond = ZoneProfiler_GetTicksPerSecond();
+
+	int nZones = ZoneProfiler_GetZoneCount();
+	capture.m_ZoneNames.SetCount( nZones );
+	for ( int i = 0; i < nZones; i++ )
+	{
+		capture.m_ZoneNames[i] = ZoneProfiler_GetZoneName( ( uint16 )i );
+	}
+
+	capture.m_ThreadNames.SetCount( s_nZoneProfilerThreads.load( std::memory_order_relaxed ) );
+	for ( CZoneProfilerThread *pThread = s_pZoneProfilerThreads.load( std::memory_order_acquire ); pThread; pThread = pThread->m_pNext )
+	{
+		if ( capture.m_ThreadNames.IsValidIndex( pThread->m_nIndex ) )
+		{
+			capture.m_ThreadNames[pThread->m_nIndex] = pThread->m_szName;
+		}
+	}
+
+	AUTO_LOCK_FM( m_Mutex );
+
+	for ( int i = 0; i < m_CaptureFrames.Count(); i++ )
+	{
+		const CaptureFrame_t &frame = m_CaptureFrames[i];
+		capture.m_FrameStarts.AddToTail( frame.m_nStart );
+
+		for ( int j = 0; j < frame.m_Events.Count(); j++ )
+		{
+			ZoneProfilerCaptureEvent_t &event = capture.m_Events[capture.m_Events.AddToTail()];
+			event.m_nStart = frame.m_Events[j].m_Event.m_nStart;
+			event.m_nTicks = frame.m_Events[j].m_Event.m_nTicks;
+			event.m_nZone = frame.m_Events[j].m_Event.m_nZone;
+			event.m_nDepth = frame.m_Events[j].m_Event.m_nDepth;
+			event.m_nThread = frame.m_Events[j].m_nThread;
+		}
+	}
+
+	if ( m_CaptureFrames.Count() )
+	{
+		capture.m_FrameStarts.AddToTail( m_CaptureFrames.Tail().m_nEnd );
+	}
+
+	std::stable_sort( capture.m_Events.Base(), capture.m_Events.Base() + capture.m_Events.Count(), PendingEventLess );
+}
+
+//-----------------------------------------------------------------------------
+// Capture export
+//-----------------------------------------------------------------------------
+CZoneProfilerCapture::CZoneProfilerCapture() :
+	m_flTicksPerSecond( 0.0 )
+{
+}
+
+void CZoneProfilerCapture::Purge()
+{
+	m_flTicksPerSecond = 0.0;
+	m_ZoneNames.Purge();
+	m_ThreadNames.Purge();
+	m_FrameStarts.Purge();
+	m_Events.Purge();
+}
+
+static void PutJSONEscapedString( CUtlBuffer &buf, const char *pszString )
+{
+	buf.PutChar( '"' );
+	for ( const char *p = pszString; *p; p++ )
+	{
+		unsigned char c = ( unsigned char )*p;
+		if ( c == '"' || c == '\\' )
+		{
+			buf.PutChar( '\\' );
+			buf.PutChar( ( char )c );
+		}
+		else if ( c < 0x20 )
+		{
+			buf.Printf( "\\u%04x", c );
+		}
+		else
+		{
+			buf.PutChar( ( char )c );
+		}
+	}
+	buf.PutChar( '"' );
+}
+
+void CZoneProfilerCapture::ExportChromeTrace( CUtlBuffer &buf ) const
+{
+	uint64 nBase = m_FrameStarts.Count() ? m_FrameStarts[0] : ( m_Events.Count() ? m_Events[0].m_nStart : 0 );
+	double flUsPerTick = ( m_flTicksPerSecond > 0.0 ) ? 1000000.0 / m_flTicksPerSecond : 0.0;
+
+	buf.PutString( "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" );
+
+	bool bFirst = true;
+	for ( int i = 0; i < m_ThreadNames.Count(); i++ )
+	{
+		buf.PutString( bFirst ? "\n" : ",\n" );
+		bFirst = false;
+
+		buf.Printf( "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", i );
+		PutJSONEscapedString( buf, m_ThreadNames[i].Get() );
+		buf.PutString( "}}" );
+	}
+
+	// Frames as instant events on the first thread, so the trace shows where they split
+	for ( int i = 0; i < m_FrameStarts.Count(); i++ )
+	{
+		buf.PutString( bFirst ? "\n" : ",\n" );
+		bFirst = false;
+
+		buf.Printf( "{\"ph\":\"i\",\"name\":\"frame\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%.3f}", ( double )( m_FrameStarts[i] - nBase ) * flUsPerTick );
+	}
+
+	for ( int i = 0; i < m_Events.Count(); i++ )
+	{
+		const ZoneProfilerCaptureEvent_t &event = m_Events[i];
+		buf.PutString( bFirst ? "\n" : ",\n" );
+		bFirst = false;
+
+		buf.PutString( "{\"ph\":\"X\",\"name\":" );
+		PutJSONEscapedString( buf, m_ZoneNames.IsValidIndex( event.m_nZone ) ? m_ZoneNames[event.m_nZone].Get() : "" );
+		buf.Printf( ",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", event.m_nThread, ( double )( int64 )( event.m_nStart - nBase ) * flUsPerTick, event.m_nTicks * flUsPerTick );
+	}
+
+	buf.PutString( "\n]}\n" );
+}
+
+static void PutVarInt( CUtlBuffer &buf, uint64 nValue )
+{
+	while ( nValue >= 0x80 )
+	{
+		buf.PutUnsignedChar( ( unsigned char )( nValue | 0x80 ) );
+		nValue >>= 7;
+	}
+	buf.PutUnsignedChar( ( unsigned char )nValue );
+}
+
+static bool GetVarInt( CUtlBuffer &buf, uint64 &nValue )
+{
+	nValue = 0;
+	for ( int nShift = 0; nShift < 64; nShift += 7 )
+	{
+		unsigned char nByte = buf.GetUnsignedChar();
+		if ( !buf.IsValid() )
+			return false;
+
+		nValue |= ( uint64 )( nByte & 0x7F ) << nShift;
+		if ( !( nByte & 0x80 ) )
+			return true;
+	}
+
+	return false;
+}
+
+static void PutCaptureString( CUtlBuffer &buf, const char *pszString )
+{
+	int nLength = V_strlen( pszString );
+	PutVarInt( buf, nLength );
+	buf.Put( pszString, nLength );
+}
+
+static bool GetCaptureString( CUtlBuffer &buf, CUtlString &string )
+{
+	uint64 nLength;
+	if ( !GetVarInt( buf, nLength ) || nLength > ( uint64 )buf.GetBytesRemaining() )
+		return false;
+
+	char szString[256];
+	char *pszString = ( nLength < sizeof( szString ) ) ? szString : new char[nLength + 1];
+	buf.Get( pszString, ( int )nLength );
+	pszString[nLength] = '\0';
+	string = pszString;
+
+	if ( pszString != szString )
+	{
+		delete[] pszString;
+	}
+
+	return buf.IsValid();
+}
+
+// Layout: magic, version, ticks per second, then varints: zone names, thread names,
+// frame starts as deltas, and the zones a thread at a time as
+// { start delta, ticks, zone, depth }, starts delta coded against the thread's previous zone.
+void CZoneProfilerCapture::ExportBinary( CUtlBuffer &buf ) const
+{
+	buf.PutUnsignedInt( s_nBinaryCaptureMagic );
+	buf.PutUnsignedInt( s_nBinaryCaptureVersion );
+	buf.PutDouble( m_flTicksPerSecond );
+
+	PutVarInt( buf, m_ZoneNames.Count() );
+	for ( int i = 0; i < m_ZoneNames.Count(); i++ )
+	{
+		PutCaptureString( buf, m_ZoneNames[i].Get() );
+	}
+
+	PutVarInt( buf, m_ThreadNames.Count() );
+	for ( int i = 0; i < m_ThreadNames.Count(); i++ )
+	{
+		PutCaptureString( buf, m_ThreadNames[i].Get() );
+	}
+
+	uint64 nBase = m_FrameStarts.Count() ? m_FrameStarts[0] : 0;
+	PutVarInt( buf, m_FrameStarts.Count() );
+	for ( int i = 0; i < m_FrameStarts.Count(); i++ )
+	{
+		PutVarInt( buf, m_FrameStarts[i] - ( i ? m_FrameStarts[i - 1] : 0 ) );
+	}
+
+	for ( int nFirst = 0; nFirst < m_Events.Count(); )
+	{
+		int nThread = m_Events[nFirst].m_nThread;
+		int nEnd = nFirst;
+		while ( nEnd < m_Events.Count() && m_Events[nEnd].m_nThread == nThread )
+		{
+			nEnd++;
+		}
+
+		PutVarInt( buf, nEnd - nFirst );
+		PutVarInt( buf, nThread );
+
+		uint64 nPrevStart = nBase;
+		for ( int i = nFirst; i < nEnd; i++ )
+		{
+			const ZoneProfilerCaptureEvent_t &event = m_Events[i];
+			Assert( event.m_nStart >= nPrevStart );
+			PutVarInt( buf, event.m_nStart - nPrevStart );
+			PutVarInt( buf, event.m_nTicks );
+			PutVarInt( buf, event.m_nZone );
+			PutVarInt( buf, event.m_nDepth );
+			nPrevStart = event.m_nStart;
+		}
+
+		nFirst = nEnd;
+	}
+
+	// Empty run ends the zones
+	PutVarInt( buf, 0 );
+}
+
+bool CZoneProfilerCapture::ImportBinary( CUtlBuffer &buf )
+{
+	Purge();
+
+	if ( buf.GetUnsignedInt() != s_nBinaryCaptureMagic || buf.GetUnsignedInt() != s_nBinaryCaptureVersion )
+		return false;
+
+	m_flTicksPerSecond = buf.GetDouble();
+
+	uint64 nCount;
+	if ( !GetVarInt( buf, nCount ) || nCount > 0x10000 )
+		return false;
+
+	m_ZoneNames.SetCount( ( int )nCount );
+	for ( int i = 0; i < m_ZoneNames.Count(); i++ )
+	{
+		if ( !GetCaptureString( buf, m_ZoneNames[i] ) )
+			return false;
+	}
+
+	if ( !GetVarInt( buf, nCount ) || nCount > ( uint64 )buf.GetBytesRemaining() )
+		return false;
+
+	m_ThreadNames.SetCount( ( int )nCount );
+	for ( int i = 0; i < m_ThreadNames.Count(); i++ )
+	{
+		if ( !GetCaptureString( buf, m_ThreadNames[i] ) )
+			return false;
+	}
+
+	if ( !GetVarInt( buf, nCount ) || nCount > ( uint64 )buf.GetBytesRemaining() )
+		return false;
+
+	m_FrameStarts.SetCount( ( int )nCount );
+	for ( int i = 0; i < m_FrameStarts.Count(); i++ )
+	{
+		uint64 nDelta;
+		if ( !GetVarInt( buf, nDelta ) )
+			return false;
+
+		m_FrameStarts[i] = ( i ? m_FrameStarts[i - 1] : 0 ) + nDelta;
+	}
+
+	uint64 nBase = m_FrameStarts.Count() ? m_FrameStarts[0] : 0;
+	for ( ;; )
+	{
+		uint64 nRunCount, nThread;
+		if ( !GetVarInt( buf, nRunCount ) )
+			return false;
+		if ( !nRunCount )
+			break;
+		if ( !GetVarInt( buf, nThread ) || nThread >= ( uint64 )m_ThreadNames.Count() || nRunCount > ( uint64 )buf.GetBytesRemaining() )
+			return false;
+
+		uint64 nPrevStart = nBase;
+		for ( uint64 i = 0; i < nRunCount; i++ )
+		{
+			uint64 nDelta, nTicks, nZone, nDepth;
+			if ( !GetVarInt( buf, nDelta ) || !GetVarInt( buf, nTicks ) || !GetVarInt( buf, nZone ) || !GetVarInt( buf, nDepth ) )
+				return false;
+			if ( nTicks > 0xFFFFFFFFull || nZone >= ( uint64 )m_ZoneNames.Count() || nDepth > 0xFFFF )
+				return false;
+
+			ZoneProfilerCaptureEvent_t &event = m_Events[m_Events.AddToTail()];
+			event.m_nStart = nPrevStart + nDelta;
+			event.m_nTicks = ( uint32 )nTicks;
+			event.m_nZone = ( uint16 )nZone;
+			event.m_nDepth = ( uint16 )nDepth;
+			event.m_nThread = ( int )nThread;
+			nPrevStart = event.m_nStart;
+		}
+	}
+
+	return buf.IsValid();
+}
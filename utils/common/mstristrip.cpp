@@ -13,23 +13,29 @@
 // Copyright (c) 1999-2000 Microsoft Corporation. All rights reserved.
 //-----------------------------------------------------------------------------
 
+#ifdef _MSC_VER
 // identifier was truncated to '255' characters in the debug information
 #pragma warning(disable: 4786)
 // conversion from 'double' to 'float'
 #pragma warning(disable: 4244)
 #pragma warning(disable: 4530)
+#endif
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
 #include <algorithm>
 #include <list>
 #include <vector>
 
 #include <assert.h>
-#ifdef _DEBUG
+#if defined(_DEBUG) && defined(_WIN32)
 #include <crtdbg.h>
 #endif
 
+#include "tier0/threadtools.h"
 #include "mstristrip.h"
 
 using namespace std;
@@ -755,7 +761,7 @@ bool CVertCache::Add(int strip, int vertindex)
     return true;
 }
 
-#ifdef _DEBUG
+#if defined(_DEBUG) && defined(_WIN32)
 //=========================================================================
 // Turn on c runtime leak checking, etc.
 //=========================================================================
@@ -928,3 +934,471 @@ void ComputeVertexPermutation(int numstripindices, WORD* pstripindices,
     delete[] pInversePermutation;
 }
 
+//=========================================================================
+// vertex cache optimizer class
+//
+// Every vertex gets a score from where it sits in a simulated LRU cache
+// and how many triangles still use it; the next triangle is the one with
+// the highest total among the triangles of the cached vertices. Per vertex
+// it keeps the triangles that still use it, so nothing is ever searched.
+//=========================================================================
+class CVertexCacheOptimizer
+{
+public:
+    CVertexCacheOptimizer(int numtris, TRIANGLELIST ptriangles);
+    ~CVertexCacheOptimizer();
+
+    // write the reordered triangles to pindices
+    void Optimize(WORD *pindices);
+
+    enum { CACHE_SIZE = 32 };       // simulated LRU cache
+    enum { MAX_VALENCE = 32 };      // valence scores stop changing past this
+
+private:
+    float VertScore(int vert) const
+    {
+        int livetris = m_plivetris[vert];
+        if(!livetris)
+            return -1.0f;
+
+        int cachepos = m_pcachepos[vert];
+        float score = (cachepos >= 0) ? m_rgCacheScore[cachepos] : 0.0f;
+        return score + m_rgValenceScore[min(livetris, (int)MAX_VALENCE - 1)];
+    }
+
+    int m_numtris;
+    int m_numverts;
+    TRIANGLELIST m_ptriangles;
+
+    int *m_pvertoffset;             // first entry of each vert's run in m_pverttris
+    int *m_pverttris;               // triangles using each vert; the live ones come first
+    int *m_plivetris;               // # triangles left to emit per vert
+    int *m_pcachepos;               // position in the cache, or -1
+    float *m_pvertscore;
+    float *m_ptriscore;             // sum of the vert scores, or -1 once emitted
+
+    float m_rgCacheScore[CACHE_SIZE];
+    float m_rgValenceScore[MAX_VALENCE];
+};
+
+//=========================================================================
+// CVertexCacheOptimizer ctor
+//=========================================================================
+CVertexCacheOptimizer::CVertexCacheOptimizer(int numtris, TRIANGLELIST ptriangles)
+{
+    m_numtris = numtris;
+    m_ptriangles = ptriangles;
+
+    // Forsyth's constants: the last triangle's verts get a fixed score (the
+    // order within it barely matters), the rest decay with cache position,
+    // and verts with few triangles left get a boost so they get finished off
+    const float kLastTriScore = 0.75f;
+    const float kCacheDecayPower = 1.5f;
+    const float kValenceBoostScale = 2.0f;
+    const float kValenceBoostPower = 0.5f;
+
+	int i;
+    for(i = 0; i < CACHE_SIZE; i++)
+    {
+        m_rgCacheScore[i] = (i < 3) ? kLastTriScore :
+            powf(1.0f - (float)(i - 3) / (CACHE_SIZE - 3), kCacheDecayPower);
+    }
+    m_rgValenceScore[0] = 0.0f;
+    for(i = 1; i < MAX_VALENCE; i++)
+        m_rgValenceScore[i] = kValenceBoostScale * powf((float)i, -kValenceBoostPower);
+
+    int numindices = numtris * 3;
+    WORD *pindices = &ptriangles[0][0];
+
+    m_numverts = 0;
+    for(i = 0; i < numindices; i++)
+        m_numverts = max(m_numverts, pindices[i] + 1);
+
+    m_pvertoffset = new int[m_numverts + 1];
+    m_pverttris = new int[numindices];
+    m_plivetris = new int[m_numverts];
+    m_pcachepos = new int[m_numverts];
+    m_pvertscore = new float[m_numverts];
+    m_ptriscore = new float[numtris];
+
+    // bucket the triangles by vert
+    memset(m_plivetris, 0, sizeof(m_plivetris[0]) * m_numverts);
+    for(i = 0; i < numindices; i++)
+        m_plivetris[pindices[i]]++;
+
+    int offset = 0;
+    for(i = 0; i < m_numverts; i++)
+    {
+        m_pvertoffset[i] = offset;
+        offset += m_plivetris[i];
+        m_plivetris[i] = 0;
+    }
+    m_pvertoffset[m_numverts] = offset;
+
+    for(i = 0; i < numindices; i++)
+    {
+        int vert = pindices[i];
+        m_pverttris[m_pvertoffset[vert] + m_plivetris[vert]++] = i / 3;
+    }
+
+    for(i = 0; i < m_numverts; i++)
+    {
+        m_pcachepos[i] = -1;
+        m_pvertscore[i] = VertScore(i);
+    }
+    for(i = 0; i < numtris; i++)
+    {
+        m_ptriscore[i] = m_pvertscore[ptriangles[i][0]] +
+            m_pvertscore[ptriangles[i][1]] + m_pvertscore[ptriangles[i][2]];
+    }
+}
+
+//=========================================================================
+// CVertexCacheOptimizer dtor
+//=========================================================================
+CVertexCacheOptimizer::~CVertexCacheOptimizer()
+{
+    delete [] m_pvertoffset;
+    delete [] m_pverttris;
+    delete [] m_plivetris;
+    delete [] m_pcachepos;
+    delete [] m_pvertscore;
+    delete [] m_ptriscore;
+}
+
+//=========================================================================
+// Emit the triangles in cache friendly order
+//=========================================================================
+void CVertexCacheOptimizer::Optimize(WORD *pindices)
+{
+    // the cache before and after adding a triangle; verts pushed past
+    // CACHE_SIZE are in the second one just long enough to drop out
+    int rgCache[CACHE_SIZE + 3];
+    int rgNewCache[CACHE_SIZE + 3];
+    int cachesize = 0;
+
+    // start with the best triangle overall
+    int besttri = 0;
+	int tri;
+    for(tri = 1; tri < m_numtris; tri++)
+    {
+        if(m_ptriscore[tri] > m_ptriscore[besttri])
+            besttri = tri;
+    }
+
+    int nexttri = 0;                // no triangle before this one is left
+    for(int numemitted = 0; numemitted < m_numtris; numemitted++)
+    {
+        // nothing in the cache has triangles left - take the next one in
+        // the original order, it's as good as any
+        if(besttri == -1)
+        {
+            while(m_ptriscore[nexttri] < 0.0f)
+                nexttri++;
+            besttri = nexttri;
+        }
+
+        WORD *ptriverts = m_ptriangles[besttri];
+        pindices[numemitted * 3 + 0] = ptriverts[0];
+        pindices[numemitted * 3 + 1] = ptriverts[1];
+        pindices[numemitted * 3 + 2] = ptriverts[2];
+        m_ptriscore[besttri] = -1.0f;
+
+        // take the triangle off its verts' live lists and put the verts
+        // at the front of the cache
+        int newcachesize = 0;
+        int ivert;
+        for(ivert = 0; ivert < 3; ivert++)
+        {
+            int vert = ptriverts[ivert];
+            int *pverttris = &m_pverttris[m_pvertoffset[vert]];
+            int last = --m_plivetris[vert];
+            for(int itri = 0; itri <= last; itri++)
+            {
+                if(pverttris[itri] == besttri)
+                {
+                    pverttris[itri] = pverttris[last];
+                    pverttris[last] = besttri;
+                    break;
+                }
+            }
+
+            // degenerate triangles name a vert more than once
+            if(find(rgNewCache, rgNewCache + newcachesize, vert) == rgNewCache + newcachesize)
+                rgNewCache[newcachesize++] = vert;
+        }
+        for(int icache = 0; icache < cachesize; icache++)
+        {
+            int vert = rgCache[icache];
+            if(vert != ptriverts[0] && vert != ptriverts[1] && vert != ptriverts[2])
+                rgNewCache[newcachesize++] = vert;
+        }
+
+        // rescore the verts that moved, and pass the change on to the
+        // triangles they still have
+        int icache;
+        for(icache = 0; icache < newcachesize; icache++)
+        {
+            int vert = rgNewCache[icache];
+            m_pcachepos[vert] = (icache < CACHE_SIZE) ? icache : -1;
+            float score = VertScore(vert);
+            float delta = score - m_pvertscore[vert];
+            m_pvertscore[vert] = score;
+            if(delta == 0.0f)
+                continue;
+
+            int *pverttris = &m_pverttris[m_pvertoffset[vert]];
+            for(int itri = 0; itri < m_plivetris[vert]; itri++)
+                m_ptriscore[pverttris[itri]] += delta;
+        }
+
+        // the next triangle is the best one using a vert still in the cache
+        besttri = -1;
+        float bestscore = -1.0f;
+        cachesize = min(newcachesize, (int)CACHE_SIZE);
+        for(icache = 0; icache < cachesize; icache++)
+        {
+            int vert = rgNewCache[icache];
+            int *pverttris = &m_pverttris[m_pvertoffset[vert]];
+            for(int itri = 0; itri < m_plivetris[vert]; itri++)
+            {
+                tri = pverttris[itri];
+                if(m_ptriscore[tri] > bestscore)
+                {
+                    besttri = tri;
+                    bestscore = m_ptriscore[tri];
+                }
+            }
+            rgCache[icache] = vert;
+        }
+    }
+}
+
+//=========================================================================
+// Count the verts a triangle list transforms through a FIFO vertex cache.
+// pcachetime holds, per vert, when it was last loaded.
+//=========================================================================
+static int CountCacheMisses(int numtris, const WORD *pindices, int cachesize,
+    int *pcachetime, int *pmisses)
+{
+    int time = cachesize;
+    int totalmisses = 0;
+    for(int tri = 0; tri < numtris; tri++)
+    {
+        int misses = 0;
+        for(int ivert = 0; ivert < 3; ivert++)
+        {
+            int vert = pindices[tri * 3 + ivert];
+            if(time - pcachetime[vert] >= cachesize)
+            {
+                pcachetime[vert] = ++time;
+                misses++;
+            }
+        }
+        if(pmisses)
+            pmisses[tri] = misses;
+        totalmisses += misses;
+    }
+    return totalmisses;
+}
+
+float ComputeACMR(int numindices, const WORD *pindices, int cachesize)
+{
+    int numtris = numindices / 3;
+    if(!numtris)
+        return 0.0f;
+
+    int numverts = *max_element(pindices, pindices + numtris * 3) + 1;
+    vector<int> cachetime(numverts, INT_MIN / 2);
+    return (float)CountCacheMisses(numtris, pindices, cachesize, &cachetime[0], NULL) / numtris;
+}
+
+//=========================================================================
+// Overdraw ordering
+//
+// Sander, Nehab and Barczak's approach: cut the list where the cache is
+// mostly reloaded anyway, then draw the clusters that face away from the
+// middle of the mesh first, since from most directions those are the ones
+// in front. The cuts cost next to nothing in cache reuse.
+//=========================================================================
+struct VERTEXCLUSTER
+{
+    int firsttri;
+    int numtris;
+    float sortkey;
+
+    bool operator<(const VERTEXCLUSTER& rhs) const
+    {
+        return sortkey > rhs.sortkey;
+    }
+};
+
+// the FIFO size the clusters are cut for, that of most hardware
+static const int s_overdrawcachesize = 16;
+
+// cut at 2 misses once a cluster has this many triangles, always at 3
+static const int s_minclustertris = 64;
+
+static void SortClustersForOverdraw(int numtris, WORD *pindices,
+    const float *pvertexpositions, int vertexstride)
+{
+    if(!vertexstride)
+        vertexstride = 3 * sizeof(float);
+
+    int numverts = *max_element(pindices, pindices + numtris * 3) + 1;
+    vector<int> cachetime(numverts, INT_MIN / 2);
+    vector<int> misses(numtris);
+    CountCacheMisses(numtris, pindices, s_overdrawcachesize, &cachetime[0], &misses[0]);
+
+    // area weighted centroid and normal of each cluster, and of the mesh
+    vector<VERTEXCLUSTER> clusters;
+    vector<float> clusterdata;      // centroid xyz, normal xyz per cluster
+    double meshcentroid[3] = { 0, 0, 0 };
+    double mesharea = 0;
+
+	int tri;
+    for(tri = 0; tri < numtris; tri++)
+    {
+        int numclustertris = clusters.empty() ? 0 : clusters.back().numtris;
+        if(!tri || misses[tri] == 3 || (misses[tri] == 2 && numclustertris >= s_minclustertris))
+        {
+            VERTEXCLUSTER cluster = { tri, 0, 0.0f };
+            clusters.push_back(cluster);
+            clusterdata.resize(clusterdata.size() + 7, 0.0f);
+        }
+        clusters.back().numtris++;
+
+        const float *p[3];
+        for(int ivert = 0; ivert < 3; ivert++)
+        {
+            p[ivert] = (const float *)((const char *)pvertexpositions +
+                pindices[tri * 3 + ivert] * vertexstride);
+        }
+        float e1[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+        float e2[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+        float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+        float area = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+        float *pdata = &clusterdata[clusterdata.size() - 7];
+        for(int axis = 0; axis < 3; axis++)
+        {
+            float center = (p[0][axis] + p[1][axis] + p[2][axis]) * (1.0f / 3.0f);
+            pdata[axis] += center * area;
+            pdata[axis + 3] += n[axis];
+            meshcentroid[axis] += center * area;
+        }
+        pdata[6] += area;
+        mesharea += area;
+    }
+
+    if(clusters.size() < 2 || mesharea <= 0)
+        return;
+
+    for(int axis = 0; axis < 3; axis++)
+        meshcentroid[axis] /= mesharea;
+
+    for(size_t icluster = 0; icluster < clusters.size(); icluster++)
+    {
+        const float *pdata = &clusterdata[icluster * 7];
+        float normallen = sqrtf(pdata[3] * pdata[3] + pdata[4] * pdata[4] + pdata[5] * pdata[5]);
+        float dot = 0.0f;
+        if(pdata[6] > 0.0f && normallen > 0.0f)
+        {
+            for(int axis = 0; axis < 3; axis++)
+                dot += (pdata[axis] / pdata[6] - (float)meshcentroid[axis]) * pdata[axis + 3];
+            dot /= normallen;
+        }
+        clusters[icluster].sortkey = dot;
+    }
+
+    stable_sort(clusters.begin(), clusters.end());
+
+    vector<WORD> sorted(numtris * 3);
+    int numsorted = 0;
+    for(size_t icluster = 0; icluster < clusters.size(); icluster++)
+    {
+        memcpy(&sorted[numsorted], &pindices[clusters[icluster].firsttri * 3],
+            clusters[icluster].numtris * 3 * sizeof(WORD));
+        numsorted += clusters[icluster].numtris * 3;
+    }
+    memcpy(pindices, &sorted[0], numtris * 3 * sizeof(WORD));
+}
+
+//=========================================================================
+// Main vertex cache optimization routine
+//=========================================================================
+int OptimizeVertexCache(int numtris, WORD *ptriangles, int *pnumindices, WORD **ppindices,
+    const float *pvertexpositions, int vertexstride)
+{
+    if(!numtris || !ptriangles)
+        return 0;
+
+    WORD *pindices = new WORD[numtris * 3];
+    {
+        CVertexCacheOptimizer optimizer(numtris, (TRIANGLELIST)ptriangles);
+        optimizer.Optimize(pindices);
+    }
+
+    if(pvertexpositions)
+        SortClustersForOverdraw(numtris, pindices, pvertexpositions, vertexstride);
+
+    *ppindices = pindices;
+    if(pnumindices)
+        *pnumindices = numtris * 3;
+    return numtris * 3;
+}
+
+//=========================================================================
+// Batches: the threads take the next mesh off a shared counter
+//=========================================================================
+struct VERTEXCACHEBATCH
+{
+    int nummeshes;
+    VERTEXCACHEMESH *pmeshes;
+    int32 volatile nextmesh;
+};
+
+static uintp OptimizeVertexCacheBatchThread(void *pparam)
+{
+    VERTEXCACHEBATCH *pbatch = (VERTEXCACHEBATCH *)pparam;
+    for(;;)
+    {
+        int imesh = ThreadInterlockedIncrement(&pbatch->nextmesh) - 1;
+        if(imesh >= pbatch->nummeshes)
+            break;
+
+        VERTEXCACHEMESH &mesh = pbatch->pmeshes[imesh];
+        mesh.numindices = 0;
+        mesh.pindices = NULL;
+        OptimizeVertexCache(mesh.numtris, mesh.ptriangles, &mesh.numindices, &mesh.pindices,
+            mesh.pvertexpositions, mesh.vertexstride);
+    }
+    return 0;
+}
+
+void OptimizeVertexCacheBatch(int nummeshes, VERTEXCACHEMESH *pmeshes, int numthreads)
+{
+    VERTEXCACHEBATCH batch;
+    batch.nummeshes = nummeshes;
+    batch.pmeshes = pmeshes;
+    batch.nextmesh = 0;
+
+    numthreads = min(numthreads, nummeshes);
+
+    vector<ThreadHandle_t> threads;
+    for(int i = 1; i < numthreads; i++)
+    {
+        ThreadHandle_t hthread = CreateSimpleThread(OptimizeVertexCacheBatchThread, &batch);
+        if(hthread)
+            threads.push_back(hthread);
+    }
+
+    // this thread works too, and does everything if no threads could be started
+    OptimizeVertexCacheBatchThread(&batch);
+
+    for(size_t i = 0; i < threads.size(); i++)
+    {
+        ThreadJoin(threads[i]);
+        ReleaseThreadHandle(threads[i]);
+    }
+}
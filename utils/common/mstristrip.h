@@ -41,3 +41,59 @@ void ComputeVertexPermutation
     WORD **ppvertexpermutation      // Map from orignal index to remapped index
 );
 
+//
+// Reorder a triangle list so that consecutive triangles reuse the vertices
+// still in the post-transform vertex cache (Forsyth's linear-speed vertex
+// cache optimisation). Unlike Stripify this is linear in the number of
+// triangles and emits a triangle list. Returns the number of indices in
+// ppindices, which is numtris * 3. Caller must delete [] ppindices.
+//
+// If pvertexpositions is given, the result is also cut into clusters at
+// points where the cache starts over anyway, and the clusters are sorted
+// so the ones facing away from the middle of the mesh are drawn first,
+// which cuts down overdraw at little cost to cache reuse.
+//
+int OptimizeVertexCache(
+    int numtris,                    // Number of triangles
+    WORD *ptriangles,               // triangle indices pointer
+    int *pnumindices,               // number of indices in ppindices (out)
+    WORD **ppindices,               // reordered triangle indices
+    const float *pvertexpositions = 0,  // xyz of each vertex (optional)
+    int vertexstride = 0            // bytes between positions, 0 for packed xyz
+);
+
+//
+// One mesh for OptimizeVertexCacheBatch. The outputs are the same as
+// OptimizeVertexCache's; caller must delete [] pindices.
+//
+struct VERTEXCACHEMESH
+{
+    int numtris;
+    WORD *ptriangles;
+    const float *pvertexpositions;  // optional
+    int vertexstride;
+
+    int numindices;                 // (out)
+    WORD *pindices;                 // (out)
+};
+
+//
+// OptimizeVertexCache for many meshes at once, spread over numthreads
+// threads (the caller's included).
+//
+void OptimizeVertexCacheBatch(
+    int nummeshes,                  // Number of meshes
+    VERTEXCACHEMESH *pmeshes,       // meshes to optimize (in and out)
+    int numthreads                  // threads to use
+);
+
+//
+// Average number of vertices transformed per triangle when drawing a
+// triangle list through a FIFO vertex cache of the given size. 0.5 is the
+// best a large regular mesh can do, 3 means no reuse at all.
+//
+float ComputeACMR(
+    int numindices,                 // Number of triangle list indices
+    const WORD *pindices,           // triangle list indices
+    int cachesize                   // vertex cache entries
+);
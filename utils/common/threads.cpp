@@ -18,9 +18,7 @@
 #define NO_THREAD_NAMES
 #include "threads.h"
 #include "pacifier.h"
-
-#define	MAX_THREADS	16
-
+#include "tier0/cache_hints.h"
 
 class CRunThreadsData
 {
@@ -30,18 +28,63 @@ public:
 	RunThreadsFn m_Fn;
 };
 
-CRunThreadsData g_RunThreadsData[MAX_THREADS];
+CRunThreadsData g_RunThreadsData[MAX_TOOL_THREADS];
 
 
-int		dispatch;
+CThreadWorkDispenser g_ThreadWork;
 int		workcount;
 qboolean		pacifier;
 
 qboolean	threaded;
 bool g_bLowPriorityThreads = false;
+ERunThreadsAffinity g_eThreadAffinity = k_eRunThreadsAffinity_None;
+
+HANDLE g_ThreadHandles[MAX_TOOL_THREADS];
+
+
+// GetThreadWork() hands out one item at a time, so each thread keeps the rest of the
+// chunk it last claimed here. Padded so the threads don't share cache lines.
+struct ThreadWorkChunk_t
+{
+	int m_nNext;
+	int m_nEnd;
+	byte m_Pad[CACHE_LINE_SIZE - 2 * sizeof( int )];
+};
 
-HANDLE g_ThreadHandles[MAX_THREADS];
+ThreadWorkChunk_t g_ThreadWorkChunks[MAX_TOOL_THREADS+1];
 
+// Thread index + 1 of the RunThreads thread this is, 0 on any other thread.
+CTHREADLOCALINT g_iThreadWorkSlot;
+
+// The dispatch index the pacifier next needs drawing at, and who's drawing it.
+int32 volatile g_nNextPacifierWork;
+int32 volatile g_nPacifierDrawing;
+
+
+static void ResetThreadWork( int workcnt )
+{
+	workcount = workcnt;
+	g_ThreadWork.Init( workcnt, numthreads );
+	memset( g_ThreadWorkChunks, 0, sizeof( g_ThreadWorkChunks ) );
+
+	g_nNextPacifierWork = 0;
+	g_nPacifierDrawing = 0;
+}
+
+
+// UpdatePacifier isn't thread safe and only draws 40 ticks, so only redraw it once the
+// dispatch crosses the next tick, and only from whichever thread gets there first.
+static void UpdateThreadWorkPacifier( int nDispatched )
+{
+	if ( nDispatched < g_nNextPacifierWork || !ThreadInterlockedAssignIf( &g_nPacifierDrawing, 1, 0 ) )
+		return;
+
+	UpdatePacifier( (float)nDispatched / workcount );
+
+	int64 nNextTick = (int64)nDispatched * 40 / workcount + 1;
+	g_nNextPacifierWork = (int32)( ( nNextTick * workcount + 39 ) / 40 );
+	ThreadInterlockedExchange( &g_nPacifierDrawing, 0 );
+}
 
 
 /*
@@ -52,23 +95,18 @@ GetThreadWork
 */
 int	GetThreadWork (void)
 {
-	int	r;
-
-	ThreadLock ();
+	int iSlot = g_iThreadWorkSlot;
+	ThreadWorkChunk_t &chunk = g_ThreadWorkChunks[iSlot ? iSlot - 1 : THREADINDEX_MAIN];
 
-	if (dispatch == workcount)
+	if ( chunk.m_nNext >= chunk.m_nEnd )
 	{
-		ThreadUnlock ();
-		return -1;
-	}
-
-	UpdatePacifier( (float)dispatch / workcount );
+		if ( !g_ThreadWork.GetChunk( &chunk.m_nNext, &chunk.m_nEnd ) )
+			return -1;
 
-	r = dispatch;
-	dispatch++;
-	ThreadUnlock ();
+		UpdateThreadWorkPacifier( chunk.m_nNext );
+	}
 
-	return r;
+	return chunk.m_nNext++;
 }
 
 
@@ -76,15 +114,14 @@ ThreadWorkerFn workfunction;
 
 void ThreadWorkerFunction( int iThread, void *pUserData )
 {
-	int		work;
+	int		start, end;
 
-	while (1)
+	while ( g_ThreadWork.GetChunk( &start, &end ) )
 	{
-		work = GetThreadWork ();
-		if (work == -1)
-			break;
-		 
-		workfunction( iThread, work );
+		UpdateThreadWorkPacifier( start );
+
+		for ( int work = start; work < end; work++ )
+			workfunction( iThread, work );
 	}
 }
 
@@ -130,14 +167,14 @@ void SetLowPriority()
 
 void ThreadSetDefault (void)
 {
-	SYSTEM_INFO info;
-
 	if (numthreads == -1)	// not set manually
 	{
-		GetSystemInfo (&info);
-		numthreads = info.dwNumberOfProcessors;
-		if (numthreads < 1 || numthreads > 32)
+		// Counts the processors in every group, GetSystemInfo stops at the caller's group of 64
+		numthreads = GetActiveProcessorCount( ALL_PROCESSOR_GROUPS );
+		if (numthreads < 1)
 			numthreads = 1;
+		else if (numthreads > MAX_TOOL_THREADS)
+			numthreads = MAX_TOOL_THREADS;
 	}
 
 	Msg ("%i threads\n", numthreads);
@@ -169,12 +206,68 @@ void ThreadUnlock (void)
 DWORD WINAPI InternalRunThreadsFn( LPVOID pParameter )
 {
 	CRunThreadsData *pData = (CRunThreadsData*)pParameter;
+	g_iThreadWorkSlot = pData->m_iThread + 1;
 	pData->m_Fn( pData->m_iThread, pData->m_pUserData );
 	return 0;
 }
 
 
-void RunThreads_Start( RunThreadsFn fn, void *pUserData, ERunThreadsPriority ePriority )
+// Pins a thread that's been created suspended, before it gets to run anywhere else.
+static void SetRunThreadAffinity( HANDLE hThread, int iThread, ERunThreadsAffinity eAffinity )
+{
+	if ( eAffinity == k_eRunThreadsAffinity_UseGlobalState )
+		eAffinity = g_eThreadAffinity;
+
+	GROUP_AFFINITY affinity;
+	memset( &affinity, 0, sizeof( affinity ) );
+
+	if ( eAffinity == k_eRunThreadsAffinity_Processors )
+	{
+		// Logical processor N counts up through the groups in order
+		int iProcessor = iThread % MAX( (int)GetActiveProcessorCount( ALL_PROCESSOR_GROUPS ), 1 );
+		WORD nGroups = GetActiveProcessorGroupCount();
+		for ( WORD iGroup = 0; iGroup < nGroups; iGroup++ )
+		{
+			int nGroupProcessors = GetActiveProcessorCount( iGroup );
+			if ( iProcessor < nGroupProcessors )
+			{
+				affinity.Group = iGroup;
+				affinity.Mask = (KAFFINITY)1 << iProcessor;
+				SetThreadGroupAffinity( hThread, &affinity, NULL );
+				return;
+			}
+
+			iProcessor -= nGroupProcessors;
+		}
+	}
+	else if ( eAffinity == k_eRunThreadsAffinity_NUMANodes )
+	{
+		// Node numbers can have gaps, so count the ones that have processors
+		ULONG nHighestNode;
+		if ( !GetNumaHighestNodeNumber( &nHighestNode ) || nHighestNode == 0 )
+			return;
+
+		int nNodes = 0;
+		for ( ULONG iNode = 0; iNode <= nHighestNode; iNode++ )
+		{
+			if ( GetNumaNodeProcessorMaskEx( (USHORT)iNode, &affinity ) && affinity.Mask )
+				nNodes++;
+		}
+
+		int iWantedNode = nNodes ? iThread % nNodes : 0;
+		for ( ULONG iNode = 0; iNode <= nHighestNode; iNode++ )
+		{
+			if ( GetNumaNodeProcessorMaskEx( (USHORT)iNode, &affinity ) && affinity.Mask && iWantedNode-- == 0 )
+			{
+				SetThreadGroupAffinity( hThread, &affinity, NULL );
+				return;
+			}
+		}
+	}
+}
+
+
+void RunThreads_Start( RunThreadsFn fn, void *pUserData, ERunThreadsPriority ePriority, ERunThreadsAffinity eAffinity )
 {
 	Assert( numthreads > 0 );
 	threaded = true;
@@ -194,9 +287,11 @@ void RunThreads_Start( RunThreadsFn fn, void *pUserData, ERunThreadsPriority ePr
 		   0,		// DWORD cbStack,
 		   InternalRunThreadsFn,	// LPTHREAD_START_ROUTINE lpStartAddr,
 		   &g_RunThreadsData[i],	// LPVOID lpvThreadParm,
-		   0,			// DWORD fdwCreate,
+		   CREATE_SUSPENDED,	// DWORD fdwCreate,
 		   &dwDummy );
 
+		SetRunThreadAffinity( g_ThreadHandles[i], i, eAffinity );
+
 		if ( ePriority == k_eRunThreadsPriority_UseGlobalState )
 		{
 			if( g_bLowPriorityThreads )
@@ -206,6 +301,8 @@ void RunThreads_Start( RunThreadsFn fn, void *pUserData, ERunThreadsPriority ePr
 		{
 			SetThreadPriority( g_ThreadHandles[i], THREAD_PRIORITY_IDLE );
 		}
+
+		ResumeThread( g_ThreadHandles[i] );
 	}
 }
 
@@ -230,8 +327,7 @@ void RunThreadsOn( int workcnt, qboolean showpacifier, RunThreadsFn fn, void *pU
 	int		start, end;
 
 	start = Plat_FloatTime();
-	dispatch = 0;
-	workcount = workcnt;
+	ResetThreadWork( workcnt );
 	StartPacifier("");
 	pacifier = showpacifier;
 
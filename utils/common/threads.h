@@ -15,10 +15,12 @@
 #define THREADS_H
 #pragma once
 
+#include "tier0/threadtools.h"
+
 
 // Arrays that are indexed by thread should always be MAX_TOOL_THREADS+1
 // large so THREADINDEX_MAIN can be used from the main thread.
-#define MAX_TOOL_THREADS	16
+#define MAX_TOOL_THREADS	64
 #define THREADINDEX_MAIN	(MAX_TOOL_THREADS)
 
 
@@ -39,6 +41,62 @@ enum ERunThreadsPriority
 };
 
 
+enum ERunThreadsAffinity
+{
+	k_eRunThreadsAffinity_UseGlobalState=0,	// Default.. uses g_eThreadAffinity to decide how to pin the threads.
+	k_eRunThreadsAffinity_None,				// Lets the OS schedule the threads anywhere.
+	k_eRunThreadsAffinity_Processors,		// Pins thread N to logical processor N, across processor groups.
+	k_eRunThreadsAffinity_NUMANodes			// Spreads the threads round robin over the NUMA nodes, free within each node.
+};
+
+// How the threads that are created get pinned when they're started with k_eRunThreadsAffinity_UseGlobalState.
+extern ERunThreadsAffinity g_eThreadAffinity;
+
+
+// Hands out work indices [0, workcount) with one atomic add per chunk instead of a lock
+// per item. Chunks are guided: each is a share of what's left, so the first ones are big
+// and the last ones single items, which keeps the threads finishing together.
+class CThreadWorkDispenser
+{
+public:
+	void Init( int nWorkCount, int nThreads, int nMinChunk = 1 )
+	{
+		m_nDispatch = 0;
+		m_nWorkCount = nWorkCount;
+		m_nChunkDivisor = MAX( nThreads, 1 ) * 2;
+		m_nMinChunk = MAX( nMinChunk, 1 );
+	}
+
+	// Claims [*pStart, *pEnd), returns false once all the work is handed out.
+	bool GetChunk( int *pStart, int *pEnd )
+	{
+		int nRemaining = m_nWorkCount - m_nDispatch;
+		if ( nRemaining <= 0 )
+			return false;
+
+		int nChunk = MAX( nRemaining / m_nChunkDivisor, m_nMinChunk );
+		int nStart = ThreadInterlockedExchangeAdd( &m_nDispatch, nChunk );
+		if ( nStart >= m_nWorkCount )
+			return false;
+
+		*pStart = nStart;
+		*pEnd = MIN( nStart + nChunk, m_nWorkCount );
+		return true;
+	}
+
+	int WorkCount() const { return m_nWorkCount; }
+
+	// How far the dispatch has got, for progress display.
+	int Dispatched() const { return MIN( (int)m_nDispatch, m_nWorkCount ); }
+
+private:
+	int32 volatile m_nDispatch;
+	int m_nWorkCount;
+	int m_nChunkDivisor;
+	int m_nMinChunk;
+};
+
+
 // Put the process into an idle priority class so it doesn't hog the UI.
 void SetLowPriority();
 
@@ -50,7 +108,8 @@ void RunThreadsOnIndividual ( int workcnt, qboolean showpacifier, ThreadWorkerFn
 void RunThreadsOn ( int workcnt, qboolean showpacifier, RunThreadsFn fn, void *pUserData=NULL );
 
 // This version doesn't track work items - it just runs your function and waits for it to finish.
-void RunThreads_Start( RunThreadsFn fn, void *pUserData, ERunThreadsPriority ePriority=k_eRunThreadsPriority_UseGlobalState );
+void RunThreads_Start( RunThreadsFn fn, void *pUserData, ERunThreadsPriority ePriority=k_eRunThreadsPriority_UseGlobalState,
+	ERunThreadsAffinity eAffinity=k_eRunThreadsAffinity_UseGlobalState );
 void RunThreads_End();
 
 void ThreadLock (void);